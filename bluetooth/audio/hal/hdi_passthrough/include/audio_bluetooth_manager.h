@@ -36,6 +36,7 @@ RawAddress& GetDevice();
 void GetProxy();
 void RegisterObserver();
 BluetoothA2dpCodecStatus GetCodecStatus();
+uint32_t GetCodecFrameSamples();
 int WriteFrame(const uint8_t *data, uint32_t size);
 int StartPlaying();
 int SuspendPlaying();
@@ -25,6 +25,7 @@
 #include <servmgr_hdi.h>
 #include "audio_manager.h"
 #include "audio_common.h"
+#include "audio_render_ring.h"
 #include "hdf_base.h"
 namespace OHOS::HDI::Audio_Bluetooth {
 #ifdef __cplusplus
@@ -200,6 +201,8 @@ struct AudioFrameRenderMode {
     char *buffer;
     uint64_t bufferFrameSize;
     uint64_t bufferSize;
+    struct AudioRenderRing ring;
+    uint64_t sentBytes;         /* ring bytes the sender handed over, already counted in frames */
     RenderCallback callback;
     void* cookie;
     struct AudioMmapBufferDescripter mmapBufDesc;
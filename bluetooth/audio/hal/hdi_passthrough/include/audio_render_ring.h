@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AUDIO_RENDER_RING_H
+#define AUDIO_RENDER_RING_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+namespace OHOS::HDI::Audio_Bluetooth {
+typedef int (*AudioRenderRingSend)(const uint8_t *data, uint32_t size);
+
+struct AudioRenderRingStats {
+    uint64_t writeBytes;        /* bytes accepted from the render caller */
+    uint64_t sendBytes;         /* bytes handed to the A2DP source */
+    uint64_t sendCount;         /* number of WriteFrame calls */
+    uint64_t sendErrors;        /* WriteFrame failures, the batch is dropped */
+    uint64_t underruns;         /* sender found the ring empty while streaming, not after drain, flush or pause */
+    uint64_t writeWaits;        /* render caller waited for free space */
+    uint64_t flushBytes;        /* bytes discarded by Flush, or still queued when the ring stopped */
+    uint64_t sendTimeTotalUs;   /* accumulated WriteFrame duration */
+    uint32_t sendTimeMaxUs;     /* longest WriteFrame duration */
+    uint32_t bufferedMaxBytes;  /* high-water mark of queued data */
+};
+
+struct AudioRenderRing {
+    uint8_t *buffer;
+    uint32_t capacity;
+    uint32_t readPos;
+    uint32_t writePos;
+    uint32_t dataSize;
+    uint32_t batchSize;
+    uint8_t *batchBuffer;
+    bool running;
+    bool paused;
+    bool draining;
+    bool starved;
+    bool sending;
+    uint32_t waiters;           /* callers blocked on a condition, Stop waits for them to leave */
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t dataCond;
+    pthread_cond_t spaceCond;
+    AudioRenderRingSend send;
+    struct AudioRenderRingStats stats;
+};
+
+int32_t AudioRenderRingStart(struct AudioRenderRing *ring, uint8_t *buffer, uint32_t capacity, uint32_t batchSize,
+                             AudioRenderRingSend send);
+void AudioRenderRingStop(struct AudioRenderRing *ring);
+int32_t AudioRenderRingWrite(struct AudioRenderRing *ring, const uint8_t *data, uint32_t size);
+void AudioRenderRingSetPause(struct AudioRenderRing *ring, bool pause);
+void AudioRenderRingFlush(struct AudioRenderRing *ring);
+void AudioRenderRingDrain(struct AudioRenderRing *ring);
+uint32_t AudioRenderRingGetBufferedBytes(struct AudioRenderRing *ring);
+void AudioRenderRingGetStats(struct AudioRenderRing *ring, struct AudioRenderRingStats *stats);
+}
+#endif
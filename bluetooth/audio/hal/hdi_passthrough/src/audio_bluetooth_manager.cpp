@@ -32,6 +32,9 @@ static sptr<BluetoothA2dpSrcObserver> g_btA2dpSrcObserverCallbacks = nullptr;
 int g_playState = false;
 RawAddress g_device;
 
+constexpr uint32_t A2DP_SBC_FRAME_SAMPLES = 128;
+constexpr uint32_t A2DP_AAC_FRAME_SAMPLES = 1024;
+
 static void AudioOnConnectionStateChanged(const RawAddress &device, int state)
 {
     HDF_LOGI("AudioOnConnectionStateChanged, state:%d", state);
@@ -120,6 +123,15 @@ BluetoothA2dpCodecStatus GetCodecStatus()
     return codecStatus;
 }
 
+uint32_t GetCodecFrameSamples()
+{
+    BluetoothA2dpCodecStatus codecStatus = GetCodecStatus();
+    if (codecStatus.codecInfo.codecType == A2DP_CODEC_TYPE_AAC_USER) {
+        return A2DP_AAC_FRAME_SAMPLES;
+    }
+    return A2DP_SBC_FRAME_SAMPLES;
+}
+
 int WriteFrame(const uint8_t *data, uint32_t size)
 {
     HDF_LOGI("audio_bluetooth_manager WriteFrame");
@@ -12,6 +12,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <cinttypes>
 #include <hdf_log.h>
 #include "audio_internal.h"
 #include "audio_adapter_info_common.h"
@@ -21,6 +22,9 @@ namespace OHOS::HDI::Audio_Bluetooth {
 /* 1 buffer: 8000(8kHz sample rate) * 2(bytes, PCM_16_BIT) * 1(channel) */
 /* 1 frame: 1024(sample) * 2(bytes, PCM_16_BIT) * 1(channel) */
 constexpr int FRAME_SIZE = 1024;
+/* PCM is batched to whole codec frames, at least this many samples per WriteFrame */
+constexpr uint32_t RENDER_BATCH_MIN_SAMPLES = 512;
+constexpr uint32_t RENDER_RING_BATCH_COUNT = 8;
 
 int32_t PcmBytesToFrames(const struct AudioFrameRenderMode *frameRenderMode, uint64_t bytes, uint32_t *frameCount)
 {
@@ -40,6 +44,46 @@ int32_t PcmBytesToFrames(const struct AudioFrameRenderMode *frameRenderMode, uin
     return HDF_SUCCESS;
 }
 
+/* frames and time follow what the sender handed to the A2DP source, not what was queued in the ring */
+static void AudioRenderSyncPosition(struct AudioFrameRenderMode *frameRenderMode)
+{
+    struct AudioRenderRingStats stats = {0};
+    AudioRenderRingGetStats(&frameRenderMode->ring, &stats);
+    if (stats.sendBytes <= frameRenderMode->sentBytes || frameRenderMode->attrs.sampleRate == 0) {
+        return;
+    }
+    uint32_t frameCount = 0;
+    if (PcmBytesToFrames(frameRenderMode, stats.sendBytes - frameRenderMode->sentBytes, &frameCount) != HDF_SUCCESS) {
+        return;
+    }
+    frameRenderMode->sentBytes = stats.sendBytes;
+    frameRenderMode->frames += frameCount;
+    (void)TimeToAudioTimeStamp(frameCount, &frameRenderMode->time, frameRenderMode->attrs.sampleRate);
+}
+
+static uint32_t AudioRenderGetBatchSize(const struct AudioFrameRenderMode *frameRenderMode)
+{
+    uint32_t formatBits = 0;
+    if (FormatToBits(frameRenderMode->attrs.format, &formatBits) != HDF_SUCCESS) {
+        return FRAME_DATA;
+    }
+    uint32_t frameSize = frameRenderMode->attrs.channelCount * (formatBits >> 3); // Bit to byte >> 3
+    uint32_t codecFrameSamples = OHOS::Bluetooth::GetCodecFrameSamples();
+    if (frameSize == 0 || codecFrameSamples == 0) {
+        return FRAME_DATA;
+    }
+    uint32_t batchSamples = codecFrameSamples;
+    while (batchSamples < RENDER_BATCH_MIN_SAMPLES) {
+        batchSamples += codecFrameSamples;
+    }
+    return batchSamples * frameSize;
+}
+
+static int AudioRenderSendFrame(const uint8_t *data, uint32_t size)
+{
+    return OHOS::Bluetooth::WriteFrame(data, size);
+}
+
 int32_t AudioRenderStart(AudioHandle handle)
 {
     struct AudioHwRender *hwRender = (struct AudioHwRender *)handle;
@@ -56,11 +100,25 @@ int32_t AudioRenderStart(AudioHandle handle)
         OHOS::Bluetooth::StartPlaying();
     }
 
-    char *buffer = (char *)calloc(1, FRAME_DATA);
+    uint32_t batchSize = AudioRenderGetBatchSize(&hwRender->renderParam.frameRenderMode);
+    uint32_t capacity = batchSize * RENDER_RING_BATCH_COUNT;
+    if (capacity < FRAME_DATA) {
+        capacity = FRAME_DATA;
+    }
+    char *buffer = (char *)calloc(1, capacity);
     if (buffer == NULL) {
         HDF_LOGE("Calloc Render buffer Fail!");
         return AUDIO_HAL_ERR_MALLOC_FAIL;
     }
+    /* count what the previous ring sent before its stats start over */
+    AudioRenderSyncPosition(&hwRender->renderParam.frameRenderMode);
+    if (AudioRenderRingStart(&hwRender->renderParam.frameRenderMode.ring, (uint8_t *)buffer, capacity, batchSize,
+        AudioRenderSendFrame) != HDF_SUCCESS) {
+        HDF_LOGE("Start render ring Fail!");
+        AudioMemFree((void **)&buffer);
+        return AUDIO_HAL_ERR_INTERNAL;
+    }
+    hwRender->renderParam.frameRenderMode.sentBytes = 0;
     hwRender->renderParam.frameRenderMode.buffer = buffer;
     return AUDIO_HAL_SUCCESS;
 }
@@ -73,6 +131,13 @@ int32_t AudioRenderStop(AudioHandle handle)
         return AUDIO_HAL_ERR_INVALID_PARAM;
     }
     if (hwRender->renderParam.frameRenderMode.buffer != NULL) {
+        /* the queued audio was already reported as rendered, send it unless the stream is paused */
+        if (hwRender->renderParam.renderMode.ctlParam.pause) {
+            AudioRenderRingFlush(&hwRender->renderParam.frameRenderMode.ring);
+        } else {
+            AudioRenderRingDrain(&hwRender->renderParam.frameRenderMode.ring);
+        }
+        AudioRenderRingStop(&hwRender->renderParam.frameRenderMode.ring);
         AudioMemFree((void **)&hwRender->renderParam.frameRenderMode.buffer);
     } else {
         HDF_LOGE("Repeat invalid stop operation!");
@@ -103,6 +168,7 @@ int32_t AudioRenderPause(AudioHandle handle)
     }
     
     HDF_LOGI("%s, SuspendPlaying", __func__);
+    AudioRenderRingSetPause(&hwRender->renderParam.frameRenderMode.ring, true);
     if (OHOS::Bluetooth::GetPlayingState() == true) {
         OHOS::Bluetooth::SuspendPlaying();
     }
@@ -127,6 +193,7 @@ int32_t AudioRenderResume(AudioHandle handle)
     if (OHOS::Bluetooth::GetPlayingState() == false) {
         OHOS::Bluetooth::StartPlaying();
     }
+    AudioRenderRingSetPause(&hwRender->renderParam.frameRenderMode.ring, false);
 
     hwRender->renderParam.renderMode.ctlParam.pause = false;
     return AUDIO_HAL_SUCCESS;
@@ -139,7 +206,11 @@ int32_t AudioRenderFlush(AudioHandle handle)
     if (hwRender == NULL) {
         return AUDIO_HAL_ERR_INVALID_PARAM;
     }
-    return AUDIO_HAL_ERR_NOT_SUPPORT;
+    if (hwRender->renderParam.frameRenderMode.buffer == NULL) {
+        return AUDIO_HAL_ERR_NOT_SUPPORT;
+    }
+    AudioRenderRingFlush(&hwRender->renderParam.frameRenderMode.ring);
+    return AUDIO_HAL_SUCCESS;
 }
 
 int32_t AudioRenderGetFrameSize(AudioHandle handle, uint64_t *size)
@@ -166,6 +237,7 @@ int32_t AudioRenderGetFrameCount(AudioHandle handle, uint64_t *count)
     if (hwRender == NULL || count == NULL) {
         return AUDIO_HAL_ERR_INVALID_PARAM;
     }
+    AudioRenderSyncPosition(&hwRender->renderParam.frameRenderMode);
     *count = hwRender->renderParam.frameRenderMode.frames;
     return AUDIO_HAL_SUCCESS;
 }
@@ -274,15 +346,9 @@ int32_t AudioRenderGetLatency(struct AudioRender *render, uint32_t *ms)
     return AUDIO_HAL_SUCCESS;
 }
 
-int32_t AudioRenderRenderFramSplit(struct AudioHwRender *hwRender)
-{
-    return HDF_SUCCESS;
-}
-
 int32_t AudioRenderRenderFrame(struct AudioRender *render, const void *frame,
                                uint64_t requestBytes, uint64_t *replyBytes)
 {
-    HDF_LOGI("AudioRenderRenderFrame");
     struct AudioHwRender *hwRender = reinterpret_cast<struct AudioHwRender *>(render);
     if (hwRender == NULL || frame == NULL || replyBytes == NULL ||
         hwRender->renderParam.frameRenderMode.buffer == NULL) {
@@ -293,36 +359,24 @@ int32_t AudioRenderRenderFrame(struct AudioRender *render, const void *frame,
         HDF_LOGE("Out of FRAME_DATA size!");
         return AUDIO_HAL_ERR_INTERNAL;
     }
-    int32_t ret = memcpy_s(hwRender->renderParam.frameRenderMode.buffer, FRAME_DATA, frame, (uint32_t)requestBytes);
-    if (ret != EOK) {
-        HDF_LOGE("memcpy_s fail");
+    if (hwRender->renderParam.frameRenderMode.attrs.sampleRate == 0) {
+        HDF_LOGE("Divisor cannot be zero!");
+        return AUDIO_HAL_ERR_INTERNAL;
+    }
+    int32_t written = AudioRenderRingWrite(&hwRender->renderParam.frameRenderMode.ring,
+        (const uint8_t *)frame, (uint32_t)requestBytes);
+    if (written < 0) {
         return AUDIO_HAL_ERR_INTERNAL;
     }
-    hwRender->renderParam.frameRenderMode.bufferSize = requestBytes;
+    hwRender->renderParam.frameRenderMode.bufferSize = (uint64_t)written;
     uint32_t frameCount = 0;
-    ret = PcmBytesToFrames(&hwRender->renderParam.frameRenderMode, requestBytes, &frameCount);
+    int32_t ret = PcmBytesToFrames(&hwRender->renderParam.frameRenderMode, (uint64_t)written, &frameCount);
     if (ret != AUDIO_HAL_SUCCESS) {
         return ret;
     }
     hwRender->renderParam.frameRenderMode.bufferFrameSize = (uint64_t)frameCount;
-    if (AudioRenderRenderFramSplit(hwRender) < 0) {
-        return AUDIO_HAL_ERR_INTERNAL;
-    }
-    *replyBytes = requestBytes;
-    hwRender->renderParam.frameRenderMode.frames += hwRender->renderParam.frameRenderMode.bufferFrameSize;
-    if (hwRender->renderParam.frameRenderMode.attrs.sampleRate == 0) {
-        HDF_LOGE("Divisor cannot be zero!");
-        return AUDIO_HAL_ERR_INTERNAL;
-    }
-    if (TimeToAudioTimeStamp(hwRender->renderParam.frameRenderMode.bufferFrameSize,
-        &hwRender->renderParam.frameRenderMode.time,
-        hwRender->renderParam.frameRenderMode.attrs.sampleRate) == HDF_FAILURE) {
-        HDF_LOGE("Frame is NULL");
-        return AUDIO_HAL_ERR_INTERNAL;
-    }
-
-    LOGV("%s, WriteFrame", __func__);
-    return OHOS::Bluetooth::WriteFrame((const uint8_t *)frame, (uint32_t)requestBytes);
+    *replyBytes = (uint64_t)written;
+    return AUDIO_HAL_SUCCESS;
 }
 
 int32_t AudioRenderGetRenderPosition(struct AudioRender *render, uint64_t *frames, struct AudioTimeStamp *time)
@@ -331,6 +385,7 @@ int32_t AudioRenderGetRenderPosition(struct AudioRender *render, uint64_t *frame
     if (impl == NULL || frames == NULL || time == NULL) {
         return AUDIO_HAL_ERR_INVALID_PARAM;
     }
+    AudioRenderSyncPosition(&impl->renderParam.frameRenderMode);
     *frames = impl->renderParam.frameRenderMode.frames;
     *time = impl->renderParam.frameRenderMode.time;
     return AUDIO_HAL_SUCCESS;
@@ -383,6 +438,7 @@ int32_t SetValue(struct ExtraParams mExtraParams, struct AudioHwRender *render)
         render->renderParam.frameRenderMode.attrs.channelCount = mExtraParams.channels;
     }
     if (mExtraParams.flag) {
+        AudioRenderSyncPosition(&render->renderParam.frameRenderMode);
         render->renderParam.frameRenderMode.frames = mExtraParams.frames;
     }
     if (mExtraParams.sampleRate != 0) {
@@ -437,6 +493,7 @@ int32_t AudioRenderGetExtraParams(AudioHandle handle, char *keyValueList, int32_
     if (ret < 0) {
         return AUDIO_HAL_ERR_INTERNAL;
     }
+    AudioRenderSyncPosition(&render->renderParam.frameRenderMode);
     ret = AddElementToList(keyValueList, listLenth, AUDIO_ATTR_PARAM_FRAME_COUNT,
         &render->renderParam.frameRenderMode.frames);
     if (ret < 0) {
@@ -486,6 +543,34 @@ int32_t AudioRenderTurnStandbyMode(AudioHandle handle)
     return AUDIO_HAL_SUCCESS;
 }
 
+static void AudioRenderDumpRingStats(struct AudioHwRender *render, int32_t fd)
+{
+    struct AudioRenderRingStats stats = {0};
+    AudioRenderRingGetStats(&render->renderParam.frameRenderMode.ring, &stats);
+    uint32_t sampleRate = render->renderParam.frameRenderMode.attrs.sampleRate;
+    uint32_t bufferedBytes = AudioRenderRingGetBufferedBytes(&render->renderParam.frameRenderMode.ring);
+    dprintf(fd, "A2DP ring: batch %u bytes, capacity %u bytes, buffered %u bytes\n",
+            render->renderParam.frameRenderMode.ring.batchSize, render->renderParam.frameRenderMode.ring.capacity,
+            bufferedBytes);
+    uint32_t bufferedFrames = 0;
+    uint32_t maxFrames = 0;
+    if (sampleRate != 0 &&
+        PcmBytesToFrames(&render->renderParam.frameRenderMode, bufferedBytes, &bufferedFrames) == HDF_SUCCESS &&
+        PcmBytesToFrames(&render->renderParam.frameRenderMode, stats.bufferedMaxBytes, &maxFrames) == HDF_SUCCESS) {
+        dprintf(fd, "A2DP ring latency: current %u ms, max %u ms\n",
+                (uint32_t)((uint64_t)bufferedFrames * 1000 / sampleRate),
+                (uint32_t)((uint64_t)maxFrames * 1000 / sampleRate));
+    }
+    dprintf(fd, "A2DP ring: written %" PRIu64 ", sent %" PRIu64 " bytes in %" PRIu64 " frames, errors %" PRIu64
+            ", underruns %" PRIu64 ", waits %" PRIu64 ", flushed %" PRIu64 " bytes\n",
+            stats.writeBytes, stats.sendBytes, stats.sendCount, stats.sendErrors, stats.underruns, stats.writeWaits,
+            stats.flushBytes);
+    if (stats.sendCount != 0) {
+        dprintf(fd, "A2DP WriteFrame: avg %" PRIu64 " us, max %u us\n",
+                stats.sendTimeTotalUs / stats.sendCount, stats.sendTimeMaxUs);
+    }
+}
+
 int32_t AudioRenderAudioDevDump(AudioHandle handle, int32_t range, int32_t fd)
 {
     struct AudioHwRender *render = (struct AudioHwRender *)handle;
@@ -493,6 +578,7 @@ int32_t AudioRenderAudioDevDump(AudioHandle handle, int32_t range, int32_t fd)
         return AUDIO_HAL_ERR_INVALID_PARAM;
     }
     dprintf(fd, "%s%d\n", "Number of errors: ", render->errorLog.totalErrors);
+    AudioRenderDumpRingStats(render, fd);
     if (range < RANGE_MIN - 1 || range > RANGE_MAX) {
         dprintf(fd, "%s\n", "Out of range, invalid output");
         return AUDIO_HAL_SUCCESS;
@@ -565,6 +651,10 @@ int32_t AudioRenderDrainBuffer(struct AudioRender *render, AudioDrainNotifyType
     if (pRender == NULL || type == NULL) {
         return AUDIO_HAL_ERR_INVALID_PARAM;
     }
-    return AUDIO_HAL_ERR_NOT_SUPPORT;
+    if (pRender->renderParam.frameRenderMode.buffer == NULL) {
+        return AUDIO_HAL_ERR_NOT_SUPPORT;
+    }
+    AudioRenderRingDrain(&pRender->renderParam.frameRenderMode.ring);
+    return AUDIO_HAL_SUCCESS;
 }
 }
\ No newline at end of file
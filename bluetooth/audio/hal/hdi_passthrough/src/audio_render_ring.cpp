@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "audio_render_ring.h"
+#include <hdf_log.h>
+#include <securec.h>
+#include <time.h>
+#include "audio_internal.h"
+
+namespace OHOS::HDI::Audio_Bluetooth {
+constexpr uint64_t USEC_PER_SEC = 1000000;
+constexpr uint64_t NSEC_PER_USEC = 1000;
+
+static uint64_t AudioRenderRingNowUs(void)
+{
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * USEC_PER_SEC + (uint64_t)ts.tv_nsec / NSEC_PER_USEC;
+}
+
+static bool AudioRenderRingBatchReady(const struct AudioRenderRing *ring)
+{
+    if (ring->paused || ring->dataSize == 0) {
+        return false;
+    }
+    return ring->dataSize >= ring->batchSize || ring->draining;
+}
+
+static const uint8_t *AudioRenderRingPeek(struct AudioRenderRing *ring, uint32_t size)
+{
+    uint32_t contiguous = ring->capacity - ring->readPos;
+    if (contiguous >= size) {
+        return ring->buffer + ring->readPos;
+    }
+    /* the batch wraps around the end of the ring, linearize it for the sender */
+    if (memcpy_s(ring->batchBuffer, ring->batchSize, ring->buffer + ring->readPos, contiguous) != EOK ||
+        memcpy_s(ring->batchBuffer + contiguous, ring->batchSize - contiguous, ring->buffer, size - contiguous) != EOK) {
+        return NULL;
+    }
+    return ring->batchBuffer;
+}
+
+/* the caller holds the mutex, Stop destroys the conditions only once every waiter returned */
+static void AudioRenderRingWait(struct AudioRenderRing *ring, pthread_cond_t *cond)
+{
+    ring->waiters++;
+    pthread_cond_wait(cond, &ring->mutex);
+    ring->waiters--;
+    if (!ring->running) {
+        pthread_cond_broadcast(&ring->spaceCond);
+    }
+}
+
+static void AudioRenderRingUpdateSendStats(struct AudioRenderRing *ring, uint32_t size, int ret, uint64_t costUs)
+{
+    ring->stats.sendCount++;
+    ring->stats.sendTimeTotalUs += costUs;
+    if (costUs > ring->stats.sendTimeMaxUs) {
+        ring->stats.sendTimeMaxUs = (uint32_t)costUs;
+    }
+    if (ret != HDF_SUCCESS) {
+        ring->stats.sendErrors++;
+        return;
+    }
+    ring->stats.sendBytes += size;
+}
+
+static void *AudioRenderRingSendThread(void *arg)
+{
+    struct AudioRenderRing *ring = (struct AudioRenderRing *)arg;
+    pthread_mutex_lock(&ring->mutex);
+    while (ring->running) {
+        if (!AudioRenderRingBatchReady(ring)) {
+            /* an empty ring after the tail was drained is the end of the stream, not an underrun */
+            if (!ring->paused && !ring->draining && !ring->starved && ring->dataSize == 0 &&
+                ring->stats.sendCount > 0) {
+                ring->starved = true;
+                ring->stats.underruns++;
+            }
+            pthread_cond_wait(&ring->dataCond, &ring->mutex);
+            continue;
+        }
+
+        ring->starved = false;
+        uint32_t size = (ring->dataSize < ring->batchSize) ? ring->dataSize : ring->batchSize;
+        const uint8_t *data = AudioRenderRingPeek(ring, size);
+        ring->sending = true;
+        pthread_mutex_unlock(&ring->mutex);
+
+        /* the render caller keeps writing into the free part of the ring while the IPC is in flight */
+        int ret = HDF_FAILURE;
+        uint64_t startUs = AudioRenderRingNowUs();
+        if (data != NULL) {
+            ret = ring->send(data, size);
+        }
+        uint64_t costUs = AudioRenderRingNowUs() - startUs;
+
+        pthread_mutex_lock(&ring->mutex);
+        ring->sending = false;
+        AudioRenderRingUpdateSendStats(ring, size, ret, costUs);
+        ring->readPos = (ring->readPos + size) % ring->capacity;
+        ring->dataSize -= size;
+        pthread_cond_broadcast(&ring->spaceCond);
+    }
+    pthread_mutex_unlock(&ring->mutex);
+    return NULL;
+}
+
+int32_t AudioRenderRingStart(struct AudioRenderRing *ring, uint8_t *buffer, uint32_t capacity, uint32_t batchSize,
+                             AudioRenderRingSend send)
+{
+    if (ring == NULL || buffer == NULL || send == NULL || batchSize == 0 || capacity < batchSize) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)memset_s(ring, sizeof(struct AudioRenderRing), 0, sizeof(struct AudioRenderRing));
+    ring->batchBuffer = (uint8_t *)calloc(1, batchSize);
+    if (ring->batchBuffer == NULL) {
+        HDF_LOGE("calloc render ring batch buffer failed");
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    ring->buffer = buffer;
+    ring->capacity = capacity;
+    ring->batchSize = batchSize;
+    ring->send = send;
+    ring->running = true;
+    pthread_mutex_init(&ring->mutex, NULL);
+    pthread_cond_init(&ring->dataCond, NULL);
+    pthread_cond_init(&ring->spaceCond, NULL);
+
+    if (pthread_create(&ring->thread, NULL, AudioRenderRingSendThread, ring) != 0) {
+        HDF_LOGE("create render ring send thread failed");
+        ring->running = false;
+        pthread_cond_destroy(&ring->spaceCond);
+        pthread_cond_destroy(&ring->dataCond);
+        pthread_mutex_destroy(&ring->mutex);
+        AudioMemFree((void **)&ring->batchBuffer);
+        return HDF_FAILURE;
+    }
+    pthread_setname_np(ring->thread, "a2dp_render");
+    return HDF_SUCCESS;
+}
+
+void AudioRenderRingStop(struct AudioRenderRing *ring)
+{
+    if (ring == NULL || ring->batchBuffer == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&ring->mutex);
+    ring->running = false;
+    pthread_cond_broadcast(&ring->dataCond);
+    pthread_cond_broadcast(&ring->spaceCond);
+    pthread_mutex_unlock(&ring->mutex);
+    pthread_join(ring->thread, NULL);
+
+    /* Write, Flush or Drain may still be blocked on the conditions, let them leave before destroying */
+    pthread_mutex_lock(&ring->mutex);
+    while (ring->waiters > 0) {
+        pthread_cond_wait(&ring->spaceCond, &ring->mutex);
+    }
+    /* the caller drains or flushes first, anything left here was written during the stop */
+    if (ring->dataSize > 0) {
+        HDF_LOGW("render ring stopped with %u bytes queued", ring->dataSize);
+        ring->stats.flushBytes += ring->dataSize;
+        ring->readPos = ring->writePos;
+        ring->dataSize = 0;
+    }
+    pthread_mutex_unlock(&ring->mutex);
+
+    pthread_cond_destroy(&ring->spaceCond);
+    pthread_cond_destroy(&ring->dataCond);
+    pthread_mutex_destroy(&ring->mutex);
+    AudioMemFree((void **)&ring->batchBuffer);
+    ring->buffer = NULL;
+}
+
+int32_t AudioRenderRingWrite(struct AudioRenderRing *ring, const uint8_t *data, uint32_t size)
+{
+    if (ring == NULL || ring->batchBuffer == NULL || data == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    uint32_t written = 0;
+    pthread_mutex_lock(&ring->mutex);
+    while (written < size && ring->running) {
+        uint32_t space = ring->capacity - ring->dataSize;
+        if (space == 0) {
+            if (ring->paused) {
+                break;
+            }
+            ring->stats.writeWaits++;
+            AudioRenderRingWait(ring, &ring->spaceCond);
+            continue;
+        }
+        uint32_t chunk = (size - written < space) ? (size - written) : space;
+        uint32_t first = ring->capacity - ring->writePos;
+        first = (chunk < first) ? chunk : first;
+        (void)memcpy_s(ring->buffer + ring->writePos, ring->capacity - ring->writePos, data + written, first);
+        if (chunk > first) {
+            (void)memcpy_s(ring->buffer, ring->capacity, data + written + first, chunk - first);
+        }
+        ring->writePos = (ring->writePos + chunk) % ring->capacity;
+        ring->dataSize += chunk;
+        written += chunk;
+        if (ring->dataSize > ring->stats.bufferedMaxBytes) {
+            ring->stats.bufferedMaxBytes = ring->dataSize;
+        }
+        pthread_cond_signal(&ring->dataCond);
+    }
+    ring->stats.writeBytes += written;
+    pthread_mutex_unlock(&ring->mutex);
+    return (int32_t)written;
+}
+
+void AudioRenderRingSetPause(struct AudioRenderRing *ring, bool pause)
+{
+    if (ring == NULL || ring->batchBuffer == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&ring->mutex);
+    ring->paused = pause;
+    /* the ring is empty on purpose until the caller writes again */
+    ring->starved = true;
+    pthread_cond_broadcast(&ring->dataCond);
+    pthread_cond_broadcast(&ring->spaceCond);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+void AudioRenderRingFlush(struct AudioRenderRing *ring)
+{
+    if (ring == NULL || ring->batchBuffer == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&ring->mutex);
+    while (ring->running && ring->sending) {
+        AudioRenderRingWait(ring, &ring->spaceCond);
+    }
+    ring->stats.flushBytes += ring->dataSize;
+    ring->readPos = ring->writePos;
+    ring->dataSize = 0;
+    ring->starved = true;
+    pthread_cond_broadcast(&ring->spaceCond);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+void AudioRenderRingDrain(struct AudioRenderRing *ring)
+{
+    if (ring == NULL || ring->batchBuffer == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&ring->mutex);
+    ring->draining = true;
+    pthread_cond_signal(&ring->dataCond);
+    while (ring->running && !ring->paused && (ring->dataSize > 0 || ring->sending)) {
+        AudioRenderRingWait(ring, &ring->spaceCond);
+    }
+    ring->draining = false;
+    ring->starved = true;
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+uint32_t AudioRenderRingGetBufferedBytes(struct AudioRenderRing *ring)
+{
+    if (ring == NULL || ring->batchBuffer == NULL) {
+        return 0;
+    }
+    pthread_mutex_lock(&ring->mutex);
+    uint32_t dataSize = ring->dataSize;
+    pthread_mutex_unlock(&ring->mutex);
+    return dataSize;
+}
+
+void AudioRenderRingGetStats(struct AudioRenderRing *ring, struct AudioRenderRingStats *stats)
+{
+    if (ring == NULL || stats == NULL) {
+        return;
+    }
+    if (ring->batchBuffer == NULL) {
+        *stats = ring->stats;
+        return;
+    }
+    pthread_mutex_lock(&ring->mutex);
+    *stats = ring->stats;
+    pthread_mutex_unlock(&ring->mutex);
+}
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "audio_internal.h"
+#include "audio_render_ring.h"
+
+using namespace std;
+using namespace testing::ext;
+using namespace OHOS::HDI::Audio_Bluetooth;
+namespace {
+const uint32_t WAIT_MS = 2000;
+const uint32_t POLL_MS = 1;
+const uint32_t RING_CAPACITY = 1000;
+const uint32_t RING_BATCH = 256;
+const uint32_t PATTERN_MOD = 251;
+
+/* stands in for WriteFrame: records every byte handed to the A2DP source and can hold the sender in the call */
+mutex g_sendLock;
+condition_variable g_sendCond;
+vector<uint8_t> g_sent;
+bool g_sendBlocked = false;
+bool g_inSend = false;
+
+int FakeSend(const uint8_t *data, uint32_t size)
+{
+    unique_lock<mutex> lock(g_sendLock);
+    g_inSend = true;
+    g_sendCond.notify_all();
+    g_sendCond.wait(lock, [] { return !g_sendBlocked; });
+    g_sent.insert(g_sent.end(), data, data + size);
+    g_inSend = false;
+    g_sendCond.notify_all();
+    return HDF_SUCCESS;
+}
+
+vector<uint8_t> Pattern(uint32_t offset, uint32_t size)
+{
+    vector<uint8_t> data(size);
+    for (uint32_t i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>((offset + i) % PATTERN_MOD);
+    }
+    return data;
+}
+
+template<typename Pred>
+bool WaitFor(Pred pred)
+{
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(WAIT_MS);
+    while (chrono::steady_clock::now() < deadline) {
+        if (pred()) {
+            return true;
+        }
+        this_thread::sleep_for(chrono::milliseconds(POLL_MS));
+    }
+    return false;
+}
+
+class AudioRenderRingTest : public testing::Test {
+public:
+    void SetUp() override;
+    void TearDown() override;
+
+protected:
+    int32_t Write(uint32_t offset, uint32_t size);
+    size_t SentSize();
+    struct AudioRenderRingStats Stats();
+    bool IsRunning();
+
+    vector<uint8_t> buffer_;
+    struct AudioRenderRing ring_;
+};
+
+void AudioRenderRingTest::SetUp()
+{
+    {
+        lock_guard<mutex> lock(g_sendLock);
+        g_sent.clear();
+        g_sendBlocked = false;
+        g_inSend = false;
+    }
+    buffer_.assign(RING_CAPACITY, 0);
+    ASSERT_EQ(AudioRenderRingStart(&ring_, buffer_.data(), RING_CAPACITY, RING_BATCH, FakeSend), HDF_SUCCESS);
+}
+
+void AudioRenderRingTest::TearDown()
+{
+    {
+        lock_guard<mutex> lock(g_sendLock);
+        g_sendBlocked = false;
+        g_sendCond.notify_all();
+    }
+    AudioRenderRingStop(&ring_);
+}
+
+int32_t AudioRenderRingTest::Write(uint32_t offset, uint32_t size)
+{
+    vector<uint8_t> data = Pattern(offset, size);
+    return AudioRenderRingWrite(&ring_, data.data(), size);
+}
+
+size_t AudioRenderRingTest::SentSize()
+{
+    lock_guard<mutex> lock(g_sendLock);
+    return g_sent.size();
+}
+
+struct AudioRenderRingStats AudioRenderRingTest::Stats()
+{
+    struct AudioRenderRingStats stats = {};
+    AudioRenderRingGetStats(&ring_, &stats);
+    return stats;
+}
+
+bool AudioRenderRingTest::IsRunning()
+{
+    pthread_mutex_lock(&ring_.mutex);
+    bool running = ring_.running;
+    pthread_mutex_unlock(&ring_.mutex);
+    return running;
+}
+
+/**
+ * @tc.name: AudioRenderRingWrap001
+ * @tc.desc: writes that do not divide the capacity reach the sender in order across the end of the ring
+ * @tc.type: FUNC
+ */
+HWTEST_F(AudioRenderRingTest, AudioRenderRingWrap001, TestSize.Level1)
+{
+    const uint32_t chunk = 37;
+    const uint32_t total = 10007;
+    uint32_t offset = 0;
+    while (offset < total) {
+        uint32_t size = (total - offset < chunk) ? (total - offset) : chunk;
+        ASSERT_EQ(Write(offset, size), static_cast<int32_t>(size));
+        offset += size;
+    }
+    AudioRenderRingDrain(&ring_);
+
+    EXPECT_EQ(AudioRenderRingGetBufferedBytes(&ring_), 0u);
+    {
+        lock_guard<mutex> lock(g_sendLock);
+        EXPECT_TRUE(g_sent == Pattern(0, total));
+    }
+    struct AudioRenderRingStats stats = Stats();
+    EXPECT_EQ(stats.writeBytes, total);
+    EXPECT_EQ(stats.sendBytes, total);
+    EXPECT_EQ(stats.sendErrors, 0u);
+    EXPECT_LE(stats.bufferedMaxBytes, RING_CAPACITY);
+}
+
+/**
+ * @tc.name: AudioRenderRingUnderrun001
+ * @tc.desc: an empty ring counts as underrun while streaming, not after drain or pause
+ * @tc.type: FUNC
+ */
+HWTEST_F(AudioRenderRingTest, AudioRenderRingUnderrun001, TestSize.Level1)
+{
+    ASSERT_EQ(Write(0, RING_BATCH), static_cast<int32_t>(RING_BATCH));
+    ASSERT_TRUE(WaitFor([this] { return Stats().underruns == 1; }));
+
+    /* a short tail is only sent by drain, the ring is then empty on purpose */
+    ASSERT_EQ(Write(RING_BATCH, RING_BATCH / 2), static_cast<int32_t>(RING_BATCH / 2));
+    AudioRenderRingDrain(&ring_);
+    EXPECT_EQ(SentSize(), RING_BATCH + RING_BATCH / 2);
+
+    AudioRenderRingSetPause(&ring_, true);
+    AudioRenderRingSetPause(&ring_, false);
+    this_thread::sleep_for(chrono::milliseconds(POLL_MS * 10));
+    EXPECT_EQ(Stats().underruns, 1u);
+
+    /* streaming again after the drain runs dry once more */
+    ASSERT_EQ(Write(0, RING_BATCH), static_cast<int32_t>(RING_BATCH));
+    ASSERT_TRUE(WaitFor([this] { return Stats().underruns == 2; }));
+}
+
+/**
+ * @tc.name: AudioRenderRingStop001
+ * @tc.desc: draining before stop sends everything, a restarted ring starts with fresh stats
+ * @tc.type: FUNC
+ */
+HWTEST_F(AudioRenderRingTest, AudioRenderRingStop001, TestSize.Level1)
+{
+    const uint32_t size = 600;
+    ASSERT_EQ(Write(0, size), static_cast<int32_t>(size));
+    AudioRenderRingDrain(&ring_);
+    AudioRenderRingStop(&ring_);
+
+    struct AudioRenderRingStats stats = Stats();
+    EXPECT_EQ(stats.sendBytes, size);
+    EXPECT_EQ(stats.flushBytes, 0u);
+    EXPECT_EQ(SentSize(), size);
+
+    ASSERT_EQ(AudioRenderRingStart(&ring_, buffer_.data(), RING_CAPACITY, RING_BATCH, FakeSend), HDF_SUCCESS);
+    EXPECT_EQ(Stats().writeBytes, 0u);
+    ASSERT_EQ(Write(size, RING_BATCH), static_cast<int32_t>(RING_BATCH));
+    AudioRenderRingDrain(&ring_);
+    EXPECT_EQ(Stats().sendBytes, RING_BATCH);
+    lock_guard<mutex> lock(g_sendLock);
+    EXPECT_TRUE(g_sent == Pattern(0, size + RING_BATCH));
+}
+
+/**
+ * @tc.name: AudioRenderRingStop002
+ * @tc.desc: data queued while paused is counted as flushed, whether flushed explicitly or left to stop
+ * @tc.type: FUNC
+ */
+HWTEST_F(AudioRenderRingTest, AudioRenderRingStop002, TestSize.Level1)
+{
+    const uint32_t size = 600;
+    AudioRenderRingSetPause(&ring_, true);
+    ASSERT_EQ(Write(0, size), static_cast<int32_t>(size));
+    AudioRenderRingFlush(&ring_);
+    EXPECT_EQ(AudioRenderRingGetBufferedBytes(&ring_), 0u);
+    EXPECT_EQ(Stats().flushBytes, size);
+
+    ASSERT_EQ(Write(0, size / 2), static_cast<int32_t>(size / 2));
+    AudioRenderRingStop(&ring_);
+    struct AudioRenderRingStats stats = Stats();
+    EXPECT_EQ(stats.flushBytes, size + size / 2);
+    EXPECT_EQ(stats.sendBytes, 0u);
+    EXPECT_EQ(SentSize(), 0u);
+
+    ASSERT_EQ(AudioRenderRingStart(&ring_, buffer_.data(), RING_CAPACITY, RING_BATCH, FakeSend), HDF_SUCCESS);
+}
+
+/**
+ * @tc.name: AudioRenderRingStop003
+ * @tc.desc: stop releases a writer waiting for space while the sender is still in WriteFrame
+ * @tc.type: FUNC
+ */
+HWTEST_F(AudioRenderRingTest, AudioRenderRingStop003, TestSize.Level1)
+{
+    const uint32_t size = RING_CAPACITY * 4;
+    {
+        lock_guard<mutex> lock(g_sendLock);
+        g_sendBlocked = true;
+    }
+    int32_t written = -1;
+    thread writer([this, &written] { written = Write(0, size); });
+    ASSERT_TRUE(WaitFor([this] { return Stats().writeWaits > 0; }));
+    {
+        unique_lock<mutex> lock(g_sendLock);
+        ASSERT_TRUE(g_sendCond.wait_for(lock, chrono::milliseconds(WAIT_MS), [] { return g_inSend; }));
+    }
+
+    thread stopper([this] { AudioRenderRingStop(&ring_); });
+    ASSERT_TRUE(WaitFor([this] { return !IsRunning(); }));
+    {
+        lock_guard<mutex> lock(g_sendLock);
+        g_sendBlocked = false;
+        g_sendCond.notify_all();
+    }
+    writer.join();
+    stopper.join();
+
+    struct AudioRenderRingStats stats = Stats();
+    EXPECT_GE(written, static_cast<int32_t>(RING_CAPACITY));
+    EXPECT_LT(written, static_cast<int32_t>(size));
+    EXPECT_EQ(stats.writeBytes, static_cast<uint64_t>(written));
+    EXPECT_EQ(stats.writeBytes, stats.sendBytes + stats.flushBytes);
+    EXPECT_EQ(SentSize(), stats.sendBytes);
+
+    ASSERT_EQ(AudioRenderRingStart(&ring_, buffer_.data(), RING_CAPACITY, RING_BATCH, FakeSend), HDF_SUCCESS);
+}
+}
@@ -14,6 +14,7 @@
  */
 
 #include "bt_hci_callbacks_proxy.h"
+#include <algorithm>
 #include <hdf_base.h>
 #include <message_option.h>
 #include <message_parcel.h>
@@ -22,6 +23,9 @@ namespace ohos {
 namespace hardware {
 namespace bt {
 namespace v1_0 {
+constexpr size_t HCI_ASHMEM_THRESHOLD = 1024;
+constexpr size_t HCI_ASHMEM_MIN_SIZE = 16 * 1024;
+
 int32_t BtHciCallbacksProxy::OnInited(BtStatus status)
 {
     MessageParcel data;
@@ -70,6 +74,100 @@ int32_t BtHciCallbacksProxy::OnReceivedHciPacket(BtType type, const std::vector<
 
     return HDF_SUCCESS;
 }
+
+int32_t BtHciCallbacksProxy::OnReceivedHciPackets(BtType type, const std::vector<HciPacketView>& packets)
+{
+    MessageParcel localData;
+    MessageParcel reply;
+    MessageOption option(MessageOption::TF_SYNC);
+
+    if (!localData.WriteInterfaceToken(BtHciCallbacksProxy::GetDescriptor())) {
+        HDF_LOGE("%s: write interface token failed!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    std::vector<uint32_t> sizes;
+    sizes.reserve(packets.size());
+    size_t totalSize = 0;
+    for (auto &packet : packets) {
+        sizes.push_back(packet.size());
+        totalSize += packet.size();
+    }
+    if (!localData.WriteUint32((uint32_t)type) || !localData.WriteUInt32Vector(sizes)) {
+        HDF_LOGE("%s: write type failed!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    /* SCO and ISO streams are passed through shared memory instead of being copied into the parcel. */
+    std::lock_guard<std::mutex> lock(ashmemMutex_);
+    bool ashmem = (type == BtType::SCO_DATA || type == BtType::ISO_DATA) && totalSize >= HCI_ASHMEM_THRESHOLD;
+    bool fresh = false;
+    if (ashmem) {
+        if (!localData.WriteUint32(HCI_PACKETS_TRANSFER_ASHMEM) ||
+            !WritePacketsToAshmem(packets, totalSize, localData, fresh)) {
+            HDF_LOGE("%s: write ashmem failed!", __func__);
+            return HDF_ERR_INVALID_PARAM;
+        }
+    } else {
+        if (!localData.WriteUint32(HCI_PACKETS_TRANSFER_INLINE)) {
+            HDF_LOGE("%s: write transfer failed!", __func__);
+            return HDF_ERR_INVALID_PARAM;
+        }
+        /* back to back, the stub takes them as one buffer */
+        for (auto &packet : packets) {
+            if (!localData.WriteUnpadBuffer(packet.data, packet.size)) {
+                HDF_LOGE("%s: write data failed!", __func__);
+                return HDF_ERR_INVALID_PARAM;
+            }
+        }
+    }
+
+    int32_t ec = Remote()->SendRequest(CMD_ON_RECEIVED_HCI_PACKETS, localData, reply, option);
+    if (ec != HDF_SUCCESS) {
+        HDF_LOGE("OnReceivedHciPackets failed, error code is %d", ec);
+        /* the stub may not have the region, it goes along with the next call again */
+        ashmemShared_ = ashmemShared_ && !fresh;
+        return ec;
+    }
+    ashmemShared_ = ashmemShared_ || fresh;
+
+    return HDF_SUCCESS;
+}
+
+bool BtHciCallbacksProxy::WritePacketsToAshmem(const std::vector<HciPacketView>& packets, size_t totalSize,
+    MessageParcel& data, bool& fresh)
+{
+    if (ashmem_ == nullptr || ashmemSize_ < totalSize) {
+        if (ashmem_ != nullptr) {
+            ashmem_->UnmapAshmem();
+            ashmem_->CloseAshmem();
+            ashmem_ = nullptr;
+        }
+        ashmemShared_ = false;
+        ashmemSize_ = std::max(totalSize, HCI_ASHMEM_MIN_SIZE);
+        ashmem_ = Ashmem::CreateAshmem("bt_hci_packets", ashmemSize_);
+        if (ashmem_ == nullptr || !ashmem_->MapReadAndWriteAshmem()) {
+            HDF_LOGE("%s: create ashmem failed!", __func__);
+            ashmem_ = nullptr;
+            ashmemSize_ = 0;
+            return false;
+        }
+    }
+
+    size_t offset = 0;
+    for (auto &packet : packets) {
+        if (!ashmem_->WriteToAshmem(packet.data, packet.size, offset)) {
+            return false;
+        }
+        offset += packet.size;
+    }
+
+    /* the region is sent once, the stub keeps it mapped for the calls after */
+    fresh = !ashmemShared_;
+    if (!data.WriteBool(fresh)) {
+        return false;
+    }
+    return !fresh || data.WriteAshmem(ashmem_);
+}
 } // v1_0
 } // bt
 } // hardware
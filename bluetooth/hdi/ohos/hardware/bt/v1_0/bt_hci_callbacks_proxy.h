@@ -16,7 +16,9 @@
 #ifndef OHOS_HARDWARE_BT_V1_0_BTHCICALLBACKSPROXY_H
 #define OHOS_HARDWARE_BT_V1_0_BTHCICALLBACKSPROXY_H
 
+#include <ashmem.h>
 #include <iremote_proxy.h>
+#include <mutex>
 #include "ibt_hci_callbacks.h"
 
 namespace ohos {
@@ -36,7 +38,17 @@ public:
 
     int32_t OnReceivedHciPacket(BtType type, const std::vector<uint8_t>& data) override;
 
+    int32_t OnReceivedHciPackets(BtType type, const std::vector<HciPacketView>& packets) override;
+
+private:
+    bool WritePacketsToAshmem(const std::vector<HciPacketView>& packets, size_t totalSize,
+        MessageParcel& data, bool& fresh);
+
 private:
+    std::mutex ashmemMutex_;
+    sptr<Ashmem> ashmem_ = nullptr;
+    size_t ashmemSize_ = 0;
+    bool ashmemShared_ = false;     // the stub has ashmem_ mapped
     static inline BrokerDelegator<BtHciCallbacksProxy> delegator_;
 };
 } // v1_0
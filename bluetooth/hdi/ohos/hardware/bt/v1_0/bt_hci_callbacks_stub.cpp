@@ -22,6 +22,8 @@ namespace ohos {
 namespace hardware {
 namespace bt {
 namespace v1_0 {
+constexpr uint32_t MAX_HCI_PACKETS_PER_CALL = 64;
+
 int32_t BtHciCallbacksStub::OnRemoteRequest(
     uint32_t code, MessageParcel &data, MessageParcel &reply, MessageOption &option)
 {
@@ -37,6 +39,11 @@ int32_t BtHciCallbacksStub::OnRemoteRequest(
                 return HDF_ERR_INVALID_PARAM;
             }
             return BtHciCallbacksStubOnReceivedHciPacket(data, reply, option);
+        case CMD_ON_RECEIVED_HCI_PACKETS:
+            if (data.ReadInterfaceToken() != BtHciCallbacksStub::GetDescriptor()) {
+                return HDF_ERR_INVALID_PARAM;
+            }
+            return BtHciCallbacksStubOnReceivedHciPackets(data, reply, option);
         default: {
             HDF_LOGE("%s: not support cmd %d", __func__, code);
             return IPCObjectStub::OnRemoteRequest(code, data, reply, option);
@@ -75,6 +82,72 @@ int32_t BtHciCallbacksStub::BtHciCallbacksStubOnReceivedHciPacket(
 
     return HDF_SUCCESS;
 }
+
+int32_t BtHciCallbacksStub::BtHciCallbacksStubOnReceivedHciPackets(
+    MessageParcel &data, MessageParcel &reply, MessageOption &option)
+{
+    BtType type = (BtType)data.ReadUint32();
+    std::vector<uint32_t> sizes;
+    if (!data.ReadUInt32Vector(&sizes) || sizes.size() > MAX_HCI_PACKETS_PER_CALL) {
+        HDF_LOGE("%s: invalid packet count", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    size_t totalSize = 0;
+    for (uint32_t size : sizes) {
+        totalSize += size;
+    }
+    uint32_t transfer = data.ReadUint32();
+
+    /* the packets are handed over where they are, in the parcel or in the region */
+    const uint8_t *buffer = nullptr;
+    std::unique_lock<std::mutex> lock(ashmemMutex_, std::defer_lock);
+    if (transfer == HCI_PACKETS_TRANSFER_ASHMEM) {
+        lock.lock();
+        buffer = ReadPacketsFromAshmem(data, totalSize);
+    } else {
+        buffer = data.ReadBuffer(totalSize);
+    }
+    if (buffer == nullptr && totalSize > 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    std::vector<HciPacketView> packets;
+    packets.reserve(sizes.size());
+    for (uint32_t size : sizes) {
+        packets.push_back({buffer, size});
+        buffer += size;
+    }
+
+    int32_t ec = OnReceivedHciPackets(type, packets);
+    if (ec != HDF_SUCCESS) {
+        HDF_LOGE("OnReceivedHciPackets failed, error code is %d", ec);
+        return ec;
+    }
+
+    return HDF_SUCCESS;
+}
+
+const uint8_t *BtHciCallbacksStub::ReadPacketsFromAshmem(MessageParcel &data, size_t totalSize)
+{
+    if (data.ReadBool()) {
+        /* the proxy outgrew the region it sent before */
+        if (ashmem_ != nullptr) {
+            ashmem_->UnmapAshmem();
+            ashmem_->CloseAshmem();
+        }
+        ashmem_ = data.ReadAshmem();
+        if (ashmem_ == nullptr || !ashmem_->MapReadOnlyAshmem()) {
+            HDF_LOGE("%s: map ashmem failed", __func__);
+            ashmem_ = nullptr;
+            return nullptr;
+        }
+    }
+    if (ashmem_ == nullptr || totalSize > static_cast<size_t>(ashmem_->GetAshmemSize())) {
+        HDF_LOGE("%s: no ashmem for %zu bytes", __func__, totalSize);
+        return nullptr;
+    }
+    return reinterpret_cast<const uint8_t *>(ashmem_->ReadFromAshmem(totalSize, 0));
+}
 }  // namespace v1_0
 }  // namespace bt
 }  // namespace hardware
@@ -16,8 +16,10 @@
 #ifndef OHOS_HARDWARE_BT_V1_0_BTHCICALLBACKSSTUB_H
 #define OHOS_HARDWARE_BT_V1_0_BTHCICALLBACKSSTUB_H
 
+#include <ashmem.h>
 #include <message_parcel.h>
 #include <message_option.h>
+#include <mutex>
 #include <refbase.h>
 #include <iremote_stub.h>
 #include "ibt_hci_callbacks.h"
@@ -30,7 +32,13 @@ using namespace OHOS;
 
 class BtHciCallbacksStub : public IRemoteStub<IBtHciCallbacks> {
 public:
-    virtual ~BtHciCallbacksStub() {}
+    virtual ~BtHciCallbacksStub()
+    {
+        if (ashmem_ != nullptr) {
+            ashmem_->UnmapAshmem();
+            ashmem_->CloseAshmem();
+        }
+    }
 
     int32_t OnRemoteRequest(uint32_t code, MessageParcel &data, MessageParcel &reply,
         MessageOption &option) override;
@@ -38,6 +46,14 @@ private:
     int32_t BtHciCallbacksStubOnInited(MessageParcel& data, MessageParcel& reply, MessageOption& option);
 
     int32_t BtHciCallbacksStubOnReceivedHciPacket(MessageParcel& data, MessageParcel& reply, MessageOption& option);
+
+    int32_t BtHciCallbacksStubOnReceivedHciPackets(MessageParcel& data, MessageParcel& reply, MessageOption& option);
+
+    const uint8_t *ReadPacketsFromAshmem(MessageParcel& data, size_t totalSize);
+
+private:
+    std::mutex ashmemMutex_;
+    sptr<Ashmem> ashmem_ = nullptr;     // the region of the proxy, mapped for as long as it is used
 };
 } // v1_0
 } // bt
@@ -19,6 +19,7 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <hdf_base.h>
 #include <hdf_log.h>
 #include <iservmgr_hdi.h>
 #include "ohos/hardware/bt/v1_0/types.h"
@@ -32,6 +33,18 @@ using namespace OHOS;
 enum {
     CMD_ON_INITED,
     CMD_ON_RECEIVED_HCI_PACKET,
+    CMD_ON_RECEIVED_HCI_PACKETS,
+};
+
+enum HciPacketsTransfer : uint32_t {
+    HCI_PACKETS_TRANSFER_INLINE,
+    HCI_PACKETS_TRANSFER_ASHMEM,    // the region of the last call, or a new one that follows
+};
+
+/* A received packet, the data is valid until the callback returns. */
+struct HciPacketView {
+    const uint8_t *data;
+    size_t size;
 };
 
 class IBtHciCallbacks : public IRemoteBroker {
@@ -43,6 +56,18 @@ public:
     virtual int32_t OnInited(BtStatus status) = 0;
 
     virtual int32_t OnReceivedHciPacket(BtType type, const std::vector<uint8_t>& data) = 0;
+
+    /* Several packets of the same type delivered in one transaction, in receive order. */
+    virtual int32_t OnReceivedHciPackets(BtType type, const std::vector<HciPacketView>& packets)
+    {
+        for (auto &packet : packets) {
+            int32_t ret = OnReceivedHciPacket(type, std::vector<uint8_t>(packet.data, packet.data + packet.size));
+            if (ret != HDF_SUCCESS) {
+                return ret;
+            }
+        }
+        return HDF_SUCCESS;
+    }
 };
 } // v1_0
 } // bt
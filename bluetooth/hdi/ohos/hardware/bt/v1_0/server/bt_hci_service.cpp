@@ -15,6 +15,7 @@
 
 #include "bt_hci_service.h"
 #include <hdf_log.h>
+#include "hci_packet_pool.h"
 #include "vendor_interface.h"
 
 namespace ohos {
@@ -23,6 +24,9 @@ namespace bt {
 namespace v1_0 {
 using VendorInterface = OHOS::HDI::BT::V1_0::VendorInterface;
 using HciPacketType = OHOS::HDI::BT::HCI::HciPacketType;
+using HciPacketPool = OHOS::HDI::BT::HCI::HciPacketPool;
+
+constexpr size_t MAX_PENDING_PACKETS = 16;
 
 BtHciService::BtHciService()
 {
@@ -48,14 +52,15 @@ int32_t BtHciService::Init(const sptr<IBtHciCallbacks> &callbacks)
 
     VendorInterface::ReceiveCallback callback = {
         .onAclReceive =
-            [callbacks](
-                const std::vector<uint8_t> &packet) { callbacks->OnReceivedHciPacket(BtType::ACL_DATA, packet); },
+            [this, callbacks](std::vector<uint8_t> &packet) { OnDataReceived(callbacks, BtType::ACL_DATA, packet); },
         .onScoReceive =
-            [callbacks](
-                const std::vector<uint8_t> &packet) { callbacks->OnReceivedHciPacket(BtType::SCO_DATA, packet); },
+            [this, callbacks](std::vector<uint8_t> &packet) { OnDataReceived(callbacks, BtType::SCO_DATA, packet); },
         .onEventReceive =
-            [callbacks](
-                const std::vector<uint8_t> &packet) { callbacks->OnReceivedHciPacket(BtType::HCI_EVENT, packet); },
+            [this, callbacks](std::vector<uint8_t> &packet) {
+                FlushPendingPackets(callbacks);
+                callbacks->OnReceivedHciPacket(BtType::HCI_EVENT, packet);
+            },
+        .onReceiveIdle = [this, callbacks]() { FlushPendingPackets(callbacks); },
     };
 
     bool result = VendorInterface::GetInstance()->Initialize(
@@ -70,12 +75,16 @@ int32_t BtHciService::Init(const sptr<IBtHciCallbacks> &callbacks)
 
 int32_t BtHciService::SendHciPacket(BtType type, const std::vector<uint8_t> &data)
 {
-    HDF_LOGI("%{public}s, ", __func__);
-    if (data.empty()) {
+    return SendHciPacket(type, data.data(), data.size());
+}
+
+int32_t BtHciService::SendHciPacket(BtType type, const uint8_t *data, size_t size)
+{
+    if (data == nullptr || size == 0) {
         return HDF_FAILURE;
     }
 
-    size_t result = VendorInterface::GetInstance()->SendPacket(static_cast<HciPacketType>(type), data);
+    size_t result = VendorInterface::GetInstance()->SendPacket(static_cast<HciPacketType>(type), data, size);
     return result ? HDF_SUCCESS : HDF_FAILURE;
 }
 
@@ -96,6 +105,42 @@ void BtHciService::OnRemoteDied(const wptr<IRemoteObject> &object)
     VendorInterface::GetInstance()->CleanUp();
     VendorInterface::DestroyInstance();
 }
+
+void BtHciService::OnDataReceived(const sptr<IBtHciCallbacks> &callbacks, BtType type, std::vector<uint8_t> &packet)
+{
+    if (!pendingPackets_.empty() && pendingType_ != type) {
+        FlushPendingPackets(callbacks);
+    }
+
+    pendingType_ = type;
+    pendingPackets_.push_back(std::move(packet));
+    if (pendingPackets_.size() >= MAX_PENDING_PACKETS) {
+        FlushPendingPackets(callbacks);
+    }
+}
+
+void BtHciService::FlushPendingPackets(const sptr<IBtHciCallbacks> &callbacks)
+{
+    if (pendingPackets_.empty()) {
+        return;
+    }
+
+    if (pendingPackets_.size() == 1) {
+        callbacks->OnReceivedHciPacket(pendingType_, pendingPackets_.front());
+    } else {
+        std::vector<HciPacketView> packets;
+        packets.reserve(pendingPackets_.size());
+        for (auto &packet : pendingPackets_) {
+            packets.push_back({packet.data(), packet.size()});
+        }
+        callbacks->OnReceivedHciPackets(pendingType_, packets);
+    }
+
+    for (auto &packet : pendingPackets_) {
+        HciPacketPool::GetInstance().Release(std::move(packet));
+    }
+    pendingPackets_.clear();
+}
 }  // namespace v1_0
 }  // namespace bt
 }  // namespace hardware
@@ -17,6 +17,7 @@
 #define OHOS_HARDWARE_BT_V1_0_BTHCISERVICE_H
 
 #include <hdf_base.h>
+#include <vector>
 #include "ibt_hci.h"
 #include "remote_death_recipient.h"
 
@@ -33,13 +34,19 @@ public:
 
     int32_t SendHciPacket(BtType type, const std::vector<uint8_t>& data) override;
 
+    int32_t SendHciPacket(BtType type, const uint8_t *data, size_t size);
+
     int32_t Close() override;
 
 private:
     void OnRemoteDied(const wptr<IRemoteObject> &object);
+    void OnDataReceived(const sptr<IBtHciCallbacks> &callbacks, BtType type, std::vector<uint8_t> &packet);
+    void FlushPendingPackets(const sptr<IBtHciCallbacks> &callbacks);
 
 private:
     sptr<IBtHciCallbacks> callbacks_ = nullptr;
+    BtType pendingType_ = BtType::ACL_DATA;
+    std::vector<std::vector<uint8_t>> pendingPackets_;
     sptr<RemoteDeathRecipient> remoteDeathRecipient_ = nullptr;
 };
 } // v1_0
@@ -56,12 +56,14 @@ int32_t BtHciStub::BtHciStubSendHciPacket(MessageParcel& data, MessageParcel& re
 {
     BtType type = (BtType)data.ReadUint32();
 
-    std::vector<uint8_t> localData;
-    if (!data.ReadUInt8Vector(&localData)) {
+    /* read in place, WriteUInt8Vector puts the count before the bytes and it is the last field */
+    int32_t size = data.ReadInt32();
+    const uint8_t *buffer = (size > 0) ? data.ReadBuffer(size) : nullptr;
+    if (buffer == nullptr) {
         return HDF_ERR_INVALID_PARAM;
     }
 
-    int32_t ec = service_.SendHciPacket(type, localData);
+    int32_t ec = service_.SendHciPacket(type, buffer, size);
     if (ec != HDF_SUCCESS) {
         HDF_LOGE("SendHciPacket failed, error code is %d", ec);
         return ec;
@@ -18,8 +18,12 @@
 #include <cerrno>
 #include <cstring>
 
+#include <sys/ioctl.h>
+
 #include <hdf_log.h>
 
+#include "hci_packet_pool.h"
+
 namespace OHOS {
 namespace HDI {
 namespace BT {
@@ -27,9 +31,11 @@ namespace HCI {
 H4Protocol::H4Protocol(
     int fd, HciDataCallback onAclReceive, HciDataCallback onScoReceive, HciDataCallback onEventReceive)
     : hciFd_(fd), onAclReceive_(onAclReceive), onScoReceive_(onScoReceive), onEventReceive_(onEventReceive)
-{}
+{
+    hciPacket_ = HciPacketPool::GetInstance().Acquire();
+}
 
-ssize_t H4Protocol::SendPacket(HciPacketType packetType, const std::vector<uint8_t> &packetData)
+ssize_t H4Protocol::SendPacket(HciPacketType packetType, const uint8_t *packetData, size_t length)
 {
     uint8_t type = packetType;
     ssize_t writtenNumber = 0;
@@ -39,13 +45,13 @@ ssize_t H4Protocol::SendPacket(HciPacketType packetType, const std::vector<uint8
         return 0;
     } else {
         do {
-            ret = Write(hciFd_, packetData.data() + writtenNumber, packetData.size() - writtenNumber);
+            ret = Write(hciFd_, packetData + writtenNumber, length - writtenNumber);
             if (ret > 0) {
                 writtenNumber += ret;
             } else if (ret < 0) {
                 return ret;
             }
-        } while (static_cast<size_t>(writtenNumber) != packetData.size());
+        } while (static_cast<size_t>(writtenNumber) != length);
     }
 
     return writtenNumber;
@@ -53,55 +59,64 @@ ssize_t H4Protocol::SendPacket(HciPacketType packetType, const std::vector<uint8
 
 void H4Protocol::ReadData(int fd)
 {
-    ssize_t readLen;
-    if (hciPacket_.size() == 0) {
-        readLen = Read(fd, &packetType_, sizeof(packetType_));
-        if (readLen < 0) {
-            HDF_LOGE("read fd[%d] err:%s", fd, strerror(errno));
-            return;
-        } else if (readLen == 0) {
-            HDF_LOGE("read fd[%d] readLen = 0.", fd);
+    // every packet that has arrived is handled in this round, the watcher reports the end of it
+    int available = 0;
+    do {
+        if (!ReadPacketPart(fd)) {
             return;
         }
+    } while (ioctl(fd, FIONREAD, &available) == 0 && available > 0);
+}
 
+bool H4Protocol::ReadPacketPart(int fd)
+{
+    // the header and the payload are read straight to where they go in the packet
+    bool typeRead = hciPacket_.size() == 0;
+    uint8_t *data = typeRead ? &packetType_ : hciPacket_.data() + readLength_;
+    size_t length = typeRead ? sizeof(packetType_) : hciPacket_.size() - readLength_;
+    ssize_t readLen = Read(fd, data, length);
+    if (readLen < 0) {
+        HDF_LOGE("read fd[%d] err:%s", fd, strerror(errno));
+        return false;
+    } else if (readLen == 0) {
+        HDF_LOGE("read fd[%d] readLen = 0.", fd);
+        return false;
+    }
+
+    if (typeRead) {
         if (packetType_ > HCI_PACKET_TYPE_UNKNOWN && packetType_ < HCI_PACKET_TYPE_MAX) {
             hciPacket_.resize(header_[packetType_].headerSize);
+        } else {
+            HDF_LOGE("packet type[%d] error.", packetType_);
         }
-    } else if (hciPacket_.size() == header_[packetType_].headerSize) {
-        readLen = Read(fd, hciPacket_.data() + readLength_, hciPacket_.size() - readLength_);
-        if (readLen < 0) {
-            HDF_LOGE("read fd[%d] err:%s", fd, strerror(errno));
-            return;
-        } else if (readLen == 0) {
-            HDF_LOGE("read fd[%d] readLen = 0.", fd);
-            return;
-        }
+        return true;
+    }
 
-        readLength_ += readLen;
-        if (readLength_ == hciPacket_.size()) {
-            size_t dataLen = 0;
-            for (int ii = 0; ii < header_[packetType_].dataLengthSize; ii++) {
-                dataLen += (hciPacket_[header_[packetType_].dataLengthOffset + ii] << (ii * 0x08));
-            }
-            hciPacket_.resize(hciPacket_.size() + dataLen);
+    readLength_ += readLen;
+    if (readLength_ < hciPacket_.size()) {
+        return true;
+    }
+
+    if (!headerReceived_) {
+        size_t dataLen = 0;
+        for (int ii = 0; ii < header_[packetType_].dataLengthSize; ii++) {
+            dataLen += (hciPacket_[header_[packetType_].dataLengthOffset + ii] << (ii * 0x08));
         }
-    } else {
-        readLen = Read(fd, hciPacket_.data() + readLength_, hciPacket_.size() - readLength_);
-        if (readLen < 0) {
-            HDF_LOGE("read fd[%d] err:%s", fd, strerror(errno));
-            return;
-        } else if (readLen == 0) {
-            HDF_LOGE("read fd[%d] readLen = 0.", fd);
-            return;
+        headerReceived_ = true;
+        if (dataLen > 0) {
+            hciPacket_.resize(hciPacket_.size() + dataLen);
+            return true;
         }
+    }
 
-        readLength_ += readLen;
-        if (readLength_ == hciPacket_.size()) {
-            PacketCallback();
-            hciPacket_.clear();
-            readLength_ = 0;
-        }
+    PacketCallback();
+    if (hciPacket_.capacity() == 0) {
+        hciPacket_ = HciPacketPool::GetInstance().Acquire();
     }
+    hciPacket_.clear();
+    readLength_ = 0;
+    headerReceived_ = false;
+    return true;
 }
 
 void H4Protocol::PacketCallback()
@@ -26,10 +26,12 @@ class H4Protocol : public HciProtocol {
 public:
     H4Protocol(int fd, HciDataCallback onAclReceive, HciDataCallback onScoReceive, HciDataCallback onEventReceive);
 
-    ssize_t SendPacket(HciPacketType packetType, const std::vector<uint8_t> &packetData) override;
+    using HciProtocol::SendPacket;
+    ssize_t SendPacket(HciPacketType packetType, const uint8_t *packetData, size_t length) override;
     void ReadData(int fd);
 
 private:
+    bool ReadPacketPart(int fd);
     void PacketCallback();
 
 private:
@@ -41,6 +43,7 @@ private:
     uint8_t packetType_ = 0;
     std::vector<uint8_t> hciPacket_;
     uint32_t readLength_ = 0;
+    bool headerReceived_ = false;
 };
 }  // namespace HCI
 }  // namespace BT
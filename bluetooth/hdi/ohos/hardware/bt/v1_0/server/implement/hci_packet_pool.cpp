@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci_packet_pool.h"
+
+namespace OHOS {
+namespace HDI {
+namespace BT {
+namespace HCI {
+constexpr size_t PACKET_POOL_MAX_COUNT = 32;
+constexpr size_t PACKET_RESERVE_SIZE = 1024;
+constexpr size_t PACKET_MAX_CAPACITY = 4096;
+
+HciPacketPool &HciPacketPool::GetInstance()
+{
+    static HciPacketPool instance;
+    return instance;
+}
+
+std::vector<uint8_t> HciPacketPool::Acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!freePackets_.empty()) {
+            std::vector<uint8_t> packet = std::move(freePackets_.back());
+            freePackets_.pop_back();
+            return packet;
+        }
+    }
+
+    std::vector<uint8_t> packet;
+    packet.reserve(PACKET_RESERVE_SIZE);
+    return packet;
+}
+
+void HciPacketPool::Release(std::vector<uint8_t> &&packet)
+{
+    if (packet.capacity() == 0 || packet.capacity() > PACKET_MAX_CAPACITY) {
+        return;
+    }
+    packet.clear();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (freePackets_.size() < PACKET_POOL_MAX_COUNT) {
+        freePackets_.push_back(std::move(packet));
+    }
+}
+}  // namespace HCI
+}  // namespace BT
+}  // namespace HDI
+}  // namespace OHOS
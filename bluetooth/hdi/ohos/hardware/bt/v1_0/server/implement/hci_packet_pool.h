@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BT_HAL_HCI_PACKET_POOL_H
+#define BT_HAL_HCI_PACKET_POOL_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace OHOS {
+namespace HDI {
+namespace BT {
+namespace HCI {
+class HciPacketPool {
+public:
+    static HciPacketPool &GetInstance();
+
+    std::vector<uint8_t> Acquire();
+    void Release(std::vector<uint8_t> &&packet);
+
+private:
+    HciPacketPool() = default;
+    ~HciPacketPool() = default;
+
+    std::mutex mutex_;
+    std::vector<std::vector<uint8_t>> freePackets_;
+};
+}  // namespace HCI
+}  // namespace BT
+}  // namespace HDI
+}  // namespace OHOS
+#endif /* BT_HAL_HCI_PACKET_POOL_H */
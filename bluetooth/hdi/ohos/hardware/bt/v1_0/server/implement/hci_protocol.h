@@ -17,6 +17,7 @@
 #define BT_HAL_HCI_PROTOCOL_H
 
 #include <cstdio>
+#include <functional>
 #include <vector>
 
 #include "hci_internal.h"
@@ -27,12 +28,17 @@ namespace BT {
 namespace HCI {
 class HciProtocol {
 public:
-    using HciDataCallback = std::function<void(const std::vector<uint8_t> &data)>;
+    /* The receiver may take the packet buffer by moving from data, it is refilled from HciPacketPool. */
+    using HciDataCallback = std::function<void(std::vector<uint8_t> &data)>;
 
     HciProtocol() = default;
     virtual ~HciProtocol() = default;
 
-    virtual ssize_t SendPacket(HciPacketType packetType, const std::vector<uint8_t> &packetData) = 0;
+    virtual ssize_t SendPacket(HciPacketType packetType, const uint8_t *packetData, size_t length) = 0;
+    ssize_t SendPacket(HciPacketType packetType, const std::vector<uint8_t> &packetData)
+    {
+        return SendPacket(packetType, packetData.data(), packetData.size());
+    }
 
     const PacketHeader& GetPacketHeaderInfo(HciPacketType packetType);
 
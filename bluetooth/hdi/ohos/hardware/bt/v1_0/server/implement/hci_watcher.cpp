@@ -60,6 +60,13 @@ bool HciWatcher::SetTimeout(std::chrono::milliseconds timeout, TimeoutCallback c
     return true;
 }
 
+bool HciWatcher::SetIdleCallback(IdleCallback callback)
+{
+    std::lock_guard<std::mutex> lock(fdsMutex_);
+    idleCallback_ = callback;
+    return true;
+}
+
 bool HciWatcher::Start()
 {
     if (running_.exchange(true)) {
@@ -147,11 +154,19 @@ void HciWatcher::WatcherThread()
                 uint8_t buff;
                 TEMP_FAILURE_RETRY(read(wakeupPipe_[0], &buff, sizeof(buff)));
             }
-            std::lock_guard<std::mutex> lock(fdsMutex_);
-            for (auto &&fd : fds_) {
-                if (FD_ISSET(fd.first, &readFds)) {
-                    fd.second(fd.first);
+            IdleCallback idleCallback;
+            {
+                std::lock_guard<std::mutex> lock(fdsMutex_);
+                for (auto &&fd : fds_) {
+                    if (FD_ISSET(fd.first, &readFds)) {
+                        fd.second(fd.first);
+                    }
                 }
+                idleCallback = idleCallback_;
+            }
+            // it may call into the client, which must not keep the fds from being changed
+            if (idleCallback) {
+                idleCallback();
             }
         }
     }
@@ -32,6 +32,7 @@ class HciWatcher {
 public:
     using HciDataCallback = std::function<void(int fd)>;
     using TimeoutCallback = std::function<void()>;
+    using IdleCallback = std::function<void()>;
 
     HciWatcher();
     ~HciWatcher();
@@ -39,6 +40,7 @@ public:
     bool AddFdToWatcher(int fd, HciDataCallback callback);
     bool RemoveFdToWatcher(int fd);
     bool SetTimeout(std::chrono::milliseconds timeout, TimeoutCallback callback);
+    bool SetIdleCallback(IdleCallback callback);
     bool Start();
     bool Stop();
 
@@ -49,6 +51,7 @@ private:
 private:
     std::atomic_bool running_ = {false};
     std::map<int, HciDataCallback> fds_;
+    IdleCallback idleCallback_;
     std::mutex fdsMutex_;
     int wakeupPipe_[2] = {0};
     timeval timeoutTimer_ = {};
@@ -20,6 +20,8 @@
 
 #include <hdf_log.h>
 
+#include "hci_packet_pool.h"
+
 namespace OHOS {
 namespace HDI {
 namespace BT {
@@ -33,16 +35,24 @@ MctProtocol::MctProtocol(int fds[HCI_MAX_CHANNEL], HciDataCallback onAclReceive,
     onAclReceive_ = onAclReceive;
     onScoReceive_ = onScoReceive;
     onEventReceive_ = onEventReceive;
+    ResetPacket(aclPacket_, HCI_PACKET_TYPE_ACL_DATA);
+    ResetPacket(eventPacket_, HCI_PACKET_TYPE_EVENT);
 }
 
-ssize_t MctProtocol::SendPacket(HciPacketType packetType, const std::vector<uint8_t> &packetData)
+void MctProtocol::ResetPacket(std::vector<uint8_t> &packet, HciPacketType packetType)
 {
-    uint8_t type = packetType;
+    if (packet.capacity() == 0) {
+        packet = HciPacketPool::GetInstance().Acquire();
+    }
+    packet.resize(header_[packetType].headerSize);
+}
 
+ssize_t MctProtocol::SendPacket(HciPacketType packetType, const uint8_t *packetData, size_t length)
+{
     if (packetType == HciPacketType::HCI_PACKET_TYPE_COMMAND) {
-        return Write(hciFds_[hci_channels_t::HCI_CMD], &type, sizeof(type));
+        return Write(hciFds_[hci_channels_t::HCI_CMD], packetData, length);
     } else if (packetType == HciPacketType::HCI_PACKET_TYPE_ACL_DATA) {
-        return Write(hciFds_[hci_channels_t::HCI_ACL_OUT], &type, sizeof(type));
+        return Write(hciFds_[hci_channels_t::HCI_ACL_OUT], packetData, length);
     }
 
     return 0;
@@ -82,7 +92,7 @@ void MctProtocol::ReadEventData(int fd)
             if (onEventReceive_) {
                 onEventReceive_(eventPacket_);
             }
-            eventPacket_.resize(header_[HCI_PACKET_TYPE_EVENT].headerSize);
+            ResetPacket(eventPacket_, HCI_PACKET_TYPE_EVENT);
             eventReadLength_ = 0;
         }
     }
@@ -122,7 +132,7 @@ void MctProtocol::ReadAclData(int fd)
             if (onAclReceive_) {
                 onAclReceive_(aclPacket_);
             }
-            aclPacket_.resize(header_[HCI_PACKET_TYPE_ACL_DATA].headerSize);
+            ResetPacket(aclPacket_, HCI_PACKET_TYPE_ACL_DATA);
             aclReadLength_ = 0;
         }
     }
@@ -28,10 +28,14 @@ class MctProtocol : public HciProtocol {
 public:
     MctProtocol(int fds[HCI_MAX_CHANNEL], HciDataCallback onAclReceive, HciDataCallback onScoReceive,
         HciDataCallback onEventReceive);
-    ssize_t SendPacket(HciPacketType packetType, const std::vector<uint8_t> &packetData) override;
+    using HciProtocol::SendPacket;
+    ssize_t SendPacket(HciPacketType packetType, const uint8_t *packetData, size_t length) override;
     void ReadEventData(int fd);
     void ReadAclData(int fd);
 
+private:
+    static void ResetPacket(std::vector<uint8_t> &packet, HciPacketType packetType);
+
 private:
     int hciFds_[HCI_MAX_CHANNEL] = {0};
     HciDataCallback onAclReceive_;
@@ -75,6 +75,7 @@ bool VendorInterface::WatchHciChannel(const ReceiveCallback &receiveCallback)
             channel[hci_channels_t::HCI_EVT], std::bind(&HCI::MctProtocol::ReadEventData, mct, std::placeholders::_1));
         hci_ = mct;
     }
+    watcher_.SetIdleCallback(receiveCallback.onReceiveIdle);
 
     return true;
 }
@@ -152,6 +153,11 @@ void VendorInterface::CleanUp()
 }
 
 size_t VendorInterface::SendPacket(HCI::HciPacketType type, const std::vector<uint8_t> &packet)
+{
+    return SendPacket(type, packet.data(), packet.size());
+}
+
+size_t VendorInterface::SendPacket(HCI::HciPacketType type, const uint8_t *packet, size_t length)
 {
     {
         std::lock_guard<std::mutex> lock(wakeupMutex_);
@@ -163,7 +169,7 @@ size_t VendorInterface::SendPacket(HCI::HciPacketType type, const std::vector<ui
         }
     }
 
-    return hci_->SendPacket(type, packet);
+    return hci_->SendPacket(type, packet, length);
 }
 
 void VendorInterface::OnInitCallback(bt_op_result_t result)
@@ -208,11 +214,10 @@ size_t VendorInterface::OnCmdXmitCallback(uint16_t opcode, void *buf)
 
     VendorInterface::GetInstance()->vendorSentOpcode_ = opcode;
 
-    return VendorInterface::GetInstance()->SendPacket(
-        HCI::HCI_PACKET_TYPE_COMMAND, std::vector<uint8_t>(hdr->data, hdr->data + hdr->len));
+    return VendorInterface::GetInstance()->SendPacket(HCI::HCI_PACKET_TYPE_COMMAND, hdr->data, hdr->len);
 }
 
-void VendorInterface::OnEventReceived(const std::vector<uint8_t> &data)
+void VendorInterface::OnEventReceived(std::vector<uint8_t> &data)
 {
     if (data[0] == HCI::HCI_EVENT_CODE_VENDOR_SPECIFIC) {
         size_t buffSize = sizeof(HC_BT_HDR) + data.size();
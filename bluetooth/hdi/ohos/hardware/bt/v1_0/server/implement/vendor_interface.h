@@ -34,15 +34,18 @@ class VendorInterface : public DelayedSingleton<VendorInterface> {
 public:
     using InitializeCompleteCallback = std::function<void(bool isSuccess)>;
     using ReceiveDataCallback = HCI::HciProtocol::HciDataCallback;
+    using ReceiveIdleCallback = HciWatcher::IdleCallback;
     struct ReceiveCallback {
         ReceiveDataCallback onAclReceive;
         ReceiveDataCallback onScoReceive;
         ReceiveDataCallback onEventReceive;
+        ReceiveIdleCallback onReceiveIdle;
     };
 
     bool Initialize(InitializeCompleteCallback initializeCompleteCallback, const ReceiveCallback &receiveCallback);
     void CleanUp();
     size_t SendPacket(HCI::HciPacketType type, const std::vector<uint8_t> &packet);
+    size_t SendPacket(HCI::HciPacketType type, const uint8_t *packet, size_t length);
 
 private:
     static void OnInitCallback(bt_op_result_t result);
@@ -50,7 +53,7 @@ private:
     static void OnFreeCallback(void* buf);
     static size_t OnCmdXmitCallback(uint16_t opcode, void* buf);
 
-    void OnEventReceived(const std::vector<uint8_t> &data);
+    void OnEventReceived(std::vector<uint8_t> &data);
     bool WatchHciChannel(const ReceiveCallback &receiveCallback);
     void WatcherTimeout();
 
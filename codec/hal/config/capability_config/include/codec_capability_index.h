@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRIVERS_PERIPHERAL_CODEC_CAPABILITY_INDEX_H_
+#define DRIVERS_PERIPHERAL_CODEC_CAPABILITY_INDEX_H_
+
+#include "config_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CODEC_CAPABILITY_FLAG_HARDWARE  0
+#define CODEC_CAPABILITY_FLAG_SOFTWARE  1
+
+typedef struct {
+    CodecCapbility *capability;
+    uint32_t flags;     // CODEC_CAPABILITY_FLAG_HARDWARE or CODEC_CAPABILITY_FLAG_SOFTWARE
+} CodecCapabilityRef;
+
+typedef struct {
+    int32_t num;
+    CodecCapabilityRef *table;      // in the order of enumeration
+    int32_t keyNum;
+    CodecCapabilityRef *sorted;     // by flags, mime and type, one per key, the one GetCapability used to find
+} CodecCapabilityIndex;
+
+/* The index points into caps, it is built again whenever caps is loaded or cleared. */
+int32_t BuildCapabilityIndex(CodecCapablites *caps, CodecCapabilityIndex *index);
+void ClearCapabilityIndex(CodecCapabilityIndex *index);
+CodecCapbility *EnumerateCapabilityIndex(const CodecCapabilityIndex *index, int32_t cursor);
+/* flags of 0 looks for a hardware codec, any other value for a software one. */
+CodecCapbility *LookupCapabilityIndex(const CodecCapabilityIndex *index,
+    AvCodecMime mime, CodecType type, uint32_t flags);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif  // DRIVERS_PERIPHERAL_CODEC_CAPABILITY_INDEX_H_
@@ -25,10 +25,28 @@
 extern "C" {
 #endif /* __cplusplus */
 
+typedef struct {
+    uint32_t flags;     // 0 for a hardware codec, 1 for a software one
+    CodecCapbility capability;
+} CodecCapabilityEntry;
+
+/* All capabilities of the service in the order of EnumrateCapability, zero it before the first use. */
+typedef struct {
+    uint32_t version;
+    int32_t num;
+    CodecCapabilityEntry *entries;
+} CodecCapabilityTable;
+
 struct HdfRemoteService *GetConfigService(void);
 int32_t EnumrateCapability(struct HdfRemoteService *remote, int index, CodecCapbility *cap);
 int32_t GetCapability(struct HdfRemoteService *remote,
     AvCodecMime mime, CodecType type, uint32_t flags, CodecCapbility *cap);
+/* Takes the whole table in one request, table is kept as it is while its version is the one of the service. */
+int32_t GetAllCapabilities(struct HdfRemoteService *remote, CodecCapabilityTable *table);
+/* Looks up table the way GetCapability does on the service. */
+int32_t FindCapability(const CodecCapabilityTable *table,
+    AvCodecMime mime, CodecType type, uint32_t flags, CodecCapbility *cap);
+void ReleaseCapabilityTable(CodecCapabilityTable *table);
 
 #ifdef __cplusplus
 }
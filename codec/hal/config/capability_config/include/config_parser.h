@@ -57,7 +57,8 @@
 
 typedef enum {
     CODEC_CONFIG_CMD_ENUMERATE_CAP,
-    CODEC_CONFIG_CMD_GET_CAP
+    CODEC_CONFIG_CMD_GET_CAP,
+    CODEC_CONFIG_CMD_GET_ALL_CAP
 } CodecInterfaceCmd;
 
 typedef struct {
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include <time.h>
 #include <hdf_sbuf.h>
 #include <hdf_device_desc.h>
 #include <hdf_device_object.h>
@@ -20,12 +21,18 @@
 #include "hdf_log.h"
 #include "codec_type.h"
 #include "config_parser.h"
+#include "codec_capability_index.h"
 #include "codec_utils.h"
 
 #define HDF_LOG_TAG "codec_config_service"
 
 static CodecCapablites codecCapabilites = {0};
 static const struct DeviceResourceNode *resourceNode;
+static CodecCapabilityIndex capabilityIndex = {0};
+// changes on every load, clients keep what they got from CODEC_CONFIG_CMD_GET_ALL_CAP while it holds
+static uint32_t capabilityVersion = 0;
+// the HCS does not change while the service runs, a load that failed is not tried again on every request
+static bool capabilityLoaded = false;
 
 static int32_t SerializeCapAlignment(struct HdfSBuf *reply, Alignment *alignment)
 {
@@ -134,65 +141,43 @@ static int32_t SerializeCodecCapbility(struct HdfSBuf *reply, CodecCapbility *ca
 
 static int32_t EnumrateCapablity(int32_t index, CodecCapbility **capability)
 {
-    int32_t loopIndex;
-    int32_t cursor = index;
-    CodecCapablityGroup *codeCapGroups[] = {&(codecCapabilites.videoHwEncoderGroup),
-                                            &(codecCapabilites.videoHwDecoderGroup),
-                                            &(codecCapabilites.videoSwEncoderGroup),
-                                            &(codecCapabilites.videoSwDecoderGroup),
-                                            &(codecCapabilites.audioHwEncoderGroup),
-                                            &(codecCapabilites.audioHwDecoderGroup),
-                                            &(codecCapabilites.audioSwEncoderGroup),
-                                            &(codecCapabilites.audioSwDecoderGroup)};
-
-    for (loopIndex = 0; loopIndex < CODEC_CAPABLITY_GROUP_NUM; loopIndex++) {
-        if (cursor + 1 <= codeCapGroups[loopIndex]->num) {
-            *capability = &(codeCapGroups[loopIndex]->capablitis[cursor]);
-            return HDF_SUCCESS;
-        } else {
-            cursor -= codeCapGroups[loopIndex]->num;
-        }
+    CodecCapbility *cap = EnumerateCapabilityIndex(&capabilityIndex, index);
+    if (cap == NULL) {
+        return HDF_FAILURE;
     }
-
-    return HDF_FAILURE;
+    *capability = cap;
+    return HDF_SUCCESS;
 }
 
 static int32_t GetCapability(AvCodecMime mime, CodecType type, uint32_t flag, CodecCapbility **capability)
 {
-    int32_t groupIndex;
-    int32_t capIndex;
-    CodecCapablityGroup *group;
-    CodecCapbility *cap;
-    bool flagMatched = false;
-    CodecCapablityGroup *codeCapGroups[] = {&(codecCapabilites.videoHwEncoderGroup),
-                                            &(codecCapabilites.videoHwDecoderGroup),
-                                            &(codecCapabilites.audioHwEncoderGroup),
-                                            &(codecCapabilites.audioHwDecoderGroup),
-                                            &(codecCapabilites.videoSwEncoderGroup),
-                                            &(codecCapabilites.videoSwDecoderGroup),
-                                            &(codecCapabilites.audioSwEncoderGroup),
-                                            &(codecCapabilites.audioSwDecoderGroup)};
-    const int32_t hardAndSoftSplitNumber = 4;
-
-    for (groupIndex = 0; groupIndex < CODEC_CAPABLITY_GROUP_NUM; groupIndex++) {
-        group = codeCapGroups[groupIndex];
-        for (capIndex = 0; capIndex < group->num; capIndex++) {
-            cap = &group->capablitis[capIndex];
-            flagMatched = flag == 0 ? groupIndex < hardAndSoftSplitNumber : groupIndex >= hardAndSoftSplitNumber;
-            if (mime == cap->mime && type == cap->type && flagMatched) {
-                *capability = &group->capablitis[capIndex];
-                return HDF_SUCCESS;
-            }
-        }
+    CodecCapbility *cap = LookupCapabilityIndex(&capabilityIndex, mime, type, flag);
+    if (cap == NULL) {
+        return HDF_FAILURE;
     }
-
-    return HDF_FAILURE;
+    *capability = cap;
+    return HDF_SUCCESS;
 }
 
 static int32_t ReloadCapabilities()
 {
+    capabilityLoaded = true;
+    ClearCapabilityIndex(&capabilityIndex);
     ClearCapabilityGroup(&codecCapabilites);
-    LoadCodecCapabilityFromHcs(resourceNode, &codecCapabilites);
+    if (LoadCodecCapabilityFromHcs(resourceNode, &codecCapabilites) != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s: load capabilities failed!", __func__);
+        ClearCapabilityGroup(&codecCapabilites);
+        return HDF_FAILURE;
+    }
+    if (BuildCapabilityIndex(&codecCapabilites, &capabilityIndex) != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s: build capability index failed!", __func__);
+        ClearCapabilityGroup(&codecCapabilites);
+        return HDF_FAILURE;
+    }
+    capabilityVersion++;
+    if (capabilityVersion == 0) {
+        capabilityVersion++;
+    }
     return HDF_SUCCESS;
 }
 
@@ -255,6 +240,47 @@ static int32_t HandleGetCmd(struct HdfSBuf *data, struct HdfSBuf *reply)
     return HDF_SUCCESS;
 }
 
+static int32_t HandleGetAllCmd(struct HdfSBuf *data, struct HdfSBuf *reply)
+{
+    uint32_t knownVersion;
+    if (!HdfSbufReadUint32(data, &knownVersion)) {
+        HDF_LOGE("%{public}s: read known version failed!", __func__);
+        return HDF_FAILURE;
+    }
+    if (!codecCapabilites.inited) {
+        return HDF_FAILURE;
+    }
+    if (!HdfSbufWriteUint32(reply, capabilityVersion)) {
+        HDF_LOGE("%{public}s: write version failed!", __func__);
+        return HDF_FAILURE;
+    }
+    if (knownVersion == capabilityVersion) {
+        return HDF_SUCCESS;
+    }
+
+    int32_t num = 0;
+    for (int32_t i = 0; i < capabilityIndex.num; i++) {
+        num += capabilityIndex.table[i].capability->mime == MEDIA_MIMETYPE_INVALID ? 0 : 1;
+    }
+    if (!HdfSbufWriteInt32(reply, num)) {
+        HDF_LOGE("%{public}s: write num failed!", __func__);
+        return HDF_FAILURE;
+    }
+    for (int32_t i = 0; i < capabilityIndex.num; i++) {
+        CodecCapabilityRef *ref = &capabilityIndex.table[i];
+        if (ref->capability->mime == MEDIA_MIMETYPE_INVALID) {
+            continue;
+        }
+        if (!HdfSbufWriteUint32(reply, ref->flags) ||
+            SerializeCodecCapbility(reply, ref->capability) != HDF_SUCCESS) {
+            HDF_LOGE("%{public}s: write capbility to sbuf failed!", __func__);
+            return HDF_FAILURE;
+        }
+    }
+
+    return HDF_SUCCESS;
+}
+
 static int32_t CodecCapabilityDispatch(struct HdfDeviceIoClient *client, int id,
     struct HdfSBuf *data, struct HdfSBuf *reply)
 {
@@ -268,7 +294,7 @@ static int32_t CodecCapabilityDispatch(struct HdfDeviceIoClient *client, int id,
         HDF_LOGE("check interface token failed");
         return HDF_ERR_INVALID_PARAM;
     }
-    if (!codecCapabilites.inited) {
+    if (!capabilityLoaded) {
         ReloadCapabilities();
     }
 
@@ -283,6 +309,11 @@ static int32_t CodecCapabilityDispatch(struct HdfDeviceIoClient *client, int id,
             break;
         }
 
+        case CODEC_CONFIG_CMD_GET_ALL_CAP: {
+            result = HandleGetAllCmd(data, reply);
+            break;
+        }
+
         default:
             break;
     }
@@ -310,14 +341,15 @@ static int32_t CodecCapabilityInit(struct HdfDeviceObject *deviceObject)
         return HDF_FAILURE;
     }
     resourceNode = deviceObject->property;
-    if (LoadCodecCapabilityFromHcs(deviceObject->property, &codecCapabilites) != HDF_SUCCESS) {
-        ClearCapabilityGroup(&codecCapabilites);
-    }
+    // a restarted service does not start from a version a client may still hold
+    capabilityVersion = (uint32_t)time(NULL);
+    ReloadCapabilities();
     return HDF_SUCCESS;
 }
 
 static void CodecCapabilityRelease(struct HdfDeviceObject *deviceObject)
 {
+    ClearCapabilityIndex(&capabilityIndex);
     ClearCapabilityGroup(&codecCapabilites);
     return;
 }
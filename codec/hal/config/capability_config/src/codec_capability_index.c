@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec_capability_index.h"
+#include <stdlib.h>
+#include <osal_mem.h>
+#include "hdf_base.h"
+#include "hdf_log.h"
+
+#define HDF_LOG_TAG "codec_capability_index"
+
+#define HARDWARE_GROUP_NUM  4
+
+typedef struct {
+    CodecCapabilityRef ref;
+    int32_t order;      // position in the lookup order, the first one of a key wins
+} CodecCapabilityKey;
+
+static int32_t GetGroupNum(const CodecCapablityGroup *group)
+{
+    return group->capablitis == NULL ? 0 : group->num;
+}
+
+static int32_t CompareKey(uint32_t flags, AvCodecMime mime, CodecType type, const CodecCapabilityRef *ref)
+{
+    if (flags != ref->flags) {
+        return flags < ref->flags ? -1 : 1;
+    }
+    if (mime != ref->capability->mime) {
+        return (uint32_t)mime < (uint32_t)ref->capability->mime ? -1 : 1;
+    }
+    if (type != ref->capability->type) {
+        return (uint32_t)type < (uint32_t)ref->capability->type ? -1 : 1;
+    }
+    return 0;
+}
+
+static int CompareSortKey(const void *left, const void *right)
+{
+    const CodecCapabilityKey *l = (const CodecCapabilityKey *)left;
+    const CodecCapabilityKey *r = (const CodecCapabilityKey *)right;
+    int32_t result = CompareKey(l->ref.flags, l->ref.capability->mime, l->ref.capability->type, &r->ref);
+    if (result != 0) {
+        return result;
+    }
+    return l->order < r->order ? -1 : (l->order > r->order ? 1 : 0);
+}
+
+static int32_t BuildTable(CodecCapablites *caps, CodecCapabilityIndex *index, int32_t total)
+{
+    // the order of EnumrateCapablity
+    CodecCapablityGroup *groups[] = {&caps->videoHwEncoderGroup, &caps->videoHwDecoderGroup,
+                                     &caps->videoSwEncoderGroup, &caps->videoSwDecoderGroup,
+                                     &caps->audioHwEncoderGroup, &caps->audioHwDecoderGroup,
+                                     &caps->audioSwEncoderGroup, &caps->audioSwDecoderGroup};
+    const uint32_t flags[] = {CODEC_CAPABILITY_FLAG_HARDWARE, CODEC_CAPABILITY_FLAG_HARDWARE,
+                              CODEC_CAPABILITY_FLAG_SOFTWARE, CODEC_CAPABILITY_FLAG_SOFTWARE,
+                              CODEC_CAPABILITY_FLAG_HARDWARE, CODEC_CAPABILITY_FLAG_HARDWARE,
+                              CODEC_CAPABILITY_FLAG_SOFTWARE, CODEC_CAPABILITY_FLAG_SOFTWARE};
+
+    index->table = (CodecCapabilityRef *)OsalMemCalloc(sizeof(CodecCapabilityRef) * total);
+    if (index->table == NULL) {
+        HDF_LOGE("%{public}s: alloc table failed!", __func__);
+        return HDF_FAILURE;
+    }
+    for (int32_t i = 0; i < CODEC_CAPABLITY_GROUP_NUM; i++) {
+        for (int32_t j = 0; j < GetGroupNum(groups[i]); j++) {
+            index->table[index->num].capability = &groups[i]->capablitis[j];
+            index->table[index->num].flags = flags[i];
+            index->num++;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t BuildSorted(CodecCapablites *caps, CodecCapabilityIndex *index)
+{
+    // the order of GetCapability, hardware groups first
+    CodecCapablityGroup *groups[] = {&caps->videoHwEncoderGroup, &caps->videoHwDecoderGroup,
+                                     &caps->audioHwEncoderGroup, &caps->audioHwDecoderGroup,
+                                     &caps->videoSwEncoderGroup, &caps->videoSwDecoderGroup,
+                                     &caps->audioSwEncoderGroup, &caps->audioSwDecoderGroup};
+    CodecCapabilityKey *keys = (CodecCapabilityKey *)OsalMemCalloc(sizeof(CodecCapabilityKey) * index->num);
+    if (keys == NULL) {
+        HDF_LOGE("%{public}s: alloc keys failed!", __func__);
+        return HDF_FAILURE;
+    }
+    int32_t order = 0;
+    for (int32_t i = 0; i < CODEC_CAPABLITY_GROUP_NUM; i++) {
+        for (int32_t j = 0; j < GetGroupNum(groups[i]); j++) {
+            keys[order].ref.capability = &groups[i]->capablitis[j];
+            keys[order].ref.flags = i < HARDWARE_GROUP_NUM ? CODEC_CAPABILITY_FLAG_HARDWARE :
+                                                             CODEC_CAPABILITY_FLAG_SOFTWARE;
+            keys[order].order = order;
+            order++;
+        }
+    }
+    qsort(keys, order, sizeof(CodecCapabilityKey), CompareSortKey);
+
+    index->sorted = (CodecCapabilityRef *)OsalMemCalloc(sizeof(CodecCapabilityRef) * order);
+    if (index->sorted == NULL) {
+        HDF_LOGE("%{public}s: alloc sorted failed!", __func__);
+        OsalMemFree(keys);
+        return HDF_FAILURE;
+    }
+    for (int32_t i = 0; i < order; i++) {
+        if (index->keyNum > 0 && CompareKey(keys[i].ref.flags, keys[i].ref.capability->mime,
+            keys[i].ref.capability->type, &index->sorted[index->keyNum - 1]) == 0) {
+            continue;
+        }
+        index->sorted[index->keyNum++] = keys[i].ref;
+    }
+    OsalMemFree(keys);
+    return HDF_SUCCESS;
+}
+
+int32_t BuildCapabilityIndex(CodecCapablites *caps, CodecCapabilityIndex *index)
+{
+    if (caps == NULL || index == NULL) {
+        HDF_LOGE("%{public}s: params NULL!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    ClearCapabilityIndex(index);
+    CodecCapablityGroup *groups[] = {&caps->videoHwEncoderGroup, &caps->videoHwDecoderGroup,
+                                     &caps->videoSwEncoderGroup, &caps->videoSwDecoderGroup,
+                                     &caps->audioHwEncoderGroup, &caps->audioHwDecoderGroup,
+                                     &caps->audioSwEncoderGroup, &caps->audioSwDecoderGroup};
+    int32_t total = 0;
+    for (int32_t i = 0; i < CODEC_CAPABLITY_GROUP_NUM; i++) {
+        total += GetGroupNum(groups[i]);
+    }
+    if (total == 0) {
+        return HDF_SUCCESS;
+    }
+    if (BuildTable(caps, index, total) != HDF_SUCCESS || BuildSorted(caps, index) != HDF_SUCCESS) {
+        ClearCapabilityIndex(index);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+void ClearCapabilityIndex(CodecCapabilityIndex *index)
+{
+    if (index == NULL) {
+        return;
+    }
+    if (index->table != NULL) {
+        OsalMemFree(index->table);
+        index->table = NULL;
+    }
+    if (index->sorted != NULL) {
+        OsalMemFree(index->sorted);
+        index->sorted = NULL;
+    }
+    index->num = 0;
+    index->keyNum = 0;
+}
+
+CodecCapbility *EnumerateCapabilityIndex(const CodecCapabilityIndex *index, int32_t cursor)
+{
+    if (index == NULL || cursor < 0 || cursor >= index->num) {
+        return NULL;
+    }
+    return index->table[cursor].capability;
+}
+
+CodecCapbility *LookupCapabilityIndex(const CodecCapabilityIndex *index,
+    AvCodecMime mime, CodecType type, uint32_t flags)
+{
+    if (index == NULL) {
+        return NULL;
+    }
+    flags = flags == 0 ? CODEC_CAPABILITY_FLAG_HARDWARE : CODEC_CAPABILITY_FLAG_SOFTWARE;
+    int32_t low = 0;
+    int32_t high = index->keyNum - 1;
+    while (low <= high) {
+        int32_t middle = low + (high - low) / 2;
+        int32_t result = CompareKey(flags, mime, type, &index->sorted[middle]);
+        if (result == 0) {
+            return index->sorted[middle].capability;
+        }
+        if (result < 0) {
+            high = middle - 1;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return NULL;
+}
@@ -16,6 +16,7 @@
 #include "codec_config_reader.h"
 #include <hdf_log.h>
 #include <hdf_sbuf.h>
+#include <osal_mem.h>
 #include <servmgr_hdi.h>
 #include "config_parser.h"
 #include "codec_utils.h"
@@ -25,6 +26,9 @@ extern "C" {
 #endif /* __cplusplus */
 
 #define HDF_LOG_TAG "codec_config_client"
+// the bytes of a table entry whose arrays are empty: flags, mime, type, alignment, two sizes,
+// two bit rates, four array lengths, buffer numbers and masks
+#define CODEC_CAPABILITY_ENTRY_MIN_SIZE (sizeof(uint32_t) * 17 + sizeof(uint64_t) * 2)
 
 static int32_t DeserializeCapAlignment(struct HdfSBuf *reply, Alignment *alignment)
 {
@@ -68,8 +72,9 @@ static int32_t DeserializeCapArray(struct HdfSBuf *reply, ResizableArray *resArr
     }
 
     resArr->actualLen = 0;
-    if (!HdfSbufReadUint32(reply, &resArr->actualLen)) {
+    if (!HdfSbufReadUint32(reply, &resArr->actualLen) || resArr->actualLen > ELEMENT_MAX_LEN) {
         HDF_LOGE("%{public}s: read actualLen failed!", __func__);
+        resArr->actualLen = 0;
         return HDF_FAILURE;
     }
     for (uint32_t i = 0; i < resArr->actualLen; i++) {
@@ -257,6 +262,121 @@ int32_t GetCapability(struct HdfRemoteService *remote,
     return HDF_SUCCESS;
 }
 
+static int32_t DeserializeCapabilityTable(struct HdfSBuf *reply, CodecCapabilityTable *table)
+{
+    uint32_t version;
+    int32_t num;
+    if (!HdfSbufReadUint32(reply, &version)) {
+        HDF_LOGE("%{public}s: read version failed!", __func__);
+        return HDF_FAILURE;
+    }
+    if (table->version != 0 && version == table->version) {
+        return HDF_SUCCESS;
+    }
+    if (!HdfSbufReadInt32(reply, &num) || num < 0) {
+        HDF_LOGE("%{public}s: read num failed!", __func__);
+        return HDF_FAILURE;
+    }
+    // the entries must fit in the reply, a bad count would otherwise size the allocation
+    if ((size_t)num > HdfSbufGetDataSize(reply) / CODEC_CAPABILITY_ENTRY_MIN_SIZE) {
+        HDF_LOGE("%{public}s: num %{public}d exceeds the reply!", __func__, num);
+        return HDF_FAILURE;
+    }
+
+    CodecCapabilityEntry *entries = NULL;
+    if (num > 0) {
+        entries = (CodecCapabilityEntry *)OsalMemCalloc(sizeof(CodecCapabilityEntry) * num);
+        if (entries == NULL) {
+            HDF_LOGE("%{public}s: alloc entries failed!", __func__);
+            return HDF_FAILURE;
+        }
+    }
+    for (int32_t i = 0; i < num; i++) {
+        if (!HdfSbufReadUint32(reply, &entries[i].flags) ||
+            DeserializeCodecCapability(reply, &entries[i].capability) != HDF_SUCCESS) {
+            HDF_LOGE("%{public}s: DeserializeCodecCapbility failed!", __func__);
+            OsalMemFree(entries);
+            return HDF_FAILURE;
+        }
+    }
+    ReleaseCapabilityTable(table);
+    table->version = version;
+    table->num = num;
+    table->entries = entries;
+    return HDF_SUCCESS;
+}
+
+int32_t GetAllCapabilities(struct HdfRemoteService *remote, CodecCapabilityTable *table)
+{
+    if (remote == NULL || table == NULL) {
+        HDF_LOGE("%{public}s: params NULL!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    struct HdfSBuf *data = HdfSbufTypedObtain(SBUF_IPC);
+    if (data == NULL) {
+        HDF_LOGE("%{public}s: Failed to obtain", __func__);
+        return HDF_FAILURE;
+    }
+    struct HdfSBuf *reply = HdfSbufTypedObtain(SBUF_IPC);
+    if (reply == NULL) {
+        HDF_LOGE("%{public}s: Failed to obtain reply", __func__);
+        HdfSbufRecycle(data);
+        return HDF_FAILURE;
+    }
+    if (!HdfRemoteServiceWriteInterfaceToken(remote, data)) {
+        HDF_LOGE("write interface token failed");
+        ReleaseSbuf(data, reply);
+        return HDF_FAILURE;
+    }
+    if (!HdfSbufWriteUint32(data, table->version)) {
+        HDF_LOGE("%{public}s: write input version failed!", __func__);
+        ReleaseSbuf(data, reply);
+        return HDF_FAILURE;
+    }
+
+    if (remote->dispatcher->Dispatch(remote, CODEC_CONFIG_CMD_GET_ALL_CAP, data, reply) != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s: dispatch request failed!", __func__);
+        ReleaseSbuf(data, reply);
+        return HDF_FAILURE;
+    }
+
+    int32_t ret = DeserializeCapabilityTable(reply, table);
+    ReleaseSbuf(data, reply);
+    return ret;
+}
+
+int32_t FindCapability(const CodecCapabilityTable *table,
+    AvCodecMime mime, CodecType type, uint32_t flags, CodecCapbility *cap)
+{
+    if (table == NULL || cap == NULL) {
+        HDF_LOGE("%{public}s: params NULL!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    // entries of a kind keep the order the service looks them up in
+    uint32_t expected = flags == 0 ? 0 : 1;
+    for (int32_t i = 0; i < table->num; i++) {
+        CodecCapabilityEntry *entry = &table->entries[i];
+        if (entry->flags == expected && entry->capability.mime == mime && entry->capability.type == type) {
+            *cap = entry->capability;
+            return HDF_SUCCESS;
+        }
+    }
+    return HDF_FAILURE;
+}
+
+void ReleaseCapabilityTable(CodecCapabilityTable *table)
+{
+    if (table == NULL) {
+        return;
+    }
+    if (table->entries != NULL) {
+        OsalMemFree(table->entries);
+        table->entries = NULL;
+    }
+    table->num = 0;
+    table->version = 0;
+}
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
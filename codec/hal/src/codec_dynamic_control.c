@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec_dynamic_control.h"
+#include <inttypes.h>
+#include <hdf_base.h>
+#include <hdf_log.h>
+#include <securec.h>
+#include "OMX_Video.h"
+
+#define HDF_LOG_TAG codec_hdi_client
+
+#define ENCODER_INPUT_PORT      0
+#define ENCODER_OUTPUT_PORT     1
+#define Q16_SHIFT               16
+#define OMX_VERSION_MAJOR       1
+
+static bool InRange(const RangeValue *range, int64_t value)
+{
+    // a range the config leaves at 0 is not limited
+    if (range->max <= 0) {
+        return true;
+    }
+    return value >= range->min && value <= range->max;
+}
+
+static int64_t GetBlockNum(const VideoPortCap *video, uint32_t width, uint32_t height)
+{
+    if (video->blockSize.width <= 0 || video->blockSize.height <= 0) {
+        return 0;
+    }
+    int64_t columns = ((int64_t)width + video->blockSize.width - 1) / video->blockSize.width;
+    int64_t rows = ((int64_t)height + video->blockSize.height - 1) / video->blockSize.height;
+    return columns * rows;
+}
+
+static int32_t CheckFrameRate(const VideoPortCap *video, uint32_t frameRate)
+{
+    // rounded up, a rate above the limit by a fraction is still too fast
+    int64_t fps = ((int64_t)frameRate + (1 << Q16_SHIFT) - 1) >> Q16_SHIFT;
+    if (fps == 0) {
+        HDF_LOGE("%{public}s: frame rate 0x%{public}x", __func__, frameRate);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (video->blocksPerSecond.max <= 0) {
+        return HDF_SUCCESS;
+    }
+    int64_t blocks = GetBlockNum(video, video->minSize.width, video->minSize.height);
+    if (blocks < video->blockCount.min) {
+        blocks = video->blockCount.min;
+    }
+    if (blocks <= 0) {
+        blocks = 1;
+    }
+    if (fps * blocks > video->blocksPerSecond.max) {
+        HDF_LOGE("%{public}s: %{public}" PRId64 " fps is above %{public}d blocks per second", __func__, fps,
+            video->blocksPerSecond.max);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t CheckResolution(const VideoPortCap *video, uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0 || width < (uint32_t)video->minSize.width ||
+        height < (uint32_t)video->minSize.height ||
+        (video->maxSize.width > 0 && width > (uint32_t)video->maxSize.width) ||
+        (video->maxSize.height > 0 && height > (uint32_t)video->maxSize.height)) {
+        HDF_LOGE("%{public}s: size %{public}ux%{public}u is out of range", __func__, width, height);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if ((video->whAlignment.widthAlignment > 0 && width % (uint32_t)video->whAlignment.widthAlignment != 0) ||
+        (video->whAlignment.heightAlignment > 0 && height % (uint32_t)video->whAlignment.heightAlignment != 0)) {
+        HDF_LOGE("%{public}s: size %{public}ux%{public}u is not aligned", __func__, width, height);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    int64_t blocks = GetBlockNum(video, width, height);
+    if (blocks > 0 && !InRange(&video->blockCount, blocks)) {
+        HDF_LOGE("%{public}s: %{public}" PRId64 " blocks are out of range", __func__, blocks);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t CodecCheckDynamicControl(const CodecCompCapability *cap, const struct CodecDynamicControl *control)
+{
+    if (cap == NULL || control == NULL) {
+        HDF_LOGE("%{public}s: params NULL!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (cap->type != VIDEO_ENCODER) {
+        HDF_LOGE("%{public}s: %{public}s is no video encoder", __func__, cap->compName);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    switch (control->type) {
+        case CODEC_CONTROL_BITRATE:
+            if (control->value.bitRate == 0 || !InRange(&cap->bitRate, control->value.bitRate)) {
+                HDF_LOGE("%{public}s: bit rate %{public}u is out of range", __func__, control->value.bitRate);
+                return HDF_ERR_INVALID_PARAM;
+            }
+            return HDF_SUCCESS;
+        case CODEC_CONTROL_FRAMERATE:
+            return CheckFrameRate(&cap->port.video, control->value.frameRate);
+        case CODEC_CONTROL_REQUEST_IDR:
+            return HDF_SUCCESS;
+        case CODEC_CONTROL_RESOLUTION:
+            return CheckResolution(&cap->port.video, control->value.size.width, control->value.size.height);
+        default:
+            HDF_LOGE("%{public}s: control type %{public}d is not supported", __func__, control->type);
+            return HDF_ERR_NOT_SUPPORT;
+    }
+}
+
+static void InitConfigHeader(void *config, uint32_t size, uint32_t *len)
+{
+    // every OMX config structure starts with its size and version
+    (void)memset_s(config, size, 0, size);
+    *(uint32_t *)config = size;
+    ((union OMX_VERSIONTYPE *)((uint8_t *)config + sizeof(uint32_t)))->s.nVersionMajor = OMX_VERSION_MAJOR;
+    *len = size;
+}
+
+int32_t CodecPackDynamicControl(const struct CodecDynamicControl *control, uint32_t *index, int8_t *config,
+    uint32_t *len)
+{
+    if (control == NULL || index == NULL || config == NULL || len == NULL) {
+        HDF_LOGE("%{public}s: params NULL!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    uint32_t sizes[] = {sizeof(OMX_VIDEO_CONFIG_BITRATETYPE), sizeof(OMX_CONFIG_FRAMERATETYPE),
+                        sizeof(OMX_CONFIG_INTRAREFRESHVOPTYPE), sizeof(struct CodecVideoFrameSize)};
+    if ((uint32_t)control->type >= sizeof(sizes) / sizeof(sizes[0])) {
+        HDF_LOGE("%{public}s: control type %{public}d is not supported", __func__, control->type);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    if (*len < sizes[control->type]) {
+        HDF_LOGE("%{public}s: len %{public}u is too small", __func__, *len);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    InitConfigHeader(config, sizes[control->type], len);
+    switch (control->type) {
+        case CODEC_CONTROL_BITRATE: {
+            OMX_VIDEO_CONFIG_BITRATETYPE *bitRate = (OMX_VIDEO_CONFIG_BITRATETYPE *)config;
+            bitRate->nPortIndex = ENCODER_OUTPUT_PORT;
+            bitRate->nEncodeBitrate = control->value.bitRate;
+            *index = OMX_IndexConfigVideoBitrate;
+            break;
+        }
+        case CODEC_CONTROL_FRAMERATE: {
+            OMX_CONFIG_FRAMERATETYPE *frameRate = (OMX_CONFIG_FRAMERATETYPE *)config;
+            frameRate->nPortIndex = ENCODER_OUTPUT_PORT;
+            frameRate->xEncodeFramerate = control->value.frameRate;
+            *index = OMX_IndexConfigVideoFramerate;
+            break;
+        }
+        case CODEC_CONTROL_REQUEST_IDR: {
+            OMX_CONFIG_INTRAREFRESHVOPTYPE *refresh = (OMX_CONFIG_INTRAREFRESHVOPTYPE *)config;
+            refresh->nPortIndex = ENCODER_OUTPUT_PORT;
+            refresh->IntraRefreshVOP = OMX_TRUE;
+            *index = OMX_IndexConfigVideoIntraVOPRefresh;
+            break;
+        }
+        default: {
+            // the size of the frames coming in, the output follows
+            struct CodecVideoFrameSize *size = (struct CodecVideoFrameSize *)config;
+            size->portIndex = ENCODER_INPUT_PORT;
+            size->width = control->value.size.width;
+            size->height = control->value.size.height;
+            *index = OMX_IndexConfigVideoFrameSize;
+            break;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t CodecSetDynamicControl(struct CodecComponentType *component, const CodecCompCapability *cap,
+    const struct CodecDynamicControl *control)
+{
+    if (component == NULL || component->SetConfig == NULL) {
+        HDF_LOGE("%{public}s: component NULL!", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    int32_t ret = CodecCheckDynamicControl(cap, control);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    union {
+        OMX_VIDEO_CONFIG_BITRATETYPE bitRate;
+        OMX_CONFIG_FRAMERATETYPE frameRate;
+        OMX_CONFIG_INTRAREFRESHVOPTYPE refresh;
+        struct CodecVideoFrameSize size;
+    } config;
+    uint32_t index = 0;
+    uint32_t len = sizeof(config);
+    ret = CodecPackDynamicControl(control, &index, (int8_t *)&config, &len);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    ret = component->SetConfig(component, index, (int8_t *)&config, len);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s: SetConfig index 0x%{public}x ret %{public}d", __func__, index, ret);
+    }
+    return ret;
+}
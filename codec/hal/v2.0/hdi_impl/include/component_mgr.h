@@ -18,7 +18,9 @@
 #include <OMX_Component.h>
 #include <OMX_Core.h>
 #include <list>
-#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "icomponent_mgr.h"
@@ -43,6 +45,12 @@ public:
 
     bool IsOMXHandleValid(OMX_COMPONENTTYPE *handle);
 
+    // at most maxInstances instances of the component live at once, 0 lifts the limit
+    int32_t SetInstanceLimit(const char *componentName, uint32_t maxInstances);
+
+    // the live instances of the component, of all components when componentName is null
+    uint32_t GetInstanceCount(const char *componentName);
+
     bool IsLoadLibSuc()
     {
         return loadLibSuc_;
@@ -61,19 +69,24 @@ private:
         IComponentMgr *omxComponent;
         void *LibHandle;
     };
-    struct ComponentNameAndObjectPoint {
-        std::string componentName;
+    struct ComponentEntry {
         IComponentMgr *omxComponentMgr;
+        uint32_t maxInstances;
+        uint32_t instances;  // live and being created
     };
-    struct ComponentTypePointAndObjectPoint {
-        OMX_COMPONENTTYPE *componentType;
+    struct InstanceInfo {
+        std::string componentName;
         IComponentMgr *omxComponentMgr;
+        uint32_t id;
+        bool deleting;  // the vendor is deleting it, the handle and the slot stay until it succeeded
     };
     std::list<ComponentInfo> componentsList_;
-    std::vector<ComponentNameAndObjectPoint> componentNameAndObjectPoint_;
-    std::vector<ComponentTypePointAndObjectPoint> componentTypePointAndObjectPoint_;
-    OMX_COMPONENTTYPE *currentComType_;
-    std::string currentComName_;
+    std::vector<std::string> componentNames_;  // in the order they are enumerated
+    std::unordered_map<std::string, ComponentEntry> components_;
+    std::mutex mutex_;
+    std::unordered_map<OMX_COMPONENTTYPE *, InstanceInfo> instances_;
+    uint32_t totalInstances_;
+    uint32_t nextInstanceId_;
 };
 }  // namespace Omx
 }  // namespace Codec
@@ -18,22 +18,27 @@
 #include <OMX_Core.h>
 #include <OMX_Types.h>
 #include <ashmem.h>
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <nocopyable.h>
 #include <osal_mem.h>
 
 #include "codec_callback_if.h"
 #include "codec_component_type.h"
+#include "component_telemetry.h"
 
 struct BufferInfo {
     struct OmxCodecBuffer omxCodecBuffer;
     std::shared_ptr<OHOS::Ashmem> sharedMem;  // sharedMem
+    bool zeroCopy;  // pBuffer of the header is the mapping of sharedMem, nothing is copied
 
     BufferInfo()
     {
         omxCodecBuffer = {0};
         sharedMem = nullptr;
+        zeroCopy = false;
     }
     ~BufferInfo()
     {
@@ -45,6 +50,16 @@ struct BufferInfo {
     }
 };
 using BufferInfo = struct BufferInfo;
+
+// Copies between the shared memory of the client and the buffers of the component
+struct BufferCopyStats {
+    uint32_t zeroCopyBuffers;  // shared buffers bound to the component as they are
+    uint32_t copyBuffers;      // shared buffers backed by a buffer the component allocated
+    uint64_t inputCopies;      // frames copied into input buffers
+    uint64_t inputBytes;
+    uint64_t outputCopies;     // frames copied out of output buffers
+    uint64_t outputBytes;
+};
 using BufferInfoSPtr = std::shared_ptr<BufferInfo>;
 using BufferInfoWPtr = std::weak_ptr<BufferInfo>;
 namespace OHOS {
@@ -100,6 +115,13 @@ public:
 
     OMX_ERRORTYPE static OnFillBufferDone(OMX_HANDLETYPE component, void *appData, OMX_BUFFERHEADERTYPE *buffer);
 
+    void GetBufferStats(struct BufferCopyStats &stats) const;
+
+    void GetTelemetry(struct ComponentTelemetryStats &stats) const;
+
+    // logs the buffers and ports of a component that stopped returning buffers, flushes it if asked
+    bool CheckStall(uint32_t timeoutMs, bool forceFlush);
+
     void SetHandle(OMX_HANDLETYPE comp)
     {
         this->comp_ = comp;
@@ -135,7 +157,11 @@ private:
                               OMX_BUFFERHEADERTYPE *bufferHdrType);
 
     void SaveBufferInfo(struct OmxCodecBuffer &omxCodecBuffer, OMX_BUFFERHEADERTYPE *bufferHdrType,
-                        std::shared_ptr<Ashmem> sharedMem);
+                        std::shared_ptr<Ashmem> sharedMem, bool zeroCopy = false);
+
+    void DumpPorts();
+
+    void DumpBuffers();
 
 private:
     OMX_HANDLETYPE comp_;                                         // Compnent handle
@@ -144,9 +170,19 @@ private:
     int32_t appDataSize_;                                         // User data length, default is 0
     std::map<uint32_t, BufferInfoSPtr> bufferInfoMap_;            // Key is buffferID
     std::map<OMX_BUFFERHEADERTYPE *, uint32_t> bufferHeaderMap_;  // Key is omx buffer header type
+    std::mutex bufferMutex_;  // the maps are read on threads of the component and of the watchdog
 
     uint32_t bufferIdCount_;
 
+    // the component callbacks run on threads of the component
+    std::atomic<uint32_t> zeroCopyBuffers_;
+    std::atomic<uint32_t> copyBuffers_;
+    std::atomic<uint64_t> inputCopies_;
+    std::atomic<uint64_t> inputBytes_;
+    std::atomic<uint64_t> outputCopies_;
+    std::atomic<uint64_t> outputBytes_;
+    ComponentTelemetry telemetry_;
+
 #ifdef NODE_DEBUG
     FILE *fp_in;
     FILE *fp_out;
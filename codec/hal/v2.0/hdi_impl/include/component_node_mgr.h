@@ -16,12 +16,14 @@
 #define COMPONENT_NODE_MGR_H
 #include <OMX_Core.h>
 #include <map>
+#include <mutex>
 #include <nocopyable.h>
 
 #include "codec_callback_if.h"
 #include "codec_types.h"
 #include "component_mgr.h"
 #include "component_node.h"
+#include "component_watchdog.h"
 namespace OHOS {
 namespace Codec {
 namespace Omx {
@@ -76,8 +78,12 @@ public:
     int32_t ComponentRoleEnum(OMX_HANDLETYPE compHandle, uint8_t *role, uint32_t roleLen, uint32_t index);
 
 private:
+    std::shared_ptr<ComponentNode> GetNode(OMX_HANDLETYPE compHandle);
+
     std::shared_ptr<ComponentMgr> compMgr_;
+    std::mutex nodeMutex_;
     std::map<OMX_HANDLETYPE, std::shared_ptr<ComponentNode>> nodeMaps_;
+    ComponentWatchdog watchdog_;
 };
 }  // namespace Omx
 }  // namespace Codec
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef COMPONENT_TELEMETRY_H
+#define COMPONENT_TELEMETRY_H
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include "codec_histogram.h"
+
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+enum TelemetryDirection {
+    TELEMETRY_INPUT,   // EmptyThisBuffer to EmptyBufferDone
+    TELEMETRY_OUTPUT,  // FillThisBuffer to FillBufferDone
+    TELEMETRY_DIRECTION_NUM
+};
+
+struct PortTelemetry {
+    uint32_t portIndex;                // port the buffers were last queued to
+    uint64_t queued;
+    uint64_t returned;
+    uint32_t held;                     // buffers the component holds now
+    uint32_t maxHeld;
+    CodecHistogram turnaroundUs;       // queued to returned
+    CodecHistogram depth;              // buffers held once one is queued
+};
+
+struct ComponentTelemetryStats {
+    PortTelemetry ports[TELEMETRY_DIRECTION_NUM];
+    CodecHistogram latencyUs;          // input queued to the output of the same pts returned
+    uint32_t stalls;
+};
+
+// Where the buffers of one component instance are and how long they stay there.
+// The calls come from the IPC threads and the threads of the component, the class locks itself.
+class ComponentTelemetry {
+public:
+    ComponentTelemetry();
+
+    ~ComponentTelemetry() = default;
+
+    // record a buffer before it is handed over, a component may return it before the call does
+    void OnQueued(TelemetryDirection dir, uint32_t portIndex, uint32_t bufferId, int64_t pts);
+
+    // the component refused a buffer recorded with OnQueued
+    void OnRejected(TelemetryDirection dir, uint32_t bufferId);
+
+    void OnReturned(TelemetryDirection dir, uint32_t bufferId, int64_t pts, uint32_t filledLen);
+
+    // a freed buffer is no longer waited for
+    void OnFreed(uint32_t bufferId);
+
+    // true once when the component holds input and output buffers and returned nothing for timeoutMs,
+    // again after it moved on
+    bool CheckStall(uint32_t timeoutMs);
+
+    void GetStats(struct ComponentTelemetryStats &stats) const;
+
+    // the buffers held in a direction and for how long in us
+    std::map<uint32_t, uint64_t> GetHeld(TelemetryDirection dir) const;
+
+private:
+    static uint64_t NowUs();
+
+private:
+    struct PendingInput {
+        uint32_t bufferId;
+        int64_t pts;
+        uint64_t queuedUs;
+    };
+
+    mutable std::mutex mutex_;
+    struct ComponentTelemetryStats stats_;
+    std::map<uint32_t, uint64_t> held_[TELEMETRY_DIRECTION_NUM];  // bufferId to the time it was queued
+    std::deque<PendingInput> pendingInputs_;                      // waiting for an output, oldest first
+    uint64_t lastProgressUs_;
+    bool stalled_;
+};
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
+#endif /* COMPONENT_TELEMETRY_H */
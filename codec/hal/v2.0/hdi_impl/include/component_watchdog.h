@@ -0,0 +1,72 @@
+/*
+ * Copyright 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef COMPONENT_WATCHDOG_H
+#define COMPONENT_WATCHDOG_H
+#include <OMX_Core.h>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <nocopyable.h>
+#include <thread>
+
+#include "component_node.h"
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+struct WatchdogConfig {
+    uint32_t intervalMs;  // between two checks
+    uint32_t timeoutMs;   // without a buffer returned an executing component is stalled
+    bool forceFlush;      // flush a stalled component so the client gets its buffers back
+};
+
+// Checks the executing components for buffers that do not come back, see ComponentNode::CheckStall.
+class ComponentWatchdog : NoCopyable {
+public:
+    ComponentWatchdog();
+
+    ~ComponentWatchdog();
+
+    void SetConfig(const struct WatchdogConfig &config);
+
+    // the thread starts with the first node
+    void AddNode(OMX_HANDLETYPE compHandle, std::weak_ptr<ComponentNode> node);
+
+    // once it returns the node is not checked any more, call it before the component is deleted
+    void RemoveNode(OMX_HANDLETYPE compHandle);
+
+    // joins the thread, no node is checked any more
+    void Stop();
+
+    // checks every node once, returns the number of stalls found
+    uint32_t CheckNodes();
+
+private:
+    void Run();
+
+    uint32_t CheckNodesLocked();
+
+private:
+    std::mutex mutex_;  // held while the nodes are checked
+    std::condition_variable cond_;
+    std::thread thread_;
+    bool stop_;
+    struct WatchdogConfig config_;
+    std::map<OMX_HANDLETYPE, std::weak_ptr<ComponentNode>> nodes_;
+};
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
+#endif /* COMPONENT_WATCHDOG_H */
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOFT_CODECS_H
+#define SOFT_CODECS_H
+#include "soft_component.h"
+
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+constexpr const char *SOFT_RAW_DECODER_NAME = "OMX.soft.video_decoder.raw";
+constexpr const char *SOFT_RAW_DECODER_ROLE = "video_decoder.raw";
+constexpr const char *SOFT_PCM_DECODER_NAME = "OMX.soft.audio_decoder.pcm";
+constexpr const char *SOFT_PCM_DECODER_ROLE = "audio_decoder.pcm";
+constexpr const char *SOFT_RLE_ENCODER_NAME = "OMX.soft.video_encoder.rle";
+constexpr const char *SOFT_RLE_ENCODER_ROLE = "video_encoder.rle";
+// PackBits, each frame is coded on its own
+constexpr OMX_VIDEO_CODINGTYPE OMX_VIDEO_CodingSoftRle =
+    static_cast<OMX_VIDEO_CODINGTYPE>(OMX_VIDEO_CodingVendorStartUnused + 1);
+
+// Video ports carry YUV420 planar or semi planar frames, or the coding of the component
+class SoftVideoComponent : public SoftComponent {
+public:
+    // stride and slice height are even, the chroma planes are half the luma in both directions
+    static uint32_t GetFrameSize(const OMX_VIDEO_PORTDEFINITIONTYPE &video);
+
+protected:
+    SoftVideoComponent(const char *name, const char *role, OMX_VIDEO_CODINGTYPE inCoding,
+                       OMX_VIDEO_CODINGTYPE outCoding);
+    OMX_ERRORTYPE SetPortFormat(uint32_t portIndex, const OMX_PARAM_PORTDEFINITIONTYPE &def) override;
+    OMX_ERRORTYPE GetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param) override;
+    OMX_ERRORTYPE SetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param) override;
+    // the format of the port changed, sizes and the ports following it are updated
+    virtual void OnPortFormatChanged(uint32_t portIndex) = 0;
+
+private:
+    OMX_VIDEO_CODINGTYPE coding_[SOFT_PORT_NUM];
+};
+
+// Scales and converts raw YUV420 frames, the output has the size of the input unless it is set
+class SoftRawDecoder : public SoftVideoComponent {
+public:
+    SoftRawDecoder();
+
+protected:
+    void OnPortFormatChanged(uint32_t portIndex) override;
+    OMX_ERRORTYPE Process(OMX_BUFFERHEADERTYPE &in, OMX_BUFFERHEADERTYPE &out, uint32_t &consumed) override;
+
+private:
+    bool followInput_;
+};
+
+// Codes every raw frame with PackBits, bit rate, frame rate and frame size are also taken as configs while executing
+class SoftRleEncoder : public SoftVideoComponent {
+public:
+    SoftRleEncoder();
+    // the worst case of coding size bytes
+    static uint32_t GetBound(uint32_t size);
+    // returns the coded size, 0 if it does not fit in dstSize
+    static uint32_t Encode(const uint8_t *src, uint32_t srcSize, uint8_t *dst, uint32_t dstSize);
+
+protected:
+    void OnPortFormatChanged(uint32_t portIndex) override;
+    OMX_ERRORTYPE GetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param) override;
+    OMX_ERRORTYPE SetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param) override;
+    OMX_ERRORTYPE CheckCodecConfig(OMX_INDEXTYPE index, const void *config) override;
+    OMX_ERRORTYPE ApplyCodecConfig(OMX_INDEXTYPE index, const void *config) override;
+    OMX_ERRORTYPE GetCodecConfig(OMX_INDEXTYPE index, OMX_PTR config) override;
+    OMX_ERRORTYPE Process(OMX_BUFFERHEADERTYPE &in, OMX_BUFFERHEADERTYPE &out, uint32_t &consumed) override;
+
+private:
+    // a new frame size has to fit in the buffers in use
+    OMX_ERRORTYPE CheckFrameSize(uint32_t width, uint32_t height);
+
+    OMX_VIDEO_CONTROLRATETYPE controlRate_;
+};
+
+// Passes PCM through, an input larger than the output is split and the timestamps follow the samples
+class SoftPcmDecoder : public SoftComponent {
+public:
+    SoftPcmDecoder();
+
+protected:
+    OMX_ERRORTYPE SetPortFormat(uint32_t portIndex, const OMX_PARAM_PORTDEFINITIONTYPE &def) override;
+    OMX_ERRORTYPE GetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param) override;
+    OMX_ERRORTYPE SetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param) override;
+    OMX_ERRORTYPE Process(OMX_BUFFERHEADERTYPE &in, OMX_BUFFERHEADERTYPE &out, uint32_t &consumed) override;
+
+private:
+    OMX_AUDIO_PARAM_PCMMODETYPE pcm_;
+};
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
+#endif /* SOFT_CODECS_H */
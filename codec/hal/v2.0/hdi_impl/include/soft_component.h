@@ -0,0 +1,177 @@
+/*
+ * Copyright 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOFT_COMPONENT_H
+#define SOFT_COMPONENT_H
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+enum SoftPortIndex : uint32_t {
+    SOFT_PORT_INPUT = 0,
+    SOFT_PORT_OUTPUT = 1,
+    SOFT_PORT_NUM = 2,
+};
+
+/*
+ * A component running on the CPU with one input and one output port. It implements the state machine, the port
+ * commands and the buffer flow of OMX IL, the codecs only convert one input buffer into one output buffer.
+ * Commands and buffers are handled in order on a worker thread, which also makes every callback.
+ */
+class SoftComponent {
+public:
+    SoftComponent(const char *name, const char *role);
+    virtual ~SoftComponent();
+    SoftComponent(const SoftComponent &) = delete;
+    SoftComponent &operator=(const SoftComponent &) = delete;
+
+    OMX_ERRORTYPE Init(const OMX_CALLBACKTYPE *callbacks, void *appData);
+
+    OMX_COMPONENTTYPE *GetHandle()
+    {
+        return &handle_;
+    }
+
+    const std::string &GetName() const
+    {
+        return name_;
+    }
+
+    static SoftComponent *FromHandle(OMX_HANDLETYPE handle);
+
+protected:
+    // the port definition the codec fills in its constructor
+    OMX_PARAM_PORTDEFINITIONTYPE &PortDef(uint32_t portIndex)
+    {
+        return ports_[portIndex].def;
+    }
+    // checks and takes the format of a port definition set by the client, nBufferSize follows from it
+    virtual OMX_ERRORTYPE SetPortFormat(uint32_t portIndex, const OMX_PARAM_PORTDEFINITIONTYPE &def) = 0;
+    virtual OMX_ERRORTYPE GetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param);
+    virtual OMX_ERRORTYPE SetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param);
+    // converts the input into the output, consumed is how much of the input is used, the rest comes again
+    virtual OMX_ERRORTYPE Process(OMX_BUFFERHEADERTYPE &in, OMX_BUFFERHEADERTYPE &out, uint32_t &consumed) = 0;
+    // the buffers are flushed or the component stops, drop what is kept between buffers
+    virtual void Reset()
+    {}
+    // tells the client to reconfigure a port, the settings changed while its buffers are in use
+    void NotifyPortSettingsChanged(uint32_t portIndex);
+    // whether buffers are in use, port settings changed then have to be announced
+    bool IsPortActive(uint32_t portIndex) const;
+    // checks a config set by the client, it is applied before the next input frame queued
+    virtual OMX_ERRORTYPE CheckCodecConfig(OMX_INDEXTYPE index, const void *config);
+    // applies a checked config on the worker thread, no frame is converted meanwhile
+    virtual OMX_ERRORTYPE ApplyCodecConfig(OMX_INDEXTYPE index, const void *config);
+    virtual OMX_ERRORTYPE GetCodecConfig(OMX_INDEXTYPE index, OMX_PTR config);
+
+private:
+    enum NoteType { NOTE_EVENT, NOTE_EMPTY_DONE, NOTE_FILL_DONE };
+    struct Note {
+        NoteType type;
+        OMX_EVENTTYPE event;
+        uint32_t data1;
+        uint32_t data2;
+        OMX_BUFFERHEADERTYPE *buffer;
+    };
+    struct Command {
+        OMX_COMMANDTYPE cmd;
+        uint32_t param;
+    };
+    struct SoftBuffer {
+        OMX_BUFFERHEADERTYPE header;
+        std::unique_ptr<uint8_t[]> data;  // null when the client owns the memory
+    };
+    struct PendingConfig {
+        OMX_INDEXTYPE index;
+        std::vector<uint8_t> data;
+        uint64_t frame;  // the input frame it is applied before
+    };
+    struct SoftPort {
+        OMX_PARAM_PORTDEFINITIONTYPE def;
+        std::vector<std::unique_ptr<SoftBuffer>> buffers;
+        std::deque<OMX_BUFFERHEADERTYPE *> queue;  // held by the component
+        bool enabling = false;
+        bool disabling = false;
+    };
+
+    static void InitHandle(OMX_COMPONENTTYPE &handle);
+    OMX_ERRORTYPE GetComponentVersion(OMX_STRING name, OMX_VERSIONTYPE *compVersion, OMX_VERSIONTYPE *specVersion,
+                                      OMX_UUIDTYPE *uuid);
+    OMX_ERRORTYPE SendCommand(OMX_COMMANDTYPE cmd, uint32_t param, OMX_PTR cmdData);
+    OMX_ERRORTYPE GetParameter(OMX_INDEXTYPE index, OMX_PTR param);
+    OMX_ERRORTYPE SetParameter(OMX_INDEXTYPE index, OMX_PTR param);
+    OMX_ERRORTYPE GetConfig(OMX_INDEXTYPE index, OMX_PTR config);
+    OMX_ERRORTYPE SetConfig(OMX_INDEXTYPE index, OMX_PTR config);
+    OMX_ERRORTYPE GetState(OMX_STATETYPE *state);
+    OMX_ERRORTYPE AddBuffer(OMX_BUFFERHEADERTYPE **header, uint32_t portIndex, OMX_PTR appPrivate, uint32_t size,
+                            uint8_t *data);
+    OMX_ERRORTYPE FreeBuffer(uint32_t portIndex, OMX_BUFFERHEADERTYPE *header);
+    OMX_ERRORTYPE QueueBuffer(uint32_t portIndex, OMX_BUFFERHEADERTYPE *header);
+    OMX_ERRORTYPE SetCallbacks(const OMX_CALLBACKTYPE *callbacks, OMX_PTR appData);
+    OMX_ERRORTYPE RoleEnum(OMX_U8 *role, uint32_t index);
+    OMX_ERRORTYPE DeInit();
+
+    void Run();
+    bool HasWork() const;
+    bool CanProcess() const;
+    bool IsBusy() const;
+    void CheckTransitions();
+    void ExecuteCommand(const Command &command);
+    void SetState(OMX_STATETYPE state);
+    void DisablePort(uint32_t portIndex);
+    void EnablePort(uint32_t portIndex);
+    void ReturnBuffers(uint32_t portIndex);
+    void ApplyConfigs();
+    void ProcessBuffers(OMX_BUFFERHEADERTYPE *in, OMX_BUFFERHEADERTYPE *out, std::vector<Note> &notes);
+    void UpdatePopulated(uint32_t portIndex);
+    bool IsBufferOperationAllowed(uint32_t portIndex) const;
+    bool HasPendingCommand(OMX_COMMANDTYPE cmd, uint32_t param) const;
+    void AddEvent(OMX_EVENTTYPE event, uint32_t data1, uint32_t data2);
+    void Notify(const std::vector<Note> &notes);
+
+    std::string name_;
+    std::string role_;
+    OMX_COMPONENTTYPE handle_;
+    OMX_CALLBACKTYPE callbacks_;
+    OMX_PTR appData_;
+    SoftPort ports_[SOFT_PORT_NUM];
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread worker_;
+    bool exit_;
+    OMX_STATETYPE state_;
+    OMX_STATETYPE targetState_;  // the state a transition waits for, state_ while there is none
+    std::deque<Command> commands_;
+    std::vector<Note> notes_;
+    std::deque<PendingConfig> configs_;
+    // input frames are counted as they are queued and as they leave, in order, so the frame at the front of the
+    // input queue is doneInputs_
+    uint64_t queuedInputs_;
+    uint64_t doneInputs_;
+};
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
+#endif /* SOFT_COMPONENT_H */
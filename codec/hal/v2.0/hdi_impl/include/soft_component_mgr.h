@@ -0,0 +1,52 @@
+/*
+ * Copyright 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOFT_COMPONENT_MGR_H
+#define SOFT_COMPONENT_MGR_H
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "icomponent_mgr.h"
+#include "soft_component.h"
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+// The components running on the CPU, they are there without a vendor plugin
+class SoftComponentMgr : public IComponentMgr {
+public:
+    SoftComponentMgr()
+    {}
+    ~SoftComponentMgr();
+    SoftComponentMgr(const SoftComponentMgr &) = delete;
+    SoftComponentMgr &operator=(const SoftComponentMgr &) = delete;
+
+    virtual int32_t CreateComponentInstance(const char *componentName, const OMX_CALLBACKTYPE *callbacks,
+                                            void *appData, OMX_COMPONENTTYPE **component);
+
+    virtual int32_t DeleteComponentInstance(OMX_COMPONENTTYPE *component);
+
+    virtual int32_t EnumerateComponentsByIndex(uint32_t index, char *componentName, size_t componentNameSize);
+
+    virtual int32_t GetRolesForComponent(const char *componentName, std::vector<std::string> *roles);
+
+private:
+    std::mutex mutex_;
+    std::map<OMX_COMPONENTTYPE *, std::unique_ptr<SoftComponent>> components_;
+};
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
+#endif /* SOFT_COMPONENT_MGR_H */
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include <climits>
 #include <cstring>
 #include <dlfcn.h>
 #include <hdf_log.h>
@@ -20,8 +21,14 @@
 #include <securec.h>
 
 #include "component_mgr.h"
+#ifdef CODEC_SOFT_COMPONENT_ENABLE
+#include "soft_component_mgr.h"
+#endif
 #define HDF_LOG_TAG codec_hdi_server
 constexpr int COMPONENT_NAME_MAX_LEN = 128;
+// a limit on the sessions of the whole service, so that clients can not run the device out of memory
+constexpr uint32_t MAX_TOTAL_INSTANCES = 64;
+constexpr uint32_t DEFAULT_MAX_INSTANCES = 16;
 #ifdef __ARM64__
 constexpr char DRIVER_PATH[] = "/vendor/lib64";
 #else
@@ -31,7 +38,7 @@ constexpr char DRIVER_PATH[] = "/vendor/lib";
 namespace OHOS {
 namespace Codec {
 namespace Omx {
-ComponentMgr::ComponentMgr() : loadLibSuc_(false), currentComType_(NULL), currentComName_("")
+ComponentMgr::ComponentMgr() : loadLibSuc_(false), totalInstances_(0), nextInstanceId_(0)
 {
     AddVendorComponent();
     AddSoftComponent();
@@ -39,15 +46,46 @@ ComponentMgr::ComponentMgr() : loadLibSuc_(false), currentComType_(NULL), curren
 
 bool ComponentMgr::IsOMXHandleValid(OMX_COMPONENTTYPE *handle)
 {
-    for (size_t i = 0; i < componentTypePointAndObjectPoint_.size(); i++) {
-        if (handle == componentTypePointAndObjectPoint_[i].componentType) {
-            return true;
-        }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = instances_.find(handle);
+    if ((it != instances_.end()) && !it->second.deleting) {
+        return true;
     }
     HDF_LOGE("%{public}s can not find handle [0x%{public}p]", __func__, handle);
     return false;
 }
 
+int32_t ComponentMgr::SetInstanceLimit(const char *componentName, uint32_t maxInstances)
+{
+    if (componentName == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = components_.find(componentName);
+    if (it == components_.end()) {
+        HDF_LOGE("%{public}s can not find component %{public}s", __func__, componentName);
+        return OMX_ErrorInvalidComponentName;
+    }
+    // the live instances stay, only new ones are refused
+    it->second.maxInstances = maxInstances;
+    return OMX_ErrorNone;
+}
+
+uint32_t ComponentMgr::GetInstanceCount(const char *componentName)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (componentName == nullptr) {
+        return instances_.size();
+    }
+    uint32_t count = 0;
+    for (const auto &it : instances_) {
+        if (it.second.componentName == componentName) {
+            count++;
+        }
+    }
+    return count;
+}
+
 ComponentMgr::~ComponentMgr()
 {
     CleanComponent();
@@ -58,57 +96,100 @@ int32_t ComponentMgr::CreateComponentInstance(const char *componentName, const O
 {
     HDF_LOGI("ComponentMgr::CreateComponentInstance:%{public}s", componentName);
     *component = NULL;
-    int32_t err = OMX_ErrorMax;
-
-    std::vector<ComponentNameAndObjectPoint>::iterator it;
-    for (it = componentNameAndObjectPoint_.begin(); it != componentNameAndObjectPoint_.end(); ++it) {
-        if (strcmp(componentName, it->componentName.c_str()) != 0) {
-            continue;
-        }
-        if (it->omxComponentMgr == nullptr) {
-            break;
+    IComponentMgr *omxComponentMgr = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = components_.find(componentName);
+        if ((it == components_.end()) || (it->second.omxComponentMgr == nullptr)) {
+            HDF_LOGE("%{public}s can not find component %{public}s", __func__, componentName);
+            return OMX_ErrorMax;
         }
-        err = it->omxComponentMgr->CreateComponentInstance(componentName, callbacks, appData, component);
-        std::vector<std::string> roles;
-        it->omxComponentMgr->GetRolesForComponent(componentName, &roles);
-        if (err != OMX_ErrorNone) {
-            HDF_LOGE("%{public}s CreateComponentInstance error %{public}x", __func__, err);
-            break;
+        ComponentEntry &entry = it->second;
+        if ((totalInstances_ >= MAX_TOTAL_INSTANCES) ||
+            ((entry.maxInstances != 0) && (entry.instances >= entry.maxInstances))) {
+            HDF_LOGE("%{public}s %{public}s has %{public}u of %{public}u instances, %{public}u in total", __func__,
+                     componentName, entry.instances, entry.maxInstances, totalInstances_);
+            return OMX_ErrorInsufficientResources;
         }
-        ComponentTypePointAndObjectPoint point;
-        point.componentType = *component;
-        point.omxComponentMgr = it->omxComponentMgr;
-        componentTypePointAndObjectPoint_.push_back(point);
-        currentComType_ = *component;
-        currentComName_ = componentName;
+        // the slot is taken before the vendor creates the instance, which may take long
+        entry.instances++;
+        totalInstances_++;
+        omxComponentMgr = entry.omxComponentMgr;
+    }
+
+    int32_t err = omxComponentMgr->CreateComponentInstance(componentName, callbacks, appData, component);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ((err != OMX_ErrorNone) || (*component == nullptr)) {
+        HDF_LOGE("%{public}s CreateComponentInstance error %{public}x", __func__, err);
+        components_[componentName].instances--;
+        totalInstances_--;
+        return (err != OMX_ErrorNone) ? err : OMX_ErrorUndefined;
     }
+    InstanceInfo info;
+    info.componentName = componentName;
+    info.omxComponentMgr = omxComponentMgr;
+    info.id = nextInstanceId_++;
+    info.deleting = false;
+    HDF_LOGI("%{public}s %{public}s instance %{public}u, %{public}u in total", __func__, componentName, info.id,
+             totalInstances_);
+    instances_[*component] = std::move(info);
     return err;
 }
 
 int32_t ComponentMgr::DeleteComponentInstance(OMX_COMPONENTTYPE *component)
 {
-    std::vector<ComponentTypePointAndObjectPoint>::iterator it;
-    for (it = componentTypePointAndObjectPoint_.begin(); it != componentTypePointAndObjectPoint_.end(); ++it) {
-        if (it->componentType == component) {
-            IComponentMgr *pOMXComponentMgr = it->omxComponentMgr;
-            componentTypePointAndObjectPoint_.erase(it);
-            if (pOMXComponentMgr != nullptr) {
-                return pOMXComponentMgr->DeleteComponentInstance(component);
-            }
+    IComponentMgr *omxComponentMgr = nullptr;
+    std::string componentName;
+    uint32_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = instances_.find(component);
+        if ((it == instances_.end()) || it->second.deleting) {
+            HDF_LOGE("%{public}s can not find handle [0x%{public}p]", __func__, component);
+            return OMX_ErrorMax;
+        }
+        if (it->second.omxComponentMgr == nullptr) {
             return OMX_ErrorMax;
         }
+        omxComponentMgr = it->second.omxComponentMgr;
+        componentName = it->second.componentName;
+        id = it->second.id;
+        // the vendor may take long, a second delete of the handle is refused meanwhile
+        it->second.deleting = true;
     }
-    return OMX_ErrorMax;
+
+    int32_t err = omxComponentMgr->DeleteComponentInstance(component);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = instances_.find(component);
+    // once the vendor freed it, a create may have got the same handle already
+    bool same = (it != instances_.end()) && (it->second.id == id);
+    if (err != OMX_ErrorNone) {
+        // the instance still lives, it keeps its slot and may be deleted again
+        HDF_LOGE("%{public}s %{public}s instance %{public}u DeleteComponentInstance error %{public}x", __func__,
+                 componentName.c_str(), id, err);
+        if (same) {
+            it->second.deleting = false;
+        }
+        return err;
+    }
+    HDF_LOGI("%{public}s %{public}s instance %{public}u", __func__, componentName.c_str(), id);
+    // the handle is invalid from here on, the next create may reuse the slot
+    components_[componentName].instances--;
+    totalInstances_--;
+    if (same) {
+        instances_.erase(it);
+    }
+    return err;
 }
 
 int32_t ComponentMgr::EnumerateComponentsByIndex(uint32_t index, char *componentName, size_t componentNameSize)
 {
-    size_t componentNum = componentNameAndObjectPoint_.size();
+    size_t componentNum = componentNames_.size();
     if (index >= componentNum) {
         HDF_LOGE("%{public}s index [%{public}d] > componentNum [%{public}zu]", __func__, index, componentNum);
         return OMX_ErrorInvalidComponentName;
     }
-    std::string &compName = componentNameAndObjectPoint_[index].componentName;
+    std::string &compName = componentNames_[index];
     if (componentNameSize < compName.length() + 1) {
         HDF_LOGE("%{public}s componentNameSize [%{public}d] is too short", __func__, index);
         return OMX_ErrorMax;
@@ -128,20 +209,15 @@ int32_t ComponentMgr::GetRolesForComponent(const char *componentName, std::vecto
         return OMX_ErrorMax;
     }
     roles->clear();
-    std::vector<ComponentNameAndObjectPoint>::iterator it;
-    for (it = componentNameAndObjectPoint_.begin(); it != componentNameAndObjectPoint_.end(); ++it) {
-        if (strcmp(componentName, it->componentName.c_str()) != 0) {
-            continue;
-        }
-        if (it->omxComponentMgr == nullptr) {
-            HDF_LOGE("%{public}s omxComponentMgr is null", __func__);
-            return OMX_ErrorInvalidComponentName;
-        }
-
-        int32_t err = it->omxComponentMgr->GetRolesForComponent(componentName, roles);
-        return err;
+    auto it = components_.find(componentName);
+    if (it == components_.end()) {
+        return OMX_ErrorInvalidComponentName;
     }
-    return OMX_ErrorInvalidComponentName;
+    if (it->second.omxComponentMgr == nullptr) {
+        HDF_LOGE("%{public}s omxComponentMgr is null", __func__);
+        return OMX_ErrorInvalidComponentName;
+    }
+    return it->second.omxComponentMgr->GetRolesForComponent(componentName, roles);
 }
 
 void ComponentMgr::AddVendorComponent()
@@ -150,7 +226,21 @@ void ComponentMgr::AddVendorComponent()
 }
 
 void ComponentMgr::AddSoftComponent()
-{}
+{
+#ifdef CODEC_SOFT_COMPONENT_ENABLE
+    IComponentMgr *soft = new (std::nothrow) SoftComponentMgr();
+    if (soft == nullptr) {
+        HDF_LOGE("%{public}s: new SoftComponentMgr failed", __func__);
+        return;
+    }
+    ComponentInfo info;
+    info.omxComponent = soft;
+    info.LibHandle = nullptr;
+    componentsList_.push_back(info);
+    AddComponentByInstance(soft);
+    loadLibSuc_ = true;
+#endif
+}
 
 void ComponentMgr::AddComponentByLibName(const char *libName)
 {
@@ -189,35 +279,31 @@ void ComponentMgr::AddComponentByInstance(IComponentMgr *pMrg)
 {
     uint32_t index = 0;
     char name[COMPONENT_NAME_MAX_LEN];
-    bool exists = false;
     int32_t err;
     while ((err = pMrg->EnumerateComponentsByIndex(index++, name, sizeof(name))) == OMX_ErrorNone) {
-        std::vector<ComponentNameAndObjectPoint>::iterator it;
-        for (it = componentNameAndObjectPoint_.begin(); it != componentNameAndObjectPoint_.end(); ++it) {
-            if (strcmp(name, it->componentName.c_str()) == 0) {
-                exists = true;
-                break;
-            }
-        }
-        if (exists) {
-            exists = false;
+        // the first to register a name keeps it
+        ComponentEntry entry = {pMrg, DEFAULT_MAX_INSTANCES, 0};
+        if (!components_.emplace(name, entry).second) {
             continue;
         }
         HDF_LOGI("ComponentMgr::AddComponentByInstance:component name=%{public}s", name);
-        ComponentNameAndObjectPoint point;
-        point.componentName = name;
-        point.omxComponentMgr = pMrg;
-        componentNameAndObjectPoint_.push_back(point);
+        componentNames_.push_back(name);
     }
 }
 
 void ComponentMgr::CleanComponent()
 {
-    componentNameAndObjectPoint_.clear();
-    componentTypePointAndObjectPoint_.clear();
+    componentNames_.clear();
+    components_.clear();
+    instances_.clear();
 
     typedef void (*DestroyOMXPluginFunc)(IComponentMgr *);
     for (const ComponentInfo &comInfo : componentsList_) {
+        // built in, nothing is loaded for it
+        if (comInfo.LibHandle == nullptr) {
+            delete comInfo.omxComponent;
+            continue;
+        }
         DestroyOMXPluginFunc destroyOMXPlugin = (DestroyOMXPluginFunc)dlsym(comInfo.LibHandle, "destroyOMXPlugin");
         if (destroyOMXPlugin != nullptr) {
             destroyOMXPlugin(comInfo.omxComponent);
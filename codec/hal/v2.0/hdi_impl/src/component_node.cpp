@@ -27,9 +27,45 @@
 #define HDF_LOG_TAG codec_hdi_server
 #define FD_SIZE     sizeof(int)
 constexpr int ROLE_MAX_LEN = 256;
+constexpr int HISTOGRAM_TEXT_LEN = 256;
+constexpr uint32_t SPEC_VERSION_MAJOR = 1;
+constexpr uint32_t SPEC_VERSION_MINOR = 1;
 namespace OHOS {
 namespace Codec {
 namespace Omx {
+static unsigned long long Average(const struct CodecHistogram &histogram)
+{
+    return (unsigned long long)CodecHistogramAverage(&histogram);
+}
+
+static void LogTelemetry(const char *func, const struct ComponentTelemetryStats &stats, bool histograms)
+{
+    const char *names[TELEMETRY_DIRECTION_NUM] = {"input", "output"};
+    for (uint32_t dir = 0; dir < TELEMETRY_DIRECTION_NUM; dir++) {
+        const struct PortTelemetry &port = stats.ports[dir];
+        HDF_LOGI("%{public}s %{public}s port %{public}u queued %{public}llu returned %{public}llu held %{public}u"
+                 " max %{public}u, turnaround avg %{public}llu max %{public}llu us, depth avg %{public}llu", func,
+                 names[dir], port.portIndex, (unsigned long long)port.queued, (unsigned long long)port.returned,
+                 port.held, port.maxHeld, Average(port.turnaroundUs), (unsigned long long)port.turnaroundUs.max,
+                 Average(port.depth));
+        if (histograms) {
+            char text[HISTOGRAM_TEXT_LEN];
+            CodecHistogramFormat(&port.turnaroundUs, text, sizeof(text));
+            HDF_LOGI("%{public}s %{public}s turnaround us [%{public}s]", func, names[dir], text);
+            CodecHistogramFormat(&port.depth, text, sizeof(text));
+            HDF_LOGI("%{public}s %{public}s depth [%{public}s]", func, names[dir], text);
+        }
+    }
+    HDF_LOGI("%{public}s latency %{public}llu frames avg %{public}llu max %{public}llu us, stalls %{public}u", func,
+             (unsigned long long)stats.latencyUs.count, Average(stats.latencyUs),
+             (unsigned long long)stats.latencyUs.max, stats.stalls);
+    if (histograms) {
+        char text[HISTOGRAM_TEXT_LEN];
+        CodecHistogramFormat(&stats.latencyUs, text, sizeof(text));
+        HDF_LOGI("%{public}s latency us [%{public}s]", func, text);
+    }
+}
+
 OMX_ERRORTYPE ComponentNode::OnEvent(OMX_HANDLETYPE component, void *appData, OMX_EVENTTYPE event, uint32_t data1,
                                      uint32_t data2, void *eventData)
 {
@@ -80,6 +116,12 @@ ComponentNode::ComponentNode(struct CodecCallbackType *callback, int8_t *appData
     bufferHeaderMap_.clear();
     omxCallback_ = callback;
     bufferIdCount_ = 0;
+    zeroCopyBuffers_ = 0;
+    copyBuffers_ = 0;
+    inputCopies_ = 0;
+    inputBytes_ = 0;
+    outputCopies_ = 0;
+    outputBytes_ = 0;
 #ifdef NODE_DEBUG
     char filename[256] = {0};
     (void)snprintf_s(filename, sizeof(filename), sizeof(filename) - 1, "/data/codec_in_%p.h264", this);
@@ -91,6 +133,15 @@ ComponentNode::ComponentNode(struct CodecCallbackType *callback, int8_t *appData
 
 ComponentNode::~ComponentNode()
 {
+    struct BufferCopyStats stats = {0};
+    GetBufferStats(stats);
+    HDF_LOGI("%{public}s buffers zero copy %{public}u copy %{public}u, input copies %{public}llu bytes %{public}llu,"
+             " output copies %{public}llu bytes %{public}llu", __func__, stats.zeroCopyBuffers, stats.copyBuffers,
+             (unsigned long long)stats.inputCopies, (unsigned long long)stats.inputBytes,
+             (unsigned long long)stats.outputCopies, (unsigned long long)stats.outputBytes);
+    struct ComponentTelemetryStats telemetry;
+    GetTelemetry(telemetry);
+    LogTelemetry(__func__, telemetry, false);
 #ifdef NODE_DEBUG
     if (fp_in != nullptr) {
         fclose(fp_in);
@@ -312,6 +363,8 @@ int32_t ComponentNode::OnEmptyBufferDone(OMX_BUFFERHEADERTYPE *buffer)
         HDF_LOGE("%{public}s get bufferinfo by header[0x%{public}p] error", __func__, buffer);
         return OMX_ErrorNone;
     }
+    telemetry_.OnReturned(TELEMETRY_INPUT, bufferInfo->omxCodecBuffer.bufferId, buffer->nTimeStamp,
+                          buffer->nFilledLen);
 
     struct OmxCodecBuffer &omxCodecBuffer = bufferInfo->omxCodecBuffer;
     switch (omxCodecBuffer.bufferType) {
@@ -355,14 +408,21 @@ int32_t ComponentNode::OnFillBufferDone(OMX_BUFFERHEADERTYPE *buffer)
         HDF_LOGE("%{public}s error, GetBufferInfoByHeader return null", __func__);
         return OMX_ErrorNone;
     }
+    telemetry_.OnReturned(TELEMETRY_OUTPUT, bufferInfo->omxCodecBuffer.bufferId, buffer->nTimeStamp,
+                          buffer->nFilledLen);
 
     struct OmxCodecBuffer &omxCodecBuffer = bufferInfo->omxCodecBuffer;
 
     switch (omxCodecBuffer.bufferType) {
         case BUFFER_TYPE_AVSHARE_MEM_FD: {
-            if (!bufferInfo->sharedMem->WriteToAshmem(buffer->pBuffer, buffer->nFilledLen, buffer->nOffset)) {
-                HDF_LOGE("%{public}s write to ashmem fail", __func__);
-                return OMX_ErrorNone;
+            // the component wrote the frame into the shared memory itself
+            if (!bufferInfo->zeroCopy) {
+                if (!bufferInfo->sharedMem->WriteToAshmem(buffer->pBuffer, buffer->nFilledLen, buffer->nOffset)) {
+                    HDF_LOGE("%{public}s write to ashmem fail", __func__);
+                    return OMX_ErrorNone;
+                }
+                outputCopies_++;
+                outputBytes_ += buffer->nFilledLen;
             }
 #ifdef NODE_DEBUG
             (void)fwrite(buffer->buffer + buffer->nOffset, 1, buffer->nFilledLen, fp_out);
@@ -485,6 +545,7 @@ int32_t ComponentNode::FreeBuffer(uint32_t portIndex, struct OmxCodecBuffer &buf
     }
     if (err == OMX_ErrorNone) {
         ReleaseBufferById(buffer.bufferId);
+        telemetry_.OnFreed(buffer.bufferId);
         bufferInfo = nullptr;
     }
     return err;
@@ -534,7 +595,13 @@ int32_t ComponentNode::EmptyThisBuffer(struct OmxCodecBuffer &buffer)
         bufferHdrType->nOffset = buffer.offset;
         bufferHdrType->nFilledLen = buffer.filledLen;
         bufferHdrType->nFlags = buffer.flag;
+        bufferHdrType->nTimeStamp = buffer.pts;
+        // recorded first, the component may return the buffer before the call does
+        telemetry_.OnQueued(TELEMETRY_INPUT, bufferHdrType->nInputPortIndex, buffer.bufferId, buffer.pts);
         err = OMX_EmptyThisBuffer((OMX_HANDLETYPE)comp_, bufferHdrType);
+        if (err != OMX_ErrorNone) {
+            telemetry_.OnRejected(TELEMETRY_INPUT, buffer.bufferId);
+        }
     }
     return err;
 }
@@ -587,7 +654,11 @@ int32_t ComponentNode::FillThisBuffer(struct OmxCodecBuffer &buffer)
         // check this
         bufferHdrType->nOffset = buffer.offset;
         bufferHdrType->nFilledLen = buffer.filledLen;
+        telemetry_.OnQueued(TELEMETRY_OUTPUT, bufferHdrType->nOutputPortIndex, buffer.bufferId, buffer.pts);
         err = OMX_FillThisBuffer((OMX_HANDLETYPE)comp_, bufferHdrType);
+        if (err != OMX_ErrorNone) {
+            telemetry_.OnRejected(TELEMETRY_OUTPUT, buffer.bufferId);
+        }
     }
     return err;
 }
@@ -622,6 +693,7 @@ BufferInfoSPtr ComponentNode::GetBufferInfoByHeader(OMX_BUFFERHEADERTYPE *buffer
         return nullptr;
     }
 
+    std::lock_guard<std::mutex> lock(bufferMutex_);
     auto iterHead = bufferHeaderMap_.find(buffer);
     if (iterHead == bufferHeaderMap_.end()) {
         HDF_LOGE("%{public}s can not find bufferID by pHeaderType = 0x%{public}p", __func__, buffer);
@@ -645,6 +717,7 @@ BufferInfoSPtr ComponentNode::GetBufferInfoByHeader(OMX_BUFFERHEADERTYPE *buffer
 
 bool ComponentNode::GetBufferById(uint32_t bufferId, BufferInfoSPtr &bufferInfo, OMX_BUFFERHEADERTYPE *&bufferHdrType)
 {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
     auto iter = bufferInfoMap_.find(bufferId);
     if ((iter == bufferInfoMap_.end()) || (iter->second == nullptr)) {
         HDF_LOGE("%{public}s error, can not find bufferIndo by bufferID [%{public}d]", __func__, bufferId);
@@ -669,6 +742,7 @@ bool ComponentNode::GetBufferById(uint32_t bufferId, BufferInfoSPtr &bufferInfo,
 
 void ComponentNode::ReleaseBufferById(uint32_t bufferId)
 {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
     auto iter = bufferInfoMap_.find(bufferId);
     if ((iter == bufferInfoMap_.end()) || (iter->second == nullptr)) {
         HDF_LOGE("%{public}s error, can not find bufferIndo by bufferID [%{public}d]", __func__, bufferId);
@@ -723,6 +797,23 @@ int32_t ComponentNode::UseSharedBuffer(struct OmxCodecBuffer &omxCodecBuffer, ui
         return err;
     }
 
+    // bind a writable mapping as it is, components that can not use a buffer of the client refuse it.
+    // a read only mapping keeps a buffer of the component, which may write to the buffers it is given
+    void *mapped = nullptr;
+    if ((omxCodecBuffer.type == READ_WRITE_TYPE) && (size > 0) && (omxCodecBuffer.allocLen <= (uint32_t)size)) {
+        mapped = const_cast<void *>(sharedMem->ReadFromAshmem(size, 0));
+    }
+    if (mapped != nullptr) {
+        err = OMX_UseBuffer((OMX_HANDLETYPE)comp_, &bufferHdrType, portIndex, 0, omxCodecBuffer.allocLen,
+                            static_cast<OMX_U8 *>(mapped));
+        if (err == OMX_ErrorNone) {
+            SaveBufferInfo(omxCodecBuffer, bufferHdrType, sharedMem, true);
+            zeroCopyBuffers_++;
+            return err;
+        }
+        HDF_LOGI("%{public}s OMX_UseBuffer ret [0x%{public}x], copy the frames instead", __func__, err);
+    }
+
     err = OMX_AllocateBuffer((OMX_HANDLETYPE)comp_, &bufferHdrType, portIndex, 0, omxCodecBuffer.allocLen);
     if (err != OMX_ErrorNone) {
         HDF_LOGE("%{public}s error, OMX_AllocateBuffer failed", __func__);
@@ -732,6 +823,7 @@ int32_t ComponentNode::UseSharedBuffer(struct OmxCodecBuffer &omxCodecBuffer, ui
         return err;
     }
     SaveBufferInfo(omxCodecBuffer, bufferHdrType, sharedMem);
+    copyBuffers_++;
 
     return err;
 }
@@ -784,11 +876,16 @@ int32_t ComponentNode::EmptySharedBuffer(struct OmxCodecBuffer &buffer, BufferIn
                  buffer.filledLen, buffer.offset);
         return OMX_ErrorUndefined;
     }
-    auto ret = memcpy_s(bufferHdrType->pBuffer + buffer.offset, buffer.allocLen - buffer.offset, sharedPtr,
-                        buffer.filledLen);
-    if (ret != EOK) {
-        HDF_LOGE("%{public}s error, memcpy_s ret [%{public}d", __func__, ret);
-        return OMX_ErrorUndefined;
+    // the frame is at the same offset of the buffer the component reads
+    if (!bufferInfo->zeroCopy) {
+        auto ret = memcpy_s(bufferHdrType->pBuffer + buffer.offset, buffer.allocLen - buffer.offset, sharedPtr,
+                            buffer.filledLen);
+        if (ret != EOK) {
+            HDF_LOGE("%{public}s error, memcpy_s ret [%{public}d", __func__, ret);
+            return OMX_ErrorUndefined;
+        }
+        inputCopies_++;
+        inputBytes_ += buffer.filledLen;
     }
 
 #ifdef NODE_DEBUG
@@ -800,9 +897,10 @@ int32_t ComponentNode::EmptySharedBuffer(struct OmxCodecBuffer &buffer, BufferIn
 }
 
 void ComponentNode::SaveBufferInfo(struct OmxCodecBuffer &omxCodecBuffer, OMX_BUFFERHEADERTYPE *bufferHdrType,
-                                   std::shared_ptr<Ashmem> sharedMem)
+                                   std::shared_ptr<Ashmem> sharedMem, bool zeroCopy)
 {
     BufferInfoSPtr bufferInfo = std::make_shared<BufferInfo>();
+    std::lock_guard<std::mutex> lock(bufferMutex_);
     uint32_t bufferId = GenerateBufferId();
     // set bufferId
     omxCodecBuffer.bufferId = bufferId;
@@ -817,11 +915,105 @@ void ComponentNode::SaveBufferInfo(struct OmxCodecBuffer &omxCodecBuffer, OMX_BU
     bufferInfo->omxCodecBuffer.buffer = 0;
     bufferInfo->omxCodecBuffer.bufferLen = 0;
     bufferInfo->sharedMem = sharedMem;
+    bufferInfo->zeroCopy = zeroCopy;
     uint32_t bufferIdTemp = bufferId;
     bufferInfoMap_.insert(std::make_pair<uint32_t, BufferInfoSPtr>(std::move(bufferId), std::move(bufferInfo)));
     bufferHeaderMap_.insert(
         std::make_pair<OMX_BUFFERHEADERTYPE *, uint32_t>(std::move(bufferHdrType), std::move(bufferIdTemp)));
 }
+
+void ComponentNode::GetBufferStats(struct BufferCopyStats &stats) const
+{
+    stats.zeroCopyBuffers = zeroCopyBuffers_;
+    stats.copyBuffers = copyBuffers_;
+    stats.inputCopies = inputCopies_;
+    stats.inputBytes = inputBytes_;
+    stats.outputCopies = outputCopies_;
+    stats.outputBytes = outputBytes_;
+}
+
+void ComponentNode::GetTelemetry(struct ComponentTelemetryStats &stats) const
+{
+    telemetry_.GetStats(stats);
+}
+
+bool ComponentNode::CheckStall(uint32_t timeoutMs, bool forceFlush)
+{
+    if (comp_ == nullptr) {
+        return false;
+    }
+    // buffers stay with a component that is not executing
+    OMX_STATETYPE state = OMX_StateInvalid;
+    if (OMX_GetState(comp_, &state) != OMX_ErrorNone || state != OMX_StateExecuting) {
+        return false;
+    }
+    if (!telemetry_.CheckStall(timeoutMs)) {
+        return false;
+    }
+    HDF_LOGE("%{public}s component [%{public}p] returned no buffer for %{public}u ms", __func__, comp_, timeoutMs);
+    DumpPorts();
+    DumpBuffers();
+    struct ComponentTelemetryStats stats;
+    GetTelemetry(stats);
+    LogTelemetry(__func__, stats, true);
+    if (forceFlush) {
+        // the component returns what it holds through the callbacks
+        int32_t err = OMX_SendCommand(comp_, OMX_CommandFlush, OMX_ALL, nullptr);
+        HDF_LOGE("%{public}s flush component [%{public}p] ret [0x%{public}x]", __func__, comp_, err);
+    }
+    return true;
+}
+
+void ComponentNode::DumpPorts()
+{
+    struct ComponentTelemetryStats stats;
+    GetTelemetry(stats);
+    for (uint32_t dir = 0; dir < TELEMETRY_DIRECTION_NUM; dir++) {
+        if (stats.ports[dir].queued == 0) {
+            continue;
+        }
+        OMX_PARAM_PORTDEFINITIONTYPE def;
+        (void)memset_s(&def, sizeof(def), 0, sizeof(def));
+        def.nSize = sizeof(def);
+        def.nVersion.s.nVersionMajor = SPEC_VERSION_MAJOR;
+        def.nVersion.s.nVersionMinor = SPEC_VERSION_MINOR;
+        def.nPortIndex = stats.ports[dir].portIndex;
+        int32_t err = OMX_GetParameter(comp_, OMX_IndexParamPortDefinition, &def);
+        if (err != OMX_ErrorNone) {
+            HDF_LOGE("%{public}s port %{public}u ret [0x%{public}x]", __func__, def.nPortIndex, err);
+            continue;
+        }
+        HDF_LOGE("%{public}s port %{public}u dir %{public}d enabled %{public}d populated %{public}d buffers"
+                 " %{public}u min %{public}u size %{public}u", __func__, def.nPortIndex, def.eDir, def.bEnabled,
+                 def.bPopulated, def.nBufferCountActual, def.nBufferCountMin, def.nBufferSize);
+    }
+}
+
+void ComponentNode::DumpBuffers()
+{
+    // copied before bufferMutex_ is taken, the telemetry is never locked inside it
+    std::map<uint32_t, uint64_t> held[TELEMETRY_DIRECTION_NUM] = {telemetry_.GetHeld(TELEMETRY_INPUT),
+                                                                  telemetry_.GetHeld(TELEMETRY_OUTPUT)};
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    for (auto &header : bufferHeaderMap_) {
+        const char *owner = "client";
+        uint64_t heldUs = 0;
+        for (uint32_t dir = 0; dir < TELEMETRY_DIRECTION_NUM; dir++) {
+            auto iter = held[dir].find(header.second);
+            if (iter != held[dir].end()) {
+                owner = (dir == TELEMETRY_INPUT) ? "component input" : "component output";
+                heldUs = iter->second;
+            }
+        }
+        auto info = bufferInfoMap_.find(header.second);
+        int32_t bufferType = (info != bufferInfoMap_.end()) ? info->second->omxCodecBuffer.bufferType : -1;
+        OMX_BUFFERHEADERTYPE *hdr = header.first;
+        HDF_LOGE("%{public}s buffer %{public}u [%{public}p] type %{public}d ports %{public}u/%{public}u alloc"
+                 " %{public}u filled %{public}u offset %{public}u flags 0x%{public}x, %{public}s for %{public}llu us",
+                 __func__, header.second, hdr, bufferType, hdr->nInputPortIndex, hdr->nOutputPortIndex,
+                 hdr->nAllocLen, hdr->nFilledLen, hdr->nOffset, hdr->nFlags, owner, (unsigned long long)heldUs);
+    }
+}
 }  // namespace Omx
 }  // namespace Codec
 }  // namespace OHOS
\ No newline at end of file
@@ -29,16 +29,27 @@ ComponentNodeMgr::ComponentNodeMgr()
 
 ComponentNodeMgr::~ComponentNodeMgr()
 {
+    // the components are not called any more once their library goes
+    watchdog_.Stop();
     if (compMgr_ != nullptr) {
         compMgr_ = nullptr;
     }
 
+    std::lock_guard<std::mutex> lock(nodeMutex_);
     auto iter = nodeMaps_.begin();
     while (iter != nodeMaps_.end()) {
         iter = nodeMaps_.erase(iter);
     }
 }
 
+std::shared_ptr<ComponentNode> ComponentNodeMgr::GetNode(OMX_HANDLETYPE compHandle)
+{
+    // the node outlives a concurrent destroy while the caller holds it
+    std::lock_guard<std::mutex> lock(nodeMutex_);
+    auto iter = nodeMaps_.find(compHandle);
+    return (iter == nodeMaps_.end()) ? nullptr : iter->second;
+}
+
 int32_t ComponentNodeMgr::CreateComponent(OMX_HANDLETYPE *compHandle, char *compName, int8_t *appData,
                                           int32_t appDataSize, struct CodecCallbackType *callbacks)
 {
@@ -58,6 +69,8 @@ int32_t ComponentNodeMgr::CreateComponent(OMX_HANDLETYPE *compHandle, char *comp
 
     *compHandle = (OMX_HANDLETYPE)comp;
     node->SetHandle((OMX_HANDLETYPE)comp);
+    watchdog_.AddNode((OMX_HANDLETYPE)comp, node);
+    std::lock_guard<std::mutex> lock(nodeMutex_);
     nodeMaps_.emplace(std::make_pair(comp, node));
     return err;
 }
@@ -71,15 +84,20 @@ int32_t ComponentNodeMgr::DestoryComponent(OMX_HANDLETYPE compHandle)
 
     OMX_COMPONENTTYPE *comp = (OMX_COMPONENTTYPE *)compHandle;
 
-    auto iter = nodeMaps_.find((OMX_HANDLETYPE)comp);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
 
+    // the component calls back into the node until it is deleted
+    watchdog_.RemoveNode(compHandle);
     int32_t err = compMgr_->DeleteComponentInstance(comp);
     if (err == OMX_ErrorNone) {
-        nodeMaps_.erase(iter);
+        std::lock_guard<std::mutex> lock(nodeMutex_);
+        nodeMaps_.erase((OMX_HANDLETYPE)comp);
+    } else {
+        watchdog_.AddNode(compHandle, node);
     }
     return err;
 }
@@ -91,13 +109,13 @@ int32_t ComponentNodeMgr::GetComponentVersion(OMX_HANDLETYPE compHandle, struct
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
 
-    return iter->second->GetComponentVersion(verInfo);
+    return node->GetComponentVersion(verInfo);
 }
 
 int32_t ComponentNodeMgr::SendCommand(OMX_HANDLETYPE compHandle, enum OMX_COMMANDTYPE cmd, uint32_t param,
@@ -108,12 +126,12 @@ int32_t ComponentNodeMgr::SendCommand(OMX_HANDLETYPE compHandle, enum OMX_COMMAN
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->SendCommand(cmd, param, cmdData, cmdDataLen);
+    return node->SendCommand(cmd, param, cmdData, cmdDataLen);
 }
 
 int32_t ComponentNodeMgr::GetParameter(OMX_HANDLETYPE compHandle, enum OMX_INDEXTYPE paramIndex, int8_t *param,
@@ -124,12 +142,12 @@ int32_t ComponentNodeMgr::GetParameter(OMX_HANDLETYPE compHandle, enum OMX_INDEX
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->GetParameter(paramIndex, param, paramLen);
+    return node->GetParameter(paramIndex, param, paramLen);
 }
 
 int32_t ComponentNodeMgr::SetParameter(OMX_HANDLETYPE compHandle, enum OMX_INDEXTYPE paramIndex, int8_t *param,
@@ -140,12 +158,12 @@ int32_t ComponentNodeMgr::SetParameter(OMX_HANDLETYPE compHandle, enum OMX_INDEX
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->SetParameter(paramIndex, param, paramLen);
+    return node->SetParameter(paramIndex, param, paramLen);
 }
 
 int32_t ComponentNodeMgr::GetConfig(OMX_HANDLETYPE compHandle, enum OMX_INDEXTYPE index, int8_t *config,
@@ -156,12 +174,12 @@ int32_t ComponentNodeMgr::GetConfig(OMX_HANDLETYPE compHandle, enum OMX_INDEXTYP
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->GetConfig(index, config, configLen);
+    return node->GetConfig(index, config, configLen);
 }
 
 int32_t ComponentNodeMgr::SetConfig(OMX_HANDLETYPE compHandle, enum OMX_INDEXTYPE index, int8_t *config,
@@ -172,12 +190,12 @@ int32_t ComponentNodeMgr::SetConfig(OMX_HANDLETYPE compHandle, enum OMX_INDEXTYP
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->SetConfig(index, config, configLen);
+    return node->SetConfig(index, config, configLen);
 }
 
 int32_t ComponentNodeMgr::GetExtensionIndex(OMX_HANDLETYPE compHandle, const char *parameterName,
@@ -188,12 +206,12 @@ int32_t ComponentNodeMgr::GetExtensionIndex(OMX_HANDLETYPE compHandle, const cha
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->GetExtensionIndex(parameterName, indexType);
+    return node->GetExtensionIndex(parameterName, indexType);
 }
 
 int32_t ComponentNodeMgr::GetState(OMX_HANDLETYPE compHandle, enum OMX_STATETYPE *state)
@@ -203,12 +221,12 @@ int32_t ComponentNodeMgr::GetState(OMX_HANDLETYPE compHandle, enum OMX_STATETYPE
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->GetState(state);
+    return node->GetState(state);
 }
 
 int32_t ComponentNodeMgr::ComponentTunnelRequest(OMX_HANDLETYPE compHandle, uint32_t port,
@@ -220,12 +238,12 @@ int32_t ComponentNodeMgr::ComponentTunnelRequest(OMX_HANDLETYPE compHandle, uint
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->ComponentTunnelRequest(port, omxHandleTypeTunneledComp, tunneledPort, tunnelSetup);
+    return node->ComponentTunnelRequest(port, omxHandleTypeTunneledComp, tunneledPort, tunnelSetup);
 }
 
 int32_t ComponentNodeMgr::UseBuffer(OMX_HANDLETYPE compHandle, uint32_t portIndex, struct OmxCodecBuffer &buffer)
@@ -235,12 +253,12 @@ int32_t ComponentNodeMgr::UseBuffer(OMX_HANDLETYPE compHandle, uint32_t portInde
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->UseBuffer(portIndex, buffer);
+    return node->UseBuffer(portIndex, buffer);
 }
 
 int32_t ComponentNodeMgr::AllocateBuffer(OMX_HANDLETYPE compHandle, uint32_t portIndex, struct OmxCodecBuffer &buffer)
@@ -250,12 +268,12 @@ int32_t ComponentNodeMgr::AllocateBuffer(OMX_HANDLETYPE compHandle, uint32_t por
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->AllocateBuffer(portIndex, buffer);
+    return node->AllocateBuffer(portIndex, buffer);
 }
 
 int32_t ComponentNodeMgr::FreeBuffer(OMX_HANDLETYPE compHandle, uint32_t portIndex, struct OmxCodecBuffer &buffer)
@@ -265,12 +283,12 @@ int32_t ComponentNodeMgr::FreeBuffer(OMX_HANDLETYPE compHandle, uint32_t portInd
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->FreeBuffer(portIndex, buffer);
+    return node->FreeBuffer(portIndex, buffer);
 }
 
 int32_t ComponentNodeMgr::EmptyThisBuffer(OMX_HANDLETYPE compHandle, struct OmxCodecBuffer &buffer)
@@ -280,12 +298,12 @@ int32_t ComponentNodeMgr::EmptyThisBuffer(OMX_HANDLETYPE compHandle, struct OmxC
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->EmptyThisBuffer(buffer);
+    return node->EmptyThisBuffer(buffer);
 }
 
 int32_t ComponentNodeMgr::FillThisBuffer(OMX_HANDLETYPE compHandle, struct OmxCodecBuffer &buffer)
@@ -294,12 +312,12 @@ int32_t ComponentNodeMgr::FillThisBuffer(OMX_HANDLETYPE compHandle, struct OmxCo
         HDF_LOGE("%{public}s error loaded lib failed", __func__);
         return OMX_ErrorInvalidComponent;
     }
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->FillThisBuffer(buffer);
+    return node->FillThisBuffer(buffer);
 }
 
 int32_t ComponentNodeMgr::SetCallbacks(OMX_HANDLETYPE compHandle, struct CodecCallbackType *omxCallback,
@@ -309,12 +327,12 @@ int32_t ComponentNodeMgr::SetCallbacks(OMX_HANDLETYPE compHandle, struct CodecCa
         HDF_LOGE("%{public}s error loaded lib failed", __func__);
         return OMX_ErrorInvalidComponent;
     }
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->SetCallbacks(omxCallback, appData, appDataLen);
+    return node->SetCallbacks(omxCallback, appData, appDataLen);
 }
 
 int32_t ComponentNodeMgr::DeInit(OMX_HANDLETYPE compHandle)
@@ -323,12 +341,12 @@ int32_t ComponentNodeMgr::DeInit(OMX_HANDLETYPE compHandle)
         HDF_LOGE("%{public}s error loaded lib failed", __func__);
         return OMX_ErrorInvalidComponent;
     }
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->DeInit();
+    return node->DeInit();
 }
 
 int32_t ComponentNodeMgr::UseEglImage(OMX_HANDLETYPE compHandle, struct OmxCodecBuffer &buffer, uint32_t portIndex,
@@ -339,12 +357,12 @@ int32_t ComponentNodeMgr::UseEglImage(OMX_HANDLETYPE compHandle, struct OmxCodec
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->UseEglImage(buffer, portIndex, eglImage, eglImageLen);
+    return node->UseEglImage(buffer, portIndex, eglImage, eglImageLen);
 }
 
 int32_t ComponentNodeMgr::ComponentRoleEnum(OMX_HANDLETYPE compHandle, uint8_t *role, uint32_t roleLen, uint32_t index)
@@ -354,12 +372,12 @@ int32_t ComponentNodeMgr::ComponentRoleEnum(OMX_HANDLETYPE compHandle, uint8_t *
         return OMX_ErrorInvalidComponent;
     }
 
-    auto iter = nodeMaps_.find(compHandle);
-    if (iter == nodeMaps_.end()) {
+    std::shared_ptr<ComponentNode> node = GetNode(compHandle);
+    if (node == nullptr) {
         HDF_LOGE("%{public}s can not find nodeInstance by component %{public}p", __func__, compHandle);
         return OMX_ErrorInvalidComponent;
     }
-    return iter->second->ComponentRoleEnum(role, roleLen, index);
+    return node->ComponentRoleEnum(role, roleLen, index);
 }
 }  // namespace Omx
 }  // namespace Codec
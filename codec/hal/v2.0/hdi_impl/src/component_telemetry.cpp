@@ -0,0 +1,158 @@
+/*
+ * Copyright 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <securec.h>
+
+#include "component_telemetry.h"
+
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+constexpr size_t MAX_PENDING_INPUTS = 64;  // inputs without an output, a decoder may drop frames
+constexpr uint64_t US_PER_MS = 1000;
+
+ComponentTelemetry::ComponentTelemetry()
+{
+    (void)memset_s(&stats_, sizeof(stats_), 0, sizeof(stats_));
+    lastProgressUs_ = NowUs();
+    stalled_ = false;
+}
+
+uint64_t ComponentTelemetry::NowUs()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+}
+
+void ComponentTelemetry::OnQueued(TelemetryDirection dir, uint32_t portIndex, uint32_t bufferId, int64_t pts)
+{
+    uint64_t now = NowUs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    struct PortTelemetry &port = stats_.ports[dir];
+    // waiting for input is no stall, the time counts from the first input held
+    if (dir == TELEMETRY_INPUT && held_[dir].empty()) {
+        lastProgressUs_ = now;
+    }
+    port.portIndex = portIndex;
+    port.queued++;
+    held_[dir][bufferId] = now;
+    port.held = static_cast<uint32_t>(held_[dir].size());
+    if (port.held > port.maxHeld) {
+        port.maxHeld = port.held;
+    }
+    CodecHistogramAddSample(&port.depth, port.held);
+    if (dir == TELEMETRY_INPUT) {
+        pendingInputs_.push_back({bufferId, pts, now});
+        if (pendingInputs_.size() > MAX_PENDING_INPUTS) {
+            pendingInputs_.pop_front();
+        }
+    }
+}
+
+void ComponentTelemetry::OnRejected(TelemetryDirection dir, uint32_t bufferId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (held_[dir].erase(bufferId) == 0) {
+        return;
+    }
+    struct PortTelemetry &port = stats_.ports[dir];
+    port.queued--;
+    port.held = static_cast<uint32_t>(held_[dir].size());
+    if (dir != TELEMETRY_INPUT) {
+        return;
+    }
+    for (auto iter = pendingInputs_.rbegin(); iter != pendingInputs_.rend(); iter++) {
+        if (iter->bufferId == bufferId) {
+            pendingInputs_.erase(std::next(iter).base());
+            break;
+        }
+    }
+}
+
+void ComponentTelemetry::OnReturned(TelemetryDirection dir, uint32_t bufferId, int64_t pts, uint32_t filledLen)
+{
+    uint64_t now = NowUs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    lastProgressUs_ = now;
+    stalled_ = false;
+    auto held = held_[dir].find(bufferId);
+    if (held == held_[dir].end()) {
+        return;
+    }
+    struct PortTelemetry &port = stats_.ports[dir];
+    CodecHistogramAddSample(&port.turnaroundUs, now - held->second);
+    held_[dir].erase(held);
+    port.held = static_cast<uint32_t>(held_[dir].size());
+    port.returned++;
+    if (dir != TELEMETRY_OUTPUT || filledLen == 0) {
+        return;
+    }
+    // the inputs before the one of this pts produced no output of their own
+    for (auto iter = pendingInputs_.begin(); iter != pendingInputs_.end(); iter++) {
+        if (iter->pts == pts) {
+            CodecHistogramAddSample(&stats_.latencyUs, now - iter->queuedUs);
+            pendingInputs_.erase(pendingInputs_.begin(), std::next(iter));
+            break;
+        }
+    }
+}
+
+void ComponentTelemetry::OnFreed(uint32_t bufferId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uint32_t dir = 0; dir < TELEMETRY_DIRECTION_NUM; dir++) {
+        if (held_[dir].erase(bufferId) != 0) {
+            stats_.ports[dir].held = static_cast<uint32_t>(held_[dir].size());
+        }
+    }
+}
+
+bool ComponentTelemetry::CheckStall(uint32_t timeoutMs)
+{
+    uint64_t now = NowUs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    // without an output buffer the component waits for the client
+    if (held_[TELEMETRY_INPUT].empty() || held_[TELEMETRY_OUTPUT].empty()) {
+        stalled_ = false;
+        return false;
+    }
+    if (stalled_ || now - lastProgressUs_ < timeoutMs * US_PER_MS) {
+        return false;
+    }
+    stalled_ = true;
+    stats_.stalls++;
+    return true;
+}
+
+void ComponentTelemetry::GetStats(struct ComponentTelemetryStats &stats) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats = stats_;
+}
+
+std::map<uint32_t, uint64_t> ComponentTelemetry::GetHeld(TelemetryDirection dir) const
+{
+    uint64_t now = NowUs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<uint32_t, uint64_t> held;
+    for (auto &buffer : held_[dir]) {
+        held.emplace(buffer.first, now - buffer.second);
+    }
+    return held;
+}
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <hdf_log.h>
+
+#include "component_watchdog.h"
+
+#define HDF_LOG_TAG codec_hdi_server
+
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+constexpr uint32_t WATCHDOG_INTERVAL_MS = 1000;
+constexpr uint32_t WATCHDOG_TIMEOUT_MS = 3000;
+
+ComponentWatchdog::ComponentWatchdog() : stop_(false), config_({WATCHDOG_INTERVAL_MS, WATCHDOG_TIMEOUT_MS, false}) {}
+
+ComponentWatchdog::~ComponentWatchdog()
+{
+    Stop();
+}
+
+void ComponentWatchdog::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        nodes_.clear();
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ComponentWatchdog::SetConfig(const struct WatchdogConfig &config)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_ = config;
+    }
+    cond_.notify_all();
+}
+
+void ComponentWatchdog::AddNode(OMX_HANDLETYPE compHandle, std::weak_ptr<ComponentNode> node)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    nodes_[compHandle] = node;
+    if (!thread_.joinable() && !stop_) {
+        thread_ = std::thread(&ComponentWatchdog::Run, this);
+    }
+}
+
+void ComponentWatchdog::RemoveNode(OMX_HANDLETYPE compHandle)
+{
+    // waits for a check of the node that is running
+    std::lock_guard<std::mutex> lock(mutex_);
+    nodes_.erase(compHandle);
+}
+
+uint32_t ComponentWatchdog::CheckNodes()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return CheckNodesLocked();
+}
+
+uint32_t ComponentWatchdog::CheckNodesLocked()
+{
+    uint32_t stalls = 0;
+    auto iter = nodes_.begin();
+    while (iter != nodes_.end()) {
+        std::shared_ptr<ComponentNode> node = iter->second.lock();
+        if (node == nullptr) {
+            iter = nodes_.erase(iter);
+            continue;
+        }
+        if (node->CheckStall(config_.timeoutMs, config_.forceFlush)) {
+            HDF_LOGE("%{public}s component [%{public}p] stalled", __func__, iter->first);
+            stalls++;
+        }
+        iter++;
+    }
+    return stalls;
+}
+
+void ComponentWatchdog::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        auto interval = std::chrono::milliseconds(config_.intervalMs);
+        if (cond_.wait_for(lock, interval, [this] { return stop_; })) {
+            break;
+        }
+        (void)CheckNodesLocked();
+    }
+}
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
@@ -0,0 +1,626 @@
+/*
+ * Copyright 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <hdf_log.h>
+#include <securec.h>
+#include <vector>
+
+#include "codec_component_type.h"
+#include "soft_codecs.h"
+
+#define HDF_LOG_TAG codec_hdi_server
+constexpr uint32_t DEFAULT_WIDTH = 176;
+constexpr uint32_t DEFAULT_HEIGHT = 144;
+constexpr uint32_t MAX_SIZE = 8192;
+constexpr uint32_t DEFAULT_FRAMERATE = 30 << 16;  // Q16
+constexpr uint32_t DEFAULT_BITRATE = 1000000;
+constexpr uint32_t RLE_MAX_COUNT = 128;
+constexpr uint32_t RLE_MIN_RUN = 2;
+constexpr uint32_t RLE_LITERAL_BREAK = 3;  // a run this long ends a literal
+constexpr uint32_t RLE_RUN_BASE = 257;
+constexpr uint32_t PCM_BUFFER_SIZE = 8192;
+constexpr uint32_t PCM_CHANNELS = 2;
+constexpr uint32_t PCM_BITS = 16;
+constexpr uint32_t PCM_SAMPLE_RATE = 48000;
+constexpr uint32_t BITS_PER_BYTE = 8;
+constexpr int64_t US_PER_SECOND = 1000000;
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+namespace {
+struct YuvFrame {
+    uint8_t *y;
+    uint8_t *u;
+    uint8_t *v;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t chromaStride;
+    uint32_t chromaStep;  // 2 when the chroma is interleaved
+};
+
+inline uint32_t AlignEven(uint32_t value)
+{
+    return (value + 1) & ~1u;
+}
+
+bool IsRawFormat(OMX_COLOR_FORMATTYPE format)
+{
+    return (format == OMX_COLOR_FormatYUV420SemiPlanar) || (format == OMX_COLOR_FormatYUV420Planar);
+}
+
+YuvFrame MapFrame(uint8_t *data, const OMX_VIDEO_PORTDEFINITIONTYPE &video)
+{
+    YuvFrame frame;
+    uint32_t stride = (uint32_t)video.nStride;
+    frame.y = data;
+    frame.u = data + stride * video.nSliceHeight;
+    frame.width = video.nFrameWidth;
+    frame.height = video.nFrameHeight;
+    frame.stride = stride;
+    if (video.eColorFormat == OMX_COLOR_FormatYUV420SemiPlanar) {
+        frame.v = frame.u + 1;
+        frame.chromaStride = stride;
+        frame.chromaStep = 2;  // 2: CbCr pairs
+    } else {
+        frame.v = frame.u + (stride / 2) * (video.nSliceHeight / 2);  // 2: the chroma is subsampled by 2
+        frame.chromaStride = stride / 2;                               // 2: the chroma is subsampled by 2
+        frame.chromaStep = 1;
+    }
+    return frame;
+}
+
+// nearest neighbour, which is all a reference scaler needs
+void ScaleFrame(const YuvFrame &src, const YuvFrame &dst)
+{
+    std::vector<uint32_t> xMap(dst.width);
+    for (uint32_t x = 0; x < dst.width; x++) {
+        xMap[x] = x * src.width / dst.width;
+    }
+    bool sameSize = (src.width == dst.width) && (src.height == dst.height);
+    for (uint32_t y = 0; y < dst.height; y++) {
+        const uint8_t *srcRow = src.y + (y * src.height / dst.height) * src.stride;
+        uint8_t *dstRow = dst.y + y * dst.stride;
+        if (sameSize) {
+            (void)memcpy_s(dstRow, dst.stride, srcRow, dst.width);
+            continue;
+        }
+        for (uint32_t x = 0; x < dst.width; x++) {
+            dstRow[x] = srcRow[xMap[x]];
+        }
+    }
+    uint32_t srcChromaWidth = (src.width + 1) / 2;  // 2: the chroma is subsampled by 2
+    uint32_t srcChromaHeight = (src.height + 1) / 2;
+    uint32_t dstChromaWidth = (dst.width + 1) / 2;
+    uint32_t dstChromaHeight = (dst.height + 1) / 2;
+    for (uint32_t y = 0; y < dstChromaHeight; y++) {
+        uint32_t srcOffset = (y * srcChromaHeight / dstChromaHeight) * src.chromaStride;
+        uint32_t dstOffset = y * dst.chromaStride;
+        for (uint32_t x = 0; x < dstChromaWidth; x++) {
+            uint32_t sx = (x * srcChromaWidth / dstChromaWidth) * src.chromaStep;
+            dst.u[dstOffset + x * dst.chromaStep] = src.u[srcOffset + sx];
+            dst.v[dstOffset + x * dst.chromaStep] = src.v[srcOffset + sx];
+        }
+    }
+}
+}  // namespace
+
+SoftVideoComponent::SoftVideoComponent(const char *name, const char *role, OMX_VIDEO_CODINGTYPE inCoding,
+                                       OMX_VIDEO_CODINGTYPE outCoding)
+    : SoftComponent(name, role)
+{
+    coding_[SOFT_PORT_INPUT] = inCoding;
+    coding_[SOFT_PORT_OUTPUT] = outCoding;
+    for (uint32_t i = 0; i < SOFT_PORT_NUM; i++) {
+        OMX_PARAM_PORTDEFINITIONTYPE &def = PortDef(i);
+        def.eDomain = OMX_PortDomainVideo;
+        OMX_VIDEO_PORTDEFINITIONTYPE &video = def.format.video;
+        video.nFrameWidth = DEFAULT_WIDTH;
+        video.nFrameHeight = DEFAULT_HEIGHT;
+        video.nStride = DEFAULT_WIDTH;
+        video.nSliceHeight = DEFAULT_HEIGHT;
+        video.xFramerate = DEFAULT_FRAMERATE;
+        video.eCompressionFormat = coding_[i];
+        video.eColorFormat =
+            (coding_[i] == OMX_VIDEO_CodingUnused) ? OMX_COLOR_FormatYUV420SemiPlanar : OMX_COLOR_FormatUnused;
+        def.nBufferSize = GetFrameSize(video);
+    }
+}
+
+uint32_t SoftVideoComponent::GetFrameSize(const OMX_VIDEO_PORTDEFINITIONTYPE &video)
+{
+    return (uint32_t)video.nStride * video.nSliceHeight * 3 / 2;  // 3 / 2: the chroma is half the luma
+}
+
+OMX_ERRORTYPE SoftVideoComponent::SetPortFormat(uint32_t portIndex, const OMX_PARAM_PORTDEFINITIONTYPE &def)
+{
+    const OMX_VIDEO_PORTDEFINITIONTYPE &video = def.format.video;
+    bool raw = (coding_[portIndex] == OMX_VIDEO_CodingUnused);
+    if ((video.eCompressionFormat != coding_[portIndex]) || (raw && !IsRawFormat(video.eColorFormat))) {
+        HDF_LOGE("%{public}s error, port %{public}u coding %{public}d color %{public}d", __func__, portIndex,
+                 video.eCompressionFormat, video.eColorFormat);
+        return OMX_ErrorUnsupportedSetting;
+    }
+    if ((video.nFrameWidth == 0) || (video.nFrameWidth > MAX_SIZE) || (video.nFrameHeight == 0) ||
+        (video.nFrameHeight > MAX_SIZE)) {
+        HDF_LOGE("%{public}s error, size %{public}u x %{public}u", __func__, video.nFrameWidth, video.nFrameHeight);
+        return OMX_ErrorBadParameter;
+    }
+    OMX_VIDEO_PORTDEFINITIONTYPE &cur = PortDef(portIndex).format.video;
+    cur.nFrameWidth = video.nFrameWidth;
+    cur.nFrameHeight = video.nFrameHeight;
+    uint32_t stride = std::min(std::max(video.nStride, (OMX_S32)0), (OMX_S32)MAX_SIZE);
+    cur.nStride = AlignEven(std::max(stride, video.nFrameWidth));
+    cur.nSliceHeight = AlignEven(std::min(std::max(video.nSliceHeight, video.nFrameHeight), MAX_SIZE));
+    cur.nBitrate = video.nBitrate;
+    cur.xFramerate = video.xFramerate;
+    if (raw) {
+        cur.eColorFormat = video.eColorFormat;
+    }
+    OnPortFormatChanged(portIndex);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftVideoComponent::GetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param)
+{
+    if (index != OMX_IndexParamVideoPortFormat) {
+        return SoftComponent::GetCodecParameter(index, param);
+    }
+    OMX_VIDEO_PARAM_PORTFORMATTYPE *format = static_cast<OMX_VIDEO_PARAM_PORTFORMATTYPE *>(param);
+    if (format->nPortIndex >= SOFT_PORT_NUM) {
+        return OMX_ErrorBadPortIndex;
+    }
+    const OMX_COLOR_FORMATTYPE rawFormats[] = {OMX_COLOR_FormatYUV420SemiPlanar, OMX_COLOR_FormatYUV420Planar};
+    bool raw = (coding_[format->nPortIndex] == OMX_VIDEO_CodingUnused);
+    uint32_t count = raw ? sizeof(rawFormats) / sizeof(rawFormats[0]) : 1;
+    if (format->nIndex >= count) {
+        return OMX_ErrorNoMore;
+    }
+    format->eCompressionFormat = coding_[format->nPortIndex];
+    format->eColorFormat = raw ? rawFormats[format->nIndex] : OMX_COLOR_FormatUnused;
+    format->xFramerate = PortDef(format->nPortIndex).format.video.xFramerate;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftVideoComponent::SetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param)
+{
+    if (index != OMX_IndexParamVideoPortFormat) {
+        return SoftComponent::SetCodecParameter(index, param);
+    }
+    const OMX_VIDEO_PARAM_PORTFORMATTYPE *format = static_cast<const OMX_VIDEO_PARAM_PORTFORMATTYPE *>(param);
+    if (format->nPortIndex >= SOFT_PORT_NUM) {
+        return OMX_ErrorBadPortIndex;
+    }
+    if (IsPortActive(format->nPortIndex)) {
+        return OMX_ErrorIncorrectStateOperation;
+    }
+    OMX_PARAM_PORTDEFINITIONTYPE def = PortDef(format->nPortIndex);
+    def.format.video.eCompressionFormat = format->eCompressionFormat;
+    if (coding_[format->nPortIndex] == OMX_VIDEO_CodingUnused) {
+        def.format.video.eColorFormat = format->eColorFormat;
+    }
+    def.format.video.xFramerate = format->xFramerate;
+    return SetPortFormat(format->nPortIndex, def);
+}
+
+SoftRawDecoder::SoftRawDecoder()
+    : SoftVideoComponent(SOFT_RAW_DECODER_NAME, SOFT_RAW_DECODER_ROLE, OMX_VIDEO_CodingUnused,
+                         OMX_VIDEO_CodingUnused),
+      followInput_(true)
+{}
+
+void SoftRawDecoder::OnPortFormatChanged(uint32_t portIndex)
+{
+    OMX_PARAM_PORTDEFINITIONTYPE &input = PortDef(SOFT_PORT_INPUT);
+    OMX_PARAM_PORTDEFINITIONTYPE &output = PortDef(SOFT_PORT_OUTPUT);
+    if (portIndex == SOFT_PORT_OUTPUT) {
+        followInput_ = (output.format.video.nFrameWidth == input.format.video.nFrameWidth) &&
+                       (output.format.video.nFrameHeight == input.format.video.nFrameHeight);
+        output.nBufferSize = GetFrameSize(output.format.video);
+        return;
+    }
+    input.nBufferSize = GetFrameSize(input.format.video);
+    if (!followInput_) {
+        return;
+    }
+    OMX_VIDEO_PORTDEFINITIONTYPE &video = output.format.video;
+    if ((video.nFrameWidth == input.format.video.nFrameWidth) &&
+        (video.nFrameHeight == input.format.video.nFrameHeight)) {
+        return;
+    }
+    video.nFrameWidth = input.format.video.nFrameWidth;
+    video.nFrameHeight = input.format.video.nFrameHeight;
+    video.nStride = input.format.video.nStride;
+    video.nSliceHeight = input.format.video.nSliceHeight;
+    output.nBufferSize = GetFrameSize(video);
+    // the buffers of the output are too small or too large now
+    if (IsPortActive(SOFT_PORT_OUTPUT)) {
+        NotifyPortSettingsChanged(SOFT_PORT_OUTPUT);
+    }
+}
+
+OMX_ERRORTYPE SoftRawDecoder::Process(OMX_BUFFERHEADERTYPE &in, OMX_BUFFERHEADERTYPE &out, uint32_t &consumed)
+{
+    const OMX_VIDEO_PORTDEFINITIONTYPE &inVideo = PortDef(SOFT_PORT_INPUT).format.video;
+    const OMX_VIDEO_PORTDEFINITIONTYPE &outVideo = PortDef(SOFT_PORT_OUTPUT).format.video;
+    uint32_t inSize = GetFrameSize(inVideo);
+    uint32_t outSize = GetFrameSize(outVideo);
+    if (in.nFilledLen < inSize) {
+        HDF_LOGE("%{public}s error, %{public}u bytes is not a frame of %{public}u", __func__, in.nFilledLen, inSize);
+        return OMX_ErrorStreamCorrupt;
+    }
+    if (out.nAllocLen < outSize) {
+        return OMX_ErrorOverflow;
+    }
+    YuvFrame src = MapFrame(in.pBuffer + in.nOffset, inVideo);
+    YuvFrame dst = MapFrame(out.pBuffer, outVideo);
+    ScaleFrame(src, dst);
+    out.nFilledLen = outSize;
+    out.nFlags |= OMX_BUFFERFLAG_ENDOFFRAME;
+    // one frame a buffer, whatever follows it is padding
+    consumed = in.nFilledLen;
+    return OMX_ErrorNone;
+}
+
+SoftRleEncoder::SoftRleEncoder()
+    : SoftVideoComponent(SOFT_RLE_ENCODER_NAME, SOFT_RLE_ENCODER_ROLE, OMX_VIDEO_CodingUnused,
+                         OMX_VIDEO_CodingSoftRle),
+      controlRate_(OMX_Video_ControlRateVariable)
+{
+    OMX_PARAM_PORTDEFINITIONTYPE &output = PortDef(SOFT_PORT_OUTPUT);
+    output.format.video.nBitrate = DEFAULT_BITRATE;
+    output.nBufferSize = GetBound(GetFrameSize(PortDef(SOFT_PORT_INPUT).format.video));
+}
+
+uint32_t SoftRleEncoder::GetBound(uint32_t size)
+{
+    // a header for every literal of RLE_MAX_COUNT bytes, the runs are never longer than their bytes
+    return size + (size + RLE_MAX_COUNT - 1) / RLE_MAX_COUNT;
+}
+
+uint32_t SoftRleEncoder::Encode(const uint8_t *src, uint32_t srcSize, uint8_t *dst, uint32_t dstSize)
+{
+    uint32_t i = 0;
+    uint32_t o = 0;
+    while (i < srcSize) {
+        uint32_t run = 1;
+        while ((i + run < srcSize) && (run < RLE_MAX_COUNT) && (src[i + run] == src[i])) {
+            run++;
+        }
+        if (run >= RLE_MIN_RUN) {
+            if (o + 2 > dstSize) {  // 2: the count and the byte
+                return 0;
+            }
+            dst[o++] = (uint8_t)(RLE_RUN_BASE - run);
+            dst[o++] = src[i];
+            i += run;
+            continue;
+        }
+        uint32_t start = i;
+        uint32_t count = 0;
+        while ((i < srcSize) && (count < RLE_MAX_COUNT)) {
+            if ((i + RLE_LITERAL_BREAK <= srcSize) && (src[i] == src[i + 1]) && (src[i] == src[i + 2])) {
+                break;
+            }
+            i++;
+            count++;
+        }
+        if (o + 1 + count > dstSize) {
+            return 0;
+        }
+        dst[o++] = (uint8_t)(count - 1);
+        (void)memcpy_s(dst + o, dstSize - o, src + start, count);
+        o += count;
+    }
+    return o;
+}
+
+void SoftRleEncoder::OnPortFormatChanged(uint32_t portIndex)
+{
+    OMX_PARAM_PORTDEFINITIONTYPE &input = PortDef(SOFT_PORT_INPUT);
+    OMX_PARAM_PORTDEFINITIONTYPE &output = PortDef(SOFT_PORT_OUTPUT);
+    OMX_VIDEO_PORTDEFINITIONTYPE &video = output.format.video;
+    bool changed = (video.nFrameWidth != input.format.video.nFrameWidth) ||
+                   (video.nFrameHeight != input.format.video.nFrameHeight);
+    if (portIndex == SOFT_PORT_INPUT) {
+        input.nBufferSize = GetFrameSize(input.format.video);
+    }
+    // nothing is scaled, the coded frame has the size of the raw one
+    video.nFrameWidth = input.format.video.nFrameWidth;
+    video.nFrameHeight = input.format.video.nFrameHeight;
+    video.nStride = input.format.video.nStride;
+    video.nSliceHeight = input.format.video.nSliceHeight;
+    output.nBufferSize = GetBound(input.nBufferSize);
+    if ((portIndex == SOFT_PORT_INPUT) && changed && IsPortActive(SOFT_PORT_OUTPUT)) {
+        NotifyPortSettingsChanged(SOFT_PORT_OUTPUT);
+    }
+}
+
+OMX_ERRORTYPE SoftRleEncoder::GetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param)
+{
+    if (index != OMX_IndexParamVideoBitrate) {
+        return SoftVideoComponent::GetCodecParameter(index, param);
+    }
+    OMX_VIDEO_PARAM_BITRATETYPE *bitrate = static_cast<OMX_VIDEO_PARAM_BITRATETYPE *>(param);
+    if (bitrate->nPortIndex != SOFT_PORT_OUTPUT) {
+        return OMX_ErrorBadPortIndex;
+    }
+    bitrate->eControlRate = controlRate_;
+    bitrate->nTargetBitrate = PortDef(SOFT_PORT_OUTPUT).format.video.nBitrate;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftRleEncoder::SetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param)
+{
+    if (index != OMX_IndexParamVideoBitrate) {
+        return SoftVideoComponent::SetCodecParameter(index, param);
+    }
+    // kept for the client to read back, the coding is lossless and takes what it takes
+    const OMX_VIDEO_PARAM_BITRATETYPE *bitrate = static_cast<const OMX_VIDEO_PARAM_BITRATETYPE *>(param);
+    if (bitrate->nPortIndex != SOFT_PORT_OUTPUT) {
+        return OMX_ErrorBadPortIndex;
+    }
+    controlRate_ = bitrate->eControlRate;
+    PortDef(SOFT_PORT_OUTPUT).format.video.nBitrate = bitrate->nTargetBitrate;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftRleEncoder::CheckFrameSize(uint32_t width, uint32_t height)
+{
+    if ((width == 0) || (width > MAX_SIZE) || (height == 0) || (height > MAX_SIZE)) {
+        HDF_LOGE("%{public}s error, size %{public}u x %{public}u", __func__, width, height);
+        return OMX_ErrorBadParameter;
+    }
+    OMX_VIDEO_PORTDEFINITIONTYPE video = PortDef(SOFT_PORT_INPUT).format.video;
+    video.nStride = AlignEven(width);
+    video.nSliceHeight = AlignEven(height);
+    // the output buffers take the bound of an input buffer
+    if (GetFrameSize(video) > PortDef(SOFT_PORT_INPUT).nBufferSize) {
+        HDF_LOGE("%{public}s error, %{public}u x %{public}u needs the port to be reconfigured", __func__, width,
+                 height);
+        return OMX_ErrorUnsupportedSetting;
+    }
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftRleEncoder::CheckCodecConfig(OMX_INDEXTYPE index, const void *config)
+{
+    uint32_t size = *static_cast<const uint32_t *>(config);
+    switch (static_cast<uint32_t>(index)) {
+        case OMX_IndexConfigVideoBitrate: {
+            const OMX_VIDEO_CONFIG_BITRATETYPE *bitrate = static_cast<const OMX_VIDEO_CONFIG_BITRATETYPE *>(config);
+            if (size < sizeof(*bitrate)) {
+                return OMX_ErrorBadParameter;
+            }
+            if (bitrate->nPortIndex != SOFT_PORT_OUTPUT) {
+                return OMX_ErrorBadPortIndex;
+            }
+            return (bitrate->nEncodeBitrate == 0) ? OMX_ErrorBadParameter : OMX_ErrorNone;
+        }
+        case OMX_IndexConfigVideoFramerate: {
+            const OMX_CONFIG_FRAMERATETYPE *framerate = static_cast<const OMX_CONFIG_FRAMERATETYPE *>(config);
+            if (size < sizeof(*framerate)) {
+                return OMX_ErrorBadParameter;
+            }
+            if (framerate->nPortIndex != SOFT_PORT_OUTPUT) {
+                return OMX_ErrorBadPortIndex;
+            }
+            return (framerate->xEncodeFramerate == 0) ? OMX_ErrorBadParameter : OMX_ErrorNone;
+        }
+        case OMX_IndexConfigVideoIntraVOPRefresh: {
+            const OMX_CONFIG_INTRAREFRESHVOPTYPE *refresh = static_cast<const OMX_CONFIG_INTRAREFRESHVOPTYPE *>(config);
+            if (size < sizeof(*refresh)) {
+                return OMX_ErrorBadParameter;
+            }
+            return (refresh->nPortIndex != SOFT_PORT_OUTPUT) ? OMX_ErrorBadPortIndex : OMX_ErrorNone;
+        }
+        case OMX_IndexConfigVideoFrameSize: {
+            const CodecVideoFrameSize *frameSize = static_cast<const CodecVideoFrameSize *>(config);
+            if (size < sizeof(*frameSize)) {
+                return OMX_ErrorBadParameter;
+            }
+            if (frameSize->portIndex != SOFT_PORT_INPUT) {
+                return OMX_ErrorBadPortIndex;
+            }
+            return CheckFrameSize(frameSize->width, frameSize->height);
+        }
+        default:
+            return SoftVideoComponent::CheckCodecConfig(index, config);
+    }
+}
+
+OMX_ERRORTYPE SoftRleEncoder::ApplyCodecConfig(OMX_INDEXTYPE index, const void *config)
+{
+    OMX_PARAM_PORTDEFINITIONTYPE &input = PortDef(SOFT_PORT_INPUT);
+    OMX_PARAM_PORTDEFINITIONTYPE &output = PortDef(SOFT_PORT_OUTPUT);
+    switch (static_cast<uint32_t>(index)) {
+        case OMX_IndexConfigVideoBitrate:
+            // kept for the client to read back like the parameter
+            output.format.video.nBitrate = static_cast<const OMX_VIDEO_CONFIG_BITRATETYPE *>(config)->nEncodeBitrate;
+            return OMX_ErrorNone;
+        case OMX_IndexConfigVideoFramerate: {
+            OMX_U32 framerate = static_cast<const OMX_CONFIG_FRAMERATETYPE *>(config)->xEncodeFramerate;
+            input.format.video.xFramerate = framerate;
+            output.format.video.xFramerate = framerate;
+            return OMX_ErrorNone;
+        }
+        case OMX_IndexConfigVideoIntraVOPRefresh:
+            // every frame is coded on its own and already a sync frame
+            return OMX_ErrorNone;
+        case OMX_IndexConfigVideoFrameSize: {
+            const CodecVideoFrameSize *frameSize = static_cast<const CodecVideoFrameSize *>(config);
+            OMX_ERRORTYPE err = CheckFrameSize(frameSize->width, frameSize->height);
+            if (err != OMX_ErrorNone) {
+                return err;
+            }
+            // the buffer sizes stay, the frames following are smaller
+            for (OMX_PARAM_PORTDEFINITIONTYPE *def : {&input, &output}) {
+                def->format.video.nFrameWidth = frameSize->width;
+                def->format.video.nFrameHeight = frameSize->height;
+                def->format.video.nStride = AlignEven(frameSize->width);
+                def->format.video.nSliceHeight = AlignEven(frameSize->height);
+            }
+            return OMX_ErrorNone;
+        }
+        default:
+            return SoftVideoComponent::ApplyCodecConfig(index, config);
+    }
+}
+
+OMX_ERRORTYPE SoftRleEncoder::GetCodecConfig(OMX_INDEXTYPE index, OMX_PTR config)
+{
+    const OMX_VIDEO_PORTDEFINITIONTYPE &video = PortDef(SOFT_PORT_OUTPUT).format.video;
+    switch (static_cast<uint32_t>(index)) {
+        case OMX_IndexConfigVideoBitrate: {
+            OMX_VIDEO_CONFIG_BITRATETYPE *bitrate = static_cast<OMX_VIDEO_CONFIG_BITRATETYPE *>(config);
+            if (bitrate->nPortIndex != SOFT_PORT_OUTPUT) {
+                return OMX_ErrorBadPortIndex;
+            }
+            bitrate->nEncodeBitrate = video.nBitrate;
+            return OMX_ErrorNone;
+        }
+        case OMX_IndexConfigVideoFramerate: {
+            OMX_CONFIG_FRAMERATETYPE *framerate = static_cast<OMX_CONFIG_FRAMERATETYPE *>(config);
+            if (framerate->nPortIndex != SOFT_PORT_OUTPUT) {
+                return OMX_ErrorBadPortIndex;
+            }
+            framerate->xEncodeFramerate = video.xFramerate;
+            return OMX_ErrorNone;
+        }
+        case OMX_IndexConfigVideoFrameSize: {
+            CodecVideoFrameSize *frameSize = static_cast<CodecVideoFrameSize *>(config);
+            if (frameSize->portIndex >= SOFT_PORT_NUM) {
+                return OMX_ErrorBadPortIndex;
+            }
+            frameSize->width = PortDef(frameSize->portIndex).format.video.nFrameWidth;
+            frameSize->height = PortDef(frameSize->portIndex).format.video.nFrameHeight;
+            return OMX_ErrorNone;
+        }
+        default:
+            return SoftVideoComponent::GetCodecConfig(index, config);
+    }
+}
+
+OMX_ERRORTYPE SoftRleEncoder::Process(OMX_BUFFERHEADERTYPE &in, OMX_BUFFERHEADERTYPE &out, uint32_t &consumed)
+{
+    uint32_t size = Encode(in.pBuffer + in.nOffset, in.nFilledLen, out.pBuffer, out.nAllocLen);
+    if (size == 0) {
+        HDF_LOGE("%{public}s error, %{public}u bytes do not fit in %{public}u", __func__, in.nFilledLen,
+                 out.nAllocLen);
+        return OMX_ErrorOverflow;
+    }
+    out.nFilledLen = size;
+    out.nFlags |= OMX_BUFFERFLAG_SYNCFRAME | OMX_BUFFERFLAG_ENDOFFRAME;
+    consumed = in.nFilledLen;
+    return OMX_ErrorNone;
+}
+
+SoftPcmDecoder::SoftPcmDecoder() : SoftComponent(SOFT_PCM_DECODER_NAME, SOFT_PCM_DECODER_ROLE)
+{
+    for (uint32_t i = 0; i < SOFT_PORT_NUM; i++) {
+        OMX_PARAM_PORTDEFINITIONTYPE &def = PortDef(i);
+        def.eDomain = OMX_PortDomainAudio;
+        def.format.audio.eEncoding = OMX_AUDIO_CodingPCM;
+        def.nBufferSize = PCM_BUFFER_SIZE;
+    }
+    (void)memset_s(&pcm_, sizeof(pcm_), 0, sizeof(pcm_));
+    pcm_.nSize = sizeof(pcm_);
+    pcm_.nVersion = PortDef(SOFT_PORT_INPUT).nVersion;
+    pcm_.nChannels = PCM_CHANNELS;
+    pcm_.eNumData = OMX_NumericalDataSigned;
+    pcm_.eEndian = OMX_EndianLittle;
+    pcm_.bInterleaved = OMX_TRUE;
+    pcm_.nBitPerSample = PCM_BITS;
+    pcm_.nSamplingRate = PCM_SAMPLE_RATE;
+    pcm_.ePCMMode = OMX_AUDIO_PCMModeLinear;
+    pcm_.eChannelMapping[0] = OMX_AUDIO_ChannelLF;
+    pcm_.eChannelMapping[1] = OMX_AUDIO_ChannelRF;
+}
+
+OMX_ERRORTYPE SoftPcmDecoder::SetPortFormat(uint32_t portIndex, const OMX_PARAM_PORTDEFINITIONTYPE &def)
+{
+    if (def.format.audio.eEncoding != OMX_AUDIO_CodingPCM) {
+        HDF_LOGE("%{public}s error, port %{public}u encoding %{public}d", __func__, portIndex,
+                 def.format.audio.eEncoding);
+        return OMX_ErrorUnsupportedSetting;
+    }
+    // larger buffers are welcome, they hold more samples
+    PortDef(portIndex).nBufferSize = std::max(def.nBufferSize, PCM_BUFFER_SIZE);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftPcmDecoder::GetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param)
+{
+    if (index != OMX_IndexParamAudioPcm) {
+        return SoftComponent::GetCodecParameter(index, param);
+    }
+    OMX_AUDIO_PARAM_PCMMODETYPE *pcm = static_cast<OMX_AUDIO_PARAM_PCMMODETYPE *>(param);
+    if (pcm->nPortIndex >= SOFT_PORT_NUM) {
+        return OMX_ErrorBadPortIndex;
+    }
+    uint32_t portIndex = pcm->nPortIndex;
+    *pcm = pcm_;
+    pcm->nPortIndex = portIndex;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftPcmDecoder::SetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param)
+{
+    if (index != OMX_IndexParamAudioPcm) {
+        return SoftComponent::SetCodecParameter(index, param);
+    }
+    const OMX_AUDIO_PARAM_PCMMODETYPE *pcm = static_cast<const OMX_AUDIO_PARAM_PCMMODETYPE *>(param);
+    if (pcm->nPortIndex >= SOFT_PORT_NUM) {
+        return OMX_ErrorBadPortIndex;
+    }
+    // both ports carry the same samples
+    if (IsPortActive(SOFT_PORT_INPUT) || IsPortActive(SOFT_PORT_OUTPUT)) {
+        return OMX_ErrorIncorrectStateOperation;
+    }
+    if ((pcm->nChannels == 0) || (pcm->nChannels > OMX_AUDIO_MAXCHANNELS) || (pcm->nBitPerSample == 0) ||
+        ((pcm->nBitPerSample % BITS_PER_BYTE) != 0) || (pcm->nSamplingRate == 0)) {
+        HDF_LOGE("%{public}s error, channels %{public}u bits %{public}u rate %{public}u", __func__, pcm->nChannels,
+                 pcm->nBitPerSample, pcm->nSamplingRate);
+        return OMX_ErrorBadParameter;
+    }
+    pcm_ = *pcm;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftPcmDecoder::Process(OMX_BUFFERHEADERTYPE &in, OMX_BUFFERHEADERTYPE &out, uint32_t &consumed)
+{
+    uint32_t frameSize = pcm_.nChannels * pcm_.nBitPerSample / BITS_PER_BYTE;
+    uint32_t size = std::min(in.nFilledLen, out.nAllocLen);
+    // a split keeps whole sample frames on both sides
+    if (size < in.nFilledLen) {
+        size -= size % frameSize;
+    }
+    if (size == 0) {
+        return OMX_ErrorOverflow;
+    }
+    if (memcpy_s(out.pBuffer, out.nAllocLen, in.pBuffer + in.nOffset, size) != EOK) {
+        return OMX_ErrorUndefined;
+    }
+    out.nFilledLen = size;
+    consumed = size;
+    // the rest of the input starts that much later
+    uint64_t bytesPerSecond = (uint64_t)frameSize * pcm_.nSamplingRate;
+    in.nTimeStamp += (OMX_TICKS)((uint64_t)size * US_PER_SECOND / bytesPerSecond);
+    return OMX_ErrorNone;
+}
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
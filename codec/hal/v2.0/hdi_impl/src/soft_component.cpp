@@ -0,0 +1,938 @@
+/*
+ * Copyright 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <hdf_log.h>
+#include <securec.h>
+
+#include "codec_component_type.h"
+#include "soft_component.h"
+
+#define HDF_LOG_TAG codec_hdi_server
+constexpr uint8_t COMP_VERSION_MAJOR = 1;
+constexpr uint8_t SPEC_VERSION_MAJOR = 1;
+constexpr uint8_t SPEC_VERSION_MINOR = 1;
+constexpr uint8_t SPEC_REVISION = 2;
+constexpr uint32_t DEFAULT_BUFFER_COUNT = 4;
+constexpr uint32_t MIN_BUFFER_COUNT = 1;
+constexpr uint32_t MAX_CONFIG_SIZE = 1024;
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+SoftComponent::SoftComponent(const char *name, const char *role)
+    : name_(name), role_(role), appData_(nullptr), exit_(false), state_(OMX_StateLoaded),
+      targetState_(OMX_StateLoaded), queuedInputs_(0), doneInputs_(0)
+{
+    (void)memset_s(&callbacks_, sizeof(callbacks_), 0, sizeof(callbacks_));
+    for (uint32_t i = 0; i < SOFT_PORT_NUM; i++) {
+        OMX_PARAM_PORTDEFINITIONTYPE &def = ports_[i].def;
+        (void)memset_s(&def, sizeof(def), 0, sizeof(def));
+        def.nSize = sizeof(def);
+        def.nVersion.s.nVersionMajor = SPEC_VERSION_MAJOR;
+        def.nVersion.s.nVersionMinor = SPEC_VERSION_MINOR;
+        def.nVersion.s.nRevision = SPEC_REVISION;
+        def.nPortIndex = i;
+        def.eDir = (i == SOFT_PORT_INPUT) ? OMX_DirInput : OMX_DirOutput;
+        def.nBufferCountActual = DEFAULT_BUFFER_COUNT;
+        def.nBufferCountMin = MIN_BUFFER_COUNT;
+        def.bEnabled = OMX_TRUE;
+        def.bPopulated = OMX_FALSE;
+        def.bBuffersContiguous = OMX_FALSE;
+        def.nBufferAlignment = 1;
+    }
+    InitHandle(handle_);
+    handle_.pComponentPrivate = this;
+}
+
+SoftComponent::~SoftComponent()
+{
+    DeInit();
+}
+
+OMX_ERRORTYPE SoftComponent::Init(const OMX_CALLBACKTYPE *callbacks, void *appData)
+{
+    OMX_ERRORTYPE err = SetCallbacks(callbacks, appData);
+    if (err != OMX_ErrorNone) {
+        return err;
+    }
+    worker_ = std::thread(&SoftComponent::Run, this);
+    return OMX_ErrorNone;
+}
+
+SoftComponent *SoftComponent::FromHandle(OMX_HANDLETYPE handle)
+{
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    return static_cast<SoftComponent *>(static_cast<OMX_COMPONENTTYPE *>(handle)->pComponentPrivate);
+}
+
+void SoftComponent::InitHandle(OMX_COMPONENTTYPE &handle)
+{
+    (void)memset_s(&handle, sizeof(handle), 0, sizeof(handle));
+    handle.nSize = sizeof(handle);
+    handle.nVersion.s.nVersionMajor = SPEC_VERSION_MAJOR;
+    handle.nVersion.s.nVersionMinor = SPEC_VERSION_MINOR;
+    handle.nVersion.s.nRevision = SPEC_REVISION;
+    handle.GetComponentVersion = [](OMX_HANDLETYPE comp, OMX_STRING name, OMX_VERSIONTYPE *compVersion,
+                                    OMX_VERSIONTYPE *specVersion, OMX_UUIDTYPE *uuid) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent :
+                                   self->GetComponentVersion(name, compVersion, specVersion, uuid);
+    };
+    handle.SendCommand = [](OMX_HANDLETYPE comp, OMX_COMMANDTYPE cmd, OMX_U32 param, OMX_PTR cmdData) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->SendCommand(cmd, param, cmdData);
+    };
+    handle.GetParameter = [](OMX_HANDLETYPE comp, OMX_INDEXTYPE index, OMX_PTR param) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->GetParameter(index, param);
+    };
+    handle.SetParameter = [](OMX_HANDLETYPE comp, OMX_INDEXTYPE index, OMX_PTR param) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->SetParameter(index, param);
+    };
+    handle.GetConfig = [](OMX_HANDLETYPE comp, OMX_INDEXTYPE index, OMX_PTR config) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->GetConfig(index, config);
+    };
+    handle.SetConfig = [](OMX_HANDLETYPE comp, OMX_INDEXTYPE index, OMX_PTR config) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->SetConfig(index, config);
+    };
+    handle.GetExtensionIndex = [](OMX_HANDLETYPE comp, OMX_STRING name, OMX_INDEXTYPE *index) {
+        (void)name;
+        (void)index;
+        return (FromHandle(comp) == nullptr) ? OMX_ErrorInvalidComponent : OMX_ErrorUnsupportedIndex;
+    };
+    handle.GetState = [](OMX_HANDLETYPE comp, OMX_STATETYPE *state) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->GetState(state);
+    };
+    handle.ComponentTunnelRequest = [](OMX_HANDLETYPE comp, OMX_U32 port, OMX_HANDLETYPE tunneledComp,
+                                       OMX_U32 tunneledPort, OMX_TUNNELSETUPTYPE *tunnelSetup) {
+        (void)port;
+        (void)tunneledComp;
+        (void)tunneledPort;
+        (void)tunnelSetup;
+        return (FromHandle(comp) == nullptr) ? OMX_ErrorInvalidComponent : OMX_ErrorNotImplemented;
+    };
+    handle.UseBuffer = [](OMX_HANDLETYPE comp, OMX_BUFFERHEADERTYPE **header, OMX_U32 portIndex, OMX_PTR appPrivate,
+                          OMX_U32 size, OMX_U8 *buffer) {
+        SoftComponent *self = FromHandle(comp);
+        if (self == nullptr) {
+            return OMX_ErrorInvalidComponent;
+        }
+        return (buffer == nullptr) ? OMX_ErrorBadParameter :
+                                     self->AddBuffer(header, portIndex, appPrivate, size, buffer);
+    };
+    handle.AllocateBuffer = [](OMX_HANDLETYPE comp, OMX_BUFFERHEADERTYPE **header, OMX_U32 portIndex,
+                               OMX_PTR appPrivate, OMX_U32 size) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent :
+                                   self->AddBuffer(header, portIndex, appPrivate, size, nullptr);
+    };
+    handle.FreeBuffer = [](OMX_HANDLETYPE comp, OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->FreeBuffer(portIndex, header);
+    };
+    handle.EmptyThisBuffer = [](OMX_HANDLETYPE comp, OMX_BUFFERHEADERTYPE *header) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->QueueBuffer(SOFT_PORT_INPUT, header);
+    };
+    handle.FillThisBuffer = [](OMX_HANDLETYPE comp, OMX_BUFFERHEADERTYPE *header) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->QueueBuffer(SOFT_PORT_OUTPUT, header);
+    };
+    handle.SetCallbacks = [](OMX_HANDLETYPE comp, OMX_CALLBACKTYPE *callbacks, OMX_PTR appData) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->SetCallbacks(callbacks, appData);
+    };
+    handle.ComponentDeInit = [](OMX_HANDLETYPE comp) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->DeInit();
+    };
+    handle.UseEGLImage = [](OMX_HANDLETYPE comp, OMX_BUFFERHEADERTYPE **header, OMX_U32 portIndex,
+                            OMX_PTR appPrivate, void *eglImage) {
+        (void)header;
+        (void)portIndex;
+        (void)appPrivate;
+        (void)eglImage;
+        return (FromHandle(comp) == nullptr) ? OMX_ErrorInvalidComponent : OMX_ErrorNotImplemented;
+    };
+    handle.ComponentRoleEnum = [](OMX_HANDLETYPE comp, OMX_U8 *role, OMX_U32 index) {
+        SoftComponent *self = FromHandle(comp);
+        return (self == nullptr) ? OMX_ErrorInvalidComponent : self->RoleEnum(role, index);
+    };
+}
+
+OMX_ERRORTYPE SoftComponent::GetComponentVersion(OMX_STRING name, OMX_VERSIONTYPE *compVersion,
+                                                 OMX_VERSIONTYPE *specVersion, OMX_UUIDTYPE *uuid)
+{
+    if ((name == nullptr) || (compVersion == nullptr) || (specVersion == nullptr) || (uuid == nullptr)) {
+        HDF_LOGE("%{public}s error, invalid param", __func__);
+        return OMX_ErrorBadParameter;
+    }
+    if (strcpy_s(name, OMX_MAX_STRINGNAME_SIZE, name_.c_str()) != EOK) {
+        return OMX_ErrorBadParameter;
+    }
+    compVersion->nVersion = 0;
+    compVersion->s.nVersionMajor = COMP_VERSION_MAJOR;
+    *specVersion = handle_.nVersion;
+    // unique while the instance lives, which is all a UUID of a component has to be
+    const SoftComponent *self = this;
+    (void)memset_s(*uuid, sizeof(OMX_UUIDTYPE), 0, sizeof(OMX_UUIDTYPE));
+    (void)memcpy_s(*uuid, sizeof(OMX_UUIDTYPE), &self, sizeof(self));
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftComponent::SendCommand(OMX_COMMANDTYPE cmd, uint32_t param, OMX_PTR cmdData)
+{
+    (void)cmdData;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == OMX_StateInvalid) {
+        return OMX_ErrorInvalidState;
+    }
+    switch (cmd) {
+        case OMX_CommandStateSet:
+            break;
+        case OMX_CommandFlush:
+        case OMX_CommandPortDisable:
+        case OMX_CommandPortEnable:
+            if ((param >= SOFT_PORT_NUM) && (param != OMX_ALL)) {
+                HDF_LOGE("%{public}s error, invalid port %{public}u", __func__, param);
+                return OMX_ErrorBadPortIndex;
+            }
+            break;
+        default:
+            HDF_LOGE("%{public}s error, command %{public}d is not implement", __func__, cmd);
+            return OMX_ErrorNotImplemented;
+    }
+    commands_.push_back({cmd, param});
+    cond_.notify_one();
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftComponent::GetParameter(OMX_INDEXTYPE index, OMX_PTR param)
+{
+    if (param == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch (index) {
+        case OMX_IndexParamPortDefinition: {
+            OMX_PARAM_PORTDEFINITIONTYPE *def = static_cast<OMX_PARAM_PORTDEFINITIONTYPE *>(param);
+            if (def->nPortIndex >= SOFT_PORT_NUM) {
+                return OMX_ErrorBadPortIndex;
+            }
+            *def = ports_[def->nPortIndex].def;
+            return OMX_ErrorNone;
+        }
+        case OMX_IndexParamAudioInit:
+        case OMX_IndexParamVideoInit:
+        case OMX_IndexParamImageInit:
+        case OMX_IndexParamOtherInit: {
+            OMX_PORT_PARAM_TYPE *portParam = static_cast<OMX_PORT_PARAM_TYPE *>(param);
+            OMX_PORTDOMAINTYPE domain = ports_[SOFT_PORT_INPUT].def.eDomain;
+            bool owned = ((index == OMX_IndexParamAudioInit) && (domain == OMX_PortDomainAudio)) ||
+                         ((index == OMX_IndexParamVideoInit) && (domain == OMX_PortDomainVideo)) ||
+                         ((index == OMX_IndexParamImageInit) && (domain == OMX_PortDomainImage)) ||
+                         ((index == OMX_IndexParamOtherInit) && (domain == OMX_PortDomainOther));
+            portParam->nPorts = owned ? (uint32_t)SOFT_PORT_NUM : 0;
+            portParam->nStartPortNumber = 0;
+            return OMX_ErrorNone;
+        }
+        case OMX_IndexParamCompBufferSupplier: {
+            OMX_PARAM_BUFFERSUPPLIERTYPE *supplier = static_cast<OMX_PARAM_BUFFERSUPPLIERTYPE *>(param);
+            if (supplier->nPortIndex >= SOFT_PORT_NUM) {
+                return OMX_ErrorBadPortIndex;
+            }
+            supplier->eBufferSupplier = OMX_BufferSupplyUnspecified;
+            return OMX_ErrorNone;
+        }
+        case OMX_IndexParamStandardComponentRole: {
+            OMX_PARAM_COMPONENTROLETYPE *role = static_cast<OMX_PARAM_COMPONENTROLETYPE *>(param);
+            if (strcpy_s((char *)role->cRole, sizeof(role->cRole), role_.c_str()) != EOK) {
+                return OMX_ErrorBadParameter;
+            }
+            return OMX_ErrorNone;
+        }
+        default:
+            return GetCodecParameter(index, param);
+    }
+}
+
+OMX_ERRORTYPE SoftComponent::SetParameter(OMX_INDEXTYPE index, OMX_PTR param)
+{
+    if (param == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch (index) {
+        case OMX_IndexParamPortDefinition: {
+            const OMX_PARAM_PORTDEFINITIONTYPE *def = static_cast<const OMX_PARAM_PORTDEFINITIONTYPE *>(param);
+            if (def->nPortIndex >= SOFT_PORT_NUM) {
+                return OMX_ErrorBadPortIndex;
+            }
+            SoftPort &port = ports_[def->nPortIndex];
+            // the buffers in use were sized by the definition
+            if ((state_ != OMX_StateLoaded) && port.def.bEnabled) {
+                HDF_LOGE("%{public}s error, port %{public}u is in use", __func__, def->nPortIndex);
+                return OMX_ErrorIncorrectStateOperation;
+            }
+            if (def->nBufferCountActual < port.def.nBufferCountMin) {
+                HDF_LOGE("%{public}s error, buffer count %{public}u", __func__, def->nBufferCountActual);
+                return OMX_ErrorBadParameter;
+            }
+            OMX_ERRORTYPE err = SetPortFormat(def->nPortIndex, *def);
+            if (err != OMX_ErrorNone) {
+                return err;
+            }
+            port.def.nBufferCountActual = def->nBufferCountActual;
+            return OMX_ErrorNone;
+        }
+        case OMX_IndexParamCompBufferSupplier:
+            // nothing is tunneled, whoever supplies is fine
+            return OMX_ErrorNone;
+        case OMX_IndexParamStandardComponentRole: {
+            const OMX_PARAM_COMPONENTROLETYPE *role = static_cast<const OMX_PARAM_COMPONENTROLETYPE *>(param);
+            if (strncmp((const char *)role->cRole, role_.c_str(), sizeof(role->cRole)) != 0) {
+                HDF_LOGE("%{public}s error, %{public}s has no role %{public}s", __func__, name_.c_str(),
+                         (const char *)role->cRole);
+                return OMX_ErrorBadParameter;
+            }
+            return OMX_ErrorNone;
+        }
+        default:
+            return SetCodecParameter(index, param);
+    }
+}
+
+OMX_ERRORTYPE SoftComponent::GetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param)
+{
+    (void)param;
+    HDF_LOGE("%{public}s error, index 0x%{public}x is not supported", __func__, index);
+    return OMX_ErrorUnsupportedIndex;
+}
+
+OMX_ERRORTYPE SoftComponent::SetCodecParameter(OMX_INDEXTYPE index, OMX_PTR param)
+{
+    (void)param;
+    HDF_LOGE("%{public}s error, index 0x%{public}x is not supported", __func__, index);
+    return OMX_ErrorUnsupportedIndex;
+}
+
+OMX_ERRORTYPE SoftComponent::GetConfig(OMX_INDEXTYPE index, OMX_PTR config)
+{
+    if (config == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return GetCodecConfig(index, config);
+}
+
+OMX_ERRORTYPE SoftComponent::SetConfig(OMX_INDEXTYPE index, OMX_PTR config)
+{
+    if (config == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    // every config starts with its size and version
+    uint32_t size = *static_cast<const uint32_t *>(config);
+    if ((size < sizeof(uint32_t) + sizeof(OMX_VERSIONTYPE)) || (size > MAX_CONFIG_SIZE)) {
+        HDF_LOGE("%{public}s error, config size %{public}u", __func__, size);
+        return OMX_ErrorBadParameter;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == OMX_StateInvalid) {
+        return OMX_ErrorInvalidState;
+    }
+    OMX_ERRORTYPE err = CheckCodecConfig(index, config);
+    if (err != OMX_ErrorNone) {
+        return err;
+    }
+    const uint8_t *data = static_cast<const uint8_t *>(config);
+    configs_.push_back({index, std::vector<uint8_t>(data, data + size), queuedInputs_});
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftComponent::CheckCodecConfig(OMX_INDEXTYPE index, const void *config)
+{
+    (void)config;
+    HDF_LOGE("%{public}s error, index 0x%{public}x is not supported", __func__, index);
+    return OMX_ErrorUnsupportedIndex;
+}
+
+OMX_ERRORTYPE SoftComponent::ApplyCodecConfig(OMX_INDEXTYPE index, const void *config)
+{
+    (void)config;
+    HDF_LOGE("%{public}s error, index 0x%{public}x is not supported", __func__, index);
+    return OMX_ErrorUnsupportedIndex;
+}
+
+OMX_ERRORTYPE SoftComponent::GetCodecConfig(OMX_INDEXTYPE index, OMX_PTR config)
+{
+    (void)config;
+    HDF_LOGE("%{public}s error, index 0x%{public}x is not supported", __func__, index);
+    return OMX_ErrorUnsupportedIndex;
+}
+
+OMX_ERRORTYPE SoftComponent::GetState(OMX_STATETYPE *state)
+{
+    if (state == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    *state = state_;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftComponent::AddBuffer(OMX_BUFFERHEADERTYPE **header, uint32_t portIndex, OMX_PTR appPrivate,
+                                       uint32_t size, uint8_t *data)
+{
+    if (header == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    if (portIndex >= SOFT_PORT_NUM) {
+        return OMX_ErrorBadPortIndex;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    SoftPort &port = ports_[portIndex];
+    if (!IsBufferOperationAllowed(portIndex)) {
+        HDF_LOGE("%{public}s error, port %{public}u takes no buffers in state %{public}d", __func__, portIndex,
+                 state_);
+        return OMX_ErrorIncorrectStateOperation;
+    }
+    if (size < port.def.nBufferSize) {
+        HDF_LOGE("%{public}s error, size %{public}u is below %{public}u", __func__, size, port.def.nBufferSize);
+        return OMX_ErrorBadParameter;
+    }
+    if (port.buffers.size() >= port.def.nBufferCountActual) {
+        HDF_LOGE("%{public}s error, port %{public}u has all its buffers", __func__, portIndex);
+        return OMX_ErrorInsufficientResources;
+    }
+    std::unique_ptr<SoftBuffer> buffer = std::make_unique<SoftBuffer>();
+    if (data == nullptr) {
+        buffer->data.reset(new (std::nothrow) uint8_t[size]);
+        if (buffer->data == nullptr) {
+            return OMX_ErrorInsufficientResources;
+        }
+        data = buffer->data.get();
+    }
+    OMX_BUFFERHEADERTYPE &hdr = buffer->header;
+    (void)memset_s(&hdr, sizeof(hdr), 0, sizeof(hdr));
+    hdr.nSize = sizeof(hdr);
+    hdr.nVersion = port.def.nVersion;
+    hdr.pBuffer = data;
+    hdr.nAllocLen = size;
+    hdr.pAppPrivate = appPrivate;
+    hdr.nInputPortIndex = (portIndex == SOFT_PORT_INPUT) ? portIndex : OMX_ALL;
+    hdr.nOutputPortIndex = (portIndex == SOFT_PORT_OUTPUT) ? portIndex : OMX_ALL;
+    *header = &hdr;
+    port.buffers.push_back(std::move(buffer));
+    UpdatePopulated(portIndex);
+    CheckTransitions();
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftComponent::FreeBuffer(uint32_t portIndex, OMX_BUFFERHEADERTYPE *header)
+{
+    if (portIndex >= SOFT_PORT_NUM) {
+        return OMX_ErrorBadPortIndex;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    SoftPort &port = ports_[portIndex];
+    auto iter = std::find_if(port.buffers.begin(), port.buffers.end(),
+                             [header](const std::unique_ptr<SoftBuffer> &buffer) { return &buffer->header == header; });
+    if (iter == port.buffers.end()) {
+        HDF_LOGE("%{public}s error, unknown buffer on port %{public}u", __func__, portIndex);
+        return OMX_ErrorBadParameter;
+    }
+    bool expected = (state_ == OMX_StateLoaded) || (state_ == OMX_StateInvalid) ||
+                    (targetState_ == OMX_StateLoaded) || port.disabling ||
+                    HasPendingCommand(OMX_CommandStateSet, OMX_StateLoaded) ||
+                    HasPendingCommand(OMX_CommandPortDisable, portIndex);
+    auto queued = std::remove(port.queue.begin(), port.queue.end(), header);
+    if ((portIndex == SOFT_PORT_INPUT) && (queued != port.queue.end())) {
+        doneInputs_++;
+    }
+    port.queue.erase(queued, port.queue.end());
+    port.buffers.erase(iter);
+    if (!expected && port.def.bEnabled) {
+        AddEvent(OMX_EventError, (uint32_t)OMX_ErrorPortUnpopulated, portIndex);
+    }
+    UpdatePopulated(portIndex);
+    CheckTransitions();
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftComponent::QueueBuffer(uint32_t portIndex, OMX_BUFFERHEADERTYPE *header)
+{
+    if (header == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ((state_ != OMX_StateExecuting) && (state_ != OMX_StatePause) && (state_ != OMX_StateIdle)) {
+        HDF_LOGE("%{public}s error, no buffers are taken in state %{public}d", __func__, state_);
+        return OMX_ErrorIncorrectStateOperation;
+    }
+    SoftPort &port = ports_[portIndex];
+    if (!port.def.bEnabled) {
+        HDF_LOGE("%{public}s error, port %{public}u is disabled", __func__, portIndex);
+        return OMX_ErrorIncorrectStateOperation;
+    }
+    auto iter = std::find_if(port.buffers.begin(), port.buffers.end(),
+                             [header](const std::unique_ptr<SoftBuffer> &buffer) { return &buffer->header == header; });
+    if (iter == port.buffers.end()) {
+        HDF_LOGE("%{public}s error, unknown buffer on port %{public}u", __func__, portIndex);
+        return OMX_ErrorBadParameter;
+    }
+    port.queue.push_back(header);
+    if (portIndex == SOFT_PORT_INPUT) {
+        queuedInputs_++;
+    }
+    cond_.notify_one();
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftComponent::SetCallbacks(const OMX_CALLBACKTYPE *callbacks, OMX_PTR appData)
+{
+    if (callbacks == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_ = *callbacks;
+    appData_ = appData;
+    handle_.pApplicationPrivate = appData;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftComponent::RoleEnum(OMX_U8 *role, uint32_t index)
+{
+    if (role == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    if (index > 0) {
+        return OMX_ErrorNoMore;
+    }
+    if (strcpy_s((char *)role, OMX_MAX_STRINGNAME_SIZE, role_.c_str()) != EOK) {
+        return OMX_ErrorBadParameter;
+    }
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SoftComponent::DeInit()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exit_ = true;
+    }
+    cond_.notify_all();
+    if (!worker_.joinable()) {
+        return OMX_ErrorNone;
+    }
+    if (worker_.get_id() == std::this_thread::get_id()) {
+        // a callback can not wait for itself, the client must not delete the component from there
+        HDF_LOGE("%{public}s error, %{public}s is deinited from its callback", __func__, name_.c_str());
+        worker_.detach();
+    } else {
+        worker_.join();
+    }
+    return OMX_ErrorNone;
+}
+
+void SoftComponent::NotifyPortSettingsChanged(uint32_t portIndex)
+{
+    AddEvent(OMX_EventPortSettingsChanged, portIndex, OMX_IndexParamPortDefinition);
+}
+
+bool SoftComponent::IsPortActive(uint32_t portIndex) const
+{
+    return (state_ != OMX_StateLoaded) && ports_[portIndex].def.bEnabled;
+}
+
+void SoftComponent::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cond_.wait(lock, [this] { return exit_ || HasWork(); });
+        if (exit_) {
+            break;
+        }
+        OMX_BUFFERHEADERTYPE *in = nullptr;
+        OMX_BUFFERHEADERTYPE *out = nullptr;
+        if (!IsBusy() && !commands_.empty()) {
+            Command command = commands_.front();
+            commands_.pop_front();
+            ExecuteCommand(command);
+            CheckTransitions();
+        } else if (CanProcess()) {
+            SoftPort &input = ports_[SOFT_PORT_INPUT];
+            in = input.queue.front();
+            input.queue.pop_front();
+            if ((in->nFilledLen == 0) && ((in->nFlags & OMX_BUFFERFLAG_EOS) == 0)) {
+                notes_.push_back({NOTE_EMPTY_DONE, OMX_EventMax, 0, 0, in});
+                in = nullptr;
+                doneInputs_++;
+            } else {
+                out = ports_[SOFT_PORT_OUTPUT].queue.front();
+                ports_[SOFT_PORT_OUTPUT].queue.pop_front();
+                // the events come before the buffers of the frame
+                ApplyConfigs();
+            }
+        }
+        std::vector<Note> notes;
+        notes.swap(notes_);
+        lock.unlock();
+
+        // commands are executed here as well, nothing takes the buffers while they are converted
+        if (in != nullptr) {
+            ProcessBuffers(in, out, notes);
+        }
+        Notify(notes);
+
+        lock.lock();
+        if ((in != nullptr) && (in->nFilledLen > 0)) {
+            ports_[SOFT_PORT_INPUT].queue.push_front(in);
+        } else if (in != nullptr) {
+            doneInputs_++;
+        }
+    }
+}
+
+bool SoftComponent::HasWork() const
+{
+    return !notes_.empty() || (!IsBusy() && !commands_.empty()) || CanProcess();
+}
+
+bool SoftComponent::CanProcess() const
+{
+    if (state_ != OMX_StateExecuting) {
+        return false;
+    }
+    for (uint32_t i = 0; i < SOFT_PORT_NUM; i++) {
+        if (!ports_[i].def.bEnabled || ports_[i].enabling) {
+            return false;
+        }
+    }
+    const SoftPort &input = ports_[SOFT_PORT_INPUT];
+    if (input.queue.empty()) {
+        return false;
+    }
+    // an empty input goes back without taking an output
+    const OMX_BUFFERHEADERTYPE *in = input.queue.front();
+    if ((in->nFilledLen == 0) && ((in->nFlags & OMX_BUFFERFLAG_EOS) == 0)) {
+        return true;
+    }
+    return !ports_[SOFT_PORT_OUTPUT].queue.empty();
+}
+
+bool SoftComponent::IsBusy() const
+{
+    if (targetState_ != state_) {
+        return true;
+    }
+    for (uint32_t i = 0; i < SOFT_PORT_NUM; i++) {
+        if (ports_[i].enabling || ports_[i].disabling) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SoftComponent::CheckTransitions()
+{
+    for (uint32_t i = 0; i < SOFT_PORT_NUM; i++) {
+        SoftPort &port = ports_[i];
+        if (port.disabling && port.buffers.empty()) {
+            port.disabling = false;
+            AddEvent(OMX_EventCmdComplete, OMX_CommandPortDisable, i);
+        }
+        if (port.enabling && port.def.bPopulated) {
+            port.enabling = false;
+            AddEvent(OMX_EventCmdComplete, OMX_CommandPortEnable, i);
+        }
+    }
+    if (targetState_ == state_) {
+        return;
+    }
+    bool done = true;
+    for (uint32_t i = 0; i < SOFT_PORT_NUM; i++) {
+        const SoftPort &port = ports_[i];
+        if (targetState_ == OMX_StateIdle) {
+            // every enabled port has all its buffers
+            done = done && (!port.def.bEnabled || port.def.bPopulated);
+        } else {
+            // every buffer is freed
+            done = done && port.buffers.empty();
+        }
+    }
+    if (done) {
+        SetState(targetState_);
+    }
+}
+
+void SoftComponent::ExecuteCommand(const Command &command)
+{
+    uint32_t first = (command.param == OMX_ALL) ? 0 : command.param;
+    uint32_t last = (command.param == OMX_ALL) ? SOFT_PORT_NUM : command.param + 1;
+    switch (command.cmd) {
+        case OMX_CommandStateSet: {
+            OMX_STATETYPE target = (OMX_STATETYPE)command.param;
+            if (target == state_) {
+                AddEvent(OMX_EventError, (uint32_t)OMX_ErrorSameState, 0);
+                break;
+            }
+            if (target == OMX_StateInvalid) {
+                state_ = OMX_StateInvalid;
+                targetState_ = OMX_StateInvalid;
+                AddEvent(OMX_EventError, (uint32_t)OMX_ErrorInvalidState, 0);
+                break;
+            }
+            bool allowed = false;
+            switch (target) {
+                case OMX_StateLoaded:
+                    allowed = (state_ == OMX_StateIdle) || (state_ == OMX_StateWaitForResources);
+                    break;
+                case OMX_StateIdle:
+                    allowed = (state_ != OMX_StateInvalid);
+                    break;
+                case OMX_StateExecuting:
+                    allowed = (state_ == OMX_StateIdle) || (state_ == OMX_StatePause);
+                    break;
+                case OMX_StatePause:
+                    allowed = (state_ == OMX_StateIdle) || (state_ == OMX_StateExecuting);
+                    break;
+                case OMX_StateWaitForResources:
+                    allowed = (state_ == OMX_StateLoaded);
+                    break;
+                default:
+                    break;
+            }
+            if (!allowed) {
+                HDF_LOGE("%{public}s error, state %{public}d to %{public}d", __func__, state_, target);
+                AddEvent(OMX_EventError, (uint32_t)OMX_ErrorIncorrectStateTransition, 0);
+                break;
+            }
+            if ((target == OMX_StateIdle) && ((state_ == OMX_StateExecuting) || (state_ == OMX_StatePause))) {
+                ReturnBuffers(SOFT_PORT_INPUT);
+                ReturnBuffers(SOFT_PORT_OUTPUT);
+                Reset();
+                SetState(target);
+            } else if ((target == OMX_StateIdle) || ((target == OMX_StateLoaded) && (state_ == OMX_StateIdle))) {
+                // waits for the buffers to be allocated or freed
+                targetState_ = target;
+            } else {
+                SetState(target);
+            }
+            break;
+        }
+        case OMX_CommandFlush:
+            for (uint32_t i = first; i < last; i++) {
+                ReturnBuffers(i);
+            }
+            Reset();
+            for (uint32_t i = first; i < last; i++) {
+                AddEvent(OMX_EventCmdComplete, OMX_CommandFlush, i);
+            }
+            break;
+        case OMX_CommandPortDisable:
+            for (uint32_t i = first; i < last; i++) {
+                DisablePort(i);
+            }
+            break;
+        case OMX_CommandPortEnable:
+            for (uint32_t i = first; i < last; i++) {
+                EnablePort(i);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void SoftComponent::SetState(OMX_STATETYPE state)
+{
+    HDF_LOGI("%{public}s %{public}s state %{public}d to %{public}d", __func__, name_.c_str(), state_, state);
+    state_ = state;
+    targetState_ = state;
+    AddEvent(OMX_EventCmdComplete, OMX_CommandStateSet, state);
+}
+
+void SoftComponent::DisablePort(uint32_t portIndex)
+{
+    SoftPort &port = ports_[portIndex];
+    port.def.bEnabled = OMX_FALSE;
+    port.enabling = false;
+    ReturnBuffers(portIndex);
+    if (portIndex == SOFT_PORT_INPUT) {
+        Reset();
+    }
+    if (port.buffers.empty()) {
+        AddEvent(OMX_EventCmdComplete, OMX_CommandPortDisable, portIndex);
+    } else {
+        port.disabling = true;
+    }
+}
+
+void SoftComponent::EnablePort(uint32_t portIndex)
+{
+    SoftPort &port = ports_[portIndex];
+    port.def.bEnabled = OMX_TRUE;
+    port.disabling = false;
+    // without buffers in use there is nothing to wait for, they come with the transition to idle
+    if ((targetState_ == state_) && ((state_ == OMX_StateLoaded) || (state_ == OMX_StateWaitForResources))) {
+        AddEvent(OMX_EventCmdComplete, OMX_CommandPortEnable, portIndex);
+    } else {
+        port.enabling = true;
+    }
+}
+
+void SoftComponent::ReturnBuffers(uint32_t portIndex)
+{
+    SoftPort &port = ports_[portIndex];
+    if (portIndex == SOFT_PORT_INPUT) {
+        doneInputs_ += port.queue.size();
+    }
+    for (OMX_BUFFERHEADERTYPE *header : port.queue) {
+        if (portIndex == SOFT_PORT_INPUT) {
+            notes_.push_back({NOTE_EMPTY_DONE, OMX_EventMax, 0, 0, header});
+        } else {
+            header->nFilledLen = 0;
+            notes_.push_back({NOTE_FILL_DONE, OMX_EventMax, 0, 0, header});
+        }
+    }
+    port.queue.clear();
+}
+
+void SoftComponent::ApplyConfigs()
+{
+    while (!configs_.empty() && (configs_.front().frame <= doneInputs_)) {
+        const PendingConfig &config = configs_.front();
+        OMX_ERRORTYPE err = ApplyCodecConfig(config.index, config.data.data());
+        if (err == OMX_ErrorNone) {
+            AddEvent(static_cast<OMX_EVENTTYPE>(OMX_EventConfigApplied), config.index, (uint32_t)doneInputs_);
+        } else {
+            // the port changed since the config was checked
+            HDF_LOGE("%{public}s %{public}s error, config 0x%{public}x ret [0x%{public}x]", __func__, name_.c_str(),
+                     config.index, err);
+            AddEvent(OMX_EventError, (uint32_t)err, config.index);
+        }
+        configs_.pop_front();
+    }
+}
+
+void SoftComponent::ProcessBuffers(OMX_BUFFERHEADERTYPE *in, OMX_BUFFERHEADERTYPE *out, std::vector<Note> &notes)
+{
+    out->nOffset = 0;
+    out->nFilledLen = 0;
+    out->nFlags = 0;
+    out->nTimeStamp = in->nTimeStamp;
+    uint32_t consumed = in->nFilledLen;
+    if (in->nFilledLen > 0) {
+        OMX_ERRORTYPE err = Process(*in, *out, consumed);
+        if ((err == OMX_ErrorNone) && (consumed == 0)) {
+            // nothing would ever take the rest
+            err = OMX_ErrorOverflow;
+        }
+        if (err != OMX_ErrorNone) {
+            HDF_LOGE("%{public}s %{public}s error, process ret [0x%{public}x]", __func__, name_.c_str(), err);
+            notes.push_back({NOTE_EVENT, OMX_EventError, (uint32_t)err, 0, nullptr});
+            consumed = in->nFilledLen;
+            out->nFilledLen = 0;
+        }
+    }
+    consumed = std::min(consumed, in->nFilledLen);
+    in->nOffset += consumed;
+    in->nFilledLen -= consumed;
+
+    bool eos = false;
+    if (in->nFilledLen == 0) {
+        eos = (in->nFlags & OMX_BUFFERFLAG_EOS) != 0;
+        if (eos) {
+            out->nFlags |= OMX_BUFFERFLAG_EOS;
+        }
+        notes.push_back({NOTE_EMPTY_DONE, OMX_EventMax, 0, 0, in});
+    }
+    notes.push_back({NOTE_FILL_DONE, OMX_EventMax, 0, 0, out});
+    if (eos) {
+        notes.push_back({NOTE_EVENT, OMX_EventBufferFlag, SOFT_PORT_OUTPUT, OMX_BUFFERFLAG_EOS, nullptr});
+    }
+}
+
+void SoftComponent::UpdatePopulated(uint32_t portIndex)
+{
+    OMX_PARAM_PORTDEFINITIONTYPE &def = ports_[portIndex].def;
+    def.bPopulated = (ports_[portIndex].buffers.size() >= def.nBufferCountActual) ? OMX_TRUE : OMX_FALSE;
+}
+
+bool SoftComponent::IsBufferOperationAllowed(uint32_t portIndex) const
+{
+    if (((targetState_ == OMX_StateIdle) && (state_ != OMX_StateIdle)) || ports_[portIndex].enabling) {
+        return true;
+    }
+    // the client allocates right after sending the command, the worker may not have taken it yet
+    bool loaded = (state_ == OMX_StateLoaded) || (state_ == OMX_StateWaitForResources);
+    return (loaded && HasPendingCommand(OMX_CommandStateSet, OMX_StateIdle)) ||
+           (!ports_[portIndex].def.bEnabled && HasPendingCommand(OMX_CommandPortEnable, portIndex));
+}
+
+bool SoftComponent::HasPendingCommand(OMX_COMMANDTYPE cmd, uint32_t param) const
+{
+    for (const Command &command : commands_) {
+        if (command.cmd != cmd) {
+            continue;
+        }
+        // OMX_ALL is a port, not a state
+        if ((command.param == param) || ((cmd != OMX_CommandStateSet) && (command.param == OMX_ALL))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SoftComponent::AddEvent(OMX_EVENTTYPE event, uint32_t data1, uint32_t data2)
+{
+    notes_.push_back({NOTE_EVENT, event, data1, data2, nullptr});
+    cond_.notify_one();
+}
+
+void SoftComponent::Notify(const std::vector<Note> &notes)
+{
+    for (const Note &note : notes) {
+        switch (note.type) {
+            case NOTE_EVENT:
+                if (callbacks_.EventHandler != nullptr) {
+                    callbacks_.EventHandler(&handle_, appData_, note.event, note.data1, note.data2, nullptr);
+                }
+                break;
+            case NOTE_EMPTY_DONE:
+                if (callbacks_.EmptyBufferDone != nullptr) {
+                    callbacks_.EmptyBufferDone(&handle_, appData_, note.buffer);
+                }
+                break;
+            case NOTE_FILL_DONE:
+                if (callbacks_.FillBufferDone != nullptr) {
+                    callbacks_.FillBufferDone(&handle_, appData_, note.buffer);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <hdf_log.h>
+#include <securec.h>
+
+#include "soft_codecs.h"
+#include "soft_component_mgr.h"
+
+#define HDF_LOG_TAG codec_hdi_server
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+namespace {
+struct SoftComponentEntry {
+    const char *name;
+    const char *role;
+    SoftComponent *(*create)();
+};
+
+template <typename T>
+SoftComponent *CreateSoft()
+{
+    return new (std::nothrow) T();
+}
+
+const SoftComponentEntry SOFT_COMPONENTS[] = {
+    {SOFT_RAW_DECODER_NAME, SOFT_RAW_DECODER_ROLE, CreateSoft<SoftRawDecoder>},
+    {SOFT_PCM_DECODER_NAME, SOFT_PCM_DECODER_ROLE, CreateSoft<SoftPcmDecoder>},
+    {SOFT_RLE_ENCODER_NAME, SOFT_RLE_ENCODER_ROLE, CreateSoft<SoftRleEncoder>},
+};
+constexpr uint32_t SOFT_COMPONENT_NUM = sizeof(SOFT_COMPONENTS) / sizeof(SOFT_COMPONENTS[0]);
+
+const SoftComponentEntry *FindEntry(const char *componentName)
+{
+    for (const SoftComponentEntry &entry : SOFT_COMPONENTS) {
+        if (strcmp(componentName, entry.name) == 0) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+}  // namespace
+
+SoftComponentMgr::~SoftComponentMgr()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &it : components_) {
+        HDF_LOGE("%{public}s %{public}s is not deleted", __func__, it.second->GetName().c_str());
+        // stops the worker while the codec is still whole
+        (void)it.first->ComponentDeInit(it.first);
+    }
+    components_.clear();
+}
+
+int32_t SoftComponentMgr::CreateComponentInstance(const char *componentName, const OMX_CALLBACKTYPE *callbacks,
+                                                  void *appData, OMX_COMPONENTTYPE **component)
+{
+    if (componentName == nullptr || component == nullptr) {
+        HDF_LOGE("%{public}s error, invalid param", __func__);
+        return OMX_ErrorBadParameter;
+    }
+    const SoftComponentEntry *entry = FindEntry(componentName);
+    if (entry == nullptr) {
+        HDF_LOGE("%{public}s error, no component %{public}s", __func__, componentName);
+        return OMX_ErrorInvalidComponentName;
+    }
+    std::unique_ptr<SoftComponent> soft(entry->create());
+    if (soft == nullptr) {
+        return OMX_ErrorInsufficientResources;
+    }
+    OMX_ERRORTYPE err = soft->Init(callbacks, appData);
+    if (err != OMX_ErrorNone) {
+        HDF_LOGE("%{public}s error, init %{public}s ret [0x%{public}x]", __func__, componentName, err);
+        return err;
+    }
+    *component = soft->GetHandle();
+    std::lock_guard<std::mutex> lock(mutex_);
+    components_[*component] = std::move(soft);
+    return OMX_ErrorNone;
+}
+
+int32_t SoftComponentMgr::DeleteComponentInstance(OMX_COMPONENTTYPE *component)
+{
+    std::unique_ptr<SoftComponent> soft;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = components_.find(component);
+        if (it == components_.end()) {
+            HDF_LOGE("%{public}s error, unknown component", __func__);
+            return OMX_ErrorInvalidComponent;
+        }
+        soft = std::move(it->second);
+        components_.erase(it);
+    }
+    // the worker may call back into the client, so it is joined outside the lock
+    return component->ComponentDeInit(component);
+}
+
+int32_t SoftComponentMgr::EnumerateComponentsByIndex(uint32_t index, char *componentName, size_t componentNameSize)
+{
+    if (index >= SOFT_COMPONENT_NUM) {
+        return OMX_ErrorNoMore;
+    }
+    if (strcpy_s(componentName, componentNameSize, SOFT_COMPONENTS[index].name) != EOK) {
+        HDF_LOGE("%{public}s strcpy_s return error", __func__);
+        return OMX_ErrorInsufficientResources;
+    }
+    return OMX_ErrorNone;
+}
+
+int32_t SoftComponentMgr::GetRolesForComponent(const char *componentName, std::vector<std::string> *roles)
+{
+    if (componentName == nullptr || roles == nullptr) {
+        return OMX_ErrorBadParameter;
+    }
+    const SoftComponentEntry *entry = FindEntry(componentName);
+    if (entry == nullptr) {
+        return OMX_ErrorInvalidComponentName;
+    }
+    roles->clear();
+    roles->push_back(entry->role);
+    return OMX_ErrorNone;
+}
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
@@ -0,0 +1,874 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec_ring.h"
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <hdf_log.h>
+#include <osal_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CODEC_RING_MAGIC            0x434F5247
+#define CODEC_RING_MAX_FD_NUM       (CODEC_RING_MAX_BUFFER_NUM + 1)
+#define CODEC_RING_IDLE_MS          100     // how often the service threads look whether they are stopped
+#define CODEC_RING_REAP_TIMEOUT_MS  100
+#define CODEC_RING_FD_TIMEOUT_MS    1000    // the fds follow their descriptor right away
+#define CODEC_RING_RETRY_US         1000
+#define CODEC_RING_WORKER_NUM       2
+#define MS_PER_SECOND               1000
+#define NS_PER_MS                   1000000
+
+struct CodecRingDesc {
+    uint32_t timeoutMs;
+    uint32_t bufferCnt;
+    uint32_t fdNum;         // fds sent on the doorbell with the descriptor
+    uint32_t hasFence;      // the last of the fds is a fence
+    CodecBufferInfo buffers[CODEC_RING_MAX_BUFFER_NUM];
+    int64_t timeStamp;
+    uint32_t sequence;
+    uint32_t flag;
+    uint32_t type;
+    uint64_t vendorPrivate;
+};
+
+struct CodecRingQueue {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t consumerWaiting;
+    uint32_t producerWaiting;
+    struct CodecRingDesc descs[CODEC_RING_ENTRY_NUM];
+};
+
+struct CodecRingShared {
+    uint32_t magic;
+    int32_t error;          // the codec failed on a submission
+    struct CodecRingQueue queues[CODEC_RING_QUEUE_NUM];
+};
+
+struct CodecRingFds {
+    uint32_t seq;
+    uint32_t num;
+    int fds[CODEC_RING_MAX_FD_NUM];
+};
+
+struct CodecRingEnd {
+    struct CodecRingQueue *queue;
+    int doorbell;
+    // a queue has one producer and one consumer, the client threads that share a side take turns
+    pthread_mutex_t lock;
+    // fds that came before their descriptor was taken, in the order of the descriptors
+    uint32_t stashNum;
+    struct CodecRingFds stash[CODEC_RING_ENTRY_NUM];
+};
+
+struct CodecRingWorker {
+    struct CodecRing *ring;
+    DirectionType direct;
+    pthread_t submitThread;
+    pthread_t reapThread;
+    bool submitStarted;
+    bool reapStarted;
+    uint32_t credits;       // submissions the codec holds
+    uint32_t bufferCnt;     // of the last submission, what is asked for when one is taken back
+    uint32_t processed;     // submissions handed to the codec
+};
+
+struct CodecRing {
+    struct CodecRingShared *shared;
+    int shmFd;
+    int peerFds[CODEC_RING_QUEUE_NUM];
+    struct CodecRingEnd ends[CODEC_RING_QUEUE_NUM];
+    // service only
+    const struct CodecRingOps *ops;
+    CODEC_HANDLETYPE handle;
+    struct CodecTelemetry *telemetry;
+    bool running;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    struct CodecRingWorker workers[CODEC_RING_WORKER_NUM];
+};
+
+static uint64_t CodecRingGetTimeMs(void)
+{
+    struct timespec time = {0};
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * MS_PER_SECOND + (uint64_t)time.tv_nsec / NS_PER_MS;
+}
+
+static void CodecRingCloseFds(const int *fds, uint32_t num)
+{
+    for (uint32_t i = 0; i < num; i++) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+}
+
+static int32_t CodecRingSendDoorbell(int doorbell, uint32_t seq, const int *fds, uint32_t fdNum)
+{
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int) * CODEC_RING_MAX_FD_NUM)];
+    } control;
+    struct iovec iov = {.iov_base = &seq, .iov_len = sizeof(seq)};
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (fdNum > 0) {
+        (void)memset(&control, 0, sizeof(control));
+        msg.msg_control = control.buf;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fdNum);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fdNum);
+        (void)memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fdNum);
+    }
+    ssize_t ret;
+    do {
+        ret = sendmsg(doorbell, &msg, MSG_NOSIGNAL);
+    } while (ret < 0 && errno == EINTR);
+    if (ret < 0) {
+        HDF_LOGE("%{public}s: sendmsg failed, errno %{public}d", __func__, errno);
+        return HDF_ERR_IO;
+    }
+    return HDF_SUCCESS;
+}
+
+static void CodecRingStashFds(struct CodecRingEnd *end, uint32_t seq, const int *fds, uint32_t num)
+{
+    if (end->stashNum >= CODEC_RING_ENTRY_NUM) {
+        HDF_LOGE("%{public}s: too many fds ahead of their descriptors", __func__);
+        CodecRingCloseFds(fds, num);
+        return;
+    }
+    struct CodecRingFds *stash = &end->stash[end->stashNum++];
+    stash->seq = seq;
+    stash->num = num;
+    (void)memcpy(stash->fds, fds, sizeof(int) * num);
+}
+
+// takes every message that is there, wakeups are dropped and fds kept for their descriptor
+static int32_t CodecRingReceiveDoorbells(struct CodecRingEnd *end)
+{
+    while (true) {
+        union {
+            struct cmsghdr align;
+            char buf[CMSG_SPACE(sizeof(int) * CODEC_RING_MAX_FD_NUM)];
+        } control;
+        uint32_t seq = 0;
+        struct iovec iov = {.iov_base = &seq, .iov_len = sizeof(seq)};
+        struct msghdr msg = {0};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+        ssize_t ret = recvmsg(end->doorbell, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? HDF_SUCCESS : HDF_ERR_IO;
+        }
+        if (ret == 0) {
+            return HDF_ERR_IO;
+        }
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+                continue;
+            }
+            int fds[CODEC_RING_MAX_FD_NUM];
+            uint32_t num = (uint32_t)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            num = num > CODEC_RING_MAX_FD_NUM ? CODEC_RING_MAX_FD_NUM : num;
+            (void)memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * num);
+            CodecRingStashFds(end, seq, fds, num);
+        }
+    }
+}
+
+static int32_t CodecRingWaitDoorbell(struct CodecRingEnd *end, uint64_t deadline)
+{
+    while (true) {
+        uint64_t now = CodecRingGetTimeMs();
+        if (now >= deadline) {
+            return HDF_ERR_TIMEOUT;
+        }
+        struct pollfd pfd = {.fd = end->doorbell, .events = POLLIN, .revents = 0};
+        int ret = poll(&pfd, 1, (int)(deadline - now));
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            return HDF_ERR_IO;
+        }
+        if (ret == 0) {
+            return HDF_ERR_TIMEOUT;
+        }
+        if ((pfd.revents & POLLIN) == 0) {
+            return HDF_ERR_IO;
+        }
+        return CodecRingReceiveDoorbells(end);
+    }
+}
+
+static int32_t CodecRingPush(struct CodecRingEnd *end, const struct CodecRingDesc *desc,
+                             const int *fds, uint32_t fdNum, uint32_t timeoutMs)
+{
+    struct CodecRingQueue *queue = end->queue;
+    uint64_t deadline = CodecRingGetTimeMs() + timeoutMs;
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    while (tail - __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) >= CODEC_RING_ENTRY_NUM) {
+        __atomic_store_n(&queue->producerWaiting, 1, __ATOMIC_SEQ_CST);
+        if (tail - __atomic_load_n(&queue->head, __ATOMIC_SEQ_CST) < CODEC_RING_ENTRY_NUM) {
+            break;
+        }
+        int32_t ret = CodecRingWaitDoorbell(end, deadline);
+        if (ret != HDF_SUCCESS) {
+            __atomic_store_n(&queue->producerWaiting, 0, __ATOMIC_RELAXED);
+            return ret;
+        }
+    }
+    __atomic_store_n(&queue->producerWaiting, 0, __ATOMIC_RELAXED);
+
+    struct CodecRingDesc *slot = &queue->descs[tail % CODEC_RING_ENTRY_NUM];
+    *slot = *desc;
+    slot->fdNum = fdNum;
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_SEQ_CST);
+    // a consumer that is not asleep finds the descriptor without a wakeup
+    if (fdNum > 0 || __atomic_load_n(&queue->consumerWaiting, __ATOMIC_SEQ_CST) != 0) {
+        return CodecRingSendDoorbell(end->doorbell, tail, fds, fdNum);
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t CodecRingTakeFds(struct CodecRingEnd *end, uint32_t seq, int *fds, uint32_t num)
+{
+    uint64_t deadline = CodecRingGetTimeMs() + CODEC_RING_FD_TIMEOUT_MS;
+    while (true) {
+        if (end->stashNum > 0) {
+            struct CodecRingFds first = end->stash[0];
+            if ((int32_t)(first.seq - seq) > 0) {
+                // the fds of this descriptor were never sent
+                return HDF_ERR_IO;
+            }
+            end->stashNum--;
+            (void)memmove(&end->stash[0], &end->stash[1], sizeof(struct CodecRingFds) * end->stashNum);
+            if (first.seq == seq && first.num == num) {
+                (void)memcpy(fds, first.fds, sizeof(int) * num);
+                return HDF_SUCCESS;
+            }
+            CodecRingCloseFds(first.fds, first.num);
+            continue;
+        }
+        int32_t ret = CodecRingWaitDoorbell(end, deadline);
+        if (ret != HDF_SUCCESS) {
+            return ret;
+        }
+    }
+}
+
+// a descriptor that was taken is returned even if its fds were lost, they are -1 then
+static int32_t CodecRingPop(struct CodecRingEnd *end, struct CodecRingDesc *desc, int *fds, uint32_t timeoutMs)
+{
+    struct CodecRingQueue *queue = end->queue;
+    uint64_t deadline = CodecRingGetTimeMs() + timeoutMs;
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    while (head == __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&queue->consumerWaiting, 1, __ATOMIC_SEQ_CST);
+        if (head != __atomic_load_n(&queue->tail, __ATOMIC_SEQ_CST)) {
+            break;
+        }
+        int32_t ret = CodecRingWaitDoorbell(end, deadline);
+        if (ret != HDF_SUCCESS) {
+            __atomic_store_n(&queue->consumerWaiting, 0, __ATOMIC_RELAXED);
+            return ret;
+        }
+    }
+    __atomic_store_n(&queue->consumerWaiting, 0, __ATOMIC_RELAXED);
+
+    *desc = queue->descs[head % CODEC_RING_ENTRY_NUM];
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&queue->producerWaiting, __ATOMIC_SEQ_CST) != 0) {
+        (void)CodecRingSendDoorbell(end->doorbell, head, NULL, 0);
+    }
+
+    // the other side is not trusted with the sizes
+    desc->bufferCnt = desc->bufferCnt > CODEC_RING_MAX_BUFFER_NUM ? CODEC_RING_MAX_BUFFER_NUM : desc->bufferCnt;
+    desc->fdNum = desc->fdNum > CODEC_RING_MAX_FD_NUM ? CODEC_RING_MAX_FD_NUM : desc->fdNum;
+    for (uint32_t i = 0; i < desc->fdNum; i++) {
+        fds[i] = -1;
+    }
+    if (desc->fdNum > 0 && CodecRingTakeFds(end, head, fds, desc->fdNum) != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s: fds of descriptor %{public}u lost", __func__, head);
+    }
+    return HDF_SUCCESS;
+}
+
+static uint32_t CodecRingCollectFds(struct CodecRingDesc *desc, int fence, int *fds)
+{
+    uint32_t num = 0;
+    for (uint32_t i = 0; i < desc->bufferCnt; i++) {
+        if (desc->buffers[i].type == BUFFER_TYPE_FD && desc->buffers[i].fd >= 0) {
+            fds[num++] = desc->buffers[i].fd;
+        }
+    }
+    desc->hasFence = fence >= 0 ? 1 : 0;
+    if (fence >= 0) {
+        fds[num++] = fence;
+    }
+    return num;
+}
+
+// puts the fds of this process in place of the ones of the sender, returns the fence
+static int CodecRingApplyFds(struct CodecRingDesc *desc, const int *fds)
+{
+    uint32_t num = 0;
+    for (uint32_t i = 0; i < desc->bufferCnt; i++) {
+        if (desc->buffers[i].type == BUFFER_TYPE_FD && desc->buffers[i].fd >= 0) {
+            desc->buffers[i].fd = num < desc->fdNum ? fds[num++] : -1;
+        }
+    }
+    return (desc->hasFence != 0 && num < desc->fdNum) ? fds[num] : -1;
+}
+
+static int32_t CodecRingMap(struct CodecRing *ring)
+{
+    struct stat st = {0};
+    if (fstat(ring->shmFd, &st) != 0 || (size_t)st.st_size < sizeof(struct CodecRingShared)) {
+        HDF_LOGE("%{public}s: shared memory too small", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    void *addr = mmap(NULL, sizeof(struct CodecRingShared), PROT_READ | PROT_WRITE, MAP_SHARED, ring->shmFd, 0);
+    if (addr == MAP_FAILED) {
+        HDF_LOGE("%{public}s: mmap failed, errno %{public}d", __func__, errno);
+        return HDF_FAILURE;
+    }
+    ring->shared = (struct CodecRingShared *)addr;
+    for (int32_t i = 0; i < CODEC_RING_QUEUE_NUM; i++) {
+        ring->ends[i].queue = &ring->shared->queues[i];
+    }
+    return HDF_SUCCESS;
+}
+
+static struct CodecRing *CodecRingAlloc(void)
+{
+    struct CodecRing *ring = (struct CodecRing *)OsalMemCalloc(sizeof(struct CodecRing));
+    if (ring == NULL) {
+        HDF_LOGE("%{public}s: alloc ring failed!", __func__);
+        return NULL;
+    }
+    ring->shmFd = -1;
+    for (int32_t i = 0; i < CODEC_RING_QUEUE_NUM; i++) {
+        ring->peerFds[i] = -1;
+        ring->ends[i].doorbell = -1;
+        pthread_mutex_init(&ring->ends[i].lock, NULL);
+    }
+    return ring;
+}
+
+int32_t CodecRingCreate(struct CodecRing **ring)
+{
+    if (ring == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    struct CodecRing *instance = CodecRingAlloc();
+    if (instance == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    instance->shmFd = memfd_create("codec_ring", MFD_CLOEXEC);
+    if (instance->shmFd < 0 || ftruncate(instance->shmFd, sizeof(struct CodecRingShared)) != 0 ||
+        CodecRingMap(instance) != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s: create shared memory failed, errno %{public}d", __func__, errno);
+        CodecRingDestroy(instance);
+        return HDF_FAILURE;
+    }
+    instance->shared->magic = CODEC_RING_MAGIC;
+    for (int32_t i = 0; i < CODEC_RING_QUEUE_NUM; i++) {
+        int pair[2] = {-1, -1};
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair) != 0) {
+            HDF_LOGE("%{public}s: socketpair failed, errno %{public}d", __func__, errno);
+            CodecRingDestroy(instance);
+            return HDF_FAILURE;
+        }
+        instance->ends[i].doorbell = pair[0];
+        instance->peerFds[i] = pair[1];
+    }
+    *ring = instance;
+    return HDF_SUCCESS;
+}
+
+int32_t CodecRingGetPeerFds(struct CodecRing *ring, int *shmFd, int doorbells[CODEC_RING_QUEUE_NUM])
+{
+    if (ring == NULL || shmFd == NULL || doorbells == NULL || ring->peerFds[0] < 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    *shmFd = ring->shmFd;
+    for (int32_t i = 0; i < CODEC_RING_QUEUE_NUM; i++) {
+        doorbells[i] = ring->peerFds[i];
+    }
+    return HDF_SUCCESS;
+}
+
+void CodecRingClosePeerFds(struct CodecRing *ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+    CodecRingCloseFds(ring->peerFds, CODEC_RING_QUEUE_NUM);
+    for (int32_t i = 0; i < CODEC_RING_QUEUE_NUM; i++) {
+        ring->peerFds[i] = -1;
+    }
+}
+
+static int32_t CodecRingTakeError(struct CodecRing *ring)
+{
+    return __atomic_exchange_n(&ring->shared->error, HDF_SUCCESS, __ATOMIC_SEQ_CST);
+}
+
+static int32_t CodecRingSubmit(struct CodecRing *ring, enum CodecRingQueueId id,
+                               struct CodecRingDesc *desc, int fence, uint32_t timeoutMs)
+{
+    int32_t ret = CodecRingTakeError(ring);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    int fds[CODEC_RING_MAX_FD_NUM];
+    uint32_t fdNum = CodecRingCollectFds(desc, fence, fds);
+    struct CodecRingEnd *end = &ring->ends[id];
+    // held until the doorbell is sent, the fds have to arrive in the order of the descriptors
+    pthread_mutex_lock(&end->lock);
+    ret = CodecRingPush(end, desc, fds, fdNum, timeoutMs);
+    pthread_mutex_unlock(&end->lock);
+    return ret;
+}
+
+// buffers the caller has no room for are dropped
+static uint32_t CodecRingCopyBuffers(const struct CodecRingDesc *desc, CodecBufferInfo *buffers, uint32_t bufferCnt)
+{
+    uint32_t num = desc->bufferCnt < bufferCnt ? desc->bufferCnt : bufferCnt;
+    for (uint32_t i = 0; i < desc->bufferCnt; i++) {
+        if (i < num) {
+            buffers[i] = desc->buffers[i];
+        } else if (desc->buffers[i].type == BUFFER_TYPE_FD && desc->buffers[i].fd >= 0) {
+            close(desc->buffers[i].fd);
+        }
+    }
+    return num;
+}
+
+int32_t CodecRingQueueInput(struct CodecRing *ring, const InputInfo *inputData, uint32_t timeoutMs)
+{
+    if (ring == NULL || inputData == NULL || inputData->buffers == NULL || inputData->bufferCnt == 0 ||
+        inputData->bufferCnt > CODEC_RING_MAX_BUFFER_NUM) {
+        HDF_LOGE("%{public}s: params error!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    struct CodecRingDesc desc = {0};
+    desc.timeoutMs = timeoutMs;
+    desc.bufferCnt = inputData->bufferCnt;
+    (void)memcpy(desc.buffers, inputData->buffers, sizeof(CodecBufferInfo) * inputData->bufferCnt);
+    desc.timeStamp = inputData->pts;
+    desc.flag = (uint32_t)inputData->flag;
+    return CodecRingSubmit(ring, CODEC_RING_INPUT_SUBMIT, &desc, -1, timeoutMs);
+}
+
+int32_t CodecRingDequeInput(struct CodecRing *ring, uint32_t timeoutMs, InputInfo *inputData)
+{
+    if (ring == NULL || inputData == NULL || inputData->buffers == NULL || inputData->bufferCnt == 0) {
+        HDF_LOGE("%{public}s: params error!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    struct CodecRingDesc desc;
+    int fds[CODEC_RING_MAX_FD_NUM];
+    struct CodecRingEnd *end = &ring->ends[CODEC_RING_INPUT_DONE];
+    pthread_mutex_lock(&end->lock);
+    int32_t ret = CodecRingPop(end, &desc, fds, timeoutMs);
+    pthread_mutex_unlock(&end->lock);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    (void)CodecRingApplyFds(&desc, fds);
+    inputData->bufferCnt = CodecRingCopyBuffers(&desc, inputData->buffers, inputData->bufferCnt);
+    inputData->pts = desc.timeStamp;
+    inputData->flag = (int32_t)desc.flag;
+    return HDF_SUCCESS;
+}
+
+int32_t CodecRingQueueOutput(struct CodecRing *ring, OutputInfo *outInfo, uint32_t timeoutMs, int releaseFenceFd)
+{
+    if (ring == NULL || outInfo == NULL || outInfo->buffers == NULL || outInfo->bufferCnt == 0 ||
+        outInfo->bufferCnt > CODEC_RING_MAX_BUFFER_NUM) {
+        HDF_LOGE("%{public}s: params error!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    struct CodecRingDesc desc = {0};
+    desc.timeoutMs = timeoutMs;
+    desc.bufferCnt = outInfo->bufferCnt;
+    (void)memcpy(desc.buffers, outInfo->buffers, sizeof(CodecBufferInfo) * outInfo->bufferCnt);
+    desc.timeStamp = outInfo->timeStamp;
+    desc.sequence = outInfo->sequence;
+    desc.flag = outInfo->flag;
+    desc.type = (uint32_t)outInfo->type;
+    desc.vendorPrivate = (uint64_t)(uintptr_t)outInfo->vendorPrivate;
+    return CodecRingSubmit(ring, CODEC_RING_OUTPUT_SUBMIT, &desc, releaseFenceFd, timeoutMs);
+}
+
+int32_t CodecRingDequeueOutput(struct CodecRing *ring, uint32_t timeoutMs, int *acquireFd, OutputInfo *outInfo)
+{
+    if (ring == NULL || acquireFd == NULL || outInfo == NULL || outInfo->buffers == NULL || outInfo->bufferCnt == 0) {
+        HDF_LOGE("%{public}s: params error!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    struct CodecRingDesc desc;
+    int fds[CODEC_RING_MAX_FD_NUM];
+    struct CodecRingEnd *end = &ring->ends[CODEC_RING_OUTPUT_DONE];
+    pthread_mutex_lock(&end->lock);
+    int32_t ret = CodecRingPop(end, &desc, fds, timeoutMs);
+    pthread_mutex_unlock(&end->lock);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    *acquireFd = CodecRingApplyFds(&desc, fds);
+    outInfo->bufferCnt = CodecRingCopyBuffers(&desc, outInfo->buffers, outInfo->bufferCnt);
+    outInfo->timeStamp = desc.timeStamp;
+    outInfo->sequence = desc.sequence;
+    outInfo->flag = desc.flag;
+    outInfo->type = (CodecType)desc.type;
+    outInfo->vendorPrivate = (void *)(uintptr_t)desc.vendorPrivate;
+    return HDF_SUCCESS;
+}
+
+static bool CodecRingIsRunning(struct CodecRing *ring)
+{
+    pthread_mutex_lock(&ring->mutex);
+    bool running = ring->running;
+    pthread_mutex_unlock(&ring->mutex);
+    return running;
+}
+
+static int32_t CodecRingCallQueue(struct CodecRingWorker *worker, struct CodecRingDesc *desc, const int *fds)
+{
+    struct CodecRing *ring = worker->ring;
+    int fence = CodecRingApplyFds(desc, fds);
+    if (desc->bufferCnt == 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (worker->direct == INPUT_TYPE) {
+        InputInfo inputData = {0};
+        inputData.bufferCnt = desc->bufferCnt;
+        inputData.buffers = desc->buffers;
+        inputData.pts = desc->timeStamp;
+        inputData.flag = (int32_t)desc->flag;
+        return ring->ops->QueueInput(ring->handle, &inputData, desc->timeoutMs);
+    }
+    OutputInfo outInfo = {0};
+    outInfo.bufferCnt = desc->bufferCnt;
+    outInfo.buffers = desc->buffers;
+    outInfo.timeStamp = desc->timeStamp;
+    outInfo.sequence = desc->sequence;
+    outInfo.flag = desc->flag;
+    outInfo.type = (CodecType)desc->type;
+    outInfo.vendorPrivate = (void *)(uintptr_t)desc->vendorPrivate;
+    return ring->ops->QueueOutput(ring->handle, &outInfo, desc->timeoutMs, fence);
+}
+
+static void *CodecRingSubmitThread(void *arg)
+{
+    struct CodecRingWorker *worker = (struct CodecRingWorker *)arg;
+    struct CodecRing *ring = worker->ring;
+    struct CodecRingEnd *end =
+        &ring->ends[worker->direct == INPUT_TYPE ? CODEC_RING_INPUT_SUBMIT : CODEC_RING_OUTPUT_SUBMIT];
+    while (CodecRingIsRunning(ring)) {
+        struct CodecRingDesc desc;
+        int fds[CODEC_RING_MAX_FD_NUM];
+        int32_t ret = CodecRingPop(end, &desc, fds, CODEC_RING_IDLE_MS);
+        if (ret == HDF_ERR_TIMEOUT) {
+            continue;
+        }
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%{public}s: client is gone", __func__);
+            break;
+        }
+        CodecTelemetryOnQueued(ring->telemetry, worker->direct, desc.timeStamp);
+        ret = CodecRingCallQueue(worker, &desc, fds);
+        // the codec has what it needs of the fds when the call returns, as with the ones of an IPC
+        CodecRingCloseFds(fds, desc.fdNum);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%{public}s: queue to codec failed, error %{public}d", __func__, ret);
+            CodecTelemetryOnRejected(ring->telemetry, worker->direct);
+            __atomic_store_n(&ring->shared->error, ret, __ATOMIC_SEQ_CST);
+        }
+        pthread_mutex_lock(&ring->mutex);
+        worker->processed++;
+        if (ret == HDF_SUCCESS) {
+            worker->credits++;
+            worker->bufferCnt = desc.bufferCnt;
+        }
+        pthread_cond_broadcast(&ring->cond);
+        pthread_mutex_unlock(&ring->mutex);
+    }
+    return NULL;
+}
+
+static int32_t CodecRingCallDeque(struct CodecRingWorker *worker, struct CodecRingDesc *desc, int *fence)
+{
+    struct CodecRing *ring = worker->ring;
+    int32_t ret;
+    if (worker->direct == INPUT_TYPE) {
+        InputInfo inputData = {0};
+        inputData.bufferCnt = desc->bufferCnt;
+        inputData.buffers = desc->buffers;
+        ret = ring->ops->DequeInput(ring->handle, CODEC_RING_REAP_TIMEOUT_MS, &inputData);
+        desc->bufferCnt = inputData.bufferCnt;
+        desc->timeStamp = inputData.pts;
+        desc->flag = (uint32_t)inputData.flag;
+        *fence = -1;
+    } else {
+        OutputInfo outInfo = {0};
+        outInfo.bufferCnt = desc->bufferCnt;
+        outInfo.buffers = desc->buffers;
+        *fence = -1;
+        ret = ring->ops->DequeueOutput(ring->handle, CODEC_RING_REAP_TIMEOUT_MS, fence, &outInfo);
+        desc->bufferCnt = outInfo.bufferCnt;
+        desc->timeStamp = outInfo.timeStamp;
+        desc->sequence = outInfo.sequence;
+        desc->flag = outInfo.flag;
+        desc->type = (uint32_t)outInfo.type;
+        desc->vendorPrivate = (uint64_t)(uintptr_t)outInfo.vendorPrivate;
+    }
+    desc->bufferCnt = desc->bufferCnt > CODEC_RING_MAX_BUFFER_NUM ? CODEC_RING_MAX_BUFFER_NUM : desc->bufferCnt;
+    return ret;
+}
+
+static void *CodecRingReapThread(void *arg)
+{
+    struct CodecRingWorker *worker = (struct CodecRingWorker *)arg;
+    struct CodecRing *ring = worker->ring;
+    struct CodecRingEnd *end =
+        &ring->ends[worker->direct == INPUT_TYPE ? CODEC_RING_INPUT_DONE : CODEC_RING_OUTPUT_DONE];
+    while (true) {
+        pthread_mutex_lock(&ring->mutex);
+        while (ring->running && worker->credits == 0) {
+            pthread_cond_wait(&ring->cond, &ring->mutex);
+        }
+        bool running = ring->running;
+        uint32_t bufferCnt = worker->bufferCnt;
+        pthread_mutex_unlock(&ring->mutex);
+        if (!running) {
+            break;
+        }
+
+        struct CodecRingDesc desc = {0};
+        int fence = -1;
+        desc.bufferCnt = bufferCnt;
+        if (CodecRingCallDeque(worker, &desc, &fence) != HDF_SUCCESS) {
+            // nothing done yet, the codec may fail at once while it is stopped
+            usleep(CODEC_RING_RETRY_US);
+            continue;
+        }
+        pthread_mutex_lock(&ring->mutex);
+        worker->credits = worker->credits > 0 ? worker->credits - 1 : 0;
+        pthread_mutex_unlock(&ring->mutex);
+        CodecTelemetryOnReturned(ring->telemetry, worker->direct, desc.timeStamp, desc.buffers, desc.bufferCnt);
+
+        int fds[CODEC_RING_MAX_FD_NUM];
+        uint32_t fdNum = CodecRingCollectFds(&desc, fence, fds);
+        int32_t ret;
+        do {
+            ret = CodecRingPush(end, &desc, fds, fdNum, CODEC_RING_IDLE_MS);
+        } while (ret == HDF_ERR_TIMEOUT && CodecRingIsRunning(ring));
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%{public}s: complete to client failed, error %{public}d", __func__, ret);
+        }
+    }
+    return NULL;
+}
+
+static int32_t CodecRingStartWorkers(struct CodecRing *ring)
+{
+    for (int32_t i = 0; i < CODEC_RING_WORKER_NUM; i++) {
+        struct CodecRingWorker *worker = &ring->workers[i];
+        worker->ring = ring;
+        worker->direct = (i == 0) ? INPUT_TYPE : OUTPUT_TYPE;
+        if (pthread_create(&worker->submitThread, NULL, CodecRingSubmitThread, worker) != 0) {
+            return HDF_ERR_THREAD_CREATE_FAIL;
+        }
+        worker->submitStarted = true;
+        if (pthread_create(&worker->reapThread, NULL, CodecRingReapThread, worker) != 0) {
+            return HDF_ERR_THREAD_CREATE_FAIL;
+        }
+        worker->reapStarted = true;
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t CodecRingServe(int shmFd, const int doorbells[CODEC_RING_QUEUE_NUM], const struct CodecRingOps *ops,
+                       CODEC_HANDLETYPE handle, struct CodecTelemetry *telemetry, struct CodecRing **ring)
+{
+    if (shmFd < 0 || doorbells == NULL || ops == NULL || ops->QueueInput == NULL || ops->DequeInput == NULL ||
+        ops->QueueOutput == NULL || ops->DequeueOutput == NULL || ring == NULL) {
+        HDF_LOGE("%{public}s: params error!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    struct CodecRing *instance = CodecRingAlloc();
+    if (instance == NULL) {
+        close(shmFd);
+        CodecRingCloseFds(doorbells, CODEC_RING_QUEUE_NUM);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    instance->shmFd = shmFd;
+    for (int32_t i = 0; i < CODEC_RING_QUEUE_NUM; i++) {
+        instance->ends[i].doorbell = doorbells[i];
+    }
+    pthread_mutex_init(&instance->mutex, NULL);
+    pthread_cond_init(&instance->cond, NULL);
+    instance->ops = ops;
+    instance->handle = handle;
+    instance->telemetry = telemetry;
+    int32_t ret = CodecRingMap(instance);
+    if (ret == HDF_SUCCESS && instance->shared->magic != CODEC_RING_MAGIC) {
+        HDF_LOGE("%{public}s: not a codec ring", __func__);
+        ret = HDF_ERR_INVALID_PARAM;
+    }
+    if (ret == HDF_SUCCESS) {
+        instance->running = true;
+        ret = CodecRingStartWorkers(instance);
+    }
+    if (ret != HDF_SUCCESS) {
+        CodecRingDestroy(instance);
+        return ret;
+    }
+    *ring = instance;
+    return HDF_SUCCESS;
+}
+
+static bool CodecRingIsDrained(struct CodecRing *ring)
+{
+    for (int32_t i = 0; i < CODEC_RING_WORKER_NUM; i++) {
+        enum CodecRingQueueId id = (i == 0) ? CODEC_RING_INPUT_SUBMIT : CODEC_RING_OUTPUT_SUBMIT;
+        if (ring->workers[i].processed != __atomic_load_n(&ring->shared->queues[id].tail, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int32_t CodecRingDrain(struct CodecRing *ring, uint32_t timeoutMs)
+{
+    if (ring == NULL || ring->ops == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    uint64_t deadline = CodecRingGetTimeMs() + timeoutMs;
+    int32_t ret = HDF_SUCCESS;
+    pthread_mutex_lock(&ring->mutex);
+    while (ring->running && !CodecRingIsDrained(ring)) {
+        uint64_t now = CodecRingGetTimeMs();
+        if (now >= deadline) {
+            ret = HDF_ERR_TIMEOUT;
+            break;
+        }
+        // the client submits without telling anyone here, so look again every now and then
+        uint64_t waitMs = deadline - now;
+        waitMs = waitMs > CODEC_RING_IDLE_MS ? CODEC_RING_IDLE_MS : waitMs;
+        struct timespec until = {0};
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_sec += (time_t)(waitMs / MS_PER_SECOND);
+        until.tv_nsec += (long)((waitMs % MS_PER_SECOND) * NS_PER_MS);
+        if (until.tv_nsec >= (long)MS_PER_SECOND * NS_PER_MS) {
+            until.tv_sec++;
+            until.tv_nsec -= (long)MS_PER_SECOND * NS_PER_MS;
+        }
+        (void)pthread_cond_timedwait(&ring->cond, &ring->mutex, &until);
+    }
+    pthread_mutex_unlock(&ring->mutex);
+    return ret;
+}
+
+void CodecRingFlush(struct CodecRing *ring, DirectionType directType)
+{
+    if (ring == NULL || ring->ops == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&ring->mutex);
+    for (int32_t i = 0; i < CODEC_RING_WORKER_NUM; i++) {
+        if (directType == ALL_TYPE || directType == ring->workers[i].direct) {
+            ring->workers[i].credits = 0;
+        }
+    }
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+void CodecRingDestroy(struct CodecRing *ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+    if (ring->ops != NULL) {
+        pthread_mutex_lock(&ring->mutex);
+        ring->running = false;
+        pthread_cond_broadcast(&ring->cond);
+        pthread_mutex_unlock(&ring->mutex);
+    }
+    // wakes whoever waits on a doorbell, on this side and on the other one
+    for (int32_t i = 0; i < CODEC_RING_QUEUE_NUM; i++) {
+        if (ring->ends[i].doorbell >= 0) {
+            shutdown(ring->ends[i].doorbell, SHUT_RDWR);
+        }
+    }
+    if (ring->ops != NULL) {
+        for (int32_t i = 0; i < CODEC_RING_WORKER_NUM; i++) {
+            if (ring->workers[i].submitStarted) {
+                pthread_join(ring->workers[i].submitThread, NULL);
+            }
+            if (ring->workers[i].reapStarted) {
+                pthread_join(ring->workers[i].reapThread, NULL);
+            }
+        }
+        pthread_cond_destroy(&ring->cond);
+        pthread_mutex_destroy(&ring->mutex);
+    }
+    for (int32_t i = 0; i < CODEC_RING_QUEUE_NUM; i++) {
+        struct CodecRingEnd *end = &ring->ends[i];
+        for (uint32_t j = 0; j < end->stashNum; j++) {
+            CodecRingCloseFds(end->stash[j].fds, end->stash[j].num);
+        }
+        if (end->doorbell >= 0) {
+            close(end->doorbell);
+        }
+        pthread_mutex_destroy(&end->lock);
+    }
+    CodecRingClosePeerFds(ring);
+    if (ring->shared != NULL) {
+        munmap(ring->shared, sizeof(struct CodecRingShared));
+    }
+    if (ring->shmFd >= 0) {
+        close(ring->shmFd);
+    }
+    OsalMemFree(ring);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CODEC_RING_H
+#define CODEC_RING_H
+
+#include "codec_telemetry.h"
+#include "codec_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A codec instance moves its buffers through shared memory instead of one IPC call per buffer.
+ * The client submits QueueInput/QueueOutput descriptors and takes the buffers the codec is done
+ * with from the completion queues, the service feeds the codec from its own threads.
+ * Every queue has one producer and one consumer, a socket pair wakes a side that sleeps and
+ * carries the file descriptors (fd buffers and fences) of a descriptor. The client calls may come
+ * from several threads, they take turns on a queue.
+ */
+#define CODEC_RING_ENTRY_NUM        64
+#define CODEC_RING_MAX_BUFFER_NUM   8   // of a descriptor, a ring takes no bigger ones
+
+enum CodecRingQueueId {
+    CODEC_RING_INPUT_SUBMIT,
+    CODEC_RING_INPUT_DONE,
+    CODEC_RING_OUTPUT_SUBMIT,
+    CODEC_RING_OUTPUT_DONE,
+    CODEC_RING_QUEUE_NUM
+};
+
+/* The calls the service makes on the codec, codec_interface.h on the device. */
+struct CodecRingOps {
+    int32_t (*QueueInput)(CODEC_HANDLETYPE handle, const InputInfo *inputData, uint32_t timeoutMs);
+    int32_t (*DequeInput)(CODEC_HANDLETYPE handle, uint32_t timeoutMs, InputInfo *inputData);
+    int32_t (*QueueOutput)(CODEC_HANDLETYPE handle, OutputInfo *outInfo, uint32_t timeoutMs, int releaseFenceFd);
+    int32_t (*DequeueOutput)(CODEC_HANDLETYPE handle, uint32_t timeoutMs, int *acquireFd, OutputInfo *outInfo);
+};
+
+struct CodecRing;
+
+/* Client side, the shared memory and the service ends of the doorbells are handed over with CodecRingGetPeerFds. */
+int32_t CodecRingCreate(struct CodecRing **ring);
+int32_t CodecRingGetPeerFds(struct CodecRing *ring, int *shmFd, int doorbells[CODEC_RING_QUEUE_NUM]);
+/* Closes the service ends, call it once they are sent. */
+void CodecRingClosePeerFds(struct CodecRing *ring);
+/* A failure of the codec on an earlier submission is returned by the next one. */
+int32_t CodecRingQueueInput(struct CodecRing *ring, const InputInfo *inputData, uint32_t timeoutMs);
+int32_t CodecRingDequeInput(struct CodecRing *ring, uint32_t timeoutMs, InputInfo *inputData);
+int32_t CodecRingQueueOutput(struct CodecRing *ring, OutputInfo *outInfo, uint32_t timeoutMs, int releaseFenceFd);
+/* The fds of fd buffers and acquireFd belong to the caller. */
+int32_t CodecRingDequeueOutput(struct CodecRing *ring, uint32_t timeoutMs, int *acquireFd, OutputInfo *outInfo);
+
+/*
+ * Service side, takes over shmFd and doorbells and serves the ring until it is destroyed.
+ * The threads of the ring record what they hand to the codec and take back in telemetry, NULL for none,
+ * which has to outlive the ring.
+ */
+int32_t CodecRingServe(int shmFd, const int doorbells[CODEC_RING_QUEUE_NUM], const struct CodecRingOps *ops,
+                       CODEC_HANDLETYPE handle, struct CodecTelemetry *telemetry, struct CodecRing **ring);
+/* Waits until the codec took every descriptor submitted so far. */
+int32_t CodecRingDrain(struct CodecRing *ring, uint32_t timeoutMs);
+/* The codec dropped the buffers it held in the direction, nothing is waited for any more. */
+void CodecRingFlush(struct CodecRing *ring, DirectionType directType);
+
+void CodecRingDestroy(struct CodecRing *ring);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif // CODEC_RING_H
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec_telemetry.h"
+#include <pthread.h>
+#include <time.h>
+#include <hdf_log.h>
+#include <osal_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CODEC_TELEMETRY_MAX_HELD    64      // timed per direction, more are counted only
+#define CODEC_TELEMETRY_TEXT_LEN    256
+#define US_PER_SECOND               1000000
+#define NS_PER_US                   1000
+#define US_PER_MS                   1000
+
+// the queue times of what the codec holds, oldest first
+struct CodecTelemetryFifo {
+    uint32_t head;
+    uint32_t num;
+    uint64_t queuedUs[CODEC_TELEMETRY_MAX_HELD];
+    int64_t pts[CODEC_TELEMETRY_MAX_HELD];
+};
+
+struct CodecTelemetry {
+    pthread_mutex_t mutex;
+    struct CodecTelemetryStats stats;
+    struct CodecTelemetryFifo held[ALL_TYPE];
+    // inputs waiting for an output, a decoder may drop frames so the oldest go first
+    struct CodecTelemetryFifo pendingInputs;
+    uint64_t lastProgressUs;
+    bool stalled;
+};
+
+static uint64_t CodecTelemetryNowUs(void)
+{
+    struct timespec time = {0};
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * US_PER_SECOND + (uint64_t)time.tv_nsec / NS_PER_US;
+}
+
+static void CodecTelemetryFifoPush(struct CodecTelemetryFifo *fifo, uint64_t queuedUs, int64_t pts, bool replace)
+{
+    if (fifo->num == CODEC_TELEMETRY_MAX_HELD) {
+        if (!replace) {
+            return;
+        }
+        fifo->head = (fifo->head + 1) % CODEC_TELEMETRY_MAX_HELD;
+        fifo->num--;
+    }
+    uint32_t tail = (fifo->head + fifo->num) % CODEC_TELEMETRY_MAX_HELD;
+    fifo->queuedUs[tail] = queuedUs;
+    fifo->pts[tail] = pts;
+    fifo->num++;
+}
+
+static void CodecTelemetryFifoDrop(struct CodecTelemetryFifo *fifo, uint32_t num)
+{
+    num = (num > fifo->num) ? fifo->num : num;
+    fifo->head = (fifo->head + num) % CODEC_TELEMETRY_MAX_HELD;
+    fifo->num -= num;
+}
+
+static bool CodecTelemetryIsValid(const struct CodecTelemetry *telemetry, DirectionType direct)
+{
+    return telemetry != NULL && (direct == INPUT_TYPE || direct == OUTPUT_TYPE);
+}
+
+struct CodecTelemetry *CodecTelemetryCreate(void)
+{
+    struct CodecTelemetry *telemetry = (struct CodecTelemetry *)OsalMemCalloc(sizeof(struct CodecTelemetry));
+    if (telemetry == NULL) {
+        HDF_LOGE("%{public}s: OsalMemCalloc failed!", __func__);
+        return NULL;
+    }
+    pthread_mutex_init(&telemetry->mutex, NULL);
+    telemetry->lastProgressUs = CodecTelemetryNowUs();
+    return telemetry;
+}
+
+void CodecTelemetryDestroy(struct CodecTelemetry *telemetry)
+{
+    if (telemetry == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&telemetry->mutex);
+    OsalMemFree(telemetry);
+}
+
+void CodecTelemetryOnQueued(struct CodecTelemetry *telemetry, DirectionType direct, int64_t pts)
+{
+    if (!CodecTelemetryIsValid(telemetry, direct)) {
+        return;
+    }
+    uint64_t now = CodecTelemetryNowUs();
+    pthread_mutex_lock(&telemetry->mutex);
+    struct CodecTelemetryPort *port = &telemetry->stats.ports[direct];
+    // waiting for input is no stall, the time counts from the first input held
+    if (direct == INPUT_TYPE && port->held == 0) {
+        telemetry->lastProgressUs = now;
+    }
+    port->queued++;
+    port->held++;
+    if (port->held > port->maxHeld) {
+        port->maxHeld = port->held;
+    }
+    CodecHistogramAddSample(&port->depth, port->held);
+    CodecTelemetryFifoPush(&telemetry->held[direct], now, pts, false);
+    if (direct == INPUT_TYPE) {
+        CodecTelemetryFifoPush(&telemetry->pendingInputs, now, pts, true);
+    }
+    pthread_mutex_unlock(&telemetry->mutex);
+}
+
+void CodecTelemetryOnRejected(struct CodecTelemetry *telemetry, DirectionType direct)
+{
+    if (!CodecTelemetryIsValid(telemetry, direct)) {
+        return;
+    }
+    pthread_mutex_lock(&telemetry->mutex);
+    struct CodecTelemetryPort *port = &telemetry->stats.ports[direct];
+    if (port->held > 0) {
+        // an untimed submission leaves the queue times of the others alone
+        if (telemetry->held[direct].num == port->held) {
+            telemetry->held[direct].num--;
+        }
+        if (direct == INPUT_TYPE && telemetry->pendingInputs.num > 0) {
+            telemetry->pendingInputs.num--;
+        }
+        port->held--;
+        port->queued--;
+    }
+    pthread_mutex_unlock(&telemetry->mutex);
+}
+
+static uint32_t CodecTelemetryFilledLen(const CodecBufferInfo *buffers, uint32_t bufferCnt)
+{
+    uint32_t filledLen = 0;
+    for (uint32_t i = 0; buffers != NULL && i < bufferCnt; i++) {
+        filledLen += buffers[i].length;
+    }
+    return filledLen;
+}
+
+// the inputs before the one of this pts produced no output of their own
+static void CodecTelemetryMatchInput(struct CodecTelemetry *telemetry, int64_t pts, uint64_t now)
+{
+    struct CodecTelemetryFifo *pending = &telemetry->pendingInputs;
+    for (uint32_t i = 0; i < pending->num; i++) {
+        uint32_t index = (pending->head + i) % CODEC_TELEMETRY_MAX_HELD;
+        if (pending->pts[index] == pts) {
+            CodecHistogramAddSample(&telemetry->stats.latencyUs, now - pending->queuedUs[index]);
+            CodecTelemetryFifoDrop(pending, i + 1);
+            return;
+        }
+    }
+}
+
+void CodecTelemetryOnReturned(struct CodecTelemetry *telemetry, DirectionType direct, int64_t pts,
+                              const CodecBufferInfo *buffers, uint32_t bufferCnt)
+{
+    if (!CodecTelemetryIsValid(telemetry, direct)) {
+        return;
+    }
+    uint64_t now = CodecTelemetryNowUs();
+    pthread_mutex_lock(&telemetry->mutex);
+    telemetry->lastProgressUs = now;
+    telemetry->stalled = false;
+    struct CodecTelemetryPort *port = &telemetry->stats.ports[direct];
+    if (port->held == 0) {
+        // queued before a flush, it is counted as dropped already
+        pthread_mutex_unlock(&telemetry->mutex);
+        return;
+    }
+    struct CodecTelemetryFifo *held = &telemetry->held[direct];
+    if (held->num > 0) {
+        CodecHistogramAddSample(&port->turnaroundUs, now - held->queuedUs[held->head]);
+        CodecTelemetryFifoDrop(held, 1);
+    }
+    port->held--;
+    port->returned++;
+    if (direct == OUTPUT_TYPE && CodecTelemetryFilledLen(buffers, bufferCnt) != 0) {
+        CodecTelemetryMatchInput(telemetry, pts, now);
+    }
+    pthread_mutex_unlock(&telemetry->mutex);
+}
+
+void CodecTelemetryOnFlushed(struct CodecTelemetry *telemetry, DirectionType direct)
+{
+    if (telemetry == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&telemetry->mutex);
+    for (int32_t i = INPUT_TYPE; i < ALL_TYPE; i++) {
+        if (direct != ALL_TYPE && direct != (DirectionType)i) {
+            continue;
+        }
+        telemetry->stats.ports[i].held = 0;
+        CodecTelemetryFifoDrop(&telemetry->held[i], CODEC_TELEMETRY_MAX_HELD);
+        if (i == INPUT_TYPE) {
+            CodecTelemetryFifoDrop(&telemetry->pendingInputs, CODEC_TELEMETRY_MAX_HELD);
+        }
+    }
+    pthread_mutex_unlock(&telemetry->mutex);
+}
+
+bool CodecTelemetryCheckStall(struct CodecTelemetry *telemetry, uint32_t timeoutMs)
+{
+    if (telemetry == NULL) {
+        return false;
+    }
+    uint64_t now = CodecTelemetryNowUs();
+    bool stall = false;
+    pthread_mutex_lock(&telemetry->mutex);
+    // without an output submission the codec waits for the client
+    if (telemetry->stats.ports[INPUT_TYPE].held == 0 || telemetry->stats.ports[OUTPUT_TYPE].held == 0) {
+        telemetry->stalled = false;
+    } else if (!telemetry->stalled && now - telemetry->lastProgressUs >= (uint64_t)timeoutMs * US_PER_MS) {
+        telemetry->stalled = true;
+        telemetry->stats.stalls++;
+        stall = true;
+    }
+    pthread_mutex_unlock(&telemetry->mutex);
+    return stall;
+}
+
+void CodecTelemetryGetStats(struct CodecTelemetry *telemetry, struct CodecTelemetryStats *stats)
+{
+    if (telemetry == NULL || stats == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&telemetry->mutex);
+    *stats = telemetry->stats;
+    pthread_mutex_unlock(&telemetry->mutex);
+}
+
+void CodecTelemetryLog(struct CodecTelemetry *telemetry, const char *name, bool histograms)
+{
+    const char *names[ALL_TYPE] = {"input", "output"};
+    struct CodecTelemetryStats stats = {0};
+    CodecTelemetryGetStats(telemetry, &stats);
+    char text[CODEC_TELEMETRY_TEXT_LEN];
+    for (int32_t i = INPUT_TYPE; i < ALL_TYPE; i++) {
+        const struct CodecTelemetryPort *port = &stats.ports[i];
+        HDF_LOGI("%{public}s %{public}s queued %{public}llu returned %{public}llu held %{public}u max %{public}u,"
+                 " turnaround avg %{public}llu max %{public}llu us, depth avg %{public}llu", name, names[i],
+                 (unsigned long long)port->queued, (unsigned long long)port->returned, port->held, port->maxHeld,
+                 (unsigned long long)CodecHistogramAverage(&port->turnaroundUs),
+                 (unsigned long long)port->turnaroundUs.max, (unsigned long long)CodecHistogramAverage(&port->depth));
+        if (histograms) {
+            CodecHistogramFormat(&port->turnaroundUs, text, sizeof(text));
+            HDF_LOGI("%{public}s %{public}s turnaround us [%{public}s]", name, names[i], text);
+            CodecHistogramFormat(&port->depth, text, sizeof(text));
+            HDF_LOGI("%{public}s %{public}s depth [%{public}s]", name, names[i], text);
+        }
+    }
+    HDF_LOGI("%{public}s latency %{public}llu frames avg %{public}llu max %{public}llu us, stalls %{public}u", name,
+             (unsigned long long)stats.latencyUs.count, (unsigned long long)CodecHistogramAverage(&stats.latencyUs),
+             (unsigned long long)stats.latencyUs.max, stats.stalls);
+    if (histograms) {
+        CodecHistogramFormat(&stats.latencyUs, text, sizeof(text));
+        HDF_LOGI("%{public}s latency us [%{public}s]", name, text);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
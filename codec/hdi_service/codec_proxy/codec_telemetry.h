@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CODEC_TELEMETRY_H
+#define CODEC_TELEMETRY_H
+
+#include <stdbool.h>
+#include "codec_histogram.h"
+#include "codec_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Where the submissions of one codec instance are and how long they stay there, fed by the
+ * IPC calls of the service and by the threads of its ring. A submission is one InputInfo or
+ * OutputInfo, the codec hands them back in the order they were queued in a direction.
+ */
+
+struct CodecTelemetryPort {
+    uint64_t queued;
+    uint64_t returned;
+    uint32_t held;                                  // submissions the codec holds now
+    uint32_t maxHeld;
+    struct CodecHistogram turnaroundUs;             // queued to returned
+    struct CodecHistogram depth;                    // submissions held once one is queued
+};
+
+struct CodecTelemetryStats {
+    struct CodecTelemetryPort ports[ALL_TYPE];      // by DirectionType
+    struct CodecHistogram latencyUs;                // input queued to the output of the same pts returned
+    uint32_t stalls;
+};
+
+struct CodecTelemetry;
+
+struct CodecTelemetry *CodecTelemetryCreate(void);
+void CodecTelemetryDestroy(struct CodecTelemetry *telemetry);
+
+/* Record a submission before it is handed over, the codec may return it before the call does. */
+void CodecTelemetryOnQueued(struct CodecTelemetry *telemetry, DirectionType direct, int64_t pts);
+/* The codec refused the submission recorded last in the direction. */
+void CodecTelemetryOnRejected(struct CodecTelemetry *telemetry, DirectionType direct);
+void CodecTelemetryOnReturned(struct CodecTelemetry *telemetry, DirectionType direct, int64_t pts,
+                              const CodecBufferInfo *buffers, uint32_t bufferCnt);
+/* The codec dropped what it held in the direction, ALL_TYPE for both. */
+void CodecTelemetryOnFlushed(struct CodecTelemetry *telemetry, DirectionType direct);
+
+/*
+ * True once when the codec holds input and output submissions and returned nothing for timeoutMs,
+ * again after it moved on.
+ */
+bool CodecTelemetryCheckStall(struct CodecTelemetry *telemetry, uint32_t timeoutMs);
+void CodecTelemetryGetStats(struct CodecTelemetry *telemetry, struct CodecTelemetryStats *stats);
+/* Logs the counts, with the histograms if asked. */
+void CodecTelemetryLog(struct CodecTelemetry *telemetry, const char *name, bool histograms);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif // CODEC_TELEMETRY_H
@@ -42,6 +42,7 @@ enum {
     CMD_CODEC_QUEQUE_OUTPUT,
     CMD_CODEC_DEQUEQUE_OUTPUT,
     CMD_CODEC_SET_CBK,
+    CMD_CODEC_SET_RING,
 };
 
 struct ICodec {
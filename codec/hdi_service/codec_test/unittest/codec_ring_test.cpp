@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec_ring.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <hdf_base.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace testing::ext;
+
+namespace {
+constexpr uint32_t TIMEOUT_MS = 1000;
+constexpr uint32_t FRAME_NUM = 200;
+constexpr uint32_t PIPELINE_DEPTH = 8;
+// what the fake hardware takes for a frame, and how often it can start one
+constexpr auto FRAME_LATENCY = chrono::microseconds(2000);
+constexpr auto FRAME_INTERVAL = chrono::microseconds(200);
+
+struct FakeFrame {
+    CodecBufferInfo buffer;
+    int64_t pts;
+    int fence;
+    chrono::steady_clock::time_point ready;
+};
+
+// a pipelined codec, each frame is done a fixed time after it was queued
+class FakeCodec {
+public:
+    ~FakeCodec()
+    {
+        for (auto &frame : outputs_) {
+            CloseFrame(frame);
+        }
+    }
+
+    int32_t Queue(bool input, const CodecBufferInfo &buffer, int64_t pts, int fence)
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (failure_ != HDF_SUCCESS) {
+            return failure_;
+        }
+        FakeFrame frame = {buffer, pts, fence >= 0 ? dup(fence) : -1, {}};
+        if (buffer.type == BUFFER_TYPE_FD) {
+            frame.buffer.fd = dup(buffer.fd);
+        }
+        auto now = chrono::steady_clock::now();
+        frame.ready = max(now + FRAME_LATENCY, lastReady_ + FRAME_INTERVAL);
+        lastReady_ = frame.ready;
+        (input ? inputs_ : outputs_).push_back(frame);
+        cond_.notify_all();
+        return HDF_SUCCESS;
+    }
+
+    int32_t Deque(bool input, uint32_t timeoutMs, FakeFrame &frame)
+    {
+        unique_lock<mutex> lock(mutex_);
+        auto &frames = input ? inputs_ : outputs_;
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+        while (frames.empty() || frames.front().ready > chrono::steady_clock::now()) {
+            auto until = frames.empty() ? deadline : min(deadline, frames.front().ready);
+            if (cond_.wait_until(lock, until) == cv_status::timeout && chrono::steady_clock::now() >= deadline) {
+                return HDF_ERR_TIMEOUT;
+            }
+        }
+        frame = frames.front();
+        frames.pop_front();
+        if (!input) {
+            // the codec keeps what it hands out, as the IPC path expects
+            handedOut_.push_back(frame);
+        }
+        return HDF_SUCCESS;
+    }
+
+    void SetFailure(int32_t failure)
+    {
+        lock_guard<mutex> lock(mutex_);
+        failure_ = failure;
+    }
+
+    void Release()
+    {
+        for (auto &frame : handedOut_) {
+            CloseFrame(frame);
+        }
+        handedOut_.clear();
+    }
+
+private:
+    static void CloseFrame(FakeFrame &frame)
+    {
+        if (frame.fence >= 0) {
+            close(frame.fence);
+        }
+        if (frame.buffer.type == BUFFER_TYPE_FD && frame.buffer.fd >= 0) {
+            close(frame.buffer.fd);
+        }
+    }
+
+    mutex mutex_;
+    condition_variable cond_;
+    deque<FakeFrame> inputs_;
+    deque<FakeFrame> outputs_;
+    vector<FakeFrame> handedOut_;
+    chrono::steady_clock::time_point lastReady_;
+    int32_t failure_ = HDF_SUCCESS;
+};
+
+int32_t FakeQueueInput(CODEC_HANDLETYPE handle, const InputInfo *inputData, uint32_t timeoutMs)
+{
+    (void)timeoutMs;
+    return static_cast<FakeCodec *>(handle)->Queue(true, inputData->buffers[0], inputData->pts, -1);
+}
+
+int32_t FakeDequeInput(CODEC_HANDLETYPE handle, uint32_t timeoutMs, InputInfo *inputData)
+{
+    FakeFrame frame = {};
+    int32_t ret = static_cast<FakeCodec *>(handle)->Deque(true, timeoutMs, frame);
+    if (ret == HDF_SUCCESS) {
+        inputData->bufferCnt = 1;
+        inputData->buffers[0] = frame.buffer;
+        inputData->pts = frame.pts;
+    }
+    return ret;
+}
+
+int32_t FakeQueueOutput(CODEC_HANDLETYPE handle, OutputInfo *outInfo, uint32_t timeoutMs, int releaseFenceFd)
+{
+    (void)timeoutMs;
+    return static_cast<FakeCodec *>(handle)->Queue(false, outInfo->buffers[0], outInfo->timeStamp, releaseFenceFd);
+}
+
+int32_t FakeDequeueOutput(CODEC_HANDLETYPE handle, uint32_t timeoutMs, int *acquireFd, OutputInfo *outInfo)
+{
+    FakeFrame frame = {};
+    int32_t ret = static_cast<FakeCodec *>(handle)->Deque(false, timeoutMs, frame);
+    if (ret == HDF_SUCCESS) {
+        outInfo->bufferCnt = 1;
+        outInfo->buffers[0] = frame.buffer;
+        outInfo->timeStamp = frame.pts;
+        *acquireFd = frame.fence;
+    }
+    return ret;
+}
+
+const CodecRingOps g_fakeOps = {FakeQueueInput, FakeDequeInput, FakeQueueOutput, FakeDequeueOutput};
+
+bool SameFile(int left, int right)
+{
+    struct stat leftStat = {};
+    struct stat rightStat = {};
+    return fstat(left, &leftStat) == 0 && fstat(right, &rightStat) == 0 &&
+        leftStat.st_dev == rightStat.st_dev && leftStat.st_ino == rightStat.st_ino;
+}
+
+class CodecRingTest : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp()
+    {
+        ASSERT_EQ(CodecRingCreate(&client_), HDF_SUCCESS);
+        int shmFd = -1;
+        int doorbells[CODEC_RING_QUEUE_NUM];
+        ASSERT_EQ(CodecRingGetPeerFds(client_, &shmFd, doorbells), HDF_SUCCESS);
+        // what the IPC does to the fds on the way to the service
+        int peerDoorbells[CODEC_RING_QUEUE_NUM];
+        for (int32_t i = 0; i < CODEC_RING_QUEUE_NUM; i++) {
+            peerDoorbells[i] = dup(doorbells[i]);
+        }
+        int peerShmFd = dup(shmFd);
+        CodecRingClosePeerFds(client_);
+        telemetry_ = CodecTelemetryCreate();
+        ASSERT_NE(telemetry_, nullptr);
+        ASSERT_EQ(CodecRingServe(peerShmFd, peerDoorbells, &g_fakeOps, &codec_, telemetry_, &service_), HDF_SUCCESS);
+    }
+    void TearDown()
+    {
+        CodecRingDestroy(service_);
+        CodecRingDestroy(client_);
+        CodecTelemetryDestroy(telemetry_);
+        codec_.Release();
+    }
+
+    double RunFrames(uint32_t depth)
+    {
+        auto start = chrono::steady_clock::now();
+        uint32_t inFlight = 0;
+        for (uint32_t i = 0; i < FRAME_NUM; i++) {
+            if (inFlight == depth) {
+                EXPECT_EQ(DequeOne(), HDF_SUCCESS);
+                inFlight--;
+            }
+            CodecBufferInfo buffer = {};
+            buffer.type = BUFFER_TYPE_VIRTUAL;
+            InputInfo input = {1, &buffer, static_cast<int64_t>(i), 0};
+            EXPECT_EQ(CodecRingQueueInput(client_, &input, TIMEOUT_MS), HDF_SUCCESS);
+            inFlight++;
+        }
+        for (; inFlight > 0; inFlight--) {
+            EXPECT_EQ(DequeOne(), HDF_SUCCESS);
+        }
+        chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+        return FRAME_NUM / seconds.count();
+    }
+
+    int32_t DequeOne()
+    {
+        CodecBufferInfo buffer = {};
+        InputInfo input = {1, &buffer, 0, 0};
+        int32_t ret = CodecRingDequeInput(client_, TIMEOUT_MS, &input);
+        if (ret == HDF_SUCCESS && input.pts != static_cast<int64_t>(dequeued_++ % FRAME_NUM)) {
+            return HDF_FAILURE;
+        }
+        return ret;
+    }
+
+    CodecRing *client_ = nullptr;
+    CodecRing *service_ = nullptr;
+    CodecTelemetry *telemetry_ = nullptr;
+    FakeCodec codec_;
+    uint32_t dequeued_ = 0;
+};
+
+HWTEST_F(CodecRingTest, CodecRingTest_001, TestSize.Level1)
+{
+    constexpr uint32_t num = 3;
+    int32_t values[num] = {0};
+    for (uint32_t i = 0; i < num; i++) {
+        CodecBufferInfo buffer = {};
+        buffer.type = BUFFER_TYPE_VIRTUAL;
+        buffer.addr = reinterpret_cast<uint8_t *>(&values[i]);
+        buffer.length = sizeof(values[i]);
+        InputInfo input = {1, &buffer, static_cast<int64_t>(i), 0};
+        ASSERT_EQ(CodecRingQueueInput(client_, &input, TIMEOUT_MS), HDF_SUCCESS);
+    }
+    for (uint32_t i = 0; i < num; i++) {
+        CodecBufferInfo buffer = {};
+        InputInfo input = {1, &buffer, 0, 0};
+        ASSERT_EQ(CodecRingDequeInput(client_, TIMEOUT_MS, &input), HDF_SUCCESS);
+        EXPECT_EQ(input.pts, static_cast<int64_t>(i));
+        EXPECT_EQ(buffer.addr, reinterpret_cast<uint8_t *>(&values[i]));
+        EXPECT_EQ(buffer.length, sizeof(values[i]));
+    }
+}
+
+HWTEST_F(CodecRingTest, CodecRingTest_002, TestSize.Level1)
+{
+    int bufferPipe[2] = {-1, -1};
+    int fencePipe[2] = {-1, -1};
+    ASSERT_EQ(pipe(bufferPipe), 0);
+    ASSERT_EQ(pipe(fencePipe), 0);
+    CodecBufferInfo buffer = {};
+    buffer.type = BUFFER_TYPE_FD;
+    buffer.fd = bufferPipe[0];
+    OutputInfo output = {};
+    output.bufferCnt = 1;
+    output.buffers = &buffer;
+    output.timeStamp = 1;
+    EXPECT_EQ(CodecRingQueueOutput(client_, &output, TIMEOUT_MS, fencePipe[0]), HDF_SUCCESS);
+
+    CodecBufferInfo outBuffer = {};
+    OutputInfo outInfo = {};
+    outInfo.bufferCnt = 1;
+    outInfo.buffers = &outBuffer;
+    int acquireFd = -1;
+    ASSERT_EQ(CodecRingDequeueOutput(client_, TIMEOUT_MS, &acquireFd, &outInfo), HDF_SUCCESS);
+    EXPECT_EQ(outInfo.timeStamp, 1);
+    EXPECT_EQ(outBuffer.type, BUFFER_TYPE_FD);
+    EXPECT_TRUE(SameFile(outBuffer.fd, bufferPipe[0]));
+    EXPECT_TRUE(SameFile(acquireFd, fencePipe[0]));
+    close(outBuffer.fd);
+    close(acquireFd);
+    close(bufferPipe[0]);
+    close(bufferPipe[1]);
+    close(fencePipe[0]);
+    close(fencePipe[1]);
+}
+
+HWTEST_F(CodecRingTest, CodecRingTest_003, TestSize.Level1)
+{
+    CodecBufferInfo buffer = {};
+    buffer.type = BUFFER_TYPE_VIRTUAL;
+    InputInfo input = {1, &buffer, 0, 0};
+    codec_.SetFailure(HDF_ERR_DEVICE_BUSY);
+    // the failure of the codec comes back with the next submission
+    EXPECT_EQ(CodecRingQueueInput(client_, &input, TIMEOUT_MS), HDF_SUCCESS);
+    EXPECT_EQ(CodecRingDrain(service_, TIMEOUT_MS), HDF_SUCCESS);
+    codec_.SetFailure(HDF_SUCCESS);
+    EXPECT_EQ(CodecRingQueueInput(client_, &input, TIMEOUT_MS), HDF_ERR_DEVICE_BUSY);
+    EXPECT_EQ(CodecRingQueueInput(client_, &input, TIMEOUT_MS), HDF_SUCCESS);
+    EXPECT_EQ(CodecRingDequeInput(client_, TIMEOUT_MS, &input), HDF_SUCCESS);
+}
+
+HWTEST_F(CodecRingTest, CodecRingTest_004, TestSize.Level1)
+{
+    // depth 1 is what a queue call per IPC round trip gets
+    double serialFps = RunFrames(1);
+    double pipelinedFps = RunFrames(PIPELINE_DEPTH);
+    printf("%u frames, depth 1: %.0f fps, depth %u: %.0f fps\n", FRAME_NUM, serialFps, PIPELINE_DEPTH, pipelinedFps);
+    EXPECT_EQ(dequeued_, FRAME_NUM * 2);
+    EXPECT_GT(pipelinedFps, serialFps);
+}
+
+HWTEST_F(CodecRingTest, CodecRingTest_005, TestSize.Level1)
+{
+    constexpr uint32_t num = 4;
+    for (uint32_t i = 0; i < num; i++) {
+        CodecBufferInfo buffer = {};
+        buffer.type = BUFFER_TYPE_VIRTUAL;
+        buffer.length = 1;
+        InputInfo input = {1, &buffer, static_cast<int64_t>(i), 0};
+        ASSERT_EQ(CodecRingQueueInput(client_, &input, TIMEOUT_MS), HDF_SUCCESS);
+        OutputInfo output = {};
+        output.bufferCnt = 1;
+        output.buffers = &buffer;
+        output.timeStamp = static_cast<int64_t>(i);
+        ASSERT_EQ(CodecRingQueueOutput(client_, &output, TIMEOUT_MS, -1), HDF_SUCCESS);
+    }
+    for (uint32_t i = 0; i < num; i++) {
+        EXPECT_EQ(DequeOne(), HDF_SUCCESS);
+        CodecBufferInfo buffer = {};
+        OutputInfo output = {};
+        output.bufferCnt = 1;
+        output.buffers = &buffer;
+        int acquireFd = -1;
+        ASSERT_EQ(CodecRingDequeueOutput(client_, TIMEOUT_MS, &acquireFd, &output), HDF_SUCCESS);
+    }
+    // the ring threads record the submission before they take the next one off the ring
+    CodecTelemetryStats stats = {};
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(TIMEOUT_MS);
+    do {
+        CodecTelemetryGetStats(telemetry_, &stats);
+    } while ((stats.ports[INPUT_TYPE].returned != num || stats.ports[OUTPUT_TYPE].returned != num) &&
+             chrono::steady_clock::now() < deadline);
+    for (int32_t i = INPUT_TYPE; i < ALL_TYPE; i++) {
+        EXPECT_EQ(stats.ports[i].queued, num);
+        EXPECT_EQ(stats.ports[i].returned, num);
+        EXPECT_EQ(stats.ports[i].held, 0u);
+        EXPECT_EQ(stats.ports[i].turnaroundUs.count, num);
+        EXPECT_GE(stats.ports[i].turnaroundUs.max, static_cast<uint64_t>(FRAME_LATENCY.count()));
+    }
+    EXPECT_EQ(stats.latencyUs.count, num);
+    EXPECT_FALSE(CodecTelemetryCheckStall(telemetry_, 0));
+}
+
+HWTEST_F(CodecRingTest, CodecRingTest_006, TestSize.Level1)
+{
+    CodecBufferInfo buffer = {};
+    buffer.type = BUFFER_TYPE_VIRTUAL;
+    InputInfo input = {1, &buffer, 0, 0};
+    // a codec that holds input and output and returns neither
+    CodecTelemetryOnQueued(telemetry_, INPUT_TYPE, 0);
+    CodecTelemetryOnQueued(telemetry_, OUTPUT_TYPE, 0);
+    EXPECT_FALSE(CodecTelemetryCheckStall(telemetry_, TIMEOUT_MS));
+    EXPECT_TRUE(CodecTelemetryCheckStall(telemetry_, 0));
+    EXPECT_FALSE(CodecTelemetryCheckStall(telemetry_, 0));
+    ASSERT_EQ(CodecRingQueueInput(client_, &input, TIMEOUT_MS), HDF_SUCCESS);
+    EXPECT_EQ(DequeOne(), HDF_SUCCESS);
+    // it moved on, the next stall counts again
+    EXPECT_TRUE(CodecTelemetryCheckStall(telemetry_, 0));
+    CodecTelemetryOnFlushed(telemetry_, ALL_TYPE);
+    EXPECT_FALSE(CodecTelemetryCheckStall(telemetry_, 0));
+    CodecTelemetryStats stats = {};
+    CodecTelemetryGetStats(telemetry_, &stats);
+    EXPECT_EQ(stats.stalls, 2u);
+}
+
+HWTEST_F(CodecRingTest, CodecRingTest_007, TestSize.Level1)
+{
+    // the client calls come from several threads, every fd has to stay with its descriptor
+    constexpr uint32_t threadNum = 4;
+    constexpr uint32_t frameNum = 50;
+    int bufferPipe[2] = {-1, -1};
+    ASSERT_EQ(pipe(bufferPipe), 0);
+    vector<thread> threads;
+    vector<uint32_t> lost(threadNum, 0);
+    for (uint32_t t = 0; t < threadNum; t++) {
+        threads.emplace_back([this, t, &bufferPipe, &lost]() {
+            for (uint32_t i = 0; i < frameNum; i++) {
+                CodecBufferInfo buffer = {};
+                buffer.type = BUFFER_TYPE_FD;
+                buffer.fd = bufferPipe[0];
+                InputInfo input = {1, &buffer, static_cast<int64_t>(i), 0};
+                EXPECT_EQ(CodecRingQueueInput(client_, &input, TIMEOUT_MS), HDF_SUCCESS);
+                CodecBufferInfo outBuffer = {};
+                InputInfo done = {1, &outBuffer, 0, 0};
+                EXPECT_EQ(CodecRingDequeInput(client_, TIMEOUT_MS, &done), HDF_SUCCESS);
+                if (outBuffer.fd < 0 || !SameFile(outBuffer.fd, bufferPipe[0])) {
+                    lost[t]++;
+                }
+                if (outBuffer.fd >= 0) {
+                    close(outBuffer.fd);
+                }
+            }
+        });
+    }
+    for (auto &worker : threads) {
+        worker.join();
+    }
+    for (uint32_t t = 0; t < threadNum; t++) {
+        EXPECT_EQ(lost[t], 0u);
+    }
+    close(bufferPipe[0]);
+    close(bufferPipe[1]);
+}
+}
@@ -41,6 +41,7 @@
 #include <stdbool.h>
 #include "OMX_Types.h"
 #include "OMX_Index.h"
+#include "OMX_Core.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -360,6 +361,21 @@ enum OmxIndexCodecExType {
     OMX_IndexParamUseBufferType,
     /** GetBufferHandleUsage */
     OMX_IndexParamGetBufferHandleUsage,
+    /** Frame size of an encoder changed while it is executing, see {@link CodecVideoFrameSize} */
+    OMX_IndexConfigVideoFrameSize,
+};
+
+/**
+ * @brief Enumerates the extended codec events.
+ */
+enum OmxEventCodecExType {
+    /** Extended event start */
+    OMX_EventExtStartUnused = OMX_EventKhronosExtensions + 0x00a00000,
+    /**
+     * A config set with SetConfig took effect, <b>data1</b> is its index and <b>data2</b> the index of
+     * the first input frame coded with it. Input frames are counted from 0 since the component is created.
+     */
+    OMX_EventConfigApplied,
 };
 
 /**
@@ -421,6 +437,17 @@ struct GetBufferHandleUsageParams {
     uint32_t usage;                                        /** Usage */
 };
 
+/**
+ * @brief Defines the <b>VideoFrameSize</b> config.
+ */
+struct CodecVideoFrameSize {
+    uint32_t size;                                         /** Size of the structure */
+    union OMX_VERSIONTYPE version;                         /** Component version */
+    uint32_t portIndex;                                    /** Port index */
+    uint32_t width;                                        /** Frame width */
+    uint32_t height;                                       /** Frame height */
+};
+
 #ifdef __cplusplus
 #if __cplusplus
 }
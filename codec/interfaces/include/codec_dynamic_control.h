@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @addtogroup Codec
+ * @{
+ *
+ * @brief Defines APIs related to the Codec module.
+ *
+ * The Codec module provides APIs for initializing the custom data and audio and video codecs,
+ * setting codec parameters, and controlling and transferring data.
+ *
+ * @since 3.1
+ */
+
+/**
+ * @file codec_dynamic_control.h
+ *
+ * @brief Declares the controls an encoder takes while it is executing.
+ *
+ * A control is checked against the capability of the component and set with <b>SetConfig</b>.
+ * The component applies it from the next input frame on and reports the frame with
+ * {@link OMX_EventConfigApplied}.
+ *
+ * @since 3.1
+ */
+
+#ifndef CODEC_DYNAMIC_CONTROL_H
+#define CODEC_DYNAMIC_CONTROL_H
+
+#include <stdint.h>
+#include "codec_component_if.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @brief Enumerates the dynamic controls of an encoder.
+ */
+enum CodecControlType {
+    /** Target bit rate in bit/s, <b>OMX_IndexConfigVideoBitrate</b> */
+    CODEC_CONTROL_BITRATE,
+    /** Frame rate in Q16 format, <b>OMX_IndexConfigVideoFramerate</b> */
+    CODEC_CONTROL_FRAMERATE,
+    /** The next frame is coded as an IDR frame, <b>OMX_IndexConfigVideoIntraVOPRefresh</b> */
+    CODEC_CONTROL_REQUEST_IDR,
+    /** Frame size of the input and output, {@link OMX_IndexConfigVideoFrameSize} */
+    CODEC_CONTROL_RESOLUTION,
+};
+
+/**
+ * @brief Defines a dynamic control, the member of <b>value</b> used follows from <b>type</b>.
+ */
+struct CodecDynamicControl {
+    enum CodecControlType type;  /** Type of the control */
+    union {
+        uint32_t bitRate;        /** Bit rate in bit/s */
+        uint32_t frameRate;      /** Frame rate in Q16 format */
+        struct {
+            uint32_t width;      /** Frame width */
+            uint32_t height;     /** Frame height */
+        } size;
+    } value;
+};
+
+/**
+ * @brief Checks a control against the capability of an encoder.
+ *
+ * The frame rate is checked against the fastest rate the encoder reaches, which is with the smallest frame.
+ *
+ * @param cap Indicates the pointer to the capability, see {@link CodecCompCapability}.
+ * @param control Indicates the pointer to the control.
+ *
+ * @return Returns <b>HDF_SUCCESS</b> if the encoder takes the control.
+ * @return Returns <b>HDF_ERR_INVALID_PARAM</b> if the component is no encoder or the value is out of its range.
+ * @return Returns <b>HDF_ERR_NOT_SUPPORT</b> if the type is unknown.
+ */
+int32_t CodecCheckDynamicControl(const CodecCompCapability *cap, const struct CodecDynamicControl *control);
+
+/**
+ * @brief Packs a control into the config structure set with <b>SetConfig</b>.
+ *
+ * @param control Indicates the pointer to the control.
+ * @param index Indicates the pointer to the config index packed.
+ * @param config Indicates the pointer to the buffer of the config structure.
+ * @param len Indicates the pointer to the size of <b>config</b>, set to the size of the structure packed.
+ *
+ * @return Returns <b>HDF_SUCCESS</b> if the operation is successful.
+ * @return Returns <b>HDF_ERR_INVALID_PARAM</b> if <b>config</b> is too small.
+ * @return Returns <b>HDF_ERR_NOT_SUPPORT</b> if the type is unknown.
+ */
+int32_t CodecPackDynamicControl(const struct CodecDynamicControl *control, uint32_t *index, int8_t *config,
+    uint32_t *len);
+
+/**
+ * @brief Checks a control, packs it and sets it on an encoder.
+ *
+ * @param component Indicates the pointer to the component.
+ * @param cap Indicates the pointer to the capability of the component.
+ * @param control Indicates the pointer to the control.
+ *
+ * @return Returns <b>HDF_SUCCESS</b> if the operation is successful.
+ * @return Returns an error code of {@link CodecCheckDynamicControl} or <b>SetConfig</b> otherwise.
+ */
+int32_t CodecSetDynamicControl(struct CodecComponentType *component, const CodecCompCapability *cap,
+    const struct CodecDynamicControl *control);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CODEC_DYNAMIC_CONTROL_H */
+/** @} */
@@ -36,7 +36,7 @@
 #include "codec_component_type.h"
 #include "codec_types.h"
 
-enum class codecMime { AVC, HEVC };
+enum class codecMime { AVC, HEVC, RAW };
 
 enum class PortIndex { PORT_INDEX_INPUT = 0, PORT_INDEX_OUTPUT = 1 };
 
@@ -105,6 +105,7 @@ public:
     void WaitForStatusChanged();
     void onStatusChanged();
     bool ReadOnePacket(FILE *fp, char *buf, size_t &filledCount);
+    bool ReadOneFrame(FILE *fp, char *buf, size_t &filledCount);
 
 private:
     int32_t UseBufferOnPort(PortIndex portIndex);
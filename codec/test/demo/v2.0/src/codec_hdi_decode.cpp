@@ -39,6 +39,8 @@ constexpr int32_t START_CODE_SIZE_SLICE = 3;
 constexpr char START_CODE = 0x1;
 constexpr const char *decoder_avc = "OMX.rk.video_decoder.avc";
 constexpr const char *decoder_hevc = "OMX.rk.video_decoder.avc";
+// only a service built with codec_soft_component_enable has it
+constexpr const char *decoder_raw = "OMX.soft.video_decoder.raw";
 
 #define HDF_LOG_TAG codec_omx_hdi_dec
 
@@ -119,6 +121,24 @@ bool CodecHdiDecode::ReadOnePacket(FILE *fp, char *buf, size_t &filledCount)
     return ret;
 }
 
+bool CodecHdiDecode::ReadOneFrame(FILE *fp, char *buf, size_t &filledCount)
+{
+    // raw frames have no start code, every frame has the same size
+    size_t frameSize = (size_t)GetYuvSize();
+    filledCount = fread(buf, 1, frameSize, fp);
+    if (filledCount < frameSize) {
+        // a partial frame at the end is dropped
+        filledCount = 0;
+        return true;
+    }
+    int next = fgetc(fp);
+    if (next == EOF) {
+        return true;
+    }
+    (void)ungetc(next, fp);
+    return false;
+}
+
 bool CodecHdiDecode::Init(int width, int height, std::string &filename, codecMime codec)
 {
     this->width_ = width;
@@ -147,6 +167,8 @@ bool CodecHdiDecode::Init(int width, int height, std::string &filename, codecMim
     int32_t err = HDF_SUCCESS;
     if (codec == codecMime::AVC) {
         err = omxMgr_->CreateComponent(&client_, const_cast<char *>(decoder_avc), 0, 0, callback_);
+    } else if (codec == codecMime::RAW) {
+        err = omxMgr_->CreateComponent(&client_, const_cast<char *>(decoder_raw), 0, 0, callback_);
     } else {
         err = omxMgr_->CreateComponent(&client_, const_cast<char *>(decoder_hevc), 0, 0, callback_);
     }
@@ -233,6 +255,9 @@ bool CodecHdiDecode::Configure()
     param.xFramerate = FRAME;  // 30fps,Q16 format
     if (codecMime_ == codecMime::AVC) {
         param.eCompressionFormat = OMX_VIDEO_CodingAVC;  // H264
+    } else if (codecMime_ == codecMime::RAW) {
+        param.eCompressionFormat = OMX_VIDEO_CodingUnused;
+        param.eColorFormat = AV_COLOR_FORMAT;
     } else {
         param.eCompressionFormat = (OMX_VIDEO_CODINGTYPE)OMX_VIDEO_CodingHEVC;  // H265
     }
@@ -482,7 +507,11 @@ void CodecHdiDecode::Run()
         }
         auto bufferInfo = iter->second;
         void *sharedAddr = (void *)bufferInfo->avSharedPtr->ReadFromAshmem(0, 0);
-        eosFlag = (size_t)this->ReadOnePacket(fpIn_, (char *)sharedAddr, bufferInfo->omxBuffer->filledLen);
+        if (codecMime_ == codecMime::RAW) {
+            eosFlag = (size_t)this->ReadOneFrame(fpIn_, (char *)sharedAddr, bufferInfo->omxBuffer->filledLen);
+        } else {
+            eosFlag = (size_t)this->ReadOnePacket(fpIn_, (char *)sharedAddr, bufferInfo->omxBuffer->filledLen);
+        }
         HDF_LOGI("read data size is %{public}d", bufferInfo->omxBuffer->filledLen);
         bufferInfo->omxBuffer->offset = 0;
         if (eosFlag) {
@@ -591,6 +620,8 @@ int main(int argc, char *argv[])
         codec = codecMime::AVC;
     } else if (strcmp(codecString.c_str(), "hevc") == 0 || strcmp(codecString.c_str(), "HEVC") == 0) {
         codec = codecMime::HEVC;
+    } else if (strcmp(codecString.c_str(), "raw") == 0 || strcmp(codecString.c_str(), "RAW") == 0) {
+        codec = codecMime::RAW;
     } else {
         return 0;
     }
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Looks every key up in 128 capabilities with the scan the service did before the index and with the index,
+ * and prints the ns per lookup of both as one JSON object.
+ * usage: codec_capability_index_bench [rounds]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "codec_capability_index_fixture.h"
+
+namespace {
+using OHOS::Codec::CapabilityIndexFixture;
+using OHOS::Codec::CapabilityKey;
+
+const uint32_t DEFAULT_ROUNDS = 1000;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t rounds = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 0)) : DEFAULT_ROUNDS;
+    if (rounds == 0) {
+        rounds = DEFAULT_ROUNDS;
+    }
+    CapabilityIndexFixture fixture;
+    CodecCapabilityIndex index = {};
+    if (BuildCapabilityIndex(&fixture.caps_, &index) != HDF_SUCCESS) {
+        printf("build the capability index failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // the sums keep the lookups from being optimized away, both find the same capabilities
+    uintptr_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (const CapabilityKey &key : fixture.keys_) {
+            sink += reinterpret_cast<uintptr_t>(fixture.LinearLookup(key));
+        }
+    }
+    auto linear = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (const CapabilityKey &key : fixture.keys_) {
+            sink -= reinterpret_cast<uintptr_t>(LookupCapabilityIndex(&index, key.mime, key.type, key.flags));
+        }
+    }
+    auto indexed = std::chrono::steady_clock::now() - start;
+    int32_t num = index.num;
+    ClearCapabilityIndex(&index);
+    if (sink != 0) {
+        printf("the index and the scan disagree\n");
+        return EXIT_FAILURE;
+    }
+
+    double lookups = static_cast<double>(rounds) * fixture.keys_.size();
+    printf("{\"capabilities\":%d,\"keys\":%zu,\"rounds\":%u,\"linearNs\":%.1f,\"indexedNs\":%.1f}\n", num,
+           fixture.keys_.size(), rounds, std::chrono::duration<double, std::nano>(linear).count() / lookups,
+           std::chrono::duration<double, std::nano>(indexed).count() / lookups);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CODEC_CAPABILITY_INDEX_FIXTURE_H
+#define CODEC_CAPABILITY_INDEX_FIXTURE_H
+
+#include <vector>
+#include "codec_capability_index.h"
+#include "codec_type.h"
+
+namespace OHOS {
+namespace Codec {
+struct CapabilityKey {
+    AvCodecMime mime;
+    CodecType type;
+    uint32_t flags;
+};
+
+// 128 capabilities over the eight groups and every key the service can be asked for, shared by the
+// capability index test and bench
+class CapabilityIndexFixture {
+public:
+    static constexpr int32_t CAPS_PER_GROUP = 16;
+    static constexpr int32_t CODEC_TYPE_NUM = AUDIO_ENCODER + 1;
+
+    CapabilityIndexFixture() : caps_(), storage_(CODEC_CAPABLITY_GROUP_NUM * CAPS_PER_GROUP)
+    {
+        CodecCapablityGroup *groups[] = {&caps_.videoHwEncoderGroup, &caps_.videoHwDecoderGroup,
+                                         &caps_.videoSwEncoderGroup, &caps_.videoSwDecoderGroup,
+                                         &caps_.audioHwEncoderGroup, &caps_.audioHwDecoderGroup,
+                                         &caps_.audioSwEncoderGroup, &caps_.audioSwDecoderGroup};
+        for (int32_t i = 0; i < CODEC_CAPABLITY_GROUP_NUM; i++) {
+            groups[i]->num = CAPS_PER_GROUP;
+            groups[i]->capablitis = &storage_[i * CAPS_PER_GROUP];
+            for (int32_t j = 0; j < CAPS_PER_GROUP; j++) {
+                // keys repeat across and inside groups, the first one in lookup order has to win
+                CodecCapbility &cap = groups[i]->capablitis[j];
+                cap.mime = static_cast<AvCodecMime>((i * 3 + j) % MEDIA_MIMETYPE_INVALID);
+                cap.type = static_cast<CodecType>((i + j) % CODEC_TYPE_NUM);
+                cap.minInputBufferNum = i * CAPS_PER_GROUP + j;
+            }
+        }
+        caps_.inited = true;
+        for (uint32_t flags = 0; flags < 2; flags++) {
+            for (int32_t mime = 0; mime <= MEDIA_MIMETYPE_INVALID; mime++) {
+                for (int32_t type = 0; type < CODEC_TYPE_NUM; type++) {
+                    keys_.push_back({static_cast<AvCodecMime>(mime), static_cast<CodecType>(type), flags});
+                }
+            }
+        }
+    }
+
+    // the scan the service did before the index
+    CodecCapbility *LinearLookup(const CapabilityKey &key)
+    {
+        CodecCapablityGroup *groups[] = {&caps_.videoHwEncoderGroup, &caps_.videoHwDecoderGroup,
+                                         &caps_.audioHwEncoderGroup, &caps_.audioHwDecoderGroup,
+                                         &caps_.videoSwEncoderGroup, &caps_.videoSwDecoderGroup,
+                                         &caps_.audioSwEncoderGroup, &caps_.audioSwDecoderGroup};
+        const int32_t hardwareGroupNum = 4;
+        for (int32_t i = 0; i < CODEC_CAPABLITY_GROUP_NUM; i++) {
+            bool flagMatched = key.flags == 0 ? i < hardwareGroupNum : i >= hardwareGroupNum;
+            for (int32_t j = 0; j < groups[i]->num && flagMatched; j++) {
+                CodecCapbility *cap = &groups[i]->capablitis[j];
+                if (cap->mime == key.mime && cap->type == key.type) {
+                    return cap;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    CodecCapablites caps_;
+    std::vector<CodecCapbility> storage_;  // in the order the index enumerates
+    std::vector<CapabilityKey> keys_;
+};
+}  // namespace Codec
+}  // namespace OHOS
+#endif  // CODEC_CAPABILITY_INDEX_FIXTURE_H
@@ -15,6 +15,8 @@
 
 #include <gtest/gtest.h>
 #include "hdf_io_service_if.h"
+#include "codec_capability_index.h"
+#include "codec_capability_index_fixture.h"
 #include "codec_config_reader.h"
 #include "codec_utils.h"
 #include "codec_type.h"
@@ -54,4 +56,59 @@ HWTEST_F(CodecConfigTest, CodecConfigTest_002, TestSize.Level0)
         PrintCapability("codec_config_utest", &cap);
     }
 }
+
+HWTEST_F(CodecConfigTest, CodecConfigTest_003, TestSize.Level0)
+{
+    struct HdfRemoteService *remote = GetConfigService();
+    ASSERT_TRUE(remote != nullptr);
+
+    CodecCapabilityTable table = {};
+    ASSERT_EQ(GetAllCapabilities(remote, &table), HDF_SUCCESS);
+    ASSERT_NE(table.version, 0u);
+    int32_t enumerated = 0;
+    for (int index = 0; index < table.num + 1; index++) {
+        CodecCapbility cap;
+        if (EnumrateCapability(remote, index, &cap) == HDF_SUCCESS) {
+            enumerated++;
+        }
+    }
+    ASSERT_EQ(enumerated, table.num);
+    for (int32_t i = 0; i < table.num; i++) {
+        CodecCapbility &entry = table.entries[i].capability;
+        CodecCapbility cached;
+        CodecCapbility remoteCap;
+        ASSERT_EQ(FindCapability(&table, entry.mime, entry.type, table.entries[i].flags, &cached), HDF_SUCCESS);
+        ASSERT_EQ(GetCapability(remote, entry.mime, entry.type, table.entries[i].flags, &remoteCap), HDF_SUCCESS);
+        ASSERT_EQ(cached.minInputBufferNum, remoteCap.minInputBufferNum);
+        ASSERT_EQ(cached.capsMask, remoteCap.capsMask);
+    }
+
+    // the table is kept while the version holds
+    CodecCapabilityEntry *entries = table.entries;
+    uint32_t version = table.version;
+    ASSERT_EQ(GetAllCapabilities(remote, &table), HDF_SUCCESS);
+    ASSERT_EQ(table.version, version);
+    ASSERT_EQ(table.entries, entries);
+    ReleaseCapabilityTable(&table);
+    ASSERT_EQ(table.entries, nullptr);
+    ASSERT_EQ(table.version, 0u);
+}
+
+HWTEST_F(CodecConfigTest, CodecConfigTest_004, TestSize.Level1)
+{
+    OHOS::Codec::CapabilityIndexFixture fixture;
+    CodecCapabilityIndex index = {};
+    ASSERT_EQ(BuildCapabilityIndex(&fixture.caps_, &index), HDF_SUCCESS);
+    ASSERT_EQ(index.num, static_cast<int32_t>(fixture.storage_.size()));
+    for (int32_t i = 0; i < index.num; i++) {
+        ASSERT_EQ(EnumerateCapabilityIndex(&index, i), &fixture.storage_[i]);
+    }
+    ASSERT_EQ(EnumerateCapabilityIndex(&index, index.num), nullptr);
+
+    for (const OHOS::Codec::CapabilityKey &key : fixture.keys_) {
+        ASSERT_EQ(LookupCapabilityIndex(&index, key.mime, key.type, key.flags), fixture.LinearLookup(key));
+    }
+    ClearCapabilityIndex(&index);
+    ASSERT_EQ(index.sorted, nullptr);
+}
 }
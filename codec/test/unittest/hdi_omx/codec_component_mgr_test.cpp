@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "component_mgr.h"
+#include "soft_codecs.h"
+
+using namespace std;
+using namespace testing::ext;
+using namespace OHOS::Codec::Omx;
+
+namespace {
+constexpr uint32_t THREAD_NUM = 8;
+constexpr uint32_t CYCLE_NUM = 64;
+constexpr uint32_t HELD_NUM = 4;  // instances a thread holds at once
+const char *const SOFT_NAMES[] = {SOFT_RAW_DECODER_NAME, SOFT_PCM_DECODER_NAME, SOFT_RLE_ENCODER_NAME};
+constexpr uint32_t SOFT_NUM = sizeof(SOFT_NAMES) / sizeof(SOFT_NAMES[0]);
+
+OMX_ERRORTYPE OnEvent(OMX_HANDLETYPE, OMX_PTR, OMX_EVENTTYPE, OMX_U32, OMX_U32, OMX_PTR)
+{
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OnBufferDone(OMX_HANDLETYPE, OMX_PTR, OMX_BUFFERHEADERTYPE *)
+{
+    return OMX_ErrorNone;
+}
+
+OMX_CALLBACKTYPE g_callbacks = {OnEvent, OnBufferDone, OnBufferDone};
+
+class CodecComponentMgrTest : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp() {}
+    void TearDown() {}
+
+    ComponentMgr mgr_;
+};
+
+HWTEST_F(CodecComponentMgrTest, CodecComponentMgrTest_001, TestSize.Level1)
+{
+    ASSERT_TRUE(mgr_.IsLoadLibSuc());
+    char name[OMX_MAX_STRINGNAME_SIZE];
+    uint32_t soft = 0;
+    for (uint32_t i = 0; mgr_.EnumerateComponentsByIndex(i, name, sizeof(name)) == OMX_ErrorNone; i++) {
+        std::vector<std::string> roles;
+        ASSERT_EQ(mgr_.GetRolesForComponent(name, &roles), OMX_ErrorNone);
+        ASSERT_FALSE(roles.empty());
+        for (const char *softName : SOFT_NAMES) {
+            soft += (strcmp(name, softName) == 0) ? 1 : 0;
+        }
+    }
+    ASSERT_EQ(soft, SOFT_NUM);
+    std::vector<std::string> roles;
+    ASSERT_NE(mgr_.GetRolesForComponent("OMX.soft.none", &roles), OMX_ErrorNone);
+    OMX_COMPONENTTYPE *comp = nullptr;
+    ASSERT_NE(mgr_.CreateComponentInstance("OMX.soft.none", &g_callbacks, nullptr, &comp), OMX_ErrorNone);
+    ASSERT_EQ(mgr_.GetInstanceCount(nullptr), 0u);
+}
+
+HWTEST_F(CodecComponentMgrTest, CodecComponentMgrTest_002, TestSize.Level1)
+{
+    const uint32_t limit = 2;
+    ASSERT_EQ(mgr_.SetInstanceLimit(SOFT_RAW_DECODER_NAME, limit), OMX_ErrorNone);
+    OMX_COMPONENTTYPE *comps[limit] = {nullptr};
+    for (uint32_t i = 0; i < limit; i++) {
+        ASSERT_EQ(mgr_.CreateComponentInstance(SOFT_RAW_DECODER_NAME, &g_callbacks, nullptr, &comps[i]),
+                  OMX_ErrorNone);
+        ASSERT_TRUE(mgr_.IsOMXHandleValid(comps[i]));
+    }
+    OMX_COMPONENTTYPE *comp = nullptr;
+    ASSERT_EQ(mgr_.CreateComponentInstance(SOFT_RAW_DECODER_NAME, &g_callbacks, nullptr, &comp),
+              OMX_ErrorInsufficientResources);
+    // the limit is per component
+    ASSERT_EQ(mgr_.CreateComponentInstance(SOFT_PCM_DECODER_NAME, &g_callbacks, nullptr, &comp), OMX_ErrorNone);
+    ASSERT_EQ(mgr_.GetInstanceCount(SOFT_RAW_DECODER_NAME), limit);
+    ASSERT_EQ(mgr_.GetInstanceCount(nullptr), limit + 1);
+
+    ASSERT_EQ(mgr_.DeleteComponentInstance(comps[0]), OMX_ErrorNone);
+    ASSERT_FALSE(mgr_.IsOMXHandleValid(comps[0]));
+    ASSERT_NE(mgr_.DeleteComponentInstance(comps[0]), OMX_ErrorNone);
+    ASSERT_EQ(mgr_.CreateComponentInstance(SOFT_RAW_DECODER_NAME, &g_callbacks, nullptr, &comps[0]),
+              OMX_ErrorNone);
+    for (OMX_COMPONENTTYPE *it : comps) {
+        ASSERT_EQ(mgr_.DeleteComponentInstance(it), OMX_ErrorNone);
+    }
+    ASSERT_EQ(mgr_.DeleteComponentInstance(comp), OMX_ErrorNone);
+    ASSERT_EQ(mgr_.GetInstanceCount(nullptr), 0u);
+}
+
+HWTEST_F(CodecComponentMgrTest, CodecComponentMgrTest_003, TestSize.Level1)
+{
+    // the limit of the service holds whatever the limits of the components are
+    for (const char *name : SOFT_NAMES) {
+        ASSERT_EQ(mgr_.SetInstanceLimit(name, 0), OMX_ErrorNone);
+    }
+    std::vector<OMX_COMPONENTTYPE *> comps;
+    int32_t err = OMX_ErrorNone;
+    while (err == OMX_ErrorNone) {
+        OMX_COMPONENTTYPE *comp = nullptr;
+        err = mgr_.CreateComponentInstance(SOFT_NAMES[comps.size() % SOFT_NUM], &g_callbacks, nullptr, &comp);
+        if (err == OMX_ErrorNone) {
+            comps.push_back(comp);
+        }
+    }
+    ASSERT_EQ(err, OMX_ErrorInsufficientResources);
+    ASSERT_FALSE(comps.empty());
+    ASSERT_EQ(mgr_.GetInstanceCount(nullptr), comps.size());
+    ASSERT_EQ(mgr_.DeleteComponentInstance(comps.back()), OMX_ErrorNone);
+    ASSERT_EQ(mgr_.CreateComponentInstance(SOFT_RAW_DECODER_NAME, &g_callbacks, nullptr, &comps.back()),
+              OMX_ErrorNone);
+    for (OMX_COMPONENTTYPE *comp : comps) {
+        ASSERT_EQ(mgr_.DeleteComponentInstance(comp), OMX_ErrorNone);
+    }
+}
+
+HWTEST_F(CodecComponentMgrTest, CodecComponentMgrTest_004, TestSize.Level1)
+{
+    for (const char *name : SOFT_NAMES) {
+        ASSERT_EQ(mgr_.SetInstanceLimit(name, 0), OMX_ErrorNone);
+    }
+    std::atomic<uint32_t> failures(0);
+    std::atomic<uint32_t> cycles(0);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREAD_NUM; t++) {
+        threads.emplace_back([this, t, &failures, &cycles] {
+            for (uint32_t c = 0; c < CYCLE_NUM; c++) {
+                OMX_COMPONENTTYPE *comps[HELD_NUM] = {nullptr};
+                for (uint32_t i = 0; i < HELD_NUM; i++) {
+                    const char *name = SOFT_NAMES[(t + c + i) % SOFT_NUM];
+                    if (mgr_.CreateComponentInstance(name, &g_callbacks, nullptr, &comps[i]) != OMX_ErrorNone) {
+                        failures++;
+                    }
+                }
+                for (OMX_COMPONENTTYPE *comp : comps) {
+                    OMX_STATETYPE state = OMX_StateInvalid;
+                    if ((comp == nullptr) || !mgr_.IsOMXHandleValid(comp) ||
+                        (comp->GetState(comp, &state) != OMX_ErrorNone) || (state != OMX_StateLoaded)) {
+                        failures++;
+                        continue;
+                    }
+                    if (mgr_.DeleteComponentInstance(comp) != OMX_ErrorNone) {
+                        failures++;
+                    }
+                }
+                cycles++;
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(failures.load(), 0u);
+    ASSERT_EQ(cycles.load(), THREAD_NUM * CYCLE_NUM);
+    ASSERT_EQ(mgr_.GetInstanceCount(nullptr), 0u);
+}
+}  // namespace
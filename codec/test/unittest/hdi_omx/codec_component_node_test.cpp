@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ashmem.h>
+#include <gtest/gtest.h>
+#include <osal_mem.h>
+#include <unistd.h>
+#include <vector>
+#include "component_node.h"
+#include "fake_component.h"
+
+using namespace std;
+using namespace testing::ext;
+using namespace OHOS::Codec::Omx;
+
+namespace {
+constexpr uint32_t INPUT_PORT = 0;
+constexpr uint32_t BUFFER_SIZE = 1024;
+constexpr uint32_t FRAME_SIZE = 16;
+constexpr uint8_t FRAME_BYTE = 0x5a;
+
+int32_t OnEvent(struct CodecCallbackType *, enum OMX_EVENTTYPE, struct EventInfo *)
+{
+    return HDF_SUCCESS;
+}
+
+int32_t OnEmptyBufferDone(struct CodecCallbackType *, int8_t *, uint32_t, const struct OmxCodecBuffer *)
+{
+    return HDF_SUCCESS;
+}
+
+int32_t OnFillBufferDone(struct CodecCallbackType *, int8_t *, uint32_t, struct OmxCodecBuffer *)
+{
+    return HDF_SUCCESS;
+}
+
+class CodecComponentNodeTest : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp()
+    {
+        auto callback = static_cast<struct CodecCallbackType *>(OsalMemCalloc(sizeof(struct CodecCallbackType)));
+        ASSERT_NE(callback, nullptr);
+        callback->EventHandler = OnEvent;
+        callback->EmptyBufferDone = OnEmptyBufferDone;
+        callback->FillBufferDone = OnFillBufferDone;
+        // the node frees the callback
+        node_ = std::make_shared<ComponentNode>(callback, nullptr, 0);
+        node_->SetHandle(&fake_.comp_);
+        fake_.appData_ = node_.get();
+    }
+    void TearDown()
+    {
+        if (bufferUsed_) {
+            (void)node_->FreeBuffer(INPUT_PORT, buffer_);
+        }
+        node_ = nullptr;
+        client_ = nullptr;
+    }
+
+    // the client keeps its own mapping of the shared memory, the node gets the fd
+    bool UseBuffer(enum ShareMemTypes type)
+    {
+        int fd = AshmemCreate("codec_node_test", BUFFER_SIZE);
+        if (fd < 0) {
+            return false;
+        }
+        int clientFd = dup(fd);
+        if (clientFd < 0) {
+            close(fd);
+            return false;
+        }
+        client_ = std::make_shared<OHOS::Ashmem>(clientFd, BUFFER_SIZE);
+        if (!client_->MapReadAndWriteAshmem()) {
+            close(fd);
+            return false;
+        }
+        buffer_ = {};
+        buffer_.size = sizeof(buffer_);
+        buffer_.bufferType = BUFFER_TYPE_AVSHARE_MEM_FD;
+        buffer_.buffer = reinterpret_cast<uint8_t *>(static_cast<unsigned long>(fd));
+        buffer_.bufferLen = sizeof(int);
+        buffer_.allocLen = BUFFER_SIZE;
+        buffer_.type = type;
+        buffer_.fenceFd = -1;
+        if (node_->UseBuffer(INPUT_PORT, buffer_) != OMX_ErrorNone) {
+            close(fd);
+            return false;
+        }
+        // the node owns the fd now
+        buffer_.buffer = nullptr;
+        buffer_.bufferLen = 0;
+        bufferUsed_ = true;
+        return true;
+    }
+
+    int32_t QueueFrame()
+    {
+        std::vector<uint8_t> frame(FRAME_SIZE, FRAME_BYTE);
+        if (!client_->WriteToAshmem(frame.data(), FRAME_SIZE, 0)) {
+            return OMX_ErrorUndefined;
+        }
+        buffer_.offset = 0;
+        buffer_.filledLen = FRAME_SIZE;
+        buffer_.flag = 0;
+        return node_->EmptyThisBuffer(buffer_);
+    }
+
+    // the bytes of the client are as it wrote them
+    bool ClientFrameIntact()
+    {
+        auto data = static_cast<const uint8_t *>(client_->ReadFromAshmem(FRAME_SIZE, 0));
+        if (data == nullptr) {
+            return false;
+        }
+        for (uint32_t i = 0; i < FRAME_SIZE; i++) {
+            if (data[i] != FRAME_BYTE) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    FakeComponent fake_;
+    std::shared_ptr<ComponentNode> node_;
+    std::shared_ptr<OHOS::Ashmem> client_;
+    struct OmxCodecBuffer buffer_ = {};
+    bool bufferUsed_ = false;
+};
+
+// a read and write buffer of the client is bound to the component, nothing is copied
+HWTEST_F(CodecComponentNodeTest, CodecComponentNodeTest_001, TestSize.Level1)
+{
+    ASSERT_TRUE(UseBuffer(READ_WRITE_TYPE));
+    ASSERT_EQ(QueueFrame(), OMX_ErrorNone);
+    ASSERT_EQ(fake_.lastFrame_, std::vector<uint8_t>(FRAME_SIZE, FRAME_BYTE));
+
+    struct BufferCopyStats stats = {};
+    node_->GetBufferStats(stats);
+    ASSERT_EQ(stats.zeroCopyBuffers, 1u);
+    ASSERT_EQ(stats.copyBuffers, 0u);
+    ASSERT_EQ(stats.inputCopies, 0u);
+    // the component wrote to the shared memory itself
+    ASSERT_FALSE(ClientFrameIntact());
+}
+
+// a read only buffer of the client is never handed to the component, the frame is copied
+HWTEST_F(CodecComponentNodeTest, CodecComponentNodeTest_002, TestSize.Level1)
+{
+    ASSERT_TRUE(UseBuffer(READ_ONLY_TYPE));
+    ASSERT_EQ(QueueFrame(), OMX_ErrorNone);
+    ASSERT_EQ(fake_.lastFrame_, std::vector<uint8_t>(FRAME_SIZE, FRAME_BYTE));
+    ASSERT_NE(fake_.lastInput_, client_->ReadFromAshmem(FRAME_SIZE, 0));
+
+    struct BufferCopyStats stats = {};
+    node_->GetBufferStats(stats);
+    ASSERT_EQ(stats.zeroCopyBuffers, 0u);
+    ASSERT_EQ(stats.copyBuffers, 1u);
+    ASSERT_EQ(stats.inputCopies, 1u);
+    ASSERT_EQ(stats.inputBytes, FRAME_SIZE);
+    ASSERT_TRUE(ClientFrameIntact());
+}
+
+// a component that refuses the buffer of the client gets its own one
+HWTEST_F(CodecComponentNodeTest, CodecComponentNodeTest_003, TestSize.Level1)
+{
+    fake_.refuseUseBuffer_ = true;
+    ASSERT_TRUE(UseBuffer(READ_WRITE_TYPE));
+    ASSERT_EQ(QueueFrame(), OMX_ErrorNone);
+    ASSERT_EQ(fake_.lastFrame_, std::vector<uint8_t>(FRAME_SIZE, FRAME_BYTE));
+
+    struct BufferCopyStats stats = {};
+    node_->GetBufferStats(stats);
+    ASSERT_EQ(stats.zeroCopyBuffers, 0u);
+    ASSERT_EQ(stats.copyBuffers, 1u);
+    ASSERT_EQ(stats.inputCopies, 1u);
+    ASSERT_TRUE(ClientFrameIntact());
+}
+}  // namespace
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ashmem.h>
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <osal_mem.h>
+#include <thread>
+#include <vector>
+#include "component_node.h"
+#include "component_telemetry.h"
+#include "component_watchdog.h"
+#include "fake_component.h"
+
+using namespace std;
+using namespace testing::ext;
+using namespace OHOS::Codec::Omx;
+
+namespace {
+constexpr uint32_t INPUT_PORT = 0;
+constexpr uint32_t OUTPUT_PORT = 1;
+constexpr uint32_t BUFFER_NUM = 2;
+constexpr uint32_t BUFFER_SIZE = 1024;
+constexpr uint32_t FRAME_SIZE = 16;
+constexpr uint32_t FRAME_NUM = 8;
+constexpr int64_t PTS_STEP = 33333;
+constexpr uint32_t TIMEOUT_MS = 50;
+constexpr uint32_t INTERVAL_MS = 10;
+constexpr uint32_t WAIT_MS = 2000;
+
+std::atomic<uint32_t> g_emptyDone(0);
+std::atomic<uint32_t> g_fillDone(0);
+
+int32_t OnEvent(struct CodecCallbackType *, enum OMX_EVENTTYPE, struct EventInfo *)
+{
+    return HDF_SUCCESS;
+}
+
+int32_t OnEmptyBufferDone(struct CodecCallbackType *, int8_t *, uint32_t, const struct OmxCodecBuffer *)
+{
+    g_emptyDone++;
+    return HDF_SUCCESS;
+}
+
+int32_t OnFillBufferDone(struct CodecCallbackType *, int8_t *, uint32_t, struct OmxCodecBuffer *)
+{
+    g_fillDone++;
+    return HDF_SUCCESS;
+}
+
+class CodecComponentWatchdogTest : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp()
+    {
+        g_emptyDone = 0;
+        g_fillDone = 0;
+        auto callback = static_cast<struct CodecCallbackType *>(OsalMemCalloc(sizeof(struct CodecCallbackType)));
+        ASSERT_NE(callback, nullptr);
+        callback->EventHandler = OnEvent;
+        callback->EmptyBufferDone = OnEmptyBufferDone;
+        callback->FillBufferDone = OnFillBufferDone;
+        // the node frees the callback
+        node_ = std::make_shared<ComponentNode>(callback, nullptr, 0);
+        node_->SetHandle(&fake_.comp_);
+        fake_.appData_ = node_.get();
+        fake_.pairBuffers_ = true;
+        for (uint32_t i = 0; i < BUFFER_NUM; i++) {
+            ASSERT_TRUE(UseBuffer(INPUT_PORT, inputs_));
+            ASSERT_TRUE(UseBuffer(OUTPUT_PORT, outputs_));
+        }
+    }
+    void TearDown()
+    {
+        for (auto &buffer : inputs_) {
+            (void)node_->FreeBuffer(INPUT_PORT, buffer);
+        }
+        for (auto &buffer : outputs_) {
+            (void)node_->FreeBuffer(OUTPUT_PORT, buffer);
+        }
+        inputs_.clear();
+        outputs_.clear();
+        node_ = nullptr;
+    }
+
+    bool UseBuffer(uint32_t port, std::vector<struct OmxCodecBuffer> &buffers)
+    {
+        int fd = AshmemCreate("codec_watchdog_test", BUFFER_SIZE);
+        if (fd < 0) {
+            return false;
+        }
+        struct OmxCodecBuffer buffer = {};
+        buffer.size = sizeof(buffer);
+        buffer.bufferType = BUFFER_TYPE_AVSHARE_MEM_FD;
+        buffer.buffer = reinterpret_cast<uint8_t *>(static_cast<unsigned long>(fd));
+        buffer.bufferLen = sizeof(int);
+        buffer.allocLen = BUFFER_SIZE;
+        buffer.type = READ_WRITE_TYPE;
+        buffer.fenceFd = -1;
+        if (node_->UseBuffer(port, buffer) != OMX_ErrorNone) {
+            return false;
+        }
+        // the node owns the fd now
+        buffer.buffer = nullptr;
+        buffer.bufferLen = 0;
+        buffers.push_back(buffer);
+        return true;
+    }
+
+    int32_t QueueInput(uint32_t index, int64_t pts)
+    {
+        struct OmxCodecBuffer &buffer = inputs_[index % BUFFER_NUM];
+        buffer.offset = 0;
+        buffer.filledLen = FRAME_SIZE;
+        buffer.pts = pts;
+        buffer.flag = 0;
+        return node_->EmptyThisBuffer(buffer);
+    }
+
+    int32_t QueueOutput(uint32_t index)
+    {
+        struct OmxCodecBuffer &buffer = outputs_[index % BUFFER_NUM];
+        buffer.offset = 0;
+        buffer.filledLen = 0;
+        return node_->FillThisBuffer(buffer);
+    }
+
+    static bool WaitFor(const std::atomic<uint32_t> &count, uint32_t expect)
+    {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(WAIT_MS);
+        while (count < expect) {
+            if (std::chrono::steady_clock::now() > end) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    FakeComponent fake_;
+    std::shared_ptr<ComponentNode> node_;
+    std::vector<struct OmxCodecBuffer> inputs_;
+    std::vector<struct OmxCodecBuffer> outputs_;
+};
+
+HWTEST_F(CodecComponentWatchdogTest, CodecComponentWatchdogTest_001, TestSize.Level1)
+{
+    struct CodecHistogram histogram = {};
+    const uint64_t values[] = {0, 1, 2, 3, 4, UINT64_MAX};
+    for (uint64_t value : values) {
+        CodecHistogramAddSample(&histogram, value);
+    }
+    ASSERT_EQ(histogram.count, sizeof(values) / sizeof(values[0]));
+    ASSERT_EQ(histogram.max, UINT64_MAX);
+    ASSERT_EQ(histogram.buckets[0], 1u);
+    ASSERT_EQ(histogram.buckets[1], 1u);
+    ASSERT_EQ(histogram.buckets[2], 2u);
+    ASSERT_EQ(histogram.buckets[3], 1u);
+    ASSERT_EQ(histogram.buckets[CODEC_HISTOGRAM_BUCKET_NUM - 1], 1u);
+
+    // a buffer the component refused was never held
+    ComponentTelemetry telemetry;
+    telemetry.OnQueued(TELEMETRY_INPUT, INPUT_PORT, 1, 0);
+    telemetry.OnQueued(TELEMETRY_OUTPUT, OUTPUT_PORT, 2, 0);
+    telemetry.OnRejected(TELEMETRY_INPUT, 1);
+    struct ComponentTelemetryStats stats;
+    telemetry.GetStats(stats);
+    ASSERT_EQ(stats.ports[TELEMETRY_INPUT].queued, 0u);
+    ASSERT_EQ(stats.ports[TELEMETRY_INPUT].held, 0u);
+    ASSERT_EQ(stats.ports[TELEMETRY_OUTPUT].held, 1u);
+    ASSERT_TRUE(telemetry.GetHeld(TELEMETRY_INPUT).empty());
+    ASSERT_EQ(telemetry.GetHeld(TELEMETRY_OUTPUT).count(2), 1u);
+    telemetry.OnFreed(2);
+    telemetry.GetStats(stats);
+    ASSERT_EQ(stats.ports[TELEMETRY_OUTPUT].held, 0u);
+}
+
+HWTEST_F(CodecComponentWatchdogTest, CodecComponentWatchdogTest_002, TestSize.Level1)
+{
+    for (uint32_t i = 0; i < BUFFER_NUM; i++) {
+        ASSERT_EQ(QueueOutput(i), OMX_ErrorNone);
+    }
+    for (uint32_t i = 0; i < FRAME_NUM; i++) {
+        ASSERT_EQ(QueueInput(i, i * PTS_STEP), OMX_ErrorNone);
+        ASSERT_EQ(QueueOutput(i), OMX_ErrorNone);
+    }
+    ASSERT_EQ(g_emptyDone, FRAME_NUM);
+    ASSERT_EQ(g_fillDone, FRAME_NUM);
+
+    struct ComponentTelemetryStats stats;
+    node_->GetTelemetry(stats);
+    const struct PortTelemetry &input = stats.ports[TELEMETRY_INPUT];
+    const struct PortTelemetry &output = stats.ports[TELEMETRY_OUTPUT];
+    ASSERT_EQ(input.portIndex, INPUT_PORT);
+    ASSERT_EQ(input.queued, FRAME_NUM);
+    ASSERT_EQ(input.returned, FRAME_NUM);
+    ASSERT_EQ(input.held, 0u);
+    ASSERT_EQ(input.turnaroundUs.count, FRAME_NUM);
+    ASSERT_EQ(input.depth.count, FRAME_NUM);
+    ASSERT_EQ(output.portIndex, OUTPUT_PORT);
+    ASSERT_EQ(output.queued, FRAME_NUM + BUFFER_NUM);
+    ASSERT_EQ(output.returned, FRAME_NUM);
+    ASSERT_EQ(output.held, BUFFER_NUM);
+    ASSERT_EQ(output.maxHeld, BUFFER_NUM);
+    ASSERT_EQ(stats.latencyUs.count, FRAME_NUM);
+
+    // output buffers waiting for input are no stall
+    std::this_thread::sleep_for(std::chrono::milliseconds(TIMEOUT_MS * 2));
+    ASSERT_FALSE(node_->CheckStall(TIMEOUT_MS, false));
+    node_->GetTelemetry(stats);
+    ASSERT_EQ(stats.stalls, 0u);
+}
+
+HWTEST_F(CodecComponentWatchdogTest, CodecComponentWatchdogTest_003, TestSize.Level1)
+{
+    fake_.stall_ = true;
+    for (uint32_t i = 0; i < BUFFER_NUM; i++) {
+        ASSERT_EQ(QueueOutput(i), OMX_ErrorNone);
+        ASSERT_EQ(QueueInput(i, i * PTS_STEP), OMX_ErrorNone);
+    }
+    ASSERT_FALSE(node_->CheckStall(TIMEOUT_MS, false));
+    std::this_thread::sleep_for(std::chrono::milliseconds(TIMEOUT_MS * 2));
+    ASSERT_TRUE(node_->CheckStall(TIMEOUT_MS, false));
+    // reported once until the component moves on
+    ASSERT_FALSE(node_->CheckStall(TIMEOUT_MS, false));
+    struct ComponentTelemetryStats stats;
+    node_->GetTelemetry(stats);
+    ASSERT_EQ(stats.stalls, 1u);
+    ASSERT_EQ(stats.ports[TELEMETRY_INPUT].held, BUFFER_NUM);
+    ASSERT_EQ(stats.ports[TELEMETRY_OUTPUT].held, BUFFER_NUM);
+    ASSERT_EQ(fake_.flushes_, 0u);
+    ASSERT_EQ(g_emptyDone, 0u);
+
+    // the client flushes, the component recovers
+    ASSERT_EQ(node_->SendCommand(OMX_CommandFlush, OMX_ALL, nullptr, 0), OMX_ErrorNone);
+    ASSERT_EQ(g_emptyDone, BUFFER_NUM);
+    ASSERT_EQ(g_fillDone, BUFFER_NUM);
+    fake_.stall_ = false;
+    ASSERT_EQ(QueueOutput(0), OMX_ErrorNone);
+    ASSERT_EQ(QueueInput(0, BUFFER_NUM * PTS_STEP), OMX_ErrorNone);
+    node_->GetTelemetry(stats);
+    ASSERT_EQ(stats.ports[TELEMETRY_INPUT].held, 0u);
+    ASSERT_EQ(stats.latencyUs.count, 1u);
+}
+
+HWTEST_F(CodecComponentWatchdogTest, CodecComponentWatchdogTest_004, TestSize.Level1)
+{
+    ComponentWatchdog watchdog;
+    watchdog.SetConfig({INTERVAL_MS, TIMEOUT_MS, true});
+    watchdog.AddNode(&fake_.comp_, node_);
+
+    fake_.stall_ = true;
+    for (uint32_t i = 0; i < BUFFER_NUM; i++) {
+        ASSERT_EQ(QueueOutput(i), OMX_ErrorNone);
+        ASSERT_EQ(QueueInput(i, i * PTS_STEP), OMX_ErrorNone);
+    }
+    // the watchdog flushes the stalled component, the client gets its buffers back
+    ASSERT_TRUE(WaitFor(g_emptyDone, BUFFER_NUM));
+    ASSERT_TRUE(WaitFor(g_fillDone, BUFFER_NUM));
+    watchdog.RemoveNode(&fake_.comp_);
+    ASSERT_EQ(fake_.flushes_, 1u);
+    struct ComponentTelemetryStats stats;
+    node_->GetTelemetry(stats);
+    ASSERT_EQ(stats.stalls, 1u);
+    ASSERT_EQ(stats.ports[TELEMETRY_INPUT].held, 0u);
+    ASSERT_EQ(stats.ports[TELEMETRY_OUTPUT].held, 0u);
+
+    // nodes that are gone are dropped
+    {
+        auto callback = static_cast<struct CodecCallbackType *>(OsalMemCalloc(sizeof(struct CodecCallbackType)));
+        auto node = std::make_shared<ComponentNode>(callback, nullptr, 0);
+        watchdog.AddNode(node.get(), node);
+    }
+    ASSERT_EQ(watchdog.CheckNodes(), 0u);
+    watchdog.Stop();
+}
+}  // namespace
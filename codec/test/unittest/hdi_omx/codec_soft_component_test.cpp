@@ -0,0 +1,671 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <gtest/gtest.h>
+#include <hdf_base.h>
+#include <mutex>
+#include <securec.h>
+#include <vector>
+#include "codec_dynamic_control.h"
+#include "soft_codecs.h"
+#include "soft_component_mgr.h"
+
+using namespace std;
+using namespace testing::ext;
+using namespace OHOS::Codec::Omx;
+
+namespace {
+constexpr int32_t WAIT_TIMEOUT_MS = 1000;
+constexpr uint32_t IN_WIDTH = 8;
+constexpr uint32_t IN_HEIGHT = 8;
+constexpr uint32_t OUT_WIDTH = 4;
+constexpr uint32_t OUT_HEIGHT = 4;
+constexpr uint32_t PCM_INPUT_SIZE = 16384;
+constexpr uint32_t PCM_FILLED_LEN = 12000;
+constexpr uint32_t PCM_FRAME_SIZE = 4;  // 16 bit stereo
+constexpr uint32_t PCM_RATE = 48000;
+constexpr int64_t US_PER_SECOND = 1000000;
+constexpr uint32_t NEW_BITRATE = 2000000;
+constexpr uint32_t NEW_FRAMERATE = 15 << 16;  // Q16
+
+union ControlConfig {
+    OMX_VIDEO_CONFIG_BITRATETYPE bitrate;
+    OMX_CONFIG_FRAMERATETYPE framerate;
+    OMX_CONFIG_INTRAREFRESHVOPTYPE refresh;
+    CodecVideoFrameSize frameSize;
+};
+constexpr uint32_t RLE_LITERAL_MAX = 127;
+
+struct Event {
+    OMX_EVENTTYPE event;
+    uint32_t data1;
+    uint32_t data2;
+    size_t filled;  // the outputs filled before it
+};
+
+// the client side, records what the component calls back
+class SoftClient {
+public:
+    OMX_CALLBACKTYPE callbacks;
+
+    SoftClient()
+    {
+        callbacks.EventHandler = [](OMX_HANDLETYPE, OMX_PTR appData, OMX_EVENTTYPE event, OMX_U32 data1,
+                                    OMX_U32 data2, OMX_PTR) {
+            SoftClient *self = static_cast<SoftClient *>(appData);
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            self->events_.push_back({event, data1, data2, self->filled_.size()});
+            self->cond_.notify_all();
+            return OMX_ErrorNone;
+        };
+        callbacks.EmptyBufferDone = [](OMX_HANDLETYPE, OMX_PTR appData, OMX_BUFFERHEADERTYPE *buffer) {
+            SoftClient *self = static_cast<SoftClient *>(appData);
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            self->emptied_.push_back(buffer);
+            self->cond_.notify_all();
+            return OMX_ErrorNone;
+        };
+        callbacks.FillBufferDone = [](OMX_HANDLETYPE, OMX_PTR appData, OMX_BUFFERHEADERTYPE *buffer) {
+            SoftClient *self = static_cast<SoftClient *>(appData);
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            // the fields are copied, the buffer goes back to the component before they are checked
+            self->filled_.push_back(*buffer);
+            self->filledData_.emplace_back(buffer->pBuffer, buffer->pBuffer + buffer->nFilledLen);
+            self->cond_.notify_all();
+            return OMX_ErrorNone;
+        };
+    }
+
+    bool WaitEvent(OMX_EVENTTYPE event, uint32_t data1, uint32_t data2)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cond_.wait_for(lock, std::chrono::milliseconds(WAIT_TIMEOUT_MS), [&] {
+            for (auto it = events_.begin(); it != events_.end(); ++it) {
+                if ((it->event == event) && (it->data1 == data1) && (it->data2 == data2)) {
+                    events_.erase(it);
+                    return true;
+                }
+            }
+            return false;
+        });
+    }
+
+    bool WaitEvent(OMX_EVENTTYPE event, uint32_t data1, Event &found)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cond_.wait_for(lock, std::chrono::milliseconds(WAIT_TIMEOUT_MS), [&] {
+            for (auto it = events_.begin(); it != events_.end(); ++it) {
+                if ((it->event == event) && (it->data1 == data1)) {
+                    found = *it;
+                    events_.erase(it);
+                    return true;
+                }
+            }
+            return false;
+        });
+    }
+
+    bool HasEvent(OMX_EVENTTYPE event)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const Event &it : events_) {
+            if (it.event == event) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool WaitEmptied(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cond_.wait_for(lock, std::chrono::milliseconds(WAIT_TIMEOUT_MS),
+                              [&] { return emptied_.size() >= count; });
+    }
+
+    bool WaitFilled(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cond_.wait_for(lock, std::chrono::milliseconds(WAIT_TIMEOUT_MS),
+                              [&] { return filled_.size() >= count; });
+    }
+
+    OMX_BUFFERHEADERTYPE Filled(size_t index, std::vector<uint8_t> &data)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        data = filledData_[index];
+        return filled_[index];
+    }
+
+    size_t FilledCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return filled_.size();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<Event> events_;
+    std::vector<OMX_BUFFERHEADERTYPE *> emptied_;
+    std::vector<OMX_BUFFERHEADERTYPE> filled_;
+    std::vector<std::vector<uint8_t>> filledData_;
+};
+
+template <typename T>
+void InitParam(T &param, uint32_t portIndex)
+{
+    (void)memset_s(&param, sizeof(param), 0, sizeof(param));
+    param.nSize = sizeof(param);
+    param.nVersion.s.nVersionMajor = 1;
+    param.nPortIndex = portIndex;
+}
+
+// the PackBits decoder of the client
+std::vector<uint8_t> UnpackBits(const std::vector<uint8_t> &src)
+{
+    std::vector<uint8_t> dst;
+    size_t i = 0;
+    while (i < src.size()) {
+        uint8_t head = src[i++];
+        if (head <= RLE_LITERAL_MAX) {
+            dst.insert(dst.end(), src.begin() + i, src.begin() + i + head + 1);
+            i += head + 1;
+        } else {
+            dst.insert(dst.end(), 257 - head, src[i++]);  // 257: a run of 2 is coded as 255
+        }
+    }
+    return dst;
+}
+
+class CodecSoftComponentTest : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp() {}
+    void TearDown()
+    {
+        if (comp_ != nullptr) {
+            mgr_.DeleteComponentInstance(comp_);
+            comp_ = nullptr;
+        }
+    }
+
+    void Create(const char *name)
+    {
+        ASSERT_EQ(mgr_.CreateComponentInstance(name, &client_.callbacks, &client_, &comp_), OMX_ErrorNone);
+        ASSERT_TRUE(comp_ != nullptr);
+    }
+
+    OMX_PARAM_PORTDEFINITIONTYPE GetPortDef(uint32_t portIndex)
+    {
+        OMX_PARAM_PORTDEFINITIONTYPE def;
+        InitParam(def, portIndex);
+        EXPECT_EQ(comp_->GetParameter(comp_, OMX_IndexParamPortDefinition, &def), OMX_ErrorNone);
+        return def;
+    }
+
+    void AllocatePort(uint32_t portIndex)
+    {
+        OMX_PARAM_PORTDEFINITIONTYPE def = GetPortDef(portIndex);
+        for (uint32_t i = 0; i < def.nBufferCountActual; i++) {
+            OMX_BUFFERHEADERTYPE *header = nullptr;
+            ASSERT_EQ(comp_->AllocateBuffer(comp_, &header, portIndex, nullptr, def.nBufferSize), OMX_ErrorNone);
+            buffers_[portIndex].push_back(header);
+        }
+    }
+
+    void FreePort(uint32_t portIndex)
+    {
+        for (OMX_BUFFERHEADERTYPE *header : buffers_[portIndex]) {
+            ASSERT_EQ(comp_->FreeBuffer(comp_, portIndex, header), OMX_ErrorNone);
+        }
+        buffers_[portIndex].clear();
+    }
+
+    void SetState(OMX_STATETYPE state)
+    {
+        ASSERT_EQ(comp_->SendCommand(comp_, OMX_CommandStateSet, state, nullptr), OMX_ErrorNone);
+    }
+
+    void Start()
+    {
+        SetState(OMX_StateIdle);
+        AllocatePort(SOFT_PORT_INPUT);
+        AllocatePort(SOFT_PORT_OUTPUT);
+        ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandStateSet, OMX_StateIdle));
+        SetState(OMX_StateExecuting);
+        ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandStateSet, OMX_StateExecuting));
+    }
+
+    void Stop()
+    {
+        SetState(OMX_StateIdle);
+        ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandStateSet, OMX_StateIdle));
+        SetState(OMX_StateLoaded);
+        FreePort(SOFT_PORT_INPUT);
+        FreePort(SOFT_PORT_OUTPUT);
+        ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandStateSet, OMX_StateLoaded));
+    }
+
+    void FillAll()
+    {
+        for (OMX_BUFFERHEADERTYPE *header : buffers_[SOFT_PORT_OUTPUT]) {
+            ASSERT_EQ(comp_->FillThisBuffer(comp_, header), OMX_ErrorNone);
+        }
+    }
+
+    void SetVideoFormat(uint32_t portIndex, uint32_t width, uint32_t height, OMX_COLOR_FORMATTYPE format)
+    {
+        OMX_PARAM_PORTDEFINITIONTYPE def = GetPortDef(portIndex);
+        def.format.video.nFrameWidth = width;
+        def.format.video.nFrameHeight = height;
+        def.format.video.nStride = (OMX_S32)width;
+        def.format.video.nSliceHeight = height;
+        def.format.video.eColorFormat = format;
+        ASSERT_EQ(comp_->SetParameter(comp_, OMX_IndexParamPortDefinition, &def), OMX_ErrorNone);
+    }
+
+    void QueueFrame(OMX_BUFFERHEADERTYPE *in, uint32_t size, uint8_t seed)
+    {
+        // nothing repeats, the coded size follows the frame size
+        for (uint32_t i = 0; i < size; i++) {
+            in->pBuffer[i] = (uint8_t)(seed + i * 7);  // 7: no runs
+        }
+        in->nFilledLen = size;
+        in->nOffset = 0;
+        ASSERT_EQ(comp_->EmptyThisBuffer(comp_, in), OMX_ErrorNone);
+    }
+
+    OMX_ERRORTYPE SetControl(const CodecDynamicControl &control, uint32_t &index)
+    {
+        ControlConfig config;
+        uint32_t len = sizeof(config);
+        EXPECT_EQ(CodecPackDynamicControl(&control, &index, (int8_t *)&config, &len), HDF_SUCCESS);
+        return comp_->SetConfig(comp_, (OMX_INDEXTYPE)index, &config);
+    }
+
+    SoftComponentMgr mgr_;
+    SoftClient client_;
+    OMX_COMPONENTTYPE *comp_ = nullptr;
+    std::vector<OMX_BUFFERHEADERTYPE *> buffers_[SOFT_PORT_NUM];
+};
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_001, TestSize.Level1)
+{
+    const uint32_t componentCount = 3;
+    char name[OMX_MAX_STRINGNAME_SIZE];
+    uint32_t count = 0;
+    while (mgr_.EnumerateComponentsByIndex(count, name, sizeof(name)) == OMX_ErrorNone) {
+        std::vector<std::string> roles;
+        ASSERT_EQ(mgr_.GetRolesForComponent(name, &roles), OMX_ErrorNone);
+        ASSERT_EQ(roles.size(), 1u);
+        count++;
+    }
+    ASSERT_EQ(count, componentCount);
+    ASSERT_NE(mgr_.CreateComponentInstance("OMX.soft.none", &client_.callbacks, &client_, &comp_), OMX_ErrorNone);
+}
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_002, TestSize.Level1)
+{
+    Create(SOFT_RAW_DECODER_NAME);
+    OMX_STATETYPE state = OMX_StateInvalid;
+    ASSERT_EQ(comp_->GetState(comp_, &state), OMX_ErrorNone);
+    ASSERT_EQ(state, OMX_StateLoaded);
+    // buffers are only taken on the way to idle
+    OMX_BUFFERHEADERTYPE *header = nullptr;
+    OMX_PARAM_PORTDEFINITIONTYPE def = GetPortDef(SOFT_PORT_INPUT);
+    ASSERT_NE(comp_->AllocateBuffer(comp_, &header, SOFT_PORT_INPUT, nullptr, def.nBufferSize), OMX_ErrorNone);
+    SetState(OMX_StateExecuting);
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventError, (uint32_t)OMX_ErrorIncorrectStateTransition, 0));
+
+    SetState(OMX_StateIdle);
+    AllocatePort(SOFT_PORT_INPUT);
+    // idle is not reached before every port is populated
+    ASSERT_EQ(comp_->GetState(comp_, &state), OMX_ErrorNone);
+    ASSERT_EQ(state, OMX_StateLoaded);
+    AllocatePort(SOFT_PORT_OUTPUT);
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandStateSet, OMX_StateIdle));
+    SetState(OMX_StateExecuting);
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandStateSet, OMX_StateExecuting));
+    // the port definition is fixed while the buffers are in use
+    def = GetPortDef(SOFT_PORT_INPUT);
+    ASSERT_EQ(comp_->SetParameter(comp_, OMX_IndexParamPortDefinition, &def), OMX_ErrorIncorrectStateOperation);
+    Stop();
+}
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_003, TestSize.Level1)
+{
+    Create(SOFT_RAW_DECODER_NAME);
+    SetVideoFormat(SOFT_PORT_INPUT, IN_WIDTH, IN_HEIGHT, OMX_COLOR_FormatYUV420Planar);
+    SetVideoFormat(SOFT_PORT_OUTPUT, OUT_WIDTH, OUT_HEIGHT, OMX_COLOR_FormatYUV420SemiPlanar);
+    Start();
+    FillAll();
+    OMX_BUFFERHEADERTYPE *in = buffers_[SOFT_PORT_INPUT][0];
+    uint32_t lumaSize = IN_WIDTH * IN_HEIGHT;
+    uint32_t chromaSize = lumaSize / 4;  // 4: both directions are subsampled by 2
+    for (uint32_t i = 0; i < lumaSize; i++) {
+        in->pBuffer[i] = (uint8_t)i;
+    }
+    (void)memset_s(in->pBuffer + lumaSize, chromaSize, 'U', chromaSize);
+    (void)memset_s(in->pBuffer + lumaSize + chromaSize, chromaSize, 'V', chromaSize);
+    in->nFilledLen = lumaSize + chromaSize * 2;  // 2: the U and the V plane
+    in->nOffset = 0;
+    in->nTimeStamp = 1;
+    ASSERT_EQ(comp_->EmptyThisBuffer(comp_, in), OMX_ErrorNone);
+    ASSERT_TRUE(client_.WaitFilled(1));
+    ASSERT_TRUE(client_.WaitEmptied(1));
+
+    std::vector<uint8_t> data;
+    OMX_BUFFERHEADERTYPE out = client_.Filled(0, data);
+    ASSERT_EQ(out.nFilledLen, OUT_WIDTH * OUT_HEIGHT * 3 / 2);  // 3 / 2: YUV420
+    ASSERT_EQ(out.nTimeStamp, 1);
+    for (uint32_t y = 0; y < OUT_HEIGHT; y++) {
+        for (uint32_t x = 0; x < OUT_WIDTH; x++) {
+            ASSERT_EQ(data[y * OUT_WIDTH + x], (uint8_t)(y * 2 * IN_WIDTH + x * 2));  // 2: the scale
+        }
+    }
+    ASSERT_EQ(data[OUT_WIDTH * OUT_HEIGHT], 'U');
+    ASSERT_EQ(data[OUT_WIDTH * OUT_HEIGHT + 1], 'V');
+    Stop();
+}
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_004, TestSize.Level1)
+{
+    Create(SOFT_PCM_DECODER_NAME);
+    OMX_PARAM_PORTDEFINITIONTYPE def = GetPortDef(SOFT_PORT_INPUT);
+    def.nBufferSize = PCM_INPUT_SIZE;
+    ASSERT_EQ(comp_->SetParameter(comp_, OMX_IndexParamPortDefinition, &def), OMX_ErrorNone);
+    uint32_t outSize = GetPortDef(SOFT_PORT_OUTPUT).nBufferSize;
+    Start();
+    FillAll();
+    OMX_BUFFERHEADERTYPE *in = buffers_[SOFT_PORT_INPUT][0];
+    for (uint32_t i = 0; i < PCM_FILLED_LEN; i++) {
+        in->pBuffer[i] = (uint8_t)i;
+    }
+    in->nFilledLen = PCM_FILLED_LEN;
+    in->nOffset = 0;
+    in->nTimeStamp = 0;
+    ASSERT_EQ(comp_->EmptyThisBuffer(comp_, in), OMX_ErrorNone);
+    // an input larger than an output comes out in two
+    ASSERT_TRUE(client_.WaitFilled(2));
+    ASSERT_TRUE(client_.WaitEmptied(1));
+    std::vector<uint8_t> first;
+    std::vector<uint8_t> second;
+    OMX_BUFFERHEADERTYPE out0 = client_.Filled(0, first);
+    OMX_BUFFERHEADERTYPE out1 = client_.Filled(1, second);
+    ASSERT_EQ(out0.nFilledLen, outSize);
+    ASSERT_EQ(out1.nFilledLen, PCM_FILLED_LEN - outSize);
+    ASSERT_EQ(out0.nTimeStamp, 0);
+    ASSERT_EQ(out1.nTimeStamp, (OMX_TICKS)(outSize / PCM_FRAME_SIZE * US_PER_SECOND / PCM_RATE));
+    ASSERT_EQ(second[0], (uint8_t)outSize);
+    Stop();
+}
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_005, TestSize.Level1)
+{
+    const uint32_t size = 1000;
+    const uint32_t runStart = 100;
+    const uint32_t runEnd = 700;
+    std::vector<uint8_t> src(size);
+    for (uint32_t i = 0; i < size; i++) {
+        src[i] = ((i >= runStart) && (i < runEnd)) ? 0 : (uint8_t)(i * 7);  // 7: no runs around it
+    }
+    std::vector<uint8_t> coded(SoftRleEncoder::GetBound(size));
+    uint32_t codedSize = SoftRleEncoder::Encode(src.data(), size, coded.data(), coded.size());
+    ASSERT_GT(codedSize, 0u);
+    ASSERT_LT(codedSize, size);
+    coded.resize(codedSize);
+    ASSERT_EQ(UnpackBits(coded), src);
+    // nothing repeats, the bound is reached
+    for (uint32_t i = 0; i < size; i++) {
+        src[i] = (uint8_t)(i * 7);
+    }
+    coded.assign(SoftRleEncoder::GetBound(size), 0);
+    ASSERT_EQ(SoftRleEncoder::Encode(src.data(), size, coded.data(), size), 0u);
+    codedSize = SoftRleEncoder::Encode(src.data(), size, coded.data(), coded.size());
+    ASSERT_GT(codedSize, 0u);
+    coded.resize(codedSize);
+    ASSERT_EQ(UnpackBits(coded), src);
+}
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_006, TestSize.Level1)
+{
+    Create(SOFT_RLE_ENCODER_NAME);
+    SetVideoFormat(SOFT_PORT_INPUT, IN_WIDTH, IN_HEIGHT, OMX_COLOR_FormatYUV420SemiPlanar);
+    OMX_PARAM_PORTDEFINITIONTYPE output = GetPortDef(SOFT_PORT_OUTPUT);
+    ASSERT_EQ(output.format.video.nFrameWidth, IN_WIDTH);
+    ASSERT_EQ(output.format.video.eCompressionFormat, OMX_VIDEO_CodingSoftRle);
+    Start();
+    FillAll();
+    OMX_BUFFERHEADERTYPE *in = buffers_[SOFT_PORT_INPUT][0];
+    uint32_t frameSize = IN_WIDTH * IN_HEIGHT * 3 / 2;  // 3 / 2: YUV420
+    std::vector<uint8_t> frame(frameSize, 0x80);
+    frame[0] = 1;
+    (void)memcpy_s(in->pBuffer, in->nAllocLen, frame.data(), frameSize);
+    in->nFilledLen = frameSize;
+    in->nOffset = 0;
+    ASSERT_EQ(comp_->EmptyThisBuffer(comp_, in), OMX_ErrorNone);
+    ASSERT_TRUE(client_.WaitFilled(1));
+    std::vector<uint8_t> data;
+    OMX_BUFFERHEADERTYPE out = client_.Filled(0, data);
+    ASSERT_NE(out.nFlags & OMX_BUFFERFLAG_SYNCFRAME, 0u);
+    ASSERT_LT(out.nFilledLen, frameSize);
+    ASSERT_EQ(UnpackBits(data), frame);
+    Stop();
+}
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_007, TestSize.Level1)
+{
+    Create(SOFT_RAW_DECODER_NAME);
+    Start();
+    // no output is queued, the input waits until it is flushed
+    for (OMX_BUFFERHEADERTYPE *header : buffers_[SOFT_PORT_INPUT]) {
+        header->nFilledLen = header->nAllocLen;
+        header->nOffset = 0;
+        ASSERT_EQ(comp_->EmptyThisBuffer(comp_, header), OMX_ErrorNone);
+    }
+    ASSERT_EQ(comp_->SendCommand(comp_, OMX_CommandFlush, OMX_ALL, nullptr), OMX_ErrorNone);
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandFlush, SOFT_PORT_INPUT));
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandFlush, SOFT_PORT_OUTPUT));
+    ASSERT_TRUE(client_.WaitEmptied(buffers_[SOFT_PORT_INPUT].size()));
+    ASSERT_EQ(client_.FilledCount(), 0u);
+    Stop();
+}
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_008, TestSize.Level1)
+{
+    Create(SOFT_RAW_DECODER_NAME);
+    Start();
+    // a larger input while the output is in use
+    ASSERT_EQ(comp_->SendCommand(comp_, OMX_CommandPortDisable, SOFT_PORT_INPUT, nullptr), OMX_ErrorNone);
+    FreePort(SOFT_PORT_INPUT);
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandPortDisable, SOFT_PORT_INPUT));
+    uint32_t oldSize = GetPortDef(SOFT_PORT_OUTPUT).nBufferSize;
+    SetVideoFormat(SOFT_PORT_INPUT, IN_WIDTH * 40, IN_HEIGHT * 40, OMX_COLOR_FormatYUV420SemiPlanar);  // 40: larger
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventPortSettingsChanged, SOFT_PORT_OUTPUT, OMX_IndexParamPortDefinition));
+    ASSERT_GT(GetPortDef(SOFT_PORT_OUTPUT).nBufferSize, oldSize);
+
+    ASSERT_EQ(comp_->SendCommand(comp_, OMX_CommandPortDisable, SOFT_PORT_OUTPUT, nullptr), OMX_ErrorNone);
+    FreePort(SOFT_PORT_OUTPUT);
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandPortDisable, SOFT_PORT_OUTPUT));
+    ASSERT_EQ(comp_->SendCommand(comp_, OMX_CommandPortEnable, OMX_ALL, nullptr), OMX_ErrorNone);
+    AllocatePort(SOFT_PORT_INPUT);
+    AllocatePort(SOFT_PORT_OUTPUT);
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandPortEnable, SOFT_PORT_INPUT));
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventCmdComplete, OMX_CommandPortEnable, SOFT_PORT_OUTPUT));
+    // freeing a buffer of an enabled port outside a transition is an error
+    ASSERT_FALSE(client_.HasEvent(OMX_EventError));
+
+    FillAll();
+    OMX_BUFFERHEADERTYPE *in = buffers_[SOFT_PORT_INPUT][0];
+    in->nFilledLen = GetPortDef(SOFT_PORT_INPUT).nBufferSize;
+    in->nOffset = 0;
+    ASSERT_EQ(comp_->EmptyThisBuffer(comp_, in), OMX_ErrorNone);
+    ASSERT_TRUE(client_.WaitFilled(1));
+    std::vector<uint8_t> data;
+    ASSERT_EQ(client_.Filled(0, data).nFilledLen, GetPortDef(SOFT_PORT_OUTPUT).nBufferSize);
+    Stop();
+}
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_009, TestSize.Level1)
+{
+    Create(SOFT_RAW_DECODER_NAME);
+    Start();
+    FillAll();
+    OMX_BUFFERHEADERTYPE *in = buffers_[SOFT_PORT_INPUT][0];
+    in->nFilledLen = 0;
+    in->nOffset = 0;
+    in->nFlags = OMX_BUFFERFLAG_EOS;
+    ASSERT_EQ(comp_->EmptyThisBuffer(comp_, in), OMX_ErrorNone);
+    ASSERT_TRUE(client_.WaitEvent(OMX_EventBufferFlag, SOFT_PORT_OUTPUT, OMX_BUFFERFLAG_EOS));
+    std::vector<uint8_t> data;
+    OMX_BUFFERHEADERTYPE out = client_.Filled(0, data);
+    ASSERT_NE(out.nFlags & OMX_BUFFERFLAG_EOS, 0u);
+    ASSERT_EQ(out.nFilledLen, 0u);
+    Stop();
+}
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_010, TestSize.Level1)
+{
+    const uint32_t controlFrame = 2;
+    Create(SOFT_RLE_ENCODER_NAME);
+    SetVideoFormat(SOFT_PORT_INPUT, IN_WIDTH, IN_HEIGHT, OMX_COLOR_FormatYUV420SemiPlanar);
+    Start();
+    FillAll();
+    std::vector<OMX_BUFFERHEADERTYPE *> &inputs = buffers_[SOFT_PORT_INPUT];
+    uint32_t frameSize = IN_WIDTH * IN_HEIGHT * 3 / 2;  // 3 / 2: YUV420
+    for (uint32_t i = 0; i < controlFrame; i++) {
+        QueueFrame(inputs[i], frameSize, i);
+    }
+    // the controls take effect with the first frame queued after them, whatever the worker is doing meanwhile
+    CodecDynamicControl bitrate = {CODEC_CONTROL_BITRATE, {NEW_BITRATE}};
+    CodecDynamicControl framerate = {CODEC_CONTROL_FRAMERATE, {NEW_FRAMERATE}};
+    CodecDynamicControl idr = {CODEC_CONTROL_REQUEST_IDR, {0}};
+    uint32_t bitrateIndex = 0;
+    uint32_t framerateIndex = 0;
+    uint32_t idrIndex = 0;
+    ASSERT_EQ(SetControl(bitrate, bitrateIndex), OMX_ErrorNone);
+    ASSERT_EQ(SetControl(framerate, framerateIndex), OMX_ErrorNone);
+    QueueFrame(inputs[controlFrame], frameSize, controlFrame);
+    ASSERT_EQ(SetControl(idr, idrIndex), OMX_ErrorNone);
+    QueueFrame(inputs[controlFrame + 1], frameSize, controlFrame + 1);
+    ASSERT_TRUE(client_.WaitFilled(inputs.size()));
+
+    // one output a frame, the event comes before the output of its frame
+    Event event = {};
+    ASSERT_TRUE(client_.WaitEvent((OMX_EVENTTYPE)OMX_EventConfigApplied, bitrateIndex, event));
+    ASSERT_EQ(event.data2, controlFrame);
+    ASSERT_EQ(event.filled, controlFrame);
+    ASSERT_TRUE(client_.WaitEvent((OMX_EVENTTYPE)OMX_EventConfigApplied, framerateIndex, event));
+    ASSERT_EQ(event.data2, controlFrame);
+    ASSERT_EQ(event.filled, controlFrame);
+    ASSERT_TRUE(client_.WaitEvent((OMX_EVENTTYPE)OMX_EventConfigApplied, idrIndex, event));
+    ASSERT_EQ(event.data2, controlFrame + 1);
+    ASSERT_EQ(event.filled, controlFrame + 1);
+    OMX_VIDEO_CONFIG_BITRATETYPE bitrateConfig;
+    InitParam(bitrateConfig, SOFT_PORT_OUTPUT);
+    ASSERT_EQ(comp_->GetConfig(comp_, OMX_IndexConfigVideoBitrate, &bitrateConfig), OMX_ErrorNone);
+    ASSERT_EQ(bitrateConfig.nEncodeBitrate, NEW_BITRATE);
+    ASSERT_EQ(GetPortDef(SOFT_PORT_OUTPUT).format.video.xFramerate, NEW_FRAMERATE);
+
+    // a smaller frame fits in the buffers in use, a larger one needs the ports to be reconfigured
+    uint32_t index = 0;
+    CodecDynamicControl resolution = {CODEC_CONTROL_RESOLUTION, {0}};
+    resolution.value.size.width = IN_WIDTH * 2;  // 2: larger
+    resolution.value.size.height = IN_HEIGHT;
+    ASSERT_EQ(SetControl(resolution, index), OMX_ErrorUnsupportedSetting);
+    resolution.value.size.width = OUT_WIDTH;
+    resolution.value.size.height = OUT_HEIGHT;
+    ASSERT_EQ(SetControl(resolution, index), OMX_ErrorNone);
+    ASSERT_EQ(GetPortDef(SOFT_PORT_OUTPUT).format.video.nFrameWidth, IN_WIDTH);
+    FillAll();
+    uint32_t smallSize = OUT_WIDTH * OUT_HEIGHT * 3 / 2;  // 3 / 2: YUV420
+    QueueFrame(inputs[0], smallSize, 0);
+    ASSERT_TRUE(client_.WaitFilled(inputs.size() + 1));
+    ASSERT_TRUE(client_.WaitEvent((OMX_EVENTTYPE)OMX_EventConfigApplied, index, event));
+    ASSERT_EQ(event.data2, inputs.size());
+    ASSERT_EQ(event.filled, inputs.size());
+    OMX_PARAM_PORTDEFINITIONTYPE output = GetPortDef(SOFT_PORT_OUTPUT);
+    ASSERT_EQ(output.format.video.nFrameWidth, OUT_WIDTH);
+    ASSERT_EQ(output.format.video.nFrameHeight, OUT_HEIGHT);
+    std::vector<uint8_t> data;
+    client_.Filled(inputs.size(), data);
+    ASSERT_EQ(UnpackBits(data).size(), smallSize);
+    ASSERT_FALSE(client_.HasEvent(OMX_EventError));
+    Stop();
+}
+
+HWTEST_F(CodecSoftComponentTest, CodecSoftComponentTest_011, TestSize.Level1)
+{
+    const int32_t maxBitrate = 4000000;
+    const int32_t maxSize = 64;
+    const int32_t blockSize = 16;
+    const int32_t alignment = 2;
+    const int32_t maxBlocksPerSecond = 480;  // 30 fps of the smallest frame, one block
+    CodecCompCapability cap = {};
+    cap.type = VIDEO_ENCODER;
+    cap.bitRate = {1, maxBitrate};
+    VideoPortCap &video = cap.port.video;
+    video.minSize = {alignment, alignment};
+    video.maxSize = {maxSize, maxSize};
+    video.whAlignment = {alignment, alignment};
+    video.blockSize = {blockSize, blockSize};
+    video.blockCount = {1, (maxSize / blockSize) * (maxSize / blockSize)};
+    video.blocksPerSecond = {1, maxBlocksPerSecond};
+
+    CodecDynamicControl control = {CODEC_CONTROL_BITRATE, {(uint32_t)maxBitrate}};
+    ASSERT_EQ(CodecCheckDynamicControl(&cap, &control), HDF_SUCCESS);
+    control.value.bitRate = maxBitrate + 1;
+    ASSERT_EQ(CodecCheckDynamicControl(&cap, &control), HDF_ERR_INVALID_PARAM);
+
+    control.type = CODEC_CONTROL_FRAMERATE;
+    control.value.frameRate = (uint32_t)maxBlocksPerSecond << 16;  // 16: Q16
+    ASSERT_EQ(CodecCheckDynamicControl(&cap, &control), HDF_SUCCESS);
+    control.value.frameRate++;
+    ASSERT_EQ(CodecCheckDynamicControl(&cap, &control), HDF_ERR_INVALID_PARAM);
+    control.value.frameRate = 0;
+    ASSERT_EQ(CodecCheckDynamicControl(&cap, &control), HDF_ERR_INVALID_PARAM);
+
+    control.type = CODEC_CONTROL_RESOLUTION;
+    control.value.size.width = maxSize;
+    control.value.size.height = maxSize / 2;  // 2: smaller
+    ASSERT_EQ(CodecCheckDynamicControl(&cap, &control), HDF_SUCCESS);
+    control.value.size.width = maxSize - 1;
+    ASSERT_EQ(CodecCheckDynamicControl(&cap, &control), HDF_ERR_INVALID_PARAM);
+    control.value.size.width = maxSize + alignment;
+    ASSERT_EQ(CodecCheckDynamicControl(&cap, &control), HDF_ERR_INVALID_PARAM);
+
+    control.type = CODEC_CONTROL_REQUEST_IDR;
+    ASSERT_EQ(CodecCheckDynamicControl(&cap, &control), HDF_SUCCESS);
+    cap.type = VIDEO_DECODER;
+    ASSERT_EQ(CodecCheckDynamicControl(&cap, &control), HDF_ERR_INVALID_PARAM);
+
+    // the config is packed whole or not at all
+    ControlConfig config;
+    uint32_t index = 0;
+    uint32_t len = sizeof(OMX_CONFIG_INTRAREFRESHVOPTYPE) - 1;
+    ASSERT_EQ(CodecPackDynamicControl(&control, &index, (int8_t *)&config, &len), HDF_ERR_INVALID_PARAM);
+    len = sizeof(config);
+    ASSERT_EQ(CodecPackDynamicControl(&control, &index, (int8_t *)&config, &len), HDF_SUCCESS);
+    ASSERT_EQ(index, (uint32_t)OMX_IndexConfigVideoIntraVOPRefresh);
+    ASSERT_EQ(len, sizeof(OMX_CONFIG_INTRAREFRESHVOPTYPE));
+    ASSERT_EQ(config.refresh.nSize, len);
+    ASSERT_EQ(config.refresh.IntraRefreshVOP, OMX_TRUE);
+}
+}  // namespace
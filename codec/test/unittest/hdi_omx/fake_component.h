@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2022 Shenzhen Kaihong DID Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CODEC_FAKE_COMPONENT_H
+#define CODEC_FAKE_COMPONENT_H
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "component_node.h"
+
+namespace OHOS {
+namespace Codec {
+namespace Omx {
+// An OMX component for the node tests. By default it reads the input it is given and returns it at once, it may
+// refuse the buffers of the client. With pairBuffers_ set it pairs an input with an output buffer and returns
+// both, or holds everything while it stalls until it is flushed.
+class FakeComponent {
+public:
+    static constexpr uint32_t INPUT_PORT = 0;
+    static constexpr uint32_t OUTPUT_PORT = 1;
+    static constexpr uint32_t BUFFER_NUM = 2;
+    static constexpr uint32_t BUFFER_SIZE = 1024;
+    static constexpr uint32_t FRAME_SIZE = 16;
+
+    FakeComponent()
+        : refuseUseBuffer_(false), pairBuffers_(false), stall_(false), flushes_(0), appData_(nullptr),
+          lastInput_(nullptr)
+    {
+        comp_ = {};
+        comp_.pComponentPrivate = this;
+        comp_.SendCommand = SendCommand;
+        comp_.GetParameter = GetParameter;
+        comp_.GetState = GetState;
+        comp_.UseBuffer = UseBuffer;
+        comp_.AllocateBuffer = AllocateBuffer;
+        comp_.FreeBuffer = FreeBuffer;
+        comp_.EmptyThisBuffer = EmptyThisBuffer;
+        comp_.FillThisBuffer = FillThisBuffer;
+    }
+
+    OMX_COMPONENTTYPE comp_;
+    bool refuseUseBuffer_;
+    bool pairBuffers_;
+    std::atomic<bool> stall_;
+    std::atomic<uint32_t> flushes_;
+    void *appData_;  // the node, as a component gets it with its callbacks
+    OMX_U8 *lastInput_;
+    std::vector<uint8_t> lastFrame_;
+
+private:
+    static FakeComponent *Self(OMX_HANDLETYPE handle)
+    {
+        return static_cast<FakeComponent *>(static_cast<OMX_COMPONENTTYPE *>(handle)->pComponentPrivate);
+    }
+
+    static OMX_ERRORTYPE SendCommand(OMX_HANDLETYPE handle, OMX_COMMANDTYPE cmd, OMX_U32, OMX_PTR)
+    {
+        FakeComponent *self = Self(handle);
+        if (cmd != OMX_CommandFlush) {
+            return OMX_ErrorNotImplemented;
+        }
+        std::deque<OMX_BUFFERHEADERTYPE *> inputs;
+        std::deque<OMX_BUFFERHEADERTYPE *> outputs;
+        {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            inputs.swap(self->inputs_);
+            outputs.swap(self->outputs_);
+        }
+        for (auto input : inputs) {
+            ComponentNode::callbacks_.EmptyBufferDone(handle, self->appData_, input);
+        }
+        for (auto output : outputs) {
+            output->nFilledLen = 0;
+            ComponentNode::callbacks_.FillBufferDone(handle, self->appData_, output);
+        }
+        self->flushes_++;
+        return OMX_ErrorNone;
+    }
+
+    static OMX_ERRORTYPE GetParameter(OMX_HANDLETYPE, OMX_INDEXTYPE index, OMX_PTR param)
+    {
+        if (index != OMX_IndexParamPortDefinition) {
+            return OMX_ErrorUnsupportedIndex;
+        }
+        auto def = static_cast<OMX_PARAM_PORTDEFINITIONTYPE *>(param);
+        def->eDir = (def->nPortIndex == INPUT_PORT) ? OMX_DirInput : OMX_DirOutput;
+        def->nBufferCountActual = BUFFER_NUM;
+        def->nBufferCountMin = BUFFER_NUM;
+        def->nBufferSize = BUFFER_SIZE;
+        def->bEnabled = OMX_TRUE;
+        def->bPopulated = OMX_TRUE;
+        return OMX_ErrorNone;
+    }
+
+    static OMX_ERRORTYPE GetState(OMX_HANDLETYPE, OMX_STATETYPE *state)
+    {
+        *state = OMX_StateExecuting;
+        return OMX_ErrorNone;
+    }
+
+    static OMX_BUFFERHEADERTYPE *NewHeader(OMX_U32 port, OMX_U32 size)
+    {
+        auto hdr = static_cast<OMX_BUFFERHEADERTYPE *>(calloc(1, sizeof(OMX_BUFFERHEADERTYPE)));
+        if (hdr == nullptr) {
+            return nullptr;
+        }
+        hdr->nSize = sizeof(OMX_BUFFERHEADERTYPE);
+        hdr->nAllocLen = size;
+        hdr->nInputPortIndex = (port == INPUT_PORT) ? port : 0;
+        hdr->nOutputPortIndex = (port == OUTPUT_PORT) ? port : 0;
+        return hdr;
+    }
+
+    static OMX_ERRORTYPE UseBuffer(OMX_HANDLETYPE handle, OMX_BUFFERHEADERTYPE **header, OMX_U32 port, OMX_PTR,
+                                   OMX_U32 size, OMX_U8 *buffer)
+    {
+        if (Self(handle)->refuseUseBuffer_) {
+            return OMX_ErrorNotImplemented;
+        }
+        auto hdr = NewHeader(port, size);
+        if (hdr == nullptr) {
+            return OMX_ErrorInsufficientResources;
+        }
+        hdr->pBuffer = buffer;
+        *header = hdr;
+        return OMX_ErrorNone;
+    }
+
+    static OMX_ERRORTYPE AllocateBuffer(OMX_HANDLETYPE, OMX_BUFFERHEADERTYPE **header, OMX_U32 port, OMX_PTR,
+                                        OMX_U32 size)
+    {
+        auto hdr = NewHeader(port, size);
+        if (hdr == nullptr) {
+            return OMX_ErrorInsufficientResources;
+        }
+        hdr->pBuffer = static_cast<OMX_U8 *>(calloc(1, size));
+        if (hdr->pBuffer == nullptr) {
+            free(hdr);
+            return OMX_ErrorInsufficientResources;
+        }
+        hdr->pPlatformPrivate = hdr->pBuffer;  // marks the buffers the component owns
+        *header = hdr;
+        return OMX_ErrorNone;
+    }
+
+    static OMX_ERRORTYPE FreeBuffer(OMX_HANDLETYPE, OMX_U32, OMX_BUFFERHEADERTYPE *header)
+    {
+        free(header->pPlatformPrivate);
+        free(header);
+        return OMX_ErrorNone;
+    }
+
+    static OMX_ERRORTYPE EmptyThisBuffer(OMX_HANDLETYPE handle, OMX_BUFFERHEADERTYPE *header)
+    {
+        FakeComponent *self = Self(handle);
+        std::unique_lock<std::mutex> lock(self->mutex_);
+        self->lastInput_ = header->pBuffer;
+        self->lastFrame_.assign(header->pBuffer + header->nOffset,
+                                header->pBuffer + header->nOffset + header->nFilledLen);
+        // components may write to the buffers they are given
+        (void)memset(header->pBuffer, 0, header->nAllocLen);
+        if (!self->pairBuffers_) {
+            lock.unlock();
+            ComponentNode::callbacks_.EmptyBufferDone(handle, self->appData_, header);
+            return OMX_ErrorNone;
+        }
+        self->inputs_.push_back(header);
+        self->Process(handle, lock);
+        return OMX_ErrorNone;
+    }
+
+    static OMX_ERRORTYPE FillThisBuffer(OMX_HANDLETYPE handle, OMX_BUFFERHEADERTYPE *header)
+    {
+        FakeComponent *self = Self(handle);
+        std::unique_lock<std::mutex> lock(self->mutex_);
+        self->outputs_.push_back(header);
+        self->Process(handle, lock);
+        return OMX_ErrorNone;
+    }
+
+    void Process(OMX_HANDLETYPE handle, std::unique_lock<std::mutex> &lock)
+    {
+        if (stall_ || inputs_.empty() || outputs_.empty()) {
+            return;
+        }
+        OMX_BUFFERHEADERTYPE *input = inputs_.front();
+        OMX_BUFFERHEADERTYPE *output = outputs_.front();
+        inputs_.pop_front();
+        outputs_.pop_front();
+        lock.unlock();
+        output->nOffset = 0;
+        output->nFilledLen = FRAME_SIZE;
+        output->nTimeStamp = input->nTimeStamp;
+        ComponentNode::callbacks_.EmptyBufferDone(handle, appData_, input);
+        ComponentNode::callbacks_.FillBufferDone(handle, appData_, output);
+    }
+
+    std::mutex mutex_;
+    std::deque<OMX_BUFFERHEADERTYPE *> inputs_;
+    std::deque<OMX_BUFFERHEADERTYPE *> outputs_;
+};
+}  // namespace Omx
+}  // namespace Codec
+}  // namespace OHOS
+#endif  // CODEC_FAKE_COMPONENT_H
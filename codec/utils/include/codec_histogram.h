@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CODEC_HISTOGRAM_H
+#define CODEC_HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Log2 histogram shared by the buffer telemetry of the v1 codec service and of the OMX components.
+ * Bucket i counts the values of i significant bits, the last one everything above.
+ */
+#define CODEC_HISTOGRAM_BUCKET_NUM 24
+
+struct CodecHistogram {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[CODEC_HISTOGRAM_BUCKET_NUM];
+};
+
+void CodecHistogramAddSample(struct CodecHistogram *histogram, uint64_t value);
+uint64_t CodecHistogramAverage(const struct CodecHistogram *histogram);
+/* Formats the used buckets as "bits:count", a bucket of n bits holds the values below 2^n. */
+void CodecHistogramFormat(const struct CodecHistogram *histogram, char *text, size_t len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif // CODEC_HISTOGRAM_H
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec_histogram.h"
+#include <securec.h>
+
+void CodecHistogramAddSample(struct CodecHistogram *histogram, uint64_t value)
+{
+    if (histogram == NULL) {
+        return;
+    }
+    uint32_t bucket = 0;
+    for (uint64_t rest = value; rest != 0 && bucket < CODEC_HISTOGRAM_BUCKET_NUM - 1; rest >>= 1) {
+        bucket++;
+    }
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    histogram->sum += value;
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+uint64_t CodecHistogramAverage(const struct CodecHistogram *histogram)
+{
+    if (histogram == NULL || histogram->count == 0) {
+        return 0;
+    }
+    return histogram->sum / histogram->count;
+}
+
+void CodecHistogramFormat(const struct CodecHistogram *histogram, char *text, size_t len)
+{
+    if (text == NULL || len == 0) {
+        return;
+    }
+    text[0] = '\0';
+    if (histogram == NULL) {
+        return;
+    }
+    size_t used = 0;
+    for (uint32_t i = 0; i < CODEC_HISTOGRAM_BUCKET_NUM; i++) {
+        if (histogram->buckets[i] == 0) {
+            continue;
+        }
+        int ret = snprintf_s(text + used, len - used, len - used - 1, "%u:%llu ", i,
+                             (unsigned long long)histogram->buckets[i]);
+        if (ret < 0) {
+            break;
+        }
+        used += (size_t)ret;
+    }
+}
@@ -374,6 +374,13 @@ int32_t GrallocInitialize(GrallocFuncs **funcs)
     return DISPLAY_SUCCESS;
 }
 
+int32_t GrallocInitializeWithPool(GrallocFuncs **funcs, uint64_t poolMaxBytes)
+{
+    // the buffers are never recycled here
+    (void)poolMaxBytes;
+    return GrallocInitialize(funcs);
+}
+
 int32_t GrallocUninitialize(GrallocFuncs *funcs)
 {
     if (funcs == NULL) {
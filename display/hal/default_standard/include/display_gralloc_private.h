@@ -16,6 +16,7 @@
 #ifndef DISPLAY_GRALLOC_INTERNAL_H
 #define DISPLAY_GRALLOC_INTERNAL_H
 #include "display_type.h"
+#include "hdf_dlist.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,6 +27,10 @@ extern "C" {
 
 typedef struct {
     BufferHandle hdl;
+    struct DListHead entry;    /* in the live list of the pool while allocated, in its bucket while free */
+    struct DListHead lruEntry; /* in the lru list of the pool while free */
+    AllocInfo info;            /* the request the buffer was created for, the key of its bucket */
+    int64_t fdRefs;            /* references to the dma-buf once created, with no CPU mapping, -1 if unknown */
 } PriBufferHandle;
 
 #ifdef __cplusplus
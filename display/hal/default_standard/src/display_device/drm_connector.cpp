@@ -14,6 +14,7 @@
  */
 
 #include "drm_connector.h"
+#include <algorithm>
 #include <cinttypes>
 #include <securec.h>
 #include "drm_device.h"
@@ -35,6 +36,7 @@ DrmConnector::DrmConnector(drmModeConnector c, FdPtr &fd)
       mPhyHeight(c.mmHeight),
       mEncoderId(c.encoder_id),
       mConnectState(c.connection),
+      mWriteBack(c.connector_type == DRM_MODE_CONNECTOR_WRITEBACK),
       mDrmFdPtr(fd)
 {
     DISPLAY_LOGD("encoder_id %{public}d", mEncoderId);
@@ -97,9 +99,51 @@ int32_t DrmConnector::Init(DrmDevice &drmDevice)
     } else {
         DISPLAY_LOGW("can not get the brightness prop, can not set the brightness");
     }
+    if (mWriteBack) {
+        return InitWriteBack(drmDevice);
+    }
     return DISPLAY_SUCCESS;
 }
 
+int32_t DrmConnector::InitWriteBack(DrmDevice &drmDevice)
+{
+    DrmProperty prop;
+    int32_t ret = drmDevice.GetConnectorProperty(*this, PROP_WRITEBACK_FB_ID, prop);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("can not get the writeback fb prop"));
+    mPropWriteBackFbId = prop.propId;
+    ret = drmDevice.GetConnectorProperty(*this, PROP_WRITEBACK_OUT_FENCE_PTR, prop);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE,
+        DISPLAY_LOGE("can not get the writeback out fence prop"));
+    mPropWriteBackOutFenceId = prop.propId;
+    ret = drmDevice.GetConnectorProperty(*this, PROP_WRITEBACK_PIXEL_FORMATS, prop);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE,
+        DISPLAY_LOGE("can not get the writeback formats prop"));
+    // the formats are a blob of fourcc codes
+    drmModePropertyBlobPtr blob = drmModeGetPropertyBlob(mDrmFdPtr->GetFd(), static_cast<uint32_t>(prop.value));
+    DISPLAY_CHK_RETURN((blob == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("can not get the writeback formats blob"));
+    const uint32_t *formats = static_cast<const uint32_t *>(blob->data);
+    mWriteBackFormats.assign(formats, formats + blob->length / sizeof(uint32_t));
+    drmModeFreePropertyBlob(blob);
+    DISPLAY_LOGI("writeback connector %{public}d supports %{public}zu formats", mId, mWriteBackFormats.size());
+    return DISPLAY_SUCCESS;
+}
+
+bool DrmConnector::IsWriteBackFormatSupported(uint32_t drmFormat) const
+{
+    return std::find(mWriteBackFormats.begin(), mWriteBackFormats.end(), drmFormat) != mWriteBackFormats.end();
+}
+
+bool DrmConnector::IsPipePossible(IdMapPtr<DrmEncoder> &encoders, uint32_t pipe) const
+{
+    for (auto encoderId : mPossibleEncoders) {
+        auto iter = encoders.find(encoderId);
+        if ((iter != encoders.end()) && ((iter->second->GetPossibleCrtcs() & (1 << pipe)) != 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 int32_t DrmConnector::GetBrightness(uint32_t& level) {
     if (mPropBrightnessId == DRM_INVALID_ID) {
         DISPLAY_LOGE("the prop id of brightness is invalid");
@@ -220,6 +264,10 @@ int32_t DrmConnector::UpdateModes()
     drmModeConnectorPtr c = drmModeGetConnector(drmFd, mId);
     DISPLAY_CHK_RETURN((c == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("can not get connector"));
     mConnectState = c->connection;
+    mPhyWidth = c->mmWidth;
+    mPhyHeight = c->mmHeight;
+    mEncoderId = c->encoder_id;
+    mPossibleEncoders.assign(c->encoders, c->encoders + c->count_encoders);
     // init the modes
     InitModes(*c);
     drmModeFreeConnector(c);
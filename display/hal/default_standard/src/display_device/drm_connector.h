@@ -31,6 +31,9 @@ namespace DISPLAY {
 const std::string PROP_DPMS = "DPMS";
 const std::string PROP_CRTCID = "CRTC_ID";
 const std::string PROP_BRIGHTNESS = "brightness";
+const std::string PROP_WRITEBACK_FB_ID = "WRITEBACK_FB_ID";
+const std::string PROP_WRITEBACK_OUT_FENCE_PTR = "WRITEBACK_OUT_FENCE_PTR";
+const std::string PROP_WRITEBACK_PIXEL_FORMATS = "WRITEBACK_PIXEL_FORMATS";
 class DrmDevice;
 class DrmModeBlock;
 
@@ -90,7 +93,7 @@ public:
     }
     int32_t TryPickEncoder(IdMapPtr<DrmEncoder> &encoders, uint32_t encoderId, IdMapPtr<DrmCrtc> &crtcs,
         uint32_t &crtcId);
-    // update modes will reset the preference mode id and active mode id
+    // update modes will reset the preference mode id and active mode id, it also reads the connect state again
     int32_t UpdateModes();
     std::unique_ptr<DrmModeBlock> GetModeBlockFromId(int32_t id);
     int32_t GetModeFromId(int32_t id, DrmMode &mode);
@@ -104,11 +107,28 @@ public:
     int32_t GetBrightness(uint32_t& level);
     int32_t SetBrightness(uint32_t level);
 
+    // a writeback connector captures the output of its crtc into a framebuffer instead of driving a display
+    bool IsWriteBack() const
+    {
+        return mWriteBack;
+    }
+    uint32_t GetPropWriteBackFbId() const
+    {
+        return mPropWriteBackFbId;
+    }
+    uint32_t GetPropWriteBackOutFenceId() const
+    {
+        return mPropWriteBackOutFenceId;
+    }
+    bool IsWriteBackFormatSupported(uint32_t drmFormat) const;
+    bool IsPipePossible(IdMapPtr<DrmEncoder> &encoders, uint32_t pipe) const;
+
 private:
     static void ConvertTypeToName(uint32_t type, std::string &name);
     static void ConvertToHdiType(uint32_t type, InterfaceType &hdiType);
 
     void InitModes(drmModeConnector c);
+    int32_t InitWriteBack(DrmDevice &drmDevice);
     uint32_t mId;
     InterfaceType mType;
     uint32_t mPhyWidth;
@@ -126,6 +146,10 @@ private:
     uint32_t mPropCrtcId = DRM_INVALID_ID;
     uint32_t mPropBrightnessId = DRM_INVALID_ID;
     uint32_t mBrightnessLevel = 0;
+    bool mWriteBack = false;
+    uint32_t mPropWriteBackFbId = DRM_INVALID_ID;
+    uint32_t mPropWriteBackOutFenceId = DRM_INVALID_ID;
+    std::vector<uint32_t> mWriteBackFormats;
     std::unordered_map<int32_t, DrmMode> mModes;
     int32_t mPreferenceId = INVALID_MODE_ID;
 
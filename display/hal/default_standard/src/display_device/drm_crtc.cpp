@@ -55,6 +55,9 @@ void DrmCrtc::UnBindDisplay(uint32_t id)
     DISPLAY_LOGD();
     if (mDisplayId == id) {
         mDisplayId = INVALIDE_DISPLAY_ID;
+        // the next display sets its own mode, which has to go through a modeset even if it is the same
+        mActiveModeId = INVALID_MODE_ID;
+        mNeedModeSet = false;
     } else {
         DISPLAY_LOGE("can not unbind");
     }
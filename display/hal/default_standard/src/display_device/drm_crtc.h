@@ -68,6 +68,10 @@ public:
     {
         return mNeedModeSet;
     }
+    void ClearModeSet()
+    {
+        mNeedModeSet = false;
+    }
 
 private:
     uint32_t mId = 0;
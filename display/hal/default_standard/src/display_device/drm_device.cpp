@@ -102,22 +102,49 @@ int32_t DrmDevice::GetPlaneProperty(const DrmPlane &plane, const std::string &na
     return GetProperty(plane.GetId(), DRM_MODE_OBJECT_PLANE, name, prop);
 }
 
-int32_t DrmDevice::GetProperty(uint32_t objId, uint32_t objType, const std::string &name, DrmProperty &prop)
+int32_t DrmDevice::LoadProperties(uint32_t objId, uint32_t objType,
+    std::unordered_map<std::string, DrmProperty> &props)
 {
-    drmModeObjectPropertiesPtr props = drmModeObjectGetProperties(GetDrmFd(), objId, objType);
-    DISPLAY_CHK_RETURN((!props), DISPLAY_FAILURE, DISPLAY_LOGE("can not get properties"));
-    bool found = false;
-    for (uint32_t i = 0; i < props->count_props; i++) {
-        drmModePropertyPtr p = drmModeGetProperty(GetDrmFd(), props->props[i]);
-        if (strcmp(p->name, name.c_str()) == 0) {
-            found = true;
-            prop.propId = p->prop_id;
-            prop.value = props->prop_values[i];
+    drmModeObjectPropertiesPtr objProps = drmModeObjectGetProperties(GetDrmFd(), objId, objType);
+    DISPLAY_CHK_RETURN((!objProps), DISPLAY_FAILURE, DISPLAY_LOGE("can not get properties"));
+    for (uint32_t i = 0; i < objProps->count_props; i++) {
+        drmModePropertyPtr p = drmModeGetProperty(GetDrmFd(), objProps->props[i]);
+        if (p == nullptr) {
+            continue;
+        }
+        DrmProperty &prop = props[p->name];
+        prop.propId = p->prop_id;
+        prop.value = objProps->prop_values[i];
+        prop.flags = p->flags;
+        prop.values.assign(p->values, p->values + p->count_values);
+        prop.enums.clear();
+        for (int j = 0; j < p->count_enums; j++) {
+            prop.enums.push_back(p->enums[j].value);
         }
         drmModeFreeProperty(p);
     }
-    drmModeFreeObjectProperties(props);
-    return found ? DISPLAY_SUCCESS : DISPLAY_NOT_SUPPORT;
+    DISPLAY_LOGD("object %{public}d has %{public}d properties", objId, objProps->count_props);
+    drmModeFreeObjectProperties(objProps);
+    return DISPLAY_SUCCESS;
+}
+
+int32_t DrmDevice::GetProperty(uint32_t objId, uint32_t objType, const std::string &name, DrmProperty &prop)
+{
+    const uint32_t typeShift = 32;
+    uint64_t key = (static_cast<uint64_t>(objType) << typeShift) | objId;
+    auto iter = mPropertyCache.find(key);
+    if (iter == mPropertyCache.end()) {
+        std::unordered_map<std::string, DrmProperty> props;
+        int32_t ret = LoadProperties(objId, objType, props);
+        DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), ret, DISPLAY_LOGE("can not load the properties"));
+        iter = mPropertyCache.emplace(key, std::move(props)).first;
+    }
+    auto propIter = iter->second.find(name);
+    if (propIter == iter->second.end()) {
+        return DISPLAY_NOT_SUPPORT;
+    }
+    prop = propIter->second;
+    return DISPLAY_SUCCESS;
 }
 
 int32_t DrmDevice::Init()
@@ -128,6 +155,11 @@ int32_t DrmDevice::Init()
     ret = drmSetClientCap(GetDrmFd(), DRM_CLIENT_CAP_ATOMIC, 1);
     DISPLAY_CHK_RETURN((ret), DISPLAY_FAILURE,
         DISPLAY_LOGE("DRM_CLIENT_CAP_ATOMIC set failed %{public}s", strerror(errno)));
+    // the writeback connectors stay hidden without it, the captures then read back the client buffer
+    ret = drmSetClientCap(GetDrmFd(), DRM_CLIENT_CAP_WRITEBACK_CONNECTORS, 1);
+    if (ret != 0) {
+        DISPLAY_LOGI("DRM_CLIENT_CAP_WRITEBACK_CONNECTORS set failed %{public}s", strerror(errno));
+    }
 
     ret = drmSetMaster(GetDrmFd());
     DISPLAY_CHK_RETURN((ret), DISPLAY_FAILURE, DISPLAY_LOGE("can not set to master errno : %{public}d", errno));
@@ -141,6 +173,8 @@ int32_t DrmDevice::Init()
 void DrmDevice::DeInit()
 {
     mDisplays.clear();
+    mConnectorDisplays.clear();
+    mBoundWriteBacks.clear();
     mCrtcs.clear();
 }
 
@@ -183,21 +217,24 @@ void DrmDevice::FindAllEncoder(const drmModeResPtr &res)
     DISPLAY_LOGD("find encoder count %{public}zd", mEncoders.size());
 }
 
+std::shared_ptr<DrmConnector> DrmDevice::CreateConnector(uint32_t connectorId)
+{
+    drmModeConnectorPtr connector = drmModeGetConnector(GetDrmFd(), connectorId);
+    DISPLAY_CHK_RETURN((connector == nullptr), nullptr, DISPLAY_LOGE("can not get connector %{public}d", connectorId));
+    std::shared_ptr<DrmConnector> drmConnector = std::make_shared<DrmConnector>(*connector, mDrmFd);
+    int ret = drmConnector->Init(*this);
+    drmModeFreeConnector(connector);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), nullptr, DISPLAY_LOGE("connector %{public}d init failed", connectorId));
+    return drmConnector;
+}
+
 void DrmDevice::FindAllConnector(const drmModeResPtr &res)
 {
     DISPLAY_CHK_RETURN_NOT_VALUE((res == nullptr), DISPLAY_LOGE("the res is null"));
     mConnectors.clear();
-    int ret;
     for (int i = 0; i < res->count_connectors; i++) {
-        drmModeConnectorPtr connector = drmModeGetConnector(GetDrmFd(), res->connectors[i]);
-        if (!connector) {
-            DISPLAY_LOGE("can not get connector mode %{public}d", i);
-            continue;
-        }
-        std::shared_ptr<DrmConnector> drmConnector = std::make_shared<DrmConnector>(*connector, mDrmFd);
-        ret = drmConnector->Init(*this);
-        drmModeFreeConnector(connector);
-        if (ret != DISPLAY_SUCCESS) {
+        std::shared_ptr<DrmConnector> drmConnector = CreateConnector(res->connectors[i]);
+        if (drmConnector == nullptr) {
             continue;
         }
         int connectorId = drmConnector->GetId();
@@ -206,6 +243,33 @@ void DrmDevice::FindAllConnector(const drmModeResPtr &res)
     DISPLAY_LOGD("find connector count %{public}zd", mConnectors.size());
 }
 
+void DrmDevice::UpdateConnectors(const drmModeResPtr &res)
+{
+    DISPLAY_CHK_RETURN_NOT_VALUE((res == nullptr), DISPLAY_LOGE("the res is null"));
+    // the connectors of a display keep their objects, dynamic ones (e.g. DP MST) come and go
+    IdMapPtr<DrmConnector> connectors;
+    for (int i = 0; i < res->count_connectors; i++) {
+        uint32_t connectorId = res->connectors[i];
+        auto iter = mConnectors.find(connectorId);
+        if ((iter != mConnectors.end()) && (iter->second->UpdateModes() == DISPLAY_SUCCESS)) {
+            connectors.emplace(connectorId, iter->second);
+            continue;
+        }
+        std::shared_ptr<DrmConnector> drmConnector = CreateConnector(connectorId);
+        if (drmConnector != nullptr) {
+            connectors.emplace(connectorId, std::move(drmConnector));
+        }
+    }
+    for (const auto &connectorPair : mConnectors) {
+        if (connectors.find(connectorPair.first) == connectors.end()) {
+            const uint32_t typeShift = 32;
+            mPropertyCache.erase((static_cast<uint64_t>(DRM_MODE_OBJECT_CONNECTOR) << typeShift) | connectorPair.first);
+        }
+    }
+    mConnectors.swap(connectors);
+    DISPLAY_LOGD("update connector count %{public}zd", mConnectors.size());
+}
+
 void DrmDevice::FindAllPlane()
 {
     mPlanes.clear();
@@ -230,6 +294,7 @@ void DrmDevice::FindAllPlane()
         }
         mPlanes.emplace_back(std::move(drmPlane));
     }
+    drmModeFreePlaneResources(planeRes);
     DISPLAY_LOGD("find plane count %{public}zd", mPlanes.size());
 }
 
@@ -276,11 +341,64 @@ std::vector<std::shared_ptr<DrmPlane>> DrmDevice::GetDrmPlane(uint32_t pipe, uin
     return planes;
 }
 
+void DrmDevice::ReleaseDrmPlanes(uint32_t pipe)
+{
+    for (const auto &plane : mPlanes) {
+        if (!plane->IsIdle() && (plane->GetPipe() == pipe)) {
+            plane->UnBindPipe();
+        }
+    }
+}
+
+std::shared_ptr<DrmConnector> DrmDevice::AcquireWriteBackConnector(uint32_t pipe)
+{
+    for (const auto &connectorPair : mConnectors) {
+        auto &connector = connectorPair.second;
+        if (!connector->IsWriteBack() || (mBoundWriteBacks.count(connectorPair.first) != 0) ||
+            !connector->IsPipePossible(mEncoders, pipe)) {
+            continue;
+        }
+        mBoundWriteBacks.insert(connectorPair.first);
+        DISPLAY_LOGD("writeback connector %{public}d captures pipe %{public}d", connectorPair.first, pipe);
+        return connector;
+    }
+    return nullptr;
+}
+
+void DrmDevice::ReleaseWriteBackConnector(uint32_t connectorId)
+{
+    mBoundWriteBacks.erase(connectorId);
+}
+
+std::shared_ptr<HdiDisplay> DrmDevice::CreateDisplay(const std::shared_ptr<DrmConnector> &connector)
+{
+    uint32_t crtcId = 0;
+    int32_t ret = connector->PickIdleCrtcId(mEncoders, mCrtcs, crtcId);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), nullptr,
+        DISPLAY_LOGE("no idle crtc for connector %{public}d", connector->GetId()));
+    auto crtcIter = mCrtcs.find(crtcId);
+    DISPLAY_CHK_RETURN((crtcIter == mCrtcs.end()), nullptr,
+        DISPLAY_LOGE("can not find crtc for the id %{public}d", connector->GetId()));
+    auto crtc = crtcIter->second;
+    DISPLAY_LOGD("crtc %{public}p", crtc.get());
+    std::shared_ptr<HdiDisplay> display = std::make_shared<DrmDisplay>(connector, crtc, mInstance);
+    ret = display->Init();
+    if (ret != DISPLAY_SUCCESS) {
+        DISPLAY_LOGE("display of connector %{public}d init failed", connector->GetId());
+        // gives back the crtc and the planes taken so far
+        display->DeInit();
+        return nullptr;
+    }
+    mConnectorDisplays[connector->GetId()] = display->GetId();
+    return display;
+}
+
 
 std::unordered_map<uint32_t, std::shared_ptr<HdiDisplay>> DrmDevice::DiscoveryDisplay()
 {
-    int32_t ret;
     mDisplays.clear();
+    mConnectorDisplays.clear();
+    mPropertyCache.clear();
     drmModeResPtr res = drmModeGetResources(GetDrmFd());
     DISPLAY_CHK_RETURN((res == nullptr), mDisplays, DISPLAY_LOGE("can not get drm resource"));
     // discovery all drm resource
@@ -289,33 +407,66 @@ std::unordered_map<uint32_t, std::shared_ptr<HdiDisplay>> DrmDevice::DiscoveryDi
     FindAllConnector(res);
     FindAllPlane();
     DISPLAY_LOGD();
-    // travel all connector
+    drmModeFreeResources(res);
+    // travel all connector, the disconnected ones get a display once they are plugged
     for (auto &connectorPair : mConnectors) {
         auto connector = connectorPair.second;
-        uint32_t crtcId = 0;
-        ret = connector->PickIdleCrtcId(mEncoders, mCrtcs, crtcId);
-        if (ret != DISPLAY_SUCCESS) {
+        if (connector->IsWriteBack()) {
             continue;
         }
-        DISPLAY_LOGD();
-
-        auto crtcIter = mCrtcs.find(crtcId);
-        if (crtcIter == mCrtcs.end()) {
-            DISPLAY_LOGE("can not find crtc for the id %{public}d", connector->GetId());
+        if (!connector->IsConnected()) {
+            DISPLAY_LOGD("connector %{public}d is not connected", connector->GetId());
             continue;
         }
-        DISPLAY_LOGD();
-        auto crtc = crtcIter->second;
-        DISPLAY_LOGD("crtc %{public}p", crtc.get());
-        // create the display
-        std::shared_ptr<HdiDisplay> display = std::make_shared<DrmDisplay>(connector, crtc, mInstance);
-        DISPLAY_LOGD();
-        display->Init();
-        mDisplays.emplace(display->GetId(), std::move(display));
+        std::shared_ptr<HdiDisplay> display = CreateDisplay(connector);
+        if (display != nullptr) {
+            mDisplays.emplace(display->GetId(), std::move(display));
+        }
     }
     DISPLAY_LOGD("find display size %{public}zd", mDisplays.size());
     return mDisplays;
 }
+
+int32_t DrmDevice::UpdateDisplays(std::vector<uint32_t> &removed, IdMapPtr<HdiDisplay> &added)
+{
+    drmModeResPtr res = drmModeGetResources(GetDrmFd());
+    DISPLAY_CHK_RETURN((res == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("can not get drm resource"));
+    // the crtcs keep their bindings, the encoders and connectors are read again
+    FindAllEncoder(res);
+    UpdateConnectors(res);
+    drmModeFreeResources(res);
+    // tear down first, the crtcs and planes of the lost outputs may be all a new one can use
+    for (auto iter = mConnectorDisplays.begin(); iter != mConnectorDisplays.end();) {
+        auto connectorIter = mConnectors.find(iter->first);
+        if ((connectorIter != mConnectors.end()) && connectorIter->second->IsConnected()) {
+            iter++;
+            continue;
+        }
+        auto displayIter = mDisplays.find(iter->second);
+        if (displayIter != mDisplays.end()) {
+            DISPLAY_LOGI("connector %{public}d unplugged, remove display %{public}d", iter->first, iter->second);
+            displayIter->second->DeInit();
+            mDisplays.erase(displayIter);
+            removed.push_back(iter->second);
+        }
+        iter = mConnectorDisplays.erase(iter);
+    }
+    for (auto &connectorPair : mConnectors) {
+        auto connector = connectorPair.second;
+        if (connector->IsWriteBack() || !connector->IsConnected() ||
+            (mConnectorDisplays.find(connectorPair.first) != mConnectorDisplays.end())) {
+            continue;
+        }
+        std::shared_ptr<HdiDisplay> display = CreateDisplay(connector);
+        if (display != nullptr) {
+            DISPLAY_LOGI("connector %{public}d plugged, add display %{public}d", connectorPair.first,
+                display->GetId());
+            mDisplays.emplace(display->GetId(), display);
+            added.emplace(display->GetId(), std::move(display));
+        }
+    }
+    return DISPLAY_SUCCESS;
+}
 } // namespace OHOS
 } // namespace HDI
 } // namespace DISPLAY
@@ -16,7 +16,9 @@
 #ifndef DRM_DEVICE_H
 #define DRM_DEVICE_H
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
+#include <vector>
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include "drm_connector.h"
@@ -34,6 +36,9 @@ namespace DISPLAY {
 struct DrmProperty {
     uint32_t propId;
     uint64_t value;
+    uint32_t flags = 0;
+    std::vector<uint64_t> values; // range bounds of range properties
+    std::vector<uint64_t> enums;  // enum values, bit indexes for bitmask properties
 };
 
 class DrmDevice : public HdiDeviceInterface, std::enable_shared_from_this<DrmDevice> {
@@ -50,12 +55,18 @@ public:
     int32_t GetConnectorProperty(const DrmConnector &connector, const std::string &name, DrmProperty &prop);
     int32_t GetPlaneProperty(const DrmPlane &plane, const std::string &name, DrmProperty &prop);
 
+    // the property table of an object is read once, values are the ones seen at that time
     int32_t GetProperty(uint32_t objId, uint32_t objType, const std::string &name, DrmProperty &prop);
     std::shared_ptr<DrmEncoder> GetDrmEncoderFromId(uint32_t id);
     std::shared_ptr<DrmConnector> GetDrmConnectorFromId(uint32_t id);
     std::shared_ptr<DrmCrtc> GetDrmCrtcFromId(uint32_t id);
     void CreateCrtc(drmModeCrtcPtr c);
     virtual std::unordered_map<uint32_t, std::shared_ptr<HdiDisplay>> DiscoveryDisplay();
+    virtual int32_t UpdateDisplays(std::vector<uint32_t> &removed, IdMapPtr<HdiDisplay> &added);
+    void ReleaseDrmPlanes(uint32_t pipe);
+    // an idle writeback connector that can capture the pipe, null if there is none
+    std::shared_ptr<DrmConnector> AcquireWriteBackConnector(uint32_t pipe);
+    void ReleaseWriteBackConnector(uint32_t connectorId);
     virtual int32_t Init();
     virtual void DeInit();
 
@@ -65,13 +76,23 @@ private:
     void FindAllCrtc(const drmModeResPtr &drmRes);
     void FindAllEncoder(const drmModeResPtr &drmRes);
     void FindAllConnector(const drmModeResPtr &drmRes);
+    void UpdateConnectors(const drmModeResPtr &drmRes);
+    std::shared_ptr<DrmConnector> CreateConnector(uint32_t connectorId);
+    std::shared_ptr<HdiDisplay> CreateDisplay(const std::shared_ptr<DrmConnector> &connector);
     void FindAllPlane();
     int InitNetLink();
+    int32_t LoadProperties(uint32_t objId, uint32_t objType, std::unordered_map<std::string, DrmProperty> &props);
     IdMapPtr<HdiDisplay> mDisplays;
     IdMapPtr<DrmCrtc> mCrtcs;
     IdMapPtr<DrmEncoder> mEncoders;
     IdMapPtr<DrmConnector> mConnectors;
+    // the display id of each connector that drives one
+    std::unordered_map<uint32_t, uint32_t> mConnectorDisplays;
+    // the writeback connectors in use, each captures one display
+    std::unordered_set<uint32_t> mBoundWriteBacks;
     std::vector<std::shared_ptr<DrmPlane>> mPlanes;
+    // keyed by object type << 32 | object id
+    std::unordered_map<uint64_t, std::unordered_map<std::string, DrmProperty>> mPropertyCache;
 };
 } // namespace OHOS
 } // namespace HDI
@@ -19,6 +19,7 @@
 #include <memory>
 #include <xf86drm.h>
 #include <xf86drmMode.h>
+#include "display_gfx_soft.h"
 #include "display_gralloc.h"
 #include "display_common.h"
 #include "drm_device.h"
@@ -29,6 +30,27 @@
 namespace OHOS {
 namespace HDI {
 namespace DISPLAY {
+namespace {
+// tried after the requested format, the alpha of a captured frame means nothing anyway
+const PixelFormat WRITEBACK_FORMATS[] = {
+    PIXEL_FMT_BGRX_8888, PIXEL_FMT_BGRA_8888, PIXEL_FMT_RGBX_8888, PIXEL_FMT_RGBA_8888
+};
+
+bool PickWriteBackFormat(const DrmConnector &connector, PixelFormat &format)
+{
+    if (connector.IsWriteBackFormatSupported(DrmDevice::ConvertToDrmFormat(format))) {
+        return true;
+    }
+    for (auto candidate : WRITEBACK_FORMATS) {
+        if (connector.IsWriteBackFormatSupported(DrmDevice::ConvertToDrmFormat(candidate))) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+}
+
 DrmDisplay::DrmDisplay(std::shared_ptr<DrmConnector> connector, std::shared_ptr<DrmCrtc> crtc,
     std::shared_ptr<DrmDevice> drmDevice)
     : mDrmDevice(drmDevice), mConnector(connector), mCrtc(crtc)
@@ -36,6 +58,9 @@ DrmDisplay::DrmDisplay(std::shared_ptr<DrmConnector> connector, std::shared_ptr<
 
 DrmDisplay::~DrmDisplay()
 {
+    if (mWriteBack != nullptr) {
+        DestroyWriteBack();
+    }
     if (mCrtc != nullptr) {
         mCrtc->UnBindDisplay(GetId());
     }
@@ -70,9 +95,29 @@ int32_t DrmDisplay::Init()
     return DISPLAY_SUCCESS;
 }
 
+void DrmDisplay::DeInit()
+{
+    DISPLAY_LOGD("display %{public}d", GetId());
+    DISPLAY_CHK_RETURN_NOT_VALUE((mCrtc == nullptr), DISPLAY_LOGE("crtc is null"));
+    if (mWriteBack != nullptr) {
+        DestroyWriteBack();
+    }
+    if (mComposer != nullptr) {
+        static_cast<HdiDrmComposition *>(mComposer->GetPostCompostion())->Disable();
+    } else {
+        // the composition failed to init, it may hold planes already
+        mDrmDevice->ReleaseDrmPlanes(mCrtc->GetPipe());
+    }
+    DrmVsyncWorker::GetInstance().ClearPipe(mCrtc->GetPipe());
+    mCrtc->UnBindDisplay(GetId());
+    mCrtc = nullptr;
+}
+
 int32_t DrmDisplay::GetDisplayCapability(DisplayCapability *info)
 {
     mConnector->GetDisplayCap(*info);
+    // a display without a writeback connector is captured by reading back its client buffer
+    info->supportWriteBack = true;
     return DISPLAY_SUCCESS;
 }
 
@@ -196,7 +241,8 @@ int32_t DrmDisplay::PushFirstFrame()
     DrmMode mode;
     ret = mConnector->GetModeFromId(mCrtc->GetActiveModeId(), mode);
     DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE,
-        DISPLAY_LOGE("can not get the mode from id %{public}d", mCrtc->GetActiveModeId()));
+        DISPLAY_LOGE("can not get the mode from id %{public}d", mCrtc->GetActiveModeId());
+        GrallocUninitialize(grallocFucs));
     AllocInfo info = {
         .width = mode.GetModeInfoPtr()->hdisplay,
         .height = mode.GetModeInfoPtr()->vdisplay,
@@ -206,13 +252,17 @@ int32_t DrmDisplay::PushFirstFrame()
 
     BufferHandle *buffer = nullptr;
     ret = grallocFucs->AllocMem(&info, &buffer);
-    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("can not alloc memory"));
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("can not alloc memory");
+        GrallocUninitialize(grallocFucs));
     mClientLayer->SetLayerBuffer(buffer, -1);
 
     std::vector<HdiLayer *> layers;
     HdiDrmComposition *drmComp = static_cast<HdiDrmComposition *>(mComposer->GetPostCompostion());
     drmComp->SetLayers(layers, *mClientLayer);
     drmComp->Apply(true);
+    // the client layer holds its own fd of the buffer, a replugged display would leak one frame each time
+    grallocFucs->FreeMem(buffer);
+    GrallocUninitialize(grallocFucs);
     return DISPLAY_SUCCESS;
 }
 
@@ -236,14 +286,119 @@ int32_t DrmDisplay::RegDisplayVBlankCallback(VBlankCallback cb, void *data)
 {
     DISPLAY_LOGD("the VBlankCallback %{public}p ", cb);
     std::shared_ptr<VsyncCallBack> vsyncCb = std::make_shared<VsyncCallBack>(cb, data);
-    DrmVsyncWorker::GetInstance().ReqesterVBlankCb(vsyncCb);
+    DrmVsyncWorker::GetInstance().SetVsyncCallback(mCrtc->GetPipe(), vsyncCb);
     return DISPLAY_SUCCESS;
 }
 
 int32_t DrmDisplay::SetDisplayVsyncEnabled(bool enabled)
 {
     DISPLAY_LOGD("enable %{public}d", enabled);
-    DrmVsyncWorker::GetInstance().EnableVsync(enabled);
+    DrmVsyncWorker::GetInstance().EnableVsync(mCrtc->GetPipe(), enabled);
+    return DISPLAY_SUCCESS;
+}
+
+int32_t DrmDisplay::RegDisplayVBlankListener(VBlankCallback cb, void *data, int64_t phaseNs)
+{
+    return DrmVsyncWorker::GetInstance().AddListener(mCrtc->GetPipe(), cb, data, phaseNs);
+}
+
+int32_t DrmDisplay::UnregDisplayVBlankListener(VBlankCallback cb, void *data)
+{
+    return DrmVsyncWorker::GetInstance().RemoveListener(mCrtc->GetPipe(), cb, data);
+}
+
+int32_t DrmDisplay::GetDisplayNextVBlank(uint64_t *ns, uint64_t *period)
+{
+    DISPLAY_CHK_RETURN(((ns == nullptr) || (period == nullptr)), DISPLAY_NULL_PTR, DISPLAY_LOGE("in ptr is nullptr"));
+    return DrmVsyncWorker::GetInstance().GetNextVBlank(mCrtc->GetPipe(), *ns, *period);
+}
+
+HdiDrmComposition *DrmDisplay::GetDrmComposition()
+{
+    DISPLAY_CHK_RETURN((mComposer == nullptr), nullptr, DISPLAY_LOGE("the display is not initialized"));
+    return static_cast<HdiDrmComposition *>(mComposer->GetPostCompostion());
+}
+
+int32_t DrmDisplay::CreateWriteBack(uint32_t width, uint32_t height, int32_t *format)
+{
+    DISPLAY_CHK_RETURN((format == nullptr), DISPLAY_NULL_PTR, DISPLAY_LOGE("format is nullptr"));
+    DISPLAY_CHK_RETURN(((width == 0) || (height == 0)), DISPLAY_PARAM_ERR, DISPLAY_LOGE("the size is empty"));
+    DISPLAY_CHK_RETURN((mWriteBack != nullptr), DISPLAY_FAILURE,
+        DISPLAY_LOGE("display %{public}d has a writeback already", GetId()));
+    HdiDrmComposition *drmComp = GetDrmComposition();
+    DISPLAY_CHK_RETURN((drmComp == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("there is no drm composition"));
+    DrmMode mode;
+    int32_t ret = mConnector->GetModeFromId(mCrtc->GetActiveModeId(), mode);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE,
+        DISPLAY_LOGE("can not get the mode from id %{public}d", mCrtc->GetActiveModeId()));
+    PixelFormat pixelFormat = static_cast<PixelFormat>(*format);
+    std::shared_ptr<DrmConnector> connector;
+    // the writeback connector captures the crtc as it is, scaling is left to the read back
+    if ((width == mode.GetModeInfoPtr()->hdisplay) && (height == mode.GetModeInfoPtr()->vdisplay)) {
+        connector = mDrmDevice->AcquireWriteBackConnector(mCrtc->GetPipe());
+    }
+    if ((connector != nullptr) && !PickWriteBackFormat(*connector, pixelFormat)) {
+        DISPLAY_LOGI("writeback connector %{public}d can not write format %{public}d", connector->GetId(), *format);
+        mDrmDevice->ReleaseWriteBackConnector(connector->GetId());
+        connector = nullptr;
+    }
+    if ((connector == nullptr) && !SoftGfx::IsDstFormatSupported(pixelFormat)) {
+        pixelFormat = PIXEL_FMT_RGBA_8888;
+    }
+    auto writeBack = std::make_unique<HdiWriteBack>(width, height, pixelFormat);
+    ret = writeBack->Init();
+    if (ret == DISPLAY_SUCCESS) {
+        ret = drmComp->SetWriteBack(writeBack.get(), connector);
+    }
+    if (ret != DISPLAY_SUCCESS) {
+        DISPLAY_LOGE("can not create the writeback of display %{public}d", GetId());
+        drmComp->SetWriteBack(nullptr, nullptr);
+        if (connector != nullptr) {
+            mDrmDevice->ReleaseWriteBackConnector(connector->GetId());
+        }
+        return DISPLAY_FAILURE;
+    }
+    DISPLAY_LOGI("display %{public}d captures %{public}u x %{public}u format %{public}d by %{public}s", GetId(),
+        width, height, pixelFormat, (connector != nullptr) ? "writeback" : "read back");
+    mWriteBack = std::move(writeBack);
+    mWriteBackConnector = connector;
+    *format = pixelFormat;
+    return DISPLAY_SUCCESS;
+}
+
+int32_t DrmDisplay::DestroyWriteBack()
+{
+    DISPLAY_CHK_RETURN((mWriteBack == nullptr), DISPLAY_FAILURE,
+        DISPLAY_LOGE("display %{public}d has no writeback", GetId()));
+    int32_t ret = GetDrmComposition()->SetWriteBack(nullptr, nullptr);
+    // waits for the capture in flight
+    mWriteBack = nullptr;
+    if (mWriteBackConnector != nullptr) {
+        mDrmDevice->ReleaseWriteBackConnector(mWriteBackConnector->GetId());
+        mWriteBackConnector = nullptr;
+    }
+    return ret;
+}
+
+int32_t DrmDisplay::GetWriteBackFrame(BufferHandle *buffer, int32_t *fence)
+{
+    DISPLAY_CHK_RETURN(((buffer == nullptr) || (fence == nullptr)), DISPLAY_NULL_PTR,
+        DISPLAY_LOGE("in ptr is nullptr"));
+    DISPLAY_CHK_RETURN((mWriteBack == nullptr), DISPLAY_FAILURE,
+        DISPLAY_LOGE("display %{public}d has no writeback", GetId()));
+    if (!mWriteBack->HasFrame()) {
+        // nothing was committed since the writeback was created
+        int32_t ret = GetDrmComposition()->CaptureNow();
+        DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), ret, DISPLAY_LOGE("can not capture the frame shown"));
+    }
+    return mWriteBack->GetFrame(*buffer, *fence);
+}
+
+int32_t DrmDisplay::SetWriteBackCadence(uint32_t interval)
+{
+    DISPLAY_CHK_RETURN((mWriteBack == nullptr), DISPLAY_FAILURE,
+        DISPLAY_LOGE("display %{public}d has no writeback", GetId()));
+    mWriteBack->SetInterval(interval);
     return DISPLAY_SUCCESS;
 }
 
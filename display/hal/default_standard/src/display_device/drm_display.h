@@ -23,6 +23,7 @@
 #include "drm_plane.h"
 #include "hdi_composer.h"
 #include "hdi_drm_composition.h"
+#include "hdi_writeback.h"
 
 namespace OHOS {
 namespace HDI {
@@ -35,6 +36,7 @@ public:
     virtual ~DrmDisplay();
 
     int32_t Init() override;
+    void DeInit() override;
     int32_t GetDisplayCapability(DisplayCapability *info) override;
     int32_t GetDisplaySupportedModes(uint32_t *num, DisplayModeInfo *modes) override;
     int32_t GetDisplayMode(uint32_t *modeId) override;
@@ -48,6 +50,13 @@ public:
     virtual int32_t WaitForVBlank(uint64_t *ns) override;
     virtual bool IsConnected() override;
     virtual int32_t SetDisplayVsyncEnabled(bool enabled) override;
+    virtual int32_t RegDisplayVBlankListener(VBlankCallback cb, void *data, int64_t phaseNs) override;
+    virtual int32_t UnregDisplayVBlankListener(VBlankCallback cb, void *data) override;
+    virtual int32_t GetDisplayNextVBlank(uint64_t *ns, uint64_t *period) override;
+    int32_t CreateWriteBack(uint32_t width, uint32_t height, int32_t *format) override;
+    int32_t DestroyWriteBack() override;
+    int32_t GetWriteBackFrame(BufferHandle *buffer, int32_t *fence) override;
+    int32_t SetWriteBackCadence(uint32_t interval) override;
     HdiDrmComposition *GetDrmComposition();
 
 protected:
@@ -60,6 +69,9 @@ private:
     std::shared_ptr<DrmDevice> mDrmDevice;
     std::shared_ptr<DrmConnector> mConnector;
     std::shared_ptr<DrmCrtc> mCrtc;
+    std::unique_ptr<HdiWriteBack> mWriteBack;
+    // null when the captures are read back from the client buffer
+    std::shared_ptr<DrmConnector> mWriteBackConnector;
 };
 } // namespace OHOS
 } // namespace HDI
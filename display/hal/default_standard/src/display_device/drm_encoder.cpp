@@ -40,7 +40,7 @@ int32_t DrmEncoder::PickIdleCrtcId(IdMapPtr<DrmCrtc> &crtcs, uint32_t &crtcId)
     crtc = crtcIter->second;
     DISPLAY_CHK_RETURN((crtc == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("crtc is null"));
 
-    if (!crtc->CanBind()) {
+    if (!crtc->CanBind() || !((1 << crtc->GetPipe()) & mPossibleCrtcs)) {
         crtc = nullptr;
         for (const auto &posCrtcPair : crtcs) {
             auto &posCrts = posCrtcPair.second;
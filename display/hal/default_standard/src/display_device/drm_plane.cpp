@@ -54,8 +54,70 @@ int32_t DrmPlane::Init(DrmDevice &drmDevice)
             DISPLAY_LOGE("unknown type value %{public}" PRIu64 "", prop.value);
             return DISPLAY_FAILURE;
     }
+    InitOptionalProps(drmDevice);
     return DISPLAY_SUCCESS;
 }
+
+void DrmPlane::InitOptionalProps(DrmDevice &drmDevice)
+{
+    const std::pair<const std::string *, uint32_t *> rectProps[] = {
+        { &PROP_SRC_X, &mPropSrcX }, { &PROP_SRC_Y, &mPropSrcY }, { &PROP_SRC_W, &mPropSrcW },
+        { &PROP_SRC_H, &mPropSrcH }, { &PROP_CRTC_X, &mPropCrtcX }, { &PROP_CRTC_Y, &mPropCrtcY },
+        { &PROP_CRTC_W, &mPropCrtcW }, { &PROP_CRTC_H, &mPropCrtcH },
+    };
+    DrmProperty prop;
+    for (const auto &rectProp : rectProps) {
+        if (drmDevice.GetPlaneProperty(*this, *rectProp.first, prop) == DISPLAY_SUCCESS) {
+            *rectProp.second = prop.propId;
+        }
+    }
+
+    if (drmDevice.GetPlaneProperty(*this, PROP_ZPOS, prop) == DISPLAY_SUCCESS) {
+        mPropZposId = prop.propId;
+        mZposImmutable = (prop.flags & DRM_MODE_PROP_IMMUTABLE) != 0;
+        mZposMin = mZposImmutable ? prop.value : (prop.values.size() > 0 ? prop.values[0] : prop.value);
+        mZposMax = (!mZposImmutable && prop.values.size() > 1) ? prop.values[1] : mZposMin;
+    }
+    if (drmDevice.GetPlaneProperty(*this, PROP_ROTATION, prop) == DISPLAY_SUCCESS) {
+        mPropRotationId = prop.propId;
+        for (auto bit : prop.enums) {
+            mRotations |= (1U << bit);
+        }
+    }
+    if (drmDevice.GetPlaneProperty(*this, PROP_ALPHA, prop) == DISPLAY_SUCCESS) {
+        mPropAlphaId = prop.propId;
+    }
+    bool hasRect = (mPropSrcW != 0) && (mPropSrcH != 0) && (mPropCrtcW != 0) && (mPropCrtcH != 0);
+    mCanScale = hasRect && (mType == DRM_PLANE_TYPE_OVERLAY);
+    DISPLAY_LOGD("plane %{public}d zpos [%{public}" PRIu64 ", %{public}" PRIu64 "] immutable %{public}d "
+        "rotations 0x%{public}x alpha %{public}d", mId, mZposMin, mZposMax, mZposImmutable, mRotations,
+        mPropAlphaId != 0);
+}
+
+DrmPlaneCaps DrmPlane::GetCaps(uint64_t stackIndex) const
+{
+    DrmPlaneCaps caps;
+    caps.id = mId;
+    caps.type = mType;
+    caps.formats = mFormats;
+    caps.canScale = mCanScale;
+    caps.rotations = (mPropRotationId != 0) ? mRotations : DRM_MODE_ROTATE_0;
+    caps.hasAlpha = (mPropAlphaId != 0);
+    if (mPropZposId != 0) {
+        caps.zposImmutable = mZposImmutable;
+        caps.zposMin = mZposMin;
+        caps.zposMax = mZposMax;
+    } else {
+        caps.zposImmutable = true;
+        caps.zposMin = stackIndex;
+        caps.zposMax = stackIndex;
+    }
+    // without a rect the plane can only mirror the client buffer size, keep it out of direct scan-out
+    if ((mPropSrcW == 0) || (mPropCrtcW == 0)) {
+        caps.formats.clear();
+    }
+    return caps;
+}
 } // namespace OHOS
 } // namespace HDI
 } // namespace DISPLAY
@@ -20,6 +20,7 @@
 #include <vector>
 #include <xf86drm.h>
 #include <xf86drmMode.h>
+#include "drm_plane_allocator.h"
 
 namespace OHOS {
 namespace HDI {
@@ -28,6 +29,17 @@ const std::string PROP_FBID = "FB_ID";
 const std::string PROP_IN_FENCE_FD = "IN_FENCE_FD";
 const std::string PROP_CRTC_ID = "CRTC_ID";
 const std::string PROP_TYPE = "type";
+const std::string PROP_SRC_X = "SRC_X";
+const std::string PROP_SRC_Y = "SRC_Y";
+const std::string PROP_SRC_W = "SRC_W";
+const std::string PROP_SRC_H = "SRC_H";
+const std::string PROP_CRTC_X = "CRTC_X";
+const std::string PROP_CRTC_Y = "CRTC_Y";
+const std::string PROP_CRTC_W = "CRTC_W";
+const std::string PROP_CRTC_H = "CRTC_H";
+const std::string PROP_ZPOS = "zpos";
+const std::string PROP_ROTATION = "rotation";
+const std::string PROP_ALPHA = "alpha";
 class DrmDevice;
 
 class DrmPlane {
@@ -59,27 +71,115 @@ public:
     {
         return mType;
     }
+    uint32_t GetPropSrcX() const
+    {
+        return mPropSrcX;
+    }
+    uint32_t GetPropSrcY() const
+    {
+        return mPropSrcY;
+    }
+    uint32_t GetPropSrcW() const
+    {
+        return mPropSrcW;
+    }
+    uint32_t GetPropSrcH() const
+    {
+        return mPropSrcH;
+    }
+    uint32_t GetPropCrtcX() const
+    {
+        return mPropCrtcX;
+    }
+    uint32_t GetPropCrtcY() const
+    {
+        return mPropCrtcY;
+    }
+    uint32_t GetPropCrtcW() const
+    {
+        return mPropCrtcW;
+    }
+    uint32_t GetPropCrtcH() const
+    {
+        return mPropCrtcH;
+    }
+    uint32_t GetPropZposId() const
+    {
+        return mPropZposId;
+    }
+    uint32_t GetPropRotationId() const
+    {
+        return mPropRotationId;
+    }
+    uint32_t GetPropAlphaId() const
+    {
+        return mPropAlphaId;
+    }
+    bool IsZposMutable() const
+    {
+        return (mPropZposId != 0) && !mZposImmutable;
+    }
+    uint64_t GetZposMin() const
+    {
+        return mZposMin;
+    }
+    bool CanScale() const
+    {
+        return mCanScale;
+    }
+    // overlays are assumed to scale until an atomic test commit proves otherwise
+    void SetScalingUnsupported()
+    {
+        mCanScale = false;
+    }
+    // stackIndex is the implicit zpos used when the driver exposes no zpos property
+    DrmPlaneCaps GetCaps(uint64_t stackIndex) const;
+    // pipe 0 is a valid pipe, whether the plane is taken is tracked apart from it
     void BindToPipe(uint32_t pipe)
     {
         mPipe = pipe;
+        mIdle = false;
     }
     void UnBindPipe()
     {
         mPipe = 0;
+        mIdle = true;
     }
     bool IsIdle() const
     {
-        return (mPipe == 0);
+        return mIdle;
+    }
+    uint32_t GetPipe() const
+    {
+        return mPipe;
     }
 
 private:
+    void InitOptionalProps(DrmDevice &drmDevice);
     uint32_t mId = 0;
     uint32_t mPossibleCrtcs = 0;
     uint32_t mPropFbId = 0;
     uint32_t mPropFenceInId = 0;
     uint32_t mPropCrtcId = 0;
     uint32_t mPipe = 0;
+    bool mIdle = true;
     uint32_t mType = 0;
+    uint32_t mPropSrcX = 0;
+    uint32_t mPropSrcY = 0;
+    uint32_t mPropSrcW = 0;
+    uint32_t mPropSrcH = 0;
+    uint32_t mPropCrtcX = 0;
+    uint32_t mPropCrtcY = 0;
+    uint32_t mPropCrtcW = 0;
+    uint32_t mPropCrtcH = 0;
+    uint32_t mPropZposId = 0;
+    bool mZposImmutable = true;
+    uint64_t mZposMin = 0;
+    uint64_t mZposMax = 0;
+    uint32_t mPropRotationId = 0;
+    uint32_t mRotations = 0;
+    uint32_t mPropAlphaId = 0;
+    bool mCanScale = false;
     std::vector<uint32_t> mFormats;
 };
 } // namespace OHOS
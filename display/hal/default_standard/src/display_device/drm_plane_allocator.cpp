@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drm_plane_allocator.h"
+#include <algorithm>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+namespace OHOS {
+namespace HDI {
+namespace DISPLAY {
+uint32_t DrmPlaneAllocator::ConvertToDrmRotation(TransformType type)
+{
+    switch (type) {
+        case ROTATE_90:
+            return DRM_MODE_ROTATE_270;
+        case ROTATE_180:
+            return DRM_MODE_ROTATE_180;
+        case ROTATE_270:
+            return DRM_MODE_ROTATE_90;
+        default:
+            return DRM_MODE_ROTATE_0;
+    }
+}
+
+bool DrmPlaneAllocator::IsScaled(const DrmLayerRequest &layer)
+{
+    bool swap = (layer.rotation & (DRM_MODE_ROTATE_90 | DRM_MODE_ROTATE_270)) != 0;
+    int32_t srcW = swap ? layer.crop.h : layer.crop.w;
+    int32_t srcH = swap ? layer.crop.w : layer.crop.h;
+    return (srcW != layer.displayRect.w) || (srcH != layer.displayRect.h);
+}
+
+bool DrmPlaneAllocator::CanScanout(const DrmPlaneCaps &plane, const DrmLayerRequest &layer, uint32_t width,
+    uint32_t height)
+{
+    const IRect &rect = layer.displayRect;
+    if ((layer.format == 0) || (layer.crop.w <= 0) || (layer.crop.h <= 0) || (rect.w <= 0) || (rect.h <= 0)) {
+        return false;
+    }
+    // partially off screen layers need clipping the client composition already does
+    if ((rect.x < 0) || (rect.y < 0) || (static_cast<uint32_t>(rect.x + rect.w) > width) ||
+        (static_cast<uint32_t>(rect.y + rect.h) > height)) {
+        return false;
+    }
+    if ((plane.type == DRM_PLANE_TYPE_CURSOR) && !layer.cursor) {
+        return false;
+    }
+    if (std::find(plane.formats.begin(), plane.formats.end(), layer.format) == plane.formats.end()) {
+        return false;
+    }
+    if ((layer.rotation != DRM_MODE_ROTATE_0) && ((plane.rotations & layer.rotation) != layer.rotation)) {
+        return false;
+    }
+    if (!plane.canScale && IsScaled(layer)) {
+        return false;
+    }
+    if (layer.globalAlpha && !plane.hasAlpha) {
+        return false;
+    }
+    return true;
+}
+
+std::vector<DrmPlaneAssignment> DrmPlaneAllocator::Allocate(const DrmPlaneCaps &primary,
+    const std::vector<DrmPlaneCaps> &planes, const std::vector<DrmLayerRequest> &layers, uint32_t width,
+    uint32_t height)
+{
+    std::vector<DrmPlaneAssignment> result(layers.size());
+    std::vector<bool> used(planes.size(), false);
+    // planes must stay strictly between the primary plane and the plane of the layer above
+    uint64_t floor = primary.zposMin;
+    uint64_t ceiling = UINT64_MAX;
+
+    for (size_t i = layers.size(); i > 0; i--) {
+        const DrmLayerRequest &layer = layers[i - 1];
+        int32_t best = PLANE_NOT_ASSIGNED;
+        uint64_t bestZpos = 0;
+        for (size_t p = 0; p < planes.size(); p++) {
+            const DrmPlaneCaps &plane = planes[p];
+            if (used[p] || !CanScanout(plane, layer, width, height)) {
+                continue;
+            }
+            uint64_t low = std::max(plane.zposMin, floor + 1);
+            uint64_t high = plane.zposImmutable ? plane.zposMin : std::min(plane.zposMax, ceiling - 1);
+            if ((plane.zposImmutable && ((plane.zposMin <= floor) || (plane.zposMin >= ceiling))) || (low > high)) {
+                continue;
+            }
+            // take the highest feasible position to leave room for the layers below
+            if ((best == PLANE_NOT_ASSIGNED) || (high > bestZpos)) {
+                best = static_cast<int32_t>(p);
+                bestZpos = high;
+            }
+        }
+        if (best == PLANE_NOT_ASSIGNED) {
+            break;
+        }
+        used[best] = true;
+        result[i - 1].plane = best;
+        result[i - 1].zpos = bestZpos;
+        ceiling = bestZpos;
+    }
+    return result;
+}
+} // namespace OHOS
+} // namespace HDI
+} // namespace DISPLAY
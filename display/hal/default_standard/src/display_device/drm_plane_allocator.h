@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRM_PLANE_ALLOCATOR_H
+#define DRM_PLANE_ALLOCATOR_H
+#include <cinttypes>
+#include <vector>
+#include "display_type.h"
+
+namespace OHOS {
+namespace HDI {
+namespace DISPLAY {
+const int32_t PLANE_NOT_ASSIGNED = -1;
+
+// What a plane can scan out. Planes without a zpos property get an immutable zpos from their stacking order.
+struct DrmPlaneCaps {
+    uint32_t id = 0;
+    uint32_t type = 0;
+    std::vector<uint32_t> formats;
+    bool canScale = false;
+    uint32_t rotations = 0; // supported DRM_MODE_ROTATE_* | DRM_MODE_REFLECT_* bits
+    bool zposImmutable = true;
+    uint64_t zposMin = 0;
+    uint64_t zposMax = 0;
+    bool hasAlpha = false;
+};
+
+// What a layer needs from a plane, formats and rotation already in DRM terms.
+struct DrmLayerRequest {
+    uint32_t format = 0;
+    IRect crop = { 0 };
+    IRect displayRect = { 0 };
+    uint32_t rotation = 0;
+    bool globalAlpha = false;
+    bool cursor = false;
+};
+
+struct DrmPlaneAssignment {
+    int32_t plane = PLANE_NOT_ASSIGNED; // index into the candidate planes
+    uint64_t zpos = 0;
+};
+
+class DrmPlaneAllocator {
+public:
+    // HDI rotations are clockwise, DRM rotations counter clockwise
+    static uint32_t ConvertToDrmRotation(TransformType type);
+    static bool IsScaled(const DrmLayerRequest &layer);
+    static bool CanScanout(const DrmPlaneCaps &plane, const DrmLayerRequest &layer, uint32_t width, uint32_t height);
+
+    /*
+     * Overlay planes stack above the primary plane that scans out the client buffer, so only the top-most
+     * run of layers can bypass client composition: layers are walked from the top zorder down and the walk
+     * stops at the first layer no idle plane can take. Layers must be sorted by ascending zorder.
+     */
+    static std::vector<DrmPlaneAssignment> Allocate(const DrmPlaneCaps &primary, const std::vector<DrmPlaneCaps> &planes,
+        const std::vector<DrmLayerRequest> &layers, uint32_t width, uint32_t height);
+};
+} // namespace OHOS
+} // namespace HDI
+} // namespace DISPLAY
+
+#endif // DRM_PLANE_ALLOCATOR_H
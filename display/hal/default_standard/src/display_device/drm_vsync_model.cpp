@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drm_vsync_model.h"
+#include <cmath>
+
+namespace OHOS {
+namespace HDI {
+namespace DISPLAY {
+namespace {
+// about half a second at 60Hz, long enough to average the timestamp noise and short enough to follow drift
+const size_t MAX_SAMPLES = 32;
+const size_t MIN_SAMPLES = 3;
+}
+
+void DrmVsyncModel::AddSample(uint32_t sequence, uint64_t ns)
+{
+    if (!mSamples.empty()) {
+        int32_t step = static_cast<int32_t>(sequence - mSamples.back().sequence);
+        if (step == 0) {
+            // the flip event and the vblank event of the same frame
+            return;
+        }
+        if ((step < 0) || (ns <= mSamples.back().ns)) {
+            Reset();
+        }
+    }
+    if (IsValid()) {
+        // the vblank predicted within half a period of the sample must carry its sequence, otherwise the
+        // mode changed or the counter restarted
+        uint32_t predictedSeq = 0;
+        (void)PredictNext(ns - mPeriod / 2, predictedSeq); // 2: half of the period
+        if (predictedSeq != sequence) {
+            Reset();
+        }
+    }
+    mSamples.push_back({ sequence, ns });
+    if (mSamples.size() > MAX_SAMPLES) {
+        mSamples.pop_front();
+    }
+    Fit();
+}
+
+void DrmVsyncModel::Reset()
+{
+    mSamples.clear();
+    mPeriod = 0;
+    mBaseNs = 0;
+    mBaseSequence = 0;
+}
+
+bool DrmVsyncModel::IsValid() const
+{
+    return (mSamples.size() >= MIN_SAMPLES) && (mPeriod != 0);
+}
+
+uint64_t DrmVsyncModel::GetPeriod() const
+{
+    return IsValid() ? mPeriod : 0;
+}
+
+uint64_t DrmVsyncModel::PredictNext(uint64_t ns, uint32_t &sequence) const
+{
+    if (!IsValid()) {
+        return 0;
+    }
+    int64_t period = static_cast<int64_t>(mPeriod);
+    int64_t delta = static_cast<int64_t>(ns - mBaseNs);
+    // the number of periods from the base to the first vblank strictly after ns
+    int64_t count = (delta >= 0) ? (delta / period + 1) : -((-delta - 1) / period);
+    sequence = mBaseSequence + static_cast<uint32_t>(count);
+    return mBaseNs + static_cast<uint64_t>(count * period);
+}
+
+void DrmVsyncModel::Fit()
+{
+    if (mSamples.size() < MIN_SAMPLES) {
+        mPeriod = 0;
+        return;
+    }
+    // work relative to the newest sample, the doubles would lose the nanoseconds of absolute timestamps
+    const Sample &last = mSamples.back();
+    double meanX = 0;
+    double meanY = 0;
+    for (const auto &sample : mSamples) {
+        meanX += static_cast<int32_t>(sample.sequence - last.sequence);
+        meanY += static_cast<double>(static_cast<int64_t>(sample.ns - last.ns));
+    }
+    meanX /= mSamples.size();
+    meanY /= mSamples.size();
+    double sxx = 0;
+    double sxy = 0;
+    for (const auto &sample : mSamples) {
+        double x = static_cast<int32_t>(sample.sequence - last.sequence) - meanX;
+        double y = static_cast<double>(static_cast<int64_t>(sample.ns - last.ns)) - meanY;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double slope = sxy / sxx;
+    if (slope < 1) {
+        mPeriod = 0;
+        return;
+    }
+    mPeriod = static_cast<uint64_t>(std::llround(slope));
+    mBaseSequence = last.sequence;
+    mBaseNs = last.ns + static_cast<int64_t>(std::llround(meanY - slope * meanX));
+}
+} // namespace OHOS
+} // namespace HDI
+} // namespace DISPLAY
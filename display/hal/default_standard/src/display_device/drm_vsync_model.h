@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRM_VSYNC_MODEL_H
+#define DRM_VSYNC_MODEL_H
+#include <cinttypes>
+#include <deque>
+
+namespace OHOS {
+namespace HDI {
+namespace DISPLAY {
+/*
+ * Least squares fit of the vblank timestamps of one pipe against their sequence numbers over a sliding window.
+ * Fitting against the sequence instead of the arrival order keeps missed events from skewing the period.
+ */
+class DrmVsyncModel {
+public:
+    void AddSample(uint32_t sequence, uint64_t ns);
+    void Reset();
+    bool IsValid() const;
+    uint64_t GetPeriod() const;
+    // the first vblank after ns and its sequence, 0 while the model has too few samples
+    uint64_t PredictNext(uint64_t ns, uint32_t &sequence) const;
+
+private:
+    struct Sample {
+        uint32_t sequence;
+        uint64_t ns;
+    };
+    void Fit();
+    std::deque<Sample> mSamples;
+    uint64_t mPeriod = 0;
+    // the fitted timestamp of the newest sample
+    uint64_t mBaseNs = 0;
+    uint32_t mBaseSequence = 0;
+};
+} // namespace OHOS
+} // namespace HDI
+} // namespace DISPLAY
+
+#endif // DRM_VSYNC_MODEL_H
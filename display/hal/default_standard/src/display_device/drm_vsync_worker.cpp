@@ -14,13 +14,35 @@
  */
 
 #include "drm_vsync_worker.h"
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <ctime>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include "display_common.h"
 #include "drm_device.h"
 
 namespace OHOS {
 namespace HDI {
 namespace DISPLAY {
+namespace {
+constexpr uint64_t SEC_TO_NSEC = 1000 * 1000 * 1000;
+constexpr uint64_t USEC_TO_NSEC = 1000;
+
+uint32_t GetPipeType(uint32_t pipe)
+{
+    if (pipe == 0) {
+        return 0;
+    }
+    if (pipe == 1) {
+        return DRM_VBLANK_SECONDARY;
+    }
+    return (pipe << DRM_VBLANK_HIGH_CRTC_SHIFT) & DRM_VBLANK_HIGH_CRTC_MASK;
+}
+}
+
 DrmVsyncWorker::DrmVsyncWorker() {}
 
 int32_t DrmVsyncWorker::Init(int fd)
@@ -28,9 +50,11 @@ int32_t DrmVsyncWorker::Init(int fd)
     DISPLAY_CHK_RETURN((fd < 0), DISPLAY_FAILURE, DISPLAY_LOGE("the fd is invalid"));
     mDrmFd = fd;
     DISPLAY_LOGD("the drm fd is %{public}d", fd);
+    mWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    DISPLAY_CHK_RETURN((mWakeFd < 0), DISPLAY_FAILURE, DISPLAY_LOGE("can not create eventfd errno %{public}d", errno));
+    mRunning = true;
     mThread = std::make_unique<std::thread>([this]() { WorkThread(); });
     DISPLAY_CHK_RETURN((mThread == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("can not create thread"));
-    mRunning = true;
     return DISPLAY_SUCCESS;
 }
 
@@ -54,74 +78,296 @@ DrmVsyncWorker::~DrmVsyncWorker()
         std::lock_guard<std::mutex> lg(mMutex);
         mRunning = false;
     }
-    DISPLAY_LOGD();
-    mCondition.notify_one();
+    Wakeup();
     if (mThread != nullptr) {
         mThread->join();
     }
+    if (mWakeFd >= 0) {
+        close(mWakeFd);
+    }
+    DISPLAY_LOGD();
+}
+
+uint64_t DrmVsyncWorker::GetMonotonicNs()
+{
+    // the clock of the drm event timestamps
+    struct timespec ts = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * SEC_TO_NSEC + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void DrmVsyncWorker::Wakeup()
+{
+    uint64_t value = 1;
+    if ((mWakeFd >= 0) && (write(mWakeFd, &value, sizeof(value)) < 0) && (errno != EAGAIN)) {
+        DISPLAY_LOGE("wake the vsync worker failed errno %{public}d", errno);
+    }
+}
+
+void DrmVsyncWorker::SetVsyncCallback(uint32_t pipe, std::shared_ptr<VsyncCallBack> &cb)
+{
     DISPLAY_LOGD();
+    DISPLAY_CHK_RETURN_NOT_VALUE((cb == nullptr), DISPLAY_LOGE("the VBlankCallback is nullptr "));
+    std::lock_guard<std::mutex> lg(mMutex);
+    mPipes[pipe].callback = cb;
+}
+
+void DrmVsyncWorker::EnableVsync(uint32_t pipe, bool enable)
+{
+    DISPLAY_LOGD("pipe %{public}d enable %{public}d", pipe, enable);
+    {
+        std::lock_guard<std::mutex> lg(mMutex);
+        mPipes[pipe].enabled = enable;
+    }
+    Wakeup();
+}
+
+int32_t DrmVsyncWorker::AddListener(uint32_t pipe, VBlankCallback cb, void *data, int64_t phaseNs)
+{
+    DISPLAY_CHK_RETURN((cb == nullptr), DISPLAY_NULL_PTR, DISPLAY_LOGE("the VBlankCallback is nullptr"));
+    DISPLAY_LOGD("pipe %{public}d listener %{public}p phase %{public}" PRId64, pipe, cb, phaseNs);
+    {
+        std::lock_guard<std::mutex> lg(mMutex);
+        auto &listeners = mPipes[pipe].listeners;
+        auto iter = std::find_if(listeners.begin(), listeners.end(),
+            [cb, data](const VsyncListener &listener) { return (listener.cb == cb) && (listener.data == data); });
+        if (iter != listeners.end()) {
+            iter->phaseNs = phaseNs;
+        } else {
+            listeners.push_back({ cb, data, phaseNs, std::make_shared<VsyncCallBack>(cb, data) });
+        }
+    }
+    Wakeup();
+    return DISPLAY_SUCCESS;
+}
+
+int32_t DrmVsyncWorker::RemoveListener(uint32_t pipe, VBlankCallback cb, void *data)
+{
+    std::lock_guard<std::mutex> lg(mMutex);
+    auto &listeners = mPipes[pipe].listeners;
+    auto iter = std::find_if(listeners.begin(), listeners.end(),
+        [cb, data](const VsyncListener &listener) { return (listener.cb == cb) && (listener.data == data); });
+    DISPLAY_CHK_RETURN((iter == listeners.end()), DISPLAY_FAILURE, DISPLAY_LOGE("the listener is not registered"));
+    // a delivery already scheduled must not reach a listener that is gone
+    for (auto timer = mTimers.begin(); timer != mTimers.end();) {
+        timer = (timer->second.callback == iter->callback) ? mTimers.erase(timer) : std::next(timer);
+    }
+    listeners.erase(iter);
+    return DISPLAY_SUCCESS;
+}
+
+int32_t DrmVsyncWorker::GetNextVBlank(uint32_t pipe, uint64_t &ns, uint64_t &period)
+{
+    std::lock_guard<std::mutex> lg(mMutex);
+    auto iter = mPipes.find(pipe);
+    DISPLAY_CHK_RETURN(((iter == mPipes.end()) || !iter->second.model.IsValid()), DISPLAY_FAILURE,
+        DISPLAY_LOGE("no vblank timestamps of pipe %{public}d yet", pipe));
+    uint32_t sequence = 0;
+    ns = iter->second.model.PredictNext(GetMonotonicNs(), sequence);
+    period = iter->second.model.GetPeriod();
+    return DISPLAY_SUCCESS;
+}
+
+void DrmVsyncWorker::ClearPipe(uint32_t pipe)
+{
+    DISPLAY_LOGD("pipe %{public}d", pipe);
+    std::lock_guard<std::mutex> lg(mMutex);
+    auto iter = mPipes.find(pipe);
+    if (iter == mPipes.end()) {
+        return;
+    }
+    const auto &listeners = iter->second.listeners;
+    for (auto timer = mTimers.begin(); timer != mTimers.end();) {
+        bool ofPipe = std::any_of(listeners.begin(), listeners.end(),
+            [&timer](const VsyncListener &listener) { return listener.callback == timer->second.callback; });
+        timer = ofPipe ? mTimers.erase(timer) : std::next(timer);
+    }
+    // an event still queued in the kernel is consumed as usual
+    bool armed = iter->second.armed;
+    iter->second = VsyncPipe();
+    iter->second.armed = armed;
+}
+
+void DrmVsyncWorker::BeginFlip(uint32_t crtcId, uint32_t pipe)
+{
+    std::lock_guard<std::mutex> lg(mMutex);
+    mFlips[crtcId] = { pipe, true };
 }
 
-bool DrmVsyncWorker::WaitSignalAndCheckRuning()
+void DrmVsyncWorker::CancelFlip(uint32_t crtcId)
+{
+    {
+        std::lock_guard<std::mutex> lg(mMutex);
+        mFlips[crtcId].pending = false;
+    }
+    mFlipCondition.notify_all();
+}
+
+int32_t DrmVsyncWorker::WaitFlip(uint32_t crtcId, uint32_t timeoutMs)
 {
     std::unique_lock<std::mutex> ul(mMutex);
-    mCondition.wait(ul, [this]() { return (mEnable || !mRunning); });
-    return mRunning;
+    bool done = mFlipCondition.wait_for(ul, std::chrono::milliseconds(timeoutMs),
+        [this, crtcId]() { return !mFlips[crtcId].pending; });
+    if (!done) {
+        DISPLAY_LOGE("wait page flip of crtc %{public}d timeout", crtcId);
+        mFlips[crtcId].pending = false;
+        return DISPLAY_FAILURE;
+    }
+    return DISPLAY_SUCCESS;
+}
+
+void DrmVsyncWorker::OnVBlank(int fd, unsigned int sequence, unsigned int sec, unsigned int usec, void *data)
+{
+    (void)fd;
+    uint64_t ns = static_cast<uint64_t>(sec) * SEC_TO_NSEC + static_cast<uint64_t>(usec) * USEC_TO_NSEC;
+    GetInstance().HandleVBlank(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(data)), sequence, ns);
 }
 
+void DrmVsyncWorker::OnPageFlip(int fd, unsigned int sequence, unsigned int sec, unsigned int usec,
+    unsigned int crtcId, void *data)
+{
+    (void)fd;
+    (void)data;
+    uint64_t ns = static_cast<uint64_t>(sec) * SEC_TO_NSEC + static_cast<uint64_t>(usec) * USEC_TO_NSEC;
+    GetInstance().HandlePageFlip(crtcId, sequence, ns);
+}
 
-uint64_t DrmVsyncWorker::WaitNextVBlank(unsigned int &sq)
+void DrmVsyncWorker::ArmPipes()
 {
-    constexpr uint64_t SEC_TO_NSEC = 1000 * 1000 * 1000;
-    constexpr uint64_t USEC_TO_NSEC = 1000;
-    drmVBlank vblank = {
-        .request =
-            drmVBlankReq {
-                .type = DRM_VBLANK_RELATIVE,
-                .sequence = 1,
-                .signal = 0,
-            }
-    };
-    int ret = drmWaitVBlank(mDrmFd, &vblank);
-    DISPLAY_CHK_RETURN((ret < 0), 0,
-        DISPLAY_LOGE("wait vblank failed ret :　%{public}d　errno %{public}d", ret, errno));
-    sq = vblank.reply.sequence;
-    return (uint64_t)(vblank.reply.tval_sec * SEC_TO_NSEC + vblank.reply.tval_usec * USEC_TO_NSEC);
+    for (auto &[pipe, state] : mPipes) {
+        bool active = (state.enabled && (state.callback != nullptr)) || !state.listeners.empty();
+        if (!active || state.armed) {
+            continue;
+        }
+        drmVBlank vblank = {
+            .request =
+                drmVBlankReq {
+                    .type = static_cast<drmVBlankSeqType>(DRM_VBLANK_RELATIVE | DRM_VBLANK_EVENT | GetPipeType(pipe)),
+                    .sequence = 1,
+                    .signal = static_cast<unsigned long>(pipe),
+                }
+        };
+        int ret = drmWaitVBlank(mDrmFd, &vblank);
+        if (ret != 0) {
+            // retried on the next wakeup, the crtc may be off
+            DISPLAY_LOGE("queue vblank event of pipe %{public}d failed errno %{public}d", pipe, errno);
+            continue;
+        }
+        state.armed = true;
+    }
 }
 
+int64_t DrmVsyncWorker::GetTimeout()
+{
+    if (mTimers.empty()) {
+        return -1;
+    }
+    uint64_t now = GetMonotonicNs();
+    uint64_t fire = mTimers.begin()->first;
+    return (fire > now) ? static_cast<int64_t>(fire - now) : 0;
+}
 
-void DrmVsyncWorker::EnableVsync(bool enable)
+void DrmVsyncWorker::HandleVBlank(uint32_t pipe, unsigned int sequence, uint64_t ns)
 {
-    DISPLAY_LOGD();
+    std::vector<VsyncTimer> deliveries;
     {
         std::lock_guard<std::mutex> lg(mMutex);
-        mEnable = enable;
+        VsyncPipe &state = mPipes[pipe];
+        state.armed = false;
+        state.model.AddSample(sequence, ns);
+        if (state.enabled && (state.callback != nullptr)) {
+            deliveries.push_back({ sequence, ns, state.callback });
+        }
+        for (const auto &listener : state.listeners) {
+            if (listener.phaseNs == 0) {
+                deliveries.push_back({ sequence, ns, listener.callback });
+            } else if (listener.phaseNs > 0) {
+                mTimers.emplace(ns + listener.phaseNs, VsyncTimer { sequence, ns, listener.callback });
+            } else {
+                // woken ahead of the next vblank, reported with its predicted timestamp
+                uint32_t nextSeq = 0;
+                uint64_t next = state.model.PredictNext(ns, nextSeq);
+                if (next != 0) {
+                    uint64_t fire = next - static_cast<uint64_t>(-listener.phaseNs);
+                    mTimers.emplace(fire, VsyncTimer { nextSeq, next, listener.callback });
+                }
+            }
+        }
+    }
+    for (auto &delivery : deliveries) {
+        delivery.callback->Vsync(delivery.sequence, delivery.ns);
     }
-    mCondition.notify_one();
 }
 
-void DrmVsyncWorker::WorkThread()
+void DrmVsyncWorker::HandlePageFlip(uint32_t crtcId, unsigned int sequence, uint64_t ns)
 {
-    DISPLAY_LOGD();
-    unsigned int seq = 0;
-    uint64_t time = 0;
-    while (WaitSignalAndCheckRuning()) {
-        // wait the vblank
-        time = WaitNextVBlank(seq);
-        if (mCallBack != nullptr) {
-            mCallBack->Vsync(seq, time);
-        } else {
-            DISPLAY_LOGE("the callbac is nullptr");
+    DISPLAY_LOGD("flip done crtc %{public}d sequence %{public}d", crtcId, sequence);
+    {
+        std::lock_guard<std::mutex> lg(mMutex);
+        auto iter = mFlips.find(crtcId);
+        if (iter != mFlips.end()) {
+            iter->second.pending = false;
+            // a flip completes on a vblank, its timestamp is as good a sample as a vblank event
+            mPipes[iter->second.pipe].model.AddSample(sequence, ns);
         }
     }
+    mFlipCondition.notify_all();
 }
 
-void DrmVsyncWorker::ReqesterVBlankCb(std::shared_ptr<VsyncCallBack> &cb)
+void DrmVsyncWorker::FireTimers()
+{
+    std::vector<VsyncTimer> deliveries;
+    {
+        std::lock_guard<std::mutex> lg(mMutex);
+        uint64_t now = GetMonotonicNs();
+        while (!mTimers.empty() && (mTimers.begin()->first <= now)) {
+            deliveries.push_back(mTimers.begin()->second);
+            mTimers.erase(mTimers.begin());
+        }
+    }
+    for (auto &delivery : deliveries) {
+        delivery.callback->Vsync(delivery.sequence, delivery.ns);
+    }
+}
+
+void DrmVsyncWorker::WorkThread()
 {
     DISPLAY_LOGD();
-    DISPLAY_CHK_RETURN_NOT_VALUE((cb == nullptr), DISPLAY_LOGE("the VBlankCallback is nullptr "));
-    mCallBack = cb;
+    drmEventContext evctx = { 0 };
+    evctx.version = DRM_EVENT_CONTEXT_VERSION;
+    evctx.vblank_handler = OnVBlank;
+    evctx.page_flip_handler2 = OnPageFlip;
+    struct pollfd fds[] = { { mDrmFd, POLLIN, 0 }, { mWakeFd, POLLIN, 0 } };
+    while (true) {
+        int64_t timeout;
+        {
+            std::lock_guard<std::mutex> lg(mMutex);
+            if (!mRunning) {
+                break;
+            }
+            ArmPipes();
+            timeout = GetTimeout();
+        }
+        // poll only has milliseconds, too coarse for the phase of a listener
+        struct timespec ts = { static_cast<time_t>(timeout / SEC_TO_NSEC), static_cast<long>(timeout % SEC_TO_NSEC) };
+        int ret = ppoll(fds, sizeof(fds) / sizeof(fds[0]), (timeout < 0) ? nullptr : &ts, nullptr);
+        if ((ret < 0) && (errno != EINTR)) {
+            DISPLAY_LOGE("poll the drm fd failed errno %{public}d", errno);
+            break;
+        }
+        if ((ret > 0) && ((fds[1].revents & POLLIN) != 0)) {
+            uint64_t value = 0;
+            (void)read(mWakeFd, &value, sizeof(value));
+        }
+        if ((ret > 0) && ((fds[0].revents & POLLIN) != 0)) {
+            ret = drmHandleEvent(mDrmFd, &evctx);
+            if (ret != 0) {
+                DISPLAY_LOGE("handle drm event failed %{public}d", ret);
+            }
+        }
+        FireTimers();
+    }
 }
 } // namespace OHOS
 } // namespace HDI
-} // namespace DISPLAY
\ No newline at end of file
+} // namespace DISPLAY
@@ -15,16 +15,25 @@
 
 #ifndef DRM_VSYNC_WORKER_H
 #define DRM_VSYNC_WORKER_H
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 #include <condition_variable>
 #include "display_device.h"
+#include "drm_vsync_model.h"
 #include "hdi_device_common.h"
 
 namespace OHOS {
 namespace HDI {
 namespace DISPLAY {
+/*
+ * The only reader of the drm fd: queued vblank events and the page flip events of nonblocking commits are
+ * dispatched from one event loop. Each pipe keeps a timestamp model fed by both, listeners with a phase
+ * offset are woken from the model instead of the hardware.
+ */
 class DrmVsyncWorker {
 public:
     DrmVsyncWorker();
@@ -32,23 +41,72 @@ public:
     int32_t Init(int fd);
     static DrmVsyncWorker &GetInstance();
 
-    void EnableVsync(bool enable);
-    void WorkThread();
-    uint64_t WaitNextVBlank(unsigned int &sq);
-    bool WaitSignalAndCheckRuning();
-    void ReqesterVBlankCb(std::shared_ptr<VsyncCallBack> &cb);
+    // the callback of RegDisplayVBlankCallback, delivered on the vblank while vsync is enabled
+    void SetVsyncCallback(uint32_t pipe, std::shared_ptr<VsyncCallBack> &cb);
+    void EnableVsync(uint32_t pipe, bool enable);
+    // listeners are delivered until removed, a negative phase wakes them before the predicted vblank
+    int32_t AddListener(uint32_t pipe, VBlankCallback cb, void *data, int64_t phaseNs);
+    int32_t RemoveListener(uint32_t pipe, VBlankCallback cb, void *data);
+    int32_t GetNextVBlank(uint32_t pipe, uint64_t &ns, uint64_t &period);
+    // the display of the pipe is gone, its callbacks and timestamps must not reach the next one
+    void ClearPipe(uint32_t pipe);
+
+    // a commit asking for a flip event marks its crtc before it is queued and waits for the event before the next
+    void BeginFlip(uint32_t crtcId, uint32_t pipe);
+    void CancelFlip(uint32_t crtcId);
+    int32_t WaitFlip(uint32_t crtcId, uint32_t timeoutMs);
 
 private:
-    int mDrmFd = 0;
+    struct VsyncListener {
+        VBlankCallback cb;
+        void *data;
+        int64_t phaseNs;
+        std::shared_ptr<VsyncCallBack> callback;
+    };
+    struct VsyncPipe {
+        bool enabled = false;
+        // a vblank event is queued in the kernel
+        bool armed = false;
+        std::shared_ptr<VsyncCallBack> callback;
+        std::vector<VsyncListener> listeners;
+        DrmVsyncModel model;
+    };
+    struct VsyncTimer {
+        unsigned int sequence;
+        uint64_t ns;
+        std::shared_ptr<VsyncCallBack> callback;
+    };
+    struct FlipState {
+        uint32_t pipe;
+        bool pending;
+    };
+
+    static void OnVBlank(int fd, unsigned int sequence, unsigned int sec, unsigned int usec, void *data);
+    static void OnPageFlip(int fd, unsigned int sequence, unsigned int sec, unsigned int usec, unsigned int crtcId,
+        void *data);
+    static uint64_t GetMonotonicNs();
+    void WorkThread();
+    void Wakeup();
+    void ArmPipes();
+    int64_t GetTimeout();
+    void HandleVBlank(uint32_t pipe, unsigned int sequence, uint64_t ns);
+    void HandlePageFlip(uint32_t crtcId, unsigned int sequence, uint64_t ns);
+    void FireTimers();
+
+    int mDrmFd = -1;
+    // written to make the event loop pick up new listeners and timers
+    int mWakeFd = -1;
     std::unique_ptr<std::thread> mThread;
-    bool mEnable = false;
     std::mutex mMutex;
-    std::condition_variable mCondition;
-    std::shared_ptr<VsyncCallBack> mCallBack;
+    std::condition_variable mFlipCondition;
+    std::unordered_map<uint32_t, VsyncPipe> mPipes;
+    std::unordered_map<uint32_t, FlipState> mFlips;
+    // phase shifted deliveries ordered by their wakeup time
+    std::multimap<uint64_t, VsyncTimer> mTimers;
     bool mRunning = false;
 };
 } // namespace OHOS
 } // namespace HDI
 } // namespace DISPLAY
 
-#endif // DRM_VSYNC_WORKER_H
\ No newline at end of file
+#endif // DRM_VSYNC_WORKER_H
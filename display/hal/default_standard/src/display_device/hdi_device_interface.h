@@ -27,6 +27,12 @@ class HdiDeviceInterface {
 public:
     static std::vector<std::shared_ptr<HdiDeviceInterface>> DiscoveryDevice();
     virtual std::unordered_map<uint32_t, std::shared_ptr<HdiDisplay>> DiscoveryDisplay() = 0;
+    // re-probes the outputs after a hotplug, the displays of lost outputs are torn down before new ones are made
+    virtual int32_t UpdateDisplays(std::vector<uint32_t> &removed,
+        std::unordered_map<uint32_t, std::shared_ptr<HdiDisplay>> &added)
+    {
+        return DISPLAY_NOT_SUPPORT;
+    }
     virtual int32_t Init() = 0;
     virtual void DeInit() = 0;
     virtual ~HdiDeviceInterface() {}
@@ -28,6 +28,8 @@ namespace HDI {
 namespace DISPLAY {
 const uint32_t INVALIDE_DISPLAY_ID = 0xffffffff;
 const uint32_t DISPLAY_TYPE_DRM = (1 << 31);
+// the writeback endpoint of a display is addressed by the display id with this flag
+const uint32_t WRITEBACK_ID_FLAG = (1 << 30);
 
 class VsyncCallBack {
 public:
@@ -101,12 +103,40 @@ public:
     {
         return DISPLAY_NOT_SUPPORT;
     }
+    virtual int32_t RegDisplayVBlankListener(VBlankCallback cb, void *data, int64_t phaseNs)
+    {
+        return DISPLAY_NOT_SUPPORT;
+    }
+    virtual int32_t UnregDisplayVBlankListener(VBlankCallback cb, void *data)
+    {
+        return DISPLAY_NOT_SUPPORT;
+    }
+    virtual int32_t GetDisplayNextVBlank(uint64_t *ns, uint64_t *period)
+    {
+        return DISPLAY_NOT_SUPPORT;
+    }
     virtual int32_t GetDisplayReleaseFence(uint32_t *num, uint32_t *layers, int32_t *fences);
     virtual int32_t SetDisplayClientBuffer(const BufferHandle *buffer, int32_t fence);
     virtual int32_t WaitForVBlank(uint64_t *ns)
     {
         return DISPLAY_NOT_SUPPORT;
     }
+    virtual int32_t CreateWriteBack(uint32_t width, uint32_t height, int32_t *format)
+    {
+        return DISPLAY_NOT_SUPPORT;
+    }
+    virtual int32_t DestroyWriteBack()
+    {
+        return DISPLAY_NOT_SUPPORT;
+    }
+    virtual int32_t GetWriteBackFrame(BufferHandle *buffer, int32_t *fence)
+    {
+        return DISPLAY_NOT_SUPPORT;
+    }
+    virtual int32_t SetWriteBackCadence(uint32_t interval)
+    {
+        return DISPLAY_NOT_SUPPORT;
+    }
     HdiLayer *GetHdiLayer(uint32_t id);
 
 protected:
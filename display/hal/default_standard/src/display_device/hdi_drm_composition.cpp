@@ -14,12 +14,29 @@
  */
 
 #include "hdi_drm_composition.h"
+#include <algorithm>
 #include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include "drm_vsync_worker.h"
 #include "hdi_drm_layer.h"
 
 namespace OHOS {
 namespace HDI {
 namespace DISPLAY {
+namespace {
+// set HDI_DISPLAY_OVERLAY=0 to compose every layer into the client buffer
+const char *OVERLAY_ENV = "HDI_DISPLAY_OVERLAY";
+// each failed test commit drops a layer or the scaling of a plane, so a few rounds settle it
+const int MAX_PLANE_TEST_COUNT = 4;
+const uint32_t DRM_FIXED_POINT_SHIFT = 16;
+const uint64_t DRM_ALPHA_OPAQUE = 0xffff;
+const uint64_t HDI_ALPHA_OPAQUE = 0xff;
+// several refresh periods at the lowest rate we drive, a flip that takes longer is lost
+const uint32_t FLIP_TIMEOUT_MS = 100;
+}
+
 HdiDrmComposition::HdiDrmComposition(std::shared_ptr<DrmConnector> connector, std::shared_ptr<DrmCrtc> crtc,
     std::shared_ptr<DrmDevice> drmDevice)
     : mDrmDevice(drmDevice), mConnector(connector), mCrtc(crtc)
@@ -27,6 +44,29 @@ HdiDrmComposition::HdiDrmComposition(std::shared_ptr<DrmConnector> connector, st
     DISPLAY_LOGD();
 }
 
+HdiDrmComposition::~HdiDrmComposition()
+{
+    // the queued flip still scans out the buffers of the last commit
+    WaitPendingFlip();
+}
+
+int32_t HdiDrmComposition::WaitPendingFlip()
+{
+    // the flip event is read by the vsync worker, which owns the event queue of the drm fd
+    return DrmVsyncWorker::GetInstance().WaitFlip(mCrtc->GetId(), FLIP_TIMEOUT_MS);
+}
+
+drmModeAtomicReqPtr HdiDrmComposition::ResetAtomicReq()
+{
+    if (mAtomicReq == nullptr) {
+        drmModeAtomicReqPtr req = drmModeAtomicAlloc();
+        DISPLAY_CHK_RETURN((req == nullptr), nullptr, DISPLAY_LOGE("drm atomic alloc failed errno %{public}d", errno));
+        mAtomicReq = std::make_unique<AtomicReqPtr>(req);
+    }
+    drmModeAtomicSetCursor(mAtomicReq->Get(), 0);
+    return mAtomicReq->Get();
+}
+
 int32_t HdiDrmComposition::Init()
 {
     DISPLAY_LOGD();
@@ -38,22 +78,211 @@ int32_t HdiDrmComposition::Init()
     DISPLAY_CHK_RETURN((mDrmDevice == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("drmDevice is null"));
     mPrimPlanes = mDrmDevice->GetDrmPlane(mCrtc->GetPipe(), DRM_PLANE_TYPE_PRIMARY);
     mOverlayPlanes = mDrmDevice->GetDrmPlane(mCrtc->GetPipe(), DRM_PLANE_TYPE_OVERLAY);
+    mCursorPlanes = mDrmDevice->GetDrmPlane(mCrtc->GetPipe(), DRM_PLANE_TYPE_CURSOR);
     DISPLAY_CHK_RETURN((mPrimPlanes.size() == 0), DISPLAY_FAILURE, DISPLAY_LOGE("has no primary plane"));
     mPlanes.insert(mPlanes.end(), mPrimPlanes.begin(), mPrimPlanes.end());
     mPlanes.insert(mPlanes.end(), mOverlayPlanes.begin(), mOverlayPlanes.end());
+    mPlanes.insert(mPlanes.end(), mCursorPlanes.begin(), mCursorPlanes.end());
+    const char *overlay = getenv(OVERLAY_ENV);
+    mOverlayEnabled = (overlay == nullptr) || (strcmp(overlay, "0") != 0);
+    DISPLAY_LOGD("overlay planes %{public}zd cursor planes %{public}zd enabled %{public}d", mOverlayPlanes.size(),
+        mCursorPlanes.size(), mOverlayEnabled);
+    // started ahead of the first flip, which also keeps the worker alive until the compositions are gone
+    DrmVsyncWorker::GetInstance();
+    return DISPLAY_SUCCESS;
+}
+
+bool HdiDrmComposition::GetLayerRequest(HdiLayer &layer, DrmLayerRequest &request)
+{
+    HdiLayerBuffer *buffer = layer.GetCurrentBuffer();
+    if (buffer == nullptr) {
+        return false;
+    }
+    // the planes only blend with premultiplied source over, anything else is left to the client composition
+    BlendType blend = layer.GetLayerBlenType();
+    if ((blend != BLEND_NONE) && (blend != BLEND_SRC) && (blend != BLEND_SRCOVER)) {
+        return false;
+    }
+    const LayerAlpha &alpha = layer.GetAlpha();
+    request.format = DrmDevice::ConvertToDrmFormat(static_cast<PixelFormat>(buffer->GetFormat()));
+    request.crop = layer.GetLayerCrop();
+    if ((request.crop.w <= 0) || (request.crop.h <= 0)) {
+        request.crop = { 0, 0, buffer->GetWight(), buffer->GetHeight() };
+    }
+    request.displayRect = layer.GetLayerDisplayRect();
+    request.rotation = DrmPlaneAllocator::ConvertToDrmRotation(layer.GetTransFormType());
+    request.globalAlpha = alpha.enGlobalAlpha && (alpha.gAlpha != HDI_ALPHA_OPAQUE);
+    request.cursor = (layer.GetCompositionType() == COMPOSITION_CURSOR);
+    return true;
+}
+
+int32_t HdiDrmComposition::AssignPlanes(std::vector<HdiLayer *> &layers, uint32_t width, uint32_t height)
+{
+    std::vector<std::shared_ptr<DrmPlane>> candidates;
+    candidates.insert(candidates.end(), mOverlayPlanes.begin(), mOverlayPlanes.end());
+    candidates.insert(candidates.end(), mCursorPlanes.begin(), mCursorPlanes.end());
+    // the test commit imports the layer buffers, which may retire the ones the pending flip still shows
+    WaitPendingFlip();
+    std::vector<DrmLayerRequest> requests(layers.size());
+    for (uint32_t i = 0; i < layers.size(); i++) {
+        if (!GetLayerRequest(*layers[i], requests[i])) {
+            requests[i].format = 0;
+        }
+    }
+
+    for (int count = 0; count < MAX_PLANE_TEST_COUNT; count++) {
+        DrmPlaneCaps primary = mPrimPlanes[0]->GetCaps(0);
+        std::vector<DrmPlaneCaps> caps;
+        for (uint32_t i = 0; i < candidates.size(); i++) {
+            caps.push_back(candidates[i]->GetCaps(i + 1));
+        }
+        std::vector<DrmPlaneAssignment> assignments =
+            DrmPlaneAllocator::Allocate(primary, caps, requests, width, height);
+        mCompLayers.resize(1);
+        mCompPlanes.resize(1);
+        mCompZpos.resize(1);
+        int32_t lowest = PLANE_NOT_ASSIGNED;
+        for (uint32_t i = 0; i < assignments.size(); i++) {
+            if (assignments[i].plane == PLANE_NOT_ASSIGNED) {
+                continue;
+            }
+            lowest = (lowest == PLANE_NOT_ASSIGNED) ? static_cast<int32_t>(i) : lowest;
+            mCompLayers.push_back(layers[i]);
+            mCompPlanes.push_back(candidates[assignments[i].plane]);
+            mCompZpos.push_back(assignments[i].zpos);
+        }
+        if (lowest == PLANE_NOT_ASSIGNED) {
+            return DISPLAY_SUCCESS;
+        }
+        if (TestCommit() == DISPLAY_SUCCESS) {
+            for (uint32_t i = 1; i < mCompLayers.size(); i++) {
+                HdiLayer *layer = mCompLayers[i];
+                CompositionType type = layer->GetCompositionType();
+                layer->SetDirectScanout(true);
+                layer->SetDeviceSelect(((type == COMPOSITION_VIDEO) || (type == COMPOSITION_CURSOR)) ? type :
+                    COMPOSITION_DEVICE);
+            }
+            DISPLAY_LOGD("%{public}zd layers scan out directly", mCompLayers.size() - 1);
+            return DISPLAY_SUCCESS;
+        }
+        // the kernel does not say why, scaling is the usual suspect, otherwise give up the lowest layer
+        auto &plane = candidates[assignments[lowest].plane];
+        if (DrmPlaneAllocator::IsScaled(requests[lowest]) && plane->CanScale()) {
+            DISPLAY_LOGD("plane %{public}d can not scale", plane->GetId());
+            plane->SetScalingUnsupported();
+        } else {
+            requests[lowest].format = 0;
+        }
+    }
+    mCompLayers.resize(1);
+    mCompPlanes.resize(1);
+    mCompZpos.resize(1);
     return DISPLAY_SUCCESS;
 }
 
 int32_t HdiDrmComposition::SetLayers(std::vector<HdiLayer *> &layers, HdiLayer &clientLayer)
 {
-    // now we do not surpport present direct
-    DISPLAY_LOGD();
+    DISPLAY_LOGD("layers size %{public}zd", layers.size());
     mCompLayers.clear();
+    mCompPlanes.clear();
+    mCompZpos.clear();
+    for (auto &layer : layers) {
+        layer->SetDirectScanout(false);
+    }
     mCompLayers.push_back(&clientLayer);
+    mCompPlanes.push_back(mPrimPlanes[0]);
+    mCompZpos.push_back(mPrimPlanes[0]->GetZposMin());
+    // a frame read back has to be composed into the client buffer entirely
+    bool readBack = (mWriteBack != nullptr) && (mWriteBackConnector == nullptr) && mWriteBack->IsFrameDue();
+    if (!mOverlayEnabled || readBack || layers.empty() || (mOverlayPlanes.empty() && mCursorPlanes.empty())) {
+        return DISPLAY_SUCCESS;
+    }
+    DrmMode mode;
+    int32_t ret = mConnector->GetModeFromId(mCrtc->GetActiveModeId(), mode);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_SUCCESS,
+        DISPLAY_LOGE("can not get the mode from id %{public}d", mCrtc->GetActiveModeId()));
+    return AssignPlanes(layers, mode.GetModeInfoPtr()->hdisplay, mode.GetModeInfoPtr()->vdisplay);
+}
+
+int32_t HdiDrmComposition::ApplyPlaneRect(HdiDrmLayer &layer, DrmPlane &drmPlane, drmModeAtomicReqPtr pset)
+{
+    DrmLayerRequest request;
+    DISPLAY_CHK_RETURN((!GetLayerRequest(layer, request)), DISPLAY_FAILURE, DISPLAY_LOGE("layer has no buffer"));
+    const IRect &crop = request.crop;
+    const IRect &rect = request.displayRect;
+    const std::pair<uint32_t, uint64_t> props[] = {
+        { drmPlane.GetPropSrcX(), static_cast<uint64_t>(crop.x) << DRM_FIXED_POINT_SHIFT },
+        { drmPlane.GetPropSrcY(), static_cast<uint64_t>(crop.y) << DRM_FIXED_POINT_SHIFT },
+        { drmPlane.GetPropSrcW(), static_cast<uint64_t>(crop.w) << DRM_FIXED_POINT_SHIFT },
+        { drmPlane.GetPropSrcH(), static_cast<uint64_t>(crop.h) << DRM_FIXED_POINT_SHIFT },
+        { drmPlane.GetPropCrtcX(), static_cast<uint64_t>(rect.x) },
+        { drmPlane.GetPropCrtcY(), static_cast<uint64_t>(rect.y) },
+        { drmPlane.GetPropCrtcW(), static_cast<uint64_t>(rect.w) },
+        { drmPlane.GetPropCrtcH(), static_cast<uint64_t>(rect.h) },
+    };
+    int ret;
+    for (const auto &prop : props) {
+        ret = drmModeAtomicAddProperty(pset, drmPlane.GetId(), prop.first, prop.second);
+        DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("set plane rect failed errno : %{public}d", errno));
+    }
+    if (drmPlane.GetPropRotationId() != 0) {
+        ret = drmModeAtomicAddProperty(pset, drmPlane.GetId(), drmPlane.GetPropRotationId(), request.rotation);
+        DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("set rotation failed errno : %{public}d", errno));
+    }
+    if (drmPlane.GetPropAlphaId() != 0) {
+        const LayerAlpha &alpha = layer.GetAlpha();
+        uint64_t value = alpha.enGlobalAlpha ? (alpha.gAlpha * DRM_ALPHA_OPAQUE / HDI_ALPHA_OPAQUE) : DRM_ALPHA_OPAQUE;
+        ret = drmModeAtomicAddProperty(pset, drmPlane.GetId(), drmPlane.GetPropAlphaId(), value);
+        DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("set alpha failed errno : %{public}d", errno));
+    }
+    return DISPLAY_SUCCESS;
+}
+
+int32_t HdiDrmComposition::DisablePlane(DrmPlane &drmPlane, drmModeAtomicReqPtr pset)
+{
+    DISPLAY_LOGD("disable plane %{public}d", drmPlane.GetId());
+    int ret = drmModeAtomicAddProperty(pset, drmPlane.GetId(), drmPlane.GetPropFbId(), 0);
+    DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("clear fb id failed errno : %{public}d", errno));
+    ret = drmModeAtomicAddProperty(pset, drmPlane.GetId(), drmPlane.GetPropCrtcId(), 0);
+    DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("clear crtc id failed errno : %{public}d", errno));
+    return DISPLAY_SUCCESS;
+}
+
+int32_t HdiDrmComposition::ApplyPlanes(drmModeAtomicReqPtr pset)
+{
+    int32_t ret;
+    DISPLAY_LOGD("mCompLayers size %{public}zd", mCompLayers.size());
+    for (uint32_t i = 0; i < mCompLayers.size(); i++) {
+        HdiDrmLayer *layer = static_cast<HdiDrmLayer *>(mCompLayers[i]);
+        ret = ApplyPlane(*layer, *mCompPlanes[i], mCompZpos[i], pset);
+        DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("apply plane failed"));
+    }
+    for (auto &plane : mActivePlanes) {
+        if (std::find(mCompPlanes.begin(), mCompPlanes.end(), plane) == mCompPlanes.end()) {
+            ret = DisablePlane(*plane, pset);
+            DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("disable plane failed"));
+        }
+    }
+    return DISPLAY_SUCCESS;
+}
+
+int32_t HdiDrmComposition::TestCommit()
+{
+    std::unique_ptr<DrmModeBlock> modeBlock;
+    drmModeAtomicReqPtr pset = ResetAtomicReq();
+    DISPLAY_CHK_RETURN((pset == nullptr), DISPLAY_NULL_PTR, DISPLAY_LOGE("no atomic request"));
+    int32_t ret = ApplyPlanes(pset);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("apply planes failed"));
+    ret = UpdateMode(modeBlock, *pset);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("update mode failed"));
+    uint32_t flags = DRM_MODE_ATOMIC_TEST_ONLY | (mCrtc->NeedModeSet() ? DRM_MODE_ATOMIC_ALLOW_MODESET : 0);
+    ret = drmModeAtomicCommit(mDrmDevice->GetDrmFd(), pset, flags, nullptr);
+    DISPLAY_CHK_RETURN((ret != 0), DISPLAY_FAILURE,
+        DISPLAY_LOGD("test commit rejected %{public}d errno %{public}d", ret, errno));
     return DISPLAY_SUCCESS;
 }
 
-int32_t HdiDrmComposition::ApplyPlane(HdiDrmLayer &layer, DrmPlane &drmPlane, drmModeAtomicReqPtr pset)
+int32_t HdiDrmComposition::ApplyPlane(HdiDrmLayer &layer, DrmPlane &drmPlane, uint64_t zpos, drmModeAtomicReqPtr pset)
 {
     // set fence in
     int ret;
@@ -84,6 +313,15 @@ int32_t HdiDrmComposition::ApplyPlane(HdiDrmLayer &layer, DrmPlane &drmPlane, dr
     DISPLAY_LOGD("set the crtc planeId %{public}d, propId %{public}d, crtcId %{public}d", drmPlane.GetId(),
         drmPlane.GetPropCrtcId(), mCrtc->GetId());
     DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("set crtc id fialed errno : %{public}d", errno));
+
+    // set zpos, the plane stays where the driver put it when it can not move
+    if (drmPlane.IsZposMutable()) {
+        ret = drmModeAtomicAddProperty(pset, drmPlane.GetId(), drmPlane.GetPropZposId(), zpos);
+        DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("set zpos failed errno : %{public}d", errno));
+    }
+    if (&drmPlane != mPrimPlanes[0].get()) {
+        return ApplyPlaneRect(layer, drmPlane, pset);
+    }
     return DISPLAY_SUCCESS;
 }
 
@@ -118,48 +356,201 @@ int32_t HdiDrmComposition::UpdateMode(std::unique_ptr<DrmModeBlock> &modeBlock,
     return DISPLAY_SUCCESS;
 }
 
+int32_t HdiDrmComposition::Disable()
+{
+    DISPLAY_LOGD("crtc %{public}d", mCrtc->GetId());
+    WaitPendingFlip();
+    drmModeAtomicReqPtr pset = ResetAtomicReq();
+    DISPLAY_CHK_RETURN((pset == nullptr), DISPLAY_NULL_PTR, DISPLAY_LOGE("no atomic request"));
+    int32_t ret = DISPLAY_SUCCESS;
+    for (auto &plane : mActivePlanes) {
+        ret = DisablePlane(*plane, pset);
+        DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("disable plane failed"));
+    }
+    if (mWriteBackAttached) {
+        ret = drmModeAtomicAddProperty(pset, mWriteBackConnector->GetId(), mWriteBackConnector->GetPropCrtcId(), 0);
+        DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("can not detach the writeback connector"));
+        mWriteBackAttached = false;
+    }
+    // the connector may be gone already, its crtc has to be released so that another output can take it
+    if ((drmModeAtomicAddProperty(pset, mConnector->GetId(), mConnector->GetPropCrtcId(), 0) < 0) ||
+        (drmModeAtomicAddProperty(pset, mCrtc->GetId(), mCrtc->GetActivePropId(), 0) < 0) ||
+        (drmModeAtomicAddProperty(pset, mCrtc->GetId(), mCrtc->GetModePropId(), 0) < 0)) {
+        DISPLAY_LOGE("can not add the disable props errno %{public}d", errno);
+        ret = DISPLAY_FAILURE;
+    } else if (drmModeAtomicCommit(mDrmDevice->GetDrmFd(), pset, DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr) != 0) {
+        DISPLAY_LOGE("disable crtc %{public}d failed errno %{public}d", mCrtc->GetId(), errno);
+        ret = DISPLAY_FAILURE;
+    }
+    mActivePlanes.clear();
+    mCompPlanes.clear();
+    mCompLayers.clear();
+    mDrmDevice->ReleaseDrmPlanes(mCrtc->GetPipe());
+    return ret;
+}
+
+int32_t HdiDrmComposition::SetWriteBack(HdiWriteBack *writeBack, std::shared_ptr<DrmConnector> connector)
+{
+    DISPLAY_LOGD("writeback connector %{public}d", (connector != nullptr) ? connector->GetId() : 0);
+    int32_t ret = DISPLAY_SUCCESS;
+    if (mWriteBackAttached) {
+        ret = DetachWriteBack();
+    }
+    // the kernel keeps a framebuffer alive until the writeback job using it is done
+    for (auto &fb : mWriteBackFbs) {
+        fb.reset();
+    }
+    mWriteBack = writeBack;
+    mWriteBackConnector = (writeBack != nullptr) ? connector : nullptr;
+    return ret;
+}
+
+int32_t HdiDrmComposition::DetachWriteBack()
+{
+    WaitPendingFlip();
+    drmModeAtomicReqPtr pset = ResetAtomicReq();
+    DISPLAY_CHK_RETURN((pset == nullptr), DISPLAY_NULL_PTR, DISPLAY_LOGE("no atomic request"));
+    mWriteBackAttached = false;
+    int ret = drmModeAtomicAddProperty(pset, mWriteBackConnector->GetId(), mWriteBackConnector->GetPropCrtcId(), 0);
+    DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("can not detach the writeback connector"));
+    ret = drmModeAtomicCommit(mDrmDevice->GetDrmFd(), pset, DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr);
+    DISPLAY_CHK_RETURN((ret != 0), DISPLAY_FAILURE,
+        DISPLAY_LOGE("detach the writeback connector failed errno %{public}d", errno));
+    return DISPLAY_SUCCESS;
+}
+
+int32_t HdiDrmComposition::ApplyWriteBack(drmModeAtomicReqPtr pset, int32_t *fence, uint32_t &slot)
+{
+    int32_t ret = mWriteBack->AcquireSlot(slot);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), ret, DISPLAY_LOGE("no free capture buffer"));
+    if (mWriteBackFbs[slot] == nullptr) {
+        HdiLayerBuffer buffer(*mWriteBack->GetSlotBuffer(slot));
+        mWriteBackFbs[slot] = std::make_unique<DrmGemBuffer>(mDrmDevice->GetDrmFd(), buffer);
+    }
+    DrmGemBuffer &fb = *mWriteBackFbs[slot];
+    DISPLAY_CHK_RETURN((!fb.IsValid()), DISPLAY_FAILURE, DISPLAY_LOGE("can not import the capture buffer"));
+    uint32_t id = mWriteBackConnector->GetId();
+    if ((drmModeAtomicAddProperty(pset, id, mWriteBackConnector->GetPropCrtcId(), mCrtc->GetId()) < 0) ||
+        (drmModeAtomicAddProperty(pset, id, mWriteBackConnector->GetPropWriteBackFbId(), fb.GetFbId()) < 0) ||
+        (drmModeAtomicAddProperty(pset, id, mWriteBackConnector->GetPropWriteBackOutFenceId(),
+        reinterpret_cast<uint64_t>(fence)) < 0)) {
+        DISPLAY_LOGE("can not add the writeback props errno %{public}d", errno);
+        return DISPLAY_FAILURE;
+    }
+    return DISPLAY_SUCCESS;
+}
+
+int32_t HdiDrmComposition::ReadBack()
+{
+    DISPLAY_CHK_RETURN((mCompLayers.empty()), DISPLAY_FAILURE, DISPLAY_LOGE("nothing is shown"));
+    HdiLayer &clientLayer = *mCompLayers[0];
+    HdiLayerBuffer *buffer = clientLayer.GetCurrentBuffer();
+    DISPLAY_CHK_RETURN((buffer == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("the client layer has no buffer"));
+    if (mCompLayers.size() > 1) {
+        DISPLAY_LOGW("%{public}zd layers on the planes are missing from the capture", mCompLayers.size() - 1);
+    }
+    return mWriteBack->ReadBack(buffer->mHandle, clientLayer.GetAcquireFenceFd());
+}
+
+int32_t HdiDrmComposition::CaptureNow()
+{
+    DISPLAY_CHK_RETURN((mWriteBack == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("there is no writeback"));
+    if (mWriteBackConnector == nullptr) {
+        return ReadBack();
+    }
+    DISPLAY_CHK_RETURN((mActivePlanes.empty()), DISPLAY_FAILURE, DISPLAY_LOGE("nothing is shown"));
+    return Present(false, true);
+}
+
 int32_t HdiDrmComposition::Apply(bool modeSet)
+{
+    bool capture = (mWriteBack != nullptr) && mWriteBack->CountFrame();
+    return Present(modeSet, capture);
+}
+
+int32_t HdiDrmComposition::Present(bool modeSet, bool capture)
 {
     uint64_t crtcOutFence = -1;
     int ret;
     std::unique_ptr<DrmModeBlock> modeBlock;
     int drmFd = mDrmDevice->GetDrmFd();
     DISPLAY_LOGD();
-    DISPLAY_CHK_RETURN((mPlanes.size() < mCompLayers.size()), DISPLAY_FAILURE, DISPLAY_LOGE("plane not enough"));
-    drmModeAtomicReqPtr pset = drmModeAtomicAlloc();
-    DISPLAY_CHK_RETURN((pset == nullptr), DISPLAY_NULL_PTR,
-        DISPLAY_LOGE("drm atomic alloc failed errno %{public}d", errno));
-    AtomicReqPtr atomicReqPtr = AtomicReqPtr(pset);
+    DISPLAY_CHK_RETURN((mCompPlanes.size() != mCompLayers.size()), DISPLAY_FAILURE,
+        DISPLAY_LOGE("layers are not assigned to planes"));
+    // the kernel refuses a new nonblocking commit while the last one is queued
+    WaitPendingFlip();
+    drmModeAtomicReqPtr pset = ResetAtomicReq();
+    DISPLAY_CHK_RETURN((pset == nullptr), DISPLAY_NULL_PTR, DISPLAY_LOGE("no atomic request"));
 
     // set the outFence property
-    ret = drmModeAtomicAddProperty(atomicReqPtr.Get(), mCrtc->GetId(), mCrtc->GetOutFencePropId(),
-        (uint64_t)&crtcOutFence);
+    ret = drmModeAtomicAddProperty(pset, mCrtc->GetId(), mCrtc->GetOutFencePropId(), (uint64_t)&crtcOutFence);
 
     DISPLAY_LOGD("Apply Set OutFence crtc id: %{public}d, fencePropId %{public}d", mCrtc->GetId(),
         mCrtc->GetOutFencePropId());
     DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("set the outfence property of crtc failed "));
 
     // set the plane info.
-    DISPLAY_LOGD("mCompLayers size %{public}zd", mCompLayers.size());
-    for (uint32_t i = 0; i < mCompLayers.size(); i++) {
-        HdiDrmLayer *layer = static_cast<HdiDrmLayer *>(mCompLayers[i]);
-        auto &drmPlane = mPlanes[i];
-        ret = ApplyPlane(*layer, *drmPlane, atomicReqPtr.Get());
-        if (ret != DISPLAY_SUCCESS) {
-            DISPLAY_LOGE("apply plane failed");
-            break;
-        }
+    ret = ApplyPlanes(pset);
+    if (ret != DISPLAY_SUCCESS) {
+        DISPLAY_LOGE("apply planes failed");
     }
-    ret = UpdateMode(modeBlock, *(atomicReqPtr.Get()));
+    bool needModeSet = modeSet || mCrtc->NeedModeSet();
+    ret = UpdateMode(modeBlock, *pset);
     DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("update mode failed"));
-    uint32_t flags = DRM_MODE_ATOMIC_ALLOW_MODESET;
+    // the writeback connector captures the frame of this very commit
+    bool writeBack = capture && (mWriteBackConnector != nullptr);
+    int32_t writeBackFence = -1;
+    uint32_t slot = 0;
+    if (writeBack) {
+        int cursor = drmModeAtomicGetCursor(pset);
+        if (ApplyWriteBack(pset, &writeBackFence, slot) == DISPLAY_SUCCESS) {
+            needModeSet = needModeSet || !mWriteBackAttached;
+        } else {
+            // the frame is shown without the capture
+            DISPLAY_LOGW("the frame is not captured");
+            drmModeAtomicSetCursor(pset, cursor);
+            writeBack = false;
+            capture = false;
+        }
+    }
+    // a modeset waits for the new mode, a plain frame is queued and the flip event retires it
+    uint32_t flags = needModeSet ? DRM_MODE_ATOMIC_ALLOW_MODESET :
+        (DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT);
 
-    ret = drmModeAtomicCommit(drmFd, atomicReqPtr.Get(), flags, nullptr);
+    if (!needModeSet) {
+        // marked before the commit, the event may arrive before drmModeAtomicCommit returns
+        DrmVsyncWorker::GetInstance().BeginFlip(mCrtc->GetId(), mCrtc->GetPipe());
+    }
+    ret = drmModeAtomicCommit(drmFd, pset, flags, nullptr);
+    if ((ret != 0) && !needModeSet) {
+        DrmVsyncWorker::GetInstance().CancelFlip(mCrtc->GetId());
+    }
     DISPLAY_CHK_RETURN((ret != 0), DISPLAY_FAILURE,
         DISPLAY_LOGE("drmModeAtomicCommit failed %{public}d errno %{public}d", ret, errno));
-    // set the release fence
+    if (mCrtc->NeedModeSet()) {
+        mCrtc->ClearModeSet();
+    }
+    mActivePlanes = mCompPlanes;
+    if (writeBack) {
+        mWriteBackAttached = true;
+        mWriteBack->Publish(slot, writeBackFence);
+    } else if (capture && (ReadBack() != DISPLAY_SUCCESS)) {
+        DISPLAY_LOGW("the frame is not captured");
+    }
+    // each layer owns its release fence, so the out fence of the crtc is shared by dups and closed once here
+    int outFence = static_cast<int>(crtcOutFence);
     for (auto layer : mCompLayers) {
-        layer->SetReleaseFence(static_cast<int>(crtcOutFence));
+        int releaseFence = -1;
+        if (outFence >= 0) {
+            releaseFence = dup(outFence);
+            if (releaseFence < 0) {
+                DISPLAY_LOGE("dup the out fence failed errno %{public}d", errno);
+            }
+        }
+        layer->SetReleaseFence(releaseFence);
+    }
+    if (outFence >= 0) {
+        close(outFence);
     }
 
     return DISPLAY_SUCCESS;
@@ -23,6 +23,7 @@
 #include "hdi_composer.h"
 #include "hdi_device_common.h"
 #include "hdi_drm_layer.h"
+#include "hdi_writeback.h"
 
 namespace OHOS {
 namespace HDI {
@@ -48,20 +49,54 @@ class HdiDrmComposition : public HdiComposition {
 public:
     HdiDrmComposition(std::shared_ptr<DrmConnector> connector, std::shared_ptr<DrmCrtc> crtc,
         std::shared_ptr<DrmDevice> drmDevice);
-    virtual ~HdiDrmComposition() {}
+    virtual ~HdiDrmComposition();
     int32_t Init();
     int32_t SetLayers(std::vector<HdiLayer *> &layers, HdiLayer &clientLayer);
     int32_t Apply(bool modeSet);
     int32_t UpdateMode(std::unique_ptr<DrmModeBlock> &modeBlock, drmModeAtomicReq &pset);
+    // switches the pipe off and gives its planes back, the composition is not used afterwards
+    int32_t Disable();
+    // the frames due are captured into writeBack by the writeback connector, or read back from the client buffer
+    // when there is none, nullptr stops capturing
+    int32_t SetWriteBack(HdiWriteBack *writeBack, std::shared_ptr<DrmConnector> connector);
+    // commits the frame shown again to capture it
+    int32_t CaptureNow();
 
 private:
-    int32_t ApplyPlane(HdiDrmLayer &layer, DrmPlane &drmPlane, drmModeAtomicReqPtr pset);
+    int32_t Present(bool modeSet, bool capture);
+    int32_t ApplyWriteBack(drmModeAtomicReqPtr pset, int32_t *fence, uint32_t &slot);
+    int32_t ReadBack();
+    int32_t DetachWriteBack();
+    int32_t WaitPendingFlip();
+    drmModeAtomicReqPtr ResetAtomicReq();
+    bool GetLayerRequest(HdiLayer &layer, DrmLayerRequest &request);
+    int32_t AssignPlanes(std::vector<HdiLayer *> &layers, uint32_t width, uint32_t height);
+    int32_t TestCommit();
+    int32_t ApplyPlanes(drmModeAtomicReqPtr pset);
+    int32_t ApplyPlane(HdiDrmLayer &layer, DrmPlane &drmPlane, uint64_t zpos, drmModeAtomicReqPtr pset);
+    int32_t ApplyPlaneRect(HdiDrmLayer &layer, DrmPlane &drmPlane, drmModeAtomicReqPtr pset);
+    int32_t DisablePlane(DrmPlane &drmPlane, drmModeAtomicReqPtr pset);
     std::shared_ptr<DrmDevice> mDrmDevice;
     std::shared_ptr<DrmConnector> mConnector;
     std::shared_ptr<DrmCrtc> mCrtc;
     std::vector<std::shared_ptr<DrmPlane>> mPrimPlanes;
     std::vector<std::shared_ptr<DrmPlane>> mOverlayPlanes;
+    std::vector<std::shared_ptr<DrmPlane>> mCursorPlanes;
     std::vector<std::shared_ptr<DrmPlane>> mPlanes;
+    // the plane and zpos of each layer in mCompLayers, the client layer always goes to the primary plane
+    std::vector<std::shared_ptr<DrmPlane>> mCompPlanes;
+    std::vector<uint64_t> mCompZpos;
+    // the planes enabled by the last commit, the ones not used any more have to be switched off
+    std::vector<std::shared_ptr<DrmPlane>> mActivePlanes;
+    bool mOverlayEnabled = true;
+    // reused by every commit of this display, rewound instead of reallocated
+    std::unique_ptr<AtomicReqPtr> mAtomicReq;
+    HdiWriteBack *mWriteBack = nullptr;
+    std::shared_ptr<DrmConnector> mWriteBackConnector;
+    // the framebuffer of each capture buffer, imported on the first capture into it
+    std::unique_ptr<DrmGemBuffer> mWriteBackFbs[HdiWriteBack::BUFFER_COUNT];
+    // the writeback connector is bound to the crtc by the first capture, which needs a modeset
+    bool mWriteBackAttached = false;
 };
 } // OHOS
 } // HDI
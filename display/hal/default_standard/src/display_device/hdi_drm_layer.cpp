@@ -75,12 +75,25 @@ bool DrmGemBuffer::IsValid()
     return (mGemHandle != INVALID_DRM_ID) && (mFdId != INVALID_DRM_ID);
 }
 
+int32_t HdiDrmLayer::SetLayerBuffer(const BufferHandle *buffer, int32_t fence)
+{
+    mImportedBuffer = nullptr;
+    return HdiLayer::SetLayerBuffer(buffer, fence);
+}
+
 DrmGemBuffer *HdiDrmLayer::GetGemBuffer()
 {
     DISPLAY_LOGD();
-    std::unique_ptr<DrmGemBuffer> ptr = std::make_unique<DrmGemBuffer>(DrmDevice::GetDrmFd(), *GetCurrentBuffer());
+    HdiLayerBuffer *layerBuffer = GetCurrentBuffer();
+    DISPLAY_CHK_RETURN((layerBuffer == nullptr), nullptr, DISPLAY_LOGE("the layer has no buffer"));
+    // a plane test commit and the real commit of one frame share the framebuffer
+    if ((mCurrentBuffer != nullptr) && (mImportedBuffer == layerBuffer)) {
+        return mCurrentBuffer.get();
+    }
+    std::unique_ptr<DrmGemBuffer> ptr = std::make_unique<DrmGemBuffer>(DrmDevice::GetDrmFd(), *layerBuffer);
     lastBuffer_ = std::move(mCurrentBuffer);
     mCurrentBuffer = std::move(ptr);
+    mImportedBuffer = layerBuffer;
     return mCurrentBuffer.get();
 }
 } // namespace OHOS
@@ -51,8 +51,11 @@ public:
     virtual ~HdiDrmLayer() {}
     // Return value optimization
     DrmGemBuffer *GetGemBuffer();
+    int32_t SetLayerBuffer(const BufferHandle *buffer, int32_t fence) override;
 
 private:
+    // the layer buffer mCurrentBuffer was imported from, reset by every SetLayerBuffer
+    const HdiLayerBuffer *mImportedBuffer = nullptr;
     std::unique_ptr<DrmGemBuffer> mCurrentBuffer;
     std::unique_ptr<DrmGemBuffer> lastBuffer_;
 };
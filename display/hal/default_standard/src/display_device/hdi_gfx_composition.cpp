@@ -18,6 +18,7 @@
 #include <dlfcn.h>
 #include <errno.h>
 #include "display_gfx.h"
+#include "display_gfx_soft.h"
 
 #define LIB_HDI_GFX_NAME "libdisplay_gfx.z.so"
 #define LIB_GFX_FUNC_INIT "GfxInitialize"
@@ -47,8 +48,8 @@ int32_t HdiGfxComposition::GfxModuleInit(void)
         DISPLAY_LOGI("Loading module '%{public}s'", LIB_HDI_GFX_NAME);
         mGfxModule = dlopen(LIB_HDI_GFX_NAME, RTLD_NOW);
         if (mGfxModule == nullptr) {
-            DISPLAY_LOGE("Failed to load module: %{public}s", dlerror());
-            return DISPLAY_FAILURE;
+            DISPLAY_LOGI("Failed to load module: %{public}s, compose on the cpu", dlerror());
+            return SoftGfxInitialize(&mGfxFuncs);
         }
     }
 
@@ -57,6 +58,7 @@ int32_t HdiGfxComposition::GfxModuleInit(void)
     if (func == nullptr) {
         DISPLAY_LOGE("Failed to lookup %{public}s function: %s", LIB_GFX_FUNC_INIT, dlerror());
         dlclose(mGfxModule);
+        mGfxModule = nullptr;
         return DISPLAY_FAILURE;
     }
     return func(&mGfxFuncs);
@@ -66,7 +68,7 @@ int32_t HdiGfxComposition::GfxModuleDeinit(void)
 {
     DISPLAY_LOGD();
     int32_t ret = DISPLAY_SUCCESS;
-    if (mGfxModule == nullptr) {
+    if (mGfxModule != nullptr) {
         using DeinitFunc = int32_t (*)(GfxFuncs *funcs);
         DeinitFunc func = reinterpret_cast<DeinitFunc>(dlsym(mGfxModule, LIB_GFX_FUNC_DEINIT));
         if (func == nullptr) {
@@ -75,15 +77,18 @@ int32_t HdiGfxComposition::GfxModuleDeinit(void)
             ret = func(mGfxFuncs);
         }
         dlclose(mGfxModule);
+    } else if (mGfxFuncs != nullptr) {
+        (void)mGfxFuncs->DeinitGfx();
+        ret = SoftGfxUninitialize(mGfxFuncs);
     }
+    mGfxFuncs = nullptr;
     return ret;
 }
 
 bool HdiGfxComposition::CanHandle(HdiLayer &hdiLayer)
 {
     DISPLAY_LOGD();
-    (void)hdiLayer;
-    return true;
+    return !hdiLayer.IsDirectScanout();
 }
 
 int32_t HdiGfxComposition::SetLayers(std::vector<HdiLayer *> &layers, HdiLayer &clientLayer)
@@ -145,6 +150,7 @@ int32_t HdiGfxComposition::BlitLayer(HdiLayer &src, HdiLayer &dst)
 
     if (src.GetAlpha().enGlobalAlpha) { // is alpha is 0xff we not set it
         opt.enGlobalAlpha = true;
+        opt.globalAlpha = src.GetAlpha().gAlpha;
         srcSurface.alpha0 = src.GetAlpha().gAlpha;
         DISPLAY_LOGD("src alpha %{public}x", src.GetAlpha().gAlpha);
     }
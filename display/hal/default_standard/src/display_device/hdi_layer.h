@@ -124,6 +124,15 @@ public:
     {
         return mDeviceSelect;
     }
+    // set while a hardware plane scans the layer buffer out, the layer then stays out of the client buffer
+    void SetDirectScanout(bool direct)
+    {
+        mDirectScanout = direct;
+    }
+    bool IsDirectScanout() const
+    {
+        return mDirectScanout;
+    }
 
     int GetAcquireFenceFd()
     {
@@ -184,6 +193,7 @@ private:
     TransformType mTransformType;
     CompositionType mCompositionType = COMPOSITION_CLIENT;
     CompositionType mDeviceSelect = COMPOSITION_CLIENT;
+    bool mDirectScanout = false;
     BlendType mBlendType;
     std::unique_ptr<HdiLayerBuffer> mHdiBuffer;
 };
@@ -14,58 +14,165 @@
  */
 
 #include "hdi_netlink_monitor.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <linux/netlink.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
-#include <errno.h>
+#include <unistd.h>
+#include "display_common.h"
+#include "display_type.h"
 
 namespace OHOS {
 namespace HDI {
 namespace DISPLAY {
+namespace {
+// the kernel multicasts its uevents to this group
+const uint32_t UEVENT_KERNEL_GROUP = 1;
+// a uevent datagram is at most 2048 bytes, leave room for the terminator
+const size_t UEVENT_BUFFER_SIZE = 2048 + 1;
+const int32_t UEVENT_SOCKET_BUFFER = 64 * 1024;
+const char *DRM_SUBSYSTEM = "drm";
+const char *ACTION_CHANGE = "change";
+
+bool StartsWith(const char *str, size_t len, const char *prefix, const char *&value)
+{
+    size_t prefixLen = strlen(prefix);
+    if ((len < prefixLen) || (strncmp(str, prefix, prefixLen) != 0)) {
+        return false;
+    }
+    value = str + prefixLen;
+    return true;
+}
+}
+
 HdiNetLinkMonitor::HdiNetLinkMonitor()
 {
     DISPLAY_LOGD();
 }
 
-int HdiNetLinkMonitor::Init()
+HdiNetLinkMonitor::HdiNetLinkMonitor(HdiUeventCallback callback) : mCallback(callback)
 {
     DISPLAY_LOGD();
-    int fd;
-    struct sockaddr_nl snl = { 0 };
-    int ret;
-    const int32_t bufferSize = 1024;
-    DISPLAY_CHK_RETURN((mScoketFd < 0), DISPLAY_FAILURE, DISPLAY_LOGE("the socket has initial"));
-    fd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_KOBJECT_UEVENT);
-    DISPLAY_CHK_RETURN((fd < 0), DISPLAY_FAILURE, DISPLAY_LOGE("scoket create failed"));
-    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
-    ret = bind(fd, (struct sockaddr *)&snl, sizeof(struct sockaddr_nl));
-    DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("bind failed errno : %{public}d", errno));
+}
 
-    mThread = std::make_unique<std::thread>([this]() {
-        mRunning = true;
-        MonitorThread();
-    });
+int HdiNetLinkMonitor::Init(HdiUeventCallback callback)
+{
+    DISPLAY_LOGD();
+    DISPLAY_CHK_RETURN(((mScoketFd >= 0) || (mCallback != nullptr)), DISPLAY_FAILURE,
+        DISPLAY_LOGE("the monitor has initial"));
+    DISPLAY_CHK_RETURN((callback == nullptr), DISPLAY_NULL_PTR, DISPLAY_LOGE("the callback is nullptr"));
+    int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    DISPLAY_CHK_RETURN((fd < 0), DISPLAY_FAILURE, DISPLAY_LOGE("scoket create failed errno : %{public}d", errno));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &UEVENT_SOCKET_BUFFER, sizeof(UEVENT_SOCKET_BUFFER));
+    struct sockaddr_nl snl = { 0 };
+    snl.nl_family = AF_NETLINK;
+    snl.nl_groups = UEVENT_KERNEL_GROUP;
+    int ret = bind(fd, reinterpret_cast<struct sockaddr *>(&snl), sizeof(snl));
+    DISPLAY_CHK_RETURN((ret < 0), DISPLAY_FAILURE, DISPLAY_LOGE("bind failed errno : %{public}d", errno); close(fd));
+    mWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    DISPLAY_CHK_RETURN((mWakeFd < 0), DISPLAY_FAILURE, DISPLAY_LOGE("can not create eventfd errno %{public}d", errno);
+        close(fd));
     mScoketFd = fd;
+    mCallback = callback;
+    mRunning = true;
+    mThread = std::make_unique<std::thread>([this]() { MonitorThread(); });
     return DISPLAY_SUCCESS;
 }
 
 HdiNetLinkMonitor::~HdiNetLinkMonitor()
 {
     DISPLAY_LOGD();
+    mRunning = false;
+    if (mThread != nullptr) {
+        uint64_t value = 1;
+        if (write(mWakeFd, &value, sizeof(value)) < 0) {
+            DISPLAY_LOGE("wake the monitor failed errno %{public}d", errno);
+        }
+        mThread->join();
+    }
     if (mScoketFd >= 0) {
         close(mScoketFd);
     }
+    if (mWakeFd >= 0) {
+        close(mWakeFd);
+    }
+}
+
+// "change@/devices/...\0ACTION=change\0SUBSYSTEM=drm\0HOTPLUG=1\0..." a header and NUL separated pairs
+bool HdiNetLinkMonitor::ParseUevent(const char *buf, size_t len, HdiUevent &event)
+{
+    DISPLAY_CHK_RETURN(((buf == nullptr) || (len == 0)), false, DISPLAY_LOGE("the uevent is empty"));
+    event = HdiUevent();
+    size_t headerLen = strnlen(buf, len);
+    DISPLAY_CHK_RETURN((memchr(buf, '@', headerLen) == nullptr), false, DISPLAY_LOGD("not a kernel uevent"));
+    for (size_t pos = headerLen + 1; pos < len;) {
+        const char *field = buf + pos;
+        size_t fieldLen = strnlen(field, len - pos);
+        const char *value = nullptr;
+        if (StartsWith(field, fieldLen, "ACTION=", value)) {
+            event.action.assign(value, field + fieldLen);
+        } else if (StartsWith(field, fieldLen, "SUBSYSTEM=", value)) {
+            event.subsystem.assign(value, field + fieldLen);
+        } else if (StartsWith(field, fieldLen, "DEVNAME=", value)) {
+            event.devName.assign(value, field + fieldLen);
+        } else if (StartsWith(field, fieldLen, "HOTPLUG=", value)) {
+            event.hotplug = (std::string(value, field + fieldLen) == "1");
+        } else if (StartsWith(field, fieldLen, "CONNECTOR=", value)) {
+            event.connectorId = static_cast<uint32_t>(strtoul(std::string(value, field + fieldLen).c_str(), nullptr,
+                10)); // 10: decimal
+        }
+        pos += fieldLen + 1;
+    }
+    return !event.action.empty();
+}
+
+void HdiNetLinkMonitor::HandleUevent(const char *buf, size_t len)
+{
+    HdiUevent event;
+    if (!ParseUevent(buf, len, event)) {
+        return;
+    }
+    if ((event.subsystem != DRM_SUBSYSTEM) || (event.action != ACTION_CHANGE) || !event.hotplug) {
+        return;
+    }
+    DISPLAY_LOGI("drm hotplug %{public}s connector %{public}u", event.devName.c_str(), event.connectorId);
+    if (mCallback != nullptr) {
+        mCallback(event);
+    }
 }
 
-Void HdiNetLinkMonitor::MonitorThread()
+void HdiNetLinkMonitor::MonitorThread()
 {
     DISPLAY_LOGD();
-    constexpr int BUFFER_SIZE = UEVENT_BUFFER_SIZE * 2;
+    char buf[UEVENT_BUFFER_SIZE] = { 0 };
+    struct pollfd fds[] = {
+        { mScoketFd, POLLIN, 0 },
+        { mWakeFd, POLLIN, 0 },
+    };
     while (mRunning) {
-        char buf[BUFFER_SIZE] = { 0 };
-        recv(mScoketFd, &buf, sizeof(buf), 0);
+        int ret = poll(fds, sizeof(fds) / sizeof(fds[0]), -1);
+        if (ret < 0) {
+            DISPLAY_CHK_RETURN_NOT_VALUE((errno != EINTR), DISPLAY_LOGE("poll failed errno %{public}d", errno));
+            continue;
+        }
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+        struct sockaddr_nl addr = { 0 };
+        socklen_t addrLen = sizeof(addr);
+        ssize_t len = recvfrom(mScoketFd, buf, sizeof(buf) - 1, 0, reinterpret_cast<struct sockaddr *>(&addr),
+            &addrLen);
+        // only the kernel is trusted, user space may multicast to the group as well
+        if ((len <= 0) || (addr.nl_pid != 0)) {
+            continue;
+        }
+        buf[len] = '\0';
+        HandleUevent(buf, static_cast<size_t>(len));
     }
 }
 } // DISPLAY
 } // HDI
 } // OHOS
-
-#endif // HDI_NETLINK_NONITOR_H
\ No newline at end of file
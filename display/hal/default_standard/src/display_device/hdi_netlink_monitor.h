@@ -15,25 +15,49 @@
 
 #ifndef HDI_NETLINK_NONITOR_H
 #define HDI_NETLINK_NONITOR_H
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
 #include <thread>
 
 namespace OHOS {
 namespace HDI {
 namespace DISPLAY {
+struct HdiUevent {
+    std::string action;
+    std::string subsystem;
+    std::string devName;
+    bool hotplug = false;
+    // only set by the drivers that tell which connector changed
+    uint32_t connectorId = 0;
+};
+
+using HdiUeventCallback = std::function<void(const HdiUevent &event)>;
+
 class HdiNetLinkMonitor {
 public:
     HdiNetLinkMonitor();
-    int Init();
+    // only HandleUevent reaches the callback, there is no socket
+    explicit HdiNetLinkMonitor(HdiUeventCallback callback);
+    // the callback runs on the monitor thread for every drm hotplug uevent
+    int Init(HdiUeventCallback callback);
     virtual ~HdiNetLinkMonitor();
+    static bool ParseUevent(const char *buf, size_t len, HdiUevent &event);
+    // the monitor thread passes every datagram of the kernel here, tests inject theirs
+    void HandleUevent(const char *buf, size_t len);
 
 private:
-    Void MonitorThread();
-    volatile bool mRunning = false;
+    void MonitorThread();
+    std::atomic<bool> mRunning { false };
     int mScoketFd = -1;
+    // written to stop the monitor thread
+    int mWakeFd = -1;
+    HdiUeventCallback mCallback;
     std::unique_ptr<std::thread> mThread;
 };
 } // namespace OHOS
 } // namespace HDI
 } // namespace DISPLAY
 
-#endif // HDI_NETLINK_NONITOR_H
\ No newline at end of file
+#endif // HDI_NETLINK_NONITOR_H
@@ -41,28 +41,76 @@ void HdiSession::Init()
         auto displays = device->DiscoveryDisplay();
         mHdiDisplays.insert(displays.begin(), displays.end());
     }
+    mNetLinkMonitor = std::make_unique<HdiNetLinkMonitor>();
+    int ret = mNetLinkMonitor->Init([this](const HdiUevent &) { HandleHotPlug(); });
+    if (ret != DISPLAY_SUCCESS) {
+        DISPLAY_LOGE("can not monitor the hotplug uevents, the displays are fixed");
+        mNetLinkMonitor = nullptr;
+    }
 }
 
 int32_t HdiSession::RegHotPlugCallback(HotPlugCallback callback, void *data)
 {
     DISPLAY_CHK_RETURN((callback == nullptr), DISPLAY_NULL_PTR, DISPLAY_LOGE("the callback is nullptr"));
-    mHotPlugCallBacks[callback] = data;
-    for (auto displayMap : mHdiDisplays) {
-        auto display = displayMap.second;
-        if (display->IsConnected()) {
-            DoHotPlugCallback(display->GetId(), true);
+    {
+        std::lock_guard<std::mutex> lock(mCallbackMutex);
+        mHotPlugCallBacks[callback] = data;
+    }
+    std::vector<uint32_t> connected;
+    {
+        std::shared_lock<std::shared_mutex> lock(mDisplayMutex);
+        for (auto displayMap : mHdiDisplays) {
+            auto display = displayMap.second;
+            if (display->IsConnected()) {
+                connected.push_back(display->GetId());
+            }
         }
     }
+    // called without the lock, the callback may query the display right away
+    for (uint32_t devId : connected) {
+        callback(devId, true, data);
+    }
     return DISPLAY_SUCCESS;
 }
 
 void HdiSession::DoHotPlugCallback(uint32_t devId, bool connect)
 {
-    DISPLAY_LOGD();
-    for (const auto &callback : mHotPlugCallBacks) {
+    DISPLAY_LOGD("display %{public}d connect %{public}d", devId, connect);
+    std::unordered_map<HotPlugCallback, void *> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mCallbackMutex);
+        callbacks = mHotPlugCallBacks;
+    }
+    for (const auto &callback : callbacks) {
         callback.first(devId, connect, callback.second);
     }
 }
+
+void HdiSession::HandleHotPlug()
+{
+    DISPLAY_LOGD();
+    std::vector<uint32_t> removed;
+    std::unordered_map<uint32_t, std::shared_ptr<HdiDisplay>> added;
+    {
+        std::unique_lock<std::shared_mutex> lock(mDisplayMutex);
+        for (auto &device : mHdiDevices) {
+            int32_t ret = device->UpdateDisplays(removed, added);
+            if ((ret != DISPLAY_SUCCESS) && (ret != DISPLAY_NOT_SUPPORT)) {
+                DISPLAY_LOGE("update the displays failed %{public}d", ret);
+            }
+        }
+        for (uint32_t devId : removed) {
+            mHdiDisplays.erase(devId);
+        }
+        mHdiDisplays.insert(added.begin(), added.end());
+    }
+    for (uint32_t devId : removed) {
+        DoHotPlugCallback(devId, false);
+    }
+    for (const auto &displayPair : added) {
+        DoHotPlugCallback(displayPair.first, true);
+    }
+}
 } // OHOS
 } // HDI
 } // DISPLAY
@@ -197,6 +245,66 @@ static int32_t RegDisplayVBlankCallback(uint32_t devId, VBlankCallback callback,
     return HdiSession::GetInstance().CallDisplayFunction(devId, &HdiDisplay::RegDisplayVBlankCallback, callback, data);
 }
 
+static int32_t RegDisplayVBlankListener(uint32_t devId, VBlankCallback callback, void *data, int64_t phaseNs)
+{
+    DISPLAY_LOGD();
+    return HdiSession::GetInstance().CallDisplayFunction(devId, &HdiDisplay::RegDisplayVBlankListener, callback, data,
+        phaseNs);
+}
+
+static int32_t UnregDisplayVBlankListener(uint32_t devId, VBlankCallback callback, void *data)
+{
+    DISPLAY_LOGD();
+    return HdiSession::GetInstance().CallDisplayFunction(devId, &HdiDisplay::UnregDisplayVBlankListener, callback,
+        data);
+}
+
+static int32_t GetDisplayNextVBlank(uint32_t devId, uint64_t *ns, uint64_t *period)
+{
+    DISPLAY_LOGD();
+    return HdiSession::GetInstance().CallDisplayFunction(devId, &HdiDisplay::GetDisplayNextVBlank, ns, period);
+}
+
+static int32_t CreateWriteBack(uint32_t *devId, uint32_t width, uint32_t height, int32_t *format)
+{
+    DISPLAY_LOGD();
+    DISPLAY_CHK_RETURN((devId == NULL), DISPLAY_NULL_PTR, DISPLAY_LOGE("devId is nullptr"));
+    DISPLAY_CHK_RETURN(((*devId & WRITEBACK_ID_FLAG) != 0), DISPLAY_PARAM_ERR,
+        DISPLAY_LOGE("%{public}x is a writeback already", *devId));
+    int32_t ret = HdiSession::GetInstance().CallDisplayFunction(*devId, &HdiDisplay::CreateWriteBack, width, height,
+        format);
+    if (ret == DISPLAY_SUCCESS) {
+        *devId |= WRITEBACK_ID_FLAG;
+    }
+    return ret;
+}
+
+static int32_t DestroyWriteBack(uint32_t devId)
+{
+    DISPLAY_LOGD();
+    DISPLAY_CHK_RETURN(((devId & WRITEBACK_ID_FLAG) == 0), DISPLAY_PARAM_ERR,
+        DISPLAY_LOGE("%{public}x is not a writeback", devId));
+    return HdiSession::GetInstance().CallDisplayFunction(devId & ~WRITEBACK_ID_FLAG, &HdiDisplay::DestroyWriteBack);
+}
+
+static int32_t GetWriteBackFrame(uint32_t devId, BufferHandle *buffer, int32_t *fence)
+{
+    DISPLAY_LOGD();
+    DISPLAY_CHK_RETURN(((devId & WRITEBACK_ID_FLAG) == 0), DISPLAY_PARAM_ERR,
+        DISPLAY_LOGE("%{public}x is not a writeback", devId));
+    return HdiSession::GetInstance().CallDisplayFunction(devId & ~WRITEBACK_ID_FLAG, &HdiDisplay::GetWriteBackFrame,
+        buffer, fence);
+}
+
+static int32_t SetWriteBackCadence(uint32_t devId, uint32_t interval)
+{
+    DISPLAY_LOGD();
+    DISPLAY_CHK_RETURN(((devId & WRITEBACK_ID_FLAG) == 0), DISPLAY_PARAM_ERR,
+        DISPLAY_LOGE("%{public}x is not a writeback", devId));
+    return HdiSession::GetInstance().CallDisplayFunction(devId & ~WRITEBACK_ID_FLAG, &HdiDisplay::SetWriteBackCadence,
+        interval);
+}
+
 static int32_t GetDisplayReleaseFence(uint32_t devId, uint32_t *num, uint32_t *layers, int32_t *fences)
 {
     DISPLAY_LOGD();
@@ -350,6 +458,13 @@ int32_t DeviceInitialize(DeviceFuncs **funcs)
     dFuncs->SetVirtualDisplayBuffer = SetVirtualDisplayBuffer;
     dFuncs->SetDisplayProperty = SetDisplayProperty;
     dFuncs->Commit = Commit;
+    dFuncs->RegDisplayVBlankListener = RegDisplayVBlankListener;
+    dFuncs->UnregDisplayVBlankListener = UnregDisplayVBlankListener;
+    dFuncs->GetDisplayNextVBlank = GetDisplayNextVBlank;
+    dFuncs->GetWriteBackFrame = GetWriteBackFrame;
+    dFuncs->CreateWriteBack = CreateWriteBack;
+    dFuncs->DestroyWriteBack = DestroyWriteBack;
+    dFuncs->SetWriteBackCadence = SetWriteBackCadence;
     *funcs = dFuncs;
     DISPLAY_LOGD("%{public}s: device initialize success", __func__);
     HdiSession::GetInstance();
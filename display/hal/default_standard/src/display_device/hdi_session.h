@@ -15,12 +15,15 @@
 
 #ifndef HDI_SESSION_H
 #define HDI_SESSION_H
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <vector>
 #include <memory>
 #include "display_device.h"
 #include "hdi_device_interface.h"
 #include "hdi_display.h"
+#include "hdi_netlink_monitor.h"
 
 namespace OHOS {
 namespace HDI {
@@ -35,6 +38,7 @@ public:
     {
         DISPLAY_LOGD("device Id : %{public}d", devId);
         DISPLAY_CHK_RETURN((devId == INVALIDE_DISPLAY_ID), DISPLAY_FAILURE, DISPLAY_LOGE("invalide device id"));
+        std::shared_lock<std::shared_mutex> lock(mDisplayMutex);
         auto iter = mHdiDisplays.find(devId);
         DISPLAY_CHK_RETURN((iter == mHdiDisplays.end()), DISPLAY_FAILURE,
             DISPLAY_LOGE("can not find display %{public}d", devId));
@@ -47,6 +51,7 @@ public:
     {
         DISPLAY_LOGD("device Id : %{public}d", devId);
         DISPLAY_CHK_RETURN((devId == INVALIDE_DISPLAY_ID), DISPLAY_FAILURE, DISPLAY_LOGE("invalide device id"));
+        std::shared_lock<std::shared_mutex> lock(mDisplayMutex);
         auto iter = mHdiDisplays.find(devId);
         DISPLAY_CHK_RETURN((iter == mHdiDisplays.end()), DISPLAY_FAILURE,
             DISPLAY_LOGE("can not find display %{public}d", devId));
@@ -59,11 +64,18 @@ public:
 
     int32_t RegHotPlugCallback(HotPlugCallback callback, void *data);
     void DoHotPlugCallback(uint32_t devId, bool connect);
+    // re-probes every device, runs on the netlink monitor thread for each drm hotplug uevent
+    void HandleHotPlug();
 
 private:
+    // the calls into a display hold it shared, a hotplug takes it exclusively to add and remove displays
+    std::shared_mutex mDisplayMutex;
     std::unordered_map<uint32_t, std::shared_ptr<HdiDisplay>> mHdiDisplays;
     std::vector<std::shared_ptr<HdiDeviceInterface>> mHdiDevices;
+    std::mutex mCallbackMutex;
     std::unordered_map<HotPlugCallback, void *> mHotPlugCallBacks;
+    // declared last, its thread is stopped before the rest of the session goes away
+    std::unique_ptr<HdiNetLinkMonitor> mNetLinkMonitor;
 };
 } // namespace OHOS
 } // namespace HDI
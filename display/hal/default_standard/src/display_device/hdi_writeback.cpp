@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hdi_writeback.h"
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include "display_common.h"
+
+namespace OHOS {
+namespace HDI {
+namespace DISPLAY {
+namespace {
+// a few refresh periods, the client or the writeback engine that takes longer is stuck
+const int FENCE_TIMEOUT_MS = 100;
+}
+
+HdiWriteBack::HdiWriteBack(uint32_t width, uint32_t height, PixelFormat format)
+    : mWidth(width), mHeight(height), mFormat(format)
+{
+    DISPLAY_LOGD("%{public}u x %{public}u format %{public}d", width, height, format);
+}
+
+HdiWriteBack::~HdiWriteBack()
+{
+    for (auto &slot : mSlots) {
+        if (slot.buffer == nullptr) {
+            continue;
+        }
+        // the writeback engine may still be writing the last capture
+        WaitFence(slot.acquireFence.GetFd(), FENCE_TIMEOUT_MS);
+        mGrallocFuncs->FreeMem(slot.buffer);
+        slot.buffer = nullptr;
+    }
+    if (mGrallocFuncs != nullptr) {
+        GrallocUninitialize(mGrallocFuncs);
+    }
+}
+
+int32_t HdiWriteBack::Init()
+{
+    int32_t ret = GrallocInitialize(&mGrallocFuncs);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("gralloc init failed"));
+    AllocInfo info = {
+        .width = mWidth,
+        .height = mHeight,
+        .usage = HBM_USE_MEM_DMA | HBM_USE_CPU_READ | HBM_USE_CPU_WRITE,
+        .format = mFormat
+    };
+    for (auto &slot : mSlots) {
+        ret = mGrallocFuncs->AllocMem(&info, &slot.buffer);
+        DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_LOGE("can not alloc the capture buffer"));
+    }
+    mSoftGfx = std::make_unique<SoftGfx>(SoftGfx::GetDefaultThreads());
+    return DISPLAY_SUCCESS;
+}
+
+void HdiWriteBack::SetInterval(uint32_t interval)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    DISPLAY_LOGD("interval %{public}u", interval);
+    mInterval = interval;
+    // the next frame starts the new cadence
+    mFrameCount = 0;
+}
+
+bool HdiWriteBack::IsFrameDue()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return (mInterval != 0) && ((mFrameCount % mInterval) == 0);
+}
+
+bool HdiWriteBack::CountFrame()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    bool due = (mInterval != 0) && ((mFrameCount % mInterval) == 0);
+    mFrameCount++;
+    return due;
+}
+
+int32_t HdiWriteBack::WaitFence(int fence, int timeoutMs)
+{
+    if (fence < 0) {
+        return DISPLAY_SUCCESS;
+    }
+    struct pollfd fds = { fence, POLLIN, 0 };
+    int ret;
+    do {
+        ret = poll(&fds, 1, timeoutMs);
+    } while ((ret < 0) && (errno == EINTR));
+    DISPLAY_CHK_RETURN((ret <= 0), DISPLAY_FAILURE,
+        DISPLAY_LOGE("wait fence %{public}d failed %{public}d errno %{public}d", fence, ret, errno));
+    return DISPLAY_SUCCESS;
+}
+
+int32_t HdiWriteBack::AcquireSlot(uint32_t &slot)
+{
+    int releaseFence = -1;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        // the latest capture is kept for the next GetFrame, and the one handed out has no release fence until
+        // the client calls GetFrame again, so the next capture goes to the first slot that is neither
+        for (uint32_t i = 1; i <= BUFFER_COUNT; i++) {
+            slot = static_cast<uint32_t>(mLatest + static_cast<int32_t>(i)) % BUFFER_COUNT;
+            if ((static_cast<int32_t>(slot) != mLatest) && (static_cast<int32_t>(slot) != mDelivered)) {
+                break;
+            }
+        }
+        Slot &next = mSlots[slot];
+        DISPLAY_CHK_RETURN((next.buffer == nullptr), DISPLAY_FAILURE,
+            DISPLAY_LOGE("the capture buffers are not allocated"));
+        if (next.releaseFence.GetFd() >= 0) {
+            releaseFence = dup(next.releaseFence.GetFd());
+            DISPLAY_CHK_RETURN((releaseFence < 0), DISPLAY_FAILURE,
+                DISPLAY_LOGE("dup the release fence failed errno %{public}d", errno));
+        }
+    }
+    // called from the commit path, so the fence is only polled and a client that is late costs this capture
+    int32_t ret = WaitFence(releaseFence, 0);
+    if (releaseFence >= 0) {
+        close(releaseFence);
+    }
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE,
+        DISPLAY_LOGE("the client still holds capture buffer %{public}u", slot));
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSlots[slot].releaseFence = -1;
+    mSlots[slot].acquireFence = -1;
+    return DISPLAY_SUCCESS;
+}
+
+BufferHandle *HdiWriteBack::GetSlotBuffer(uint32_t slot)
+{
+    DISPLAY_CHK_RETURN((slot >= BUFFER_COUNT), nullptr, DISPLAY_LOGE("invalid slot %{public}u", slot));
+    return mSlots[slot].buffer;
+}
+
+void HdiWriteBack::Publish(uint32_t slot, int fence)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    DISPLAY_CHK_RETURN_NOT_VALUE((slot >= BUFFER_COUNT), DISPLAY_LOGE("invalid slot %{public}u", slot));
+    mSlots[slot].acquireFence = fence;
+    mLatest = static_cast<int32_t>(slot);
+}
+
+bool HdiWriteBack::HasFrame()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLatest >= 0;
+}
+
+int32_t HdiWriteBack::GetFrame(BufferHandle &buffer, int32_t &fence)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mDelivered >= 0) {
+        mSlots[mDelivered].releaseFence = fence;
+    } else if (fence >= 0) {
+        close(fence);
+    }
+    fence = -1;
+    DISPLAY_CHK_RETURN((mLatest < 0), DISPLAY_FAILURE, DISPLAY_LOGE("no frame is captured yet"));
+    Slot &latest = mSlots[mLatest];
+    buffer = *latest.buffer;
+    buffer.fd = dup(latest.buffer->fd);
+    DISPLAY_CHK_RETURN((buffer.fd < 0), DISPLAY_FAILURE, DISPLAY_LOGE("dup the buffer fd failed errno %{public}d", errno));
+    // the mapping belongs to this process, the client maps the fd itself
+    buffer.virAddr = nullptr;
+    buffer.reserveFds = 0;
+    buffer.reserveInts = 0;
+    if (latest.acquireFence.GetFd() >= 0) {
+        fence = dup(latest.acquireFence.GetFd());
+    }
+    mDelivered = mLatest;
+    return DISPLAY_SUCCESS;
+}
+
+int32_t HdiWriteBack::ReadBack(const BufferHandle &src, int acquireFence)
+{
+    PixelFormat srcFormat = static_cast<PixelFormat>(src.format);
+    DISPLAY_CHK_RETURN((!SoftGfx::IsSrcFormatSupported(srcFormat)), DISPLAY_NOT_SUPPORT,
+        DISPLAY_LOGE("can not read back format %{public}d", src.format));
+    uint32_t slot = 0;
+    int32_t ret = AcquireSlot(slot);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), ret, DISPLAY_LOGE("no free capture buffer"));
+    // the client may still be rendering the frame
+    ret = WaitFence(acquireFence, FENCE_TIMEOUT_MS);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), ret, DISPLAY_LOGE("the client buffer is not ready"));
+    BufferHandle *dst = mSlots[slot].buffer;
+    void *dstAddr = mGrallocFuncs->Mmap(dst);
+    DISPLAY_CHK_RETURN((dstAddr == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("can not map the capture buffer"));
+    // maps a copy, the mapping of the layer buffer is not ours to keep
+    BufferHandle srcHandle = src;
+    srcHandle.virAddr = nullptr;
+    void *srcAddr = mGrallocFuncs->Mmap(&srcHandle);
+    DISPLAY_CHK_RETURN((srcAddr == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("can not map the client buffer"));
+    mGrallocFuncs->InvalidateCache(&srcHandle);
+    SoftGfxImage srcImage;
+    srcImage.data = static_cast<uint8_t *>(srcAddr);
+    srcImage.width = src.width;
+    srcImage.height = src.height;
+    srcImage.stride = src.stride;
+    srcImage.format = srcFormat;
+    SoftGfxImage dstImage;
+    dstImage.data = static_cast<uint8_t *>(dstAddr);
+    dstImage.width = dst->width;
+    dstImage.height = dst->height;
+    dstImage.stride = dst->stride;
+    dstImage.format = mFormat;
+    IRect srcRect = { 0, 0, src.width, src.height };
+    IRect dstRect = { 0, 0, dst->width, dst->height };
+    GfxOpt opt = {};
+    opt.blendType = BLEND_SRC;
+    opt.enPixelAlpha = true;
+    ret = mSoftGfx->Blit(srcImage, srcRect, dstImage, dstRect, opt);
+    mGrallocFuncs->Unmap(&srcHandle);
+    DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), ret, DISPLAY_LOGE("read back failed %{public}d", ret));
+    mGrallocFuncs->FlushCache(dst);
+    Publish(slot, -1);
+    return DISPLAY_SUCCESS;
+}
+} // namespace OHOS
+} // namespace HDI
+} // namespace DISPLAY
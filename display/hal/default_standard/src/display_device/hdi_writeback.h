@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HDI_WRITEBACK_H
+#define HDI_WRITEBACK_H
+#include <memory>
+#include <mutex>
+#include "buffer_handle.h"
+#include "display_gfx_soft.h"
+#include "display_gralloc.h"
+#include "hdi_shared_fd.h"
+
+namespace OHOS {
+namespace HDI {
+namespace DISPLAY {
+/*
+ * The capture endpoint of a display. Every interval-th frame the display commits is captured into one of a few
+ * gralloc buffers, so the latest capture and the one the client holds stay untouched while the next is written. A capture is either written by a writeback connector, the fence of the slot then signals once the
+ * frame is in the buffer, or read back from the client buffer with the CPU.
+ */
+class HdiWriteBack {
+public:
+    static const uint32_t BUFFER_COUNT = 3;
+    HdiWriteBack(uint32_t width, uint32_t height, PixelFormat format);
+    virtual ~HdiWriteBack();
+    int32_t Init();
+    uint32_t GetWidth() const
+    {
+        return mWidth;
+    }
+    uint32_t GetHeight() const
+    {
+        return mHeight;
+    }
+    PixelFormat GetFormat() const
+    {
+        return mFormat;
+    }
+    // every frame is captured until SetWriteBackCadence sets an interval, locally or through the HDI service;
+    // 0 stops the captures, a frame is still captured on demand while there is none
+    void SetInterval(uint32_t interval);
+    // whether the next committed frame is captured, without counting it
+    bool IsFrameDue();
+    // counts a committed frame and tells whether it is captured
+    bool CountFrame();
+    // the slot the next capture goes to, it fails without waiting while the client still reads the buffer
+    int32_t AcquireSlot(uint32_t &slot);
+    BufferHandle *GetSlotBuffer(uint32_t slot);
+    // the capture in the slot is complete once the fence signals, -1 if it is complete already
+    void Publish(uint32_t slot, int fence);
+    bool HasFrame();
+    // hands out the latest capture, fence is the release fence of the capture handed out before on input
+    int32_t GetFrame(BufferHandle &buffer, int32_t &fence);
+    // copies the client buffer into a slot and publishes it
+    int32_t ReadBack(const BufferHandle &src, int acquireFence);
+    // -1 waits forever, a fd below 0 is signaled
+    static int32_t WaitFence(int fence, int timeoutMs);
+
+private:
+    struct Slot {
+        BufferHandle *buffer = nullptr;
+        HdiFd acquireFence;
+        HdiFd releaseFence;
+    };
+    uint32_t mWidth;
+    uint32_t mHeight;
+    PixelFormat mFormat;
+    GrallocFuncs *mGrallocFuncs = nullptr;
+    std::unique_ptr<SoftGfx> mSoftGfx;
+    std::mutex mMutex;
+    Slot mSlots[BUFFER_COUNT];
+    uint32_t mInterval = 1;
+    uint64_t mFrameCount = 0;
+    int32_t mLatest = -1;
+    int32_t mDelivered = -1;
+};
+} // namespace OHOS
+} // namespace HDI
+} // namespace DISPLAY
+
+#endif // HDI_WRITEBACK_H
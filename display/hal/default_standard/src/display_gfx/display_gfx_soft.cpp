@@ -0,0 +1,957 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "display_gfx_soft.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <memory>
+#include <linux/dma-buf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SOFT_GFX_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SOFT_GFX_SSE2
+#endif
+#include "display_common.h"
+
+namespace OHOS {
+namespace HDI {
+namespace DISPLAY {
+namespace {
+const uint32_t CHANNEL_MAX = 0xff;
+const uint32_t SHIFT_R = 24;
+const uint32_t SHIFT_G = 16;
+const uint32_t SHIFT_B = 8;
+const uint32_t MAX_THREADS = 4;
+// below this many pixels handing out tiles costs more than composing them on the calling thread
+const int64_t PARALLEL_MIN_PIXELS = 256 * 256;
+const int32_t BAND_ROWS = 32;
+// a rotated blit reads the source by columns, square tiles keep those columns in the cache
+const int32_t ROTATE_TILE = 64;
+
+struct BlitPlan {
+    const SoftGfxImage *src;
+    const SoftGfxImage *dst;
+    GfxOpt opt;
+    IRect clip;
+    // the source column or, when transposed, the source row of every destination column of the clip
+    std::vector<int32_t> colMap;
+    // the source row or, when transposed, the source column of every destination row of the clip
+    std::vector<int32_t> rowMap;
+    bool transposed;
+    bool identity;
+    bool opaque;
+    uint32_t globalAlpha;
+};
+
+// exact rounding of x / 255 for x up to 255 * 255
+inline uint32_t Div255(uint32_t x)
+{
+    x += 0x80;
+    return (x + (x >> SHIFT_B)) >> SHIFT_B;
+}
+
+inline uint32_t PackRgba(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+    return (r << SHIFT_R) | (g << SHIFT_G) | (b << SHIFT_B) | a;
+}
+
+inline uint32_t SwapRb(uint32_t c)
+{
+    return (c & 0x00ff00ff) | ((c >> SHIFT_G) & 0xff00) | ((c & 0xff00) << SHIFT_G);
+}
+
+inline uint32_t Clamp255(int32_t v)
+{
+    return static_cast<uint32_t>(std::min(std::max(v, 0), static_cast<int32_t>(CHANNEL_MAX)));
+}
+
+// BT.601 limited range
+inline uint32_t YuvToRgba(int32_t y, int32_t u, int32_t v)
+{
+    const int32_t yOffset = 16;
+    const int32_t uvOffset = 128;
+    const int32_t round = 128;
+    int32_t c = 298 * (y - yOffset) + round; // 298: 1.164 in 8 bit fixed point
+    int32_t d = u - uvOffset;
+    int32_t e = v - uvOffset;
+    return PackRgba(Clamp255((c + 409 * e) >> SHIFT_B), Clamp255((c - 100 * d - 208 * e) >> SHIFT_B), // 409 100 208
+        Clamp255((c + 516 * d) >> SHIFT_B), CHANNEL_MAX); // 516: the cb weight
+}
+
+// the 565 layout of PIXEL_FMT_BGR_565 is DRM_FORMAT_RGB565, red in the high bits, as the gbm allocator maps it
+inline uint32_t Expand565(uint16_t p, bool redHigh)
+{
+    const uint32_t hiShift = 11;
+    const uint32_t midShift = 5;
+    uint32_t hi = (p >> hiShift) & 0x1f;
+    uint32_t mid = (p >> midShift) & 0x3f;
+    uint32_t lo = p & 0x1f;
+    hi = (hi << 3) | (hi >> 2); // 3 2: replicate the top bits of 5 bit channels
+    mid = (mid << 2) | (mid >> 4); // 2 4: replicate the top bits of the 6 bit channel
+    lo = (lo << 3) | (lo >> 2);
+    return redHigh ? PackRgba(hi, mid, lo, CHANNEL_MAX) : PackRgba(lo, mid, hi, CHANNEL_MAX);
+}
+
+inline uint16_t Pack565(uint32_t c, bool redHigh)
+{
+    uint32_t r = (c >> SHIFT_R) & CHANNEL_MAX;
+    uint32_t g = (c >> SHIFT_G) & CHANNEL_MAX;
+    uint32_t b = (c >> SHIFT_B) & CHANNEL_MAX;
+    uint32_t hi = redHigh ? r : b;
+    uint32_t lo = redHigh ? b : r;
+    return static_cast<uint16_t>(((hi >> 3) << 11) | ((g >> 2) << 5) | (lo >> 3)); // 3 11 2 5: 565 packing
+}
+
+inline const uint8_t *PixelRow(const SoftGfxImage &image, int32_t y)
+{
+    return image.data + static_cast<int64_t>(y) * image.stride;
+}
+
+inline uint8_t *PixelRow(const SoftGfxImage &image, int32_t y, int32_t x, int32_t bytes)
+{
+    return image.data + static_cast<int64_t>(y) * image.stride + static_cast<int64_t>(x) * bytes;
+}
+
+template <PixelFormat F>
+inline uint32_t LoadPixel(const SoftGfxImage &image, int32_t x, int32_t y)
+{
+    const uint8_t *row = PixelRow(image, y);
+    switch (F) {
+        case PIXEL_FMT_RGBA_8888:
+            return reinterpret_cast<const uint32_t *>(row)[x];
+        case PIXEL_FMT_RGBX_8888:
+            return reinterpret_cast<const uint32_t *>(row)[x] | CHANNEL_MAX;
+        case PIXEL_FMT_BGRA_8888:
+            return SwapRb(reinterpret_cast<const uint32_t *>(row)[x]);
+        case PIXEL_FMT_BGRX_8888:
+            return SwapRb(reinterpret_cast<const uint32_t *>(row)[x]) | CHANNEL_MAX;
+        case PIXEL_FMT_BGR_565:
+            return Expand565(reinterpret_cast<const uint16_t *>(row)[x], true);
+        case PIXEL_FMT_RGB_565:
+            return Expand565(reinterpret_cast<const uint16_t *>(row)[x], false);
+        default: {
+            // semi-planar 4:2:0, one CbCr pair for every 2x2 luma block
+            const uint8_t *uv = image.chroma + static_cast<int64_t>(y >> 1) * image.chromaStride + (x & ~1);
+            bool crFirst = (F == PIXEL_FMT_YCRCB_420_SP);
+            return YuvToRgba(row[x], uv[crFirst ? 1 : 0], uv[crFirst ? 0 : 1]);
+        }
+    }
+}
+
+template <PixelFormat F>
+void FetchRowT(const SoftGfxImage &src, int32_t fixed, const int32_t *map, int32_t count, bool transposed,
+    uint32_t *out)
+{
+    if (transposed) {
+        for (int32_t i = 0; i < count; i++) {
+            out[i] = LoadPixel<F>(src, fixed, map[i]);
+        }
+    } else {
+        for (int32_t i = 0; i < count; i++) {
+            out[i] = LoadPixel<F>(src, map[i], fixed);
+        }
+    }
+}
+
+void FetchRow(const SoftGfxImage &src, int32_t fixed, const int32_t *map, int32_t count, bool transposed,
+    uint32_t *out)
+{
+    switch (src.format) {
+        case PIXEL_FMT_RGBA_8888:
+            FetchRowT<PIXEL_FMT_RGBA_8888>(src, fixed, map, count, transposed, out);
+            break;
+        case PIXEL_FMT_RGBX_8888:
+            FetchRowT<PIXEL_FMT_RGBX_8888>(src, fixed, map, count, transposed, out);
+            break;
+        case PIXEL_FMT_BGRA_8888:
+            FetchRowT<PIXEL_FMT_BGRA_8888>(src, fixed, map, count, transposed, out);
+            break;
+        case PIXEL_FMT_BGRX_8888:
+            FetchRowT<PIXEL_FMT_BGRX_8888>(src, fixed, map, count, transposed, out);
+            break;
+        case PIXEL_FMT_BGR_565:
+            FetchRowT<PIXEL_FMT_BGR_565>(src, fixed, map, count, transposed, out);
+            break;
+        case PIXEL_FMT_RGB_565:
+            FetchRowT<PIXEL_FMT_RGB_565>(src, fixed, map, count, transposed, out);
+            break;
+        case PIXEL_FMT_YCBCR_420_SP:
+            FetchRowT<PIXEL_FMT_YCBCR_420_SP>(src, fixed, map, count, transposed, out);
+            break;
+        default:
+            FetchRowT<PIXEL_FMT_YCRCB_420_SP>(src, fixed, map, count, transposed, out);
+            break;
+    }
+}
+
+inline int32_t GetPixelBytes(PixelFormat format)
+{
+    const int32_t bytes565 = 2;
+    const int32_t bytes8888 = 4;
+    return ((format == PIXEL_FMT_RGB_565) || (format == PIXEL_FMT_BGR_565)) ? bytes565 : bytes8888;
+}
+
+// converts a row of a destination format into colors and back, the rgba format is used in place instead
+void LoadRow(const SoftGfxImage &dst, int32_t x, int32_t y, int32_t count, uint32_t *out)
+{
+    const uint8_t *row = PixelRow(dst, y, x, GetPixelBytes(dst.format));
+    const uint32_t *row32 = reinterpret_cast<const uint32_t *>(row);
+    const uint16_t *row16 = reinterpret_cast<const uint16_t *>(row);
+    for (int32_t i = 0; i < count; i++) {
+        switch (dst.format) {
+            case PIXEL_FMT_RGBX_8888:
+                out[i] = row32[i] | CHANNEL_MAX;
+                break;
+            case PIXEL_FMT_BGRA_8888:
+                out[i] = SwapRb(row32[i]);
+                break;
+            case PIXEL_FMT_BGRX_8888:
+                out[i] = SwapRb(row32[i]) | CHANNEL_MAX;
+                break;
+            case PIXEL_FMT_BGR_565:
+                out[i] = Expand565(row16[i], true);
+                break;
+            case PIXEL_FMT_RGB_565:
+                out[i] = Expand565(row16[i], false);
+                break;
+            default:
+                out[i] = row32[i];
+                break;
+        }
+    }
+}
+
+inline uint32_t ConvertColor(PixelFormat format, uint32_t c)
+{
+    switch (format) {
+        case PIXEL_FMT_BGRA_8888:
+        case PIXEL_FMT_BGRX_8888:
+            return SwapRb(c);
+        case PIXEL_FMT_BGR_565:
+            return Pack565(c, true);
+        case PIXEL_FMT_RGB_565:
+            return Pack565(c, false);
+        default:
+            return c;
+    }
+}
+
+void StoreRow(const SoftGfxImage &dst, int32_t x, int32_t y, int32_t count, const uint32_t *in)
+{
+    uint8_t *row = PixelRow(dst, y, x, GetPixelBytes(dst.format));
+    if (GetPixelBytes(dst.format) == sizeof(uint16_t)) {
+        uint16_t *row16 = reinterpret_cast<uint16_t *>(row);
+        for (int32_t i = 0; i < count; i++) {
+            row16[i] = static_cast<uint16_t>(ConvertColor(dst.format, in[i]));
+        }
+    } else {
+        uint32_t *row32 = reinterpret_cast<uint32_t *>(row);
+        for (int32_t i = 0; i < count; i++) {
+            row32[i] = ConvertColor(dst.format, in[i]);
+        }
+    }
+}
+
+template <BlendType T>
+inline uint32_t BlendChannel(uint32_t sc, uint32_t sa, uint32_t dc, uint32_t da)
+{
+    switch (T) {
+        case BLEND_NONE:
+        case BLEND_SRCOVER:
+            return Div255(sc * sa + dc * (CHANNEL_MAX - sa));
+        case BLEND_DSTOVER:
+            return Div255(dc * da + sc * (CHANNEL_MAX - da));
+        case BLEND_SRCIN:
+            return Div255(sc * da);
+        case BLEND_DSTIN:
+            return Div255(dc * sa);
+        case BLEND_SRCOUT:
+            return Div255(sc * (CHANNEL_MAX - da));
+        case BLEND_DSTOUT:
+            return Div255(dc * (CHANNEL_MAX - sa));
+        case BLEND_SRCATOP:
+            return Div255(sc * da + dc * (CHANNEL_MAX - sa));
+        case BLEND_DSTATOP:
+            return Div255(dc * sa + sc * (CHANNEL_MAX - da));
+        case BLEND_XOR:
+            return Div255(sc * (CHANNEL_MAX - da) + dc * (CHANNEL_MAX - sa));
+        case BLEND_ADD:
+            return std::min(sc + dc, CHANNEL_MAX);
+        default:
+            return 0;
+    }
+}
+
+template <BlendType T>
+inline uint32_t BlendAlpha(uint32_t sa, uint32_t da)
+{
+    switch (T) {
+        case BLEND_NONE:
+            return Div255(sa * sa + da * (CHANNEL_MAX - sa));
+        case BLEND_SRCOVER:
+            return Div255(sa * CHANNEL_MAX + da * (CHANNEL_MAX - sa));
+        case BLEND_DSTOVER:
+            return Div255(da * CHANNEL_MAX + sa * (CHANNEL_MAX - da));
+        case BLEND_SRCIN:
+        case BLEND_DSTIN:
+            return Div255(sa * da);
+        case BLEND_SRCOUT:
+            return Div255(sa * (CHANNEL_MAX - da));
+        case BLEND_DSTOUT:
+            return Div255(da * (CHANNEL_MAX - sa));
+        case BLEND_SRCATOP:
+            return da;
+        case BLEND_DSTATOP:
+            return sa;
+        case BLEND_XOR:
+            return Div255(sa * (CHANNEL_MAX - da) + da * (CHANNEL_MAX - sa));
+        case BLEND_ADD:
+            return std::min(sa + da, CHANNEL_MAX);
+        default:
+            return 0;
+    }
+}
+
+template <BlendType T>
+inline uint32_t BlendPixel(uint32_t s, uint32_t d)
+{
+    uint32_t sa = s & CHANNEL_MAX;
+    uint32_t da = d & CHANNEL_MAX;
+    uint32_t out = BlendAlpha<T>(sa, da);
+    for (uint32_t shift = SHIFT_B; shift <= SHIFT_R; shift += SHIFT_B) {
+        out |= BlendChannel<T>((s >> shift) & CHANNEL_MAX, sa, (d >> shift) & CHANNEL_MAX, da) << shift;
+    }
+    return out;
+}
+
+template <BlendType T>
+void BlendRowT(const uint32_t *src, uint32_t *dst, int32_t count)
+{
+    for (int32_t i = 0; i < count; i++) {
+        dst[i] = BlendPixel<T>(src[i], dst[i]);
+    }
+}
+
+/*
+ * NONE and SRCOVER, the blends of every composed layer, four pixels at a time. The color channels are
+ * (s * sa + d * (255 - sa)) / 255, the alpha is weighted by sa for NONE and by 255 for SRCOVER.
+ */
+void BlendOverRow(const uint32_t *src, uint32_t *dst, int32_t count, bool srcOver)
+{
+    const int32_t lanes = 4;
+    int32_t i = 0;
+#if defined(SOFT_GFX_SSE2)
+    const __m128i alphaMask = _mm_set1_epi32(CHANNEL_MAX);
+    const __m128i ones = _mm_set1_epi32(-1);
+    const __m128i round = _mm_set1_epi16(0x80);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i srcAlphaWeight = srcOver ? alphaMask : zero;
+    for (; i + lanes <= count; i += lanes) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i sa = _mm_and_si128(s, alphaMask);
+        sa = _mm_or_si128(sa, _mm_slli_epi32(sa, SHIFT_B));
+        sa = _mm_or_si128(sa, _mm_slli_epi32(sa, SHIFT_G));
+        __m128i weight = _mm_or_si128(sa, srcAlphaWeight);
+        __m128i inv = _mm_xor_si128(sa, ones);
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(weight, zero)),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(inv, zero)));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(weight, zero)),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(inv, zero)));
+        lo = _mm_add_epi16(lo, round);
+        hi = _mm_add_epi16(hi, round);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, SHIFT_B)), SHIFT_B);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, SHIFT_B)), SHIFT_B);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(SOFT_GFX_NEON)
+    const uint32x4_t alphaMask = vdupq_n_u32(CHANNEL_MAX);
+    const uint16x8_t round = vdupq_n_u16(0x80);
+    const uint8x16_t srcAlphaWeight = vreinterpretq_u8_u32(srcOver ? alphaMask : vdupq_n_u32(0));
+    for (; i + lanes <= count; i += lanes) {
+        uint32x4_t s = vld1q_u32(src + i);
+        uint32x4_t d = vld1q_u32(dst + i);
+        uint8x16_t sa = vreinterpretq_u8_u32(vmulq_n_u32(vandq_u32(s, alphaMask), 0x01010101));
+        uint8x16_t weight = vorrq_u8(sa, srcAlphaWeight);
+        uint8x16_t inv = vmvnq_u8(sa);
+        uint8x16_t s8 = vreinterpretq_u8_u32(s);
+        uint8x16_t d8 = vreinterpretq_u8_u32(d);
+        uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(s8), vget_low_u8(weight)), vget_low_u8(d8), vget_low_u8(inv));
+        uint16x8_t hi =
+            vmlal_u8(vmull_u8(vget_high_u8(s8), vget_high_u8(weight)), vget_high_u8(d8), vget_high_u8(inv));
+        lo = vaddq_u16(lo, round);
+        hi = vaddq_u16(hi, round);
+        uint8x16_t out = vcombine_u8(vshrn_n_u16(vsraq_n_u16(lo, lo, SHIFT_B), SHIFT_B),
+            vshrn_n_u16(vsraq_n_u16(hi, hi, SHIFT_B), SHIFT_B));
+        vst1q_u32(dst + i, vreinterpretq_u32_u8(out));
+    }
+#endif
+    if (srcOver) {
+        BlendRowT<BLEND_SRCOVER>(src + i, dst + i, count - i);
+    } else {
+        BlendRowT<BLEND_NONE>(src + i, dst + i, count - i);
+    }
+}
+
+void BlendRow(BlendType type, const uint32_t *src, uint32_t *dst, int32_t count)
+{
+    switch (type) {
+        case BLEND_NONE:
+            BlendOverRow(src, dst, count, false);
+            break;
+        case BLEND_SRCOVER:
+            BlendOverRow(src, dst, count, true);
+            break;
+        case BLEND_SRC:
+            std::copy(src, src + count, dst);
+            break;
+        case BLEND_CLEAR:
+            std::fill(dst, dst + count, 0);
+            break;
+        case BLEND_DSTOVER:
+            BlendRowT<BLEND_DSTOVER>(src, dst, count);
+            break;
+        case BLEND_SRCIN:
+            BlendRowT<BLEND_SRCIN>(src, dst, count);
+            break;
+        case BLEND_DSTIN:
+            BlendRowT<BLEND_DSTIN>(src, dst, count);
+            break;
+        case BLEND_SRCOUT:
+            BlendRowT<BLEND_SRCOUT>(src, dst, count);
+            break;
+        case BLEND_DSTOUT:
+            BlendRowT<BLEND_DSTOUT>(src, dst, count);
+            break;
+        case BLEND_SRCATOP:
+            BlendRowT<BLEND_SRCATOP>(src, dst, count);
+            break;
+        case BLEND_DSTATOP:
+            BlendRowT<BLEND_DSTATOP>(src, dst, count);
+            break;
+        case BLEND_XOR:
+            BlendRowT<BLEND_XOR>(src, dst, count);
+            break;
+        case BLEND_ADD:
+            BlendRowT<BLEND_ADD>(src, dst, count);
+            break;
+        default:
+            break;
+    }
+}
+
+void ApplySrcAlpha(uint32_t *row, int32_t count, bool opaque, uint32_t globalAlpha)
+{
+    for (int32_t i = 0; i < count; i++) {
+        uint32_t a = opaque ? CHANNEL_MAX : (row[i] & CHANNEL_MAX);
+        row[i] = (row[i] & ~CHANNEL_MAX) | Div255(a * globalAlpha);
+    }
+}
+
+bool IsBlendSupported(BlendType type)
+{
+    return (type >= BLEND_NONE) && (type <= BLEND_DST) && (type != BLEND_AKS) && (type != BLEND_AKD);
+}
+
+bool IntersectRect(const IRect &a, const IRect &b, IRect &out)
+{
+    int64_t left = std::max(a.x, b.x);
+    int64_t top = std::max(a.y, b.y);
+    int64_t right = std::min(static_cast<int64_t>(a.x) + a.w, static_cast<int64_t>(b.x) + b.w);
+    int64_t bottom = std::min(static_cast<int64_t>(a.y) + a.h, static_cast<int64_t>(b.y) + b.h);
+    if ((right <= left) || (bottom <= top)) {
+        return false;
+    }
+    out = { static_cast<int32_t>(left), static_cast<int32_t>(top), static_cast<int32_t>(right - left),
+        static_cast<int32_t>(bottom - top) };
+    return true;
+}
+
+bool IsRectInside(const IRect &rect, const SoftGfxImage &image)
+{
+    return (rect.x >= 0) && (rect.y >= 0) && (rect.w > 0) && (rect.h > 0) && (rect.w <= image.width - rect.x) &&
+        (rect.h <= image.height - rect.y);
+}
+
+bool IsImageValid(const SoftGfxImage &image)
+{
+    bool semiPlanar = (image.format == PIXEL_FMT_YCBCR_420_SP) || (image.format == PIXEL_FMT_YCRCB_420_SP);
+    return (image.data != nullptr) && (image.width > 0) && (image.height > 0) && (image.stride > 0) &&
+        (!semiPlanar || ((image.chroma != nullptr) && (image.chromaStride > 0)));
+}
+
+// the centers of count destination pixels sampled from size source pixels, mirrored when asked
+void BuildSampleMap(int32_t count, int32_t size, bool mirror, std::vector<int32_t> &map)
+{
+    map.resize(count);
+    for (int32_t i = 0; i < count; i++) {
+        int32_t pos = static_cast<int32_t>((2 * static_cast<int64_t>(i) + 1) * size / (2 * static_cast<int64_t>(count)));
+        map[i] = mirror ? (size - 1 - pos) : pos;
+    }
+}
+
+/*
+ * Maps the destination onto the source. u and v walk the source as the destination sees it after the rotation,
+ * 90 degrees turns the source clockwise so the destination column u is the source row h - 1 - u.
+ */
+void BuildPlan(const IRect &srcRect, const IRect &dstRect, BlitPlan &plan)
+{
+    TransformType rotate = plan.opt.rotateType;
+    plan.transposed = (rotate == ROTATE_90) || (rotate == ROTATE_270);
+    int32_t rotatedW = plan.transposed ? srcRect.h : srcRect.w;
+    int32_t rotatedH = plan.transposed ? srcRect.w : srcRect.h;
+    std::vector<int32_t> uMap;
+    std::vector<int32_t> vMap;
+    BuildSampleMap(dstRect.w, rotatedW, plan.opt.mirrorType == MIRROR_LR, uMap);
+    BuildSampleMap(dstRect.h, rotatedH, plan.opt.mirrorType == MIRROR_TB, vMap);
+    int32_t offsetX = plan.clip.x - dstRect.x;
+    int32_t offsetY = plan.clip.y - dstRect.y;
+    plan.colMap.resize(plan.clip.w);
+    plan.rowMap.resize(plan.clip.h);
+    for (int32_t i = 0; i < plan.clip.w; i++) {
+        int32_t u = uMap[offsetX + i];
+        switch (rotate) {
+            case ROTATE_90:
+                plan.colMap[i] = srcRect.y + srcRect.h - 1 - u;
+                break;
+            case ROTATE_180:
+                plan.colMap[i] = srcRect.x + srcRect.w - 1 - u;
+                break;
+            case ROTATE_270:
+                plan.colMap[i] = srcRect.y + u;
+                break;
+            default:
+                plan.colMap[i] = srcRect.x + u;
+                break;
+        }
+    }
+    for (int32_t j = 0; j < plan.clip.h; j++) {
+        int32_t v = vMap[offsetY + j];
+        switch (rotate) {
+            case ROTATE_90:
+                plan.rowMap[j] = srcRect.x + v;
+                break;
+            case ROTATE_180:
+                plan.rowMap[j] = srcRect.y + srcRect.h - 1 - v;
+                break;
+            case ROTATE_270:
+                plan.rowMap[j] = srcRect.x + srcRect.w - 1 - v;
+                break;
+            default:
+                plan.rowMap[j] = srcRect.y + v;
+                break;
+        }
+    }
+    plan.identity = (rotate == ROTATE_NONE) && (plan.opt.mirrorType != MIRROR_LR) &&
+        (plan.opt.mirrorType != MIRROR_TB) && (srcRect.w == dstRect.w) && (srcRect.h == dstRect.h);
+}
+
+void ComposeRow(const BlitPlan &plan, int32_t row, int32_t col, int32_t count, std::vector<uint32_t> &srcBuf,
+    std::vector<uint32_t> &dstBuf)
+{
+    const SoftGfxImage &src = *plan.src;
+    const SoftGfxImage &dst = *plan.dst;
+    BlendType blend = plan.opt.blendType;
+    bool alphaPass = plan.opaque || (plan.globalAlpha != CHANNEL_MAX);
+    const uint32_t *srcRow = nullptr;
+    if (plan.identity && (src.format == PIXEL_FMT_RGBA_8888) && !alphaPass) {
+        srcRow = reinterpret_cast<const uint32_t *>(PixelRow(src, plan.rowMap[row])) + plan.colMap[col];
+    } else {
+        srcBuf.resize(count);
+        FetchRow(src, plan.rowMap[row], plan.colMap.data() + col, count, plan.transposed, srcBuf.data());
+        if (alphaPass) {
+            ApplySrcAlpha(srcBuf.data(), count, plan.opaque, plan.globalAlpha);
+        }
+        srcRow = srcBuf.data();
+    }
+    int32_t x = plan.clip.x + col;
+    int32_t y = plan.clip.y + row;
+    if (dst.format == PIXEL_FMT_RGBA_8888) {
+        BlendRow(blend, srcRow, reinterpret_cast<uint32_t *>(PixelRow(dst, y, x, sizeof(uint32_t))), count);
+        return;
+    }
+    dstBuf.resize(count);
+    if ((blend != BLEND_SRC) && (blend != BLEND_CLEAR)) {
+        LoadRow(dst, x, y, count, dstBuf.data());
+    }
+    BlendRow(blend, srcRow, dstBuf.data(), count);
+    StoreRow(dst, x, y, count, dstBuf.data());
+}
+
+void FillRow(const SoftGfxImage &dst, int32_t x, int32_t y, int32_t count, uint32_t value)
+{
+    if (GetPixelBytes(dst.format) == sizeof(uint16_t)) {
+        uint16_t *row = reinterpret_cast<uint16_t *>(PixelRow(dst, y, x, sizeof(uint16_t)));
+        std::fill(row, row + count, static_cast<uint16_t>(value));
+    } else {
+        uint32_t *row = reinterpret_cast<uint32_t *>(PixelRow(dst, y, x, sizeof(uint32_t)));
+        std::fill(row, row + count, value);
+    }
+}
+} // namespace
+
+SoftGfx::SoftGfx(uint32_t threads)
+{
+    for (uint32_t i = 0; i < threads; i++) {
+        mThreads.emplace_back([this] { WorkerLoop(); });
+    }
+    DISPLAY_LOGI("soft gfx with %{public}u workers", threads);
+}
+
+SoftGfx::~SoftGfx()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWorkCond.notify_all();
+    for (auto &thread : mThreads) {
+        thread.join();
+    }
+}
+
+uint32_t SoftGfx::GetDefaultThreads()
+{
+    uint32_t cores = std::thread::hardware_concurrency();
+    return (cores > 1) ? std::min(cores - 1, MAX_THREADS) : 0;
+}
+
+bool SoftGfx::IsSrcFormatSupported(PixelFormat format)
+{
+    return IsDstFormatSupported(format) || (format == PIXEL_FMT_YCBCR_420_SP) ||
+        (format == PIXEL_FMT_YCRCB_420_SP);
+}
+
+bool SoftGfx::IsDstFormatSupported(PixelFormat format)
+{
+    switch (format) {
+        case PIXEL_FMT_RGBA_8888:
+        case PIXEL_FMT_RGBX_8888:
+        case PIXEL_FMT_BGRA_8888:
+        case PIXEL_FMT_BGRX_8888:
+        case PIXEL_FMT_RGB_565:
+        case PIXEL_FMT_BGR_565:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void SoftGfx::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mWorkCond.wait(lock, [this] { return mStop || ((mTask != nullptr) && (mNextTile < mTileCount)); });
+        if (mStop) {
+            return;
+        }
+        const std::function<void(uint32_t)> *task = mTask;
+        uint32_t tile = mNextTile++;
+        lock.unlock();
+        (*task)(tile);
+        lock.lock();
+        if (++mDoneTiles == mTileCount) {
+            mDoneCond.notify_all();
+        }
+    }
+}
+
+void SoftGfx::RunTiles(uint32_t count, const std::function<void(uint32_t)> &task)
+{
+    if (mThreads.empty() || (count <= 1)) {
+        for (uint32_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> runLock(mRunMutex);
+    std::unique_lock<std::mutex> lock(mMutex);
+    mTask = &task;
+    mTileCount = count;
+    mNextTile = 0;
+    mDoneTiles = 0;
+    mWorkCond.notify_all();
+    // the calling thread takes tiles as well rather than waiting idle
+    while (mNextTile < mTileCount) {
+        uint32_t tile = mNextTile++;
+        lock.unlock();
+        task(tile);
+        lock.lock();
+        mDoneTiles++;
+    }
+    mDoneCond.wait(lock, [this] { return mDoneTiles == mTileCount; });
+    mTask = nullptr;
+}
+
+int32_t SoftGfx::Blit(const SoftGfxImage &src, const IRect &srcRect, const SoftGfxImage &dst, const IRect &dstRect,
+    const GfxOpt &opt)
+{
+    DISPLAY_CHK_RETURN(!IsImageValid(src) || !IsImageValid(dst), DISPLAY_PARAM_ERR,
+        DISPLAY_LOGE("invalid src or dst image"));
+    DISPLAY_CHK_RETURN(!IsSrcFormatSupported(src.format) || !IsDstFormatSupported(dst.format), DISPLAY_NOT_SUPPORT,
+        DISPLAY_LOGE("can not blit format %{public}d to %{public}d", src.format, dst.format));
+    DISPLAY_CHK_RETURN(!IsBlendSupported(opt.blendType) || (opt.rotateType >= ROTATE_BUTT), DISPLAY_NOT_SUPPORT,
+        DISPLAY_LOGE("not support blend %{public}d rotate %{public}d", opt.blendType, opt.rotateType));
+    DISPLAY_CHK_RETURN(!IsRectInside(srcRect, src) || (dstRect.w <= 0) || (dstRect.h <= 0), DISPLAY_PARAM_ERR,
+        DISPLAY_LOGE("invalid src rect x:%{public}d y:%{public}d w:%{public}d h:%{public}d", srcRect.x, srcRect.y,
+        srcRect.w, srcRect.h));
+    BlitPlan plan;
+    plan.src = &src;
+    plan.dst = &dst;
+    plan.opt = opt;
+    // the part of the destination rect out of the surface is not drawn, the scaling still follows the whole rect
+    if ((opt.blendType == BLEND_DST) || !IntersectRect(dstRect, { 0, 0, dst.width, dst.height }, plan.clip)) {
+        return DISPLAY_SUCCESS;
+    }
+    // BLEND_SRC copies the source alpha as it is, the other blends take a source without pixel alpha as opaque
+    plan.opaque = !opt.enPixelAlpha && (opt.blendType != BLEND_SRC);
+    plan.globalAlpha = opt.enGlobalAlpha ? (opt.globalAlpha & CHANNEL_MAX) : CHANNEL_MAX;
+    BuildPlan(srcRect, dstRect, plan);
+
+    int32_t tileW = plan.transposed ? ROTATE_TILE : plan.clip.w;
+    int32_t tileH = plan.transposed ? ROTATE_TILE : BAND_ROWS;
+    if (static_cast<int64_t>(plan.clip.w) * plan.clip.h < PARALLEL_MIN_PIXELS) {
+        tileW = plan.clip.w;
+        tileH = plan.clip.h;
+    }
+    uint32_t columns = static_cast<uint32_t>((plan.clip.w + tileW - 1) / tileW);
+    uint32_t rows = static_cast<uint32_t>((plan.clip.h + tileH - 1) / tileH);
+    RunTiles(columns * rows, [&plan, columns, tileW, tileH](uint32_t tile) {
+        std::vector<uint32_t> srcBuf;
+        std::vector<uint32_t> dstBuf;
+        int32_t col = static_cast<int32_t>(tile % columns) * tileW;
+        int32_t row = static_cast<int32_t>(tile / columns) * tileH;
+        int32_t count = std::min(tileW, plan.clip.w - col);
+        int32_t rowEnd = std::min(row + tileH, plan.clip.h);
+        for (; row < rowEnd; row++) {
+            ComposeRow(plan, row, col, count, srcBuf, dstBuf);
+        }
+    });
+    return DISPLAY_SUCCESS;
+}
+
+int32_t SoftGfx::Fill(const SoftGfxImage &dst, const IRect &rect, uint32_t color, const GfxOpt &opt)
+{
+    DISPLAY_CHK_RETURN(!IsImageValid(dst), DISPLAY_PARAM_ERR, DISPLAY_LOGE("invalid dst image"));
+    DISPLAY_CHK_RETURN(!IsDstFormatSupported(dst.format), DISPLAY_NOT_SUPPORT,
+        DISPLAY_LOGE("can not fill format %{public}d", dst.format));
+    DISPLAY_CHK_RETURN(!IsBlendSupported(opt.blendType), DISPLAY_NOT_SUPPORT,
+        DISPLAY_LOGE("not support blend %{public}d", opt.blendType));
+    IRect clip;
+    if ((opt.blendType == BLEND_DST) || !IntersectRect(rect, { 0, 0, dst.width, dst.height }, clip)) {
+        return DISPLAY_SUCCESS;
+    }
+    // a fill without blending writes the color, the other blends treat it as a source of that color
+    bool plain = (opt.blendType == BLEND_NONE) || (opt.blendType == BLEND_SRC);
+    uint32_t source = color;
+    if (!plain) {
+        uint32_t globalAlpha = opt.enGlobalAlpha ? (opt.globalAlpha & CHANNEL_MAX) : CHANNEL_MAX;
+        ApplySrcAlpha(&source, 1, !opt.enPixelAlpha, globalAlpha);
+    }
+    uint32_t value = ConvertColor(dst.format, color);
+    uint32_t rows = static_cast<uint32_t>((clip.h + BAND_ROWS - 1) / BAND_ROWS);
+    if (static_cast<int64_t>(clip.w) * clip.h < PARALLEL_MIN_PIXELS) {
+        rows = 1;
+    }
+    int32_t bandRows = (clip.h + static_cast<int32_t>(rows) - 1) / static_cast<int32_t>(rows);
+    RunTiles(rows, [&dst, &opt, &clip, plain, source, value, bandRows](uint32_t tile) {
+        std::vector<uint32_t> srcBuf;
+        std::vector<uint32_t> dstBuf;
+        int32_t y = clip.y + static_cast<int32_t>(tile) * bandRows;
+        int32_t yEnd = std::min(y + bandRows, clip.y + clip.h);
+        for (; y < yEnd; y++) {
+            if (plain) {
+                FillRow(dst, clip.x, y, clip.w, value);
+                continue;
+            }
+            srcBuf.assign(clip.w, source);
+            dstBuf.resize(clip.w);
+            LoadRow(dst, clip.x, y, clip.w, dstBuf.data());
+            BlendRow(opt.blendType, srcBuf.data(), dstBuf.data(), clip.w);
+            StoreRow(dst, clip.x, y, clip.w, dstBuf.data());
+        }
+    });
+    return DISPLAY_SUCCESS;
+}
+
+namespace {
+std::mutex g_softGfxMutex;
+std::unique_ptr<SoftGfx> g_softGfx;
+uint32_t g_softGfxRefs = 0;
+
+class SurfaceMapping {
+public:
+    SurfaceMapping(const ISurface &surface, bool write) : mWrite(write)
+    {
+        DISPLAY_CHK_RETURN_NOT_VALUE((surface.phyAddr > INT_MAX) || (surface.width <= 0) || (surface.height <= 0) ||
+            (surface.stride <= 0), DISPLAY_LOGE("the surface is not a dma-buf the cpu can map"));
+        mFd = static_cast<int>(surface.phyAddr);
+        mImage.width = surface.width;
+        mImage.height = surface.height;
+        mImage.stride = surface.stride;
+        mImage.format = surface.enColorFmt;
+        mSize = static_cast<size_t>(surface.stride) * static_cast<size_t>(surface.height);
+        size_t chromaOffset = mSize;
+        if ((surface.enColorFmt == PIXEL_FMT_YCBCR_420_SP) || (surface.enColorFmt == PIXEL_FMT_YCRCB_420_SP)) {
+            // the CbCr plane follows the luma in the same buffer
+            mImage.chromaStride = (surface.cbcrStride > 0) ? surface.cbcrStride : surface.stride;
+            mSize += static_cast<size_t>(mImage.chromaStride) * static_cast<size_t>((surface.height + 1) / 2);
+        }
+        void *addr = mmap(nullptr, mSize, write ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, mFd, 0);
+        DISPLAY_CHK_RETURN_NOT_VALUE((addr == MAP_FAILED), DISPLAY_LOGE("mmap fd %{public}d failed %{public}d", mFd,
+            errno));
+        mAddr = addr;
+        mImage.data = static_cast<uint8_t *>(addr);
+        if (mImage.chromaStride > 0) {
+            mImage.chroma = mImage.data + chromaOffset;
+        }
+        Sync(DMA_BUF_SYNC_START);
+    }
+
+    virtual ~SurfaceMapping()
+    {
+        if (mAddr != nullptr) {
+            Sync(DMA_BUF_SYNC_END);
+            munmap(mAddr, mSize);
+        }
+    }
+
+    const SoftGfxImage &GetImage() const
+    {
+        return mImage;
+    }
+
+private:
+    // keeps the cpu view coherent with the devices, buffers that are not dma-bufs do not need it
+    void Sync(uint64_t flags)
+    {
+        struct dma_buf_sync sync = { flags | (mWrite ? DMA_BUF_SYNC_RW : DMA_BUF_SYNC_READ) };
+        (void)ioctl(mFd, DMA_BUF_IOCTL_SYNC, &sync);
+    }
+    int mFd = -1;
+    bool mWrite = false;
+    void *mAddr = nullptr;
+    size_t mSize = 0;
+    SoftGfxImage mImage;
+};
+
+int32_t SoftInitGfx(void)
+{
+    std::lock_guard<std::mutex> lock(g_softGfxMutex);
+    if (g_softGfx == nullptr) {
+        g_softGfx = std::make_unique<SoftGfx>(SoftGfx::GetDefaultThreads());
+    }
+    g_softGfxRefs++;
+    return DISPLAY_SUCCESS;
+}
+
+int32_t SoftDeinitGfx(void)
+{
+    std::lock_guard<std::mutex> lock(g_softGfxMutex);
+    DISPLAY_CHK_RETURN((g_softGfxRefs == 0), DISPLAY_FAILURE, DISPLAY_LOGE("the soft gfx is not initialized"));
+    if (--g_softGfxRefs == 0) {
+        g_softGfx = nullptr;
+    }
+    return DISPLAY_SUCCESS;
+}
+
+int32_t SoftFillRect(ISurface *surface, IRect *rect, uint32_t color, GfxOpt *opt)
+{
+    DISPLAY_CHK_RETURN((surface == nullptr) || (rect == nullptr), DISPLAY_NULL_PTR,
+        DISPLAY_LOGE("surface or rect is null"));
+    GfxOpt defaultOpt = {};
+    std::lock_guard<std::mutex> lock(g_softGfxMutex);
+    DISPLAY_CHK_RETURN((g_softGfx == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("the soft gfx is not initialized"));
+    SurfaceMapping dst(*surface, true);
+    return g_softGfx->Fill(dst.GetImage(), *rect, color, (opt != nullptr) ? *opt : defaultOpt);
+}
+
+int32_t SoftDrawRectangle(ISurface *surface, Rectangle *rect, uint32_t color, GfxOpt *opt)
+{
+    DISPLAY_UNUSED(surface);
+    DISPLAY_UNUSED(rect);
+    DISPLAY_UNUSED(color);
+    DISPLAY_UNUSED(opt);
+    return DISPLAY_NOT_SUPPORT;
+}
+
+int32_t SoftDrawLine(ISurface *surface, ILine *line, GfxOpt *opt)
+{
+    DISPLAY_UNUSED(surface);
+    DISPLAY_UNUSED(line);
+    DISPLAY_UNUSED(opt);
+    return DISPLAY_NOT_SUPPORT;
+}
+
+int32_t SoftDrawCircle(ISurface *surface, ICircle *circle, GfxOpt *opt)
+{
+    DISPLAY_UNUSED(surface);
+    DISPLAY_UNUSED(circle);
+    DISPLAY_UNUSED(opt);
+    return DISPLAY_NOT_SUPPORT;
+}
+
+int32_t SoftBlit(ISurface *srcSurface, IRect *srcRect, ISurface *dstSurface, IRect *dstRect, GfxOpt *opt)
+{
+    DISPLAY_CHK_RETURN((srcSurface == nullptr) || (dstSurface == nullptr) || (srcRect == nullptr) ||
+        (dstRect == nullptr), DISPLAY_NULL_PTR, DISPLAY_LOGE("surface or rect is null"));
+    GfxOpt defaultOpt = {};
+    std::lock_guard<std::mutex> lock(g_softGfxMutex);
+    DISPLAY_CHK_RETURN((g_softGfx == nullptr), DISPLAY_FAILURE, DISPLAY_LOGE("the soft gfx is not initialized"));
+    SurfaceMapping src(*srcSurface, false);
+    SurfaceMapping dst(*dstSurface, true);
+    return g_softGfx->Blit(src.GetImage(), *srcRect, dst.GetImage(), *dstRect, (opt != nullptr) ? *opt : defaultOpt);
+}
+
+// the cpu is done once a call returns
+int32_t SoftSync(int32_t timeOut)
+{
+    DISPLAY_UNUSED(timeOut);
+    return DISPLAY_SUCCESS;
+}
+} // namespace
+} // namespace DISPLAY
+} // namespace HDI
+} // namespace OHOS
+
+using namespace OHOS::HDI::DISPLAY;
+int32_t SoftGfxInitialize(GfxFuncs **funcs)
+{
+    DISPLAY_CHK_RETURN((funcs == nullptr), DISPLAY_PARAM_ERR, DISPLAY_LOGE("funcs is null"));
+    GfxFuncs *gfxFuncs = new (std::nothrow) GfxFuncs();
+    DISPLAY_CHK_RETURN((gfxFuncs == nullptr), DISPLAY_NOMEM, DISPLAY_LOGE("alloc gfx funcs failed"));
+    gfxFuncs->InitGfx = SoftInitGfx;
+    gfxFuncs->DeinitGfx = SoftDeinitGfx;
+    gfxFuncs->FillRect = SoftFillRect;
+    gfxFuncs->DrawRectangle = SoftDrawRectangle;
+    gfxFuncs->DrawLine = SoftDrawLine;
+    gfxFuncs->DrawCircle = SoftDrawCircle;
+    gfxFuncs->Blit = SoftBlit;
+    gfxFuncs->Sync = SoftSync;
+    *funcs = gfxFuncs;
+    return DISPLAY_SUCCESS;
+}
+
+int32_t SoftGfxUninitialize(GfxFuncs *funcs)
+{
+    DISPLAY_CHK_RETURN((funcs == nullptr), DISPLAY_PARAM_ERR, DISPLAY_LOGE("funcs is null"));
+    delete funcs;
+    return DISPLAY_SUCCESS;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISPLAY_GFX_SOFT_H
+#define DISPLAY_GFX_SOFT_H
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "display_gfx.h"
+
+namespace OHOS {
+namespace HDI {
+namespace DISPLAY {
+// a surface the CPU can address, chroma is the CbCr plane of the semi-planar yuv formats
+struct SoftGfxImage {
+    uint8_t *data = nullptr;
+    uint8_t *chroma = nullptr;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t stride = 0;
+    int32_t chromaStride = 0;
+    PixelFormat format = PIXEL_FMT_BUTT;
+};
+
+/*
+ * The CPU implementation of the GfxFuncs operations, used when there is no vendor gfx library.
+ * The colors are 0xRRGGBBAA words as PIXEL_FMT_RGBA_8888 stores them, the blending follows the Porter-Duff
+ * operators with straight alpha in the source. Scaling samples the nearest pixel. The destination is split in
+ * tiles that run on the workers and on the calling thread.
+ */
+class SoftGfx {
+public:
+    // threads is the number of workers beside the calling thread
+    explicit SoftGfx(uint32_t threads);
+    virtual ~SoftGfx();
+    int32_t Blit(const SoftGfxImage &src, const IRect &srcRect, const SoftGfxImage &dst, const IRect &dstRect,
+        const GfxOpt &opt);
+    int32_t Fill(const SoftGfxImage &dst, const IRect &rect, uint32_t color, const GfxOpt &opt);
+    static bool IsSrcFormatSupported(PixelFormat format);
+    static bool IsDstFormatSupported(PixelFormat format);
+    // the workers a default instance gets, one per core up to a few
+    static uint32_t GetDefaultThreads();
+
+private:
+    // runs task(0 .. count - 1) and returns once all of them are done
+    void RunTiles(uint32_t count, const std::function<void(uint32_t)> &task);
+    void WorkerLoop();
+    std::vector<std::thread> mThreads;
+    // one operation at a time owns the workers
+    std::mutex mRunMutex;
+    std::mutex mMutex;
+    std::condition_variable mWorkCond;
+    std::condition_variable mDoneCond;
+    const std::function<void(uint32_t)> *mTask = nullptr;
+    uint32_t mTileCount = 0;
+    uint32_t mNextTile = 0;
+    uint32_t mDoneTiles = 0;
+    uint64_t mGeneration = 0;
+    bool mStop = false;
+};
+} // namespace DISPLAY
+} // namespace HDI
+} // namespace OHOS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * GfxFuncs backed by SoftGfx. The surfaces carry a dma-buf fd in phyAddr, as the display device fills them for
+ * buffers without a physical address, and are mapped for the duration of each operation.
+ */
+int32_t SoftGfxInitialize(GfxFuncs **funcs);
+int32_t SoftGfxUninitialize(GfxFuncs *funcs);
+#ifdef __cplusplus
+}
+#endif
+#endif // DISPLAY_GFX_SOFT_H
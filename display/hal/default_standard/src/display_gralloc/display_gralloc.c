@@ -100,7 +100,7 @@ int32_t GrallocUninitialize(GrallocFuncs *funcs)
     return DISPLAY_SUCCESS;
 }
 
-int32_t GrallocInitialize(GrallocFuncs **funcs)
+int32_t GrallocInitializeWithPool(GrallocFuncs **funcs, uint64_t poolMaxBytes)
 {
     DISPLAY_LOGD();
     int ret;
@@ -111,8 +111,10 @@ int32_t GrallocInitialize(GrallocFuncs **funcs)
     DISPLAY_CHK_RETURN((eok != EOK), DISPLAY_FAILURE, DISPLAY_LOGE("memset_s failed"));
     // initialize gbm gralloc
 #ifdef GRALLOC_GBM_SUPPORT
-    ret = GbmGrallocInitialize();
+    ret = GbmGrallocInitialize(poolMaxBytes);
     DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), ret, DISPLAY_LOGE("gbm initial"); free(grallocFuncs));
+#else
+    (void)poolMaxBytes;
 #endif
     grallocFuncs->AllocMem = AllocMem;
     grallocFuncs->FreeMem = FreeMem;
@@ -122,4 +124,9 @@ int32_t GrallocInitialize(GrallocFuncs **funcs)
     grallocFuncs->FlushCache = FlushCache;
     *funcs = grallocFuncs;
     return DISPLAY_SUCCESS;
+}
+
+int32_t GrallocInitialize(GrallocFuncs **funcs)
+{
+    return GrallocInitializeWithPool(funcs, GRALLOC_POOL_SIZE_DEFAULT);
 }
\ No newline at end of file
@@ -15,6 +15,7 @@
 
 #include "display_gralloc_gbm.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <inttypes.h>
 #include <string.h>
@@ -32,9 +33,13 @@
 #include "hi_gbm.h"
 #include "hdf_dlist.h"
 #include "display_gralloc_private.h"
+#include "display_gralloc_pool.h"
 #include "display_common.h"
 
 const char *g_drmFileNode = "/dev/dri/card0";
+// the pool is off unless HDI_GRALLOC_POOL_MB sets how many MiB the free buffers may hold
+#define GRALLOC_POOL_ENV "HDI_GRALLOC_POOL_MB"
+#define DMA_BUF_FDINFO_LINE 128
 static GrallocManager *g_grallocManager = NULL;
 static pthread_mutex_t g_lock;
 
@@ -179,7 +184,93 @@ static uint64_t ConvertUsageToGbm(uint64_t inUsage)
     return outUsage;
 }
 
-static int32_t InitGbmDevice(const char *drmFile, GrallocManager *grallocManager)
+static void CloseBufferHandle(BufferHandle *handle)
+{
+    DISPLAY_CHK_RETURN_NOT_VALUE((handle == NULL), DISPLAY_LOGE("buffer is null"));
+    if (handle->fd >= 0) {
+        close(handle->fd);
+        handle->fd = -1;
+    }
+    const uint32_t reserveFds = handle->reserveFds;
+    for (uint32_t i = 0; i < reserveFds; i++) {
+        if (handle->reserve[i] >= 0) {
+            close(handle->reserve[i]);
+            handle->reserve[i] = -1;
+        }
+    }
+}
+
+static void DestroyBuffer(BufferHandle *buffer)
+{
+    if ((buffer->virAddr != NULL) && (GbmUnmap(buffer) != DISPLAY_SUCCESS)) {
+        DISPLAY_LOGE("freeMem unmap buffer failed");
+    }
+    CloseBufferHandle(buffer);
+    free(buffer);
+}
+
+static uint64_t GetPoolMaxBytes(uint64_t poolMaxBytes)
+{
+    const uint64_t mib = 1024 * 1024;
+    if (poolMaxBytes != GRALLOC_POOL_SIZE_DEFAULT) {
+        return poolMaxBytes;
+    }
+    const char *env = getenv(GRALLOC_POOL_ENV);
+    if (env == NULL) {
+        return 0;
+    }
+    char *end = NULL;
+    unsigned long long value = strtoull(env, &end, 10); // 10: decimal
+    if ((end == env) || (*end != '\0')) {
+        DISPLAY_LOGE("invalid %{public}s %{public}s", GRALLOC_POOL_ENV, env);
+        return 0;
+    }
+    return (uint64_t)value * mib;
+}
+
+// the file references of a dma-buf fd as the kernel reports them, -1 if it does not
+static int64_t GetDmaBufRefs(int fd)
+{
+    char path[PATH_MAX] = {0};
+    char line[DMA_BUF_FDINFO_LINE] = {0};
+    long long refs = -1;
+    if (snprintf_s(path, sizeof(path), sizeof(path) - 1, "/proc/self/fdinfo/%d", fd) < 0) {
+        return -1;
+    }
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf_s(line, "count: %lld", &refs) == 1) {
+            break;
+        }
+    }
+    (void)fclose(fp);
+    return (int64_t)refs;
+}
+
+// every dup, mapping or transfer of the fd to another process holds one more reference than the pool accounts for
+static bool IsBufferShared(const PriBufferHandle *buffer)
+{
+    if (buffer->fdRefs < 0) {
+        return true;
+    }
+    int64_t refs = GetDmaBufRefs(buffer->hdl.fd);
+    int64_t mapped = (buffer->hdl.virAddr != NULL) ? 1 : 0;
+    return (refs < 0) || (refs != buffer->fdRefs + mapped);
+}
+
+// the pool of an initialized device, NULL when recycling is off
+static GrallocPool *GetPool(GrallocManager *grallocManager)
+{
+    if ((grallocManager == NULL) || (grallocManager->gbmDevice == NULL) || (grallocManager->pool.maxBytes == 0)) {
+        return NULL;
+    }
+    return &grallocManager->pool;
+}
+
+static int32_t InitGbmDevice(const char *drmFile, GrallocManager *grallocManager, uint64_t poolMaxBytes)
 {
     DISPLAY_LOGD();
     char path[PATH_MAX] = {0};
@@ -208,6 +299,7 @@ static int32_t InitGbmDevice(const char *drmFile, GrallocManager *grallocManager
         grallocManager->gbmDevice = gbmDevice;
         grallocManager->drmFd = drmFd;
         DListHeadInit(&grallocManager->gbmBoHead);
+        GrallocPoolInit(&grallocManager->pool, GetPoolMaxBytes(poolMaxBytes), DestroyBuffer, IsBufferShared);
     }
     return DISPLAY_SUCCESS;
 }
@@ -215,6 +307,9 @@ static int32_t InitGbmDevice(const char *drmFile, GrallocManager *grallocManager
 static void DeInitGbmDevice(GrallocManager *grallocManager)
 {
     DISPLAY_LOGD();
+    if (grallocManager->gbmDevice != NULL) {
+        GrallocPoolDeinit(&grallocManager->pool);
+    }
     hdi_gbm_device_destroy(grallocManager->gbmDevice);
     if (grallocManager->drmFd > 0) {
         close(grallocManager->drmFd);
@@ -306,8 +401,23 @@ int32_t GbmAllocMem(const AllocInfo *info, BufferHandle **buffer)
     GrallocManager *grallocManager = GetGrallocManager();
     DISPLAY_CHK_RETURN((grallocManager == NULL), DISPLAY_PARAM_ERR, DISPLAY_LOGE("gralloc manager failed");
         GRALLOC_UNLOCK());
+    GrallocPool *pool = GetPool(grallocManager);
+    if (pool != NULL) {
+        priBuffer = GrallocPoolAcquire(pool, info);
+        if (priBuffer != NULL) {
+            *buffer = &priBuffer->hdl;
+            GRALLOC_UNLOCK();
+            return DISPLAY_SUCCESS;
+        }
+    }
     struct gbm_bo *bo =
         hdi_gbm_bo_create(grallocManager->gbmDevice, info->width, info->height, drmFmt, ConvertUsageToGbm(info->usage));
+    if ((bo == NULL) && (pool != NULL)) {
+        // the memory may be held by free buffers of other sizes
+        GrallocPoolTrim(pool, 0);
+        bo = hdi_gbm_bo_create(grallocManager->gbmDevice, info->width, info->height, drmFmt,
+            ConvertUsageToGbm(info->usage));
+    }
     DISPLAY_CHK_RETURN((bo == NULL), DISPLAY_NOMEM, DISPLAY_LOGE("gbm create bo failed"); GRALLOC_UNLOCK());
 
     int fd = hdi_gbm_bo_get_fd(bo);
@@ -321,8 +431,13 @@ int32_t GbmAllocMem(const AllocInfo *info, BufferHandle **buffer)
 
     InitBufferHandle(bo, fd, info, priBuffer);
     priBuffer->hdl.phyAddr = GetPhysicalAddr(grallocManager->drmFd, fd);
-    *buffer = &priBuffer->hdl;
     hdi_gbm_bo_destroy(bo);
+    if (pool != NULL) {
+        // the fd is not handed out yet, any reference beyond these on release means it was shared
+        priBuffer->fdRefs = GetDmaBufRefs(fd);
+        GrallocPoolTrack(pool, priBuffer, info);
+    }
+    *buffer = &priBuffer->hdl;
     GRALLOC_UNLOCK();
     return DISPLAY_SUCCESS;
 error:
@@ -335,31 +450,17 @@ error:
     return DISPLAY_FAILURE;
 }
 
-static void CloseBufferHandle(BufferHandle *handle)
-{
-    DISPLAY_CHK_RETURN_NOT_VALUE((handle == NULL), DISPLAY_LOGE("buffer is null"));
-    if (handle->fd >= 0) {
-        close(handle->fd);
-        handle->fd = -1;
-    }
-    const uint32_t reserveFds = handle->reserveFds;
-    for (uint32_t i = 0; i < reserveFds; i++) {
-        if (handle->reserve[i] >= 0) {
-            close(handle->reserve[i]);
-            handle->reserve[i] = -1;
-        }
-    }
-}
-
 void GbmFreeMem(BufferHandle *buffer)
 {
     DISPLAY_LOGD();
     DISPLAY_CHK_RETURN_NOT_VALUE((buffer == NULL), DISPLAY_LOGE("buffer is null"));
-    if ((buffer->virAddr != NULL) && (GbmUnmap(buffer) != DISPLAY_SUCCESS)) {
-        DISPLAY_LOGE("freeMem unmap buffer failed");
+    GRALLOC_LOCK();
+    // the pool keeps the fd and the mapping of its own buffers, the imported ones are closed
+    GrallocPool *pool = GetPool(g_grallocManager);
+    if ((pool == NULL) || !GrallocPoolRelease(pool, buffer)) {
+        DestroyBuffer(buffer);
     }
-    CloseBufferHandle(buffer);
-    free(buffer);
+    GRALLOC_UNLOCK();
 }
 
 void *GbmMmap(BufferHandle *buffer)
@@ -415,6 +516,28 @@ int32_t GbmFlushCache(BufferHandle *buffer)
     return DmaBufferSync(buffer, false);
 }
 
+void GbmGrallocPoolStats(GrallocPoolStats *stats)
+{
+    DISPLAY_CHK_RETURN_NOT_VALUE((stats == NULL), DISPLAY_LOGE("stats is null"));
+    (void)memset_s(stats, sizeof(*stats), 0, sizeof(*stats));
+    GRALLOC_LOCK();
+    GrallocPool *pool = GetPool(g_grallocManager);
+    if (pool != NULL) {
+        GrallocPoolGetStats(pool, stats);
+    }
+    GRALLOC_UNLOCK();
+}
+
+void GbmGrallocPoolTrim(uint64_t maxBytes)
+{
+    GRALLOC_LOCK();
+    GrallocPool *pool = GetPool(g_grallocManager);
+    if (pool != NULL) {
+        GrallocPoolTrim(pool, maxBytes);
+    }
+    GRALLOC_UNLOCK();
+}
+
 int32_t GbmGrallocUninitialize(void)
 {
     DISPLAY_LOGD();
@@ -432,14 +555,14 @@ int32_t GbmGrallocUninitialize(void)
     return DISPLAY_SUCCESS;
 }
 
-int32_t GbmGrallocInitialize(void)
+int32_t GbmGrallocInitialize(uint64_t poolMaxBytes)
 {
     DISPLAY_LOGD();
     GRALLOC_LOCK();
     GrallocManager *grallocManager = GetGrallocManager();
     DISPLAY_CHK_RETURN((grallocManager == NULL), DISPLAY_PARAM_ERR, DISPLAY_LOGE("gralloc manager failed");
         GRALLOC_UNLOCK());
-    int ret = InitGbmDevice(g_drmFileNode, grallocManager);
+    int ret = InitGbmDevice(g_drmFileNode, grallocManager, poolMaxBytes);
     DISPLAY_CHK_RETURN((ret != DISPLAY_SUCCESS), ret, DISPLAY_LOGE("gralloc manager failed"); GRALLOC_UNLOCK());
     grallocManager->referCount++;
     GRALLOC_UNLOCK();
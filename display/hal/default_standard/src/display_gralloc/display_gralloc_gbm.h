@@ -17,6 +17,7 @@
 #define DISPLAY_GRALLOC_GBM_H
 #include "display_type.h"
 #include "hdf_dlist.h"
+#include "display_gralloc_pool.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,6 +27,7 @@ typedef struct {
     int drmFd;
     struct DListHead gbmBoHead;
     int32_t referCount;
+    GrallocPool pool;
 } GrallocManager;
 
 typedef struct {
@@ -40,8 +42,15 @@ void *GbmMmap(BufferHandle *buffer);
 int32_t GbmUnmap(BufferHandle *buffer);
 int32_t GbmInvalidateCache(BufferHandle *buffer);
 int32_t GbmFlushCache(BufferHandle *buffer);
+// statistics of the free buffer pool of this process, all zero when it is off
+void GbmGrallocPoolStats(GrallocPoolStats *stats);
+// destroys the least recently freed buffers until the pool holds no more than maxBytes, e.g. on memory pressure
+void GbmGrallocPoolTrim(uint64_t maxBytes);
+#define GRALLOC_POOL_SIZE_DEFAULT UINT64_MAX
 int32_t GbmGrallocUninitialize();
-int32_t GbmGrallocInitialize();
+// poolMaxBytes sizes the free buffer pool when the device is created, GRALLOC_POOL_SIZE_DEFAULT takes
+// HDI_GRALLOC_POOL_MB, the pool is off without it
+int32_t GbmGrallocInitialize(uint64_t poolMaxBytes);
 
 #ifdef GRALLOC_LOCK_DEBUG
 #define GRALLOC_LOCK(format, ...)                                                                                    \
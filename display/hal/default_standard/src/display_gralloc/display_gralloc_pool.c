@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "display_gralloc_pool.h"
+#include <inttypes.h>
+#include <securec.h>
+#include "display_common.h"
+
+static uint32_t GetBucketIndex(const AllocInfo *info)
+{
+    const uint32_t prime = 31;
+    uint32_t hash = info->width;
+    hash = hash * prime + info->height;
+    hash = hash * prime + (uint32_t)info->format;
+    hash = hash * prime + (uint32_t)(info->usage ^ (info->usage >> 32)); // 32: fold the high half of the usage
+    return hash % GRALLOC_POOL_BUCKETS;
+}
+
+static struct DListHead *GetLiveBucket(GrallocPool *pool, const BufferHandle *handle)
+{
+    const uint32_t shift = 4; // 4: the low bits of a heap address are always zero
+    return &pool->liveBuckets[((uintptr_t)handle >> shift) % GRALLOC_POOL_LIVE_BUCKETS];
+}
+
+static bool IsSameRequest(const AllocInfo *a, const AllocInfo *b)
+{
+    return (a->width == b->width) && (a->height == b->height) && (a->format == b->format) && (a->usage == b->usage);
+}
+
+void GrallocPoolInit(GrallocPool *pool, uint64_t maxBytes, GrallocPoolDestroyFunc destroy,
+    GrallocPoolSharedFunc isShared)
+{
+    DISPLAY_CHK_RETURN_NOT_VALUE((pool == NULL), DISPLAY_LOGE("pool is null"));
+    for (uint32_t i = 0; i < GRALLOC_POOL_LIVE_BUCKETS; i++) {
+        DListHeadInit(&pool->liveBuckets[i]);
+    }
+    DListHeadInit(&pool->lruHead);
+    for (uint32_t i = 0; i < GRALLOC_POOL_BUCKETS; i++) {
+        DListHeadInit(&pool->buckets[i]);
+    }
+    pool->maxBytes = maxBytes;
+    pool->destroy = destroy;
+    pool->isShared = isShared;
+    (void)memset_s(&pool->stats, sizeof(pool->stats), 0, sizeof(pool->stats));
+}
+
+void GrallocPoolDeinit(GrallocPool *pool)
+{
+    DISPLAY_CHK_RETURN_NOT_VALUE((pool == NULL), DISPLAY_LOGE("pool is null"));
+    DISPLAY_LOGI("pool hits %{public}" PRIu64 " misses %{public}" PRIu64 " evictions %{public}" PRIu64
+        " shared %{public}" PRIu64, pool->stats.hits, pool->stats.misses, pool->stats.evictions, pool->stats.shared);
+    GrallocPoolTrim(pool, 0);
+    // the live buffers are freed after the pool, unlink them so that they are destroyed instead of pooled
+    PriBufferHandle *buffer = NULL;
+    PriBufferHandle *tmp = NULL;
+    for (uint32_t i = 0; i < GRALLOC_POOL_LIVE_BUCKETS; i++) {
+        DLIST_FOR_EACH_ENTRY_SAFE(buffer, tmp, &pool->liveBuckets[i], PriBufferHandle, entry) {
+            DListRemove(&buffer->entry);
+            DListHeadInit(&buffer->entry);
+        }
+    }
+    pool->stats.liveCount = 0;
+}
+
+void GrallocPoolTrack(GrallocPool *pool, PriBufferHandle *buffer, const AllocInfo *info)
+{
+    DISPLAY_CHK_RETURN_NOT_VALUE((pool == NULL) || (buffer == NULL) || (info == NULL),
+        DISPLAY_LOGE("pool, buffer or info is null"));
+    buffer->info = *info;
+    DListInsertTail(&buffer->entry, GetLiveBucket(pool, &buffer->hdl));
+    DListHeadInit(&buffer->lruEntry);
+    pool->stats.liveCount++;
+}
+
+PriBufferHandle *GrallocPoolAcquire(GrallocPool *pool, const AllocInfo *info)
+{
+    DISPLAY_CHK_RETURN((pool == NULL) || (info == NULL), NULL, DISPLAY_LOGE("pool or info is null"));
+    struct DListHead *bucket = &pool->buckets[GetBucketIndex(info)];
+    PriBufferHandle *buffer = NULL;
+    // the bucket is in release order, the newest buffer is the most likely to still be in the caches
+    DLIST_FOR_EACH_ENTRY(buffer, bucket, PriBufferHandle, entry) {
+        if (IsSameRequest(&buffer->info, info)) {
+            DListRemove(&buffer->entry);
+            DListRemove(&buffer->lruEntry);
+            DListHeadInit(&buffer->lruEntry);
+            DListInsertTail(&buffer->entry, GetLiveBucket(pool, &buffer->hdl));
+            pool->stats.freeCount--;
+            pool->stats.freeBytes -= (uint32_t)buffer->hdl.size;
+            pool->stats.liveCount++;
+            pool->stats.hits++;
+            return buffer;
+        }
+    }
+    pool->stats.misses++;
+    return NULL;
+}
+
+bool GrallocPoolRelease(GrallocPool *pool, BufferHandle *handle)
+{
+    DISPLAY_CHK_RETURN((pool == NULL) || (handle == NULL), false, DISPLAY_LOGE("pool or handle is null"));
+    PriBufferHandle *buffer = NULL;
+    bool found = false;
+    // only compare the addresses, a foreign handle is not a PriBufferHandle and must not be read as one
+    DLIST_FOR_EACH_ENTRY(buffer, GetLiveBucket(pool, handle), PriBufferHandle, entry) {
+        if (&buffer->hdl == handle) {
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    DListRemove(&buffer->entry);
+    pool->stats.liveCount--;
+    if ((handle->fd < 0) || ((uint64_t)(uint32_t)handle->size > pool->maxBytes)) {
+        pool->destroy(handle);
+        return true;
+    }
+    if ((pool->isShared != NULL) && pool->isShared(buffer)) {
+        pool->stats.shared++;
+        pool->destroy(handle);
+        return true;
+    }
+    DListInsertHead(&buffer->entry, &pool->buckets[GetBucketIndex(&buffer->info)]);
+    DListInsertTail(&buffer->lruEntry, &pool->lruHead);
+    pool->stats.freeCount++;
+    pool->stats.freeBytes += (uint32_t)handle->size;
+    GrallocPoolTrim(pool, pool->maxBytes);
+    return true;
+}
+
+void GrallocPoolTrim(GrallocPool *pool, uint64_t maxBytes)
+{
+    DISPLAY_CHK_RETURN_NOT_VALUE((pool == NULL), DISPLAY_LOGE("pool is null"));
+    while ((pool->stats.freeBytes > maxBytes) && !DListIsEmpty(&pool->lruHead)) {
+        PriBufferHandle *buffer = DLIST_FIRST_ENTRY(&pool->lruHead, PriBufferHandle, lruEntry);
+        DListRemove(&buffer->lruEntry);
+        DListRemove(&buffer->entry);
+        pool->stats.freeCount--;
+        pool->stats.freeBytes -= (uint32_t)buffer->hdl.size;
+        pool->stats.evictions++;
+        pool->destroy(&buffer->hdl);
+    }
+}
+
+void GrallocPoolGetStats(const GrallocPool *pool, GrallocPoolStats *stats)
+{
+    DISPLAY_CHK_RETURN_NOT_VALUE((pool == NULL) || (stats == NULL), DISPLAY_LOGE("pool or stats is null"));
+    *stats = pool->stats;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISPLAY_GRALLOC_POOL_H
+#define DISPLAY_GRALLOC_POOL_H
+#include <stdbool.h>
+#include "display_gralloc_private.h"
+#include "hdf_dlist.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GRALLOC_POOL_BUCKETS 16
+#define GRALLOC_POOL_LIVE_BUCKETS 64
+
+typedef struct {
+    uint64_t hits;      /* allocations served from the pool */
+    uint64_t misses;    /* allocations that had to create a buffer */
+    uint64_t evictions; /* free buffers destroyed to stay under the limit */
+    uint64_t shared;    /* freed buffers destroyed because their fd was shared */
+    uint32_t liveCount; /* buffers handed out and not freed yet */
+    uint32_t freeCount; /* buffers kept for reuse */
+    uint64_t freeBytes; /* memory held by the free buffers */
+} GrallocPoolStats;
+
+typedef void (*GrallocPoolDestroyFunc)(BufferHandle *buffer);
+/* true if the memory of the buffer may still be reached from elsewhere, e.g. its dma-buf was sent to a client */
+typedef bool (*GrallocPoolSharedFunc)(const PriBufferHandle *buffer);
+
+/*
+ * Keeps freed buffers with their fd and CPU mapping, bucketed by the width, height, format and usage they were
+ * requested with. The free buffers are also kept in release order, the least recently released go first when
+ * the pool grows beyond maxBytes. A buffer that was shared is destroyed on release, handing it out again would
+ * give its memory to two owners. The live buffers are hashed by their handle address. The pool is not thread
+ * safe, the caller holds the gralloc lock.
+ */
+typedef struct {
+    struct DListHead liveBuckets[GRALLOC_POOL_LIVE_BUCKETS];
+    struct DListHead lruHead;
+    struct DListHead buckets[GRALLOC_POOL_BUCKETS];
+    uint64_t maxBytes;
+    GrallocPoolDestroyFunc destroy;
+    GrallocPoolSharedFunc isShared;
+    GrallocPoolStats stats;
+} GrallocPool;
+
+void GrallocPoolInit(GrallocPool *pool, uint64_t maxBytes, GrallocPoolDestroyFunc destroy,
+    GrallocPoolSharedFunc isShared);
+/* destroys the free buffers, the live ones are destroyed by their owners once the pool is gone */
+void GrallocPoolDeinit(GrallocPool *pool);
+/* records a newly created buffer so that freeing it returns it to the pool */
+void GrallocPoolTrack(GrallocPool *pool, PriBufferHandle *buffer, const AllocInfo *info);
+/* a free buffer matching the request, NULL on a miss */
+PriBufferHandle *GrallocPoolAcquire(GrallocPool *pool, const AllocInfo *info);
+/* false if the handle was not created through this pool, e.g. it was received from another process */
+bool GrallocPoolRelease(GrallocPool *pool, BufferHandle *handle);
+/* destroys the least recently released buffers until the free ones hold no more than maxBytes */
+void GrallocPoolTrim(GrallocPool *pool, uint64_t maxBytes);
+void GrallocPoolGetStats(const GrallocPool *pool, GrallocPoolStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // DISPLAY_GRALLOC_POOL_H
@@ -71,6 +71,7 @@ public:
     virtual int32_t GetWriteBackFrame(uint32_t devId, BufferHandle &buffer, int32_t &fence) = 0;
     virtual int32_t CreateWriteBack(uint32_t &devId, uint32_t width, uint32_t height, int32_t &format) = 0;
     virtual int32_t DestroyWriteBack(uint32_t devId) = 0;
+    virtual int32_t SetWriteBackCadence(uint32_t devId, uint32_t interval) = 0;
     virtual int32_t SetProxyRemoteCallback(const OHOS::sptr<DisplayRegisterCallbackBase> &callback) = 0;
     /* layer proxy */
     virtual int32_t CreateLayer(uint32_t devId, const LayerInfo &layerInfo, uint32_t &layerId) = 0;
@@ -16,6 +16,9 @@
 #ifndef _HDI_DISPLAY_HOST_PROXY_H_
 #define _HDI_DISPLAY_HOST_PROXY_H_
 
+#include <atomic>
+#include <mutex>
+#include "display_device_cmd_buffer.h"
 #include "idisplay_device.h"
 
 namespace OHOS {
@@ -65,6 +68,7 @@ public:
     int32_t GetWriteBackFrame(uint32_t devId, BufferHandle &buffer, int32_t &fence) override;
     int32_t CreateWriteBack(uint32_t &devId, uint32_t width, uint32_t height, int32_t &format) override;
     int32_t DestroyWriteBack(uint32_t devId) override;
+    int32_t SetWriteBackCadence(uint32_t devId, uint32_t interval) override;
     int32_t SetProxyRemoteCallback(const OHOS::sptr<DisplayRegisterCallbackBase> &callback) override;
     /* layer proxy */
     int32_t CreateLayer(uint32_t devId, const LayerInfo &layerInfo, uint32_t &layerId) override;
@@ -100,6 +104,8 @@ public:
     int32_t InvokeLayerCmd(uint32_t devId, uint32_t layerId, uint32_t cmd, ...) override;
     int32_t SetLayerCompositionType(uint32_t devId, uint32_t layerId, CompositionType type) override;
     int32_t SetLayerBlendType(uint32_t devId, uint32_t layerId, BlendType type) override;
+    // the transactions sent to the server so far, to measure the calls per frame
+    uint32_t GetTransactionCount() const;
 
 private:
     static inline OHOS::BrokerDelegator<DisplayDeviceProxy> delegator_;
@@ -109,6 +115,30 @@ private:
         void *data1 = nullptr, void *data2 = nullptr);
     void DeviceReplyDataDistributer(
         DisplayDeviceCommandId cmdId, MessageParcel *pReplay, void *data1 = nullptr, void *data2 = nullptr);
+    /* the setters with BATCH_CMD_FLAG are recorded into cmdWriter_ and reach the server along with the next
+    ** PrepareDisplayLayers or Commit, any other call sends the recorded state ahead of itself */
+    int32_t Send(DisplayDeviceCommandId cmdId, MessageParcel &data, MessageParcel &reply, MessageOption &option);
+    int32_t Transact(DisplayDeviceCommandId cmdId, MessageParcel &data, MessageParcel &reply, MessageOption &option);
+    int32_t FlushCmds();
+    static bool IsBatchEnabled();
+    int32_t EndRecord();
+    template <typename T>
+    int32_t RecordCmd(DisplayDeviceCommandId cmdId, uint32_t devId, uint32_t layerId, const T &payload)
+    {
+        {
+            std::lock_guard<std::mutex> lock(cmdMutex_);
+            cmdWriter_.Write(cmdId, devId, layerId, payload);
+        }
+        return EndRecord();
+    }
+    int32_t RecordRects(DisplayDeviceCommandId cmdId, uint32_t devId, uint32_t layerId, const IRect *rects,
+        uint32_t num);
+    int32_t RecordBufHdl(DisplayDeviceCommandId cmdId, uint32_t devId, uint32_t layerId, const BufferHandle &buffer,
+        int32_t fence);
+    // also held while a batch is in flight, the server reads the shared memory during the transaction
+    std::mutex cmdMutex_;
+    DisplayCmdWriter cmdWriter_;
+    std::atomic<uint32_t> transactionCount_ { 0 };
 };
 } // namespace Client
 } // namespace Device
@@ -61,6 +61,7 @@ public:
     int32_t GetWriteBackFrame(uint32_t devId, BufferHandle &buffer, int32_t &fence) override;
     int32_t CreateWriteBack(uint32_t &devId, uint32_t width, uint32_t height, int32_t &format) override;
     int32_t DestroyWriteBack(uint32_t devId) override;
+    int32_t SetWriteBackCadence(uint32_t devId, uint32_t interval) override;
     int32_t SetProxyRemoteCallback(const OHOS::sptr<DisplayRegisterCallbackBase> &callback) override;
     /* layer proxy */
     int32_t CreateLayer(uint32_t devId, const LayerInfo &layerInfo, uint32_t &layerId) override;
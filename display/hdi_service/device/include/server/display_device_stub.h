@@ -23,6 +23,7 @@
 
 #include "display_device.h"
 #include "display_device_callback_proxy.h"
+#include "display_device_cmd_buffer.h"
 #include "display_device_common.h"
 #include "display_device_service.h"
 
@@ -36,6 +37,7 @@ public:
     DisplayDeviceServerStub();
     ~DisplayDeviceServerStub() = default;
     int32_t OnRemoteRequest(int cmdId, MessageParcel *data, MessageParcel *reply);
+    int32_t ExecuteCmd(MessageParcel *data, MessageParcel *reply);
     // device
     int32_t RegHotPlugCallback(MessageParcel *data, MessageParcel *reply);
     int32_t GetDisplayCapability(MessageParcel *data, MessageParcel *reply);
@@ -66,6 +68,7 @@ public:
     int32_t GetWriteBackFrame(MessageParcel *data, MessageParcel *reply);
     int32_t CreateWriteBack(MessageParcel *data, MessageParcel *reply);
     int32_t DestroyWriteBack(MessageParcel *data, MessageParcel *reply);
+    int32_t SetWriteBackCadence(MessageParcel *data, MessageParcel *reply);
     int32_t FileTest(MessageParcel *data, MessageParcel *reply);
     int32_t SetProxyRemoteCallback(MessageParcel *data, MessageParcel *reply);
     // layer
@@ -110,6 +113,9 @@ public:
 private:
     static inline const std::u16string metaDescriptor_ = IDisplayDevice::GetDescriptor();
     int32_t SetCallBackObject(sptr<IRemoteObject> callbackRemote);
+    // runs the layer commands the proxy recorded since its last transaction
+    int32_t ExecuteBatch(MessageParcel *data);
+    int32_t DispatchCmd(const DisplayCmdReader &reader, const DisplayCmdHeader &header, const uint8_t *payload);
     sptr<DisplayDeviceCallbackProxy> callbackRemote_;
     std::unique_ptr<DisplayDeviceService> device_;
 };
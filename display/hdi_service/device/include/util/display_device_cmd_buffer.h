@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DISPLAY_DEVICE_CMD_BUFFER_H_
+#define _DISPLAY_DEVICE_CMD_BUFFER_H_
+
+#include <ashmem.h>
+#include <vector>
+#include "display_device_common.h"
+
+/* batch data in the parcel : N|A|S|F*     N mean command number, A mean the shared memory,
+**                                         S mean used bytes of the shared memory, F mean fd number and fds
+** shared memory            : HP HP HP     H mean DisplayCmdHeader, P mean the payload of the command
+** the setters with BATCH_CMD_FLAG are recorded, fds in a payload are indices into the fds of the parcel **/
+struct DisplayCmdHeader {
+    uint32_t cmdId;
+    uint32_t devId;
+    uint32_t layerId;
+    uint32_t size;
+};
+
+// a BufferHandle with fd indices instead of fds, followed by reserveFds indices and reserveInts values
+struct DisplayCmdBufHdl {
+    int32_t fd;
+    int32_t width;
+    int32_t stride;
+    int32_t height;
+    int32_t size;
+    int32_t format;
+    uint64_t usage;
+    uint64_t phyAddr;
+    int32_t key;
+    uint32_t reserveFds;
+    uint32_t reserveInts;
+    int32_t fence;
+};
+
+struct DisplayCmdColorKey {
+    uint32_t enable;
+    uint32_t key;
+};
+
+namespace OHOS {
+namespace Display {
+namespace Device {
+class DisplayCmdWriter {
+public:
+    DisplayCmdWriter() = default;
+    ~DisplayCmdWriter();
+    bool IsEmpty() const
+    {
+        return count_ == 0;
+    }
+    uint32_t GetCount() const
+    {
+        return count_;
+    }
+    template <typename T>
+    void Write(uint32_t cmdId, uint32_t devId, uint32_t layerId, const T &payload)
+    {
+        WriteRaw(cmdId, devId, layerId, &payload, sizeof(T));
+    }
+    void WriteRects(uint32_t cmdId, uint32_t devId, uint32_t layerId, const IRect *rects, uint32_t num);
+    // the fds are duplicated, the caller keeps its own
+    bool WriteBufHdl(uint32_t cmdId, uint32_t devId, uint32_t layerId, const BufferHandle &handle, int32_t fence);
+    // moves the recorded commands into the shared memory and their fds into the parcel, then starts over
+    bool Flush(MessageParcel &parcel);
+
+private:
+    void WriteRaw(uint32_t cmdId, uint32_t devId, uint32_t layerId, const void *payload, uint32_t size);
+    int32_t AddFd(int32_t fd);
+    void Reset();
+    std::vector<uint8_t> cmds_;
+    std::vector<int32_t> fds_;
+    // reused across batches, but sent with every one of them so the server keeps no state per client
+    sptr<Ashmem> ashmem_;
+    uint32_t count_ = 0;
+};
+
+// reads a single batch, the server uses one reader per transaction
+class DisplayCmdReader {
+public:
+    DisplayCmdReader() = default;
+    ~DisplayCmdReader();
+    bool Read(MessageParcel &parcel);
+    uint32_t GetCount() const
+    {
+        return count_;
+    }
+    // walks the commands of the batch, the payload stays valid until the next Read
+    bool Next(DisplayCmdHeader &header, const uint8_t *&payload);
+    // rebuilds the BufferHandle of a payload in storage, the fds stay owned by the reader
+    bool ReadBufHdl(const DisplayCmdHeader &header, const uint8_t *payload, std::vector<uint8_t> &storage,
+        BufferHandle *&handle, int32_t &fence) const;
+    void CloseFds();
+
+private:
+    int32_t GetFd(int32_t index) const;
+    sptr<Ashmem> ashmem_;
+    const uint8_t *cmds_ = nullptr;
+    uint32_t used_ = 0;
+    uint32_t offset_ = 0;
+    uint32_t count_ = 0;
+    std::vector<int32_t> fds_;
+};
+} // namespace Device
+} // namespace Display
+} // namespace OHOS
+#endif // _DISPLAY_DEVICE_CMD_BUFFER_H_
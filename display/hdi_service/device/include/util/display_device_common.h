@@ -98,6 +98,7 @@ using DisplayDeviceCommandId = enum {
     DSP_CMD_CREATEWRITEBACK = 0x10000 | 35,
     DSP_CMD_DESTROYWRITEBACK = 0x10000 | 36,
     DSP_CMD_SET_PROXY_REMOTE_CALLBACK = 0x10000 | 37,
+    DSP_CMD_SETWRITEBACKCADENCE = 0x10000 | 38,
     // layer
     DSP_CMD_RESERVED_2001 = 0x20000 | 1,
     DSP_CMD_RESERVED_2002 = 0x20000 | 2,
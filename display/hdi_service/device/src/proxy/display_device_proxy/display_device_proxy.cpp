@@ -14,6 +14,9 @@
  */
 
 #include "display_device_proxy.h"
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
 #include "display_device_common.h"
 
 #undef HDF_LOG_TAG
@@ -77,6 +80,92 @@ OHOS::sptr<IDisplayDevice> DisplayDeviceProxy::GetInstance(void)
     return g_instance;
 }
 
+int32_t DisplayDeviceProxy::Send(DisplayDeviceCommandId cmdId, MessageParcel &data, MessageParcel &reply,
+    MessageOption &option)
+{
+    transactionCount_++;
+    return Remote()->SendRequest(cmdId, data, reply, option);
+}
+
+int32_t DisplayDeviceProxy::Transact(DisplayDeviceCommandId cmdId, MessageParcel &data, MessageParcel &reply,
+    MessageOption &option)
+{
+    // the state recorded before this call has to reach the server first
+    int32_t ret = FlushCmds();
+    if (ret != DISPLAY_SUCCESS) {
+        return ret;
+    }
+    return Send(cmdId, data, reply, option);
+}
+
+int32_t DisplayDeviceProxy::FlushCmds()
+{
+    std::lock_guard<std::mutex> lock(cmdMutex_);
+    if (cmdWriter_.IsEmpty()) {
+        return DISPLAY_SUCCESS;
+    }
+    MessageParcel data;
+    MessageParcel reply;
+    MessageOption option;
+    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !cmdWriter_.Flush(data)) {
+        DISPLAY_LOG("error: %{public}s write layer commands into data failed", __func__);
+        return DISPLAY_FAILURE;
+    }
+    int32_t ret = Send(DSP_CMD_EXECUTECMD, data, reply, option);
+    if (ret != 0) {
+        DISPLAY_LOG("error: failed %{public}d", ret);
+        return ret;
+    }
+    return reply.ReadInt32();
+}
+
+bool DisplayDeviceProxy::IsBatchEnabled()
+{
+    // HDI_DISPLAY_BATCH=0 sends every setter on its own, to compare against the batched protocol
+    static const bool enabled = []() {
+        const char *env = getenv("HDI_DISPLAY_BATCH");
+        return (env == nullptr) || (strcmp(env, "0") != 0);
+    }();
+    return enabled;
+}
+
+int32_t DisplayDeviceProxy::EndRecord()
+{
+    return IsBatchEnabled() ? DISPLAY_SUCCESS : FlushCmds();
+}
+
+int32_t DisplayDeviceProxy::RecordRects(DisplayDeviceCommandId cmdId, uint32_t devId, uint32_t layerId,
+    const IRect *rects, uint32_t num)
+{
+    if (num > COMPOSER_SERVER_ARRAY_NUMBER_MAX) {
+        DISPLAY_LOG("error: %{public}u rects are too many", num);
+        return DISPLAY_PARAM_ERR;
+    }
+    {
+        std::lock_guard<std::mutex> lock(cmdMutex_);
+        cmdWriter_.WriteRects(cmdId, devId, layerId, rects, num);
+    }
+    return EndRecord();
+}
+
+int32_t DisplayDeviceProxy::RecordBufHdl(DisplayDeviceCommandId cmdId, uint32_t devId, uint32_t layerId,
+    const BufferHandle &buffer, int32_t fence)
+{
+    {
+        std::lock_guard<std::mutex> lock(cmdMutex_);
+        if (!cmdWriter_.WriteBufHdl(cmdId, devId, layerId, buffer, fence)) {
+            DISPLAY_LOG("error: write bufferhandle into the command buffer failed");
+            return DISPLAY_FAILURE;
+        }
+    }
+    return EndRecord();
+}
+
+uint32_t DisplayDeviceProxy::GetTransactionCount() const
+{
+    return transactionCount_;
+}
+
 void DisplayDeviceProxy::ReleaseInstance(void)
 {
     DISPLAY_START;
@@ -102,7 +191,7 @@ int32_t DisplayDeviceProxy::RegHotPlugCallback(HotPlugCallback callback, void *c
     if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor())) {
         return HDF_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_REGHOTPLUGCALLBACK, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_REGHOTPLUGCALLBACK, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
     }
@@ -130,7 +219,7 @@ int32_t DisplayDeviceProxy::RegDisplayVBlankCallback(uint32_t devId, VBlankCallb
         return false;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_REGDISPLAYVBLANKCALLBACK, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_REGDISPLAYVBLANKCALLBACK, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
     }
@@ -159,7 +248,7 @@ int32_t DisplayDeviceProxy::RegDisplayRefreshCallback(uint32_t devId, RefreshCal
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_REGDISPLAYREFRESHCALLBACK, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_REGDISPLAYREFRESHCALLBACK, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
     }
@@ -182,7 +271,7 @@ int32_t DisplayDeviceProxy::GetDisplayCapability(uint32_t devId, DisplayCapabili
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETDISPLAYCAPABILITY, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETDISPLAYCAPABILITY, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -215,7 +304,7 @@ int32_t DisplayDeviceProxy::GetDisplaySupportedModes(uint32_t devId, uint32_t &n
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETDISPLAYSUPPORTEDMODES, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETDISPLAYSUPPORTEDMODES, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -244,7 +333,7 @@ int32_t DisplayDeviceProxy::GetDisplayMode(uint32_t devId, uint32_t &modeId)
         DISPLAY_LOG("error: write devId into data failed");
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETDISPLAYMODE, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETDISPLAYMODE, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -273,7 +362,7 @@ int32_t DisplayDeviceProxy::SetDisplayMode(uint32_t devId, uint32_t modeId)
         DISPLAY_LOG("error: %{public}s write modeId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETDISPLAYMODE, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SETDISPLAYMODE, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -297,7 +386,7 @@ int32_t DisplayDeviceProxy::GetDisplayPowerStatus(uint32_t devId, DispPowerStatu
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETDISPLAYPOWERSTATUS, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETDISPLAYPOWERSTATUS, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -326,7 +415,7 @@ int32_t DisplayDeviceProxy::SetDisplayPowerStatus(uint32_t devId, DispPowerStatu
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETDISPLAYPOWERSTATUS, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SETDISPLAYPOWERSTATUS, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -350,7 +439,7 @@ int32_t DisplayDeviceProxy::GetDisplayBacklight(uint32_t devId, uint32_t &level)
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETDISPLAYBACKLIGHT, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETDISPLAYBACKLIGHT, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -379,7 +468,7 @@ int32_t DisplayDeviceProxy::SetDisplayBacklight(uint32_t devId, uint32_t level)
         DISPLAY_LOG("error: %{public}s write status into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETDISPLAYBACKLIGHT, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SETDISPLAYBACKLIGHT, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -408,7 +497,7 @@ int32_t DisplayDeviceProxy::GetDisplayProperty(uint32_t devId, uint32_t property
         DISPLAY_LOG("error: %{public}s write status into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETDISPLAYPROPERTY, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETDISPLAYPROPERTY, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -441,7 +530,7 @@ int32_t DisplayDeviceProxy::SetDisplayProperty(uint32_t devId, uint32_t property
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETDISPLAYPROPERTY, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SETDISPLAYPROPERTY, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -462,21 +551,28 @@ int32_t DisplayDeviceProxy::PrepareDisplayLayers(uint32_t devId, bool &needFlush
     MessageParcel data;
     MessageParcel reply;
     MessageOption option;
+    std::lock_guard<std::mutex> lock(cmdMutex_);
     if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
+    if (!cmdWriter_.Flush(data)) {
+        DISPLAY_LOG("error: %{public}s write layer commands into data failed", __func__);
+        return DISPLAY_FAILURE;
+    }
     if (!data.WriteUint32(needFlushFb)) {
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_PREPAREDISPLAYLAYERS, data, reply, option);
+    int32_t ret = Send(DSP_CMD_PREPAREDISPLAYLAYERS, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
     }
     needFlushFb = reply.ReadBool();
+    // the first failure of the setters that went with this call
+    ret = reply.ReadInt32();
     DISPLAY_LOG("interface end");
     return ret;
 }
@@ -496,7 +592,7 @@ int32_t DisplayDeviceProxy::GetDisplayCompChange(uint32_t devId, uint32_t &num,
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETDISPLAYCOMPCHANGE, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETDISPLAYCOMPCHANGE, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -542,7 +638,7 @@ int32_t DisplayDeviceProxy::SetDisplayClientCrop(uint32_t devId, const IRect *re
         DISPLAY_LOG("error: write devId into data failed");
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETDISPLAYCLIENTCROP, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SETDISPLAYCLIENTCROP, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -571,7 +667,7 @@ int32_t DisplayDeviceProxy::SetDisplayClientDestRect(uint32_t devId, const IRect
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETDISPLAYCLIENTDESTRECT, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SETDISPLAYCLIENTDESTRECT, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -584,69 +680,26 @@ int32_t DisplayDeviceProxy::SetDisplayClientBuffer(uint32_t devId, const BufferH
 {
     DISPLAY_LOG("interface start");
     if (devId > MAX_DEVID) {
+        DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!DisplayDeviceWriteBufHdl(&data, &bufhandle)) {
-        DISPLAY_LOG("error: write bufferhandle into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!DisplayDeviceWriteFileDescriptor(&data, fence)) {
-        DISPLAY_LOG("error: write size into data failed");
-        return DISPLAY_FAILURE;
-    }
-
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETDISPLAYCLIENTBUFFER, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordBufHdl(DSP_CMD_SETDISPLAYCLIENTBUFFER, devId, 0, bufhandle, fence);
 }
 
 int32_t DisplayDeviceProxy::SetDisplayClientDamage(uint32_t devId, uint32_t num, const IRect &rect)
 {
     DISPLAY_LOG("interface start");
     if (num == 0) {
+        DISPLAY_LOG("num is 0");
         return DISPLAY_PARAM_ERR;
     }
-
     if (devId > MAX_DEVID) {
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(num)) {
-        DISPLAY_LOG("error: %{public}s write num into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!DisplayDeviceWriteData(&data, &rect, num)) {
-        DISPLAY_LOG("error: write rect into data failed");
-        return DISPLAY_FAILURE;
-    }
-
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETDISPLAYCLIENTDAMAGE, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordRects(DSP_CMD_SETDISPLAYCLIENTDAMAGE, devId, 0, &rect, num);
 }
 
 int32_t DisplayDeviceProxy::SetDisplayVsyncEnabled(uint32_t devId, bool enabled)
@@ -668,7 +721,7 @@ int32_t DisplayDeviceProxy::SetDisplayVsyncEnabled(uint32_t devId, bool enabled)
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETDISPLAYVSYNCENABLED, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SETDISPLAYVSYNCENABLED, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -698,7 +751,7 @@ int32_t DisplayDeviceProxy::GetDisplayReleaseFence(uint32_t devId, uint32_t *num
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETDISPLAYRELEASEFENCE, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETDISPLAYRELEASEFENCE, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -733,11 +786,16 @@ int32_t DisplayDeviceProxy::Commit(uint32_t devId, int32_t &fence)
     MessageParcel data;
     MessageParcel reply;
     MessageOption option;
+    std::lock_guard<std::mutex> lock(cmdMutex_);
     if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_COMMIT, data, reply, option);
+    if (!cmdWriter_.Flush(data)) {
+        DISPLAY_LOG("error: %{public}s write layer commands into data failed", __func__);
+        return DISPLAY_FAILURE;
+    }
+    int32_t ret = Send(DSP_CMD_COMMIT, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -746,6 +804,8 @@ int32_t DisplayDeviceProxy::Commit(uint32_t devId, int32_t &fence)
         DISPLAY_LOG("error: read reply failed");
         return DISPLAY_FAILURE;
     }
+    // the frame is committed and the fence is valid even when one of the setters that went with it failed
+    ret = reply.ReadInt32();
     DISPLAY_LOG("interface end");
     return ret;
 }
@@ -775,7 +835,7 @@ int32_t DisplayDeviceProxy::CreateVirtualDisplay(uint32_t width, uint32_t height
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_CREATEVIRTUALDISPLAY, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_CREATEVIRTUALDISPLAY, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -801,7 +861,7 @@ int32_t DisplayDeviceProxy::DestroyVirtualDisplay(uint32_t devId)
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_DESTROYVIRTUALDISPLAY, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_DESTROYVIRTUALDISPLAY, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -839,7 +899,7 @@ int32_t DisplayDeviceProxy::SetVirtualDisplayBuffer(uint32_t devId, const Buffer
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETVIRTUALDISPLAYBUFFER, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SETVIRTUALDISPLAYBUFFER, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -851,11 +911,43 @@ int32_t DisplayDeviceProxy::SetVirtualDisplayBuffer(uint32_t devId, const Buffer
 
 int32_t DisplayDeviceProxy::GetWriteBackFrame(uint32_t devId, BufferHandle &buffer, int32_t &fence)
 {
-    DISPLAY_LOG("interface not support");
-    (void)devId;
-    (void)buffer;
-    (void)fence;
-    return DISPLAY_NOT_SUPPORT;
+    DISPLAY_LOG("interface start");
+    MessageParcel data;
+    MessageParcel reply;
+    MessageOption option;
+    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
+        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
+        return DISPLAY_FAILURE;
+    }
+    bool written = DisplayDeviceWriteFileDescriptor(&data, fence);
+    // the release fence is handed over like it is to the device, the parcel holds its own copy
+    if (fence >= 0) {
+        close(fence);
+    }
+    fence = -1;
+    if (!written) {
+        DISPLAY_LOG("error: %{public}s write fence into data failed", __func__);
+        return DISPLAY_FAILURE;
+    }
+    int32_t ret = Transact(DSP_CMD_GETWRITEBACKFRAME, data, reply, option);
+    if (ret != 0) {
+        DISPLAY_LOG("error: failed %{public}d", ret);
+        return ret;
+    }
+    BufferHandle *handle = nullptr;
+    if (!DisplayDeviceReadBufHdl(handle, &reply)) {
+        DISPLAY_LOG("error: read buffer from reply failed");
+        return DISPLAY_FAILURE;
+    }
+    // the caller owns the fd now, the handle carries no reserved data
+    buffer = *handle;
+    free(handle);
+    if (!DisplayDeviceReadFileDescriptor(&fence, &reply)) {
+        DISPLAY_LOG("error: read fence from reply failed");
+        return DISPLAY_FAILURE;
+    }
+    DISPLAY_LOG("interface end");
+    return ret;
 }
 
 int32_t DisplayDeviceProxy::CreateWriteBack(uint32_t &devId, uint32_t width, uint32_t height, int32_t &format)
@@ -864,7 +956,11 @@ int32_t DisplayDeviceProxy::CreateWriteBack(uint32_t &devId, uint32_t width, uin
     MessageParcel data;
     MessageParcel reply;
     MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(width)) {
+    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
+        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
+        return DISPLAY_FAILURE;
+    }
+    if (!data.WriteUint32(width)) {
         DISPLAY_LOG("error: %{public}s write width into data failed", __func__);
         return DISPLAY_FAILURE;
     }
@@ -872,8 +968,12 @@ int32_t DisplayDeviceProxy::CreateWriteBack(uint32_t &devId, uint32_t width, uin
         DISPLAY_LOG("error: %{public}s write height into data failed", __func__);
         return DISPLAY_FAILURE;
     }
+    if (!data.WriteInt32(format)) {
+        DISPLAY_LOG("error: %{public}s write format into data failed", __func__);
+        return DISPLAY_FAILURE;
+    }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_CREATEWRITEBACK, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_CREATEWRITEBACK, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -887,10 +987,26 @@ int32_t DisplayDeviceProxy::CreateWriteBack(uint32_t &devId, uint32_t width, uin
 int32_t DisplayDeviceProxy::DestroyWriteBack(uint32_t devId)
 {
     DISPLAY_LOG("interface start");
-    if (devId > MAX_DEVID) {
-        DISPLAY_LOG("param error");
-        return DISPLAY_PARAM_ERR;
+    // the id of a writeback endpoint is above the display ids
+    MessageParcel data;
+    MessageParcel reply;
+    MessageOption option;
+    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
+        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
+        return DISPLAY_FAILURE;
+    }
+    int32_t ret = Transact(DSP_CMD_DESTROYWRITEBACK, data, reply, option);
+    if (ret != 0) {
+        DISPLAY_LOG("error: failed %{public}d", ret);
+        return ret;
     }
+    DISPLAY_LOG("interface end");
+    return ret;
+}
+
+int32_t DisplayDeviceProxy::SetWriteBackCadence(uint32_t devId, uint32_t interval)
+{
+    DISPLAY_LOG("interface start");
     MessageParcel data;
     MessageParcel reply;
     MessageOption option;
@@ -898,7 +1014,11 @@ int32_t DisplayDeviceProxy::DestroyWriteBack(uint32_t devId)
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_DESTROYWRITEBACK, data, reply, option);
+    if (!data.WriteUint32(interval)) {
+        DISPLAY_LOG("error: %{public}s write interval into data failed", __func__);
+        return DISPLAY_FAILURE;
+    }
+    int32_t ret = Transact(DSP_CMD_SETWRITEBACKCADENCE, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -919,7 +1039,7 @@ int32_t DisplayDeviceProxy::SetProxyRemoteCallback(const OHOS::sptr<DisplayRegis
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SET_PROXY_REMOTE_CALLBACK, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SET_PROXY_REMOTE_CALLBACK, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -943,7 +1063,7 @@ int32_t DisplayDeviceProxy::InitDisplay(uint32_t devId)
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_INITDISPLAY, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_INITDISPLAY, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -967,7 +1087,7 @@ int32_t DisplayDeviceProxy::DeinitDisplay(uint32_t devId)
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_DEINITDISPLAY, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_DEINITDISPLAY, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -990,7 +1110,7 @@ int32_t DisplayDeviceProxy::GetDisplayInfo(uint32_t devId, DisplayInfo &dispInfo
         DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETDISPLAYINFO, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETDISPLAYINFO, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1022,7 +1142,7 @@ int32_t DisplayDeviceProxy::CreateLayer(uint32_t devId, const LayerInfo &layerIn
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_CREATELAYER, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_CREATELAYER, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1051,7 +1171,7 @@ int32_t DisplayDeviceProxy::CloseLayer(uint32_t devId, uint32_t layerId)
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_CLOSELAYER, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_CLOSELAYER, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1067,29 +1187,8 @@ int32_t DisplayDeviceProxy::SetLayerVisible(uint32_t devId, uint32_t layerId, bo
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteBool(visible)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERVISIBLE, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
-
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETLAYERVISIBLE, devId, layerId, static_cast<uint32_t>(visible));
 }
 
 int32_t DisplayDeviceProxy::GetLayerVisibleState(uint32_t devId, uint32_t layerId, bool &visible)
@@ -1110,7 +1209,7 @@ int32_t DisplayDeviceProxy::GetLayerVisibleState(uint32_t devId, uint32_t layerI
         DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETLAYERVISIBLESTATE, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETLAYERVISIBLESTATE, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1131,29 +1230,8 @@ int32_t DisplayDeviceProxy::SetLayerSize(uint32_t devId, uint32_t layerId, const
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!DisplayDeviceWriteData(&data, rect)) {
-        DISPLAY_LOG("error: write rect into data failed");
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERSIZE, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
-
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETLAYERSIZE, devId, layerId, *rect);
 }
 
 int32_t DisplayDeviceProxy::GetLayerSize(uint32_t devId, uint32_t layerId, IRect &rect)
@@ -1174,7 +1252,7 @@ int32_t DisplayDeviceProxy::GetLayerSize(uint32_t devId, uint32_t layerId, IRect
         DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETLAYERSIZE, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETLAYERSIZE, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1194,34 +1272,12 @@ int32_t DisplayDeviceProxy::SetLayerCrop(uint32_t devId, uint32_t layerId, const
         DISPLAY_LOG("rect is nullptr");
         return DISPLAY_PARAM_ERR;
     }
-
     if (devId > MAX_DEVID) {
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!DisplayDeviceWriteData(&data, rect)) {
-        DISPLAY_LOG("error: write rect into data failed");
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERCROP, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
-
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETLAYERCROP, devId, layerId, *rect);
 }
 
 int32_t DisplayDeviceProxy::SetLayerZorder(uint32_t devId, uint32_t layerId, uint32_t zorder)
@@ -1231,29 +1287,8 @@ int32_t DisplayDeviceProxy::SetLayerZorder(uint32_t devId, uint32_t layerId, uin
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(zorder)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERZORDER, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
-
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETLAYERZORDER, devId, layerId, zorder);
 }
 
 int32_t DisplayDeviceProxy::GetLayerZorder(uint32_t devId, uint32_t layerId, uint32_t &zorder)
@@ -1275,7 +1310,7 @@ int32_t DisplayDeviceProxy::GetLayerZorder(uint32_t devId, uint32_t layerId, uin
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETLAYERZORDER, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETLAYERZORDER, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1292,29 +1327,8 @@ int32_t DisplayDeviceProxy::SetLayerPreMulti(uint32_t devId, uint32_t layerId, b
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteBool(preMul)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERPREMULTI, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
-
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETLAYERPREMULTI, devId, layerId, static_cast<uint32_t>(preMul));
 }
 
 int32_t DisplayDeviceProxy::GetLayerPreMulti(uint32_t devId, uint32_t layerId, bool &preMul)
@@ -1335,7 +1349,7 @@ int32_t DisplayDeviceProxy::GetLayerPreMulti(uint32_t devId, uint32_t layerId, b
         DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETLAYERPREMULTI, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETLAYERPREMULTI, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1352,28 +1366,8 @@ int32_t DisplayDeviceProxy::SetLayerAlpha(uint32_t devId, uint32_t layerId, cons
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!DisplayDeviceWriteData(&data, &alpha)) {
-        DISPLAY_LOG("error: write alpha into data failed");
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERALPHA, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETLAYERALPHA, devId, layerId, alpha);
 }
 
 int32_t DisplayDeviceProxy::GetLayerAlpha(uint32_t devId, uint32_t layerId, LayerAlpha &alpha)
@@ -1395,7 +1389,7 @@ int32_t DisplayDeviceProxy::GetLayerAlpha(uint32_t devId, uint32_t layerId, Laye
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETLAYERALPHA, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETLAYERALPHA, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1415,32 +1409,9 @@ int32_t DisplayDeviceProxy::SetLayerColorKey(uint32_t devId, uint32_t layerId, b
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteBool(enable)) {
-        DISPLAY_LOG("error: %{public}s write enable into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(key)) {
-        DISPLAY_LOG("error: %{public}s write key into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERCOLORKEY, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
+    DisplayCmdColorKey colorKey = { static_cast<uint32_t>(enable), key };
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETLAYERCOLORKEY, devId, layerId, colorKey);
 }
 
 int32_t DisplayDeviceProxy::GetLayerColorKey(uint32_t devId, uint32_t layerId, bool *enable, uint32_t *key)
@@ -1461,7 +1432,7 @@ int32_t DisplayDeviceProxy::GetLayerColorKey(uint32_t devId, uint32_t layerId, b
         DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETLAYERCOLORKEY, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETLAYERCOLORKEY, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1504,7 +1475,7 @@ int32_t DisplayDeviceProxy::SetLayerPalette(uint32_t devId, uint32_t layerId, co
         DISPLAY_LOG("error: write enable into data failed");
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERPALETTE, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SETLAYERPALETTE, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1532,7 +1503,7 @@ int32_t DisplayDeviceProxy::GetLayerPalette(uint32_t devId, uint32_t layerId, ui
         return DISPLAY_FAILURE;
     }
 
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETLAYERPALETTE, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETLAYERPALETTE, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1553,28 +1524,8 @@ int32_t DisplayDeviceProxy::SetTransformMode(uint32_t devId, uint32_t layerId, T
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: %{public}s write devId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: %{public}s write layerId into data failed", __func__);
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteInt32(type)) {
-        DISPLAY_LOG("error: write type into data failed");
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETTRANSFORMMODE, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETTRANSFORMMODE, devId, layerId, static_cast<int32_t>(type));
 }
 
 int32_t DisplayDeviceProxy::SetLayerCompression(uint32_t devId, uint32_t layerId, int32_t compType)
@@ -1584,28 +1535,8 @@ int32_t DisplayDeviceProxy::SetLayerCompression(uint32_t devId, uint32_t layerId
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: write devId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: write layerId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteInt32(compType)) {
-        DISPLAY_LOG("error: write compType into data failed");
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERCOMPRESSION, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETLAYERCOMPRESSION, devId, layerId, compType);
 }
 
 int32_t DisplayDeviceProxy::GetLayerCompression(uint32_t devId, uint32_t layerId, int32_t &compType)
@@ -1626,7 +1557,7 @@ int32_t DisplayDeviceProxy::GetLayerCompression(uint32_t devId, uint32_t layerId
         DISPLAY_LOG("error: write layerId into data failed");
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETLAYERCOMPRESSION, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETLAYERCOMPRESSION, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1639,37 +1570,16 @@ int32_t DisplayDeviceProxy::GetLayerCompression(uint32_t devId, uint32_t layerId
 int32_t DisplayDeviceProxy::SetLayerDirtyRegion(uint32_t devId, uint32_t layerId, uint32_t num, const IRect &region)
 {
     DISPLAY_LOG("interface start");
+    if (num == 0) {
+        DISPLAY_LOG("num is 0");
+        return DISPLAY_PARAM_ERR;
+    }
     if (devId > MAX_DEVID) {
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: write devId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: write layerId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(num)) {
-        DISPLAY_LOG("error: write layerId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!DisplayDeviceWriteData(&data, &region, num)) {
-        DISPLAY_LOG("error: write layerId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERDIRTYREGION, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
-
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordRects(DSP_CMD_SETLAYERDIRTYREGION, devId, layerId, &region, num);
 }
 
 int32_t DisplayDeviceProxy::GetLayerBuffer(uint32_t devId, uint32_t layerId, LayerBuffer *buffer)
@@ -1696,7 +1606,7 @@ int32_t DisplayDeviceProxy::GetLayerBuffer(uint32_t devId, uint32_t layerId, Lay
         DISPLAY_LOG("error: write layerId into data failed");
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_GETLAYERBUFFER, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_GETLAYERBUFFER, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1739,7 +1649,7 @@ int32_t DisplayDeviceProxy::Flush(uint32_t devId, uint32_t layerId, LayerBuffer
         DISPLAY_LOG("error: server write buffer handle into data failed");
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_FLUSH, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_FLUSH, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1770,7 +1680,7 @@ int32_t DisplayDeviceProxy::WaitForVBlank(uint32_t devId, uint32_t layerId, int3
         DISPLAY_LOG("error: write timeOut into data failed");
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_WAITFORVBLANK, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_WAITFORVBLANK, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1793,7 +1703,7 @@ int32_t DisplayDeviceProxy::SnapShot(uint32_t devId, LayerBuffer &buffer)
         DISPLAY_LOG("error: write devId into data failed");
         return DISPLAY_FAILURE;
     }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SNAPSHOT, data, reply, option);
+    int32_t ret = Transact(DSP_CMD_SNAPSHOT, data, reply, option);
     if (ret != 0) {
         DISPLAY_LOG("error: failed %{public}d", ret);
         return ret;
@@ -1815,36 +1725,16 @@ int32_t DisplayDeviceProxy::SnapShot(uint32_t devId, LayerBuffer &buffer)
 int32_t DisplayDeviceProxy::SetLayerVisibleRegion(uint32_t devId, uint32_t layerId, uint32_t num, const IRect &rect)
 {
     DISPLAY_LOG("interface start");
+    if (num == 0) {
+        DISPLAY_LOG("num is 0");
+        return DISPLAY_PARAM_ERR;
+    }
     if (devId > MAX_DEVID) {
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: write devId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: write layerId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(num)) {
-        DISPLAY_LOG("error: write num into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!DisplayDeviceWriteData(&data, &rect, num)) {
-        DISPLAY_LOG("error: write rect into data failed");
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERVISIBLEREGION, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordRects(DSP_CMD_SETLAYERVISIBLEREGION, devId, layerId, &rect, num);
 }
 
 int32_t DisplayDeviceProxy::SetLayerBuffer(uint32_t devId, uint32_t layerId, const BufferHandle &buffer, int32_t fence)
@@ -1854,32 +1744,8 @@ int32_t DisplayDeviceProxy::SetLayerBuffer(uint32_t devId, uint32_t layerId, con
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: write devId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: write layerId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!DisplayDeviceWriteBufHdl(&data, &buffer)) {
-        DISPLAY_LOG("error: write layerId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!DisplayDeviceWriteFileDescriptor(&data, fence)) {
-        DISPLAY_LOG("error: write layerId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERBUFFER, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordBufHdl(DSP_CMD_SETLAYERBUFFER, devId, layerId, buffer, fence);
 }
 
 int32_t DisplayDeviceProxy::InvokeLayerCmd(uint32_t devId, uint32_t layerId, uint32_t cmd, ...)
@@ -1898,28 +1764,8 @@ int32_t DisplayDeviceProxy::SetLayerCompositionType(uint32_t devId, uint32_t lay
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: write devId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: write layerId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteInt32(type)) {
-        DISPLAY_LOG("error: write type into data failed");
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERCOMPOSITIONTYPE, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETLAYERCOMPOSITIONTYPE, devId, layerId, static_cast<int32_t>(type));
 }
 
 int32_t DisplayDeviceProxy::SetLayerBlendType(uint32_t devId, uint32_t layerId, BlendType type)
@@ -1929,26 +1775,6 @@ int32_t DisplayDeviceProxy::SetLayerBlendType(uint32_t devId, uint32_t layerId,
         DISPLAY_LOG("param error");
         return DISPLAY_PARAM_ERR;
     }
-    MessageParcel data;
-    MessageParcel reply;
-    MessageOption option;
-    if (!data.WriteInterfaceToken(DisplayDeviceProxy::GetDescriptor()) || !data.WriteUint32(devId)) {
-        DISPLAY_LOG("error: write devId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteUint32(layerId)) {
-        DISPLAY_LOG("error: write layerId into data failed");
-        return DISPLAY_FAILURE;
-    }
-    if (!data.WriteInt32(type)) {
-        DISPLAY_LOG("error: write type into data failed");
-        return DISPLAY_FAILURE;
-    }
-    int32_t ret = Remote()->SendRequest(DSP_CMD_SETLAYERBLENDTYPE, data, reply, option);
-    if (ret != 0) {
-        DISPLAY_LOG("error: failed %{public}d", ret);
-        return ret;
-    }
     DISPLAY_LOG("interface end");
-    return ret;
+    return RecordCmd(DSP_CMD_SETLAYERBLENDTYPE, devId, layerId, static_cast<int32_t>(type));
 }
@@ -15,6 +15,8 @@
 
 #include <hdf_remote_service.h>
 #include <hdf_sbuf_ipc.h>
+#include <unistd.h>
+#include <vector>
 
 #include "display_device_common.h"
 #include "display_device_service.h"
@@ -39,7 +41,7 @@ static const DisplayDeviceServerStubFunc g_displayDeviceServerFuncTbl[HDF_DISPLA
                                                                      [HDF_DISPLAY_DRIVER_FUNC_NUM_MAX]
     = {
           /* reserved */
-          {},
+          { nullptr, DDSS::ExecuteCmd },
           /* DEVICE */
           { nullptr, nullptr, nullptr, DDSS::RegHotPlugCallback, DDSS::GetDisplayCapability,
               DDSS::GetDisplaySupportedModes, DDSS::GetDisplayMode, DDSS::SetDisplayMode, DDSS::GetDisplayPowerStatus,
@@ -50,7 +52,8 @@ static const DisplayDeviceServerStubFunc g_displayDeviceServerFuncTbl[HDF_DISPLA
               nullptr, DDSS::RegDisplayVBlankCallback, nullptr, DDSS::GetDisplayReleaseFence, DDSS::Commit,
               DDSS::InvokeDisplayCmd, DDSS::CreateVirtualDisplay, DDSS::DestroyVirtualDisplay,
               DDSS::SetVirtualDisplayBuffer, DDSS::RegDisplayRefreshCallback, DDSS::GetWriteBackFrame,
-              DDSS::CreateWriteBack, DDSS::DestroyWriteBack, DDSS::SetProxyRemoteCallback, DDSS::FileTest },
+              DDSS::CreateWriteBack, DDSS::DestroyWriteBack, DDSS::SetProxyRemoteCallback, DDSS::SetWriteBackCadence,
+              DDSS::FileTest },
           /* LAYER */
           { nullptr, nullptr, nullptr, DDSS::CreateLayer, nullptr, DDSS::SetLayerVisible, DDSS::GetLayerVisibleState,
               nullptr, nullptr, DDSS::SetLayerCrop, DDSS::SetLayerZorder, DDSS::GetLayerZorder, DDSS::SetLayerPreMulti,
@@ -63,6 +66,21 @@ static const DisplayDeviceServerStubFunc g_displayDeviceServerFuncTbl[HDF_DISPLA
               DDSS::FileTest },
       };
 
+template <typename T>
+static bool ReadCmdPayload(const DisplayCmdHeader &header, const uint8_t *payload, T &value)
+{
+    return (header.size == sizeof(T)) && (memcpy_s(&value, sizeof(T), payload, sizeof(T)) == EOK);
+}
+
+static bool ReadCmdRects(const DisplayCmdHeader &header, const uint8_t *payload, std::vector<IRect> &rects)
+{
+    if ((header.size == 0) || (header.size % sizeof(IRect) != 0)) {
+        return false;
+    }
+    rects.resize(header.size / sizeof(IRect));
+    return memcpy_s(rects.data(), header.size, payload, header.size) == EOK;
+}
+
 static int32_t DisplayDeviceServiceDispatch(
     struct HdfDeviceIoClient *client, int cmdId, struct HdfSBuf *data, struct HdfSBuf *reply)
 {
@@ -170,6 +188,154 @@ int32_t DisplayDeviceServerStub::OnRemoteRequest(int cmdId, MessageParcel *data,
     return ret;
 }
 
+int32_t DisplayDeviceServerStub::ExecuteCmd(MessageParcel *data, MessageParcel *reply)
+{
+    DISPLAY_START;
+    if (data->ReadInterfaceToken() != DisplayDeviceServerStub::GetDescriptor()) {
+        HDF_LOGE("failed to check interface token");
+        return HDF_ERR_INVALID_PARAM;
+    }
+    int32_t ret = ExecuteBatch(data);
+    if (!reply->WriteInt32(ret)) {
+        DISPLAY_LOG("error: server write ret into reply failed");
+        return DISPLAY_FAILURE;
+    }
+    DISPLAY_END;
+    return DISPLAY_SUCCESS;
+}
+
+int32_t DisplayDeviceServerStub::ExecuteBatch(MessageParcel *data)
+{
+    // binder threads serve several clients at once, so the reader lives for this transaction only
+    DisplayCmdReader reader;
+    if (!reader.Read(*data)) {
+        DISPLAY_LOG("error: read layer commands from data failed");
+        return DISPLAY_FAILURE;
+    }
+    DisplayCmdHeader header;
+    const uint8_t *payload = nullptr;
+    uint32_t count = 0;
+    int32_t ret = DISPLAY_SUCCESS;
+    for (; (count < reader.GetCount()) && reader.Next(header, payload); count++) {
+        // the calls no longer return to the client one by one, a failed command is logged and the rest still run
+        int32_t cmdRet = DispatchCmd(reader, header, payload);
+        if (cmdRet != DISPLAY_SUCCESS) {
+            DISPLAY_LOG("error: cmdId 0x%{public}x devId %{public}u layerId %{public}u failed %{public}d", header.cmdId,
+                header.devId, header.layerId, cmdRet);
+            ret = (ret == DISPLAY_SUCCESS) ? cmdRet : ret;
+        }
+    }
+    // the device duplicates the fds it keeps, the reader closes the rest
+    if (count != reader.GetCount()) {
+        DISPLAY_LOG("error: only %{public}u of %{public}u commands are valid", count, reader.GetCount());
+        return (ret == DISPLAY_SUCCESS) ? DISPLAY_FAILURE : ret;
+    }
+    return ret;
+}
+
+int32_t DisplayDeviceServerStub::DispatchCmd(const DisplayCmdReader &reader, const DisplayCmdHeader &header,
+    const uint8_t *payload)
+{
+    uint32_t devId = header.devId;
+    uint32_t layerId = header.layerId;
+    uint32_t value = 0;
+    int32_t enumTmp = 0;
+    IRect rect;
+    LayerAlpha alpha;
+    DisplayCmdColorKey colorKey;
+    std::vector<IRect> rects;
+    std::vector<uint8_t> storage;
+    BufferHandle *bufhandle = nullptr;
+    int32_t fence = -1;
+    switch (header.cmdId) {
+        case DSP_CMD_SETDISPLAYCLIENTBUFFER:
+            if (!reader.ReadBufHdl(header, payload, storage, bufhandle, fence)) {
+                break;
+            }
+            return device_->SetDisplayClientBuffer(devId, *bufhandle, fence);
+        case DSP_CMD_SETDISPLAYCLIENTDAMAGE:
+            if (!ReadCmdRects(header, payload, rects)) {
+                break;
+            }
+            return device_->SetDisplayClientDamage(devId, static_cast<uint32_t>(rects.size()), rects[0]);
+        case DSP_CMD_SETLAYERVISIBLE:
+            if (!ReadCmdPayload(header, payload, value)) {
+                break;
+            }
+            return device_->SetLayerVisible(devId, layerId, value != 0);
+        case DSP_CMD_SETLAYERCROP:
+            if (!ReadCmdPayload(header, payload, rect)) {
+                break;
+            }
+            return device_->SetLayerCrop(devId, layerId, &rect);
+        case DSP_CMD_SETLAYERZORDER:
+            if (!ReadCmdPayload(header, payload, value)) {
+                break;
+            }
+            return device_->SetLayerZorder(devId, layerId, value);
+        case DSP_CMD_SETLAYERPREMULTI:
+            if (!ReadCmdPayload(header, payload, value)) {
+                break;
+            }
+            return device_->SetLayerPreMulti(devId, layerId, value != 0);
+        case DSP_CMD_SETLAYERALPHA:
+            if (!ReadCmdPayload(header, payload, alpha)) {
+                break;
+            }
+            return device_->SetLayerAlpha(devId, layerId, alpha);
+        case DSP_CMD_SETLAYERCOLORKEY:
+            if (!ReadCmdPayload(header, payload, colorKey)) {
+                break;
+            }
+            return device_->SetLayerColorKey(devId, layerId, colorKey.enable != 0, colorKey.key);
+        case DSP_CMD_SETLAYERCOMPRESSION:
+            if (!ReadCmdPayload(header, payload, enumTmp)) {
+                break;
+            }
+            return device_->SetLayerCompression(devId, layerId, enumTmp);
+        case DSP_CMD_SETLAYERVISIBLEREGION:
+            if (!ReadCmdRects(header, payload, rects)) {
+                break;
+            }
+            return device_->SetLayerVisibleRegion(devId, layerId, static_cast<uint32_t>(rects.size()), rects[0]);
+        case DSP_CMD_SETLAYERDIRTYREGION:
+            if (!ReadCmdRects(header, payload, rects)) {
+                break;
+            }
+            return device_->SetLayerDirtyRegion(devId, layerId, static_cast<uint32_t>(rects.size()), rects[0]);
+        case DSP_CMD_SETLAYERBUFFER:
+            if (!reader.ReadBufHdl(header, payload, storage, bufhandle, fence)) {
+                break;
+            }
+            return device_->SetLayerBuffer(devId, layerId, *bufhandle, fence);
+        case DSP_CMD_SETLAYERCOMPOSITIONTYPE:
+            if (!ReadCmdPayload(header, payload, enumTmp)) {
+                break;
+            }
+            return device_->SetLayerCompositionType(devId, layerId, Convert2CompositionType(enumTmp));
+        case DSP_CMD_SETLAYERSIZE:
+            if (!ReadCmdPayload(header, payload, rect)) {
+                break;
+            }
+            return device_->SetLayerSize(devId, layerId, &rect);
+        case DSP_CMD_SETTRANSFORMMODE:
+            if (!ReadCmdPayload(header, payload, enumTmp)) {
+                break;
+            }
+            return device_->SetTransformMode(devId, layerId, Convert2TransformType(enumTmp));
+        case DSP_CMD_SETLAYERBLENDTYPE:
+            if (!ReadCmdPayload(header, payload, enumTmp)) {
+                break;
+            }
+            return device_->SetLayerBlendType(devId, layerId, Convert2BlendTypeType(enumTmp));
+        default:
+            DISPLAY_LOG("error: cmdId 0x%{public}x can not be batched", header.cmdId);
+            return DISPLAY_NOT_SUPPORT;
+    }
+    DISPLAY_LOG("error: payload of cmdId 0x%{public}x is malformed", header.cmdId);
+    return DISPLAY_PARAM_ERR;
+}
+
 static void HotPlugCallbackFunc(uint32_t devId, bool connected, void *data)
 {
     HDF_LOGI("hotplug callback %{public}d %{public}d", devId, connected);
@@ -485,6 +651,10 @@ int32_t DisplayDeviceServerStub::PrepareDisplayLayers(MessageParcel *data, Messa
         DISPLAY_LOG("read devId from data failed!");
         return DISPLAY_FAILURE;
     }
+    int32_t batchRet = ExecuteBatch(data);
+    if (batchRet != DISPLAY_SUCCESS) {
+        DISPLAY_LOG("error: layer commands before prepare failed %{public}d", batchRet);
+    }
     bool needFlushFb = false;
 
     int32_t ret = device_->PrepareDisplayLayers(devId, needFlushFb);
@@ -492,7 +662,7 @@ int32_t DisplayDeviceServerStub::PrepareDisplayLayers(MessageParcel *data, Messa
     if (ret != HDF_SUCCESS) {
         return ret;
     }
-    if (!reply->WriteBool(needFlushFb)) {
+    if (!reply->WriteBool(needFlushFb) || !reply->WriteInt32(batchRet)) {
         DISPLAY_LOG("error: server write needFlushFb into data failed");
         return DISPLAY_FAILURE;
     }
@@ -768,6 +938,10 @@ int32_t DisplayDeviceServerStub::Commit(MessageParcel *data, MessageParcel *repl
         DISPLAY_LOG("read devId from data failed!");
         return DISPLAY_FAILURE;
     }
+    int32_t batchRet = ExecuteBatch(data);
+    if (batchRet != DISPLAY_SUCCESS) {
+        DISPLAY_LOG("error: layer commands before commit failed %{public}d", batchRet);
+    }
 
     int32_t fenceTmp = -1;
     int32_t ret = device_->Commit(devId, fenceTmp);
@@ -775,7 +949,7 @@ int32_t DisplayDeviceServerStub::Commit(MessageParcel *data, MessageParcel *repl
     if (ret != HDF_SUCCESS) {
         return ret;
     }
-    if (!DisplayDeviceWriteFileDescriptor(reply, fenceTmp)) {
+    if (!DisplayDeviceWriteFileDescriptor(reply, fenceTmp) || !reply->WriteInt32(batchRet)) {
         DISPLAY_LOG("error: write value into data failed");
         return DISPLAY_FAILURE;
     }
@@ -911,23 +1085,114 @@ int32_t DisplayDeviceServerStub::RegDisplayRefreshCallback(MessageParcel *data,
 
 int32_t DisplayDeviceServerStub::GetWriteBackFrame(MessageParcel *data, MessageParcel *reply)
 {
-    (void)data;
-    (void)reply;
-    return DISPLAY_NOT_SUPPORT;
+    DISPLAY_START;
+    if (data->ReadInterfaceToken() != DisplayDeviceServerStub::GetDescriptor()) {
+        HDF_LOGE("failed to check interface token");
+        return HDF_ERR_INVALID_PARAM;
+    }
+    uint32_t devId = 0;
+    if (!data->ReadUint32(devId)) {
+        DISPLAY_LOG("read devId from data failed!");
+        return DISPLAY_FAILURE;
+    }
+    int32_t fenceTmp = -1;
+    if (!DisplayDeviceReadFileDescriptor(&fenceTmp, data)) {
+        DISPLAY_LOG("read fence from data failed!");
+        return DISPLAY_FAILURE;
+    }
+    BufferHandle bufferTmp = {};
+    bufferTmp.fd = -1;
+    int32_t ret = device_->GetWriteBackFrame(devId, bufferTmp, fenceTmp);
+    DISPLAY_LOG("call impl ret = %{public}d", ret);
+    if (ret != HDF_SUCCESS) {
+        // the release fence stays with the caller when no frame is handed out
+        if (fenceTmp >= 0) {
+            close(fenceTmp);
+        }
+        return ret;
+    }
+    bool written = DisplayDeviceWriteBufHdl(reply, &bufferTmp) && DisplayDeviceWriteFileDescriptor(reply, fenceTmp);
+    // the reply holds its own copies of the fds
+    close(bufferTmp.fd);
+    if (fenceTmp >= 0) {
+        close(fenceTmp);
+    }
+    if (!written) {
+        DISPLAY_LOG("error: write frame into reply failed");
+        return DISPLAY_FAILURE;
+    }
+    DISPLAY_END;
+    return ret;
 }
 
 int32_t DisplayDeviceServerStub::CreateWriteBack(MessageParcel *data, MessageParcel *reply)
 {
-    (void)data;
-    (void)reply;
-    return DISPLAY_NOT_SUPPORT;
+    DISPLAY_START;
+    if (data->ReadInterfaceToken() != DisplayDeviceServerStub::GetDescriptor()) {
+        HDF_LOGE("failed to check interface token");
+        return HDF_ERR_INVALID_PARAM;
+    }
+    uint32_t devId = 0;
+    uint32_t widthTmp = 0;
+    uint32_t heightTmp = 0;
+    int32_t formatTmp = 0;
+    if (!data->ReadUint32(devId) || !data->ReadUint32(widthTmp) || !data->ReadUint32(heightTmp) ||
+        !data->ReadInt32(formatTmp)) {
+        DISPLAY_LOG("read writeback params from data failed!");
+        return DISPLAY_FAILURE;
+    }
+    int32_t ret = device_->CreateWriteBack(devId, widthTmp, heightTmp, formatTmp);
+    DISPLAY_LOG("call impl ret=%{public}d,format=%{public}d,devid= %{public}d", ret, formatTmp, devId);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    if (!reply->WriteUint32(devId)) {
+        DISPLAY_LOG("error: write devId into data failed");
+        return DISPLAY_FAILURE;
+    }
+    if (!reply->WriteInt32(formatTmp)) {
+        DISPLAY_LOG("error: write format into data failed");
+        return DISPLAY_FAILURE;
+    }
+    DISPLAY_END;
+    return DISPLAY_SUCCESS;
 }
 
 int32_t DisplayDeviceServerStub::DestroyWriteBack(MessageParcel *data, MessageParcel *reply)
 {
-    (void)data;
-    (void)reply;
-    return DISPLAY_NOT_SUPPORT;
+    DISPLAY_START;
+    if (data->ReadInterfaceToken() != DisplayDeviceServerStub::GetDescriptor()) {
+        HDF_LOGE("failed to check interface token");
+        return HDF_ERR_INVALID_PARAM;
+    }
+    uint32_t devId = 0;
+    if (!data->ReadUint32(devId)) {
+        DISPLAY_LOG("read devId from data failed!");
+        return DISPLAY_FAILURE;
+    }
+    int32_t ret = device_->DestroyWriteBack(devId);
+    DISPLAY_LOG("call impl ret = %{public}d", ret);
+    DISPLAY_END;
+    return ret;
+}
+
+int32_t DisplayDeviceServerStub::SetWriteBackCadence(MessageParcel *data, MessageParcel *reply)
+{
+    DISPLAY_START;
+    if (data->ReadInterfaceToken() != DisplayDeviceServerStub::GetDescriptor()) {
+        HDF_LOGE("failed to check interface token");
+        return HDF_ERR_INVALID_PARAM;
+    }
+    uint32_t devId = 0;
+    uint32_t intervalTmp = 0;
+    if (!data->ReadUint32(devId) || !data->ReadUint32(intervalTmp)) {
+        DISPLAY_LOG("read cadence params from data failed!");
+        return DISPLAY_FAILURE;
+    }
+    int32_t ret = device_->SetWriteBackCadence(devId, intervalTmp);
+    DISPLAY_LOG("call impl ret = %{public}d", ret);
+    DISPLAY_END;
+    return ret;
 }
 
 int32_t DisplayDeviceServerStub::FileTest(MessageParcel *data, MessageParcel *reply)
@@ -177,25 +177,34 @@ int32_t DisplayDeviceService::RegDisplayRefreshCallback(uint32_t devId, RefreshC
 
 int32_t DisplayDeviceService::GetWriteBackFrame(uint32_t devId, BufferHandle &buffer, int32_t &fence)
 {
-    (void)devId;
-    (void)buffer;
-    (void)fence;
-    return HDF_ERR_NOT_SUPPORT;
+    if (displayDevice_->GetWriteBackFrame == nullptr) {
+        return DISPLAY_NOT_SUPPORT;
+    }
+    return displayDevice_->GetWriteBackFrame(devId, &buffer, &fence);
 }
 
 int32_t DisplayDeviceService::CreateWriteBack(uint32_t &devId, uint32_t width, uint32_t height, int32_t &format)
 {
-    (void)devId;
-    (void)width;
-    (void)height;
-    (void)format;
-    return HDF_ERR_NOT_SUPPORT;
+    if (displayDevice_->CreateWriteBack == nullptr) {
+        return DISPLAY_NOT_SUPPORT;
+    }
+    return displayDevice_->CreateWriteBack(&devId, width, height, &format);
 }
 
 int32_t DisplayDeviceService::DestroyWriteBack(uint32_t devId)
 {
-    (void)devId;
-    return HDF_ERR_NOT_SUPPORT;
+    if (displayDevice_->DestroyWriteBack == nullptr) {
+        return DISPLAY_NOT_SUPPORT;
+    }
+    return displayDevice_->DestroyWriteBack(devId);
+}
+
+int32_t DisplayDeviceService::SetWriteBackCadence(uint32_t devId, uint32_t interval)
+{
+    if (displayDevice_->SetWriteBackCadence == nullptr) {
+        return DISPLAY_NOT_SUPPORT;
+    }
+    return displayDevice_->SetWriteBackCadence(devId, interval);
 }
 
 int32_t DisplayDeviceService::SetProxyRemoteCallback(const OHOS::sptr<DisplayRegisterCallbackBase> &callback)
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "display_device_cmd_buffer.h"
+#undef HDF_LOG_TAG
+#define HDF_LOG_TAG DisplayCmdBuffer
+
+namespace OHOS {
+namespace Display {
+namespace Device {
+namespace {
+// a frame of ten layers takes a few kilobytes, the region grows in powers of two beyond that
+const uint32_t CMD_ASHMEM_MIN_SIZE = 16 * 1024;
+const uint32_t CMD_FDS_MAX = 1024;
+const char *CMD_ASHMEM_NAME = "display_cmd_buffer";
+
+void ReleaseAshmem(sptr<Ashmem> &ashmem)
+{
+    if (ashmem != nullptr) {
+        ashmem->UnmapAshmem();
+        ashmem->CloseAshmem();
+        ashmem = nullptr;
+    }
+}
+}
+
+DisplayCmdWriter::~DisplayCmdWriter()
+{
+    Reset();
+    ReleaseAshmem(ashmem_);
+}
+
+void DisplayCmdWriter::Reset()
+{
+    for (int32_t fd : fds_) {
+        close(fd);
+    }
+    fds_.clear();
+    cmds_.clear();
+    count_ = 0;
+}
+
+int32_t DisplayCmdWriter::AddFd(int32_t fd)
+{
+    if (fd < 0) {
+        return -1;
+    }
+    int32_t dupFd = dup(fd);
+    if (dupFd < 0) {
+        DISPLAY_LOG("error: dup fd %{public}d failed", fd);
+        return -1;
+    }
+    fds_.push_back(dupFd);
+    return static_cast<int32_t>(fds_.size() - 1);
+}
+
+void DisplayCmdWriter::WriteRaw(uint32_t cmdId, uint32_t devId, uint32_t layerId, const void *payload,
+    uint32_t size)
+{
+    DisplayCmdHeader header = { cmdId, devId, layerId, size };
+    const uint8_t *headerBytes = reinterpret_cast<const uint8_t *>(&header);
+    const uint8_t *payloadBytes = static_cast<const uint8_t *>(payload);
+    cmds_.insert(cmds_.end(), headerBytes, headerBytes + sizeof(header));
+    cmds_.insert(cmds_.end(), payloadBytes, payloadBytes + size);
+    count_++;
+}
+
+void DisplayCmdWriter::WriteRects(uint32_t cmdId, uint32_t devId, uint32_t layerId, const IRect *rects,
+    uint32_t num)
+{
+    WriteRaw(cmdId, devId, layerId, rects, sizeof(IRect) * num);
+}
+
+bool DisplayCmdWriter::WriteBufHdl(uint32_t cmdId, uint32_t devId, uint32_t layerId,
+    const BufferHandle &handle, int32_t fence)
+{
+    DisplayCmdBufHdl hdl = {
+        .fd = AddFd(handle.fd),
+        .width = handle.width,
+        .stride = handle.stride,
+        .height = handle.height,
+        .size = handle.size,
+        .format = handle.format,
+        .usage = handle.usage,
+        .phyAddr = handle.phyAddr,
+        .key = handle.key,
+        .reserveFds = handle.reserveFds,
+        .reserveInts = handle.reserveInts,
+        .fence = AddFd(fence),
+    };
+    if (hdl.fd < 0) {
+        DISPLAY_LOG("error: the buffer fd %{public}d is invalid", handle.fd);
+        return false;
+    }
+    std::vector<int32_t> payload(sizeof(hdl) / sizeof(int32_t));
+    if (memcpy_s(payload.data(), sizeof(hdl), &hdl, sizeof(hdl)) != EOK) {
+        return false;
+    }
+    for (uint32_t i = 0; i < handle.reserveFds; i++) {
+        payload.push_back(AddFd(handle.reserve[i]));
+    }
+    for (uint32_t i = 0; i < handle.reserveInts; i++) {
+        payload.push_back(handle.reserve[handle.reserveFds + i]);
+    }
+    WriteRaw(cmdId, devId, layerId, payload.data(), payload.size() * sizeof(int32_t));
+    return true;
+}
+
+bool DisplayCmdWriter::Flush(MessageParcel &parcel)
+{
+    if (!parcel.WriteUint32(count_)) {
+        DISPLAY_LOG("error: write command number failed");
+        Reset();
+        return false;
+    }
+    if (count_ == 0) {
+        return true;
+    }
+    uint32_t used = static_cast<uint32_t>(cmds_.size());
+    if ((ashmem_ == nullptr) || (static_cast<uint32_t>(ashmem_->GetAshmemSize()) < used)) {
+        uint32_t size = CMD_ASHMEM_MIN_SIZE;
+        while (size < used) {
+            size <<= 1;
+        }
+        ReleaseAshmem(ashmem_);
+        ashmem_ = Ashmem::CreateAshmem(CMD_ASHMEM_NAME, static_cast<int32_t>(size));
+        if ((ashmem_ == nullptr) || !ashmem_->MapReadAndWriteAshmem()) {
+            DISPLAY_LOG("error: create command ashmem of %{public}u bytes failed", size);
+            ReleaseAshmem(ashmem_);
+            Reset();
+            return false;
+        }
+    }
+    bool ret = ashmem_->WriteToAshmem(cmds_.data(), static_cast<int32_t>(used), 0) && parcel.WriteAshmem(ashmem_) &&
+        parcel.WriteUint32(used) && parcel.WriteUint32(static_cast<uint32_t>(fds_.size()));
+    for (size_t i = 0; ret && (i < fds_.size()); i++) {
+        ret = parcel.WriteFileDescriptor(fds_[i]);
+    }
+    if (!ret) {
+        DISPLAY_LOG("error: write %{public}u commands into parcel failed", count_);
+    }
+    // the parcel holds its own copies of the fds
+    Reset();
+    return ret;
+}
+
+DisplayCmdReader::~DisplayCmdReader()
+{
+    CloseFds();
+    ReleaseAshmem(ashmem_);
+}
+
+void DisplayCmdReader::CloseFds()
+{
+    for (int32_t fd : fds_) {
+        close(fd);
+    }
+    fds_.clear();
+}
+
+bool DisplayCmdReader::Read(MessageParcel &parcel)
+{
+    CloseFds();
+    ReleaseAshmem(ashmem_);
+    cmds_ = nullptr;
+    used_ = 0;
+    offset_ = 0;
+    count_ = parcel.ReadUint32();
+    if (count_ == 0) {
+        return true;
+    }
+    ashmem_ = parcel.ReadAshmem();
+    if ((ashmem_ == nullptr) || !ashmem_->MapReadOnlyAshmem()) {
+        DISPLAY_LOG("error: map command ashmem failed");
+        ReleaseAshmem(ashmem_);
+        return false;
+    }
+    used_ = parcel.ReadUint32();
+    if (used_ > static_cast<uint32_t>(ashmem_->GetAshmemSize())) {
+        DISPLAY_LOG("error: %{public}u command bytes overflow the ashmem", used_);
+        return false;
+    }
+    cmds_ = static_cast<const uint8_t *>(ashmem_->ReadFromAshmem(static_cast<int32_t>(used_), 0));
+    uint32_t fdCount = parcel.ReadUint32();
+    if ((cmds_ == nullptr) || (fdCount > CMD_FDS_MAX)) {
+        DISPLAY_LOG("error: invalid batch of %{public}u bytes %{public}u fds", used_, fdCount);
+        return false;
+    }
+    for (uint32_t i = 0; i < fdCount; i++) {
+        int32_t fd = parcel.ReadFileDescriptor();
+        if (fd < 0) {
+            DISPLAY_LOG("error: read command fd %{public}u failed", i);
+            return false;
+        }
+        fds_.push_back(fd);
+    }
+    return true;
+}
+
+bool DisplayCmdReader::Next(DisplayCmdHeader &header, const uint8_t *&payload)
+{
+    if ((cmds_ == nullptr) || (used_ - offset_ < sizeof(header))) {
+        return false;
+    }
+    if (memcpy_s(&header, sizeof(header), cmds_ + offset_, sizeof(header)) != EOK) {
+        return false;
+    }
+    offset_ += sizeof(header);
+    if (header.size > used_ - offset_) {
+        DISPLAY_LOG("error: command 0x%{public}x overflows the batch", header.cmdId);
+        offset_ = used_;
+        return false;
+    }
+    payload = cmds_ + offset_;
+    offset_ += header.size;
+    return true;
+}
+
+int32_t DisplayCmdReader::GetFd(int32_t index) const
+{
+    return ((index < 0) || (static_cast<size_t>(index) >= fds_.size())) ? -1 : fds_[index];
+}
+
+bool DisplayCmdReader::ReadBufHdl(const DisplayCmdHeader &header, const uint8_t *payload,
+    std::vector<uint8_t> &storage, BufferHandle *&handle, int32_t &fence) const
+{
+    DisplayCmdBufHdl hdl;
+    if ((header.size < sizeof(hdl)) || (memcpy_s(&hdl, sizeof(hdl), payload, sizeof(hdl)) != EOK)) {
+        return false;
+    }
+    uint64_t reserveCount = static_cast<uint64_t>(hdl.reserveFds) + hdl.reserveInts;
+    if (header.size != sizeof(hdl) + reserveCount * sizeof(int32_t)) {
+        DISPLAY_LOG("error: buffer handle of %{public}u bytes is malformed", header.size);
+        return false;
+    }
+    storage.assign(sizeof(BufferHandle) + reserveCount * sizeof(int32_t), 0);
+    handle = reinterpret_cast<BufferHandle *>(storage.data());
+    handle->fd = GetFd(hdl.fd);
+    handle->width = hdl.width;
+    handle->stride = hdl.stride;
+    handle->height = hdl.height;
+    handle->size = hdl.size;
+    handle->format = hdl.format;
+    handle->usage = hdl.usage;
+    handle->virAddr = nullptr;
+    handle->phyAddr = hdl.phyAddr;
+    handle->key = hdl.key;
+    handle->reserveFds = hdl.reserveFds;
+    handle->reserveInts = hdl.reserveInts;
+    const uint8_t *reserve = payload + sizeof(hdl);
+    for (uint32_t i = 0; i < reserveCount; i++) {
+        int32_t value = 0;
+        if (memcpy_s(&value, sizeof(value), reserve + i * sizeof(int32_t), sizeof(int32_t)) != EOK) {
+            return false;
+        }
+        handle->reserve[i] = (i < hdl.reserveFds) ? GetFd(value) : value;
+    }
+    fence = GetFd(hdl.fence);
+    return handle->fd >= 0;
+}
+} // namespace Device
+} // namespace Display
+} // namespace OHOS
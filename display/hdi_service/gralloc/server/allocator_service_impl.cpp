@@ -29,7 +29,8 @@ namespace Display {
 namespace V1_0 {
 AllocatorService::AllocatorService() : grallocFuncs_(nullptr)
 {
-    if (GrallocInitialize(&grallocFuncs_) != HDF_SUCCESS) {
+    // the buffers are handed to the clients, recycling them here would give the same memory to two clients
+    if (GrallocInitializeWithPool(&grallocFuncs_, 0) != HDF_SUCCESS) {
         HDF_LOGE("%{public}s: gralloc init failed", __func__);
     }
 }
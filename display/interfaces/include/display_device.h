@@ -650,6 +650,73 @@ typedef struct {
      * @version 1.0
      */
     int32_t (*DestroyWriteBack)(uint32_t devId);
+
+    /* *
+     * @brief Registers a listener to be invoked on every VBLANK of a display device.
+     *
+     * Unlike the callback of <b>RegDisplayVBlankCallback</b>, a display can have several listeners, and they are
+     * invoked until unregistered regardless of <b>SetDisplayVsyncEnabled</b>. Registering the same callback and
+     * data again updates the phase.
+     *
+     * @param devId Indicates the ID of the display device.
+     * @param callback Indicates the callback to invoke.
+     * @param data Indicates the pointer to the private data returned in the callback.
+     * @param phaseNs Indicates the offset of the callback to the VBLANK in nanoseconds, within one refresh period.
+     * A negative offset wakes the listener before the predicted VBLANK, which is then passed to the callback.
+     *
+     * @return Returns <b>0</b> if the operation is successful; returns an error code defined
+     * in {@link DispErrCode} otherwise.
+     * @since 1.0
+     * @version 1.0
+     */
+    int32_t (*RegDisplayVBlankListener)(uint32_t devId, VBlankCallback callback, void *data, int64_t phaseNs);
+
+    /* *
+     * @brief Unregisters a listener registered by <b>RegDisplayVBlankListener</b>.
+     *
+     * @param devId Indicates the ID of the display device.
+     * @param callback Indicates the callback of the listener.
+     * @param data Indicates the private data of the listener.
+     *
+     * @return Returns <b>0</b> if the operation is successful; returns an error code defined
+     * in {@link DispErrCode} otherwise.
+     * @since 1.0
+     * @version 1.0
+     */
+    int32_t (*UnregDisplayVBlankListener)(uint32_t devId, VBlankCallback callback, void *data);
+
+    /* *
+     * @brief Predicts the time of the next VBLANK of a display device.
+     *
+     * The prediction is fitted to the timestamps of recent VBLANK and page flip events, so it fails until the
+     * display has been refreshed or has delivered VBLANK events for a few frames.
+     *
+     * @param devId Indicates the ID of the display device.
+     * @param ns Indicates the pointer to the CLOCK_MONOTONIC time of the next VBLANK in nanoseconds.
+     * @param period Indicates the pointer to the refresh period in nanoseconds.
+     *
+     * @return Returns <b>0</b> if the operation is successful; returns an error code defined
+     * in {@link DispErrCode} otherwise.
+     * @since 1.0
+     * @version 1.0
+     */
+    int32_t (*GetDisplayNextVBlank)(uint32_t devId, uint64_t *ns, uint64_t *period);
+
+    /* *
+     * @brief Sets how often a writeback endpoint captures the frames committed to its display.
+     *
+     * Every <b>interval</b>-th committed frame is captured, starting with the next one. <b>0</b> stops the captures,
+     * <b>GetWriteBackFrame</b> then keeps returning the last captured frame. A new endpoint captures every frame.
+     *
+     * @param devId Indicates the ID of the writeback endpoint returned by <b>CreateWriteBack</b>.
+     * @param interval Indicates the number of committed frames per captured frame.
+     *
+     * @return Returns <b>0</b> if the operation is successful; returns an error code defined
+     * in {@link DispErrCode} otherwise.
+     * @since 1.0
+     * @version 1.0
+     */
+    int32_t (*SetWriteBackCadence)(uint32_t devId, uint32_t interval);
 } DeviceFuncs;
 
 /**
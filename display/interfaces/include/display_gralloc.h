@@ -169,6 +169,22 @@ typedef struct {
  */
 int32_t GrallocInitialize(GrallocFuncs **funcs);
 
+/**
+ * @brief Initializes the memory module like {@link GrallocInitialize}, with the size of the free buffer pool.
+ *
+ * The pool is off by default. The pool size is fixed by the first initialization in the process and ignored
+ * afterwards. A freed buffer whose fd was shared with another owner is destroyed instead of pooled.
+ *
+ * @param funcs Indicates the double pointer to functions for memory operations.
+ * @param poolMaxBytes Indicates the memory the free buffers may hold, <b>0</b> turns the pool off.
+ *
+ * @return Returns <b>0</b> if the operation is successful; returns an error code defined in {@link DispErrCode}
+ * otherwise.
+ * @since 1.0
+ * @version 1.0
+ */
+int32_t GrallocInitializeWithPool(GrallocFuncs **funcs, uint64_t poolMaxBytes);
+
 /**
  * @brief Deinitializes the memory module to release the memory allocated to the pointer to functions for memory
  * operations.
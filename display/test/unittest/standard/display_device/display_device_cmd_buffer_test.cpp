@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "display_device_cmd_buffer_test.h"
+
+namespace {
+const uint32_t TEST_CMD_ID = DSP_CMD_SETLAYERZORDER;
+const uint32_t TEST_DEV_ID = 0;
+const uint32_t TEST_LAYER_ID = 3;
+const int32_t TEST_ASHMEM_SIZE = 4096;
+
+void DisplayCmdBufferTest::WriteBatch(MessageParcel &parcel, uint32_t count, const std::vector<uint8_t> &cmds,
+    uint32_t used, uint32_t fdCount)
+{
+    OHOS::sptr<OHOS::Ashmem> ashmem = OHOS::Ashmem::CreateAshmem("display_cmd_buffer_test", TEST_ASHMEM_SIZE);
+    ASSERT_NE(ashmem, nullptr);
+    ASSERT_TRUE(ashmem->MapReadAndWriteAshmem());
+    if (!cmds.empty()) {
+        ASSERT_TRUE(ashmem->WriteToAshmem(cmds.data(), static_cast<int32_t>(cmds.size()), 0));
+    }
+    ASSERT_TRUE(parcel.WriteUint32(count));
+    ASSERT_TRUE(parcel.WriteAshmem(ashmem));
+    ASSERT_TRUE(parcel.WriteUint32(used));
+    ASSERT_TRUE(parcel.WriteUint32(fdCount));
+    ashmem->UnmapAshmem();
+    ashmem->CloseAshmem();
+}
+
+void DisplayCmdBufferTest::AppendCmd(std::vector<uint8_t> &cmds, const DisplayCmdHeader &header, const void *payload,
+    uint32_t size)
+{
+    const uint8_t *headerBytes = reinterpret_cast<const uint8_t *>(&header);
+    const uint8_t *payloadBytes = static_cast<const uint8_t *>(payload);
+    cmds.insert(cmds.end(), headerBytes, headerBytes + sizeof(header));
+    cmds.insert(cmds.end(), payloadBytes, payloadBytes + size);
+}
+
+TEST_F(DisplayCmdBufferTest, RoundTrip)
+{
+    DisplayCmdWriter writer;
+    uint32_t zorder = 7;
+    IRect rects[] = { { 0, 0, 16, 16 }, { 16, 16, 32, 32 } };
+    writer.Write(TEST_CMD_ID, TEST_DEV_ID, TEST_LAYER_ID, zorder);
+    writer.WriteRects(DSP_CMD_SETLAYERDIRTYREGION, TEST_DEV_ID, TEST_LAYER_ID, rects, 2); // 2: the rects above
+    MessageParcel parcel;
+    ASSERT_TRUE(writer.Flush(parcel));
+    EXPECT_TRUE(writer.IsEmpty());
+
+    DisplayCmdReader reader;
+    ASSERT_TRUE(reader.Read(parcel));
+    ASSERT_EQ(reader.GetCount(), 2u);
+    DisplayCmdHeader header;
+    const uint8_t *payload = nullptr;
+    ASSERT_TRUE(reader.Next(header, payload));
+    EXPECT_EQ(header.cmdId, TEST_CMD_ID);
+    EXPECT_EQ(header.layerId, TEST_LAYER_ID);
+    ASSERT_EQ(header.size, sizeof(zorder));
+    EXPECT_EQ(memcmp(payload, &zorder, sizeof(zorder)), 0);
+    ASSERT_TRUE(reader.Next(header, payload));
+    EXPECT_EQ(header.cmdId, static_cast<uint32_t>(DSP_CMD_SETLAYERDIRTYREGION));
+    ASSERT_EQ(header.size, sizeof(rects));
+    EXPECT_EQ(memcmp(payload, rects, sizeof(rects)), 0);
+    EXPECT_FALSE(reader.Next(header, payload));
+}
+
+TEST_F(DisplayCmdBufferTest, EveryBatchCarriesAshmem)
+{
+    // a reader that never saw the previous batch of the writer still reads the next one
+    DisplayCmdWriter writer;
+    uint32_t zorder = 1;
+    for (uint32_t i = 0; i < 2; i++) { // 2: a first and a second batch
+        writer.Write(TEST_CMD_ID, TEST_DEV_ID, TEST_LAYER_ID, zorder);
+        MessageParcel parcel;
+        ASSERT_TRUE(writer.Flush(parcel));
+        DisplayCmdReader reader;
+        ASSERT_TRUE(reader.Read(parcel));
+        DisplayCmdHeader header;
+        const uint8_t *payload = nullptr;
+        EXPECT_TRUE(reader.Next(header, payload));
+    }
+}
+
+TEST_F(DisplayCmdBufferTest, EmptyBatch)
+{
+    MessageParcel parcel;
+    ASSERT_TRUE(parcel.WriteUint32(0));
+    DisplayCmdReader reader;
+    ASSERT_TRUE(reader.Read(parcel));
+    EXPECT_EQ(reader.GetCount(), 0u);
+    DisplayCmdHeader header;
+    const uint8_t *payload = nullptr;
+    EXPECT_FALSE(reader.Next(header, payload));
+}
+
+TEST_F(DisplayCmdBufferTest, NoAshmem)
+{
+    MessageParcel parcel;
+    ASSERT_TRUE(parcel.WriteUint32(1));
+    DisplayCmdReader reader;
+    EXPECT_FALSE(reader.Read(parcel));
+}
+
+TEST_F(DisplayCmdBufferTest, UsedOverflowsAshmem)
+{
+    std::vector<uint8_t> cmds;
+    MessageParcel parcel;
+    WriteBatch(parcel, 1, cmds, TEST_ASHMEM_SIZE + 1, 0);
+    DisplayCmdReader reader;
+    EXPECT_FALSE(reader.Read(parcel));
+}
+
+TEST_F(DisplayCmdBufferTest, TooManyFds)
+{
+    std::vector<uint8_t> cmds;
+    MessageParcel parcel;
+    WriteBatch(parcel, 1, cmds, 0, UINT32_MAX);
+    DisplayCmdReader reader;
+    EXPECT_FALSE(reader.Read(parcel));
+}
+
+TEST_F(DisplayCmdBufferTest, MissingFds)
+{
+    std::vector<uint8_t> cmds;
+    MessageParcel parcel;
+    WriteBatch(parcel, 1, cmds, 0, 2); // 2: fds the parcel does not carry
+    DisplayCmdReader reader;
+    EXPECT_FALSE(reader.Read(parcel));
+}
+
+TEST_F(DisplayCmdBufferTest, TruncatedHeader)
+{
+    uint32_t zorder = 1;
+    std::vector<uint8_t> cmds;
+    AppendCmd(cmds, { TEST_CMD_ID, TEST_DEV_ID, TEST_LAYER_ID, sizeof(zorder) }, &zorder, sizeof(zorder));
+    MessageParcel parcel;
+    // the second command claims a header but only half of it is in the batch
+    WriteBatch(parcel, 2, cmds, static_cast<uint32_t>(cmds.size() + sizeof(DisplayCmdHeader) / 2), 0);
+    DisplayCmdReader reader;
+    ASSERT_TRUE(reader.Read(parcel));
+    DisplayCmdHeader header;
+    const uint8_t *payload = nullptr;
+    EXPECT_TRUE(reader.Next(header, payload));
+    EXPECT_FALSE(reader.Next(header, payload));
+}
+
+TEST_F(DisplayCmdBufferTest, PayloadOverflowsBatch)
+{
+    uint32_t zorder = 1;
+    std::vector<uint8_t> cmds;
+    AppendCmd(cmds, { TEST_CMD_ID, TEST_DEV_ID, TEST_LAYER_ID, UINT32_MAX }, &zorder, sizeof(zorder));
+    AppendCmd(cmds, { TEST_CMD_ID, TEST_DEV_ID, TEST_LAYER_ID, sizeof(zorder) }, &zorder, sizeof(zorder));
+    MessageParcel parcel;
+    WriteBatch(parcel, 2, cmds, static_cast<uint32_t>(cmds.size()), 0); // 2: the commands above
+    DisplayCmdReader reader;
+    ASSERT_TRUE(reader.Read(parcel));
+    DisplayCmdHeader header;
+    const uint8_t *payload = nullptr;
+    // the size of the first command can not be trusted, so nothing after it is read either
+    EXPECT_FALSE(reader.Next(header, payload));
+    EXPECT_FALSE(reader.Next(header, payload));
+}
+
+TEST_F(DisplayCmdBufferTest, FewerCmdsThanCount)
+{
+    uint32_t zorder = 1;
+    std::vector<uint8_t> cmds;
+    AppendCmd(cmds, { TEST_CMD_ID, TEST_DEV_ID, TEST_LAYER_ID, sizeof(zorder) }, &zorder, sizeof(zorder));
+    MessageParcel parcel;
+    WriteBatch(parcel, 3, cmds, static_cast<uint32_t>(cmds.size()), 0); // 3: more than the batch holds
+    DisplayCmdReader reader;
+    ASSERT_TRUE(reader.Read(parcel));
+    uint32_t count = 0;
+    DisplayCmdHeader header;
+    const uint8_t *payload = nullptr;
+    while ((count < reader.GetCount()) && reader.Next(header, payload)) {
+        count++;
+    }
+    EXPECT_EQ(count, 1u);
+}
+
+TEST_F(DisplayCmdBufferTest, MalformedBufHdl)
+{
+    DisplayCmdReader reader;
+    std::vector<uint8_t> storage;
+    BufferHandle *handle = nullptr;
+    int32_t fence = -1;
+    DisplayCmdBufHdl hdl = {};
+    hdl.fd = 0;
+    hdl.fence = -1;
+    // shorter than the fixed part
+    DisplayCmdHeader header = { DSP_CMD_SETLAYERBUFFER, TEST_DEV_ID, TEST_LAYER_ID, sizeof(hdl) - 1 };
+    EXPECT_FALSE(reader.ReadBufHdl(header, reinterpret_cast<const uint8_t *>(&hdl), storage, handle, fence));
+    // reserve counts that do not match the size of the payload
+    hdl.reserveFds = UINT32_MAX;
+    hdl.reserveInts = 1;
+    header.size = sizeof(hdl);
+    EXPECT_FALSE(reader.ReadBufHdl(header, reinterpret_cast<const uint8_t *>(&hdl), storage, handle, fence));
+    // a well formed handle whose fd index is not in the batch
+    hdl.reserveFds = 0;
+    hdl.reserveInts = 0;
+    EXPECT_FALSE(reader.ReadBufHdl(header, reinterpret_cast<const uint8_t *>(&hdl), storage, handle, fence));
+}
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISPLAY_DEVICE_CMD_BUFFER_TEST_H
+#define DISPLAY_DEVICE_CMD_BUFFER_TEST_H
+#include <vector>
+#include "gtest/gtest.h"
+#include "display_device_cmd_buffer.h"
+
+namespace {
+using OHOS::MessageParcel;
+using OHOS::Display::Device::DisplayCmdReader;
+using OHOS::Display::Device::DisplayCmdWriter;
+
+class DisplayCmdBufferTest : public ::testing::Test {
+protected:
+    // a batch as the writer puts it into the parcel, with the fields chosen by the test
+    static void WriteBatch(MessageParcel &parcel, uint32_t count, const std::vector<uint8_t> &cmds, uint32_t used,
+        uint32_t fdCount);
+    static void AppendCmd(std::vector<uint8_t> &cmds, const DisplayCmdHeader &header, const void *payload,
+        uint32_t size);
+};
+}
+#endif // DISPLAY_DEVICE_CMD_BUFFER_TEST_H
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Submits frames of N layers through the display device proxy and prints the binder transactions per frame and
+ * the latency from the first layer setter to the return of Commit as one JSON object.
+ * Run it once as is and once with HDI_DISPLAY_BATCH=0 to compare the batched protocol with one call per setter.
+ * usage: display_device_ipc_bench [layers] [frames]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+#include "display_device_proxy.h"
+#include "idisplay_gralloc.h"
+
+namespace {
+using OHOS::sptr;
+using OHOS::Display::Device::IDisplayDevice;
+using OHOS::Display::Device::Client::DisplayDeviceProxy;
+using OHOS::HDI::Display::V1_0::IDisplayGralloc;
+
+const uint32_t DEFAULT_LAYERS = 4;
+const uint32_t DEFAULT_FRAMES = 300;
+const uint32_t MAX_LAYERS = 16;
+const uint32_t BUFFERS_PER_LAYER = 2;
+const uint32_t WARMUP_FRAMES = 10;
+const uint32_t DEV_ID = 0;
+const int32_t PERCENT = 100;
+
+struct BenchLayer {
+    uint32_t id;
+    IRect rect;
+    std::vector<BufferHandle *> buffers;
+};
+
+double Percentile(std::vector<double> &samples, int32_t percent)
+{
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = std::min(samples.size() - 1, samples.size() * percent / PERCENT);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+bool CreateLayers(IDisplayDevice &device, const IDisplayGralloc &gralloc, const DisplayInfo &info,
+    std::vector<BenchLayer> &layers, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        BenchLayer layer;
+        // a cascade of windows, each a quarter of the screen
+        layer.rect = { static_cast<int32_t>(i * info.width / (count * 2)),
+            static_cast<int32_t>(i * info.height / (count * 2)), static_cast<int32_t>(info.width / 2),
+            static_cast<int32_t>(info.height / 2) };
+        LayerInfo layerInfo = { layer.rect.w, layer.rect.h, LAYER_TYPE_GRAPHIC, 32, PIXEL_FMT_RGBA_8888 };
+        if (device.CreateLayer(DEV_ID, layerInfo, layer.id) != DISPLAY_SUCCESS) {
+            fprintf(stderr, "create layer %u failed\n", i);
+            return false;
+        }
+        for (uint32_t j = 0; j < BUFFERS_PER_LAYER; j++) {
+            AllocInfo allocInfo = {};
+            allocInfo.width = static_cast<uint32_t>(layer.rect.w);
+            allocInfo.height = static_cast<uint32_t>(layer.rect.h);
+            allocInfo.usage = HBM_USE_MEM_DMA | HBM_USE_CPU_READ | HBM_USE_CPU_WRITE;
+            allocInfo.format = PIXEL_FMT_RGBA_8888;
+            BufferHandle *buffer = nullptr;
+            if (gralloc.AllocMem(allocInfo, buffer) != DISPLAY_SUCCESS) {
+                fprintf(stderr, "alloc buffer of layer %u failed\n", i);
+                return false;
+            }
+            layer.buffers.push_back(buffer);
+        }
+        layers.push_back(layer);
+    }
+    return true;
+}
+
+void DestroyLayers(IDisplayDevice &device, const IDisplayGralloc &gralloc, std::vector<BenchLayer> &layers)
+{
+    for (auto &layer : layers) {
+        (void)device.CloseLayer(DEV_ID, layer.id);
+        for (auto buffer : layer.buffers) {
+            gralloc.FreeMem(*buffer);
+        }
+    }
+    layers.clear();
+}
+
+// the per frame state a compositor pushes for every layer
+int32_t SubmitFrame(IDisplayDevice &device, std::vector<BenchLayer> &layers, uint32_t frame)
+{
+    uint32_t zorder = 0;
+    for (auto &layer : layers) {
+        LayerAlpha alpha = { true, false, 0, 0, 0xff };
+        IRect crop = { 0, 0, layer.rect.w, layer.rect.h };
+        BufferHandle *buffer = layer.buffers[frame % layer.buffers.size()];
+        int32_t ret = device.SetLayerBuffer(DEV_ID, layer.id, *buffer, -1);
+        ret |= device.SetLayerSize(DEV_ID, layer.id, &layer.rect);
+        ret |= device.SetLayerCrop(DEV_ID, layer.id, &crop);
+        ret |= device.SetLayerZorder(DEV_ID, layer.id, zorder++);
+        ret |= device.SetLayerAlpha(DEV_ID, layer.id, alpha);
+        ret |= device.SetLayerDirtyRegion(DEV_ID, layer.id, 1, crop);
+        ret |= device.SetLayerCompositionType(DEV_ID, layer.id, COMPOSITION_DEVICE);
+        if (ret != DISPLAY_SUCCESS) {
+            return DISPLAY_FAILURE;
+        }
+    }
+    bool needFlushFb = false;
+    int32_t ret = device.PrepareDisplayLayers(DEV_ID, needFlushFb);
+    if (ret != DISPLAY_SUCCESS) {
+        return ret;
+    }
+    int32_t fence = -1;
+    ret = device.Commit(DEV_ID, fence);
+    if (fence >= 0) {
+        close(fence);
+    }
+    return ret;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t layerCount = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 0)) : DEFAULT_LAYERS;
+    uint32_t frameCount = (argc > 2) ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 0)) : DEFAULT_FRAMES;
+    if ((layerCount == 0) || (layerCount > MAX_LAYERS) || (frameCount == 0)) {
+        fprintf(stderr, "usage: %s [layers 1-%u] [frames]\n", argv[0], MAX_LAYERS);
+        return EXIT_FAILURE;
+    }
+    sptr<IDisplayDevice> device = DisplayDeviceProxy::GetInstance();
+    IDisplayGralloc *gralloc = IDisplayGralloc::Get();
+    if ((device == nullptr) || (gralloc == nullptr)) {
+        fprintf(stderr, "get the display device or gralloc failed\n");
+        return EXIT_FAILURE;
+    }
+    auto proxy = static_cast<DisplayDeviceProxy *>(device.GetRefPtr());
+    DisplayInfo info = {};
+    if ((device->InitDisplay(DEV_ID) != DISPLAY_SUCCESS) ||
+        (device->GetDisplayInfo(DEV_ID, info) != DISPLAY_SUCCESS)) {
+        fprintf(stderr, "init display %u failed\n", DEV_ID);
+        return EXIT_FAILURE;
+    }
+    std::vector<BenchLayer> layers;
+    if (!CreateLayers(*device, *gralloc, info, layers, layerCount)) {
+        DestroyLayers(*device, *gralloc, layers);
+        return EXIT_FAILURE;
+    }
+    std::vector<double> latencyUs;
+    uint32_t transactions = 0;
+    int32_t ret = DISPLAY_SUCCESS;
+    for (uint32_t frame = 0; (frame < WARMUP_FRAMES + frameCount) && (ret == DISPLAY_SUCCESS); frame++) {
+        uint32_t startCount = proxy->GetTransactionCount();
+        auto start = std::chrono::steady_clock::now();
+        ret = SubmitFrame(*device, layers, frame);
+        auto end = std::chrono::steady_clock::now();
+        if (frame >= WARMUP_FRAMES) {
+            transactions += proxy->GetTransactionCount() - startCount;
+            latencyUs.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+    }
+    DestroyLayers(*device, *gralloc, layers);
+    if (ret != DISPLAY_SUCCESS) {
+        fprintf(stderr, "submit frame failed %d\n", ret);
+        return EXIT_FAILURE;
+    }
+    const char *batch = getenv("HDI_DISPLAY_BATCH");
+    double maxUs = *std::max_element(latencyUs.begin(), latencyUs.end());
+    printf("{\"layers\":%u,\"frames\":%u,\"batch\":%s,\"transactions_per_frame\":%.2f,"
+           "\"p50_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}\n",
+        layerCount, frameCount, ((batch != nullptr) && (strcmp(batch, "0") == 0)) ? "false" : "true",
+        static_cast<double>(transactions) / frameCount, Percentile(latencyUs, 50), Percentile(latencyUs, 90),
+        Percentile(latencyUs, 99), maxUs); // 50 90 99: the percentiles
+    return EXIT_SUCCESS;
+}
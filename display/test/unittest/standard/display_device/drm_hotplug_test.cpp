@@ -0,0 +1,628 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drm_hotplug_test.h"
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <map>
+#include <string>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <drm_fourcc.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include "display_gralloc.h"
+#include "display_type.h"
+
+// a fake of the libdrm calls of the display device, the objects only live in memory
+struct _drmModeAtomicReq {
+    std::vector<std::pair<std::pair<uint32_t, uint32_t>, uint64_t>> items;
+};
+
+namespace {
+const uint32_t CRTC_ID = 31;
+const uint32_t ENCODER_ID = 41;
+const uint32_t HDMI_CONNECTOR_ID = 51;
+const uint32_t DSI_CONNECTOR_ID = 52;
+const uint32_t PLANE_ID = 61;
+const uint32_t MODE_WIDTH = 1920;
+const uint32_t MODE_HEIGHT = 1080;
+const uint32_t MODE_REFRESH = 60;
+
+struct FakeConnector {
+    uint32_t type;
+    bool present;
+    bool connected;
+};
+
+struct FakeProperty {
+    std::string name;
+    uint64_t value;
+};
+
+class FakeDrm {
+public:
+    static FakeDrm &Get()
+    {
+        static FakeDrm instance;
+        return instance;
+    }
+
+    // one crtc with one primary plane, the hdmi connector is plugged and the dsi one is not
+    void Reset()
+    {
+        mProps.clear();
+        mObjectProps.clear();
+        mConnectors.clear();
+        mNextId = 100; // 100: above the ids of the objects
+        AddProps(CRTC_ID, { { "MODE_ID", 0 }, { "OUT_FENCE_PTR", 0 }, { "ACTIVE", 0 } });
+        AddProps(PLANE_ID, { { "FB_ID", 0 }, { "IN_FENCE_FD", 0 }, { "CRTC_ID", 0 },
+            { "type", DRM_PLANE_TYPE_PRIMARY } });
+        mConnectors[HDMI_CONNECTOR_ID] = { DRM_MODE_CONNECTOR_HDMIA, true, true };
+        mConnectors[DSI_CONNECTOR_ID] = { DRM_MODE_CONNECTOR_DSI, true, false };
+        for (const auto &connector : mConnectors) {
+            AddProps(connector.first, { { "DPMS", DRM_MODE_DPMS_ON }, { "CRTC_ID", 0 } });
+        }
+    }
+
+    void SetConnected(uint32_t connectorId, bool connected)
+    {
+        mConnectors[connectorId].connected = connected;
+    }
+
+    // a dynamic connector, e.g. DP MST, leaves the resources
+    void SetPresent(uint32_t connectorId, bool present)
+    {
+        mConnectors[connectorId].present = present;
+    }
+
+    // the value the last commit left in the property of the object
+    uint64_t GetValue(uint32_t objId, const std::string &name)
+    {
+        for (uint32_t propId : mObjectProps[objId]) {
+            if (mProps[propId].name == name) {
+                return mProps[propId].value;
+            }
+        }
+        return UINT64_MAX;
+    }
+
+    uint32_t NewId()
+    {
+        return mNextId++;
+    }
+
+    std::map<uint32_t, FakeConnector> mConnectors;
+    std::map<uint32_t, FakeProperty> mProps;
+    std::map<uint32_t, std::vector<uint32_t>> mObjectProps;
+
+private:
+    void AddProps(uint32_t objId, const std::vector<FakeProperty> &props)
+    {
+        for (const auto &prop : props) {
+            uint32_t propId = NewId();
+            mProps[propId] = prop;
+            mObjectProps[objId].push_back(propId);
+        }
+    }
+
+    uint32_t mNextId = 0;
+};
+
+template<typename T>
+T *NewArray(const std::vector<T> &values)
+{
+    T *array = static_cast<T *>(calloc(values.size() + 1, sizeof(T)));
+    if ((array != nullptr) && !values.empty()) {
+        (void)memcpy(array, values.data(), values.size() * sizeof(T));
+    }
+    return array;
+}
+}
+
+int drmOpen(const char *, const char *)
+{
+    return eventfd(0, EFD_CLOEXEC);
+}
+
+int drmSetClientCap(int, uint64_t, uint64_t)
+{
+    return 0;
+}
+
+int drmSetMaster(int)
+{
+    return 0;
+}
+
+int drmDropMaster(int)
+{
+    return 0;
+}
+
+int drmIsMaster(int)
+{
+    return 1;
+}
+
+int drmIoctl(int, unsigned long, void *)
+{
+    return 0;
+}
+
+int drmHandleEvent(int, drmEventContextPtr)
+{
+    return 0;
+}
+
+int drmWaitVBlank(int, drmVBlankPtr)
+{
+    return -1;
+}
+
+int drmPrimeFDToHandle(int, int, uint32_t *handle)
+{
+    *handle = FakeDrm::Get().NewId();
+    return 0;
+}
+
+drmModeResPtr drmModeGetResources(int)
+{
+    auto res = static_cast<drmModeResPtr>(calloc(1, sizeof(drmModeRes)));
+    if (res == nullptr) {
+        return nullptr;
+    }
+    std::vector<uint32_t> connectors;
+    for (const auto &connector : FakeDrm::Get().mConnectors) {
+        if (connector.second.present) {
+            connectors.push_back(connector.first);
+        }
+    }
+    res->count_crtcs = 1;
+    res->crtcs = NewArray<uint32_t>({ CRTC_ID });
+    res->count_encoders = 1;
+    res->encoders = NewArray<uint32_t>({ ENCODER_ID });
+    res->count_connectors = static_cast<int>(connectors.size());
+    res->connectors = NewArray(connectors);
+    return res;
+}
+
+void drmModeFreeResources(drmModeResPtr ptr)
+{
+    if (ptr != nullptr) {
+        free(ptr->crtcs);
+        free(ptr->encoders);
+        free(ptr->connectors);
+        free(ptr);
+    }
+}
+
+drmModeCrtcPtr drmModeGetCrtc(int, uint32_t crtcId)
+{
+    auto crtc = static_cast<drmModeCrtcPtr>(calloc(1, sizeof(drmModeCrtc)));
+    if (crtc != nullptr) {
+        crtc->crtc_id = crtcId;
+    }
+    return crtc;
+}
+
+void drmModeFreeCrtc(drmModeCrtcPtr ptr)
+{
+    free(ptr);
+}
+
+drmModeEncoderPtr drmModeGetEncoder(int, uint32_t encoderId)
+{
+    auto encoder = static_cast<drmModeEncoderPtr>(calloc(1, sizeof(drmModeEncoder)));
+    if (encoder != nullptr) {
+        encoder->encoder_id = encoderId;
+        encoder->possible_crtcs = 1;
+    }
+    return encoder;
+}
+
+void drmModeFreeEncoder(drmModeEncoderPtr ptr)
+{
+    free(ptr);
+}
+
+drmModeConnectorPtr drmModeGetConnector(int, uint32_t connectorId)
+{
+    auto iter = FakeDrm::Get().mConnectors.find(connectorId);
+    if ((iter == FakeDrm::Get().mConnectors.end()) || !iter->second.present) {
+        return nullptr;
+    }
+    auto connector = static_cast<drmModeConnectorPtr>(calloc(1, sizeof(drmModeConnector)));
+    if (connector == nullptr) {
+        return nullptr;
+    }
+    connector->connector_id = connectorId;
+    connector->connector_type = iter->second.type;
+    connector->connection = iter->second.connected ? DRM_MODE_CONNECTED : DRM_MODE_DISCONNECTED;
+    connector->count_encoders = 1;
+    connector->encoders = NewArray<uint32_t>({ ENCODER_ID });
+    if (iter->second.connected) {
+        drmModeModeInfo mode = {};
+        mode.hdisplay = MODE_WIDTH;
+        mode.vdisplay = MODE_HEIGHT;
+        mode.vrefresh = MODE_REFRESH;
+        mode.type = DRM_MODE_TYPE_PREFERRED;
+        connector->count_modes = 1;
+        connector->modes = NewArray<drmModeModeInfo>({ mode });
+    }
+    return connector;
+}
+
+void drmModeFreeConnector(drmModeConnectorPtr ptr)
+{
+    if (ptr != nullptr) {
+        free(ptr->encoders);
+        free(ptr->modes);
+        free(ptr);
+    }
+}
+
+int drmModeConnectorSetProperty(int, uint32_t, uint32_t, uint64_t)
+{
+    return 0;
+}
+
+drmModePlaneResPtr drmModeGetPlaneResources(int)
+{
+    auto res = static_cast<drmModePlaneResPtr>(calloc(1, sizeof(drmModePlaneRes)));
+    if (res != nullptr) {
+        res->count_planes = 1;
+        res->planes = NewArray<uint32_t>({ PLANE_ID });
+    }
+    return res;
+}
+
+void drmModeFreePlaneResources(drmModePlaneResPtr ptr)
+{
+    if (ptr != nullptr) {
+        free(ptr->planes);
+        free(ptr);
+    }
+}
+
+drmModePlanePtr drmModeGetPlane(int, uint32_t planeId)
+{
+    auto plane = static_cast<drmModePlanePtr>(calloc(1, sizeof(drmModePlane)));
+    if (plane != nullptr) {
+        plane->plane_id = planeId;
+        plane->possible_crtcs = 1;
+        plane->count_formats = 1;
+        plane->formats = NewArray<uint32_t>({ DRM_FORMAT_ARGB8888 });
+    }
+    return plane;
+}
+
+void drmModeFreePlane(drmModePlanePtr ptr)
+{
+    if (ptr != nullptr) {
+        free(ptr->formats);
+        free(ptr);
+    }
+}
+
+drmModeObjectPropertiesPtr drmModeObjectGetProperties(int, uint32_t objectId, uint32_t)
+{
+    auto props = static_cast<drmModeObjectPropertiesPtr>(calloc(1, sizeof(drmModeObjectProperties)));
+    if (props == nullptr) {
+        return nullptr;
+    }
+    std::vector<uint32_t> ids = FakeDrm::Get().mObjectProps[objectId];
+    std::vector<uint64_t> values;
+    for (uint32_t id : ids) {
+        values.push_back(FakeDrm::Get().mProps[id].value);
+    }
+    props->count_props = ids.size();
+    props->props = NewArray(ids);
+    props->prop_values = NewArray(values);
+    return props;
+}
+
+void drmModeFreeObjectProperties(drmModeObjectPropertiesPtr ptr)
+{
+    if (ptr != nullptr) {
+        free(ptr->props);
+        free(ptr->prop_values);
+        free(ptr);
+    }
+}
+
+drmModePropertyPtr drmModeGetProperty(int, uint32_t propertyId)
+{
+    auto iter = FakeDrm::Get().mProps.find(propertyId);
+    if (iter == FakeDrm::Get().mProps.end()) {
+        return nullptr;
+    }
+    auto prop = static_cast<drmModePropertyPtr>(calloc(1, sizeof(drmModePropertyRes)));
+    if (prop != nullptr) {
+        prop->prop_id = propertyId;
+        (void)strncpy(prop->name, iter->second.name.c_str(), sizeof(prop->name) - 1);
+    }
+    return prop;
+}
+
+void drmModeFreeProperty(drmModePropertyPtr ptr)
+{
+    free(ptr);
+}
+
+drmModePropertyBlobPtr drmModeGetPropertyBlob(int, uint32_t)
+{
+    return nullptr;
+}
+
+void drmModeFreePropertyBlob(drmModePropertyBlobPtr ptr)
+{
+    free(ptr);
+}
+
+int drmModeCreatePropertyBlob(int, const void *, size_t, uint32_t *id)
+{
+    *id = FakeDrm::Get().NewId();
+    return 0;
+}
+
+int drmModeDestroyPropertyBlob(int, uint32_t)
+{
+    return 0;
+}
+
+int drmModeAddFB2(int, uint32_t, uint32_t, uint32_t, const uint32_t[4], const uint32_t[4], const uint32_t[4],
+    uint32_t *bufId, uint32_t)
+{
+    *bufId = FakeDrm::Get().NewId();
+    return 0;
+}
+
+int drmModeRmFB(int, uint32_t)
+{
+    return 0;
+}
+
+drmModeAtomicReqPtr drmModeAtomicAlloc(void)
+{
+    return new (std::nothrow) _drmModeAtomicReq;
+}
+
+void drmModeAtomicFree(drmModeAtomicReqPtr req)
+{
+    delete req;
+}
+
+int drmModeAtomicGetCursor(drmModeAtomicReqPtr req)
+{
+    return static_cast<int>(req->items.size());
+}
+
+void drmModeAtomicSetCursor(drmModeAtomicReqPtr req, int cursor)
+{
+    req->items.resize(cursor);
+}
+
+int drmModeAtomicAddProperty(drmModeAtomicReqPtr req, uint32_t objectId, uint32_t propertyId, uint64_t value)
+{
+    req->items.push_back({ { objectId, propertyId }, value });
+    return static_cast<int>(req->items.size());
+}
+
+// only the state matters, a flip event is never sent
+int drmModeAtomicCommit(int, drmModeAtomicReqPtr req, uint32_t flags, void *)
+{
+    if ((flags & DRM_MODE_ATOMIC_TEST_ONLY) != 0) {
+        return 0;
+    }
+    for (const auto &item : req->items) {
+        auto iter = FakeDrm::Get().mProps.find(item.first.second);
+        if (iter == FakeDrm::Get().mProps.end()) {
+            continue;
+        }
+        iter->second.value = item.second;
+        // the kernel hands out a fence that signals once the frame is off the screen
+        if ((iter->second.name == "OUT_FENCE_PTR") && (item.second != 0)) {
+            *reinterpret_cast<int32_t *>(static_cast<uintptr_t>(item.second)) = eventfd(0, EFD_CLOEXEC);
+        }
+    }
+    return 0;
+}
+
+namespace {
+int32_t FakeAllocMem(const AllocInfo *info, BufferHandle **handle)
+{
+    auto buffer = static_cast<BufferHandle *>(calloc(1, sizeof(BufferHandle)));
+    if (buffer == nullptr) {
+        return DISPLAY_NOMEM;
+    }
+    buffer->fd = eventfd(0, EFD_CLOEXEC);
+    buffer->width = static_cast<int32_t>(info->width);
+    buffer->height = static_cast<int32_t>(info->height);
+    buffer->stride = static_cast<int32_t>(info->width * 4); // 4: bytes of BGRA_8888
+    buffer->format = info->format;
+    *handle = buffer;
+    return DISPLAY_SUCCESS;
+}
+
+void FakeFreeMem(BufferHandle *handle)
+{
+    if (handle != nullptr) {
+        close(handle->fd);
+        free(handle);
+    }
+}
+}
+
+int32_t GrallocInitialize(GrallocFuncs **funcs)
+{
+    static GrallocFuncs fakeFuncs = {};
+    fakeFuncs.AllocMem = FakeAllocMem;
+    fakeFuncs.FreeMem = FakeFreeMem;
+    *funcs = &fakeFuncs;
+    return DISPLAY_SUCCESS;
+}
+
+int32_t GrallocUninitialize(GrallocFuncs *)
+{
+    return DISPLAY_SUCCESS;
+}
+
+namespace {
+void DrmHotplugTest::SetUp()
+{
+    FakeDrm::Get().Reset();
+    mDevice = std::static_pointer_cast<DrmDevice>(DrmDevice::Create());
+    ASSERT_NE(mDevice, nullptr);
+    ASSERT_EQ(mDevice->Init(), DISPLAY_SUCCESS);
+    mDisplays = mDevice->DiscoveryDisplay();
+}
+
+void DrmHotplugTest::TearDown()
+{
+    for (auto &displayPair : mDisplays) {
+        displayPair.second->DeInit();
+    }
+    mDisplays.clear();
+    mAdded.clear();
+    mDevice->DeInit();
+}
+
+int32_t DrmHotplugTest::Update()
+{
+    mRemoved.clear();
+    mAdded.clear();
+    int32_t ret = mDevice->UpdateDisplays(mRemoved, mAdded);
+    for (uint32_t id : mRemoved) {
+        mDisplays.erase(id);
+    }
+    mDisplays.insert(mAdded.begin(), mAdded.end());
+    return ret;
+}
+
+InterfaceType GetType(HdiDisplay &display)
+{
+    DisplayCapability cap = {};
+    (void)display.GetDisplayCapability(&cap);
+    return cap.type;
+}
+
+TEST_F(DrmHotplugTest, NothingChanged)
+{
+    ASSERT_EQ(mDisplays.size(), 1u);
+    EXPECT_EQ(FakeDrm::Get().GetValue(CRTC_ID, "ACTIVE"), 1u);
+    EXPECT_EQ(FakeDrm::Get().GetValue(HDMI_CONNECTOR_ID, "CRTC_ID"), CRTC_ID);
+    ASSERT_EQ(Update(), DISPLAY_SUCCESS);
+    EXPECT_TRUE(mRemoved.empty());
+    EXPECT_TRUE(mAdded.empty());
+    EXPECT_EQ(mDisplays.size(), 1u);
+}
+
+TEST_F(DrmHotplugTest, UnplugAndReplug)
+{
+    ASSERT_EQ(mDisplays.size(), 1u);
+    uint32_t id = mDisplays.begin()->first;
+    FakeDrm::Get().SetConnected(HDMI_CONNECTOR_ID, false);
+    ASSERT_EQ(Update(), DISPLAY_SUCCESS);
+    ASSERT_EQ(mRemoved.size(), 1u);
+    EXPECT_EQ(mRemoved[0], id);
+    EXPECT_TRUE(mAdded.empty());
+    // the crtc and the plane are given back
+    EXPECT_EQ(FakeDrm::Get().GetValue(CRTC_ID, "ACTIVE"), 0u);
+    EXPECT_EQ(FakeDrm::Get().GetValue(HDMI_CONNECTOR_ID, "CRTC_ID"), 0u);
+    EXPECT_EQ(FakeDrm::Get().GetValue(PLANE_ID, "FB_ID"), 0u);
+
+    FakeDrm::Get().SetConnected(HDMI_CONNECTOR_ID, true);
+    ASSERT_EQ(Update(), DISPLAY_SUCCESS);
+    EXPECT_TRUE(mRemoved.empty());
+    ASSERT_EQ(mAdded.size(), 1u);
+    EXPECT_EQ(GetType(*mAdded.begin()->second), DISP_INTF_HDMI);
+    EXPECT_EQ(FakeDrm::Get().GetValue(CRTC_ID, "ACTIVE"), 1u);
+    EXPECT_NE(FakeDrm::Get().GetValue(PLANE_ID, "FB_ID"), 0u);
+}
+
+TEST_F(DrmHotplugTest, SwapOutputs)
+{
+    ASSERT_EQ(mDisplays.size(), 1u);
+    // one event for both, the only crtc moves to the new output
+    FakeDrm::Get().SetConnected(HDMI_CONNECTOR_ID, false);
+    FakeDrm::Get().SetConnected(DSI_CONNECTOR_ID, true);
+    ASSERT_EQ(Update(), DISPLAY_SUCCESS);
+    EXPECT_EQ(mRemoved.size(), 1u);
+    ASSERT_EQ(mAdded.size(), 1u);
+    EXPECT_EQ(GetType(*mAdded.begin()->second), DISP_INTF_MIPI);
+    EXPECT_EQ(FakeDrm::Get().GetValue(HDMI_CONNECTOR_ID, "CRTC_ID"), 0u);
+    EXPECT_EQ(FakeDrm::Get().GetValue(DSI_CONNECTOR_ID, "CRTC_ID"), CRTC_ID);
+    EXPECT_EQ(FakeDrm::Get().GetValue(CRTC_ID, "ACTIVE"), 1u);
+}
+
+TEST_F(DrmHotplugTest, WaitForIdleCrtc)
+{
+    ASSERT_EQ(mDisplays.size(), 1u);
+    FakeDrm::Get().SetConnected(DSI_CONNECTOR_ID, true);
+    ASSERT_EQ(Update(), DISPLAY_SUCCESS);
+    EXPECT_TRUE(mRemoved.empty());
+    EXPECT_TRUE(mAdded.empty());
+    // the waiting output gets the crtc once it is free
+    FakeDrm::Get().SetConnected(HDMI_CONNECTOR_ID, false);
+    ASSERT_EQ(Update(), DISPLAY_SUCCESS);
+    EXPECT_EQ(mRemoved.size(), 1u);
+    ASSERT_EQ(mAdded.size(), 1u);
+    EXPECT_EQ(GetType(*mAdded.begin()->second), DISP_INTF_MIPI);
+}
+
+size_t CountFds()
+{
+    size_t count = 0;
+    DIR *dir = opendir("/proc/self/fd");
+    if (dir == nullptr) {
+        return 0;
+    }
+    while (readdir(dir) != nullptr) {
+        count++;
+    }
+    closedir(dir);
+    return count;
+}
+
+TEST_F(DrmHotplugTest, FencesNotLeaked)
+{
+    ASSERT_EQ(mDisplays.size(), 1u);
+    size_t fds = CountFds();
+    for (int i = 0; i < 3; i++) { // 3: a few cycles of frames with out fences
+        FakeDrm::Get().SetConnected(HDMI_CONNECTOR_ID, false);
+        ASSERT_EQ(Update(), DISPLAY_SUCCESS);
+        FakeDrm::Get().SetConnected(HDMI_CONNECTOR_ID, true);
+        ASSERT_EQ(Update(), DISPLAY_SUCCESS);
+        ASSERT_EQ(mAdded.size(), 1u);
+    }
+    // the fence of the last frame is held by the client layer of the new display
+    EXPECT_LE(CountFds(), fds + 1);
+}
+
+TEST_F(DrmHotplugTest, ConnectorGone)
+{
+    ASSERT_EQ(mDisplays.size(), 1u);
+    FakeDrm::Get().SetPresent(HDMI_CONNECTOR_ID, false);
+    ASSERT_EQ(Update(), DISPLAY_SUCCESS);
+    EXPECT_EQ(mRemoved.size(), 1u);
+    EXPECT_TRUE(mAdded.empty());
+    EXPECT_EQ(FakeDrm::Get().GetValue(CRTC_ID, "ACTIVE"), 0u);
+    FakeDrm::Get().SetPresent(HDMI_CONNECTOR_ID, true);
+    ASSERT_EQ(Update(), DISPLAY_SUCCESS);
+    EXPECT_EQ(mAdded.size(), 1u);
+}
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRM_HOTPLUG_TEST_H
+#define DRM_HOTPLUG_TEST_H
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "drm_device.h"
+
+namespace {
+using OHOS::HDI::DISPLAY::DrmDevice;
+using OHOS::HDI::DISPLAY::HdiDisplay;
+using OHOS::HDI::DISPLAY::IdMapPtr;
+
+// DrmDevice on top of a fake libdrm, the test plugs and unplugs its connectors
+class DrmHotplugTest : public ::testing::Test {
+protected:
+    void SetUp() override;
+    void TearDown() override;
+    // what the session does on a hotplug uevent
+    int32_t Update();
+    std::shared_ptr<DrmDevice> mDevice;
+    IdMapPtr<HdiDisplay> mDisplays;
+    std::vector<uint32_t> mRemoved;
+    IdMapPtr<HdiDisplay> mAdded;
+};
+}
+#endif // DRM_HOTPLUG_TEST_H
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drm_plane_allocator_test.h"
+#include <drm_fourcc.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+using namespace OHOS::HDI::DISPLAY;
+
+namespace {
+const uint32_t MODE_WIDTH = 1024;
+const uint32_t MODE_HEIGHT = 768;
+const int32_t WINDOW_SIZE = 256;
+const uint32_t OVERLAY_INDEX = 0;
+const uint32_t CURSOR_INDEX = 1;
+
+void PlaneAllocatorTest::SetUp()
+{
+    mPrimary.type = DRM_PLANE_TYPE_PRIMARY;
+    mPrimary.formats = { DRM_FORMAT_XRGB8888 };
+    mPrimary.rotations = DRM_MODE_ROTATE_0;
+    mPrimary.zposMin = mPrimary.zposMax = 0;
+
+    mOverlay.type = DRM_PLANE_TYPE_OVERLAY;
+    mOverlay.formats = { DRM_FORMAT_XRGB8888, DRM_FORMAT_ARGB8888 };
+    mOverlay.rotations = DRM_MODE_ROTATE_0;
+    mOverlay.zposMin = mOverlay.zposMax = 1;
+
+    mCursor.type = DRM_PLANE_TYPE_CURSOR;
+    mCursor.formats = { DRM_FORMAT_ARGB8888 };
+    mCursor.rotations = DRM_MODE_ROTATE_0;
+    mCursor.zposMin = mCursor.zposMax = 2; // 2 is the stack index of the cursor plane
+
+    mPlanes = { mOverlay, mCursor };
+}
+
+DrmLayerRequest PlaneAllocatorTest::FullScreenLayer(uint32_t format) const
+{
+    DrmLayerRequest layer;
+    layer.format = format;
+    layer.crop = { 0, 0, MODE_WIDTH, MODE_HEIGHT };
+    layer.displayRect = { 0, 0, MODE_WIDTH, MODE_HEIGHT };
+    layer.rotation = DRM_MODE_ROTATE_0;
+    return layer;
+}
+
+DrmLayerRequest PlaneAllocatorTest::WindowLayer(uint32_t format) const
+{
+    DrmLayerRequest layer;
+    layer.format = format;
+    layer.crop = { 0, 0, WINDOW_SIZE, WINDOW_SIZE };
+    layer.displayRect = { WINDOW_SIZE, WINDOW_SIZE, WINDOW_SIZE, WINDOW_SIZE };
+    layer.rotation = DRM_MODE_ROTATE_0;
+    return layer;
+}
+
+TEST_F(PlaneAllocatorTest, TopLayerOnOverlay)
+{
+    std::vector<DrmLayerRequest> layers = { FullScreenLayer(DRM_FORMAT_XRGB8888), WindowLayer(DRM_FORMAT_ARGB8888) };
+    auto result = DrmPlaneAllocator::Allocate(mPrimary, mPlanes, layers, MODE_WIDTH, MODE_HEIGHT);
+    ASSERT_EQ(result.size(), layers.size());
+    EXPECT_EQ(result[1].plane, static_cast<int32_t>(OVERLAY_INDEX));
+    EXPECT_EQ(result[1].zpos, mOverlay.zposMin);
+    // the only overlay is taken, the bottom layer stays with the client composition
+    EXPECT_EQ(result[0].plane, PLANE_NOT_ASSIGNED);
+}
+
+TEST_F(PlaneAllocatorTest, FormatMismatch)
+{
+    std::vector<DrmLayerRequest> layers = { WindowLayer(DRM_FORMAT_NV12) };
+    auto result = DrmPlaneAllocator::Allocate(mPrimary, mPlanes, layers, MODE_WIDTH, MODE_HEIGHT);
+    EXPECT_EQ(result[0].plane, PLANE_NOT_ASSIGNED);
+}
+
+TEST_F(PlaneAllocatorTest, Scaling)
+{
+    DrmLayerRequest layer = WindowLayer(DRM_FORMAT_XRGB8888);
+    layer.displayRect.w = WINDOW_SIZE * 2; // 2 times wider than the crop
+    EXPECT_TRUE(DrmPlaneAllocator::IsScaled(layer));
+    EXPECT_FALSE(DrmPlaneAllocator::CanScanout(mOverlay, layer, MODE_WIDTH, MODE_HEIGHT));
+    mOverlay.canScale = true;
+    EXPECT_TRUE(DrmPlaneAllocator::CanScanout(mOverlay, layer, MODE_WIDTH, MODE_HEIGHT));
+}
+
+TEST_F(PlaneAllocatorTest, Rotation)
+{
+    EXPECT_EQ(DrmPlaneAllocator::ConvertToDrmRotation(ROTATE_NONE), static_cast<uint32_t>(DRM_MODE_ROTATE_0));
+    EXPECT_EQ(DrmPlaneAllocator::ConvertToDrmRotation(ROTATE_90), static_cast<uint32_t>(DRM_MODE_ROTATE_270));
+    EXPECT_EQ(DrmPlaneAllocator::ConvertToDrmRotation(ROTATE_270), static_cast<uint32_t>(DRM_MODE_ROTATE_90));
+
+    DrmLayerRequest layer = WindowLayer(DRM_FORMAT_XRGB8888);
+    layer.crop.w = WINDOW_SIZE / 2; // 2: a portrait buffer shown in landscape
+    layer.displayRect.h = WINDOW_SIZE / 2;
+    layer.rotation = DRM_MODE_ROTATE_90;
+    EXPECT_FALSE(DrmPlaneAllocator::IsScaled(layer));
+    EXPECT_FALSE(DrmPlaneAllocator::CanScanout(mOverlay, layer, MODE_WIDTH, MODE_HEIGHT));
+    mOverlay.rotations |= DRM_MODE_ROTATE_90;
+    EXPECT_TRUE(DrmPlaneAllocator::CanScanout(mOverlay, layer, MODE_WIDTH, MODE_HEIGHT));
+}
+
+TEST_F(PlaneAllocatorTest, OffScreen)
+{
+    DrmLayerRequest layer = WindowLayer(DRM_FORMAT_XRGB8888);
+    layer.displayRect.x = MODE_WIDTH - WINDOW_SIZE / 2; // 2: half of the window is off screen
+    EXPECT_FALSE(DrmPlaneAllocator::CanScanout(mOverlay, layer, MODE_WIDTH, MODE_HEIGHT));
+}
+
+TEST_F(PlaneAllocatorTest, ZorderContiguity)
+{
+    // the middle layer fits the overlay, but the unsupported top layer has to be composed above it
+    std::vector<DrmLayerRequest> layers = { FullScreenLayer(DRM_FORMAT_XRGB8888), WindowLayer(DRM_FORMAT_XRGB8888),
+        WindowLayer(DRM_FORMAT_NV12) };
+    auto result = DrmPlaneAllocator::Allocate(mPrimary, mPlanes, layers, MODE_WIDTH, MODE_HEIGHT);
+    for (const auto &assignment : result) {
+        EXPECT_EQ(assignment.plane, PLANE_NOT_ASSIGNED);
+    }
+}
+
+TEST_F(PlaneAllocatorTest, CursorPlane)
+{
+    DrmLayerRequest window = WindowLayer(DRM_FORMAT_ARGB8888);
+    EXPECT_FALSE(DrmPlaneAllocator::CanScanout(mCursor, window, MODE_WIDTH, MODE_HEIGHT));
+
+    DrmLayerRequest cursor = WindowLayer(DRM_FORMAT_ARGB8888);
+    cursor.cursor = true;
+    std::vector<DrmLayerRequest> layers = { window, cursor };
+    auto result = DrmPlaneAllocator::Allocate(mPrimary, mPlanes, layers, MODE_WIDTH, MODE_HEIGHT);
+    EXPECT_EQ(result[1].plane, static_cast<int32_t>(CURSOR_INDEX));
+    EXPECT_EQ(result[0].plane, static_cast<int32_t>(OVERLAY_INDEX));
+    EXPECT_LT(result[0].zpos, result[1].zpos);
+}
+
+TEST_F(PlaneAllocatorTest, MutableZpos)
+{
+    const uint64_t zposMax = 3;
+    mOverlay.zposImmutable = false;
+    mOverlay.zposMin = 1;
+    mOverlay.zposMax = zposMax;
+    std::vector<DrmPlaneCaps> planes = { mOverlay, mOverlay };
+    std::vector<DrmLayerRequest> layers = { WindowLayer(DRM_FORMAT_XRGB8888), WindowLayer(DRM_FORMAT_ARGB8888) };
+    auto result = DrmPlaneAllocator::Allocate(mPrimary, planes, layers, MODE_WIDTH, MODE_HEIGHT);
+    ASSERT_NE(result[0].plane, PLANE_NOT_ASSIGNED);
+    ASSERT_NE(result[1].plane, PLANE_NOT_ASSIGNED);
+    EXPECT_NE(result[0].plane, result[1].plane);
+    EXPECT_EQ(result[1].zpos, zposMax);
+    EXPECT_GT(result[0].zpos, mPrimary.zposMin);
+    EXPECT_LT(result[0].zpos, result[1].zpos);
+}
+}
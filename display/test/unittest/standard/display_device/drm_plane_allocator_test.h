@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRM_PLANE_ALLOCATOR_TEST_H
+#define DRM_PLANE_ALLOCATOR_TEST_H
+#include <vector>
+#include "gtest/gtest.h"
+#include "drm_plane_allocator.h"
+
+namespace {
+using OHOS::HDI::DISPLAY::DrmLayerRequest;
+using OHOS::HDI::DISPLAY::DrmPlaneCaps;
+
+// the planes vkms exposes with enable_overlay and enable_cursor set
+class PlaneAllocatorTest : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    DrmLayerRequest FullScreenLayer(uint32_t format) const;
+    DrmLayerRequest WindowLayer(uint32_t format) const;
+    DrmPlaneCaps mPrimary;
+    DrmPlaneCaps mOverlay;
+    DrmPlaneCaps mCursor;
+    std::vector<DrmPlaneCaps> mPlanes;
+};
+}
+#endif // DRM_PLANE_ALLOCATOR_TEST_H
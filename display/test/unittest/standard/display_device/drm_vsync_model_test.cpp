@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drm_vsync_model_test.h"
+#include <cstdlib>
+
+namespace {
+const uint64_t PERIOD_60HZ = 16666667;
+const uint64_t PERIOD_30HZ = 33333333;
+const int64_t NOISE_NS = 100000;
+// the fit averages the noise out, it stays well within the noise of a single sample
+const int64_t TOLERANCE_NS = NOISE_NS / 2;
+const uint32_t SAMPLE_COUNT = 32;
+
+void VsyncModelTest::Feed(uint32_t sequence, uint32_t count, uint32_t step, int64_t noiseNs)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t seq = sequence + i * step;
+        int64_t noise = (seq % 2 == 0) ? noiseNs : -noiseNs; // 2: alternate early and late
+        mModel.AddSample(seq, mStartNs + seq * PERIOD_60HZ + noise);
+    }
+}
+
+TEST_F(VsyncModelTest, TooFewSamples)
+{
+    uint32_t sequence = 0;
+    EXPECT_FALSE(mModel.IsValid());
+    EXPECT_EQ(mModel.PredictNext(mStartNs, sequence), 0u);
+    Feed(0, 2, 1, 0); // 2: one sample short of a fit
+    EXPECT_FALSE(mModel.IsValid());
+    Feed(2, 1, 1, 0); // 2: the third sample
+    EXPECT_TRUE(mModel.IsValid());
+    EXPECT_EQ(mModel.GetPeriod(), PERIOD_60HZ);
+}
+
+TEST_F(VsyncModelTest, NoisyTimestamps)
+{
+    Feed(0, SAMPLE_COUNT, 1, NOISE_NS);
+    EXPECT_LE(std::llabs(static_cast<int64_t>(mModel.GetPeriod() - PERIOD_60HZ)), TOLERANCE_NS);
+    uint32_t sequence = 0;
+    uint64_t now = mStartNs + SAMPLE_COUNT * PERIOD_60HZ - PERIOD_60HZ / 2; // 2: half a period ahead
+    uint64_t next = mModel.PredictNext(now, sequence);
+    EXPECT_EQ(sequence, SAMPLE_COUNT);
+    EXPECT_LE(std::llabs(static_cast<int64_t>(next - (mStartNs + SAMPLE_COUNT * PERIOD_60HZ))), TOLERANCE_NS);
+}
+
+TEST_F(VsyncModelTest, StrictlyAfter)
+{
+    Feed(0, SAMPLE_COUNT, 1, 0);
+    uint32_t sequence = 0;
+    uint64_t vblank = mStartNs + SAMPLE_COUNT * PERIOD_60HZ;
+    EXPECT_EQ(mModel.PredictNext(vblank, sequence), vblank + PERIOD_60HZ);
+    EXPECT_EQ(sequence, SAMPLE_COUNT + 1);
+    // far behind the newest sample, the prediction walks back
+    EXPECT_EQ(mModel.PredictNext(mStartNs, sequence), mStartNs + PERIOD_60HZ);
+    EXPECT_EQ(sequence, 1u);
+}
+
+TEST_F(VsyncModelTest, MissedVblanks)
+{
+    // every third event lost does not stretch the period
+    Feed(0, SAMPLE_COUNT, 3, NOISE_NS); // 3: the step between delivered vblanks
+    EXPECT_LE(std::llabs(static_cast<int64_t>(mModel.GetPeriod() - PERIOD_60HZ)), TOLERANCE_NS);
+}
+
+TEST_F(VsyncModelTest, FlipAndVblankOfOneFrame)
+{
+    Feed(0, SAMPLE_COUNT, 1, 0);
+    // the flip event reports the vblank again, slightly later
+    mModel.AddSample(SAMPLE_COUNT - 1, mStartNs + SAMPLE_COUNT * PERIOD_60HZ);
+    EXPECT_EQ(mModel.GetPeriod(), PERIOD_60HZ);
+}
+
+TEST_F(VsyncModelTest, ModeChange)
+{
+    Feed(0, SAMPLE_COUNT, 1, 0);
+    // the counter keeps going at half the rate, the old samples must not be averaged in
+    uint64_t base = mStartNs + SAMPLE_COUNT * PERIOD_60HZ;
+    for (uint32_t i = 0; i < SAMPLE_COUNT; i++) {
+        mModel.AddSample(SAMPLE_COUNT + i, base + i * PERIOD_30HZ);
+    }
+    EXPECT_EQ(mModel.GetPeriod(), PERIOD_30HZ);
+
+    // a counter restarted by a modeset
+    mModel.AddSample(0, base + SAMPLE_COUNT * PERIOD_30HZ);
+    EXPECT_FALSE(mModel.IsValid());
+}
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRM_VSYNC_MODEL_TEST_H
+#define DRM_VSYNC_MODEL_TEST_H
+#include "gtest/gtest.h"
+#include "drm_vsync_model.h"
+
+namespace {
+using OHOS::HDI::DISPLAY::DrmVsyncModel;
+
+class VsyncModelTest : public ::testing::Test {
+protected:
+    // feeds count vblanks from sequence on, every step vblanks apart, with the timestamps alternately early and late
+    void Feed(uint32_t sequence, uint32_t count, uint32_t step, int64_t noiseNs);
+    DrmVsyncModel mModel;
+    uint64_t mStartNs = 1000000000;
+};
+}
+#endif // DRM_VSYNC_MODEL_TEST_H
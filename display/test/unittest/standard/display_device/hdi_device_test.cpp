@@ -16,7 +16,11 @@
 #include "hdi_device_test.h"
 #include <chrono>
 #include <cinttypes>
+#include <cstdlib>
+#include <ctime>
 #include <algorithm>
+#include <poll.h>
+#include <unistd.h>
 #include "display_device.h"
 #include "display_gralloc.h"
 #include "display_layer.h"
@@ -258,6 +262,18 @@ static void TestVBlankCallback(unsigned int sequence, uint64_t ns, void *data)
     VblankCtr::GetInstance().NotifyVblank(sequence, ns, data);
 }
 
+static void ReportPercentiles(const char *name, std::vector<uint64_t> &samples)
+{
+    DISPLAY_TEST_CHK_RETURN_NOT_VALUE((samples.empty()), DISPLAY_FAILURE, DISPLAY_TEST_LOGE("no %s samples", name));
+    std::sort(samples.begin(), samples.end());
+    const uint32_t percents[] = { 50, 90, 99 };
+    const uint32_t hundred = 100;
+    for (uint32_t percent : percents) {
+        DISPLAY_TEST_LOGD("%s p%u %" PRIu64 " us", name, percent, samples[(samples.size() - 1) * percent / hundred]);
+    }
+    DISPLAY_TEST_LOGD("%s max %" PRIu64 " us", name, samples.back());
+}
+
 static void AdjustLayerSettings(std::vector<LayerSettings> &settings, uint32_t w, uint32_t h)
 {
     DISPLAY_TEST_LOGD();
@@ -307,6 +323,50 @@ static std::vector<std::shared_ptr<HdiTestLayer>> CreateLayers(std::vector<Layer
     return layers;
 }
 
+static int32_t FillAndPresent(std::shared_ptr<HdiTestLayer> &layer, uint32_t color)
+{
+    HdiGrallocBuffer *handle = layer->GetFrontBuffer();
+    DISPLAY_TEST_CHK_RETURN((handle == nullptr), DISPLAY_FAILURE, DISPLAY_TEST_LOGE("can not get front buffer"));
+    ClearColor(*(handle->Get()), color);
+    int32_t ret = layer->SwapFrontToBackQ();
+    DISPLAY_TEST_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_TEST_LOGE("SwapFrontToBackQ failed"));
+    return PrepareAndPrensent();
+}
+
+// gets the latest captured frame, which shows a single colour, and reads its corner and centre pixels
+static int32_t GetCapturedPixels(uint32_t writeBackId, std::vector<uint32_t> &pixels)
+{
+    const int fenceTimeoutMs = 1000;
+    BufferHandle frame = {};
+    // the frame got before is read already, it needs no release fence
+    int32_t fence = -1;
+    int32_t ret = HdiTestDevice::GetInstance().GetDeviceFuncs().GetWriteBackFrame(writeBackId, &frame, &fence);
+    DISPLAY_TEST_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_TEST_LOGE("GetWriteBackFrame failed"));
+    if (fence >= 0) {
+        struct pollfd fds = { fence, POLLIN, 0 };
+        int polled = poll(&fds, 1, fenceTimeoutMs);
+        close(fence);
+        DISPLAY_TEST_CHK_RETURN((polled <= 0), DISPLAY_FAILURE, DISPLAY_TEST_LOGE("the capture is not done"));
+    }
+    GrallocFuncs &gralloc = HdiTestDevice::GetInstance().GetGrallocFuncs();
+    void *addr = gralloc.Mmap(&frame);
+    if (addr == nullptr) {
+        close(frame.fd);
+        DISPLAY_TEST_LOGE("can not map the frame");
+        return DISPLAY_FAILURE;
+    }
+    gralloc.InvalidateCache(&frame);
+    pixels = {
+        GetPixelValue(frame, 0, 0),
+        GetPixelValue(frame, frame.width - 1, frame.height - 1),
+        GetPixelValue(frame, frame.width / 2, frame.height / 2), // 2: the centre
+    };
+    DISPLAY_TEST_LOGD("frame %d x %d format %d pixel 0x%x", frame.width, frame.height, frame.format, pixels[0]);
+    gralloc.Unmap(&frame);
+    close(frame.fd);
+    return DISPLAY_SUCCESS;
+}
+
 static inline void PresentAndCheck(std::vector<LayerSettings> &layerSettings,
     uint32_t checkType = HdiCompositionCheck::CHECK_VERTEX)
 {
@@ -334,6 +394,14 @@ void DeviceLayerDisplay::TearDown()
     HdiTestDevice::GetInstance().Clear();
 }
 
+void WriteBackTest::TearDown()
+{
+    if (mHasWriteBack) {
+        HdiTestDevice::GetInstance().GetDeviceFuncs().DestroyWriteBack(mWriteBackId);
+    }
+    HdiTestDevice::GetInstance().Clear();
+}
+
 void VblankCtr::NotifyVblank(unsigned int sequence, uint64_t ns, void *data)
 {
     DISPLAY_TEST_LOGD();
@@ -362,6 +430,31 @@ int32_t VblankCtr::WaitVblank(uint32_t ms)
     return DISPLAY_SUCCESS;
 }
 
+void VblankRecorder::OnVblank(unsigned int sequence, uint64_t ns, void *data)
+{
+    const uint64_t nPerS = 1000000000;
+    struct timespec ts = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    VblankRecorder *recorder = static_cast<VblankRecorder *>(data);
+    std::unique_lock<std::mutex> lg(recorder->mMutex);
+    if (recorder->mSamples.size() < recorder->mCount) {
+        recorder->mSamples.push_back({ sequence, ns, static_cast<uint64_t>(ts.tv_sec) * nPerS + ts.tv_nsec });
+        recorder->mCondition.notify_one();
+    }
+}
+
+bool VblankRecorder::Wait(uint32_t ms)
+{
+    std::unique_lock<std::mutex> lck(mMutex);
+    return mCondition.wait_for(lck, std::chrono::milliseconds(ms), [this] { return mSamples.size() >= mCount; });
+}
+
+std::vector<VblankSample> VblankRecorder::GetSamples()
+{
+    std::unique_lock<std::mutex> lck(mMutex);
+    return mSamples;
+}
+
 void VblankTest::TearDown()
 {
     auto display = HdiTestDevice::GetInstance().GetFirstDisplay();
@@ -417,6 +510,37 @@ TEST_F(DeviceTest, zorder)
     HdiTestDevice::GetInstance().Clear();
 }
 
+// frame submission and frame to frame times, run it on vkms to compare the commit paths
+TEST_F(DeviceTest, FrameTime)
+{
+    const uint32_t frameCount = 300;
+    std::vector<LayerSettings> settings = {
+        {
+        .rectRatio = { 0, 0, 1.0f, 1.0f },
+        .color = RED },
+        {
+        .rectRatio = { 0, 0, 1.0f, 0.125f },
+        .color = GREEN },
+    };
+    std::vector<std::shared_ptr<HdiTestLayer>> layers = CreateLayers(settings);
+    ASSERT_TRUE((layers.size() > 0));
+    std::vector<uint64_t> submitTimes;
+    std::vector<uint64_t> frameTimes;
+    auto last = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < frameCount; i++) {
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_TRUE((PrepareAndPrensent() == DISPLAY_SUCCESS));
+        auto end = std::chrono::steady_clock::now();
+        submitTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+        if (i > 0) {
+            frameTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - last).count());
+        }
+        last = end;
+    }
+    ReportPercentiles("submit", submitTimes);
+    ReportPercentiles("frame", frameTimes);
+}
+
 TEST_P(LayerRotateTest, SplitCheck)
 {
     LayerSettings settings = GetParam();
@@ -509,6 +633,121 @@ TEST_F(VblankTest, CtrlTest)
     ASSERT_TRUE(ret != DISPLAY_SUCCESS) << "vblank do not disable";
 }
 
+// vblank delivery and prediction accuracy, run it on vkms where the vblanks come from an hrtimer
+TEST_F(VblankTest, Jitter)
+{
+    const uint32_t vblankCount = 120;
+    const uint32_t timeoutMs = 5000;
+    const int64_t phaseNs = -2000000; // wake 2ms ahead of the vblank
+    const uint64_t nPerUs = 1000;
+    std::shared_ptr<HdiTestDisplay> display = HdiTestDevice::GetInstance().GetFirstDisplay();
+    VblankRecorder onVblank(vblankCount);
+    VblankRecorder ahead(vblankCount);
+    int32_t ret = display->RegDisplayVBlankListener(VblankRecorder::OnVblank, &onVblank, 0);
+    ASSERT_TRUE(ret == DISPLAY_SUCCESS) << "RegDisplayVBlankListener failed";
+    ret = display->RegDisplayVBlankListener(VblankRecorder::OnVblank, &ahead, phaseNs);
+    ASSERT_TRUE(ret == DISPLAY_SUCCESS) << "RegDisplayVBlankListener failed";
+    bool done = onVblank.Wait(timeoutMs) && ahead.Wait(timeoutMs);
+    uint64_t next = 0;
+    uint64_t period = 0;
+    int32_t predicted = display->GetDisplayNextVBlank(&next, &period);
+    display->UnregDisplayVBlankListener(VblankRecorder::OnVblank, &onVblank);
+    display->UnregDisplayVBlankListener(VblankRecorder::OnVblank, &ahead);
+    usleep(100 * 1000); // wait for 100ms avoid the last vsync.
+    ASSERT_TRUE(done) << "listeners timeout";
+    ASSERT_TRUE(predicted == DISPLAY_SUCCESS) << "GetDisplayNextVBlank failed";
+    ASSERT_TRUE(period > 0);
+    DISPLAY_TEST_LOGD("period %" PRIu64 " ns", period);
+
+    std::vector<VblankSample> samples = onVblank.GetSamples();
+    std::unordered_map<unsigned int, uint64_t> vblanks;
+    std::vector<uint64_t> intervals;
+    std::vector<uint64_t> latencies;
+    for (size_t i = 0; i < samples.size(); i++) {
+        vblanks[samples[i].sequence] = samples[i].ns;
+        latencies.push_back((samples[i].receiveNs - samples[i].ns) / nPerUs);
+        if (i > 0) {
+            uint64_t interval = (samples[i].ns - samples[i - 1].ns) / (samples[i].sequence - samples[i - 1].sequence);
+            intervals.push_back(std::llabs(static_cast<int64_t>(interval - period)) / nPerUs);
+        }
+    }
+    std::vector<uint64_t> wakeups;
+    std::vector<uint64_t> predictions;
+    for (const auto &sample : ahead.GetSamples()) {
+        wakeups.push_back(std::llabs(static_cast<int64_t>(sample.receiveNs - sample.ns) - phaseNs) / nPerUs);
+        auto vblank = vblanks.find(sample.sequence);
+        if (vblank != vblanks.end()) {
+            predictions.push_back(std::llabs(static_cast<int64_t>(sample.ns - vblank->second)) / nPerUs);
+        }
+    }
+    ReportPercentiles("interval jitter", intervals);
+    ReportPercentiles("delivery latency", latencies);
+    ReportPercentiles("phase wakeup error", wakeups);
+    ReportPercentiles("prediction error", predictions);
+}
+
+// run it on vkms loaded with enable_writeback=1 to cover the writeback connector, elsewhere it reads back
+TEST_F(WriteBackTest, Capture)
+{
+    std::shared_ptr<HdiTestDisplay> display = GetFirstDisplay();
+    DisplayModeInfo mode = display->GetCurrentMode();
+    std::vector<LayerSettings> settings = {
+        {
+        .rectRatio = { 0, 0, 1.0f, 1.0f },
+        .color = RED },
+    };
+    std::vector<std::shared_ptr<HdiTestLayer>> layers = CreateLayers(settings);
+    ASSERT_TRUE((layers.size() > 0));
+    int32_t format = PIXEL_FMT_RGBA_8888;
+    int32_t ret = display->CreateWriteBack(mode.width, mode.height, &format, &mWriteBackId);
+    ASSERT_TRUE(ret == DISPLAY_SUCCESS) << "CreateWriteBack failed";
+    mHasWriteBack = true;
+    ASSERT_TRUE((PrepareAndPrensent() == DISPLAY_SUCCESS));
+    std::vector<uint32_t> red;
+    ASSERT_TRUE((GetCapturedPixels(mWriteBackId, red) == DISPLAY_SUCCESS));
+    ASSERT_TRUE((red[0] == red[1]) && (red[0] == red[2])) << "the frame is not uniform";
+
+    ASSERT_TRUE((FillAndPresent(layers[0], GREEN) == DISPLAY_SUCCESS));
+    std::vector<uint32_t> green;
+    ASSERT_TRUE((GetCapturedPixels(mWriteBackId, green) == DISPLAY_SUCCESS));
+    ASSERT_TRUE((green[0] == green[1]) && (green[0] == green[2])) << "the frame is not uniform";
+    ASSERT_TRUE(red[0] != green[0]) << "the new frame is not captured";
+}
+
+TEST_F(WriteBackTest, Cadence)
+{
+    std::shared_ptr<HdiTestDisplay> display = GetFirstDisplay();
+    DisplayModeInfo mode = display->GetCurrentMode();
+    std::vector<LayerSettings> settings = {
+        {
+        .rectRatio = { 0, 0, 1.0f, 1.0f },
+        .color = RED },
+    };
+    std::vector<std::shared_ptr<HdiTestLayer>> layers = CreateLayers(settings);
+    ASSERT_TRUE((layers.size() > 0));
+    int32_t format = PIXEL_FMT_RGBA_8888;
+    int32_t ret = display->CreateWriteBack(mode.width, mode.height, &format, &mWriteBackId);
+    ASSERT_TRUE(ret == DISPLAY_SUCCESS) << "CreateWriteBack failed";
+    mHasWriteBack = true;
+    DeviceFuncs &funcs = HdiTestDevice::GetInstance().GetDeviceFuncs();
+    ASSERT_TRUE((PrepareAndPrensent() == DISPLAY_SUCCESS));
+    std::vector<uint32_t> first;
+    ASSERT_TRUE((GetCapturedPixels(mWriteBackId, first) == DISPLAY_SUCCESS));
+
+    // stopped, the last capture stays
+    ASSERT_TRUE((funcs.SetWriteBackCadence(mWriteBackId, 0) == DISPLAY_SUCCESS));
+    ASSERT_TRUE((FillAndPresent(layers[0], GREEN) == DISPLAY_SUCCESS));
+    std::vector<uint32_t> stopped;
+    ASSERT_TRUE((GetCapturedPixels(mWriteBackId, stopped) == DISPLAY_SUCCESS));
+    ASSERT_TRUE(stopped[0] == first[0]) << "a frame is captured while the captures are stopped";
+
+    ASSERT_TRUE((funcs.SetWriteBackCadence(mWriteBackId, 1) == DISPLAY_SUCCESS));
+    ASSERT_TRUE((FillAndPresent(layers[0], BLUE) == DISPLAY_SUCCESS));
+    std::vector<uint32_t> resumed;
+    ASSERT_TRUE((GetCapturedPixels(mWriteBackId, resumed) == DISPLAY_SUCCESS));
+    ASSERT_TRUE(resumed[0] != first[0]) << "the captures do not resume";
+}
+
 INSTANTIATE_TEST_CASE_P(MultiLayer, DeviceLayerDisplay, ::testing::ValuesIn(TEST_MULTILAYER));
 INSTANTIATE_TEST_CASE_P(SingleLayer, DeviceLayerDisplay, ::testing::ValuesIn(TEST_SINGLE_LAYER));
 INSTANTIATE_TEST_CASE_P(ScaleLayer, DeviceLayerDisplay, ::testing::ValuesIn(TEST_SCALE));
@@ -518,6 +757,8 @@ INSTANTIATE_TEST_CASE_P(Rotation, LayerRotateTest, ::testing::ValuesIn(TEST_ROTA
 
 int main(int argc, char **argv)
 {
+    // the checks read back the client buffer, keep every layer in it instead of on an overlay plane
+    setenv("HDI_DISPLAY_OVERLAY", "0", 0);
     int ret = HdiTestDevice::GetInstance().InitDevice();
     DISPLAY_TEST_CHK_RETURN((ret != DISPLAY_SUCCESS), DISPLAY_FAILURE, DISPLAY_TEST_LOGE("Init Device Failed"));
     ::testing::InitGoogleTest(&argc, argv);
@@ -96,6 +96,13 @@ protected:
     void TearDown();
 };
 
+class WriteBackTest : public ::testing::Test {
+protected:
+    void TearDown();
+    bool mHasWriteBack = false;
+    uint32_t mWriteBackId = 0;
+};
+
 class VblankCtr {
 public:
     static VblankCtr &GetInstance()
@@ -116,6 +123,28 @@ private:
     ~VblankCtr();
     bool mHasVblank = false;
 };
+
+struct VblankSample {
+    unsigned int sequence;
+    uint64_t ns;
+    // CLOCK_MONOTONIC time the listener ran at, the clock of the vblank timestamps
+    uint64_t receiveNs;
+};
+
+// collects the vblanks one listener receives
+class VblankRecorder {
+public:
+    explicit VblankRecorder(uint32_t count) : mCount(count) {}
+    static void OnVblank(unsigned int sequence, uint64_t ns, void *data);
+    bool Wait(uint32_t ms);
+    std::vector<VblankSample> GetSamples();
+
+private:
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::vector<VblankSample> mSamples;
+    uint32_t mCount;
+};
 } // OHOS
 } // HDI
 } // DISPLAY
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hdi_netlink_monitor_test.h"
+
+namespace {
+const std::string DRM_HEADER = "change@/devices/platform/vkms/drm/card0";
+const std::vector<std::string> DRM_HOTPLUG = {
+    "ACTION=change",
+    "DEVPATH=/devices/platform/vkms/drm/card0",
+    "SUBSYSTEM=drm",
+    "HOTPLUG=1",
+    "DEVNAME=dri/card0",
+    "DEVTYPE=drm_minor",
+    "SEQNUM=2042",
+    "MAJOR=226",
+    "MINOR=0",
+};
+
+std::string NetLinkMonitorTest::MakeUevent(const std::string &header, const std::vector<std::string> &pairs)
+{
+    std::string uevent = header;
+    for (const auto &pair : pairs) {
+        uevent.push_back('\0');
+        uevent += pair;
+    }
+    return uevent;
+}
+
+void NetLinkMonitorTest::Inject(const std::string &uevent)
+{
+    mMonitor.HandleUevent(uevent.data(), uevent.size());
+}
+
+TEST_F(NetLinkMonitorTest, ParseDrmHotplug)
+{
+    std::string uevent = MakeUevent(DRM_HEADER, DRM_HOTPLUG);
+    HdiUevent event;
+    ASSERT_TRUE(HdiNetLinkMonitor::ParseUevent(uevent.data(), uevent.size(), event));
+    EXPECT_EQ(event.action, "change");
+    EXPECT_EQ(event.subsystem, "drm");
+    EXPECT_EQ(event.devName, "dri/card0");
+    EXPECT_TRUE(event.hotplug);
+    EXPECT_EQ(event.connectorId, 0u);
+}
+
+TEST_F(NetLinkMonitorTest, ParseConnector)
+{
+    std::vector<std::string> pairs = DRM_HOTPLUG;
+    pairs.push_back("CONNECTOR=37");
+    pairs.push_back("PROPERTY=5");
+    std::string uevent = MakeUevent(DRM_HEADER, pairs);
+    HdiUevent event;
+    ASSERT_TRUE(HdiNetLinkMonitor::ParseUevent(uevent.data(), uevent.size(), event));
+    EXPECT_EQ(event.connectorId, 37u); // 37: the CONNECTOR above
+}
+
+TEST_F(NetLinkMonitorTest, ParseMalformed)
+{
+    HdiUevent event;
+    std::string noHeader = MakeUevent("libudev", { "ACTION=change" });
+    EXPECT_FALSE(HdiNetLinkMonitor::ParseUevent(noHeader.data(), noHeader.size(), event));
+    std::string noAction = MakeUevent(DRM_HEADER, { "SUBSYSTEM=drm", "HOTPLUG=1" });
+    EXPECT_FALSE(HdiNetLinkMonitor::ParseUevent(noAction.data(), noAction.size(), event));
+    EXPECT_FALSE(HdiNetLinkMonitor::ParseUevent(nullptr, 0, event));
+    // a datagram cut in the middle of a pair keeps what is complete
+    std::string uevent = MakeUevent(DRM_HEADER, DRM_HOTPLUG);
+    ASSERT_TRUE(HdiNetLinkMonitor::ParseUevent(uevent.data(), DRM_HEADER.size() + 20, event)); // 20: a part pair
+    EXPECT_EQ(event.action, "change");
+    EXPECT_FALSE(event.hotplug);
+}
+
+TEST_F(NetLinkMonitorTest, InjectOnlyDrmHotplug)
+{
+    Inject(MakeUevent("change@/devices/virtual/net/lo", { "ACTION=change", "SUBSYSTEM=net" }));
+    Inject(MakeUevent("add@/devices/platform/vkms/drm/card0", { "ACTION=add", "SUBSYSTEM=drm" }));
+    Inject(MakeUevent(DRM_HEADER, { "ACTION=change", "SUBSYSTEM=drm", "HOTPLUG=0" }));
+    EXPECT_TRUE(mEvents.empty());
+    Inject(MakeUevent(DRM_HEADER, DRM_HOTPLUG));
+    ASSERT_EQ(mEvents.size(), 1u);
+    EXPECT_EQ(mEvents[0].devName, "dri/card0");
+}
+
+TEST_F(NetLinkMonitorTest, InjectOnlyNoSocket)
+{
+    // a monitor that only injects never opens the socket nor starts the thread
+    EXPECT_NE(mMonitor.Init([](const HdiUevent &) {}), 0);
+    Inject(MakeUevent(DRM_HEADER, DRM_HOTPLUG));
+    EXPECT_EQ(mEvents.size(), 1u);
+}
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HDI_NETLINK_MONITOR_TEST_H
+#define HDI_NETLINK_MONITOR_TEST_H
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "hdi_netlink_monitor.h"
+
+namespace {
+using OHOS::HDI::DISPLAY::HdiNetLinkMonitor;
+using OHOS::HDI::DISPLAY::HdiUevent;
+
+class NetLinkMonitorTest : public ::testing::Test {
+protected:
+    // a datagram as the kernel sends it, the header and the pairs separated by NUL
+    static std::string MakeUevent(const std::string &header, const std::vector<std::string> &pairs);
+    // what the monitor thread does with a received datagram
+    void Inject(const std::string &uevent);
+    std::vector<HdiUevent> mEvents;
+    // no socket, the test is the only source of uevents
+    HdiNetLinkMonitor mMonitor { [this](const HdiUevent &event) { mEvents.push_back(event); } };
+};
+}
+#endif // HDI_NETLINK_MONITOR_TEST_H
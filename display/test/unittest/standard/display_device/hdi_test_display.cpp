@@ -210,6 +210,31 @@ int32_t HdiTestDisplay::SetDisplayVsyncEnabled(bool enabled)
     return ret;
 }
 
+int32_t HdiTestDisplay::RegDisplayVBlankListener(VBlankCallback cb, void *data, int64_t phaseNs)
+{
+    int ret = HdiTestDevice::GetInstance().GetDeviceFuncs().RegDisplayVBlankListener(mId, cb, data, phaseNs);
+    return ret;
+}
+
+int32_t HdiTestDisplay::UnregDisplayVBlankListener(VBlankCallback cb, void *data)
+{
+    int ret = HdiTestDevice::GetInstance().GetDeviceFuncs().UnregDisplayVBlankListener(mId, cb, data);
+    return ret;
+}
+
+int32_t HdiTestDisplay::GetDisplayNextVBlank(uint64_t *ns, uint64_t *period)
+{
+    int ret = HdiTestDevice::GetInstance().GetDeviceFuncs().GetDisplayNextVBlank(mId, ns, period);
+    return ret;
+}
+
+int32_t HdiTestDisplay::CreateWriteBack(uint32_t w, uint32_t h, int32_t *format, uint32_t *writeBackId)
+{
+    *writeBackId = mId;
+    int ret = HdiTestDevice::GetInstance().GetDeviceFuncs().CreateWriteBack(writeBackId, w, h, format);
+    return ret;
+}
+
 std::shared_ptr<HdiTestLayer> HdiTestDisplay::GetLayerFromId(uint32_t id)
 {
     auto layerMap = mLayerMaps.find(id);
@@ -43,6 +43,10 @@ public:
     }
     int32_t RegDisplayVBlankCallback(VBlankCallback cb, void *data);
     int32_t SetDisplayVsyncEnabled(bool enabled);
+    int32_t RegDisplayVBlankListener(VBlankCallback cb, void *data, int64_t phaseNs);
+    int32_t UnregDisplayVBlankListener(VBlankCallback cb, void *data);
+    int32_t GetDisplayNextVBlank(uint64_t *ns, uint64_t *period);
+    int32_t CreateWriteBack(uint32_t w, uint32_t h, int32_t *format, uint32_t *writeBackId);
     std::shared_ptr<HdiTestLayer> GetLayerFromId(uint32_t id);
     std::unordered_map<uint32_t, std::shared_ptr<HdiTestLayer>> &GetLayers()
     {
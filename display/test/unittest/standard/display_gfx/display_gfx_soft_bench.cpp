@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs the cpu compositor over full hd surfaces and prints the destination megapixels per second of every case as
+ * one JSON object per line. Compare the runs with 0 workers and with the default to see how the tiles scale.
+ * usage: display_gfx_soft_bench [workers] [iterations]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "display_gfx_soft.h"
+
+namespace {
+using OHOS::HDI::DISPLAY::SoftGfx;
+using OHOS::HDI::DISPLAY::SoftGfxImage;
+
+const int32_t WIDTH = 1920;
+const int32_t HEIGHT = 1080;
+const int32_t SCALE_WIDTH = 1280;
+const int32_t SCALE_HEIGHT = 720;
+const uint32_t DEFAULT_ITERATIONS = 50;
+const uint32_t WARMUP_ITERATIONS = 3;
+const double MEGA = 1000000.0;
+
+struct BenchImage {
+    BenchImage(int32_t width, int32_t height, PixelFormat format)
+    {
+        bool yuv = (format == PIXEL_FMT_YCBCR_420_SP);
+        image.width = width;
+        image.height = height;
+        image.format = format;
+        image.stride = yuv ? width : width * static_cast<int32_t>(sizeof(uint32_t));
+        size_t size = static_cast<size_t>(image.stride) * height;
+        size_t chromaSize = yuv ? size / 2 : 0; // 2: the CbCr plane is half the luma
+        data.resize(size + chromaSize);
+        uint32_t state = 1;
+        for (auto &byte : data) {
+            state = state * 1664525u + 1013904223u; // 1664525 1013904223: a linear congruential generator
+            byte = static_cast<uint8_t>(state >> 24); // 24: the high byte
+        }
+        image.data = data.data();
+        if (yuv) {
+            image.chroma = data.data() + size;
+            image.chromaStride = image.stride;
+        }
+    }
+    std::vector<uint8_t> data;
+    SoftGfxImage image;
+};
+
+struct BenchCase {
+    const char *name;
+    const BenchImage *src;
+    BlendType blend;
+    TransformType rotate;
+    bool fill;
+};
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t threads =
+        (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 0)) : SoftGfx::GetDefaultThreads();
+    uint32_t iterations = (argc > 2) ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 0)) : DEFAULT_ITERATIONS;
+    if (iterations == 0) {
+        fprintf(stderr, "usage: %s [workers] [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    SoftGfx gfx(threads);
+    BenchImage rgba(WIDTH, HEIGHT, PIXEL_FMT_RGBA_8888);
+    BenchImage rotated(HEIGHT, WIDTH, PIXEL_FMT_RGBA_8888);
+    BenchImage small(SCALE_WIDTH, SCALE_HEIGHT, PIXEL_FMT_RGBA_8888);
+    BenchImage nv12(WIDTH, HEIGHT, PIXEL_FMT_YCBCR_420_SP);
+    BenchImage dst(WIDTH, HEIGHT, PIXEL_FMT_RGBA_8888);
+    const BenchCase cases[] = {
+        { "copy", &rgba, BLEND_SRC, ROTATE_NONE, false },
+        { "srcover", &rgba, BLEND_SRCOVER, ROTATE_NONE, false },
+        { "xor", &rgba, BLEND_XOR, ROTATE_NONE, false },
+        { "rotate90_srcover", &rotated, BLEND_SRCOVER, ROTATE_90, false },
+        { "scale_srcover", &small, BLEND_SRCOVER, ROTATE_NONE, false },
+        { "nv12_copy", &nv12, BLEND_SRC, ROTATE_NONE, false },
+        { "fill", nullptr, BLEND_NONE, ROTATE_NONE, true },
+    };
+    IRect dstRect = { 0, 0, WIDTH, HEIGHT };
+    for (const auto &c : cases) {
+        GfxOpt opt = {};
+        opt.blendType = c.blend;
+        opt.rotateType = c.rotate;
+        opt.enPixelAlpha = true;
+        IRect srcRect = { 0, 0, 0, 0 };
+        if (c.src != nullptr) {
+            srcRect = { 0, 0, c.src->image.width, c.src->image.height };
+        }
+        double seconds = 0;
+        for (uint32_t i = 0; i < WARMUP_ITERATIONS + iterations; i++) {
+            auto start = std::chrono::steady_clock::now();
+            int32_t ret = c.fill ? gfx.Fill(dst.image, dstRect, 0x11223344, opt) :
+                                   gfx.Blit(c.src->image, srcRect, dst.image, dstRect, opt);
+            auto end = std::chrono::steady_clock::now();
+            if (ret != DISPLAY_SUCCESS) {
+                fprintf(stderr, "%s failed %d\n", c.name, ret);
+                return EXIT_FAILURE;
+            }
+            if (i >= WARMUP_ITERATIONS) {
+                seconds += std::chrono::duration<double>(end - start).count();
+            }
+        }
+        double megapixels = static_cast<double>(WIDTH) * HEIGHT * iterations / MEGA;
+        printf("{\"case\":\"%s\",\"workers\":%u,\"iterations\":%u,\"ms_per_frame\":%.3f,\"mpix_per_s\":%.1f}\n",
+            c.name, threads, iterations, seconds * 1000 / iterations, megapixels / seconds); // 1000: ms per second
+    }
+    return EXIT_SUCCESS;
+}
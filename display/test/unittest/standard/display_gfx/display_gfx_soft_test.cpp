@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "display_gfx_soft_test.h"
+#include <cstdlib>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "soft_blit.h"
+
+namespace {
+const uint32_t RED = 0xff0000ff;
+const uint32_t GREEN = 0x00ff00ff;
+const uint32_t BLUE = 0x0000ffff;
+const uint32_t WHITE = 0xffffffff;
+const uint32_t BACKGROUND = 0x11225588;
+const uint32_t MARK = 0x22336699;
+const uint32_t CHANNEL_TOLERANCE = 2;
+
+bool IsSemiPlanar(PixelFormat format)
+{
+    return (format == PIXEL_FMT_YCBCR_420_SP) || (format == PIXEL_FMT_YCRCB_420_SP);
+}
+
+int32_t GetPixelBytes(PixelFormat format)
+{
+    if (IsSemiPlanar(format)) {
+        return 1;
+    }
+    return ((format == PIXEL_FMT_RGB_565) || (format == PIXEL_FMT_BGR_565)) ? 2 : 4; // 2 4: bytes per pixel
+}
+
+bool IsNear(uint32_t a, uint32_t b)
+{
+    for (uint32_t shift = 0; shift < 32; shift += 8) { // 32 8: the four channels
+        int32_t ca = static_cast<int32_t>((a >> shift) & 0xff);
+        int32_t cb = static_cast<int32_t>((b >> shift) & 0xff);
+        if (static_cast<uint32_t>(std::abs(ca - cb)) > CHANNEL_TOLERANCE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TestImage::TestImage(int32_t width, int32_t height, PixelFormat format)
+{
+    mImage.width = width;
+    mImage.height = height;
+    mImage.format = format;
+    mImage.stride = width * GetPixelBytes(format);
+    size_t size = static_cast<size_t>(mImage.stride) * height;
+    if (IsSemiPlanar(format)) {
+        mImage.chromaStride = mImage.stride;
+        size += static_cast<size_t>(mImage.chromaStride) * ((height + 1) / 2);
+    }
+    mData.assign(size, 0);
+    mImage.data = mData.data();
+    if (IsSemiPlanar(format)) {
+        mImage.chroma = mData.data() + static_cast<size_t>(mImage.stride) * height;
+    }
+}
+
+uint32_t TestImage::Get(int32_t x, int32_t y) const
+{
+    const uint8_t *row = mImage.data + y * mImage.stride;
+    if (GetPixelBytes(mImage.format) == sizeof(uint16_t)) {
+        return reinterpret_cast<const uint16_t *>(row)[x];
+    }
+    return reinterpret_cast<const uint32_t *>(row)[x];
+}
+
+void TestImage::Set(int32_t x, int32_t y, uint32_t value)
+{
+    uint8_t *row = mImage.data + y * mImage.stride;
+    if (GetPixelBytes(mImage.format) == sizeof(uint16_t)) {
+        reinterpret_cast<uint16_t *>(row)[x] = static_cast<uint16_t>(value);
+    } else {
+        reinterpret_cast<uint32_t *>(row)[x] = value;
+    }
+}
+
+void TestImage::Fill(uint32_t value)
+{
+    for (int32_t y = 0; y < mImage.height; y++) {
+        for (int32_t x = 0; x < mImage.width; x++) {
+            Set(x, y, value);
+        }
+    }
+}
+
+void TestImage::FillPattern(uint32_t seed)
+{
+    uint32_t state = seed;
+    for (int32_t y = 0; y < mImage.height; y++) {
+        for (int32_t x = 0; x < mImage.width; x++) {
+            state = state * 1664525u + 1013904223u; // 1664525 1013904223: a linear congruential generator
+            Set(x, y, state);
+        }
+    }
+}
+
+BufferHandle TestImage::GetHandle()
+{
+    BufferHandle handle = {};
+    handle.width = mImage.width;
+    handle.height = mImage.height;
+    handle.stride = mImage.stride;
+    handle.size = static_cast<int32_t>(mData.size());
+    handle.format = mImage.format;
+    handle.virAddr = mData.data();
+    return handle;
+}
+
+GfxOpt SoftGfxTest::MakeOpt(BlendType blend, TransformType rotate)
+{
+    GfxOpt opt = {};
+    opt.blendType = blend;
+    opt.enPixelAlpha = true;
+    opt.rotateType = rotate;
+    return opt;
+}
+
+TEST_P(SoftGfxBlendTest, MatchReference)
+{
+    const int32_t width = 67; // 67: not a multiple of the simd width, the tail takes the scalar path
+    const int32_t height = 35;
+    TestImage src(width, height, PIXEL_FMT_RGBA_8888);
+    TestImage dst(width, height, PIXEL_FMT_RGBA_8888);
+    TestImage before(width, height, PIXEL_FMT_RGBA_8888);
+    src.FillPattern(1);
+    dst.FillPattern(2); // 2: another pattern than the source
+    before.mData = dst.mData;
+    before.mImage.data = before.mData.data();
+    IRect rect = { 0, 0, width, height };
+    GfxOpt opt = {};
+    opt.blendType = GetParam();
+    opt.enPixelAlpha = true;
+    ASSERT_EQ(mGfx.Blit(src.mImage, rect, dst.mImage, rect, opt), DISPLAY_SUCCESS);
+    SoftBlit reference(src.GetHandle(), rect, before.GetHandle(), rect, GetParam());
+    EXPECT_TRUE(reference.RunAndCheck(dst.GetHandle()));
+}
+
+INSTANTIATE_TEST_CASE_P(SoftGfx, SoftGfxBlendTest,
+    ::testing::Values(BLEND_NONE, BLEND_CLEAR, BLEND_SRC, BLEND_SRCOVER, BLEND_DSTOVER, BLEND_SRCIN, BLEND_DSTIN,
+        BLEND_SRCOUT, BLEND_DSTOUT, BLEND_SRCATOP, BLEND_DSTATOP, BLEND_ADD, BLEND_XOR, BLEND_DST));
+
+TEST_F(SoftGfxTest, Rotate)
+{
+    // the positions the gfx test expects of a vendor library, on a smaller surface
+    const int32_t width = 40;
+    const int32_t height = 20;
+    const int32_t markX = 7;
+    const int32_t markY = 3;
+    struct {
+        TransformType rotate;
+        int32_t x;
+        int32_t y;
+    } cases[] = {
+        { ROTATE_NONE, markX, markY },
+        { ROTATE_90, height - 1 - markY, markX },
+        { ROTATE_180, width - 1 - markX, height - 1 - markY },
+        { ROTATE_270, markY, width - 1 - markX },
+    };
+    TestImage src(width, height, PIXEL_FMT_BGRA_8888);
+    src.Fill(BACKGROUND);
+    src.Set(markX, markY, MARK);
+    for (const auto &c : cases) {
+        bool swap = (c.rotate == ROTATE_90) || (c.rotate == ROTATE_270);
+        TestImage dst(swap ? height : width, swap ? width : height, PIXEL_FMT_BGRA_8888);
+        IRect srcRect = { 0, 0, width, height };
+        IRect dstRect = { 0, 0, dst.mImage.width, dst.mImage.height };
+        ASSERT_EQ(mGfx.Blit(src.mImage, srcRect, dst.mImage, dstRect, MakeOpt(BLEND_SRC, c.rotate)), DISPLAY_SUCCESS);
+        for (int32_t y = 0; y < dst.mImage.height; y++) {
+            for (int32_t x = 0; x < dst.mImage.width; x++) {
+                uint32_t expect = ((x == c.x) && (y == c.y)) ? MARK : BACKGROUND;
+                ASSERT_EQ(dst.Get(x, y), expect) << "rotate " << c.rotate << " x " << x << " y " << y;
+            }
+        }
+    }
+}
+
+TEST_F(SoftGfxTest, Mirror)
+{
+    TestImage src(4, 2, PIXEL_FMT_RGBA_8888); // 4 2: a small surface
+    src.Fill(BACKGROUND);
+    src.Set(0, 0, MARK);
+    TestImage dst(4, 2, PIXEL_FMT_RGBA_8888);
+    IRect rect = { 0, 0, 4, 2 };
+    GfxOpt opt = MakeOpt(BLEND_SRC);
+    opt.mirrorType = MIRROR_LR;
+    ASSERT_EQ(mGfx.Blit(src.mImage, rect, dst.mImage, rect, opt), DISPLAY_SUCCESS);
+    EXPECT_EQ(dst.Get(3, 0), MARK);
+    opt.mirrorType = MIRROR_TB;
+    ASSERT_EQ(mGfx.Blit(src.mImage, rect, dst.mImage, rect, opt), DISPLAY_SUCCESS);
+    EXPECT_EQ(dst.Get(0, 1), MARK);
+}
+
+TEST_F(SoftGfxTest, Scale)
+{
+    TestImage src(2, 2, PIXEL_FMT_RGBA_8888); // 2: one pixel of each color
+    src.Set(0, 0, RED);
+    src.Set(1, 0, GREEN);
+    src.Set(0, 1, BLUE);
+    src.Set(1, 1, WHITE);
+    TestImage big(4, 4, PIXEL_FMT_RGBA_8888); // 4: twice as large
+    IRect srcRect = { 0, 0, 2, 2 };
+    IRect bigRect = { 0, 0, 4, 4 };
+    ASSERT_EQ(mGfx.Blit(src.mImage, srcRect, big.mImage, bigRect, MakeOpt(BLEND_SRC)), DISPLAY_SUCCESS);
+    for (int32_t y = 0; y < 4; y++) { // 4: the rows of the scaled image
+        for (int32_t x = 0; x < 4; x++) {
+            EXPECT_EQ(big.Get(x, y), src.Get(x / 2, y / 2)) << "x " << x << " y " << y; // 2: the scale factor
+        }
+    }
+    TestImage small(1, 1, PIXEL_FMT_RGBA_8888);
+    IRect smallRect = { 0, 0, 1, 1 };
+    IRect cropRect = { 1, 1, 1, 1 };
+    ASSERT_EQ(mGfx.Blit(big.mImage, cropRect, small.mImage, smallRect, MakeOpt(BLEND_SRC)), DISPLAY_SUCCESS);
+    EXPECT_EQ(small.Get(0, 0), RED);
+    ASSERT_EQ(mGfx.Blit(big.mImage, bigRect, small.mImage, smallRect, MakeOpt(BLEND_SRC)), DISPLAY_SUCCESS);
+    EXPECT_EQ(small.Get(0, 0), WHITE); // the center of the 4x4 source falls in its last quadrant
+}
+
+TEST_F(SoftGfxTest, Rgb565)
+{
+    TestImage src(3, 1, PIXEL_FMT_BGR_565); // 3: one pixel of each primary
+    src.Set(0, 0, 0xf800);
+    src.Set(1, 0, 0x07e0);
+    src.Set(2, 0, 0x001f); // 0xf800 0x07e0 0x001f: red green blue with red in the high bits
+    TestImage dst(3, 1, PIXEL_FMT_RGBA_8888);
+    IRect rect = { 0, 0, 3, 1 };
+    ASSERT_EQ(mGfx.Blit(src.mImage, rect, dst.mImage, rect, MakeOpt(BLEND_SRCOVER)), DISPLAY_SUCCESS);
+    EXPECT_EQ(dst.Get(0, 0), RED);
+    EXPECT_EQ(dst.Get(1, 0), GREEN);
+    EXPECT_EQ(dst.Get(2, 0), BLUE);
+    TestImage back(3, 1, PIXEL_FMT_RGB_565);
+    ASSERT_EQ(mGfx.Blit(dst.mImage, rect, back.mImage, rect, MakeOpt(BLEND_SRC)), DISPLAY_SUCCESS);
+    EXPECT_EQ(back.Get(0, 0), 0x001fu); // RGB_565 keeps blue in the high bits
+    EXPECT_EQ(back.Get(1, 0), 0x07e0u);
+    EXPECT_EQ(back.Get(2, 0), 0xf800u);
+}
+
+TEST_F(SoftGfxTest, Nv12)
+{
+    const int32_t size = 4;
+    TestImage src(size, size, PIXEL_FMT_YCBCR_420_SP);
+    // the left half white, the right half red
+    for (int32_t y = 0; y < size; y++) {
+        for (int32_t x = 0; x < size; x++) {
+            src.mImage.data[y * src.mImage.stride + x] = (x < size / 2) ? 235 : 81; // 235 81: the luma of both
+        }
+    }
+    for (int32_t y = 0; y < size / 2; y++) {
+        uint8_t *uv = src.mImage.chroma + y * src.mImage.chromaStride;
+        uv[0] = 128; // 128: no chroma
+        uv[1] = 128;
+        uv[2] = 90; // 90 240: the cb and cr of red
+        uv[3] = 240;
+    }
+    TestImage dst(size, size, PIXEL_FMT_RGBA_8888);
+    IRect rect = { 0, 0, size, size };
+    ASSERT_EQ(mGfx.Blit(src.mImage, rect, dst.mImage, rect, MakeOpt(BLEND_SRC)), DISPLAY_SUCCESS);
+    EXPECT_TRUE(IsNear(dst.Get(0, 0), WHITE)) << std::hex << dst.Get(0, 0);
+    EXPECT_TRUE(IsNear(dst.Get(size - 1, size - 1), RED)) << std::hex << dst.Get(size - 1, size - 1);
+
+    // the same picture as NV21 swaps the chroma bytes
+    src.mImage.format = PIXEL_FMT_YCRCB_420_SP;
+    for (int32_t y = 0; y < size / 2; y++) {
+        std::swap(src.mImage.chroma[y * src.mImage.chromaStride + 2], src.mImage.chroma[y * src.mImage.chromaStride + 3]);
+    }
+    ASSERT_EQ(mGfx.Blit(src.mImage, rect, dst.mImage, rect, MakeOpt(BLEND_SRC)), DISPLAY_SUCCESS);
+    EXPECT_TRUE(IsNear(dst.Get(size - 1, 0), RED)) << std::hex << dst.Get(size - 1, 0);
+}
+
+TEST_F(SoftGfxTest, GlobalAlpha)
+{
+    TestImage src(5, 1, PIXEL_FMT_RGBA_8888); // 5: a few pixels
+    TestImage dst(5, 1, PIXEL_FMT_RGBA_8888);
+    src.Fill(RED);
+    dst.Fill(BLUE);
+    IRect rect = { 0, 0, 5, 1 };
+    GfxOpt opt = MakeOpt(BLEND_SRCOVER);
+    opt.enGlobalAlpha = true;
+    opt.globalAlpha = 0x80;
+    ASSERT_EQ(mGfx.Blit(src.mImage, rect, dst.mImage, rect, opt), DISPLAY_SUCCESS);
+    EXPECT_EQ(dst.Get(4, 0), 0x80007fffu); // half red over blue
+    // without pixel alpha a transparent source still covers the destination
+    src.Fill(GREEN & 0xffffff00);
+    dst.Fill(BLUE);
+    opt = MakeOpt(BLEND_SRCOVER);
+    opt.enPixelAlpha = false;
+    ASSERT_EQ(mGfx.Blit(src.mImage, rect, dst.mImage, rect, opt), DISPLAY_SUCCESS);
+    EXPECT_EQ(dst.Get(0, 0), GREEN);
+}
+
+TEST_F(SoftGfxTest, ClipDstRect)
+{
+    TestImage src(8, 8, PIXEL_FMT_RGBA_8888); // 8: the source size
+    TestImage dst(8, 8, PIXEL_FMT_RGBA_8888);
+    for (int32_t x = 0; x < 8; x++) {
+        for (int32_t y = 0; y < 8; y++) {
+            src.Set(x, y, (x < 4) ? RED : GREEN); // 4: the left half
+        }
+    }
+    dst.Fill(BACKGROUND);
+    IRect srcRect = { 0, 0, 8, 8 };
+    IRect dstRect = { -4, 2, 8, 8 }; // half of it left of the surface, some below
+    ASSERT_EQ(mGfx.Blit(src.mImage, srcRect, dst.mImage, dstRect, MakeOpt(BLEND_SRC)), DISPLAY_SUCCESS);
+    EXPECT_EQ(dst.Get(0, 1), BACKGROUND);
+    EXPECT_EQ(dst.Get(0, 2), GREEN); // the red half is out of the surface
+    EXPECT_EQ(dst.Get(3, 7), GREEN);
+    EXPECT_EQ(dst.Get(4, 2), BACKGROUND);
+}
+
+TEST_F(SoftGfxTest, TilesMatchSingleThread)
+{
+    const int32_t width = 600; // 600 400: large enough to split in tiles
+    const int32_t height = 400;
+    SoftGfx threaded(3); // 3: workers beside the calling thread
+    TestImage src(width, height, PIXEL_FMT_RGBA_8888);
+    src.FillPattern(3); // 3: the seed
+    for (TransformType rotate : { ROTATE_NONE, ROTATE_90 }) {
+        bool swap = (rotate == ROTATE_90);
+        TestImage single(swap ? height : width, swap ? width : height, PIXEL_FMT_BGRA_8888);
+        single.FillPattern(4); // 4: the seed
+        TestImage tiled = single;
+        tiled.mImage.data = tiled.mData.data();
+        IRect srcRect = { 0, 0, width, height };
+        IRect dstRect = { 0, 0, single.mImage.width, single.mImage.height };
+        ASSERT_EQ(mGfx.Blit(src.mImage, srcRect, single.mImage, dstRect, MakeOpt(BLEND_SRCOVER, rotate)),
+            DISPLAY_SUCCESS);
+        ASSERT_EQ(threaded.Blit(src.mImage, srcRect, tiled.mImage, dstRect, MakeOpt(BLEND_SRCOVER, rotate)),
+            DISPLAY_SUCCESS);
+        EXPECT_TRUE(single.mData == tiled.mData) << "rotate " << rotate;
+    }
+    TestImage filled(width, height, PIXEL_FMT_RGBA_8888);
+    IRect rect = { 0, 0, width, height };
+    ASSERT_EQ(threaded.Fill(filled.mImage, rect, MARK, MakeOpt(BLEND_NONE)), DISPLAY_SUCCESS);
+    EXPECT_EQ(filled.Get(width - 1, height - 1), MARK);
+}
+
+TEST_F(SoftGfxTest, Fill)
+{
+    TestImage dst(6, 3, PIXEL_FMT_BGR_565); // 6 3: a small surface
+    IRect rect = { 1, 1, 4, 1 };
+    ASSERT_EQ(mGfx.Fill(dst.mImage, rect, RED, MakeOpt(BLEND_NONE)), DISPLAY_SUCCESS);
+    EXPECT_EQ(dst.Get(0, 1), 0u);
+    EXPECT_EQ(dst.Get(1, 1), 0xf800u);
+    EXPECT_EQ(dst.Get(4, 1), 0xf800u);
+    EXPECT_EQ(dst.Get(5, 1), 0u);
+    TestImage rgba(2, 1, PIXEL_FMT_RGBA_8888); // 2: a small surface
+    rgba.Fill(BLUE);
+    IRect all = { 0, 0, 2, 1 };
+    ASSERT_EQ(mGfx.Fill(rgba.mImage, all, RED & 0xffffff80, MakeOpt(BLEND_SRCOVER)), DISPLAY_SUCCESS);
+    EXPECT_EQ(rgba.Get(1, 0), 0x80007fffu); // half red over blue
+}
+
+TEST_F(SoftGfxTest, InvalidParams)
+{
+    TestImage src(4, 4, PIXEL_FMT_RGBA_8888); // 4: a small surface
+    TestImage yuv(4, 4, PIXEL_FMT_YCBCR_420_SP);
+    IRect rect = { 0, 0, 4, 4 };
+    IRect outside = { 2, 2, 4, 4 };
+    EXPECT_EQ(mGfx.Blit(src.mImage, rect, src.mImage, rect, MakeOpt(BLEND_AKS)), DISPLAY_NOT_SUPPORT);
+    EXPECT_EQ(mGfx.Blit(src.mImage, rect, yuv.mImage, rect, MakeOpt(BLEND_SRC)), DISPLAY_NOT_SUPPORT);
+    EXPECT_EQ(mGfx.Blit(src.mImage, outside, src.mImage, rect, MakeOpt(BLEND_SRC)), DISPLAY_PARAM_ERR);
+    EXPECT_EQ(mGfx.Fill(yuv.mImage, rect, RED, MakeOpt(BLEND_NONE)), DISPLAY_NOT_SUPPORT);
+    SoftGfxImage empty;
+    EXPECT_EQ(mGfx.Fill(empty, rect, RED, MakeOpt(BLEND_NONE)), DISPLAY_PARAM_ERR);
+}
+
+// the GfxFuncs map the surfaces from the fd the display device puts in phyAddr
+TEST_F(SoftGfxTest, GfxFuncs)
+{
+    const int32_t width = 16;
+    const int32_t height = 8;
+    const int32_t stride = width * sizeof(uint32_t);
+    const size_t size = static_cast<size_t>(stride) * height;
+    int srcFd = memfd_create("soft_gfx_src", 0);
+    int dstFd = memfd_create("soft_gfx_dst", 0);
+    ASSERT_GE(srcFd, 0);
+    ASSERT_GE(dstFd, 0);
+    ASSERT_EQ(ftruncate(srcFd, size), 0);
+    ASSERT_EQ(ftruncate(dstFd, size), 0);
+    ISurface srcSurface = {};
+    srcSurface.phyAddr = static_cast<uint64_t>(srcFd);
+    srcSurface.width = width;
+    srcSurface.height = height;
+    srcSurface.stride = stride;
+    srcSurface.enColorFmt = PIXEL_FMT_RGBA_8888;
+    ISurface dstSurface = srcSurface;
+    dstSurface.phyAddr = static_cast<uint64_t>(dstFd);
+    IRect rect = { 0, 0, width, height };
+    GfxOpt opt = MakeOpt(BLEND_SRC);
+
+    GfxFuncs *funcs = nullptr;
+    ASSERT_EQ(SoftGfxInitialize(&funcs), DISPLAY_SUCCESS);
+    ASSERT_NE(funcs, nullptr);
+    EXPECT_EQ(funcs->InitGfx(), DISPLAY_SUCCESS);
+    EXPECT_EQ(funcs->FillRect(&srcSurface, &rect, MARK, &opt), DISPLAY_SUCCESS);
+    EXPECT_EQ(funcs->Blit(&srcSurface, &rect, &dstSurface, &rect, &opt), DISPLAY_SUCCESS);
+    EXPECT_EQ(funcs->Sync(0), DISPLAY_SUCCESS);
+    EXPECT_EQ(funcs->DeinitGfx(), DISPLAY_SUCCESS);
+    EXPECT_NE(funcs->Blit(&srcSurface, &rect, &dstSurface, &rect, &opt), DISPLAY_SUCCESS);
+    EXPECT_EQ(SoftGfxUninitialize(funcs), DISPLAY_SUCCESS);
+
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, dstFd, 0);
+    ASSERT_NE(addr, MAP_FAILED);
+    const uint32_t *pixels = static_cast<const uint32_t *>(addr);
+    EXPECT_EQ(pixels[0], MARK);
+    EXPECT_EQ(pixels[width * height - 1], MARK);
+    munmap(addr, size);
+    close(srcFd);
+    close(dstFd);
+}
+}
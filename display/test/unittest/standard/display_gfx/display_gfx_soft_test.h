@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISPLAY_GFX_SOFT_TEST_H
+#define DISPLAY_GFX_SOFT_TEST_H
+#include <vector>
+#include "gtest/gtest.h"
+#include "display_gfx_soft.h"
+
+namespace {
+using OHOS::HDI::DISPLAY::SoftGfx;
+using OHOS::HDI::DISPLAY::SoftGfxImage;
+
+// an image in host memory, semi-planar formats keep the CbCr rows after the luma rows
+struct TestImage {
+    TestImage(int32_t width, int32_t height, PixelFormat format);
+    uint32_t Get(int32_t x, int32_t y) const;
+    void Set(int32_t x, int32_t y, uint32_t value);
+    void Fill(uint32_t value);
+    // pseudo random pixels, every alpha value shows up
+    void FillPattern(uint32_t seed);
+    // the view the reference blender of the gfx test reads, only for PIXEL_FMT_RGBA_8888
+    BufferHandle GetHandle();
+    std::vector<uint8_t> mData;
+    SoftGfxImage mImage;
+};
+
+class SoftGfxTest : public ::testing::Test {
+protected:
+    static GfxOpt MakeOpt(BlendType blend, TransformType rotate = ROTATE_NONE);
+    SoftGfx mGfx { 0 };
+};
+
+class SoftGfxBlendTest : public ::testing::TestWithParam<BlendType> {
+protected:
+    SoftGfx mGfx { 0 };
+};
+}
+#endif // DISPLAY_GFX_SOFT_TEST_H
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "display_gralloc_pool_test.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+const uint32_t BYTES_PER_PIXEL = 4;
+const uint32_t WIDTH = 64;
+const uint32_t HEIGHT = 32;
+const uint32_t BUFFER_SIZE = WIDTH * HEIGHT * BYTES_PER_PIXEL;
+const uint64_t POOL_MAX_BYTES = BUFFER_SIZE * 3;
+const int32_t FAKE_FD = 100;
+
+std::vector<BufferHandle *> GrallocPoolTest::sDestroyed;
+std::vector<const PriBufferHandle *> GrallocPoolTest::sShared;
+
+void GrallocPoolTest::SetUp()
+{
+    sDestroyed.clear();
+    sShared.clear();
+    GrallocPoolInit(&mPool, POOL_MAX_BYTES, Destroy, IsShared);
+}
+
+void GrallocPoolTest::TearDown()
+{
+    GrallocPoolDeinit(&mPool);
+}
+
+void GrallocPoolTest::Destroy(BufferHandle *buffer)
+{
+    sDestroyed.push_back(buffer);
+    free(buffer);
+}
+
+bool GrallocPoolTest::IsShared(const PriBufferHandle *buffer)
+{
+    return std::find(sShared.begin(), sShared.end(), buffer) != sShared.end();
+}
+
+PriBufferHandle *GrallocPoolTest::Alloc(uint32_t width, uint32_t height, PixelFormat format)
+{
+    AllocInfo info = {};
+    info.width = width;
+    info.height = height;
+    info.format = format;
+    info.usage = HBM_USE_MEM_DMA | HBM_USE_CPU_READ | HBM_USE_CPU_WRITE;
+    PriBufferHandle *buffer = GrallocPoolAcquire(&mPool, &info);
+    if (buffer != nullptr) {
+        return buffer;
+    }
+    buffer = static_cast<PriBufferHandle *>(calloc(1, sizeof(PriBufferHandle)));
+    if (buffer == nullptr) {
+        return nullptr;
+    }
+    buffer->hdl.fd = FAKE_FD;
+    buffer->hdl.width = static_cast<int32_t>(width);
+    buffer->hdl.height = static_cast<int32_t>(height);
+    buffer->hdl.stride = static_cast<int32_t>(width * BYTES_PER_PIXEL);
+    buffer->hdl.size = static_cast<int32_t>(width * height * BYTES_PER_PIXEL);
+    buffer->hdl.format = format;
+    buffer->hdl.usage = info.usage;
+    GrallocPoolTrack(&mPool, buffer, &info);
+    return buffer;
+}
+
+bool WasDestroyed(const std::vector<BufferHandle *> &destroyed, const PriBufferHandle *buffer)
+{
+    return std::find(destroyed.begin(), destroyed.end(), &buffer->hdl) != destroyed.end();
+}
+
+TEST_F(GrallocPoolTest, ReuseSameRequest)
+{
+    PriBufferHandle *first = Alloc(WIDTH, HEIGHT);
+    ASSERT_NE(first, nullptr);
+    ASSERT_TRUE(GrallocPoolRelease(&mPool, &first->hdl));
+    PriBufferHandle *second = Alloc(WIDTH, HEIGHT);
+    EXPECT_EQ(second, first);
+    GrallocPoolStats stats;
+    GrallocPoolGetStats(&mPool, &stats);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.liveCount, 1u);
+    EXPECT_EQ(stats.freeCount, 0u);
+    EXPECT_EQ(stats.freeBytes, 0u);
+    EXPECT_TRUE(GrallocPoolRelease(&mPool, &second->hdl));
+}
+
+TEST_F(GrallocPoolTest, NoReuseOtherRequest)
+{
+    PriBufferHandle *first = Alloc(WIDTH, HEIGHT);
+    ASSERT_NE(first, nullptr);
+    ASSERT_TRUE(GrallocPoolRelease(&mPool, &first->hdl));
+    PriBufferHandle *other = Alloc(HEIGHT, WIDTH);
+    ASSERT_NE(other, nullptr);
+    EXPECT_NE(other, first);
+    PriBufferHandle *format = Alloc(WIDTH, HEIGHT, PIXEL_FMT_BGRA_8888);
+    ASSERT_NE(format, nullptr);
+    EXPECT_NE(format, first);
+    GrallocPoolStats stats;
+    GrallocPoolGetStats(&mPool, &stats);
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.misses, 3u); // 3: every allocation created a buffer
+    EXPECT_EQ(stats.freeCount, 1u);
+    EXPECT_TRUE(GrallocPoolRelease(&mPool, &other->hdl));
+    EXPECT_TRUE(GrallocPoolRelease(&mPool, &format->hdl));
+}
+
+TEST_F(GrallocPoolTest, NewestFirst)
+{
+    PriBufferHandle *older = Alloc(WIDTH, HEIGHT);
+    PriBufferHandle *newer = Alloc(WIDTH, HEIGHT);
+    ASSERT_NE(older, nullptr);
+    ASSERT_NE(newer, nullptr);
+    ASSERT_TRUE(GrallocPoolRelease(&mPool, &older->hdl));
+    ASSERT_TRUE(GrallocPoolRelease(&mPool, &newer->hdl));
+    EXPECT_EQ(Alloc(WIDTH, HEIGHT), newer);
+    EXPECT_EQ(Alloc(WIDTH, HEIGHT), older);
+    EXPECT_TRUE(GrallocPoolRelease(&mPool, &older->hdl));
+    EXPECT_TRUE(GrallocPoolRelease(&mPool, &newer->hdl));
+}
+
+TEST_F(GrallocPoolTest, EvictLeastRecentlyReleased)
+{
+    const uint32_t count = 4;
+    std::vector<PriBufferHandle *> buffers;
+    for (uint32_t i = 0; i < count; i++) {
+        buffers.push_back(Alloc(WIDTH, HEIGHT));
+        ASSERT_NE(buffers.back(), nullptr);
+    }
+    for (auto buffer : buffers) {
+        ASSERT_TRUE(GrallocPoolRelease(&mPool, &buffer->hdl));
+    }
+    // only three fit under the limit, the first one released goes
+    ASSERT_EQ(sDestroyed.size(), 1u);
+    EXPECT_EQ(sDestroyed[0], &buffers[0]->hdl);
+    GrallocPoolStats stats;
+    GrallocPoolGetStats(&mPool, &stats);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.freeCount, count - 1);
+    EXPECT_EQ(stats.freeBytes, POOL_MAX_BYTES);
+    // reusing a buffer refreshes nothing, the next eviction takes the oldest one still free
+    PriBufferHandle *reused = Alloc(WIDTH, HEIGHT);
+    EXPECT_EQ(reused, buffers[count - 1]);
+    GrallocPoolTrim(&mPool, BUFFER_SIZE);
+    EXPECT_TRUE(WasDestroyed(sDestroyed, buffers[1]));
+    EXPECT_FALSE(WasDestroyed(sDestroyed, buffers[2])); // 2: the newest free buffer stays
+    EXPECT_TRUE(GrallocPoolRelease(&mPool, &reused->hdl));
+}
+
+TEST_F(GrallocPoolTest, TooLargeForPool)
+{
+    PriBufferHandle *large = Alloc(WIDTH * 4, HEIGHT); // 4: larger than the whole pool
+    ASSERT_NE(large, nullptr);
+    EXPECT_TRUE(GrallocPoolRelease(&mPool, &large->hdl));
+    ASSERT_EQ(sDestroyed.size(), 1u);
+    EXPECT_EQ(sDestroyed[0], &large->hdl);
+}
+
+TEST_F(GrallocPoolTest, ForeignHandle)
+{
+    PriBufferHandle *own = Alloc(WIDTH, HEIGHT);
+    ASSERT_NE(own, nullptr);
+    // a handle received from another process is a bare BufferHandle
+    BufferHandle foreign = own->hdl;
+    EXPECT_FALSE(GrallocPoolRelease(&mPool, &foreign));
+    EXPECT_TRUE(sDestroyed.empty());
+    EXPECT_TRUE(GrallocPoolRelease(&mPool, &own->hdl));
+    EXPECT_FALSE(GrallocPoolRelease(&mPool, &own->hdl));
+}
+
+TEST_F(GrallocPoolTest, SharedNotPooled)
+{
+    PriBufferHandle *shared = Alloc(WIDTH, HEIGHT);
+    ASSERT_NE(shared, nullptr);
+    sShared.push_back(shared);
+    EXPECT_TRUE(GrallocPoolRelease(&mPool, &shared->hdl));
+    ASSERT_EQ(sDestroyed.size(), 1u);
+    EXPECT_EQ(sDestroyed[0], &shared->hdl);
+    sShared.clear();
+    GrallocPoolStats stats;
+    GrallocPoolGetStats(&mPool, &stats);
+    EXPECT_EQ(stats.shared, 1u);
+    EXPECT_EQ(stats.freeCount, 0u);
+    // the next allocation gets a new buffer, not the memory someone else may still hold
+    PriBufferHandle *next = Alloc(WIDTH, HEIGHT);
+    ASSERT_NE(next, nullptr);
+    GrallocPoolGetStats(&mPool, &stats);
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_TRUE(GrallocPoolRelease(&mPool, &next->hdl));
+}
+
+TEST_F(GrallocPoolTest, ManyLiveBuffers)
+{
+    const uint32_t count = GRALLOC_POOL_LIVE_BUCKETS * 4; // 4: several buffers share each live bucket
+    std::vector<PriBufferHandle *> buffers;
+    for (uint32_t i = 0; i < count; i++) {
+        buffers.push_back(Alloc(WIDTH, i + 1));
+        ASSERT_NE(buffers.back(), nullptr);
+    }
+    // release out of allocation order, every handle is still found in its bucket
+    for (uint32_t i = 0; i < count; i += 2) { // 2: the even ones first
+        EXPECT_TRUE(GrallocPoolRelease(&mPool, &buffers[i]->hdl));
+    }
+    for (uint32_t i = 1; i < count; i += 2) { // 2: then the odd ones
+        EXPECT_TRUE(GrallocPoolRelease(&mPool, &buffers[i]->hdl));
+    }
+    GrallocPoolStats stats;
+    GrallocPoolGetStats(&mPool, &stats);
+    EXPECT_EQ(stats.liveCount, 0u);
+}
+
+TEST_F(GrallocPoolTest, DeinitKeepsLiveBuffers)
+{
+    PriBufferHandle *live = Alloc(WIDTH, HEIGHT);
+    PriBufferHandle *idle = Alloc(WIDTH, HEIGHT);
+    ASSERT_NE(live, nullptr);
+    ASSERT_NE(idle, nullptr);
+    ASSERT_TRUE(GrallocPoolRelease(&mPool, &idle->hdl));
+    GrallocPoolDeinit(&mPool);
+    ASSERT_EQ(sDestroyed.size(), 1u);
+    EXPECT_EQ(sDestroyed[0], &idle->hdl);
+    // the owner destroys the live buffer itself once the pool is gone
+    EXPECT_FALSE(GrallocPoolRelease(&mPool, &live->hdl));
+    Destroy(&live->hdl);
+    GrallocPoolInit(&mPool, POOL_MAX_BYTES, Destroy, IsShared);
+}
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISPLAY_GRALLOC_POOL_TEST_H
+#define DISPLAY_GRALLOC_POOL_TEST_H
+#include <vector>
+#include "gtest/gtest.h"
+#include "display_gralloc_pool.h"
+
+namespace {
+class GrallocPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override;
+    void TearDown() override;
+    // what the allocator does on a miss, the fake buffer has no memory behind its fd
+    PriBufferHandle *Alloc(uint32_t width, uint32_t height, PixelFormat format = PIXEL_FMT_RGBA_8888);
+    static void Destroy(BufferHandle *buffer);
+    // stands in for the dma-buf reference check, the buffers listed in sShared count as sent elsewhere
+    static bool IsShared(const PriBufferHandle *buffer);
+    static std::vector<BufferHandle *> sDestroyed;
+    static std::vector<const PriBufferHandle *> sShared;
+    GrallocPool mPool;
+};
+}
+#endif // DISPLAY_GRALLOC_POOL_TEST_H
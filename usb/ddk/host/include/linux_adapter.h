@@ -32,7 +32,8 @@ static inline pid_t gettid()
 #define BUS_OFFSET      8
 
 #define MAX_BULK_DATA_BUFFER_LENGTH     4096
-#define MAX_BULK_URBS_PER_REQUEST       1
+#define MAX_BULK_URBS_PER_REQUEST       64
+#define MAX_BULK_REQUEST_LENGTH         (MAX_BULK_DATA_BUFFER_LENGTH * MAX_BULK_URBS_PER_REQUEST)
 
 #define MAX_ISO_PACKETS_PER_URB         128
 #define MAX_ISO_DATA_BUFFER_LEN         (8 * 1024)
@@ -46,6 +47,12 @@ static inline pid_t gettid()
     (URBS_PER_REQUEST * sizeof(struct UsbAdapterUrb)) + MAX_BULK_DATA_BUFFER_LENGTH
 #define MAX_CTRL_BUFFER_LENGTH  4096
 
+/* request pool size classes are 1K, 4K, 16K, 64K and 256K of data buffer */
+#define USB_ADAPTER_REQ_POOL_CLASS_NUM          5
+#define USB_ADAPTER_REQ_POOL_CLASS_MIN_SIZE     1024
+#define USB_ADAPTER_REQ_POOL_CLASS_SHIFT        2
+#define USB_ADAPTER_REQ_POOL_CACHE_MAX          16
+
 #define USB_ADAPTER_URB_TYPE_ISO                0
 #define USB_ADAPTER_URB_TYPE_INTERRUPT          1
 #define USB_ADAPTER_URB_TYPE_CONTROL            2
@@ -67,6 +74,7 @@ static inline pid_t gettid()
 #define USBDEVFS_SUBMITURB          _IOR('U', 10, struct UsbAdapterUrb)
 #define USBDEVFS_DISCARDURB         _IO('U', 11)
 #define USBDEVFS_REAPURB            _IOW('U', 12, void *)
+#define USBDEVFS_REAPURBNDELAY      _IOW('U', 13, void *)
 #define USBDEVFS_CLAIMINTERFACE     _IOR('U', 15, unsigned int)
 #define USBDEVFS_RELEASEINTERFACE   _IOR('U', 16, unsigned int)
 #define USBDEVFS_RESET              _IO('U', 20)
@@ -86,6 +94,24 @@ struct UsbAdapterStreams {
     unsigned char eps[0];
 };
 
+struct UsbAdapterRequestPoolStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t recycled;
+    /* requests unmapped on free or when the pool closes */
+    uint32_t released;
+};
+
+/* Per-device cache of usbfs-mapped requests, kept in UsbDevice::privateData. */
+struct UsbAdapterRequestPool {
+    struct OsalMutex lock;
+    struct DListHead freeList[USB_ADAPTER_REQ_POOL_CLASS_NUM];
+    uint32_t freeCount[USB_ADAPTER_REQ_POOL_CLASS_NUM];
+    uint32_t outstanding;
+    bool closed;
+    struct UsbAdapterRequestPoolStats stats;
+};
+
 struct UsbOsAdapterOps {
     int32_t (*init)(const struct UsbSession *session);
     void (*exit)(const struct UsbSession *session);
@@ -105,12 +131,15 @@ struct UsbOsAdapterOps {
     int32_t (*submitRequest)(struct UsbHostRequest *request);
     int32_t (*cancelRequest)(struct UsbHostRequest *request);
     int32_t (*urbCompleteHandle)(const struct UsbDeviceHandle *devHandle);
+    int32_t (*urbCompleteBatch)(const struct UsbDeviceHandle *devHandle, uint32_t maxUrbs);
 };
 
 struct UsbOsAdapterOps *UsbAdapterGetOps(void);
 UsbRawTidType UsbAdapterGetTid(void);
 int32_t UsbAdapterRegisterSignal(void);
 int32_t UsbAdapterKillSignal(struct UsbDeviceHandle *devHandle, UsbRawTidType tid);
+int32_t UsbAdapterGetRequestPoolStats(const struct UsbDeviceHandle *handle,
+    struct UsbAdapterRequestPoolStats *stats);
 int32_t AdapterAtomicInc(OsalAtomic *v);
 int32_t AdapterAtomicDec(OsalAtomic *v);
 
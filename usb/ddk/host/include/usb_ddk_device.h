@@ -21,6 +21,9 @@
 
 #define USB_MAXENDPOINTS    32
 #define USB_MAXALTSETTING   128
+#define USB_RAW_CONFIG_CACHE_MAX    8
+
+struct UsbRawConfigTree;
 
 struct UsbDeviceConfigDescriptor {
     struct UsbConfigDescriptor *desc;
@@ -44,6 +47,9 @@ struct UsbDevice {
     struct UsbDeviceConfigDescriptor *configDescriptors;
     struct OsalMutex requestLock;
     struct HdfSList requestList;
+    struct OsalMutex configCacheLock;
+    /* parsed configurations shared by RawGetConfigDescriptor callers */
+    struct UsbRawConfigTree *configCache[USB_RAW_CONFIG_CACHE_MAX];
     void *privateObject;
     void *privateData;
 };
@@ -96,6 +96,10 @@ struct UsbHostRequest {
     unsigned int timeout;
     unsigned char requestType;
     void *bulkUrb;
+    /* the number of urbs the bulkUrb array can hold */
+    int32_t bulkUrbNum;
+    /* the request pool the request memory is recycled to, NULL if not pooled */
+    void *reqPool;
     union {
         void *urbs;
         void **isoUrbs;
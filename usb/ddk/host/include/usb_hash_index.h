@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef USB_HASH_INDEX_H
+#define USB_HASH_INDEX_H
+
+#include <pthread.h>
+#include "hdf_base.h"
+
+#define USB_HASH_INDEX_BUCKETS  64
+
+/* (busNum, devAddr) of a device */
+#define USB_HASH_DEV_KEY(busNum, devAddr) \
+    (((uint32_t)(uint8_t)(busNum) << 8) | (uint32_t)(uint8_t)(devAddr))
+/* (interface number, endpoint address including the direction bit) of a pipe */
+#define USB_HASH_PIPE_KEY(interfaceId, pipeAddr) \
+    (((uint32_t)(uint8_t)(interfaceId) << 8) | (uint32_t)(uint8_t)(pipeAddr))
+
+#define USB_HASH_INDEX_ENTRY(ptr, type, member) \
+    ((type *)((char *)(ptr) - (char *)&((type *)0)->member))
+
+/* embedded in the indexed object, the index never allocates */
+struct UsbHashNode {
+    struct UsbHashNode *next;
+    uint32_t key;
+};
+
+/*
+ * Hash table guarded by a reader/writer lock: lookups on the transfer path
+ * only take the read side, attach and detach take the write side.
+ */
+struct UsbHashIndex {
+    pthread_rwlock_t lock;
+    struct UsbHashNode *buckets[USB_HASH_INDEX_BUCKETS];
+    uint32_t count;
+};
+
+typedef bool (*UsbHashIndexMatch)(const struct UsbHashNode *node, const void *arg);
+
+HDF_STATUS UsbHashIndexInit(struct UsbHashIndex *index);
+void UsbHashIndexDestroy(struct UsbHashIndex *index);
+void UsbHashIndexInsert(struct UsbHashIndex *index, struct UsbHashNode *node, uint32_t key);
+bool UsbHashIndexRemove(struct UsbHashIndex *index, struct UsbHashNode *node);
+struct UsbHashNode *UsbHashIndexFind(struct UsbHashIndex *index, uint32_t key,
+    UsbHashIndexMatch match, const void *arg);
+uint32_t UsbHashIndexCount(struct UsbHashIndex *index);
+
+/* for callers that must keep the found object stable while using it */
+void UsbHashIndexReadLock(struct UsbHashIndex *index);
+void UsbHashIndexReadUnlock(struct UsbHashIndex *index);
+struct UsbHashNode *UsbHashIndexFindLocked(const struct UsbHashIndex *index, uint32_t key,
+    UsbHashIndexMatch match, const void *arg);
+
+#endif /* USB_HASH_INDEX_H */
@@ -20,6 +20,7 @@
 #include "usb_ddk_device.h"
 #include "usb_ddk_interface.h"
 #include "usb_ddk_request.h"
+#include "usb_hash_index.h"
 #include "usb_raw_api_library.h"
 
 #define INTERFACE_POOL_ID_MAX   (128)
@@ -59,6 +60,10 @@ struct UsbSdkInterface {
     uint8_t altSettingId;
     struct UsbSession *session;
     OsalAtomic refCount;
+    /* linked into interfacePool->interfaceIndex, keyed by interface number */
+    struct UsbHashNode hashNode;
+    /* pipes indexed by pipeId, 0 is the control pipe */
+    struct UsbPipe *pipeTable[USB_MAXENDPOINTS + 1];
 };
 
 struct UsbInterfacePool {
@@ -67,6 +72,8 @@ struct UsbInterfacePool {
     struct OsalMutex mutex;
     struct DListHead interfaceList;
     struct OsalMutex interfaceLock;
+    /* every alternate setting of interfaceList, looked up on each transfer */
+    struct UsbHashIndex interfaceIndex;
     OsalAtomic refCount;
     uint8_t busNum;
     uint8_t devAddr;
@@ -77,6 +84,8 @@ struct UsbInterfacePool {
     UsbRawTidType ioProcessTid;
     UsbPoolProcessStatusType ioProcessStopStatus;
     struct OsalMutex ioStopLock;
+    /* completions are reaped by the shared io reactor instead of ioAsyncReceiveProcess */
+    bool ioReactor;
     struct UsbDevice *device;
 };
 
@@ -113,6 +122,8 @@ struct UsbIfRequest {
 
 int32_t UsbIfCreatPipeObj(const struct UsbSdkInterface *interfaceObj, struct UsbPipe **pipeObj);
 int32_t UsbIfCreatInterfaceObj(const struct UsbInterfacePool *interfacePool, struct UsbSdkInterface **interfaceObj);
+int32_t UsbIfAddPipeIndex(struct UsbSdkInterface *interfaceObj, struct UsbPipe *pipeObj);
+int32_t UsbIfAddInterfaceIndex(const struct UsbInterfacePool *interfacePool, struct UsbSdkInterface *interfaceObj);
 HDF_STATUS UsbIfDestroyInterfaceObj(
     const struct UsbInterfacePool *interfacePool, const struct UsbSdkInterface *interfaceObj);
 int32_t UsbIfCreatInterfacePool(const struct UsbSession *session, uint8_t busNum, uint8_t devAddr,
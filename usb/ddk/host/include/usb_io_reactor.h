@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef USB_IO_REACTOR_H
+#define USB_IO_REACTOR_H
+
+#include "usb_interface_pool.h"
+
+#define USB_IO_REACTOR_STACK_SIZE       10000
+#define USB_IO_REACTOR_MAX_EVENTS       16
+#define USB_IO_REACTOR_REAP_BATCH       32
+#define USB_IO_REACTOR_WAIT_MS          1
+
+struct UsbIoReactorStats {
+    /* the number of device fds currently polled */
+    uint32_t devices;
+    /* the number of interface pools reaping through them */
+    uint32_t pools;
+    /* the number of reactor threads, 0 before the first registration */
+    uint32_t threads;
+    /* the number of times the reactor woke up with ready fds */
+    uint64_t wakeups;
+    /* the number of urbs reaped */
+    uint64_t completions;
+    /* the number of interface pools that left the reactor */
+    uint64_t releases;
+};
+
+/*
+ * Only completions go through the reactor. Each interface pool keeps its IoSendProcess thread: requests
+ * are queued behind a semaphore rather than an fd epoll can wait on, a bulk request is submitted as up
+ * to 64 urbs with retries, and doing that on the shared thread would hold up reaping for every device.
+ */
+HDF_STATUS UsbIoReactorRegister(struct UsbInterfacePool *interfacePool);
+HDF_STATUS UsbIoReactorUnregister(struct UsbInterfacePool *interfacePool);
+HDF_STATUS UsbIoReactorGetStats(struct UsbIoReactorStats *stats);
+/* Stops and joins the reactor thread once no device is registered, the next registration restarts it. */
+HDF_STATUS UsbIoReactorStop(void);
+
+#endif /* USB_IO_REACTOR_H */
@@ -105,6 +105,10 @@ int32_t RawFreeRequest(const struct UsbHostRequest *request);
 int32_t RawGetConfigDescriptor(const struct UsbDevice *dev, uint8_t configIndex,
     struct UsbRawConfigDescriptor **config);
 void RawClearConfiguration(struct UsbRawConfigDescriptor *config);
+void RawFreeConfigDescriptor(const struct UsbRawConfigDescriptor *config);
+void RawConfigCacheInit(struct UsbDevice *dev);
+void RawConfigCacheInvalidate(struct UsbDevice *dev);
+void RawConfigCacheDeinit(struct UsbDevice *dev);
 int32_t RawGetConfiguration(const struct UsbDeviceHandle *devHandle, int32_t *config);
 int32_t RawSetConfiguration(const struct UsbDeviceHandle *devHandle, int32_t configuration);
 int32_t RawGetDescriptor(const struct UsbHostRequest *request, const struct UsbDeviceHandle *devHandle,
@@ -116,6 +120,7 @@ int32_t RawResetDevice(const struct UsbDeviceHandle *devHandle);
 int32_t RawSubmitRequest(const struct UsbHostRequest *request);
 int32_t RawCancelRequest(const struct UsbHostRequest *request);
 int32_t RawHandleRequest(const struct UsbDeviceHandle *devHandle);
+int32_t RawHandleRequestBatch(const struct UsbDeviceHandle *devHandle, uint32_t maxUrbs);
 int32_t RawClearHalt(const struct UsbDeviceHandle *devHandle, uint8_t pipeAddress);
 int32_t RawHandleRequestCompletion(struct UsbHostRequest *request, UsbRequestStatus status);
 int32_t RawSetInterfaceAltsetting(
@@ -114,6 +114,7 @@ static struct UsbDevice *OsAllocDevice(struct UsbSession *session, struct UsbDev
     dev->devHandle = handle;
 
     RawRequestListInit(dev);
+    RawConfigCacheInit(dev);
 
     handle->dev = dev;
 
@@ -480,7 +481,7 @@ static int32_t OsSubmitBulkRequest(struct UsbHostRequest *request)
         return HDF_ERR_INVALID_PARAM;
     }
 
-    if (request->length > MAX_BULK_DATA_BUFFER_LENGTH || request->length <= 0) {
+    if (request->length > MAX_BULK_REQUEST_LENGTH || request->length <= 0) {
         HDF_LOGE("Bulk request size err");
         return -1;
     }
@@ -501,15 +502,18 @@ static int32_t OsSubmitBulkRequest(struct UsbHostRequest *request)
         numUrbs++;
     }
 
-    if (numUrbs != 1) {
+    /* the urb array only grows, so a recycled request keeps its largest array */
+    if ((numUrbs > request->bulkUrbNum) || (request->bulkUrb == NULL)) {
         urbs = RawUsbMemCalloc(numUrbs * sizeof(*urbs));
         if (request->bulkUrb) {
             RawUsbMemFree(request->bulkUrb);
         }
         request->bulkUrb = urbs;
+        request->bulkUrbNum = (urbs != NULL) ? numUrbs : 0;
         request->urbs = NULL;
     } else {
         urbs = request->bulkUrb;
+        (void)memset_s(urbs, numUrbs * sizeof(*urbs), 0, numUrbs * sizeof(*urbs));
     }
 
     if (urbs == NULL) {
@@ -865,6 +869,160 @@ COMPLETED:
     return RawHandleRequestCompletion(request, request->reqStatus);
 }
 
+static int32_t OsRequestPoolClass(size_t len)
+{
+    size_t classSize = USB_ADAPTER_REQ_POOL_CLASS_MIN_SIZE;
+
+    for (int32_t i = 0; i < USB_ADAPTER_REQ_POOL_CLASS_NUM; i++) {
+        if (len <= classSize) {
+            return i;
+        }
+        classSize <<= USB_ADAPTER_REQ_POOL_CLASS_SHIFT;
+    }
+
+    return -1;
+}
+
+static size_t OsRequestPoolClassSize(int32_t cls)
+{
+    return (size_t)USB_ADAPTER_REQ_POOL_CLASS_MIN_SIZE << (USB_ADAPTER_REQ_POOL_CLASS_SHIFT * cls);
+}
+
+static struct UsbAdapterRequestPool *OsRequestPoolCreate(void)
+{
+    struct UsbAdapterRequestPool *pool = RawUsbMemCalloc(sizeof(*pool));
+    if (pool == NULL) {
+        HDF_LOGE("%{public}s:%{public}d RawUsbMemCalloc failed.", __func__, __LINE__);
+        return NULL;
+    }
+
+    OsalMutexInit(&pool->lock);
+    for (int32_t i = 0; i < USB_ADAPTER_REQ_POOL_CLASS_NUM; i++) {
+        DListHeadInit(&pool->freeList[i]);
+    }
+
+    return pool;
+}
+
+static void OsRequestPoolDestroy(struct UsbAdapterRequestPool *pool)
+{
+    OsalMutexDestroy(&pool->lock);
+    RawUsbMemFree(pool);
+}
+
+static int32_t OsRequestUnmap(struct UsbHostRequest *request)
+{
+    size_t allocSize = sizeof(struct UsbHostRequest)
+                       + (sizeof(struct UsbIsoPacketDesc) * (size_t)(request->numIsoPackets))
+                       + request->bufLen;
+
+    if (request->bulkUrb) {
+        RawUsbMemFree(request->bulkUrb);
+        request->bulkUrb = NULL;
+    }
+    request->urbs = NULL;
+    if (munmap((void *)request, allocSize) != 0) {
+        HDF_LOGE("%s:%d munmap failed, errno=%d", __func__, __LINE__, errno);
+        return HDF_ERR_IO;
+    }
+
+    return HDF_SUCCESS;
+}
+
+/* Take a cached request of the given class, or account for a fresh one on a miss. */
+static struct UsbHostRequest *OsRequestPoolGet(struct UsbAdapterRequestPool *pool, int32_t cls)
+{
+    struct UsbHostRequest *request = NULL;
+
+    OsalMutexLock(&pool->lock);
+    if (!DListIsEmpty(&pool->freeList[cls])) {
+        request = DLIST_FIRST_ENTRY(&pool->freeList[cls], struct UsbHostRequest, list);
+        DListRemove(&request->list);
+        pool->freeCount[cls]--;
+        pool->stats.hits++;
+    } else {
+        pool->stats.misses++;
+    }
+    pool->outstanding++;
+    OsalMutexUnlock(&pool->lock);
+
+    return request;
+}
+
+/* Returns true if the pool kept the request, false if the caller must unmap it. */
+static bool OsRequestPoolPut(struct UsbAdapterRequestPool *pool, struct UsbHostRequest *request)
+{
+    int32_t cls = (request != NULL) ? OsRequestPoolClass((size_t)request->bufLen) : -1;
+    bool destroy = false;
+
+    OsalMutexLock(&pool->lock);
+    pool->outstanding--;
+    if ((request != NULL) && !pool->closed && (cls >= 0) &&
+        (pool->freeCount[cls] < USB_ADAPTER_REQ_POOL_CACHE_MAX)) {
+        DListInsertHead(&request->list, &pool->freeList[cls]);
+        pool->freeCount[cls]++;
+        pool->stats.recycled++;
+        OsalMutexUnlock(&pool->lock);
+        return true;
+    }
+    if (request != NULL) {
+        pool->stats.released++;
+    }
+    destroy = pool->closed && (pool->outstanding == 0);
+    OsalMutexUnlock(&pool->lock);
+
+    if (destroy) {
+        OsRequestPoolDestroy(pool);
+    }
+    return false;
+}
+
+static void OsRequestPoolClose(struct UsbAdapterRequestPool *pool)
+{
+    struct UsbHostRequest *request = NULL;
+    struct UsbHostRequest *tmp = NULL;
+    struct DListHead drain;
+    bool destroy = false;
+
+    DListHeadInit(&drain);
+    OsalMutexLock(&pool->lock);
+    pool->closed = true;
+    for (int32_t i = 0; i < USB_ADAPTER_REQ_POOL_CLASS_NUM; i++) {
+        DListMerge(&pool->freeList[i], &drain);
+        /* the cached requests are unmapped below */
+        pool->stats.released += pool->freeCount[i];
+        pool->freeCount[i] = 0;
+    }
+    HDF_LOGI("%s:%d request pool hits=%u misses=%u recycled=%u released=%u", __func__, __LINE__,
+        pool->stats.hits, pool->stats.misses, pool->stats.recycled, pool->stats.released);
+    destroy = (pool->outstanding == 0);
+    OsalMutexUnlock(&pool->lock);
+
+    DLIST_FOR_EACH_ENTRY_SAFE(request, tmp, &drain, struct UsbHostRequest, list) {
+        DListRemove(&request->list);
+        (void)OsRequestUnmap(request);
+    }
+    if (destroy) {
+        OsRequestPoolDestroy(pool);
+    }
+}
+
+static void OsRequestReset(struct UsbHostRequest *request, struct UsbAdapterRequestPool *pool, int32_t isoPackets,
+    size_t bufLen, size_t allocSize)
+{
+    void *bulkUrb = request->bulkUrb;
+    int32_t bulkUrbNum = request->bulkUrbNum;
+
+    (void)memset_s(request, sizeof(*request), 0, sizeof(*request));
+    request->numIsoPackets = isoPackets;
+    request->buffer = (unsigned char *)request + allocSize - bufLen;
+    request->bufLen = (int32_t)bufLen;
+    request->bulkUrb = bulkUrb;
+    request->bulkUrbNum = bulkUrbNum;
+    request->urbs = request->bulkUrb;
+    request->reqPool = pool;
+}
+
 static int32_t AdapterInit(const struct UsbSession *session)
 {
     return HDF_SUCCESS;
@@ -902,6 +1060,7 @@ static struct UsbDeviceHandle *AdapterOpenDevice(struct UsbSession *session, uin
         goto ERR;
     }
 
+    dev->privateData = OsRequestPoolCreate();
     OsalAtomicSet(&dev->refcnt, 1);
     /* add the new device to the device list on session */
     OsalMutexLock(&session->lock);
@@ -940,6 +1099,11 @@ static void AdapterCloseDevice(struct UsbDeviceHandle *handle)
     if (dev->descriptors) {
         RawUsbMemFree(dev->descriptors);
     }
+    if (dev->privateData) {
+        OsRequestPoolClose((struct UsbAdapterRequestPool *)dev->privateData);
+        dev->privateData = NULL;
+    }
+    RawConfigCacheDeinit(dev);
     RawUsbMemFree(dev);
 
     close(handle->fd);
@@ -1131,53 +1295,70 @@ static struct UsbHostRequest *AdapterAllocRequest(const struct UsbDeviceHandle *
     void *memBuf = NULL;
     size_t allocSize;
     struct UsbHostRequest *request = NULL;
+    struct UsbAdapterRequestPool *pool = NULL;
+    int32_t cls = -1;
+
     if (handle == NULL) {
         HDF_LOGE("%s:%d invalid param", __func__, __LINE__);
         return NULL;
     }
+
+    /* iso requests carry per-packet descriptors and are not worth caching */
+    if (handle->dev != NULL) {
+        pool = (struct UsbAdapterRequestPool *)handle->dev->privateData;
+    }
+    if ((pool != NULL) && (isoPackets == 0)) {
+        cls = OsRequestPoolClass(len);
+    }
+    if (cls >= 0) {
+        len = OsRequestPoolClassSize(cls);
+        request = OsRequestPoolGet(pool, cls);
+    } else {
+        pool = NULL;
+    }
     allocSize = sizeof(struct UsbHostRequest)
                 + (sizeof(struct UsbIsoPacketDesc) * (size_t)isoPackets)
                 + (sizeof(unsigned char) * len);
+    if (request != NULL) {
+        OsRequestReset(request, pool, isoPackets, len, allocSize);
+        return request;
+    }
 
-    memBuf = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, handle->fd, 0);
+    memBuf = mmap(NULL, allocSize, PROT_READ | PROT_WRITE, MAP_SHARED, handle->fd, 0);
     if (memBuf == MAP_FAILED) {
         HDF_LOGE("%s:%d mmap failed, errno=%d", __func__, __LINE__, errno);
+        if (pool != NULL) {
+            (void)OsRequestPoolPut(pool, NULL);
+        }
         return NULL;
     }
     request = (struct UsbHostRequest *)memBuf;
-    request->numIsoPackets = isoPackets;
-    request->buffer = (unsigned char *)request + allocSize - len;
-    request->bufLen = len;
     request->bulkUrb = RawUsbMemCalloc(sizeof(struct UsbAdapterUrb));
     if (request->bulkUrb == NULL) {
         HDF_LOGE("%s RawUsbMemAlloc fail", __func__);
+        (void)munmap(memBuf, allocSize);
+        if (pool != NULL) {
+            (void)OsRequestPoolPut(pool, NULL);
+        }
         return NULL;
     }
-    request->urbs = request->bulkUrb;
+    request->bulkUrbNum = 1;
+    OsRequestReset(request, pool, isoPackets, len, allocSize);
     return request;
 }
 
 static int32_t AdapterFreeRequest(struct UsbHostRequest *request)
 {
-    size_t allocSize;
     if (request == NULL) {
         HDF_LOGE("%s:%d invalid param", __func__, __LINE__);
         return HDF_ERR_INVALID_PARAM;
     }
-    allocSize = sizeof(struct UsbHostRequest)
-                + (sizeof(struct UsbIsoPacketDesc) * (size_t)(request->numIsoPackets))
-                + request->bufLen;
-    if (request->bulkUrb) {
-        RawUsbMemFree(request->bulkUrb);
-        request->bulkUrb = NULL;
-    }
-    request->urbs = NULL;
-    if (munmap((void *)request, allocSize) != 0) {
-        HDF_LOGE("%s:%d munmap failed, errno=%d", __func__, __LINE__, errno);
-        return HDF_ERR_IO;
+
+    if ((request->reqPool != NULL) && OsRequestPoolPut((struct UsbAdapterRequestPool *)request->reqPool, request)) {
+        return HDF_SUCCESS;
     }
 
-    return HDF_SUCCESS;
+    return OsRequestUnmap(request);
 }
 
 static int32_t AdapterSubmitRequest(struct UsbHostRequest *request)
@@ -1226,10 +1407,34 @@ static int32_t AdapterCancelRequest(struct UsbHostRequest * const request)
     return HDF_SUCCESS;
 }
 
+static int32_t OsUrbCompletion(struct UsbAdapterUrb *urb)
+{
+    struct UsbHostRequest *request = urb->userContext;
+    int32_t ret;
+
+    switch (request->requestType) {
+        case USB_REQUEST_TYPE_CONTROL:
+            ret = OsControlCompletion(request, urb);
+            break;
+        case USB_REQUEST_TYPE_ISOCHRONOUS:
+            ret = OsIsoCompletion(request, urb);
+            break;
+        case USB_REQUEST_TYPE_BULK:
+        case USB_REQUEST_TYPE_INTERRUPT:
+            ret = OsBulkCompletion(request, (const struct UsbAdapterUrb *)urb);
+            break;
+        default:
+            HDF_LOGE("%s:%d unrecognised requestType %u", __func__, __LINE__, request->requestType);
+            ret = HDF_FAILURE;
+            break;
+    }
+
+    return ret;
+}
+
 static int32_t AdapterUrbCompleteHandle(const struct UsbDeviceHandle *devHandle)
 {
     struct UsbAdapterUrb *urb = NULL;
-    struct UsbHostRequest *request = NULL;
     int32_t ret;
 
     if (devHandle == NULL) {
@@ -1250,26 +1455,36 @@ static int32_t AdapterUrbCompleteHandle(const struct UsbDeviceHandle *devHandle)
         return HDF_ERR_IO;
     }
 
-    request = urb->userContext;
+    return OsUrbCompletion(urb);
+}
 
-    switch (request->requestType) {
-        case USB_REQUEST_TYPE_CONTROL:
-            ret = OsControlCompletion(request, urb);
-            break;
-        case USB_REQUEST_TYPE_ISOCHRONOUS:
-            ret = OsIsoCompletion(request, urb);
-            break;
-        case USB_REQUEST_TYPE_BULK:
-        case USB_REQUEST_TYPE_INTERRUPT:
-            ret = OsBulkCompletion(request, (const struct UsbAdapterUrb *)urb);
-            break;
-        default:
-            HDF_LOGE("%s:%d unrecognised requestType %u", __func__, __LINE__, request->requestType);
-            ret = HDF_FAILURE;
-            break;
+/* Drain up to maxUrbs completed urbs without blocking, returns the number reaped. */
+static int32_t AdapterUrbCompleteBatch(const struct UsbDeviceHandle *devHandle, uint32_t maxUrbs)
+{
+    struct UsbAdapterUrb *urb = NULL;
+    int32_t count = 0;
+
+    if (devHandle == NULL) {
+        HDF_LOGE("%s:%d invalid parameter", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
     }
 
-    return ret;
+    while ((uint32_t)count < maxUrbs) {
+        if (ioctl(devHandle->fd, USBDEVFS_REAPURBNDELAY, &urb) < 0) {
+            if (errno == EAGAIN) {
+                break;
+            }
+            if (errno == ENODEV) {
+                return HDF_DEV_ERR_NO_DEVICE;
+            }
+            HDF_LOGE("%s:%d reap failed, errno=%d", __func__, __LINE__, errno);
+            return HDF_ERR_IO;
+        }
+        (void)OsUrbCompletion(urb);
+        count++;
+    }
+
+    return count;
 }
 
 static struct UsbOsAdapterOps g_usbAdapter = {
@@ -1290,6 +1505,7 @@ static struct UsbOsAdapterOps g_usbAdapter = {
     .submitRequest = AdapterSubmitRequest,
     .cancelRequest = AdapterCancelRequest,
     .urbCompleteHandle = AdapterUrbCompleteHandle,
+    .urbCompleteBatch = AdapterUrbCompleteBatch,
 };
 
 static void OsSignalHandler(int32_t signo)
@@ -1332,6 +1548,28 @@ int32_t UsbAdapterKillSignal(struct UsbDeviceHandle *devHandle, UsbRawTidType ti
     return HDF_SUCCESS;
 }
 
+int32_t UsbAdapterGetRequestPoolStats(const struct UsbDeviceHandle *handle,
+    struct UsbAdapterRequestPoolStats *stats)
+{
+    struct UsbAdapterRequestPool *pool = NULL;
+
+    if ((handle == NULL) || (handle->dev == NULL) || (stats == NULL)) {
+        HDF_LOGE("%s:%d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    pool = (struct UsbAdapterRequestPool *)handle->dev->privateData;
+    if (pool == NULL) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    OsalMutexLock(&pool->lock);
+    *stats = pool->stats;
+    OsalMutexUnlock(&pool->lock);
+
+    return HDF_SUCCESS;
+}
+
 int32_t AdapterAtomicInc(OsalAtomic *v)
 {
     return OsalAtomicInc(v);
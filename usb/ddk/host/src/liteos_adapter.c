@@ -261,6 +261,7 @@ static struct UsbDevice *OsAllocDevice(struct UsbSession *session, struct UsbDev
     dev->devHandle = handle;
 
     RawRequestListInit(dev);
+    RawConfigCacheInit(dev);
 
     handle->dev = dev;
     return dev;
@@ -1201,6 +1202,7 @@ static void AdapterCloseDevice(struct UsbDeviceHandle *handle)
         OsDevDestory(dev->privateData);
         dev->privateData = NULL;
     }
+    RawConfigCacheDeinit(dev);
     RawUsbMemFree(dev);
 
     OsalMutexDestroy(&handle->lock);
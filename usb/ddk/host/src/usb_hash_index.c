@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "usb_hash_index.h"
+#include "hdf_log.h"
+#include "securec.h"
+
+#define HDF_LOG_TAG USB_HASH_INDEX
+
+static inline uint32_t UsbHashIndexBucket(uint32_t key)
+{
+    /* keys are packed 8-bit ids, fold the high byte into the low bits */
+    return (key ^ (key >> 8) ^ (key >> 16)) & (USB_HASH_INDEX_BUCKETS - 1);
+}
+
+HDF_STATUS UsbHashIndexInit(struct UsbHashIndex *index)
+{
+    if (index == NULL) {
+        HDF_LOGE("%{public}s:%{public}d index is null", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    (void)memset_s(index->buckets, sizeof(index->buckets), 0, sizeof(index->buckets));
+    index->count = 0;
+    if (pthread_rwlock_init(&index->lock, NULL) != 0) {
+        HDF_LOGE("%{public}s:%{public}d pthread_rwlock_init failed", __func__, __LINE__);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+void UsbHashIndexDestroy(struct UsbHashIndex *index)
+{
+    if (index == NULL) {
+        return;
+    }
+
+    (void)memset_s(index->buckets, sizeof(index->buckets), 0, sizeof(index->buckets));
+    index->count = 0;
+    (void)pthread_rwlock_destroy(&index->lock);
+}
+
+void UsbHashIndexInsert(struct UsbHashIndex *index, struct UsbHashNode *node, uint32_t key)
+{
+    struct UsbHashNode **bucket = NULL;
+
+    if (index == NULL || node == NULL) {
+        return;
+    }
+
+    node->key = key;
+    (void)pthread_rwlock_wrlock(&index->lock);
+    bucket = &index->buckets[UsbHashIndexBucket(key)];
+    node->next = *bucket;
+    *bucket = node;
+    index->count++;
+    (void)pthread_rwlock_unlock(&index->lock);
+}
+
+bool UsbHashIndexRemove(struct UsbHashIndex *index, struct UsbHashNode *node)
+{
+    struct UsbHashNode **link = NULL;
+    bool found = false;
+
+    if (index == NULL || node == NULL) {
+        return false;
+    }
+
+    (void)pthread_rwlock_wrlock(&index->lock);
+    for (link = &index->buckets[UsbHashIndexBucket(node->key)]; *link != NULL; link = &(*link)->next) {
+        if (*link == node) {
+            *link = node->next;
+            node->next = NULL;
+            index->count--;
+            found = true;
+            break;
+        }
+    }
+    (void)pthread_rwlock_unlock(&index->lock);
+    return found;
+}
+
+struct UsbHashNode *UsbHashIndexFindLocked(const struct UsbHashIndex *index, uint32_t key,
+    UsbHashIndexMatch match, const void *arg)
+{
+    struct UsbHashNode *node = NULL;
+
+    for (node = index->buckets[UsbHashIndexBucket(key)]; node != NULL; node = node->next) {
+        if (node->key == key && (match == NULL || match(node, arg))) {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+struct UsbHashNode *UsbHashIndexFind(struct UsbHashIndex *index, uint32_t key,
+    UsbHashIndexMatch match, const void *arg)
+{
+    struct UsbHashNode *node = NULL;
+
+    if (index == NULL) {
+        return NULL;
+    }
+
+    (void)pthread_rwlock_rdlock(&index->lock);
+    node = UsbHashIndexFindLocked(index, key, match, arg);
+    (void)pthread_rwlock_unlock(&index->lock);
+    return node;
+}
+
+uint32_t UsbHashIndexCount(struct UsbHashIndex *index)
+{
+    uint32_t count;
+
+    if (index == NULL) {
+        return 0;
+    }
+
+    (void)pthread_rwlock_rdlock(&index->lock);
+    count = index->count;
+    (void)pthread_rwlock_unlock(&index->lock);
+    return count;
+}
+
+void UsbHashIndexReadLock(struct UsbHashIndex *index)
+{
+    (void)pthread_rwlock_rdlock(&index->lock);
+}
+
+void UsbHashIndexReadUnlock(struct UsbHashIndex *index)
+{
+    (void)pthread_rwlock_unlock(&index->lock);
+}
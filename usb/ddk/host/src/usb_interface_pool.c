@@ -16,6 +16,7 @@
 #include "usb_interface_pool.h"
 #include "linux_adapter.h"
 #include "usb_io_manage.h"
+#include "usb_io_reactor.h"
 #include "usb_protocol.h"
 
 #define HDF_LOG_TAG USB_INTERFACE_POOL
@@ -69,6 +70,10 @@ static HDF_STATUS IfDestroyPipeObj(const struct UsbSdkInterface *interfaceObj, c
         if (destroyFlag || (!destroyFlag && pipePos->object.objectId == pipeObj->object.objectId)) {
             found = true;
             DListRemove(&pipePos->object.entry);
+            if (pipePos->info.pipeId <= USB_MAXENDPOINTS &&
+                interfaceObj->pipeTable[pipePos->info.pipeId] == pipePos) {
+                ((struct UsbSdkInterface *)interfaceObj)->pipeTable[pipePos->info.pipeId] = NULL;
+            }
             ret = IfFreePipeObj(pipePos);
             if (ret != HDF_SUCCESS) {
                 HDF_LOGE("%{public}s:%{public}d IfFreePipeObj failed, ret = %d ", __func__, __LINE__, ret);
@@ -125,6 +130,10 @@ static HDF_STATUS IfFreeInterfaceObj(struct UsbSdkInterface *interfaceObj)
 
 static HDF_STATUS IfInterfacePoolInit(struct UsbInterfacePool *interfacePool, uint8_t busNum, uint8_t devAddr)
 {
+    if (UsbHashIndexInit(&interfacePool->interfaceIndex) != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s:%{public}d UsbHashIndexInit failed", __func__, __LINE__);
+        return HDF_FAILURE;
+    }
     interfacePool->session = NULL;
     OsalMutexInit(&interfacePool->mutex);
     DListHeadInit(&interfacePool->interfaceList);
@@ -167,6 +176,7 @@ static HDF_STATUS IfFreeInterfacePool(struct UsbInterfacePool *interfacePool)
         return ret;
     }
     OsalMutexDestroy(&interfacePool->interfaceLock);
+    UsbHashIndexDestroy(&interfacePool->interfaceIndex);
     interfacePool->busNum = 0;
     interfacePool->devAddr = 0;
 
@@ -250,6 +260,12 @@ static struct UsbPipe *IfFindPipeObj(const struct UsbSdkInterface *interfaceObj,
         return NULL;
     }
 
+    /* transfers look pipes up by id, served from the table without taking listLock */
+    if (queryPara.type == USB_PIPE_INDEX_TYPE && queryPara.pipeId <= USB_MAXENDPOINTS &&
+        interfaceObj->pipeTable[queryPara.pipeId] != NULL) {
+        return interfaceObj->pipeTable[queryPara.pipeId];
+    }
+
     OsalMutexLock((struct OsalMutex *)&interfaceObj->listLock);
     DLIST_FOR_EACH_ENTRY_SAFE(pipePos, pipeTemp, &interfaceObj->pipeList, struct UsbPipe, object.entry) {
         switch (queryPara.type) {
@@ -280,46 +296,49 @@ static struct UsbPipe *IfFindPipeObj(const struct UsbSdkInterface *interfaceObj,
     return pipePos;
 }
 
+static bool IfInterfaceObjMatch(const struct UsbHashNode *node, const void *arg)
+{
+    const struct UsbSdkInterface *interfaceObj = USB_HASH_INDEX_ENTRY(node, struct UsbSdkInterface, hashNode);
+    const struct UsbInterfaceQueryPara *queryPara = (const struct UsbInterfaceQueryPara *)arg;
+
+    switch (queryPara->type) {
+        case USB_INTERFACE_INTERFACE_INDEX_TYPE:
+            return interfaceObj->interface.info.curAltSetting == interfaceObj->altSettingId;
+        case USB_INTERFACE_ALT_SETTINGS_TYPE:
+            return interfaceObj->altSettingId == queryPara->altSettingId;
+        default:
+            return false;
+    }
+}
+
 static struct UsbSdkInterface *IfFindInterfaceObj(const struct UsbInterfacePool *interfacePool,
     struct UsbInterfaceQueryPara queryPara, bool refCountFlag, bool *claimFlag, bool statusFlag)
 {
+    struct UsbInterfacePool *pool = (struct UsbInterfacePool *)interfacePool;
     struct UsbSdkInterface *interfacePos = NULL;
-    struct UsbSdkInterface *interfaceTemp = NULL;
-    bool found = false;
+    struct UsbHashNode *node = NULL;
 
     if (interfacePool == NULL || DListIsEmpty(&interfacePool->interfaceList)) {
         HDF_LOGE("%{public}s:%{public}d interfacePool is null or interface list is empty", __func__, __LINE__);
         return NULL;
     }
 
-    OsalMutexLock((struct OsalMutex *)&interfacePool->interfaceLock);
-    DLIST_FOR_EACH_ENTRY_SAFE(interfacePos, interfaceTemp, &interfacePool->interfaceList, \
-        struct UsbSdkInterface, interface.object.entry) {
-        switch (queryPara.type) {
-            case USB_INTERFACE_INTERFACE_INDEX_TYPE:
-                if ((interfacePos->interface.info.interfaceIndex == queryPara.interfaceIndex)
-                && (interfacePos->interface.info.curAltSetting == interfacePos->altSettingId)) {
-                    found = true;
-                }
-                break;
-            case USB_INTERFACE_ALT_SETTINGS_TYPE:
-                if ((interfacePos->interface.info.interfaceIndex == queryPara.interfaceIndex)
-                && (interfacePos->altSettingId == queryPara.altSettingId)) {
-                    found = true;
-                }
-                break;
-            default:
-                break;
-        }
-
-        if (found) {
-            IfInterfaceRefCount(interfacePos, queryPara.interfaceIndex, refCountFlag, claimFlag);
-            break;
-        }
+    /* claims keep interfaceLock so the refCount check and increment stay atomic */
+    if (refCountFlag) {
+        OsalMutexLock(&pool->interfaceLock);
+    }
+    UsbHashIndexReadLock(&pool->interfaceIndex);
+    node = UsbHashIndexFindLocked(&pool->interfaceIndex, queryPara.interfaceIndex, IfInterfaceObjMatch, &queryPara);
+    if (node != NULL) {
+        interfacePos = USB_HASH_INDEX_ENTRY(node, struct UsbSdkInterface, hashNode);
+        IfInterfaceRefCount(interfacePos, queryPara.interfaceIndex, refCountFlag, claimFlag);
+    }
+    UsbHashIndexReadUnlock(&pool->interfaceIndex);
+    if (refCountFlag) {
+        OsalMutexUnlock(&pool->interfaceLock);
     }
-    OsalMutexUnlock((struct OsalMutex *)&interfacePool->interfaceLock);
 
-    if (!found) {
+    if (interfacePos == NULL) {
         HDF_LOGE("%{public}s:%{public}d the interface object to be find does not exist", __func__, __LINE__);
         return NULL;
     }
@@ -723,6 +742,31 @@ int32_t UsbIfCreatPipeObj(const struct UsbSdkInterface *interfaceObj, struct Usb
     return HDF_SUCCESS;
 }
 
+int32_t UsbIfAddPipeIndex(struct UsbSdkInterface *interfaceObj, struct UsbPipe *pipeObj)
+{
+    if (interfaceObj == NULL || pipeObj == NULL || pipeObj->info.pipeId > USB_MAXENDPOINTS) {
+        HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    OsalMutexLock(&interfaceObj->listLock);
+    interfaceObj->pipeTable[pipeObj->info.pipeId] = pipeObj;
+    OsalMutexUnlock(&interfaceObj->listLock);
+    return HDF_SUCCESS;
+}
+
+int32_t UsbIfAddInterfaceIndex(const struct UsbInterfacePool *interfacePool, struct UsbSdkInterface *interfaceObj)
+{
+    if (interfacePool == NULL || interfaceObj == NULL) {
+        HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    UsbHashIndexInsert((struct UsbHashIndex *)&interfacePool->interfaceIndex, &interfaceObj->hashNode,
+        interfaceObj->interface.info.interfaceIndex);
+    return HDF_SUCCESS;
+}
+
 int32_t UsbIfCreatInterfaceObj(const struct UsbInterfacePool *interfacePool, struct UsbSdkInterface **interfaceObj)
 {
     struct UsbSdkInterface *interfaceObjTemp = NULL;
@@ -789,6 +833,7 @@ HDF_STATUS UsbIfDestroyInterfaceObj(const struct UsbInterfacePool *interfacePool
             interfacePos->interface.object.objectId == interfaceObj->interface.object.objectId)) {
             found = true;
             DListRemove(&interfacePos->interface.object.entry);
+            (void)UsbHashIndexRemove((struct UsbHashIndex *)&interfacePool->interfaceIndex, &interfacePos->hashNode);
             ret = IfFreeInterfaceObj(interfacePos);
             if (ret != HDF_SUCCESS) {
                 HDF_LOGE("%{public}s:%{public}d IfFreeInterfaceObj failed, ret = %d", __func__, __LINE__, ret);
@@ -854,7 +899,12 @@ int32_t UsbInitHostSdk(struct UsbSession **session)
 
 int32_t UsbExitHostSdk(const struct UsbSession *session)
 {
-    return RawExit(session);
+    int32_t ret = RawExit(session);
+    /* join the reactor thread once no device of any session is left on it */
+    if (UsbIoReactorStop() == HDF_ERR_DEVICE_BUSY) {
+        HDF_LOGI("%{public}s:%{public}d reactor still in use", __func__, __LINE__);
+    }
+    return ret;
 }
 
 struct UsbInterface *UsbClaimInterfaceUnforce(
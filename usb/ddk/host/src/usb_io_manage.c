@@ -14,6 +14,7 @@
  */
 
 #include "usb_io_manage.h"
+#include "usb_io_reactor.h"
 #include "usb_raw_api_library.h"
 
 #define HDF_LOG_TAG USB_IO_MANAGE
@@ -279,6 +280,12 @@ HDF_STATUS UsbIoStart(struct UsbInterfacePool *interfacePool)
         goto ERR_DESTROY_SEND;
     }
 
+    /* reap completions on the shared reactor, fall back to a receive thread per pool */
+    interfacePool->ioReactor = (UsbIoReactorRegister(interfacePool) == HDF_SUCCESS);
+    if (interfacePool->ioReactor) {
+        return HDF_SUCCESS;
+    }
+
     /* creat IoAsyncReceiveProcess thread */
     (void)memset_s(&threadCfg, sizeof(threadCfg), 0, sizeof(threadCfg));
     threadCfg.name = "usb io async receive process";
@@ -319,6 +326,27 @@ HDF_STATUS UsbIoStop(struct UsbInterfacePool *interfacePool)
         HDF_LOGE("%s:%d param is NULL", __func__, __LINE__);
         return HDF_ERR_INVALID_PARAM;
     }
+    if (interfacePool->ioReactor) {
+        OsalMutexLock(&interfacePool->ioStopLock);
+        interfacePool->ioProcessStopStatus = USB_POOL_PROCESS_STOP;
+        OsalSemPost(&interfacePool->submitRequestQueue.sem);
+        OsalMutexUnlock(&interfacePool->ioStopLock);
+
+        (void)UsbIoReactorUnregister(interfacePool);
+        interfacePool->ioReactor = false;
+
+        OsalMutexLock(&interfacePool->ioStopLock);
+        interfacePool->ioProcessStopStatus = USB_POOL_PROCESS_STOPED;
+        OsalMutexUnlock(&interfacePool->ioStopLock);
+
+        ret = OsalThreadDestroy(&interfacePool->ioSendProcess);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s:%d OsalThreadDestroy faile, ret=%d ", __func__, __LINE__, ret);
+        }
+        OsalMutexDestroy(&interfacePool->ioStopLock);
+        return ret;
+    }
+
     if ((interfacePool->ioProcessStopStatus != USB_POOL_PROCESS_STOPED)) {
         OsalMutexLock(&interfacePool->ioStopLock);
         interfacePool->ioProcessStopStatus = USB_POOL_PROCESS_STOP;
@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "usb_io_reactor.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "linux_adapter.h"
+#include "usb_io_manage.h"
+#include "usb_raw_api_library.h"
+
+#define HDF_LOG_TAG USB_IO_REACTOR
+
+/* An interface pool reaping through the entry of its device. */
+struct UsbIoReactorPool {
+    struct DListHead node;
+    struct UsbInterfacePool *interfacePool;
+};
+
+/*
+ * All interface pools of a device share its usbfs fd, which epoll accepts only once. The entry is
+ * added on the first pool and removed with the last. A reaped urb runs the callback of its own
+ * request, so the completions reach the pool that submitted them without sorting here.
+ */
+struct UsbIoReactorEntry {
+    struct DListHead node;
+    struct DListHead poolList;
+    uint32_t refCount;
+    struct UsbDeviceHandle *devHandle;
+    /* removed from epoll, no more dispatches */
+    bool dead;
+    /* unregistered from a completion callback, freed by the dispatcher */
+    bool release;
+};
+
+/* One reactor per process reaps completions for every opened interface pool. */
+struct UsbIoReactor {
+    struct OsalMutex lock;
+    struct DListHead entryList;
+    struct OsalThread thread;
+    UsbRawTidType tid;
+    int32_t epollFd;
+    /* wakes the thread up to stop, polled with a NULL entry */
+    int32_t stopFd;
+    bool started;
+    bool stopping;
+    bool exited;
+    struct UsbIoReactorEntry *dispatching;
+    /* the number of finished dispatches */
+    uint64_t dispatched;
+    struct UsbIoReactorStats stats;
+};
+
+static struct UsbIoReactor g_usbIoReactor = {
+    .epollFd = -1,
+    .stopFd = -1,
+};
+static pthread_once_t g_usbIoReactorOnce = PTHREAD_ONCE_INIT;
+
+static void UsbIoReactorInitOnce(void)
+{
+    OsalMutexInit(&g_usbIoReactor.lock);
+    DListHeadInit(&g_usbIoReactor.entryList);
+}
+
+static bool UsbIoReactorEntryValid(const struct UsbIoReactorEntry *entry)
+{
+    struct UsbIoReactorEntry *pos = NULL;
+
+    DLIST_FOR_EACH_ENTRY(pos, &g_usbIoReactor.entryList, struct UsbIoReactorEntry, node) {
+        if (pos == entry) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static struct UsbIoReactorEntry *UsbIoReactorFindEntry(const struct UsbDeviceHandle *devHandle)
+{
+    struct UsbIoReactorEntry *pos = NULL;
+
+    DLIST_FOR_EACH_ENTRY(pos, &g_usbIoReactor.entryList, struct UsbIoReactorEntry, node) {
+        if (pos->devHandle == devHandle) {
+            return pos;
+        }
+    }
+
+    return NULL;
+}
+
+static struct UsbIoReactorPool *UsbIoReactorFindPool(const struct UsbIoReactorEntry *entry,
+    const struct UsbInterfacePool *interfacePool)
+{
+    struct UsbIoReactorPool *pos = NULL;
+
+    DLIST_FOR_EACH_ENTRY(pos, &entry->poolList, struct UsbIoReactorPool, node) {
+        if (pos->interfacePool == interfacePool) {
+            return pos;
+        }
+    }
+
+    return NULL;
+}
+
+/* Called with the reactor lock held, mirrors the exit path of IoAsyncReceiveProcess for each pool of the device. */
+static void UsbIoReactorEntryStop(struct UsbIoReactorEntry *entry)
+{
+    struct UsbIoReactorPool *pos = NULL;
+    struct UsbInterfacePool *interfacePool = NULL;
+
+    entry->dead = true;
+    (void)epoll_ctl(g_usbIoReactor.epollFd, EPOLL_CTL_DEL, entry->devHandle->fd, NULL);
+
+    DLIST_FOR_EACH_ENTRY(pos, &entry->poolList, struct UsbIoReactorPool, node) {
+        interfacePool = pos->interfacePool;
+        OsalMutexLock(&interfacePool->ioStopLock);
+        interfacePool->ioProcessStopStatus = USB_POOL_PROCESS_STOPED;
+        OsalSemPost(&interfacePool->submitRequestQueue.sem);
+        OsalMutexUnlock(&interfacePool->ioStopLock);
+    }
+}
+
+static void UsbIoReactorDispatch(struct UsbIoReactorEntry *entry, uint32_t events)
+{
+    int32_t ret;
+
+    OsalMutexLock(&g_usbIoReactor.lock);
+    /* the entry may have been unregistered after epoll_wait returned */
+    if (!UsbIoReactorEntryValid(entry) || entry->dead) {
+        OsalMutexUnlock(&g_usbIoReactor.lock);
+        return;
+    }
+    g_usbIoReactor.dispatching = entry;
+    OsalMutexUnlock(&g_usbIoReactor.lock);
+
+    ret = RawHandleRequestBatch(entry->devHandle, USB_IO_REACTOR_REAP_BATCH);
+
+    OsalMutexLock(&g_usbIoReactor.lock);
+    g_usbIoReactor.dispatching = NULL;
+    g_usbIoReactor.dispatched++;
+    if (entry->release) {
+        OsalMutexUnlock(&g_usbIoReactor.lock);
+        RawUsbMemFree(entry);
+        return;
+    }
+    if (ret > 0) {
+        g_usbIoReactor.stats.completions += (uint64_t)ret;
+    } else if ((ret < 0) || (events & (EPOLLERR | EPOLLHUP))) {
+        HDF_LOGE("%s:%d device gone, ret=%d events=0x%x", __func__, __LINE__, ret, events);
+        UsbIoReactorEntryStop(entry);
+    }
+    OsalMutexUnlock(&g_usbIoReactor.lock);
+}
+
+static int32_t UsbIoReactorProcess(const void *arg)
+{
+    struct epoll_event events[USB_IO_REACTOR_MAX_EVENTS];
+    int32_t num;
+    int32_t i;
+
+    (void)arg;
+    g_usbIoReactor.tid = RawGetTid();
+    while (true) {
+        num = epoll_wait(g_usbIoReactor.epollFd, events, USB_IO_REACTOR_MAX_EVENTS, -1);
+        if (num < 0) {
+            if (errno != EINTR) {
+                HDF_LOGE("%s:%d epoll_wait failed, errno=%d", __func__, __LINE__, errno);
+                OsalMSleep(USB_IO_SLEEP_MS_TIME);
+            }
+            continue;
+        }
+
+        OsalMutexLock(&g_usbIoReactor.lock);
+        if (g_usbIoReactor.stopping) {
+            g_usbIoReactor.exited = true;
+            OsalMutexUnlock(&g_usbIoReactor.lock);
+            break;
+        }
+        g_usbIoReactor.stats.wakeups++;
+        OsalMutexUnlock(&g_usbIoReactor.lock);
+
+        for (i = 0; i < num; i++) {
+            /* the stop fd, never read, so it keeps waking the thread until it exits */
+            if (events[i].data.ptr == NULL) {
+                continue;
+            }
+            UsbIoReactorDispatch((struct UsbIoReactorEntry *)events[i].data.ptr, events[i].events);
+        }
+    }
+
+    return HDF_SUCCESS;
+}
+
+static void UsbIoReactorCloseFds(void)
+{
+    if (g_usbIoReactor.stopFd >= 0) {
+        close(g_usbIoReactor.stopFd);
+        g_usbIoReactor.stopFd = -1;
+    }
+    if (g_usbIoReactor.epollFd >= 0) {
+        close(g_usbIoReactor.epollFd);
+        g_usbIoReactor.epollFd = -1;
+    }
+}
+
+/* Called with the reactor lock held. The reactor thread runs until UsbIoReactorStop. */
+static HDF_STATUS UsbIoReactorStart(void)
+{
+    HDF_STATUS ret;
+    struct OsalThreadParam threadCfg;
+    struct epoll_event event;
+
+    if (g_usbIoReactor.started) {
+        /* a stopping reactor takes no new devices, the pool falls back to its own receive thread */
+        return g_usbIoReactor.stopping ? HDF_ERR_DEVICE_BUSY : HDF_SUCCESS;
+    }
+
+    g_usbIoReactor.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (g_usbIoReactor.epollFd < 0) {
+        HDF_LOGE("%s:%d epoll_create1 failed, errno=%d", __func__, __LINE__, errno);
+        return HDF_ERR_IO;
+    }
+
+    g_usbIoReactor.stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (g_usbIoReactor.stopFd < 0) {
+        HDF_LOGE("%s:%d eventfd failed, errno=%d", __func__, __LINE__, errno);
+        ret = HDF_ERR_IO;
+        goto ERR_CLOSE;
+    }
+    (void)memset_s(&event, sizeof(event), 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if (epoll_ctl(g_usbIoReactor.epollFd, EPOLL_CTL_ADD, g_usbIoReactor.stopFd, &event) < 0) {
+        HDF_LOGE("%s:%d epoll_ctl failed, errno=%d", __func__, __LINE__, errno);
+        ret = HDF_ERR_IO;
+        goto ERR_CLOSE;
+    }
+    g_usbIoReactor.stopping = false;
+    g_usbIoReactor.exited = false;
+
+    (void)memset_s(&threadCfg, sizeof(threadCfg), 0, sizeof(threadCfg));
+    threadCfg.name = "usb io reactor";
+    threadCfg.priority = OSAL_THREAD_PRI_DEFAULT;
+    threadCfg.stackSize = USB_IO_REACTOR_STACK_SIZE;
+
+    ret = OsalThreadCreate(&g_usbIoReactor.thread, (OsalThreadEntry)UsbIoReactorProcess, NULL);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s:%d OsalThreadCreate faile, ret=%d ", __func__, __LINE__, ret);
+        goto ERR_CLOSE;
+    }
+
+    ret = OsalThreadStart(&g_usbIoReactor.thread, &threadCfg);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s:%d OsalThreadStart faile, ret=%d ", __func__, __LINE__, ret);
+        OsalThreadDestroy(&g_usbIoReactor.thread);
+        goto ERR_CLOSE;
+    }
+
+    g_usbIoReactor.started = true;
+    g_usbIoReactor.stats.threads = 1;
+    return HDF_SUCCESS;
+
+ERR_CLOSE:
+    UsbIoReactorCloseFds();
+    return ret;
+}
+
+/* Called with the reactor lock held. */
+static struct UsbIoReactorEntry *UsbIoReactorAddEntry(struct UsbDeviceHandle *devHandle)
+{
+    struct UsbIoReactorEntry *entry = NULL;
+    struct epoll_event event;
+
+    entry = RawUsbMemCalloc(sizeof(*entry));
+    if (entry == NULL) {
+        HDF_LOGE("%s:%d RawUsbMemCalloc failed", __func__, __LINE__);
+        return NULL;
+    }
+    DListHeadInit(&entry->poolList);
+    entry->devHandle = devHandle;
+
+    /* usbfs reports POLLOUT while reaped urbs are pending */
+    (void)memset_s(&event, sizeof(event), 0, sizeof(event));
+    event.events = EPOLLOUT;
+    event.data.ptr = entry;
+    if (epoll_ctl(g_usbIoReactor.epollFd, EPOLL_CTL_ADD, devHandle->fd, &event) < 0) {
+        HDF_LOGE("%s:%d epoll_ctl failed, errno=%d", __func__, __LINE__, errno);
+        RawUsbMemFree(entry);
+        return NULL;
+    }
+    DListInsertTail(&entry->node, &g_usbIoReactor.entryList);
+    g_usbIoReactor.stats.devices++;
+
+    return entry;
+}
+
+HDF_STATUS UsbIoReactorRegister(struct UsbInterfacePool *interfacePool)
+{
+    struct UsbIoReactorEntry *entry = NULL;
+    struct UsbIoReactorPool *pool = NULL;
+    HDF_STATUS ret;
+
+    if ((interfacePool == NULL) || (interfacePool->device == NULL) ||
+        (interfacePool->device->devHandle == NULL)) {
+        HDF_LOGE("%s:%d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    if (UsbAdapterGetOps()->urbCompleteBatch == NULL) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    pool = RawUsbMemCalloc(sizeof(*pool));
+    if (pool == NULL) {
+        HDF_LOGE("%s:%d RawUsbMemCalloc failed", __func__, __LINE__);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    pool->interfacePool = interfacePool;
+
+    pthread_once(&g_usbIoReactorOnce, UsbIoReactorInitOnce);
+    OsalMutexLock(&g_usbIoReactor.lock);
+    ret = UsbIoReactorStart();
+    if (ret != HDF_SUCCESS) {
+        goto ERR;
+    }
+
+    entry = UsbIoReactorFindEntry(interfacePool->device->devHandle);
+    if (entry == NULL) {
+        entry = UsbIoReactorAddEntry(interfacePool->device->devHandle);
+        if (entry == NULL) {
+            ret = HDF_ERR_IO;
+            goto ERR;
+        }
+    } else if (entry->dead) {
+        /* the device is gone, the entry waits for its last pool to leave */
+        ret = HDF_DEV_ERR_NO_DEVICE;
+        goto ERR;
+    }
+    DListInsertTail(&pool->node, &entry->poolList);
+    entry->refCount++;
+    g_usbIoReactor.stats.pools++;
+    OsalMutexUnlock(&g_usbIoReactor.lock);
+
+    return HDF_SUCCESS;
+
+ERR:
+    OsalMutexUnlock(&g_usbIoReactor.lock);
+    RawUsbMemFree(pool);
+    return ret;
+}
+
+HDF_STATUS UsbIoReactorUnregister(struct UsbInterfacePool *interfacePool)
+{
+    struct UsbIoReactorEntry *entry = NULL;
+    struct UsbIoReactorPool *pool = NULL;
+    uint64_t dispatched;
+    bool lastPool = false;
+
+    if ((interfacePool == NULL) || (interfacePool->device == NULL)) {
+        HDF_LOGE("%s:%d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    pthread_once(&g_usbIoReactorOnce, UsbIoReactorInitOnce);
+    OsalMutexLock(&g_usbIoReactor.lock);
+    entry = UsbIoReactorFindEntry(interfacePool->device->devHandle);
+    pool = (entry != NULL) ? UsbIoReactorFindPool(entry, interfacePool) : NULL;
+    if (pool == NULL) {
+        OsalMutexUnlock(&g_usbIoReactor.lock);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    DListRemove(&pool->node);
+    RawUsbMemFree(pool);
+    entry->refCount--;
+    g_usbIoReactor.stats.pools--;
+    g_usbIoReactor.stats.releases++;
+    /* the other pools of the device keep reaping on the fd */
+    lastPool = (entry->refCount == 0);
+    if (lastPool) {
+        if (!entry->dead) {
+            entry->dead = true;
+            (void)epoll_ctl(g_usbIoReactor.epollFd, EPOLL_CTL_DEL, entry->devHandle->fd, NULL);
+        }
+        DListRemove(&entry->node);
+        g_usbIoReactor.stats.devices--;
+    }
+
+    if (g_usbIoReactor.dispatching == entry) {
+        /* closed from a completion callback, the dispatcher frees the entry when it returns */
+        if (RawGetTid() == g_usbIoReactor.tid) {
+            entry->release = lastPool;
+            OsalMutexUnlock(&g_usbIoReactor.lock);
+            return HDF_SUCCESS;
+        }
+        /* the batch in flight may still complete requests of this pool, later ones cannot */
+        dispatched = g_usbIoReactor.dispatched;
+        while ((g_usbIoReactor.dispatching == entry) && (g_usbIoReactor.dispatched == dispatched)) {
+            OsalMutexUnlock(&g_usbIoReactor.lock);
+            OsalMSleep(USB_IO_REACTOR_WAIT_MS);
+            OsalMutexLock(&g_usbIoReactor.lock);
+        }
+    }
+    OsalMutexUnlock(&g_usbIoReactor.lock);
+    if (lastPool) {
+        RawUsbMemFree(entry);
+    }
+
+    return HDF_SUCCESS;
+}
+
+HDF_STATUS UsbIoReactorGetStats(struct UsbIoReactorStats *stats)
+{
+    if (stats == NULL) {
+        HDF_LOGE("%s:%d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    pthread_once(&g_usbIoReactorOnce, UsbIoReactorInitOnce);
+    OsalMutexLock(&g_usbIoReactor.lock);
+    *stats = g_usbIoReactor.stats;
+    OsalMutexUnlock(&g_usbIoReactor.lock);
+
+    return HDF_SUCCESS;
+}
+
+HDF_STATUS UsbIoReactorStop(void)
+{
+    uint64_t one = 1;
+
+    pthread_once(&g_usbIoReactorOnce, UsbIoReactorInitOnce);
+    OsalMutexLock(&g_usbIoReactor.lock);
+    if (!g_usbIoReactor.started || g_usbIoReactor.stopping) {
+        OsalMutexUnlock(&g_usbIoReactor.lock);
+        return HDF_SUCCESS;
+    }
+    /* a device is still open, or the reactor thread would wait for itself */
+    if (!DListIsEmpty(&g_usbIoReactor.entryList) || (RawGetTid() == g_usbIoReactor.tid)) {
+        OsalMutexUnlock(&g_usbIoReactor.lock);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    g_usbIoReactor.stopping = true;
+    if (write(g_usbIoReactor.stopFd, &one, sizeof(one)) != (ssize_t)sizeof(one)) {
+        HDF_LOGE("%s:%d write stop fd failed, errno=%d", __func__, __LINE__, errno);
+    }
+
+    /* no entry is left to dispatch, so the thread leaves on its next wakeup */
+    while (!g_usbIoReactor.exited) {
+        OsalMutexUnlock(&g_usbIoReactor.lock);
+        OsalMSleep(USB_IO_REACTOR_WAIT_MS);
+        OsalMutexLock(&g_usbIoReactor.lock);
+    }
+
+    (void)OsalThreadDestroy(&g_usbIoReactor.thread);
+    UsbIoReactorCloseFds();
+    g_usbIoReactor.started = false;
+    g_usbIoReactor.stopping = false;
+    g_usbIoReactor.tid = 0;
+    g_usbIoReactor.stats.threads = 0;
+    OsalMutexUnlock(&g_usbIoReactor.lock);
+
+    return HDF_SUCCESS;
+}
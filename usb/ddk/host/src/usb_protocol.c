@@ -82,8 +82,9 @@ static int32_t CreateCtrPipe(const struct UsbInterfacePool *pool)
     pipe->info.pipeAddress = 0;
     pipe->info.pipeDirection = USB_PIPE_DIRECTION_OUT;
     pipe->info.pipeType = USB_PIPE_TYPE_CONTROL;
+    (void)UsbIfAddPipeIndex(interfaceObj, pipe);
 
-    return ret;
+    return UsbIfAddInterfaceIndex(pool, interfaceObj);
 }
 
 static int32_t UsbInterfaceInit(struct UsbSdkInterface *interfaceObj,
@@ -195,6 +196,10 @@ static int32_t UsbProtocalCreatePipeObj(
         if (ret != HDF_SUCCESS) {
             break;
         }
+        ret = UsbIfAddPipeIndex((struct UsbSdkInterface *)interfaceObj, pipe);
+        if (ret != HDF_SUCCESS) {
+            break;
+        }
     }
 
     return ret;
@@ -238,6 +243,11 @@ static int32_t UsbProtocalCreatInterfaceObj(const struct UsbRawConfigDescriptor
             if (ret != HDF_SUCCESS) {
                 goto ERROR;
             }
+
+            ret = UsbIfAddInterfaceIndex(interfacePool, interfaceObj);
+            if (ret != HDF_SUCCESS) {
+                goto ERROR;
+            }
         }
     }
 
@@ -288,8 +298,7 @@ int32_t UsbProtocalParseDescriptor(struct UsbDeviceHandle *devHandle, uint8_t bu
 
 FREE_CONFIG:
     if (config != NULL) {
-        RawClearConfiguration(config);
-        RawUsbMemFree(config);
+        RawFreeConfigDescriptor(config);
         config = NULL;
     }
 
@@ -97,8 +97,7 @@ void UsbRawFreeConfigDescriptor(const struct UsbRawConfigDescriptor *config)
         return;
     }
 
-    RawClearConfiguration((struct UsbRawConfigDescriptor *)config);
-    RawUsbMemFree((void *)config);
+    RawFreeConfigDescriptor(config);
 }
 
 int32_t UsbRawGetConfiguration(const UsbRawHandle *devHandle, int32_t *config)
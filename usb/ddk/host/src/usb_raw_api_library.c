@@ -18,9 +18,27 @@
 
 #define HDF_LOG_TAG USB_RAW_API_LIBRARY
 
+#define RAW_CONFIG_TREE_ALIGN(len)  (((size_t)(len) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+#define RAW_CONFIG_TREE_ENTRY(config) CONTAINER_OF(config, struct UsbRawConfigTree, config)
+#define RAW_USB_RAM_TEST_BUCKETS    64
+
+/*
+ * A parsed configuration packed into a single allocation: this header, then
+ * the interfaces, their altsettings, endpoints and extra descriptor bytes.
+ * It is never modified after creation, so every RawGetConfigDescriptor caller
+ * for the same configuration shares it and only the reference count changes.
+ */
+struct UsbRawConfigTree {
+    uint32_t refCount;
+    uint8_t configIndex;
+    struct UsbRawConfigDescriptor config;
+};
+
 struct UsbSession *g_usbRawDefaultSession = NULL;
+/* allocation records hashed by address, only kept while the memory test is on */
 static struct RawUsbRamTestList *g_usbRamTestHead = NULL;
 static bool g_usbRamTestFlag = false;
+static uint64_t g_usbRamTestTotal = 0;
 
 static void SyncRequestCallback(const void *requestArg)
 {
@@ -66,6 +84,7 @@ static int32_t HandleSyncRequestCompletion(const struct UsbHostRequest *request,
 
     switch (request->status) {
         case USB_REQUEST_COMPLETED:
+        case USB_REQUEST_COMPLETED_SHORT:
             ret = HDF_SUCCESS;
             break;
         case USB_REQUEST_TIMEOUT:
@@ -1110,7 +1129,7 @@ int32_t RawFreeRequest(const struct UsbHostRequest *request)
     return FreeRequest(request);
 }
 
-int32_t RawGetConfigDescriptor(const struct UsbDevice *dev, uint8_t configIndex,
+static int32_t RawParseConfigDescriptor(const struct UsbDevice *dev, uint8_t configIndex,
     struct UsbRawConfigDescriptor **config)
 {
     int32_t ret;
@@ -1118,16 +1137,6 @@ int32_t RawGetConfigDescriptor(const struct UsbDevice *dev, uint8_t configIndex,
     uint16_t configLen;
     uint8_t *buf = NULL;
 
-    if (dev == NULL) {
-        HDF_LOGE("%s: invalid param", __func__);
-        return HDF_ERR_INVALID_PARAM;
-    }
-
-    if (configIndex > dev->deviceDescriptor.bNumConfigurations) {
-        HDF_LOGE("%s:%d invalid param", __func__, __LINE__);
-        return HDF_ERR_BAD_FD;
-    }
-
     ret = GetConfigDescriptor(dev, configIndex, tmpConfig.buf, sizeof(tmpConfig.buf));
     if (ret < HDF_SUCCESS) {
         HDF_LOGE("%s:%d ret=%d", __func__, __LINE__, ret);
@@ -1151,6 +1160,254 @@ int32_t RawGetConfigDescriptor(const struct UsbDevice *dev, uint8_t configIndex,
     return ret;
 }
 
+static size_t RawConfigTreeSize(const struct UsbRawConfigDescriptor *config)
+{
+    const struct UsbRawInterface *usbInterface = NULL;
+    const struct UsbRawInterfaceDescriptor *ifp = NULL;
+    size_t size;
+    uint8_t i, j, k;
+
+    size = RAW_CONFIG_TREE_ALIGN(sizeof(struct UsbRawConfigTree)) + RAW_CONFIG_TREE_ALIGN(config->extraLength);
+    for (i = 0; i < config->configDescriptor.bNumInterfaces; i++) {
+        usbInterface = config->interface[i];
+        if (usbInterface == NULL) {
+            continue;
+        }
+        size += RAW_CONFIG_TREE_ALIGN(sizeof(struct UsbRawInterface) +
+            usbInterface->numAltsetting * sizeof(struct UsbRawInterfaceDescriptor));
+        for (j = 0; j < usbInterface->numAltsetting; j++) {
+            ifp = &usbInterface->altsetting[j];
+            size += RAW_CONFIG_TREE_ALIGN(ifp->extraLength);
+            if (ifp->endPoint == NULL) {
+                continue;
+            }
+            size += RAW_CONFIG_TREE_ALIGN(ifp->interfaceDescriptor.bNumEndpoints * sizeof(*ifp->endPoint));
+            for (k = 0; k < ifp->interfaceDescriptor.bNumEndpoints; k++) {
+                size += RAW_CONFIG_TREE_ALIGN(ifp->endPoint[k].extraLength);
+            }
+        }
+    }
+
+    return size;
+}
+
+static void *RawConfigTreeCopy(uint8_t **cursor, const void *src, size_t len)
+{
+    void *dest = *cursor;
+
+    if (src == NULL || len == 0) {
+        return NULL;
+    }
+    /* the tree was sized with RawConfigTreeSize, the copy cannot run past it */
+    (void)memcpy_s(dest, len, src, len);
+    *cursor += RAW_CONFIG_TREE_ALIGN(len);
+    return dest;
+}
+
+static void RawConfigTreeCopyInterface(uint8_t **cursor, const struct UsbRawInterface *src,
+    const struct UsbRawInterface **dest)
+{
+    struct UsbRawInterface *usbInterface = NULL;
+    struct UsbRawInterfaceDescriptor *ifp = NULL;
+    struct UsbRawEndpointDescriptor *endPoint = NULL;
+    uint8_t j, k;
+
+    usbInterface = RawConfigTreeCopy(cursor, src,
+        sizeof(struct UsbRawInterface) + src->numAltsetting * sizeof(struct UsbRawInterfaceDescriptor));
+    *dest = usbInterface;
+    for (j = 0; j < usbInterface->numAltsetting; j++) {
+        ifp = (struct UsbRawInterfaceDescriptor *)&usbInterface->altsetting[j];
+        ifp->extra = RawConfigTreeCopy(cursor, src->altsetting[j].extra, ifp->extraLength);
+        if (ifp->endPoint == NULL) {
+            continue;
+        }
+        endPoint = RawConfigTreeCopy(cursor, src->altsetting[j].endPoint,
+            ifp->interfaceDescriptor.bNumEndpoints * sizeof(*endPoint));
+        ifp->endPoint = endPoint;
+        for (k = 0; (endPoint != NULL) && (k < ifp->interfaceDescriptor.bNumEndpoints); k++) {
+            endPoint[k].extra = RawConfigTreeCopy(cursor, src->altsetting[j].endPoint[k].extra,
+                endPoint[k].extraLength);
+        }
+    }
+}
+
+/* pack a parsed configuration into one block, the block starts with the tree header */
+static struct UsbRawConfigTree *RawConfigTreeCreate(const struct UsbRawConfigDescriptor *config, uint8_t configIndex)
+{
+    struct UsbRawConfigTree *tree = NULL;
+    uint8_t *cursor = NULL;
+    size_t size = RawConfigTreeSize(config);
+    uint8_t i;
+
+    tree = RawUsbMemCalloc(size);
+    if (tree == NULL) {
+        HDF_LOGE("%s:%d RawUsbMemCalloc failed", __func__, __LINE__);
+        return NULL;
+    }
+    tree->refCount = 1;
+    tree->configIndex = configIndex;
+    tree->config = *config;
+
+    cursor = (uint8_t *)tree + RAW_CONFIG_TREE_ALIGN(sizeof(struct UsbRawConfigTree));
+    tree->config.extra = RawConfigTreeCopy(&cursor, config->extra, config->extraLength);
+    for (i = 0; i < config->configDescriptor.bNumInterfaces; i++) {
+        if (config->interface[i] != NULL) {
+            RawConfigTreeCopyInterface(&cursor, config->interface[i], &tree->config.interface[i]);
+        }
+    }
+
+    return tree;
+}
+
+static void RawConfigTreePut(struct UsbRawConfigTree *tree)
+{
+    if (__atomic_sub_fetch(&tree->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        RawUsbMemFree(tree);
+    }
+}
+
+static struct UsbRawConfigTree *RawConfigCacheFind(struct UsbDevice *dev, uint8_t configIndex)
+{
+    struct UsbRawConfigTree *tree = NULL;
+    uint8_t i;
+
+    OsalMutexLock(&dev->configCacheLock);
+    for (i = 0; i < USB_RAW_CONFIG_CACHE_MAX; i++) {
+        if (dev->configCache[i] != NULL && dev->configCache[i]->configIndex == configIndex) {
+            tree = dev->configCache[i];
+            __atomic_add_fetch(&tree->refCount, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    OsalMutexUnlock(&dev->configCacheLock);
+
+    return tree;
+}
+
+/* returns the tree the caller should use, which is an earlier one if another caller raced ahead */
+static struct UsbRawConfigTree *RawConfigCacheAdd(struct UsbDevice *dev, struct UsbRawConfigTree *tree)
+{
+    struct UsbRawConfigTree *cached = NULL;
+    int32_t slot = -1;
+    uint8_t i;
+
+    OsalMutexLock(&dev->configCacheLock);
+    for (i = 0; i < USB_RAW_CONFIG_CACHE_MAX; i++) {
+        if (dev->configCache[i] == NULL) {
+            slot = (slot < 0) ? i : slot;
+        } else if (dev->configCache[i]->configIndex == tree->configIndex) {
+            cached = dev->configCache[i];
+            __atomic_add_fetch(&cached->refCount, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    if (cached == NULL && slot >= 0) {
+        __atomic_add_fetch(&tree->refCount, 1, __ATOMIC_RELAXED);
+        dev->configCache[slot] = tree;
+    }
+    OsalMutexUnlock(&dev->configCacheLock);
+
+    if (cached != NULL) {
+        RawConfigTreePut(tree);
+        return cached;
+    }
+    return tree;
+}
+
+int32_t RawGetConfigDescriptor(const struct UsbDevice *dev, uint8_t configIndex,
+    struct UsbRawConfigDescriptor **config)
+{
+    int32_t ret;
+    struct UsbRawConfigDescriptor *parsed = NULL;
+    struct UsbRawConfigTree *tree = NULL;
+
+    if (dev == NULL || config == NULL) {
+        HDF_LOGE("%s: invalid param", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    if (configIndex > dev->deviceDescriptor.bNumConfigurations) {
+        HDF_LOGE("%s:%d invalid param", __func__, __LINE__);
+        return HDF_ERR_BAD_FD;
+    }
+
+    tree = RawConfigCacheFind((struct UsbDevice *)dev, configIndex);
+    if (tree != NULL) {
+        *config = &tree->config;
+        return HDF_SUCCESS;
+    }
+
+    ret = RawParseConfigDescriptor(dev, configIndex, &parsed);
+    if (ret < HDF_SUCCESS) {
+        return ret;
+    }
+    tree = RawConfigTreeCreate(parsed, configIndex);
+    RawClearConfiguration(parsed);
+    RawUsbMemFree(parsed);
+    if (tree == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+
+    tree = RawConfigCacheAdd((struct UsbDevice *)dev, tree);
+    *config = &tree->config;
+    return HDF_SUCCESS;
+}
+
+void RawFreeConfigDescriptor(const struct UsbRawConfigDescriptor *config)
+{
+    if (config == NULL) {
+        HDF_LOGE("%s:%d config is NULL", __func__, __LINE__);
+        return;
+    }
+
+    RawConfigTreePut(RAW_CONFIG_TREE_ENTRY(config));
+}
+
+void RawConfigCacheInit(struct UsbDevice *dev)
+{
+    if (dev == NULL) {
+        HDF_LOGE("%s:%d dev is NULL", __func__, __LINE__);
+        return;
+    }
+
+    OsalMutexInit(&dev->configCacheLock);
+    (void)memset_s(dev->configCache, sizeof(dev->configCache), 0, sizeof(dev->configCache));
+}
+
+/* trees already handed out stay valid until their holders free them */
+void RawConfigCacheInvalidate(struct UsbDevice *dev)
+{
+    struct UsbRawConfigTree *trees[USB_RAW_CONFIG_CACHE_MAX] = {NULL};
+    uint8_t i;
+
+    if (dev == NULL) {
+        return;
+    }
+
+    OsalMutexLock(&dev->configCacheLock);
+    for (i = 0; i < USB_RAW_CONFIG_CACHE_MAX; i++) {
+        trees[i] = dev->configCache[i];
+        dev->configCache[i] = NULL;
+    }
+    OsalMutexUnlock(&dev->configCacheLock);
+
+    for (i = 0; i < USB_RAW_CONFIG_CACHE_MAX; i++) {
+        if (trees[i] != NULL) {
+            RawConfigTreePut(trees[i]);
+        }
+    }
+}
+
+void RawConfigCacheDeinit(struct UsbDevice *dev)
+{
+    if (dev == NULL) {
+        return;
+    }
+
+    RawConfigCacheInvalidate(dev);
+    OsalMutexDestroy(&dev->configCacheLock);
+}
+
 void RawClearConfiguration(struct UsbRawConfigDescriptor *config)
 {
     uint8_t i;
@@ -1194,6 +1451,7 @@ int32_t RawGetConfiguration(const struct UsbDeviceHandle *devHandle, int32_t *co
 
 int32_t RawSetConfiguration(const struct UsbDeviceHandle *devHandle, int32_t configuration)
 {
+    int32_t ret;
     struct UsbOsAdapterOps *osAdapterOps = UsbAdapterGetOps();
 
     if (configuration < -1 || configuration > (int)0xFF) {
@@ -1204,7 +1462,11 @@ int32_t RawSetConfiguration(const struct UsbDeviceHandle *devHandle, int32_t con
         return HDF_ERR_NOT_SUPPORT;
     }
 
-    return osAdapterOps->setConfiguration((struct UsbDeviceHandle *)devHandle, configuration);
+    ret = osAdapterOps->setConfiguration((struct UsbDeviceHandle *)devHandle, configuration);
+    if (ret == HDF_SUCCESS && devHandle != NULL) {
+        RawConfigCacheInvalidate(devHandle->dev);
+    }
+    return ret;
 }
 
 int32_t RawGetDescriptor(const struct UsbHostRequest *request, const struct UsbDeviceHandle *devHandle,
@@ -1285,13 +1547,18 @@ OUT:
 
 int32_t RawResetDevice(const struct UsbDeviceHandle *devHandle)
 {
+    int32_t ret;
     struct UsbOsAdapterOps *osAdapterOps = UsbAdapterGetOps();
 
     if (!osAdapterOps->resetDevice) {
         return HDF_ERR_NOT_SUPPORT;
     }
 
-    return osAdapterOps->resetDevice(devHandle);
+    ret = osAdapterOps->resetDevice(devHandle);
+    if (ret == HDF_SUCCESS && devHandle != NULL) {
+        RawConfigCacheInvalidate(devHandle->dev);
+    }
+    return ret;
 }
 
 int32_t RawSubmitRequest(const struct UsbHostRequest *request)
@@ -1344,6 +1611,23 @@ int32_t RawHandleRequest(const struct UsbDeviceHandle *devHandle)
     return ret;
 }
 
+int32_t RawHandleRequestBatch(const struct UsbDeviceHandle *devHandle, uint32_t maxUrbs)
+{
+    struct UsbOsAdapterOps *osAdapterOps = UsbAdapterGetOps();
+    int32_t ret;
+
+    if (!osAdapterOps->urbCompleteBatch) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    ret = osAdapterOps->urbCompleteBatch(devHandle, maxUrbs);
+    if (ret < 0) {
+        HDF_LOGE("%s:%d handleEvents error, return %d", __func__, __LINE__, ret);
+    }
+
+    return ret;
+}
+
 int32_t RawClearHalt(const struct UsbDeviceHandle *devHandle, uint8_t pipeAddress)
 {
     struct UsbOsAdapterOps *osAdapterOps = UsbAdapterGetOps();
@@ -1470,8 +1754,28 @@ void RawRequestListInit(struct UsbDevice *deviceObj)
 }
 
 
+static inline struct RawUsbRamTestList *RawUsbRamTestBucket(const void *mem)
+{
+    uintptr_t address = (uintptr_t)mem;
+    return &g_usbRamTestHead[((address >> 4) ^ (address >> 12)) & (RAW_USB_RAM_TEST_BUCKETS - 1)];
+}
+
 int32_t RawUsbMemTestTrigger(bool enable)
 {
+    uint32_t i;
+
+    /* the record table lives for the rest of the process once the test was enabled */
+    if (enable && g_usbRamTestHead == NULL) {
+        g_usbRamTestHead = OsalMemCalloc(RAW_USB_RAM_TEST_BUCKETS * sizeof(struct RawUsbRamTestList));
+        if (g_usbRamTestHead == NULL) {
+            HDF_LOGE("%s:%d OsalMemCalloc failed", __func__, __LINE__);
+            return HDF_ERR_MALLOC_FAIL;
+        }
+        for (i = 0; i < RAW_USB_RAM_TEST_BUCKETS; i++) {
+            OsalMutexInit(&g_usbRamTestHead[i].lock);
+            DListHeadInit(&g_usbRamTestHead[i].list);
+        }
+    }
     g_usbRamTestFlag = enable;
     return HDF_SUCCESS;
 }
@@ -1485,15 +1789,15 @@ void *RawUsbMemCalloc(size_t size)
 {
     void *buf = NULL;
     struct RawUsbRamTestList *testEntry = NULL;
-    struct RawUsbRamTestList *pos = NULL;
-    uint32_t totalSize = 0;
+    struct RawUsbRamTestList *bucket = NULL;
+    uint64_t totalSize;
     int32_t ret = 0;
 
     if (size == 0) {
         HDF_LOGE("%s:%d size is 0", __func__, __LINE__);
         return NULL;
     }
-    
+
     buf = OsalMemAlloc(size);
     if (buf == NULL) {
         HDF_LOGE("%{public}s: %{public}d, OsalMemAlloc failed", __func__, __LINE__);
@@ -1505,12 +1809,7 @@ void *RawUsbMemCalloc(size_t size)
         OsalMemFree(buf);
         return NULL;
     }
-    if (g_usbRamTestFlag) {
-        if (g_usbRamTestHead == NULL) {
-            g_usbRamTestHead = OsalMemAlloc(sizeof(struct RawUsbRamTestList));
-            OsalMutexInit(&g_usbRamTestHead->lock);
-            DListHeadInit(&g_usbRamTestHead->list);
-        }
+    if (g_usbRamTestFlag && g_usbRamTestHead != NULL) {
         testEntry = OsalMemAlloc(sizeof(struct RawUsbRamTestList));
         if (testEntry == NULL) {
             HDF_LOGE("%s:%d testEntry is NULL", __func__, __LINE__);
@@ -1519,14 +1818,14 @@ void *RawUsbMemCalloc(size_t size)
         testEntry->address = (uintptr_t)buf;
         testEntry->size = size;
 
-        OsalMutexLock(&g_usbRamTestHead->lock);
-        DListInsertTail(&testEntry->list, &g_usbRamTestHead->list);
-        DLIST_FOR_EACH_ENTRY(pos, &g_usbRamTestHead->list, struct RawUsbRamTestList, list) {
-            totalSize += pos->size;
-        }
-        OsalMutexUnlock(&g_usbRamTestHead->lock);
+        bucket = RawUsbRamTestBucket(buf);
+        OsalMutexLock(&bucket->lock);
+        DListInsertTail(&testEntry->list, &bucket->list);
+        OsalMutexUnlock(&bucket->lock);
+        totalSize = __atomic_add_fetch(&g_usbRamTestTotal, size, __ATOMIC_RELAXED);
 
-        HDF_LOGE("%{public}s add size=%{public}d totalSize=%{public}d", __func__, (uint32_t)size, totalSize);
+        HDF_LOGE("%{public}s add size=%{public}d totalSize=%{public}llu", __func__, (uint32_t)size,
+            (unsigned long long)totalSize);
     }
     return buf;
 }
@@ -1535,7 +1834,8 @@ void RawUsbMemFree(void *mem)
 {
     struct RawUsbRamTestList *pos = NULL;
     struct RawUsbRamTestList *tmp = NULL;
-    uint32_t totalSize = 0;
+    struct RawUsbRamTestList *bucket = NULL;
+    uint64_t totalSize;
     uint32_t size = 0;
 
     if (mem == NULL) {
@@ -1544,22 +1844,21 @@ void RawUsbMemFree(void *mem)
     }
 
     if (g_usbRamTestFlag && g_usbRamTestHead != NULL) {
-        OsalMutexLock(&g_usbRamTestHead->lock);
-        DLIST_FOR_EACH_ENTRY_SAFE(pos, tmp, &g_usbRamTestHead->list, struct RawUsbRamTestList, list) {
+        bucket = RawUsbRamTestBucket(mem);
+        OsalMutexLock(&bucket->lock);
+        DLIST_FOR_EACH_ENTRY_SAFE(pos, tmp, &bucket->list, struct RawUsbRamTestList, list) {
             if (pos->address == (uintptr_t)mem) {
                 size = pos->size;
                 DListRemove(&pos->list);
                 OsalMemFree(pos);
-                continue;
+                break;
             }
-            totalSize += pos->size;
         }
-        OsalMutexUnlock(&g_usbRamTestHead->lock);
-        HDF_LOGE("%{public}s rm size=%{public}d totalSize=%{public}d", __func__, size, totalSize);
+        OsalMutexUnlock(&bucket->lock);
+        totalSize = __atomic_sub_fetch(&g_usbRamTestTotal, size, __ATOMIC_RELAXED);
+        HDF_LOGE("%{public}s rm size=%{public}d totalSize=%{public}llu", __func__, size,
+            (unsigned long long)totalSize);
     }
 
-    if (mem != NULL) {
-        OsalMemFree(mem);
-    }
+    OsalMemFree(mem);
 }
-
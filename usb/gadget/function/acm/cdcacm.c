@@ -31,6 +31,8 @@
 #define PENDING_FLAG            0
 #define CTRL_REQUEST_NUM        2
 #define QUEUE_SIZE              8
+#define QUEUE_SIZE_MAX          USB_THROUGHPUT_INFLIGHT_MAX
+#define REQUEST_SIZE_MAX        65536
 #define WRITE_BUF_SIZE          8192
 #define READ_BUF_SIZE           8192
 
@@ -54,24 +56,31 @@ static int32_t UsbSerialStartTx(struct UsbSerial *port)
     while (!port->writeBusy && !DListIsEmpty(pool)) {
         struct UsbFnRequest *req = NULL;
         uint32_t len;
-        if (port->writeStarted >= QUEUE_SIZE) {
+        if (port->writeStarted >= (int32_t)port->queueDepth) {
             break;
         }
         req = DLIST_FIRST_ENTRY(pool, struct UsbFnRequest, list);
         if (req == NULL) {
             break;
         }
-        len = DataFifoRead(&port->writeFifo, req->buf, port->acm->dataInPipe.maxPacketSize);
+        /* the throughput profile resends the request buffer as is */
+        if (port->throughput & USB_SERIAL_THROUGHPUT_TX) {
+            len = port->reqSize;
+        } else {
+            len = DataFifoRead(&port->writeFifo, req->buf, port->reqSize);
+        }
         if (len == 0) {
             break;
         }
         req->length = len;
         DListRemove(&req->list);
         port->writeBusy = true;
+        UsbThroughputSubmit(&port->writeStats);
         ret = UsbFnSubmitRequestAsync(req);
         port->writeBusy = false;
         if (ret != HDF_SUCCESS) {
             HDF_LOGD("%s: send request erro %d", __func__, ret);
+            UsbThroughputCancel(&port->writeStats);
             DListInsertTail(&req->list, pool);
             break;
         }
@@ -87,21 +96,22 @@ static int32_t UsbSerialStartTx(struct UsbSerial *port)
 static uint32_t UsbSerialStartRx(struct UsbSerial *port)
 {
     struct DListHead *pool = &port->readPool;
-    struct UsbAcmPipe *out = &port->acm->dataOutPipe;
     while (!DListIsEmpty(pool)) {
         struct UsbFnRequest *req = NULL;
         int32_t ret;
 
-        if (port->readStarted >= QUEUE_SIZE) {
+        if (port->readStarted >= (int32_t)port->queueDepth) {
             break;
         }
 
         req = DLIST_FIRST_ENTRY(pool, struct UsbFnRequest, list);
         DListRemove(&req->list);
-        req->length = out->maxPacketSize;
+        req->length = port->reqSize;
+        UsbThroughputSubmit(&port->readStats);
         ret = UsbFnSubmitRequestAsync(req);
         if (ret != HDF_SUCCESS) {
             HDF_LOGD("%s: send request erro %d", __func__, ret);
+            UsbThroughputCancel(&port->readStats);
             DListInsertTail(&req->list, pool);
             break;
         }
@@ -134,7 +144,7 @@ static void UsbSerialRxPush(struct UsbSerial *port)
                 break;
         }
 
-        if (g_inFifo && req->actual) {
+        if (g_inFifo && !(port->throughput & USB_SERIAL_THROUGHPUT_RX) && req->actual) {
             uint32_t size = req->actual;
             uint8_t *data = req->buf;
             uint32_t count;
@@ -188,6 +198,7 @@ static void UsbSerialReadComplete(uint8_t pipe, struct UsbFnRequest *req)
         }
     }
     OsalMutexLock(&port->lock);
+    UsbThroughputComplete(&port->readStats, req->actual, req->status == USB_REQUEST_COMPLETED);
     DListInsertTail(&req->list, &port->readQueue);
     UsbSerialRxPush(port);
     OsalMutexUnlock(&port->lock);
@@ -292,6 +303,7 @@ static void UsbSerialWriteComplete(uint8_t pipe, struct UsbFnRequest *req)
     struct UsbSerial *port = (struct UsbSerial *)req->context;
 
     OsalMutexLock(&port->lock);
+    UsbThroughputComplete(&port->writeStats, req->actual, req->status == USB_REQUEST_COMPLETED);
     DListInsertTail(&req->list, &port->writePool);
     port->writeStarted--;
 
@@ -317,8 +329,7 @@ static int32_t UsbSerialAllocReadRequests(struct UsbSerial *port, int32_t num)
     int32_t  i;
 
     for (i = 0; i < num; i++) {
-        req = UsbFnAllocRequest(acm->dataIface.handle, acm->dataOutPipe.id,
-            acm->dataOutPipe.maxPacketSize);
+        req = UsbFnAllocRequest(acm->dataIface.handle, acm->dataOutPipe.id, port->reqSize);
         if (!req) {
             return DListIsEmpty(head) ? HDF_FAILURE : HDF_SUCCESS;
         }
@@ -339,8 +350,7 @@ static int32_t UsbSerialAllocWriteRequests(struct UsbSerial *port, int32_t num)
     int32_t i;
 
     for (i = 0; i < num; i++) {
-        req = UsbFnAllocRequest(acm->dataIface.handle, acm->dataInPipe.id,
-            acm->dataInPipe.maxPacketSize);
+        req = UsbFnAllocRequest(acm->dataIface.handle, acm->dataInPipe.id, port->reqSize);
         if (!req) {
             return DListIsEmpty(head) ? HDF_FAILURE : HDF_SUCCESS;
         }
@@ -361,13 +371,13 @@ static int32_t UsbSerialStartIo(struct UsbSerial *port)
 
     /* allocate requests for read/write */
     if (port->readAllocated == 0) {
-        ret = UsbSerialAllocReadRequests(port, QUEUE_SIZE);
+        ret = UsbSerialAllocReadRequests(port, port->queueDepth);
         if (ret != HDF_SUCCESS) {
             return ret;
         }
     }
     if (port->writeAllocated == 0) {
-        ret = UsbSerialAllocWriteRequests(port, QUEUE_SIZE);
+        ret = UsbSerialAllocWriteRequests(port, port->queueDepth);
         if (ret != HDF_SUCCESS) {
             UsbSerialFreeRequests(head, &port->readAllocated);
             return ret;
@@ -622,6 +632,63 @@ static int32_t UsbSerialSpeed(struct UsbSerial *port)
     return HDF_SUCCESS;
 }
 
+static int32_t UsbSerialThroughputStart(struct UsbSerial *port, struct HdfSBuf *data)
+{
+    uint32_t direction;
+
+    if (!HdfSbufReadUint32(data, &direction)) {
+        HDF_LOGE("%s: sbuf read direction failed", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    direction &= USB_SERIAL_THROUGHPUT_RX | USB_SERIAL_THROUGHPUT_TX;
+
+    OsalMutexLock(&port->lock);
+    if (port->readAllocated == 0 || port->writeAllocated == 0) {
+        HDF_LOGE("%s: usb serial is not open", __func__);
+        OsalMutexUnlock(&port->lock);
+        return HDF_ERR_IO;
+    }
+    port->throughput = direction;
+    UsbThroughputReset(&port->readStats);
+    UsbThroughputReset(&port->writeStats);
+    /* keep every request of the profiled directions queued */
+    if (port->acm) {
+        UsbSerialStartRx(port);
+        UsbSerialStartTx(port);
+    }
+    OsalMutexUnlock(&port->lock);
+    return HDF_SUCCESS;
+}
+
+static int32_t UsbSerialThroughputStop(struct UsbSerial *port)
+{
+    OsalMutexLock(&port->lock);
+    port->throughput = 0;
+    OsalMutexUnlock(&port->lock);
+    return HDF_SUCCESS;
+}
+
+static int32_t UsbSerialGetStats(struct UsbSerial *port, struct HdfSBuf *reply)
+{
+    int32_t ret;
+
+    OsalMutexLock(&port->lock);
+    if (!HdfSbufWriteUint32(reply, port->queueDepth) || !HdfSbufWriteUint32(reply, port->reqSize)) {
+        OsalMutexUnlock(&port->lock);
+        HDF_LOGE("%s: sbuf write config failed", __func__);
+        return HDF_ERR_IO;
+    }
+    ret = UsbThroughputWriteReply(&port->readStats, reply);
+    if (ret == HDF_SUCCESS) {
+        ret = UsbThroughputWriteReply(&port->writeStats, reply);
+    }
+    OsalMutexUnlock(&port->lock);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: sbuf write stats failed", __func__);
+    }
+    return ret;
+}
+
 static int32_t UsbSerialRead(struct UsbSerial *port, struct HdfSBuf *reply)
 {
     uint32_t len, fifoLen;
@@ -862,6 +929,12 @@ static int32_t AcmSerialCmd(struct UsbAcmDevice *acm, int32_t cmd, struct UsbSer
             return UsbSerialReadSpeedDone(port);
         case USB_SERIAL_READ_GET_TEMP_SPEED_UINT32:
             return UsbSerialGetTempReadSpeedInt(port, reply);
+        case USB_SERIAL_THROUGHPUT_START:
+            return UsbSerialThroughputStart(port, data);
+        case USB_SERIAL_THROUGHPUT_STOP:
+            return UsbSerialThroughputStop(port);
+        case USB_SERIAL_GET_STATS:
+            return UsbSerialGetStats(port, reply);
         default:
             return HDF_ERR_NOT_SUPPORT;
     }
@@ -1506,6 +1579,31 @@ static int32_t UsbSerialAlloc(struct UsbAcmDevice *acm)
     return HDF_SUCCESS;
 }
 
+static void UsbSerialParseConfig(struct UsbAcmDevice *acm, struct DeviceResourceIface *iface)
+{
+    struct UsbSerial *port = acm->port;
+    uint32_t maxPacketSize = MAX(acm->dataInPipe.maxPacketSize, acm->dataOutPipe.maxPacketSize);
+
+    if (iface->GetUint32(acm->device->property, "queue_size", &port->queueDepth, QUEUE_SIZE) != HDF_SUCCESS) {
+        HDF_LOGI("%s: read queue_size failed, use default", __func__);
+    }
+    if (iface->GetUint32(acm->device->property, "request_size", &port->reqSize, maxPacketSize) != HDF_SUCCESS) {
+        HDF_LOGI("%s: read request_size failed, use default", __func__);
+    }
+
+    if (port->queueDepth == 0 || port->queueDepth > QUEUE_SIZE_MAX) {
+        HDF_LOGW("%s: queue_size %u out of range", __func__, port->queueDepth);
+        port->queueDepth = (port->queueDepth == 0) ? QUEUE_SIZE : QUEUE_SIZE_MAX;
+    }
+    if (maxPacketSize == 0) {
+        maxPacketSize = USB_MAX_PACKET_SIZE;
+    }
+    /* read requests must be a whole number of packets to avoid babble */
+    port->reqSize = MIN(MAX(port->reqSize, maxPacketSize), REQUEST_SIZE_MAX);
+    port->reqSize -= port->reqSize % maxPacketSize;
+    HDF_LOGI("%s: queue_size %u request_size %u", __func__, port->queueDepth, port->reqSize);
+}
+
 static void UsbSerialFree(struct UsbAcmDevice *acm)
 {
     struct UsbSerial *port = acm->port;
@@ -1579,6 +1677,7 @@ static int32_t UsbSerialInit(struct UsbAcmDevice *acm)
         HDF_LOGE("%s: UsbSerialAlloc failed", __func__);
         goto ERR;
     }
+    UsbSerialParseConfig(acm, iface);
 
     ret = AcmAllocCtrlRequests(acm, CTRL_REQUEST_NUM);
     if (ret != HDF_SUCCESS) {
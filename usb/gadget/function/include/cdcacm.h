@@ -24,6 +24,7 @@
 #include "usbfn_request.h"
 #include "usb_ddk.h"
 #include "usb_object.h"
+#include "usb_throughput_stats.h"
 
 #define USB_MAX_PACKET_SIZE     0x40
 
@@ -45,10 +46,17 @@ enum UsbSerialCmd {
     USB_SERIAL_READ_GET_TEMP_SPEED,
     USB_SERIAL_READ_SPEED_DONE,
     USB_SERIAL_READ_GET_TEMP_SPEED_UINT32,
+    USB_SERIAL_THROUGHPUT_START,
+    USB_SERIAL_THROUGHPUT_STOP,
+    USB_SERIAL_GET_STATS,
     USB_SERIAL_INIT = 100,
     USB_SERIAL_RELEASE = 101,
 };
 
+/* directions for USB_SERIAL_THROUGHPUT_START, as seen from the gadget */
+#define USB_SERIAL_THROUGHPUT_RX    (1 << 0)
+#define USB_SERIAL_THROUGHPUT_TX    (1 << 1)
+
 struct UsbSerial {
     struct UsbAcmDevice         *acm;
     struct UsbCdcLineCoding     lineCoding;
@@ -65,6 +73,13 @@ struct UsbSerial {
     struct DataFifo             writeFifo;
     bool                        writeBusy;
 
+    /* throughput profile, queue depth and request size come from HCS */
+    uint32_t                    queueDepth;
+    uint32_t                    reqSize;
+    uint32_t                    throughput;
+    struct UsbThroughputStats   readStats;
+    struct UsbThroughputStats   writeStats;
+
     bool                        suspended;
     bool                        startDelayed;
     int32_t                         refCount;
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HDF_USB_THROUGHPUT_STATS_H
+#define HDF_USB_THROUGHPUT_STATS_H
+
+#include "hdf_base.h"
+#include "hdf_sbuf.h"
+#include "osal_time.h"
+#include "securec.h"
+
+#define USB_THROUGHPUT_INFLIGHT_MAX     64
+#define USB_THROUGHPUT_LATENCY_BUCKETS  32
+#define USB_THROUGHPUT_US_PER_SEC       1000000
+#define USB_THROUGHPUT_BYTES_PER_MB     (1024 * 1024)
+#define USB_THROUGHPUT_PERCENT_MAX      100
+#define USB_THROUGHPUT_P50              50
+#define USB_THROUGHPUT_P90              90
+#define USB_THROUGHPUT_P99              99
+
+/*
+ * Throughput and latency counters of one bulk pipe. Requests on a pipe
+ * complete in submission order, so the submit timestamps are kept in a
+ * small ring and matched against completions oldest first. Latencies are
+ * collected in a log2 histogram of microseconds: bucket n holds samples
+ * in [2^n, 2^(n+1)), bucket 0 also holds 0.
+ */
+struct UsbThroughputStats {
+    uint64_t bytes;
+    uint64_t requests;
+    uint64_t errors;
+    uint64_t startUs;
+    uint64_t lastUs;
+    uint64_t submitUs[USB_THROUGHPUT_INFLIGHT_MAX];
+    uint32_t submitHead;
+    uint32_t submitTail;
+    uint32_t latency[USB_THROUGHPUT_LATENCY_BUCKETS];
+};
+
+static inline uint64_t UsbThroughputNowUs(void)
+{
+    OsalTimespec time = {0, 0};
+
+    (void)OsalGetTime(&time);
+    return time.sec * USB_THROUGHPUT_US_PER_SEC + time.usec;
+}
+
+/* restart the measurement window, requests in flight keep their submit time */
+static inline void UsbThroughputReset(struct UsbThroughputStats *stats)
+{
+    stats->bytes = 0;
+    stats->requests = 0;
+    stats->errors = 0;
+    stats->startUs = 0;
+    stats->lastUs = 0;
+    (void)memset_s(stats->latency, sizeof(stats->latency), 0, sizeof(stats->latency));
+}
+
+/* call right before a request is handed to the controller */
+static inline void UsbThroughputSubmit(struct UsbThroughputStats *stats)
+{
+    if (stats->submitHead - stats->submitTail >= USB_THROUGHPUT_INFLIGHT_MAX) {
+        return;
+    }
+    stats->submitUs[stats->submitHead % USB_THROUGHPUT_INFLIGHT_MAX] = UsbThroughputNowUs();
+    stats->submitHead++;
+}
+
+/* undo UsbThroughputSubmit when the submission itself failed */
+static inline void UsbThroughputCancel(struct UsbThroughputStats *stats)
+{
+    if (stats->submitHead != stats->submitTail) {
+        stats->submitHead--;
+    }
+}
+
+static inline uint32_t UsbThroughputBucket(uint64_t us)
+{
+    uint32_t bucket = 0;
+
+    while (us > 1 && bucket < USB_THROUGHPUT_LATENCY_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static inline void UsbThroughputComplete(struct UsbThroughputStats *stats, uint32_t actual, bool success)
+{
+    uint64_t now = UsbThroughputNowUs();
+
+    if (stats->submitHead != stats->submitTail) {
+        uint64_t submitUs = stats->submitUs[stats->submitTail % USB_THROUGHPUT_INFLIGHT_MAX];
+        stats->submitTail++;
+        if (success) {
+            stats->latency[UsbThroughputBucket(now - submitUs)]++;
+        }
+        if (stats->startUs == 0) {
+            stats->startUs = submitUs;
+        }
+    }
+    if (!success) {
+        stats->errors++;
+        return;
+    }
+    if (stats->startUs == 0) {
+        stats->startUs = now;
+    }
+    stats->bytes += actual;
+    stats->requests++;
+    stats->lastUs = now;
+}
+
+/* percentile latency in microseconds, interpolated inside its bucket */
+static inline uint32_t UsbThroughputPercentile(const struct UsbThroughputStats *stats, uint32_t percent)
+{
+    uint64_t total = 0;
+    uint64_t seen = 0;
+    uint64_t rank;
+    uint32_t i;
+
+    for (i = 0; i < USB_THROUGHPUT_LATENCY_BUCKETS; i++) {
+        total += stats->latency[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    rank = (total * percent + USB_THROUGHPUT_PERCENT_MAX - 1) / USB_THROUGHPUT_PERCENT_MAX;
+    for (i = 0; i < USB_THROUGHPUT_LATENCY_BUCKETS; i++) {
+        uint64_t low = (i == 0) ? 0 : (1ULL << i);
+        uint64_t high = 1ULL << (i + 1);
+        if (stats->latency[i] == 0 || seen + stats->latency[i] < rank) {
+            seen += stats->latency[i];
+            continue;
+        }
+        return (uint32_t)(low + (high - low) * (rank - seen) / stats->latency[i]);
+    }
+    return UINT32_MAX;
+}
+
+static inline float UsbThroughputMBps(const struct UsbThroughputStats *stats)
+{
+    uint64_t elapsed = stats->lastUs - stats->startUs;
+
+    if (stats->requests == 0 || elapsed == 0) {
+        return 0;
+    }
+    return (float)((double)stats->bytes * USB_THROUGHPUT_US_PER_SEC / USB_THROUGHPUT_BYTES_PER_MB / elapsed);
+}
+
+/*
+ * Stats reply layout: bytes, requests, errors and elapsed time in us as
+ * uint64, sustained MB/s as float, then p50/p90/p99 latency in us as uint32.
+ */
+static inline int32_t UsbThroughputWriteReply(const struct UsbThroughputStats *stats, struct HdfSBuf *reply)
+{
+    uint64_t elapsed = (stats->requests == 0) ? 0 : stats->lastUs - stats->startUs;
+
+    if (!HdfSbufWriteUint64(reply, stats->bytes) || !HdfSbufWriteUint64(reply, stats->requests) ||
+        !HdfSbufWriteUint64(reply, stats->errors) || !HdfSbufWriteUint64(reply, elapsed) ||
+        !HdfSbufWriteFloat(reply, UsbThroughputMBps(stats)) ||
+        !HdfSbufWriteUint32(reply, UsbThroughputPercentile(stats, USB_THROUGHPUT_P50)) ||
+        !HdfSbufWriteUint32(reply, UsbThroughputPercentile(stats, USB_THROUGHPUT_P90)) ||
+        !HdfSbufWriteUint32(reply, UsbThroughputPercentile(stats, USB_THROUGHPUT_P99))) {
+        return HDF_ERR_IO;
+    }
+    return HDF_SUCCESS;
+}
+
+#endif /* HDF_USB_THROUGHPUT_STATS_H */
@@ -38,6 +38,7 @@
 
 #include "usb_param.h"
 #include "usbd_subscriber.h"
+#include "usbd_type.h"
 
 namespace OHOS {
 namespace USB {
@@ -445,6 +446,68 @@ public:
      */
     int32_t BulkCancel(const UsbDev &dev, const UsbPipe &pipe);
 
+    /* *
+     * @brief Sets the request size and the number of requests kept in flight for asynchronous and streaming bulk
+     * transfer on a pipe. Must be called while no transfer is running on the pipe.
+     *
+     * @param dev Indicates the USB device address.
+     * @param pipe Indicates the pipe of the USB device.
+     * @param requestSize Indicates the size of each request, up to USBD_BULK_STREAM_REQ_SIZE_MAX bytes.
+     * @param queueDepth Indicates the number of requests in flight, up to USBD_BULK_STREAM_DEPTH_MAX.
+     *
+     * @return Returns <b>0</b> if the operation is successful; returns a non-0 value if the operation fails.
+     * @since 3.0
+     */
+    int32_t BulkStreamConfig(const UsbDev &dev, const UsbPipe &pipe, uint32_t requestSize, uint32_t queueDepth);
+
+    /* *
+     * @brief Starts streaming reads into a ring buffer ashmem laid out as described by UsbdBulkStreamHeader.
+     * Reads continue until the stream is cancelled or an error is reported in the header status.
+     *
+     * @param dev Indicates the USB device address.
+     * @param pipe Indicates the pipe of the USB device.
+     * @param ashmem Indicates the shared memory holding the stream header and the data ring.
+     *
+     * @return Returns <b>0</b> if the operation is successful; returns a non-0 value if the operation fails.
+     * @since 3.0
+     */
+    int32_t BulkStreamRead(const UsbDev &dev, const UsbPipe &pipe, sptr<Ashmem> &ashmem);
+
+    /* *
+     * @brief Starts streaming writes from a ring buffer ashmem laid out as described by UsbdBulkStreamHeader.
+     *
+     * @param dev Indicates the USB device address.
+     * @param pipe Indicates the pipe of the USB device.
+     * @param ashmem Indicates the shared memory holding the stream header and the data ring.
+     *
+     * @return Returns <b>0</b> if the operation is successful; returns a non-0 value if the operation fails.
+     * @since 3.0
+     */
+    int32_t BulkStreamWrite(const UsbDev &dev, const UsbPipe &pipe, sptr<Ashmem> &ashmem);
+
+    /* *
+     * @brief Resumes a stream that set USBD_BULK_STREAM_FLAG_WAIT after the client has moved its ring index.
+     *
+     * @param dev Indicates the USB device address.
+     * @param pipe Indicates the pipe of the USB device.
+     *
+     * @return Returns <b>0</b> if the operation is successful; returns a non-0 value if the operation fails.
+     * @since 3.0
+     */
+    int32_t BulkStreamKick(const UsbDev &dev, const UsbPipe &pipe);
+
+    /* *
+     * @brief Obtains the throughput counters of asynchronous and streaming bulk transfer on a pipe.
+     *
+     * @param dev Indicates the USB device address.
+     * @param pipe Indicates the pipe of the USB device.
+     * @param stats Indicates the counters.
+     *
+     * @return Returns <b>0</b> if the operation is successful; returns a non-0 value if the operation fails.
+     * @since 3.0
+     */
+    int32_t GetBulkStats(const UsbDev &dev, const UsbPipe &pipe, UsbdBulkStats &stats);
+
 private:
     int32_t SetDeviceMessage(MessageParcel &data, const UsbDev &dev);
     int32_t SetBufferMessage(MessageParcel &data, const std::vector<uint8_t> &bufferData);
@@ -123,6 +123,11 @@ enum UsbdCmd {
     CMD_FUN_REG_BULK_CALLBACK,
     CMD_FUN_UNREG_BULK_CALLBACK,
     CMD_FUN_BULK_CANCEL,
+    CMD_FUN_BULK_STREAM_CONFIG,
+    CMD_FUN_BULK_STREAM_READ,
+    CMD_FUN_BULK_STREAM_WRITE,
+    CMD_FUN_BULK_STREAM_KICK,
+    CMD_FUN_GET_BULK_STATS,
 };
 
 struct UsbdDevice {
@@ -265,4 +270,37 @@ struct UsbdInfo {
 struct UsbdRequest {
 };
 
+#define USBD_BULK_STREAM_MAGIC 0x5553424D
+#define USBD_BULK_STREAM_REQ_SIZE_MAX (64 * 1024)
+#define USBD_BULK_STREAM_DEPTH_MAX 64
+#define USBD_BULK_STREAM_FLAG_WAIT 0x1
+
+/*
+ * Header at the start of a bulk stream ashmem, the data ring follows at headerSize.
+ * ringSize must be a power of two. producer and consumer are free running byte counts, the
+ * readable length is producer - consumer. For reads the service owns producer and the client
+ * owns consumer, for writes the other way round. When the service runs out of ring space (read)
+ * or data (write) it sets USBD_BULK_STREAM_FLAG_WAIT, and the side that moves its index next
+ * clears the flag and sends CMD_FUN_BULK_STREAM_KICK. Indexes and flags are accessed with
+ * sequentially consistent atomics on both sides.
+ */
+struct UsbdBulkStreamHeader {
+    uint32_t magic;
+    uint32_t headerSize;
+    uint32_t ringSize;
+    int32_t status;
+    uint32_t producer;
+    uint32_t consumer;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct UsbdBulkStats {
+    uint64_t bytes;
+    uint64_t requests;
+    uint64_t errors;
+    uint64_t waits;
+    uint64_t elapsedMs;
+};
+
 #endif // USBD_TYPE_H
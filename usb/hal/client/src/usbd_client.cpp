@@ -899,5 +899,124 @@ int32_t UsbdClient::BulkCancel(const UsbDev &dev, const UsbPipe &pipe)
     }
     return ret;
 }
+
+int32_t UsbdClient::BulkStreamConfig(const UsbDev &dev, const UsbPipe &pipe, uint32_t requestSize,
+    uint32_t queueDepth)
+{
+    MessageParcel data;
+    MessageParcel reply;
+
+    if (data.WriteInterfaceToken(GetDescriptor()) == false) {
+        HDF_LOGE(" WriteInterfaceToken failed.");
+        return UEC_HDF_FAILURE;
+    }
+
+    UsbdClient::SetDeviceMessage(data, dev);
+    WRITE_PARCEL_WITH_RET(data, Uint8, pipe.interfaceId, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    WRITE_PARCEL_WITH_RET(data, Uint8, pipe.endpointId, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    WRITE_PARCEL_WITH_RET(data, Uint32, requestSize, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    WRITE_PARCEL_WITH_RET(data, Uint32, queueDepth, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    int32_t ret = UsbdClient::DoDispatch(CMD_FUN_BULK_STREAM_CONFIG, data, reply);
+    if (ret != UEC_OK) {
+        HDF_LOGE("%{public}s:%{public}d failed:%{public}d", __func__, __LINE__, ret);
+    }
+    return ret;
+}
+
+int32_t UsbdClient::BulkStreamRead(const UsbDev &dev, const UsbPipe &pipe, sptr<Ashmem> &ashmem)
+{
+    MessageParcel data;
+    MessageParcel reply;
+    if (ashmem == nullptr) {
+        HDF_LOGE("%{public}s:%{public}d BulkStreamRead error ashmem", __func__, __LINE__);
+        return UEC_HDF_ERR_INVALID_PARAM;
+    }
+
+    if (data.WriteInterfaceToken(GetDescriptor()) == false) {
+        HDF_LOGE(" WriteInterfaceToken failed.");
+        return UEC_HDF_FAILURE;
+    }
+
+    UsbdClient::SetDeviceMessage(data, dev);
+    WRITE_PARCEL_WITH_RET(data, Uint8, pipe.interfaceId, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    WRITE_PARCEL_WITH_RET(data, Uint8, pipe.endpointId, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    WRITE_PARCEL_WITH_RET(data, Ashmem, ashmem, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    int32_t ret = UsbdClient::DoDispatch(CMD_FUN_BULK_STREAM_READ, data, reply);
+    if (ret != UEC_OK) {
+        HDF_LOGE("%{public}s:%{public}d failed:%{public}d", __func__, __LINE__, ret);
+    }
+    return ret;
+}
+
+int32_t UsbdClient::BulkStreamWrite(const UsbDev &dev, const UsbPipe &pipe, sptr<Ashmem> &ashmem)
+{
+    MessageParcel data;
+    MessageParcel reply;
+    if (ashmem == nullptr) {
+        HDF_LOGE("%{public}s:%{public}d BulkStreamWrite error ashmem", __func__, __LINE__);
+        return UEC_HDF_ERR_INVALID_PARAM;
+    }
+
+    if (data.WriteInterfaceToken(GetDescriptor()) == false) {
+        HDF_LOGE(" WriteInterfaceToken failed.");
+        return UEC_HDF_FAILURE;
+    }
+
+    UsbdClient::SetDeviceMessage(data, dev);
+    WRITE_PARCEL_WITH_RET(data, Uint8, pipe.interfaceId, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    WRITE_PARCEL_WITH_RET(data, Uint8, pipe.endpointId, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    WRITE_PARCEL_WITH_RET(data, Ashmem, ashmem, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    int32_t ret = UsbdClient::DoDispatch(CMD_FUN_BULK_STREAM_WRITE, data, reply);
+    if (ret != UEC_OK) {
+        HDF_LOGE("%{public}s:%{public}d failed:%{public}d", __func__, __LINE__, ret);
+    }
+    return ret;
+}
+
+int32_t UsbdClient::BulkStreamKick(const UsbDev &dev, const UsbPipe &pipe)
+{
+    MessageParcel data;
+    MessageParcel reply;
+
+    if (data.WriteInterfaceToken(GetDescriptor()) == false) {
+        HDF_LOGE(" WriteInterfaceToken failed.");
+        return UEC_HDF_FAILURE;
+    }
+
+    UsbdClient::SetDeviceMessage(data, dev);
+    WRITE_PARCEL_WITH_RET(data, Uint8, pipe.interfaceId, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    WRITE_PARCEL_WITH_RET(data, Uint8, pipe.endpointId, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    int32_t ret = UsbdClient::DoDispatch(CMD_FUN_BULK_STREAM_KICK, data, reply);
+    if (ret != UEC_OK) {
+        HDF_LOGE("%{public}s:%{public}d failed:%{public}d", __func__, __LINE__, ret);
+    }
+    return ret;
+}
+
+int32_t UsbdClient::GetBulkStats(const UsbDev &dev, const UsbPipe &pipe, UsbdBulkStats &stats)
+{
+    MessageParcel data;
+    MessageParcel reply;
+
+    if (data.WriteInterfaceToken(GetDescriptor()) == false) {
+        HDF_LOGE(" WriteInterfaceToken failed.");
+        return UEC_HDF_FAILURE;
+    }
+
+    UsbdClient::SetDeviceMessage(data, dev);
+    WRITE_PARCEL_WITH_RET(data, Uint8, pipe.interfaceId, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    WRITE_PARCEL_WITH_RET(data, Uint8, pipe.endpointId, UEC_SERVICE_WRITE_PARCEL_ERROR);
+    int32_t ret = UsbdClient::DoDispatch(CMD_FUN_GET_BULK_STATS, data, reply);
+    if (ret != UEC_OK) {
+        HDF_LOGE("%{public}s:%{public}d failed:%{public}d", __func__, __LINE__, ret);
+        return ret;
+    }
+    READ_PARCEL_WITH_RET(reply, Uint64, stats.bytes, UEC_SERVICE_READ_PARCEL_ERROR);
+    READ_PARCEL_WITH_RET(reply, Uint64, stats.requests, UEC_SERVICE_READ_PARCEL_ERROR);
+    READ_PARCEL_WITH_RET(reply, Uint64, stats.errors, UEC_SERVICE_READ_PARCEL_ERROR);
+    READ_PARCEL_WITH_RET(reply, Uint64, stats.waits, UEC_SERVICE_READ_PARCEL_ERROR);
+    READ_PARCEL_WITH_RET(reply, Uint64, stats.elapsedMs, UEC_SERVICE_READ_PARCEL_ERROR);
+    return ret;
+}
 } // namespace USB
 } // namespace OHOS
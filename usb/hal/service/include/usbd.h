@@ -23,6 +23,7 @@
 #include "osal_sem.h"
 #include "usb_ddk.h"
 #include "usb_ddk_interface.h"
+#include "usb_hash_index.h"
 #include "usb_session.h"
 #include "usbd_publisher.h"
 #include "usbd_type.h"
@@ -60,6 +61,7 @@ struct UsbdBulkASyncReqNode {
 
 struct UsbdBulkASyncReqList {
     struct UsbdBulkASyncReqNode node[USBD_BULKASYNCREQ_NUM_MAX];
+    uint32_t reqNum; /* < node[0, reqNum) hold a request */
     struct UsbdBulkASyncList *pList;
     struct DListHead eList;
     struct DListHead uList;
@@ -78,10 +80,18 @@ struct UsbdBulkASyncList {
     struct UsbdBufferHandle asmHandle;
     uint8_t ifId;
     uint8_t epId;
+    uint32_t reqSize;
+    uint32_t queueDepth;
+    uint32_t inflight;
+    uint32_t streamPos;
+    bool stream;
+    struct UsbdBulkStats stats;
+    uint64_t statsStartTime;
 };
 
 struct HostDevice {
     struct HdfSListNode node;
+    struct UsbHashNode hashNode;
     struct UsbdService *service;
     struct DataFifo readFifo;
     struct HdfSList requestQueue;
@@ -102,6 +112,7 @@ struct HostDevice {
     bool initFlag;
     struct HdfSList reqSyncList;
     struct OsalMutex reqSyncLock;
+    struct UsbHashIndex reqSyncIndex;
     struct HdfSList reqASyncList;
     struct OsalMutex reqASyncLock;
     struct UsbdBulkASyncList *bulkASyncList;
@@ -141,17 +152,21 @@ struct UsbdService {
     struct UsbdSubscriber *subscriber;
     struct UsbSession *session;
     struct HdfSList devList;
+    struct UsbHashIndex devIndex;
     struct OsalMutex lock;
 };
 
 struct UsbdRequestSync {
     struct HdfSListNode node;
+    struct UsbHashNode hashNode;
     struct UsbRequest *request;
     UsbInterfaceHandle *ifHandle;
     struct OsalMutex lock;
     struct UsbPipeInfo pipe;
     struct UsbRequestParams params;
     uint8_t endPointAddr;
+    uint32_t bufLen;
+    uint8_t *readBuf; /* < bufLen bytes, reused by every sync bulk read on the pipe */
 };
 
 struct UsbdRequestASync {
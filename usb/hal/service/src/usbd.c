@@ -122,6 +122,12 @@ static int32_t UsbdDriverBind(struct HdfDeviceObject *device)
         OsalMemFree(dev);
         return HDF_FAILURE;
     }
+    if (UsbHashIndexInit(&dev->devIndex) != HDF_SUCCESS) {
+        HDF_LOGE(" init dev index fail!");
+        OsalMutexDestroy(&dev->lock);
+        OsalMemFree(dev);
+        return HDF_FAILURE;
+    }
     int32_t ret = HDF_SUCCESS;
     struct UsbPnpNotifyServiceInfo *info = (struct UsbPnpNotifyServiceInfo *)device->priv;
     if (info != NULL) {
@@ -15,6 +15,7 @@
 
 #include "usbd_dispatcher.h"
 #include <errno.h>
+#include <inttypes.h>
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -34,6 +35,7 @@
 #define MAX_BUFF_SIZE 16384
 #define MAX_CONTROL_BUFF_SIZE 1024
 #define READ_BUF_SIZE 8192
+#define BULK_SYNC_BUFF_SIZE 65536
 
 #define USB_CTRL_SET_TIMEOUT 5000
 #define GET_STRING_SET_TIMEOUT 50
@@ -313,6 +315,7 @@ static int32_t UsbdBulkReadSyncGetParams(struct HdfSBuf *data, uint8_t *ifId, ui
     return HDF_SUCCESS;
 }
 
+/* Called with requestSync->lock held. */
 static int32_t UsbdBulkReadSyncBase(int32_t timeout, uint8_t *buffer, uint32_t size, uint32_t *actlength,
     struct UsbdRequestSync *requestSync)
 {
@@ -326,21 +329,34 @@ static int32_t UsbdBulkReadSyncBase(int32_t timeout, uint8_t *buffer, uint32_t s
     uint64_t stime = OsalGetSysTimeMs();
     uint64_t ntime = 0;
     uint32_t tcur = 0;
-    uint32_t msize = 0;
-    OsalMutexLock(&requestSync->lock);
+    uint32_t tsize = 0;
+    uint32_t msize = requestSync->pipe.maxPacketSize;
     requestSync->params.timeout = timeonce;
-    msize = requestSync->pipe.maxPacketSize;
-    while (tcur + msize < size) {
+    while (tcur < size) {
+        /* Submit one request for as much of the buffer as is left, the adapter splits it into URBs. */
+        tsize = (size - tcur) < requestSync->bufLen ? (size - tcur) : requestSync->bufLen;
+        if ((msize > 0) && (tsize > msize) && (tsize < size - tcur)) {
+            tsize -= tsize % msize;
+        }
+        requestSync->params.dataReq.length = tsize;
         ret = UsbFillRequest(requestSync->request, requestSync->ifHandle, &requestSync->params);
         if (HDF_SUCCESS != ret) {
             HDF_LOGE("%{public}s: UsbFillRequest failed, ret=%{public}d \n", __func__, ret);
             break;
         }
+        requestSync->request->compInfo.actualLength = 0;
         ret = UsbSubmitRequestSync(requestSync->request);
+        uint32_t actualLength = requestSync->request->compInfo.actualLength;
+        if ((actualLength > 0) && ((HDF_SUCCESS == ret) || (HDF_ERR_TIMEOUT == ret))) {
+            actualLength = actualLength < (size - tcur) ? actualLength : (size - tcur);
+            memcpy_s(buffer + tcur, size - tcur, requestSync->request->compInfo.buffer, actualLength);
+            tcur += actualLength;
+        }
         if (HDF_SUCCESS == ret) {
-            memcpy_s(buffer + tcur, size - tcur, requestSync->request->compInfo.buffer,
-                     requestSync->request->compInfo.actualLength);
-            tcur += requestSync->request->compInfo.actualLength;
+            /* A short packet terminates the transfer. */
+            if (actualLength < tsize) {
+                break;
+            }
         } else if (HDF_ERR_TIMEOUT == ret) {
             if (tcur > 0) {
                 ret = HDF_SUCCESS;
@@ -358,36 +374,20 @@ static int32_t UsbdBulkReadSyncBase(int32_t timeout, uint8_t *buffer, uint32_t s
             break;
         }
     }
-    OsalMutexUnlock(&requestSync->lock);
     *actlength = tcur;
     return ret;
 }
 
 static struct UsbdRequestSync *UsbdFindRequestSync(struct HostDevice *port, uint8_t interfaceId, uint8_t pipeAddr)
 {
-    struct UsbdRequestSync *req = NULL;
-    struct HdfSListIterator it;
-    bool flag = false;
+    struct UsbHashNode *node = NULL;
     if (!port) {
         HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
         return NULL;
     }
-    OsalMutexLock(&port->reqSyncLock);
-    HdfSListIteratorInit(&it, &port->reqSyncList);
-    while (HdfSListIteratorHasNext(&it)) {
-        req = (struct UsbdRequestSync *)HdfSListIteratorNext(&it);
-        if (!req) {
-            continue;
-        }
-        if ((req->pipe.interfaceId == interfaceId) && ((req->pipe.pipeAddress | req->pipe.pipeDirection) == pipeAddr)) {
-            flag = true;
-            break;
-        }
-    }
-    OsalMutexUnlock(&port->reqSyncLock);
-
-    if (flag) {
-        return req;
+    node = UsbHashIndexFind(&port->reqSyncIndex, USB_HASH_PIPE_KEY(interfaceId, pipeAddr), NULL, NULL);
+    if (node) {
+        return USB_HASH_INDEX_ENTRY(node, struct UsbdRequestSync, hashNode);
     }
     HDF_LOGE("%{public}s:%{public}d req null", __func__, __LINE__);
     return NULL;
@@ -439,7 +439,19 @@ static int32_t UsbdRequestSyncInit(struct HostDevice *port, UsbInterfaceHandle *
     }
     memcpy_s(&requestSync->pipe, sizeof(struct UsbPipeInfo), pipe, sizeof(struct UsbPipeInfo));
     requestSync->ifHandle = ifHandle;
-    requestSync->request = UsbAllocRequest(requestSync->ifHandle, 0, requestSync->pipe.maxPacketSize);
+    requestSync->bufLen = requestSync->pipe.maxPacketSize;
+    if (requestSync->pipe.pipeType == USB_PIPE_TYPE_BULK) {
+        requestSync->bufLen = BULK_SYNC_BUFF_SIZE;
+        requestSync->request = UsbAllocRequest(requestSync->ifHandle, 0, requestSync->bufLen);
+        if (!requestSync->request) {
+            HDF_LOGW("%{public}s:%{public}d alloc %{public}u bytes failed, fall back to maxPacketSize", __func__,
+                __LINE__, requestSync->bufLen);
+            requestSync->bufLen = requestSync->pipe.maxPacketSize;
+        }
+    }
+    if (!requestSync->request) {
+        requestSync->request = UsbAllocRequest(requestSync->ifHandle, 0, requestSync->bufLen);
+    }
     if (!requestSync->request) {
         HDF_LOGE("%{public}s:%{public}d alloc request failed\n", __func__, __LINE__);
         return HDF_ERR_MALLOC_FAIL;
@@ -449,6 +461,8 @@ static int32_t UsbdRequestSyncInit(struct HostDevice *port, UsbInterfaceHandle *
     OsalMutexLock(&port->reqSyncLock);
     HdfSListAdd(&port->reqSyncList, &requestSync->node);
     OsalMutexUnlock(&port->reqSyncLock);
+    UsbHashIndexInsert(&port->reqSyncIndex, &requestSync->hashNode,
+        USB_HASH_PIPE_KEY(pipe->interfaceId, pipe->pipeAddress | pipe->pipeDirection));
     return ret;
 }
 
@@ -464,6 +478,8 @@ static int32_t UsbdRequestSyncRelease(struct UsbdRequestSync *requestSync)
             }
             requestSync->request = NULL;
         }
+        OsalMemFree(requestSync->readBuf);
+        requestSync->readBuf = NULL;
         OsalMutexUnlock(&requestSync->lock);
         OsalMemFree(requestSync);
     }
@@ -523,8 +539,6 @@ static int32_t FunBulkReadSync(struct HostDevice *port, struct HdfSBuf *data, st
 {
     uint8_t interfaceId = 0, pipeId = 0;
     int32_t timeout = 0;
-    uint8_t tbuf[READ_BUF_SIZE] = {0};
-    uint32_t tsize = READ_BUF_SIZE;
     uint32_t actlength = 0;
     struct UsbdRequestSync *requestSync = NULL;
 
@@ -547,19 +561,29 @@ static int32_t FunBulkReadSync(struct HostDevice *port, struct HdfSBuf *data, st
         HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
         return HDF_ERR_INVALID_PARAM;
     }
-    ret = UsbdBulkReadSyncBase(timeout, tbuf, tsize, &actlength, requestSync);
+    OsalMutexLock(&requestSync->lock);
+    if (requestSync->readBuf == NULL) {
+        requestSync->readBuf = (uint8_t *)OsalMemAlloc(requestSync->bufLen);
+        if (requestSync->readBuf == NULL) {
+            OsalMutexUnlock(&requestSync->lock);
+            HDF_LOGE("%{public}s:%{public}d OsalMemAlloc failed", __func__, __LINE__);
+            return HDF_ERR_MALLOC_FAIL;
+        }
+    }
+    ret = UsbdBulkReadSyncBase(timeout, requestSync->readBuf, requestSync->bufLen, &actlength, requestSync);
     if (HDF_SUCCESS != ret) {
         HDF_LOGW("%{public}s:%{public}d UsbdBulkReadSyncBase ret:%{public}d, len:%{public}u",
             __func__, __LINE__, ret, actlength);
     }
     if (actlength > 0) {
-        if (!UsbdHdfWriteBuf(reply, tbuf, actlength)) {
+        if (!UsbdHdfWriteBuf(reply, requestSync->readBuf, actlength)) {
             HDF_LOGE("%{public}s:%{public}d sbuf write buffer failed:%{public}u", __func__, __LINE__, actlength);
             ret = HDF_ERR_IO;
         } else {
             ret = HDF_SUCCESS;
         }
     }
+    OsalMutexUnlock(&requestSync->lock);
     return ret;
 }
 
@@ -597,6 +621,7 @@ static int32_t UsbdRequestSyncReleaseList(struct HostDevice *port)
             continue;
         }
         HdfSListIteratorRemove(&it);
+        (void)UsbHashIndexRemove(&port->reqSyncIndex, &req->hashNode);
         ret = UsbdRequestSyncRelease(req);
         req = NULL;
         if (HDF_SUCCESS != ret) {
@@ -621,9 +646,12 @@ static int32_t UsbdBulkWriteSyncBase(struct HostDevice *port, struct UsbdRequest
     int32_t initTimeout = timeout < 0 ? 0 : timeout;
     requestSync->params.timeout = initTimeout;
     requestSync->params.userData = port;
-    uint16_t tsize = requestSync->pipe.maxPacketSize;
-    uint16_t tcur = 0;
-    uint16_t msize = requestSync->pipe.maxPacketSize;
+    uint32_t tsize = 0;
+    uint32_t tcur = 0;
+    uint32_t msize = requestSync->bufLen;
+    if ((requestSync->pipe.maxPacketSize > 0) && (msize > requestSync->pipe.maxPacketSize)) {
+        msize -= msize % requestSync->pipe.maxPacketSize;
+    }
     while (tcur < length) {
         tsize = (length - tcur) < msize ? (length - tcur) : msize;
         requestSync->params.dataReq.buffer = (unsigned char *)(buffer + tcur);
@@ -1163,6 +1191,7 @@ static void RemoveDevFromService(struct UsbdService *service, struct HostDevice
         }
         if ((tempPort->busNum == port->busNum) && (tempPort->devAddr == port->devAddr)) {
             HdfSListIteratorRemove(&it);
+            (void)UsbHashIndexRemove(&service->devIndex, &tempPort->hashNode);
             break;
         }
     }
@@ -1324,10 +1353,11 @@ static int32_t UsbdRequestASyncReleaseList(struct HostDevice *port)
 
 static int32_t UsbdBulkASyncReqRelease(struct UsbdBulkASyncReqList *list)
 {
-    for (int32_t i = 0; i < USBD_BULKASYNCREQ_NUM_MAX; ++i) {
+    for (uint32_t i = 0; i < list->reqNum; ++i) {
         UsbFreeRequest(list->node[i].request);
         list->node[i].request = NULL;
     }
+    list->reqNum = 0;
     DListHeadInit(&list->eList);
     DListHeadInit(&list->uList);
     OsalMutexDestroy(&list->elock);
@@ -1386,6 +1416,7 @@ static void UsbdRelease(struct HostDevice *dev)
     OsalMutexDestroy(&dev->requestLock);
     OsalMutexDestroy(&dev->reqSyncLock);
     OsalMutexDestroy(&dev->reqASyncLock);
+    UsbHashIndexDestroy(&dev->reqSyncIndex);
     dev->busNum = 0;
     dev->devAddr = 0;
     dev->initFlag = false;
@@ -1402,6 +1433,13 @@ static int32_t ReOpenDevice(struct HostDevice *port)
     UsbdRelease(port);
     port->busNum = busNum;
     port->devAddr = devAddr;
+    /* first, the port holds nothing else to undo if it fails */
+    if (UsbHashIndexInit(&port->reqSyncIndex) != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s:%{public}d init index failed", __func__, __LINE__);
+        RemoveDevFromService(port->service, port);
+        OsalMemFree(port);
+        return HDF_FAILURE;
+    }
     OsalMutexInit(&port->writeLock);
     OsalMutexInit(&port->readLock);
     OsalMutexInit(&port->lock);
@@ -2156,30 +2194,17 @@ static int32_t FunGetFileDescriptor(struct HostDevice *port, struct HdfSBuf *rep
 
 static struct HostDevice *FindDevFromService(struct UsbdService *service, uint8_t busNum, uint8_t devAddr)
 {
-    struct HdfSListIterator it;
-    struct HostDevice *port = NULL;
-    bool flag = false;
+    struct UsbHashNode *node = NULL;
     if (!service) {
         return NULL;
     }
 
-    OsalMutexLock(&service->lock);
-    HdfSListIteratorInit(&it, &service->devList);
-    while (HdfSListIteratorHasNext(&it)) {
-        port = (struct HostDevice *)HdfSListIteratorNext(&it);
-        if (!port) {
-            continue;
-        }
-        if ((port->busNum == busNum) && (port->devAddr == devAddr)) {
-            flag = true;
-            break;
-        }
-    }
-    OsalMutexUnlock(&service->lock);
-    if (!flag) {
+    /* called on every request, only the read side of the index is taken */
+    node = UsbHashIndexFind(&service->devIndex, USB_HASH_DEV_KEY(busNum, devAddr), NULL, NULL);
+    if (!node) {
         return NULL;
     }
-    return port;
+    return USB_HASH_INDEX_ENTRY(node, struct HostDevice, hashNode);
 }
 
 static int32_t HostDeviceInit(struct HostDevice *port)
@@ -2217,6 +2242,10 @@ static int32_t HostDeviceInit(struct HostDevice *port)
         HDF_LOGE("%{public}s:%{public}d init lock failed!", __func__, __LINE__);
         return HDF_FAILURE;
     }
+    if (UsbHashIndexInit(&port->reqSyncIndex) != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s:%{public}d init index failed!", __func__, __LINE__);
+        return HDF_FAILURE;
+    }
     HdfSListInit(&port->requestQueue);
     HdfSListInit(&port->reqSyncList);
     HdfSListInit(&port->reqASyncList);
@@ -2264,6 +2293,7 @@ int32_t UsbdRealseDevices(struct UsbdService *service)
     while (!HdfSListIsEmpty(&service->devList)) {
         struct HostDevice *port = (struct HostDevice *)HdfSListPop(&service->devList);
         if (port) {
+            (void)UsbHashIndexRemove(&service->devIndex, &port->hashNode);
             UsbdRelease(port);
             OsalMemFree(port);
             port = NULL;
@@ -2336,6 +2366,7 @@ int32_t UsbdDeviceCreateAndAttach(struct UsbdService *service, uint8_t busNum, u
         OsalMutexLock(&service->lock);
         HdfSListAdd(&service->devList, &port->node);
         OsalMutexUnlock(&service->lock);
+        UsbHashIndexInsert(&service->devIndex, &port->hashNode, USB_HASH_DEV_KEY(busNum, devAddr));
         ret = FunAttachDevice(port, NULL, NULL);
         port = NULL;
     } else {
@@ -2389,6 +2420,7 @@ struct HostDevice *UsbdFindDevForBusNum(struct UsbdService *service, uint8_t bus
         }
         if (tempPort->busNum == busNum) {
             HdfSListIteratorRemove(&it);
+            (void)UsbHashIndexRemove(&service->devIndex, &tempPort->hashNode);
             flg = true;
             break;
         }
@@ -2429,7 +2461,7 @@ static int32_t UsbdBulkASyncReqInit(struct UsbdBulkASyncReqList *list, struct Us
     OsalMutexInit(&list->elock);
     OsalMutexInit(&list->ulock);
     for (i = 0; i < USBD_BULKASYNCREQ_NUM_MAX; ++i) {
-        list->node[i].request = UsbAllocRequest(pList->ifHandle, 0, pList->pipe.maxPacketSize);
+        list->node[i].request = UsbAllocRequest(pList->ifHandle, 0, pList->reqSize);
         if (!list->node[i].request) {
             HDF_LOGE("%{public}s:%{public}d alloc request failed i:%{public}d", __func__, __LINE__, i);
             ret = HDF_ERR_MALLOC_FAIL;
@@ -2450,6 +2482,8 @@ static int32_t UsbdBulkASyncReqInit(struct UsbdBulkASyncReqList *list, struct Us
         DListHeadInit(&list->uList);
         OsalMutexDestroy(&list->elock);
         OsalMutexDestroy(&list->ulock);
+    } else {
+        list->reqNum = USBD_BULKASYNCREQ_NUM_MAX;
     }
     list->pList = pList;
     return ret;
@@ -2496,6 +2530,8 @@ static struct UsbdBulkASyncList *UsbdBulkASyncListAlloc(struct HostDevice *port,
     OsalMutexInit(&bulkAsyncList->asmHandle.lock);
     bulkAsyncList->pipe = pipe;
     bulkAsyncList->ifHandle = ifHandle;
+    bulkAsyncList->reqSize = pipe.maxPacketSize;
+    bulkAsyncList->queueDepth = USBD_BULKASYNCREQ_NUM_MAX;
 
     UsbdBulkASyncReqFillParams(&bulkAsyncList->pipe, &bulkAsyncList->params, NULL);
 
@@ -2566,24 +2602,10 @@ static struct UsbdBulkASyncReqNode *UsbdBulkASyncReqGetENode(struct UsbdBulkASyn
     return ptr;
 }
 
-static int32_t UsbdBulkReadRemoteCallback(struct HdfRemoteService *service, int32_t status,
-    struct UsbdBufferHandle *handle)
+static int32_t UsbdBulkRemoteCallbackDispatch(struct HdfRemoteService *service, int32_t cmd, int32_t status,
+    int32_t actLength)
 {
     int32_t ret = HDF_SUCCESS;
-    int32_t actLength = 0;
-    uint8_t flg = 0;
-    if ((service == NULL) || (handle == NULL)) {
-        HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
-        return HDF_ERR_INVALID_PARAM;
-    }
-    OsalMutexLock(&handle->lock);
-    flg = handle->cbflg;
-    handle->cbflg = 1;
-    actLength = handle->rcur;
-    OsalMutexUnlock(&handle->lock);
-    if (flg) {
-        return HDF_SUCCESS;
-    }
     struct HdfSBuf *data = HdfSbufTypedObtain(SBUF_IPC);
     struct HdfSBuf *reply = HdfSbufTypedObtain(SBUF_IPC);
     do {
@@ -2607,7 +2629,7 @@ static int32_t UsbdBulkReadRemoteCallback(struct HdfRemoteService *service, int3
             ret = HDF_ERR_IO;
             break;
         }
-        ret = service->dispatcher->Dispatch(service, CMD_USBD_BULK_CALLBACK_READ, data, reply);
+        ret = service->dispatcher->Dispatch(service, cmd, data, reply);
     } while (0);
 
     HdfSbufRecycle(data);
@@ -2615,10 +2637,29 @@ static int32_t UsbdBulkReadRemoteCallback(struct HdfRemoteService *service, int3
     return ret;
 }
 
+static int32_t UsbdBulkReadRemoteCallback(struct HdfRemoteService *service, int32_t status,
+    struct UsbdBufferHandle *handle)
+{
+    int32_t actLength = 0;
+    uint8_t flg = 0;
+    if ((service == NULL) || (handle == NULL)) {
+        HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    OsalMutexLock(&handle->lock);
+    flg = handle->cbflg;
+    handle->cbflg = 1;
+    actLength = handle->rcur;
+    OsalMutexUnlock(&handle->lock);
+    if (flg) {
+        return HDF_SUCCESS;
+    }
+    return UsbdBulkRemoteCallbackDispatch(service, CMD_USBD_BULK_CALLBACK_READ, status, actLength);
+}
+
 static int32_t UsbdBulkWriteRemoteCallback(struct HdfRemoteService *service, int32_t status,
     struct UsbdBufferHandle *handle)
 {
-    int32_t ret = HDF_SUCCESS;
     int32_t actLength = 0;
     uint8_t flg = 0;
     if ((service == NULL) || (handle == NULL)) {
@@ -2633,35 +2674,35 @@ static int32_t UsbdBulkWriteRemoteCallback(struct HdfRemoteService *service, int
     if (flg) {
         return HDF_SUCCESS;
     }
-    struct HdfSBuf *data = HdfSbufTypedObtain(SBUF_IPC);
-    struct HdfSBuf *reply = HdfSbufTypedObtain(SBUF_IPC);
-    do {
-        if (data == NULL || reply == NULL) {
-            HDF_LOGE("%{public}s:%{public}d failed to obtain hdf sbuf", __func__, __LINE__);
-            ret = HDF_ERR_IO;
-            break;
-        }
-        if (!HdfRemoteServiceWriteInterfaceToken(service, data)) {
-            HDF_LOGE("%{public}s:%{public}d write interface token failed", __func__, __LINE__);
-            ret = HDF_ERR_IO;
-            break;
-        }
-        if (!HdfSbufWriteInt32(data, status)) {
-            HDF_LOGE("%{public}s:%{public}d write status error status:%{public}d", __func__, __LINE__, status);
-            ret = HDF_ERR_IO;
-            break;
-        }
-        if (!HdfSbufWriteInt32(data, actLength)) {
-            HDF_LOGE("%{public}s:%{public}d write actLength error length:%{public}d", __func__, __LINE__, actLength);
-            ret = HDF_ERR_IO;
-            break;
-        }
-        ret = service->dispatcher->Dispatch(service, CMD_USBD_BULK_CALLBACK_WRITE, data, reply);
-    } while (0);
+    return UsbdBulkRemoteCallbackDispatch(service, CMD_USBD_BULK_CALLBACK_WRITE, status, actLength);
+}
 
-    HdfSbufRecycle(data);
-    HdfSbufRecycle(reply);
-    return ret;
+/* Called with asmHandle.lock held. */
+static void UsbdBulkStatsAdd(struct UsbdBulkASyncList *list, int32_t status, uint32_t actualLength)
+{
+    if (status == 0) {
+        list->stats.bytes += actualLength;
+        list->stats.requests++;
+    } else {
+        list->stats.errors++;
+    }
+}
+
+static void UsbdBulkStatsUpdate(struct UsbdBulkASyncList *list, int32_t status, uint32_t actualLength)
+{
+    OsalMutexLock(&list->asmHandle.lock);
+    UsbdBulkStatsAdd(list, status, actualLength);
+    OsalMutexUnlock(&list->asmHandle.lock);
+}
+
+/* Throughput is measured from the first transfer started on the pipe. */
+static void UsbdBulkStatsStart(struct UsbdBulkASyncList *list)
+{
+    OsalMutexLock(&list->asmHandle.lock);
+    if (list->statsStartTime == 0) {
+        list->statsStartTime = OsalGetSysTimeMs();
+    }
+    OsalMutexUnlock(&list->asmHandle.lock);
 }
 
 static int32_t UsbdBulkASyncPutAsmData(struct UsbdBufferHandle *handle, uint8_t *buffer, uint32_t len)
@@ -2691,17 +2732,17 @@ static int32_t UsbdBulkASyncPutAsmData(struct UsbdBufferHandle *handle, uint8_t
 }
 
 static int32_t UsbdBulkAsyncGetAsmData(struct UsbdBufferHandle *handle, struct UsbRequestParams *params,
-    uint16_t maxPacketSize)
+    uint32_t reqSize)
 {
     int32_t ret = HDF_ERR_INVALID_PARAM;
-    if ((handle == NULL) || (params == NULL) || (handle->size < 1) || (maxPacketSize < 1)) {
+    if ((handle == NULL) || (params == NULL) || (handle->size < 1) || (reqSize < 1)) {
         HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
         return HDF_ERR_IO;
     }
     OsalMutexLock(&handle->lock);
     if (handle->cur < handle->size) {
         params->dataReq.length =
-            (handle->size - handle->cur) < maxPacketSize ? (handle->size - handle->cur) : maxPacketSize;
+            (uint32_t)(handle->size - handle->cur) < reqSize ? (uint32_t)(handle->size - handle->cur) : reqSize;
         params->dataReq.buffer = handle->starAddr + handle->cur;
         handle->cur += params->dataReq.length;
         ret = HDF_SUCCESS;
@@ -2715,9 +2756,9 @@ static int32_t UsbdBulkAsyncGetAsmData(struct UsbdBufferHandle *handle, struct U
     return ret;
 }
 
-static int32_t UsbdBulkAsyncGetAsmReqLen(struct UsbdBufferHandle *handle, uint32_t *reqLen, uint16_t maxPacketSize)
+static int32_t UsbdBulkAsyncGetAsmReqLen(struct UsbdBufferHandle *handle, uint32_t *reqLen, uint32_t reqSize)
 {
-    if ((handle == NULL) || (reqLen == NULL) || (handle->size < 1) || (maxPacketSize < 1)) {
+    if ((handle == NULL) || (reqLen == NULL) || (handle->size < 1) || (reqSize < 1)) {
         HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
         return HDF_ERR_IO;
     }
@@ -2725,7 +2766,7 @@ static int32_t UsbdBulkAsyncGetAsmReqLen(struct UsbdBufferHandle *handle, uint32
     OsalMutexLock(&handle->lock);
     if (handle->cur < handle->size) {
         tlen = handle->size - handle->cur;
-        tlen = tlen < maxPacketSize ? tlen : maxPacketSize;
+        tlen = tlen < reqSize ? tlen : reqSize;
         handle->cur += tlen;
     }
     OsalMutexUnlock(&handle->lock);
@@ -2740,7 +2781,7 @@ static int32_t UsbdBulkASyncReqWriteAutoSubmit(struct UsbRequest *request)
     struct UsbRequestParams params = {0};
     memcpy_s(&params, sizeof(params), &db->list->pList->params, sizeof(params));
     params.userData = (void *)db;
-    ret = UsbdBulkAsyncGetAsmData(&db->list->pList->asmHandle, &params, db->list->pList->pipe.maxPacketSize);
+    ret = UsbdBulkAsyncGetAsmData(&db->list->pList->asmHandle, &params, db->list->pList->reqSize);
     if (HDF_SUCCESS != ret) {
         UsbdBulkASyncReqNodeSetNoUse(db);
         return ret;
@@ -2774,7 +2815,7 @@ static int32_t UsbdBulkASyncReqReadAutoSubmit(struct UsbRequest *request)
         UsbdBulkASyncReqNodeSetNoUse(db);
         return ret;
     }
-    ret = UsbdBulkAsyncGetAsmReqLen(&db->list->pList->asmHandle, &readLen, db->list->pList->pipe.maxPacketSize);
+    ret = UsbdBulkAsyncGetAsmReqLen(&db->list->pList->asmHandle, &readLen, db->list->pList->reqSize);
     if (readLen < 1) {
         UsbdBulkASyncReqNodeSetNoUse(db);
         HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
@@ -2811,11 +2852,12 @@ static void UsbdBulkASyncWriteCallbackAutoSubmit(struct UsbRequest *request)
     int32_t ret = HDF_SUCCESS;
     struct UsbdBulkASyncReqNode *node = (struct UsbdBulkASyncReqNode *)request->compInfo.userData;
     int32_t status = request->compInfo.status;
+    UsbdBulkStatsUpdate(node->list->pList, status, request->compInfo.actualLength);
     if (status == 0) {
         ret = UsbdBulkASyncReqWriteAutoSubmit(request);
         if (HDF_DEV_ERR_NODATA == ret) {
             int32_t count = DListGetCount(&node->list->eList);
-            if (count >= USBD_BULKASYNCREQ_NUM_MAX) {
+            if (count >= (int32_t)node->list->reqNum) {
                 ret = UsbdBulkWriteRemoteCallback(node->list->pList->cb, HDF_SUCCESS, &node->list->pList->asmHandle);
             }
         } else if (HDF_SUCCESS != ret) {
@@ -2843,11 +2885,12 @@ static void UsbdBulkASyncReadCallbackAutoSubmit(struct UsbRequest *request)
     int32_t ret = HDF_SUCCESS;
     struct UsbdBulkASyncReqNode *node = (struct UsbdBulkASyncReqNode *)request->compInfo.userData;
     int32_t status = request->compInfo.status;
+    UsbdBulkStatsUpdate(node->list->pList, status, request->compInfo.actualLength);
     if (status == 0) {
         ret = UsbdBulkASyncReqReadAutoSubmit(request);
         if (HDF_DEV_ERR_NODATA == ret) {
             int32_t count = DListGetCount(&node->list->eList);
-            if (count >= USBD_BULKASYNCREQ_NUM_MAX) {
+            if (count >= (int32_t)node->list->reqNum) {
                 ret = UsbdBulkReadRemoteCallback(node->list->pList->cb, HDF_SUCCESS, &node->list->pList->asmHandle);
             }
         } else if (HDF_SUCCESS != ret) {
@@ -2893,7 +2936,7 @@ static int32_t UsbdBulkASyncReqWriteSubmit(struct UsbdBulkASyncReqNode *req)
     struct UsbRequestParams params = {0};
     memcpy_s(&params, sizeof(params), &req->list->pList->params, sizeof(params));
     params.userData = (void *)req;
-    ret = UsbdBulkAsyncGetAsmData(&req->list->pList->asmHandle, &params, req->list->pList->pipe.maxPacketSize);
+    ret = UsbdBulkAsyncGetAsmData(&req->list->pList->asmHandle, &params, req->list->pList->reqSize);
     if (HDF_SUCCESS != ret) {
         UsbdBulkASyncReqNodeSetNoUse(req);
         HDF_LOGE("%{public}s:%{public}d UsbdBulkAsyncGetAsmData ret:%{public}d", __func__, __LINE__, ret);
@@ -2934,7 +2977,7 @@ static int32_t UsbdBulkASyncWriteSubmitStart(struct UsbdBulkASyncList *list)
                 break;
             }
         }
-        if (++i > USBD_BULKASYNCREQ_NUM_MAX) {
+        if (++i >= list->queueDepth) {
             break;
         }
     } while (!DListIsEmpty(&list->rList.eList));
@@ -2945,7 +2988,7 @@ static int32_t UsbdBulkASyncReqReadSubmit(struct UsbdBulkASyncReqNode *db)
 {
     int32_t ret = HDF_SUCCESS;
     uint32_t readLen = 0;
-    ret = UsbdBulkAsyncGetAsmReqLen(&db->list->pList->asmHandle, &readLen, db->list->pList->pipe.maxPacketSize);
+    ret = UsbdBulkAsyncGetAsmReqLen(&db->list->pList->asmHandle, &readLen, db->list->pList->reqSize);
     if (readLen == 0) {
         UsbdBulkASyncReqNodeSetNoUse(db);
         HDF_LOGE("%{public}s:%{public}d readLen:%{public}d", __func__, __LINE__, readLen);
@@ -2994,13 +3037,229 @@ static int32_t UsbdBulkReadASyncSubmitStart(struct UsbdBulkASyncList *list)
                 break;
             }
         }
-        if (++i > USBD_BULKASYNCREQ_NUM_MAX) {
+        if (++i >= list->queueDepth) {
             break;
         }
     } while (!DListIsEmpty(&list->rList.eList));
     return ret;
 }
 
+static struct UsbdBulkStreamHeader *UsbdBulkStreamGetHeader(struct UsbdBulkASyncList *list)
+{
+    if ((!list->stream) || (list->asmHandle.size < 1) || (list->asmHandle.starAddr == NULL)) {
+        return NULL;
+    }
+    return (struct UsbdBulkStreamHeader *)list->asmHandle.starAddr;
+}
+
+/*
+ * Read completions land in the request buffer, which the DDK maps from usbfs so the controller writes it
+ * directly, and are copied once into the ring here. Handing the ring slot to the urb would not save that
+ * copy: usbfs would bounce the transfer through a kernel buffer and copy it out instead.
+ */
+static void UsbdBulkStreamCopyToRing(struct UsbdBulkStreamHeader *header, uint32_t pos, const uint8_t *buffer,
+    uint32_t len)
+{
+    uint8_t *ring = (uint8_t *)header + header->headerSize;
+    uint32_t offset = pos & (header->ringSize - 1);
+    uint32_t first = (header->ringSize - offset) < len ? (header->ringSize - offset) : len;
+    memcpy_s(ring + offset, header->ringSize - offset, buffer, first);
+    if (first < len) {
+        memcpy_s(ring, header->ringSize, buffer + first, len - first);
+    }
+}
+
+static void UsbdBulkStreamReadCallback(struct UsbRequest *request);
+static void UsbdBulkStreamWriteCallback(struct UsbRequest *request);
+
+static int32_t UsbdBulkStreamSubmitNode(struct UsbdBulkASyncList *list, uint8_t *buffer, uint32_t len)
+{
+    struct UsbdBulkASyncReqNode *node = UsbdBulkASyncReqGetENode(&list->rList);
+    if (node == NULL) {
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    struct UsbRequestParams params;
+    memcpy_s(&params, sizeof(params), &list->params, sizeof(params));
+    params.dataReq.buffer = buffer;
+    params.dataReq.length = len;
+    params.userData = (void *)node;
+    params.callback = (list->pipe.pipeDirection == USB_PIPE_DIRECTION_OUT) ? UsbdBulkStreamWriteCallback :
+        UsbdBulkStreamReadCallback;
+    node->request->compInfo.status = 0;
+    int32_t ret = UsbFillRequest(node->request, list->ifHandle, &params);
+    if (HDF_SUCCESS == ret) {
+        ret = UsbSubmitRequestAsync(node->request);
+    }
+    if (HDF_SUCCESS != ret) {
+        HDF_LOGE("%{public}s:%{public}d submit len:%{public}u ret:%{public}d", __func__, __LINE__, len, ret);
+        UsbdBulkASyncReqNodeSetNoUse(node);
+    }
+    return ret;
+}
+
+static int32_t UsbdBulkStreamReadSubmit(struct UsbdBulkASyncList *list)
+{
+    int32_t ret = HDF_SUCCESS;
+    while (ret == HDF_SUCCESS) {
+        OsalMutexLock(&list->asmHandle.lock);
+        struct UsbdBulkStreamHeader *header = UsbdBulkStreamGetHeader(list);
+        if ((header == NULL) || (header->status != HDF_SUCCESS) || (list->inflight >= list->queueDepth)) {
+            OsalMutexUnlock(&list->asmHandle.lock);
+            break;
+        }
+        uint32_t consumer = __atomic_load_n(&header->consumer, __ATOMIC_SEQ_CST);
+        if (header->ringSize - (list->streamPos - consumer) < list->reqSize) {
+            /* Ring full, ask the client to kick us once it has consumed, then recheck to close the race. */
+            __atomic_store_n(&header->flags, USBD_BULK_STREAM_FLAG_WAIT, __ATOMIC_SEQ_CST);
+            consumer = __atomic_load_n(&header->consumer, __ATOMIC_SEQ_CST);
+            if (header->ringSize - (list->streamPos - consumer) < list->reqSize) {
+                list->stats.waits++;
+                OsalMutexUnlock(&list->asmHandle.lock);
+                break;
+            }
+            __atomic_store_n(&header->flags, 0, __ATOMIC_SEQ_CST);
+        }
+        list->streamPos += list->reqSize;
+        list->inflight++;
+        OsalMutexUnlock(&list->asmHandle.lock);
+
+        ret = UsbdBulkStreamSubmitNode(list, NULL, list->reqSize);
+        if (HDF_SUCCESS != ret) {
+            OsalMutexLock(&list->asmHandle.lock);
+            list->streamPos -= list->reqSize;
+            list->inflight--;
+            OsalMutexUnlock(&list->asmHandle.lock);
+        }
+    }
+    return (ret == HDF_ERR_DEVICE_BUSY) ? HDF_SUCCESS : ret;
+}
+
+static int32_t UsbdBulkStreamWriteSubmit(struct UsbdBulkASyncList *list)
+{
+    int32_t ret = HDF_SUCCESS;
+    while (ret == HDF_SUCCESS) {
+        OsalMutexLock(&list->asmHandle.lock);
+        struct UsbdBulkStreamHeader *header = UsbdBulkStreamGetHeader(list);
+        if ((header == NULL) || (header->status != HDF_SUCCESS) || (list->inflight >= list->queueDepth)) {
+            OsalMutexUnlock(&list->asmHandle.lock);
+            break;
+        }
+        uint32_t producer = __atomic_load_n(&header->producer, __ATOMIC_SEQ_CST);
+        if (producer == list->streamPos) {
+            /* Nothing queued, ask the client to kick us once it has produced, then recheck. */
+            __atomic_store_n(&header->flags, USBD_BULK_STREAM_FLAG_WAIT, __ATOMIC_SEQ_CST);
+            producer = __atomic_load_n(&header->producer, __ATOMIC_SEQ_CST);
+            if (producer == list->streamPos) {
+                list->stats.waits++;
+                OsalMutexUnlock(&list->asmHandle.lock);
+                break;
+            }
+            __atomic_store_n(&header->flags, 0, __ATOMIC_SEQ_CST);
+        }
+        uint32_t offset = list->streamPos & (header->ringSize - 1);
+        uint32_t len = producer - list->streamPos;
+        len = len < list->reqSize ? len : list->reqSize;
+        len = len < (header->ringSize - offset) ? len : (header->ringSize - offset);
+        uint8_t *buffer = (uint8_t *)header + header->headerSize + offset;
+        list->streamPos += len;
+        list->inflight++;
+        OsalMutexUnlock(&list->asmHandle.lock);
+
+        ret = UsbdBulkStreamSubmitNode(list, buffer, len);
+        if (HDF_SUCCESS != ret) {
+            OsalMutexLock(&list->asmHandle.lock);
+            list->streamPos -= len;
+            list->inflight--;
+            OsalMutexUnlock(&list->asmHandle.lock);
+        }
+    }
+    return (ret == HDF_ERR_DEVICE_BUSY) ? HDF_SUCCESS : ret;
+}
+
+static void UsbdBulkStreamReadCallback(struct UsbRequest *request)
+{
+    if (!request) {
+        return;
+    }
+    struct UsbdBulkASyncReqNode *node = (struct UsbdBulkASyncReqNode *)request->compInfo.userData;
+    struct UsbdBulkASyncList *list = node->list->pList;
+    int32_t status = request->compInfo.status;
+    uint32_t actLength = request->compInfo.actualLength;
+    bool notify = false;
+    struct HdfRemoteService *cb = NULL;
+
+    OsalMutexLock(&list->asmHandle.lock);
+    struct UsbdBulkStreamHeader *header = UsbdBulkStreamGetHeader(list);
+    list->inflight = (list->inflight > 0) ? (list->inflight - 1) : 0;
+    if (header != NULL) {
+        actLength = (status == 0) ? (actLength < list->reqSize ? actLength : list->reqSize) : 0;
+        uint32_t producer = header->producer;
+        if (actLength > 0) {
+            UsbdBulkStreamCopyToRing(header, producer, request->compInfo.buffer, actLength);
+            __atomic_store_n(&header->producer, producer + actLength, __ATOMIC_SEQ_CST);
+            /* Only wake the client when it had drained the ring, otherwise it is still consuming. */
+            notify = (__atomic_load_n(&header->consumer, __ATOMIC_SEQ_CST) == producer);
+        }
+        list->streamPos -= list->reqSize - actLength;
+        if ((status != 0) && (header->status == HDF_SUCCESS)) {
+            header->status = status;
+            notify = true;
+        }
+    }
+    /* count the bytes that reached the ring, a completion after cancel has nowhere to go */
+    UsbdBulkStatsAdd(list, status, (header != NULL) ? actLength : 0);
+    /* cancel may clear the callback once the lock is dropped */
+    cb = list->cb;
+    OsalMutexUnlock(&list->asmHandle.lock);
+    UsbdBulkASyncReqNodeSetNoUse(node);
+
+    if (notify && (cb != NULL)) {
+        UsbdBulkRemoteCallbackDispatch(cb, CMD_USBD_BULK_CALLBACK_READ, status, (int32_t)actLength);
+    }
+    if ((header != NULL) && (status == 0)) {
+        UsbdBulkStreamReadSubmit(list);
+    }
+}
+
+static void UsbdBulkStreamWriteCallback(struct UsbRequest *request)
+{
+    if (!request) {
+        return;
+    }
+    struct UsbdBulkASyncReqNode *node = (struct UsbdBulkASyncReqNode *)request->compInfo.userData;
+    struct UsbdBulkASyncList *list = node->list->pList;
+    int32_t status = request->compInfo.status;
+    uint32_t actLength = request->compInfo.actualLength;
+    bool notify = false;
+    struct HdfRemoteService *cb = NULL;
+
+    OsalMutexLock(&list->asmHandle.lock);
+    UsbdBulkStatsAdd(list, status, actLength);
+    struct UsbdBulkStreamHeader *header = UsbdBulkStreamGetHeader(list);
+    list->inflight = (list->inflight > 0) ? (list->inflight - 1) : 0;
+    if (header != NULL) {
+        uint32_t consumer = header->consumer + request->compInfo.length;
+        __atomic_store_n(&header->consumer, consumer, __ATOMIC_SEQ_CST);
+        /* Wake the client once everything it queued is on the wire. */
+        notify = (__atomic_load_n(&header->producer, __ATOMIC_SEQ_CST) == consumer);
+        if ((status != 0) && (header->status == HDF_SUCCESS)) {
+            header->status = status;
+            notify = true;
+        }
+    }
+    /* cancel may clear the callback once the lock is dropped */
+    cb = list->cb;
+    OsalMutexUnlock(&list->asmHandle.lock);
+    UsbdBulkASyncReqNodeSetNoUse(node);
+
+    if (notify && (cb != NULL)) {
+        UsbdBulkRemoteCallbackDispatch(cb, CMD_USBD_BULK_CALLBACK_WRITE, status, (int32_t)actLength);
+    }
+    if ((header != NULL) && (status == 0)) {
+        UsbdBulkStreamWriteSubmit(list);
+    }
+}
+
 static int32_t FunRegBulkCallback(struct HostDevice *port, struct HdfSBuf *data, struct HdfSBuf *reply)
 {
     uint8_t interfaceId = 0;
@@ -3023,16 +3282,19 @@ static int32_t FunRegBulkCallback(struct HostDevice *port, struct HdfSBuf *data,
             __func__, __LINE__, interfaceId, pipeId);
         return HDF_DEV_ERR_DEV_INIT_FAIL;
     }
-    list->cb = HdfSbufReadRemoteService(data);
-    if (!list->cb) {
+    struct HdfRemoteService *cb = HdfSbufReadRemoteService(data);
+    if (!cb) {
         HDF_LOGE("%{public}s:%{public}d get callback error", __func__, __LINE__);
         return HDF_ERR_IO;
     }
-    if (!HdfRemoteServiceSetInterfaceDesc(list->cb, USB_TOKEN_VALUE)) {
+    if (!HdfRemoteServiceSetInterfaceDesc(cb, USB_TOKEN_VALUE)) {
         HDF_LOGE("%{public}s: failed to init interface desc", __func__);
-        HdfRemoteServiceRecycle(list->cb);
+        HdfRemoteServiceRecycle(cb);
         return HDF_ERR_IO;
     }
+    OsalMutexLock(&list->asmHandle.lock);
+    list->cb = cb;
+    OsalMutexUnlock(&list->asmHandle.lock);
     return HDF_SUCCESS;
 }
 
@@ -3057,7 +3319,9 @@ static int32_t FunUnRegBulkCallback(struct HostDevice *port, struct HdfSBuf *dat
         HDF_LOGW("%{public}s:%{public}d fail ifId:%{public}d epId:%{public}d", __func__, __LINE__, interfaceId, pipeId);
         return HDF_SUCCESS;
     }
+    OsalMutexLock(&list->asmHandle.lock);
     list->cb = NULL;
+    OsalMutexUnlock(&list->asmHandle.lock);
     return HDF_SUCCESS;
 }
 
@@ -3090,6 +3354,13 @@ static void ReleaseAsmBufferHandle(struct UsbdBufferHandle *handle)
     handle->starAddr = NULL;
 }
 
+static void UsbdBulkASyncListStopStream(struct UsbdBulkASyncList *list)
+{
+    OsalMutexLock(&list->asmHandle.lock);
+    list->stream = false;
+    OsalMutexUnlock(&list->asmHandle.lock);
+}
+
 static int32_t BulkRequestCancel(struct UsbdBulkASyncList *list)
 {
     int32_t ret = HDF_SUCCESS;
@@ -3098,14 +3369,14 @@ static int32_t BulkRequestCancel(struct UsbdBulkASyncList *list)
         return HDF_ERR_INVALID_PARAM;
     }
 
-    for (int32_t i = 0; i < USBD_BULKASYNCREQ_NUM_MAX; ++i) {
+    for (uint32_t i = 0; i < list->rList.reqNum; ++i) {
         if ((list->rList.node[i].use == USBD_REQNODE_USE) || (list->rList.node[i].use == USBD_REQNODE_OTHER)) {
             ret = UsbCancelRequest(list->rList.node[i].request);
         }
     }
     OsalMSleep(USB_BULK_CANCEL_SLEEP_TIME);
 
-    for (int32_t i = 0; i < USBD_BULKASYNCREQ_NUM_MAX; ++i) {
+    for (uint32_t i = 0; i < list->rList.reqNum; ++i) {
         list->rList.node[i].request->compInfo.status = 0;
         if ((list->rList.node[i].use == USBD_REQNODE_USE) || (list->rList.node[i].use == USBD_REQNODE_OTHER)) {
             list->rList.node[i].request->compInfo.status = 0;
@@ -3138,11 +3409,21 @@ static int32_t FunBulkCancel(struct HostDevice *port, struct HdfSBuf *data, stru
             __func__, __LINE__, interfaceId, pipeId);
         return HDF_SUCCESS;
     }
+    OsalMutexLock(&list->asmHandle.lock);
     tcb = list->cb;
     list->cb = NULL;
+    OsalMutexUnlock(&list->asmHandle.lock);
+    UsbdBulkASyncListStopStream(list);
     ReleaseAsmBufferHandle(&list->asmHandle);
     BulkRequestCancel(list);
+    OsalMutexLock(&list->asmHandle.lock);
+    list->inflight = 0;
     list->cb = tcb;
+    OsalMutexUnlock(&list->asmHandle.lock);
+    HDF_LOGI("%{public}s:%{public}d ifId:%{public}hhu epId:%{public}hhu bytes:%{public}" PRIu64
+        " requests:%{public}" PRIu64 " errors:%{public}" PRIu64 " waits:%{public}" PRIu64,
+        __func__, __LINE__, interfaceId, pipeId, list->stats.bytes, list->stats.requests, list->stats.errors,
+        list->stats.waits);
     return HDF_SUCCESS;
 }
 
@@ -3221,6 +3502,7 @@ static int32_t FunBulkRead(struct HostDevice *port, struct HdfSBuf *data, struct
         HDF_LOGE("%{public}s:%{public}d fail ifId:%{public}hhu epId:%{public}hhu", __func__, __LINE__, ifId, epId);
         return HDF_ERR_MALLOC_FAIL;
     }
+    UsbdBulkASyncListStopStream(list);
     ret = InitAsmBufferHandle(&list->asmHandle, fd, size);
     if (HDF_SUCCESS != ret) {
         HDF_LOGE(
@@ -3229,6 +3511,7 @@ static int32_t FunBulkRead(struct HostDevice *port, struct HdfSBuf *data, struct
             __func__, __LINE__, ret, fd, size);
         return ret;
     }
+    UsbdBulkStatsStart(list);
     ret = UsbdBulkReadASyncSubmitStart(list);
     if ((HDF_DEV_ERR_NODATA == ret) || (HDF_DEV_ERR_NO_MEMORY == ret) || (HDF_ERR_DEVICE_BUSY == ret)) {
         ret = HDF_SUCCESS;
@@ -3264,6 +3547,7 @@ static int32_t FunBulkWrite(struct HostDevice *port, struct HdfSBuf *data, struc
         HDF_LOGE("%{public}s:%{public}d fail ifId:%{public}d epId:%{public}d", __func__, __LINE__, ifId, epId);
         return HDF_ERR_MALLOC_FAIL;
     }
+    UsbdBulkASyncListStopStream(list);
     ret = InitAsmBufferHandle(&list->asmHandle, fd, size);
     if (HDF_SUCCESS != ret) {
         HDF_LOGE(
@@ -3272,6 +3556,7 @@ static int32_t FunBulkWrite(struct HostDevice *port, struct HdfSBuf *data, struc
             __func__, __LINE__, ret, fd, size);
         return ret;
     }
+    UsbdBulkStatsStart(list);
     ret = UsbdBulkASyncWriteSubmitStart(list);
     if ((HDF_DEV_ERR_NODATA == ret) || (HDF_DEV_ERR_NO_MEMORY == ret) || (HDF_ERR_DEVICE_BUSY == ret)) {
         ret = HDF_SUCCESS;
@@ -3286,6 +3571,241 @@ static int32_t FunBulkWrite(struct HostDevice *port, struct HdfSBuf *data, struc
     return ret;
 }
 
+/* A stream never has more than queueDepth requests in flight, so only that many are kept at reqSize. */
+static int32_t UsbdBulkASyncReqResize(struct UsbdBulkASyncList *list, uint32_t reqSize, uint32_t reqNum)
+{
+    struct UsbdBulkASyncReqList *rList = &list->rList;
+    struct UsbRequest *requests[USBD_BULKASYNCREQ_NUM_MAX] = {NULL};
+    if ((reqSize == list->reqSize) && (reqNum == rList->reqNum)) {
+        return HDF_SUCCESS;
+    }
+    if (DListGetCount(&rList->eList) != (int32_t)rList->reqNum) {
+        HDF_LOGE("%{public}s:%{public}d requests still in flight", __func__, __LINE__);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    for (uint32_t i = 0; i < reqNum; ++i) {
+        requests[i] = UsbAllocRequest(list->ifHandle, 0, reqSize);
+        if (requests[i] == NULL) {
+            /* Nothing is replaced yet, keep the old requests. */
+            HDF_LOGE("%{public}s:%{public}d alloc request failed i:%{public}u", __func__, __LINE__, i);
+            for (uint32_t j = 0; j < i; ++j) {
+                UsbFreeRequest(requests[j]);
+            }
+            return HDF_ERR_MALLOC_FAIL;
+        }
+    }
+    OsalMutexLock(&rList->elock);
+    DListHeadInit(&rList->eList);
+    for (uint32_t i = 0; i < USBD_BULKASYNCREQ_NUM_MAX; ++i) {
+        if (i < rList->reqNum) {
+            UsbFreeRequest(rList->node[i].request);
+        }
+        rList->node[i].request = requests[i];
+        if (i < reqNum) {
+            DListInsertTail(&rList->node[i].node, &rList->eList);
+        }
+    }
+    rList->reqNum = reqNum;
+    OsalMutexUnlock(&rList->elock);
+    list->reqSize = reqSize;
+    return HDF_SUCCESS;
+}
+
+static int32_t FunBulkStreamConfig(struct HostDevice *port, struct HdfSBuf *data, struct HdfSBuf *reply)
+{
+    uint8_t interfaceId = 0;
+    uint8_t pipeId = 0;
+    uint32_t reqSize = 0;
+    uint32_t queueDepth = 0;
+    if ((port == NULL) || (data == NULL)) {
+        HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (!HdfSbufReadUint8(data, &interfaceId) || !HdfSbufReadUint8(data, &pipeId)) {
+        HDF_LOGE("%{public}s:%{public}d get pipe error", __func__, __LINE__);
+        return HDF_ERR_IO;
+    }
+    if (!HdfSbufReadUint32(data, &reqSize) || !HdfSbufReadUint32(data, &queueDepth)) {
+        HDF_LOGE("%{public}s:%{public}d get config error", __func__, __LINE__);
+        return HDF_ERR_IO;
+    }
+    if ((reqSize < 1) || (reqSize > USBD_BULK_STREAM_REQ_SIZE_MAX) || (queueDepth < 1) ||
+        (queueDepth > USBD_BULK_STREAM_DEPTH_MAX) || (queueDepth > USBD_BULKASYNCREQ_NUM_MAX)) {
+        HDF_LOGE("%{public}s:%{public}d invalid reqSize:%{public}u queueDepth:%{public}u", __func__, __LINE__,
+            reqSize, queueDepth);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    struct UsbdBulkASyncList *list = UsbdBulkASyncListInit(port, interfaceId, pipeId);
+    if (!list) {
+        HDF_LOGE("%{public}s:%{public}d fail ifId:%{public}hhu epId:%{public}hhu", __func__, __LINE__, interfaceId,
+            pipeId);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    /* Keep IN requests a whole number of packets so a full request never ends in a babble. */
+    uint32_t maxPacketSize = list->pipe.maxPacketSize;
+    if ((maxPacketSize > 0) && (reqSize > maxPacketSize)) {
+        reqSize -= reqSize % maxPacketSize;
+    }
+    int32_t ret = UsbdBulkASyncReqResize(list, reqSize, queueDepth);
+    if (HDF_SUCCESS != ret) {
+        return ret;
+    }
+    list->queueDepth = queueDepth;
+    HDF_LOGI("%{public}s:%{public}d ifId:%{public}hhu epId:%{public}hhu reqSize:%{public}u queueDepth:%{public}u",
+        __func__, __LINE__, interfaceId, pipeId, list->reqSize, list->queueDepth);
+    return HDF_SUCCESS;
+}
+
+static int32_t UsbdBulkStreamCheckHeader(const struct UsbdBulkStreamHeader *header, int32_t size, uint32_t reqSize)
+{
+    if (header->magic != USBD_BULK_STREAM_MAGIC) {
+        HDF_LOGE("%{public}s:%{public}d bad magic:%{public}x", __func__, __LINE__, header->magic);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if ((header->headerSize < sizeof(struct UsbdBulkStreamHeader)) || (header->ringSize < reqSize) ||
+        ((header->ringSize & (header->ringSize - 1)) != 0) ||
+        ((uint64_t)header->headerSize + header->ringSize > (uint64_t)size)) {
+        HDF_LOGE("%{public}s:%{public}d bad layout headerSize:%{public}u ringSize:%{public}u size:%{public}d",
+            __func__, __LINE__, header->headerSize, header->ringSize, size);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t FunBulkStreamStart(struct HostDevice *port, struct HdfSBuf *data, bool write)
+{
+    int32_t fd = -1;
+    int32_t size = 0;
+    uint8_t ifId = 0;
+    uint8_t epId = 0;
+    if ((port == NULL) || (data == NULL)) {
+        HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    int32_t ret = UsbdGetBulkParams(data, &ifId, &epId, &fd, &size);
+    if (HDF_SUCCESS != ret) {
+        HDF_LOGE("%{public}s:%{public}d UsbdGetBulkParams error ret:%{public}d", __func__, __LINE__, ret);
+        return ret;
+    }
+    struct UsbdBulkASyncList *list = UsbdBulkASyncListInit(port, ifId, epId);
+    if (!list) {
+        HDF_LOGE("%{public}s:%{public}d fail ifId:%{public}hhu epId:%{public}hhu", __func__, __LINE__, ifId, epId);
+        close(fd);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    if ((list->pipe.pipeDirection == USB_PIPE_DIRECTION_OUT) != write) {
+        HDF_LOGE("%{public}s:%{public}d pipe direction mismatch epId:%{public}hhu", __func__, __LINE__, epId);
+        close(fd);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if ((size < (int32_t)sizeof(struct UsbdBulkStreamHeader)) ||
+        (DListGetCount(&list->rList.eList) != (int32_t)list->rList.reqNum)) {
+        HDF_LOGE("%{public}s:%{public}d size:%{public}d or requests busy", __func__, __LINE__, size);
+        close(fd);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    UsbdBulkASyncListStopStream(list);
+    ret = InitAsmBufferHandle(&list->asmHandle, fd, size);
+    if (HDF_SUCCESS != ret) {
+        HDF_LOGE("%{public}s:%{public}d InitAsmBufferHandle error ret:%{public}d", __func__, __LINE__, ret);
+        return ret;
+    }
+    struct UsbdBulkStreamHeader *header = (struct UsbdBulkStreamHeader *)list->asmHandle.starAddr;
+    ret = UsbdBulkStreamCheckHeader(header, size, list->reqSize);
+    if (HDF_SUCCESS != ret) {
+        ReleaseAsmBufferHandle(&list->asmHandle);
+        return ret;
+    }
+
+    OsalMutexLock(&list->asmHandle.lock);
+    header->status = HDF_SUCCESS;
+    __atomic_store_n(&header->flags, 0, __ATOMIC_SEQ_CST);
+    list->streamPos = write ? header->consumer : header->producer;
+    list->inflight = 0;
+    list->stream = true;
+    OsalMutexUnlock(&list->asmHandle.lock);
+    UsbdBulkStatsStart(list);
+
+    ret = write ? UsbdBulkStreamWriteSubmit(list) : UsbdBulkStreamReadSubmit(list);
+    if (HDF_SUCCESS != ret) {
+        HDF_LOGE("%{public}s:%{public}d submit error ret:%{public}d", __func__, __LINE__, ret);
+    }
+    return ret;
+}
+
+static int32_t FunBulkStreamRead(struct HostDevice *port, struct HdfSBuf *data, struct HdfSBuf *reply)
+{
+    return FunBulkStreamStart(port, data, false);
+}
+
+static int32_t FunBulkStreamWrite(struct HostDevice *port, struct HdfSBuf *data, struct HdfSBuf *reply)
+{
+    return FunBulkStreamStart(port, data, true);
+}
+
+static int32_t FunBulkStreamKick(struct HostDevice *port, struct HdfSBuf *data, struct HdfSBuf *reply)
+{
+    uint8_t interfaceId = 0;
+    uint8_t pipeId = 0;
+    if ((port == NULL) || (data == NULL)) {
+        HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (!HdfSbufReadUint8(data, &interfaceId) || !HdfSbufReadUint8(data, &pipeId)) {
+        HDF_LOGE("%{public}s:%{public}d get pipe error", __func__, __LINE__);
+        return HDF_ERR_IO;
+    }
+    struct UsbdBulkASyncList *list = UsbdBulkASyncListFind(port, interfaceId, pipeId);
+    bool stream = false;
+    if (list != NULL) {
+        /* The stream may be stopped or restarted by another caller, the submitters check it again. */
+        OsalMutexLock(&list->asmHandle.lock);
+        stream = list->stream;
+        OsalMutexUnlock(&list->asmHandle.lock);
+    }
+    if (!stream) {
+        HDF_LOGE("%{public}s:%{public}d no stream ifId:%{public}hhu epId:%{public}hhu", __func__, __LINE__,
+            interfaceId, pipeId);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    if (list->pipe.pipeDirection == USB_PIPE_DIRECTION_OUT) {
+        return UsbdBulkStreamWriteSubmit(list);
+    }
+    return UsbdBulkStreamReadSubmit(list);
+}
+
+static int32_t FunGetBulkStats(struct HostDevice *port, struct HdfSBuf *data, struct HdfSBuf *reply)
+{
+    uint8_t interfaceId = 0;
+    uint8_t pipeId = 0;
+    struct UsbdBulkStats stats;
+    if ((port == NULL) || (data == NULL) || (reply == NULL)) {
+        HDF_LOGE("%{public}s:%{public}d invalid param", __func__, __LINE__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (!HdfSbufReadUint8(data, &interfaceId) || !HdfSbufReadUint8(data, &pipeId)) {
+        HDF_LOGE("%{public}s:%{public}d get pipe error", __func__, __LINE__);
+        return HDF_ERR_IO;
+    }
+    struct UsbdBulkASyncList *list = UsbdBulkASyncListFind(port, interfaceId, pipeId);
+    if (!list) {
+        HDF_LOGE("%{public}s:%{public}d no list ifId:%{public}hhu epId:%{public}hhu", __func__, __LINE__,
+            interfaceId, pipeId);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    OsalMutexLock(&list->asmHandle.lock);
+    stats = list->stats;
+    stats.elapsedMs = (list->statsStartTime == 0) ? 0 : (OsalGetSysTimeMs() - list->statsStartTime);
+    OsalMutexUnlock(&list->asmHandle.lock);
+    if (!HdfSbufWriteUint64(reply, stats.bytes) || !HdfSbufWriteUint64(reply, stats.requests) ||
+        !HdfSbufWriteUint64(reply, stats.errors) || !HdfSbufWriteUint64(reply, stats.waits) ||
+        !HdfSbufWriteUint64(reply, stats.elapsedMs)) {
+        HDF_LOGE("%{public}s:%{public}d write stats failed", __func__, __LINE__);
+        return HDF_ERR_IO;
+    }
+    return HDF_SUCCESS;
+}
+
 static int32_t DispatchCheckParam(struct HdfDeviceIoClient *client)
 {
     if (client == NULL) {
@@ -3342,6 +3862,16 @@ int32_t DispatchSwitchHost(int32_t cmd, struct UsbdService *service, struct Host
             return FunUnRegBulkCallback(port, data, reply);
         case CMD_FUN_BULK_CANCEL:
             return FunBulkCancel(port, data, reply);
+        case CMD_FUN_BULK_STREAM_CONFIG:
+            return FunBulkStreamConfig(port, data, reply);
+        case CMD_FUN_BULK_STREAM_READ:
+            return FunBulkStreamRead(port, data, reply);
+        case CMD_FUN_BULK_STREAM_WRITE:
+            return FunBulkStreamWrite(port, data, reply);
+        case CMD_FUN_BULK_STREAM_KICK:
+            return FunBulkStreamKick(port, data, reply);
+        case CMD_FUN_GET_BULK_STATS:
+            return FunGetBulkStats(port, data, reply);
         default:
             return HDF_ERR_NOT_SUPPORT;
     }
@@ -3374,7 +3904,8 @@ int32_t DispatchSwitch(int32_t cmd, struct UsbdService *service, struct HostDevi
         cmd == CMD_FUN_SEND_INTERRUPT_READ_SYNC || cmd == CMD_FUN_SEND_ISO_READ_SYNC ||
         cmd == CMD_FUN_SEND_BULK_WRITE_SYNC || cmd == CMD_FUN_SEND_INTERRUPT_WRITE_SYNC ||
         cmd == CMD_FUN_SEND_ISO_WRITE_SYNC || cmd == CMD_FUN_GET_DESCRIPTOR || cmd == CMD_FUN_REG_BULK_CALLBACK ||
-        cmd == CMD_FUN_UNREG_BULK_CALLBACK || cmd == CMD_FUN_BULK_CANCEL || cmd == CMD_FUN_GET_FILEDESCRIPTOR) {
+        cmd == CMD_FUN_UNREG_BULK_CALLBACK || cmd == CMD_FUN_BULK_CANCEL || cmd == CMD_FUN_GET_FILEDESCRIPTOR ||
+        (cmd >= CMD_FUN_BULK_STREAM_CONFIG && cmd <= CMD_FUN_GET_BULK_STATS)) {
         return DispatchSwitchHost(cmd, service, port, data, reply);
     }
     if (cmd == CMD_SET_ROLE || cmd == CMD_QUERY_PORT || cmd == CMD_FUN_GET_CURRENT_FUNCTIONS ||
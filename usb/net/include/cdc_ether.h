@@ -21,7 +21,7 @@
 #include "osal_atomic.h"
 #include "usb_session.h"
 #include "usb_interface_pool.h"
-#include "data_fifo.h"
+#include "ecm_frame_ring.h"
 
 #define ECM_NW  16
 #define ECM_NR  16
@@ -29,7 +29,8 @@
 #define REQUEST_TYPE_MASK       0x3
 #define DIRECTION_MASK          0x1
 #define USB_CTRL_SET_TIMEOUT    5000
-#define READ_BUF_SIZE           8192
+/* largest Ethernet frame without FCS, one frame per bulk transfer */
+#define ECM_MAX_FRAME_SIZE      1514
 #define USB_MAX_INTERFACES      32
 #define ETHER_SLEEP_TIME        100000
 #define ETHER_SLEEP_MS_TIME     2
@@ -102,7 +103,7 @@ struct EcmDevice {
     UsbInterfaceHandle *devHandle[USB_MAX_INTERFACES];
     UsbInterfaceHandle *ctrDevHandle;
     struct UsbSession *session;
-    struct DataFifo readFifo;
+    struct EcmFrameRing readRing;
     uint32_t nbIndex;
     uint32_t nbSize;
     int32_t transmitting;
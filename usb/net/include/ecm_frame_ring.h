@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HDF_USB_ECM_FRAME_RING_H
+#define HDF_USB_ECM_FRAME_RING_H
+
+#include "hdf_base.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* must be a power of two and not less than the number of read requests */
+#define ECM_FRAME_RING_SIZE     32
+
+/*
+ * A received Ethernet frame. The data stays in the completed request buffer
+ * until the reader releases the frame, which hands the request back.
+ */
+struct EcmFrame {
+    void *owner;
+    uint8_t *data;
+    uint32_t len;
+};
+
+typedef int32_t (*EcmFrameReleaseFunc)(void *owner, void *priv);
+
+/* Push, Get and Flush must be serialised by the caller, Release may run unlocked. */
+struct EcmFrameRing {
+    struct EcmFrame frames[ECM_FRAME_RING_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+    EcmFrameReleaseFunc release;
+    void *priv;
+};
+
+void EcmFrameRingInit(struct EcmFrameRing *ring, EcmFrameReleaseFunc release, void *priv);
+uint32_t EcmFrameRingCount(const struct EcmFrameRing *ring);
+int32_t EcmFrameRingPush(struct EcmFrameRing *ring, void *owner, uint8_t *data, uint32_t len);
+int32_t EcmFrameRingGet(struct EcmFrameRing *ring, struct EcmFrame *frame);
+int32_t EcmFrameRingRelease(const struct EcmFrameRing *ring, const struct EcmFrame *frame);
+uint32_t EcmFrameRingFlush(struct EcmFrameRing *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
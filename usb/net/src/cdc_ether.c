@@ -79,24 +79,33 @@ static UsbInterfaceHandle *InterfaceIdToHandle(const struct EcmDevice *ecm, uint
     return devHandle;
 }
 
-static int32_t EcmAllocFifo(struct DataFifo *fifo, uint32_t size)
+/* Round the frame size up to whole packets so a full frame always ends the transfer. */
+static uint32_t EcmFrameBufSize(const struct UsbPipeInfo *pipe)
 {
-    if (!DataFifoIsInitialized(fifo)) {
-        void *data = OsalMemAlloc(size);
-        if (data == NULL) {
-            HDF_LOGE("%s: allocate fifo data buffer failed", __func__);
-            return HDF_ERR_MALLOC_FAIL;
-        }
-        DataFifoInit(fifo, size, data);
+    uint32_t packetSize = pipe->maxPacketSize;
+    if (packetSize == 0) {
+        return ECM_MAX_FRAME_SIZE;
     }
-    return HDF_SUCCESS;
+    return ((ECM_MAX_FRAME_SIZE + packetSize - 1) / packetSize) * packetSize;
 }
 
-static void EcmFreeFifo(struct DataFifo *fifo)
+/* Called when the reader is done with a frame: hand its request back to the device. */
+static int32_t EcmReadFrameRelease(void *owner, void *priv)
 {
-    void *buf = fifo->data;
-    OsalMemFree(buf);
-    DataFifoInit(fifo, 0, NULL);
+    int32_t ret;
+    struct UsbRequest *req = (struct UsbRequest *)owner;
+    struct EcmDevice *ecm = (struct EcmDevice *)priv;
+
+    if (!ecm->openFlag) {
+        return HDF_SUCCESS;
+    }
+    ret = UsbSubmitRequestAsync(req);
+    if (ret && ret != -EPERM) {
+        HDF_LOGE("%s - usb_submit_urb failed: %d\n", __func__, ret);
+    } else {
+        ecm->readReqNum++;
+    }
+    return ret;
 }
 
 static int32_t EcmWbIsAvail(struct EcmDevice *ecm)
@@ -267,14 +276,15 @@ static int32_t EcmCtrlMsg(struct EcmDevice *ecm, uint8_t request,
 
 static int32_t EcmRead(struct EcmDevice *ecm, struct HdfSBuf *reply)
 {
-    uint32_t len;
     int32_t ret = HDF_SUCCESS;
-    uint8_t *buf = NULL;
+    struct EcmFrame frame;
     if (ecm == NULL) {
         HDF_LOGE("%d: invalid parma", __LINE__);
         return HDF_ERR_INVALID_PARAM;
     }
+    OsalMutexLock(&ecm->readLock);
     if (!(ecm->openFlag)) {
+        OsalMutexUnlock(&ecm->readLock);
         return HDF_ERR_BAD_FD;
     }
 
@@ -282,36 +292,23 @@ static int32_t EcmRead(struct EcmDevice *ecm, struct HdfSBuf *reply)
         if(ecm->readReq[i]->compInfo.status != USB_REQUEST_COMPLETED) {
             HDF_LOGE("%s:%d i=%d status=%d!",
                 __func__, __LINE__, i, ecm->readReq[i]->compInfo.status);
+            OsalMutexUnlock(&ecm->readLock);
             return HDF_FAILURE;
         }
     }
-    OsalMutexLock(&ecm->readLock);
-    if (DataFifoIsEmpty(&ecm->readFifo)) {
+    if (EcmFrameRingGet(&ecm->readRing, &frame) != HDF_SUCCESS) {
         OsalMutexUnlock(&ecm->readLock);
         return 0;
     }
-    OsalMutexUnlock(&ecm->readLock);
-    buf = (uint8_t *)OsalMemCalloc(DataFifoLen(&ecm->readFifo) + sizeof(uint32_t));
-    if (buf == NULL) {
-        HDF_LOGE("%s: OsalMemCalloc error", __func__);
-        return HDF_ERR_MALLOC_FAIL;
-    }
-    OsalMutexLock(&ecm->readLock);
-    len = DataFifoRead(&ecm->readFifo, buf, DataFifoLen(&ecm->readFifo));
-    if (len == 0) {
-        HDF_LOGE("%s: no data", __func__);
-        ret = 0;
-        OsalMutexUnlock(&ecm->readLock);
-        goto OUT;
-    }
-    OsalMutexUnlock(&ecm->readLock);
-    bool bufok = HdfSbufWriteBuffer(reply, (const void *)buf, len);
+    /* one frame per reply, written straight from the request buffer. The lock is held until the request
+     * is given back, a close flushes the ring under it before the requests are freed. */
+    bool bufok = HdfSbufWriteBuffer(reply, (const void *)frame.data, frame.len);
     if (!bufok) {
         HDF_LOGE("EcmRead HdfSbufWriteBuffer err");
         ret = HDF_ERR_IO;
     }
-OUT:
-    OsalMemFree(buf);
+    (void)EcmFrameRingRelease(&ecm->readRing, &frame);
+    OsalMutexUnlock(&ecm->readLock);
     return ret;
 }
 
@@ -342,11 +339,7 @@ static int32_t EcmOpen(struct EcmDevice *ecm, struct HdfSBuf *data)
         return HDF_SUCCESS;
     }
 
-    ret = EcmAllocFifo(&ecm->readFifo, READ_BUF_SIZE);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: UsbSerialAllocFifo failed", __func__);
-        return  HDF_ERR_INVALID_PARAM;
-    }
+    EcmFrameRingInit(&ecm->readRing, EcmReadFrameRelease, ecm);
     ecm->openFlag = true;
     ecm->readReqNum = 0;
     ecm->writeReqNum = 0;
@@ -363,7 +356,6 @@ static int32_t EcmOpen(struct EcmDevice *ecm, struct HdfSBuf *data)
     }
     return HDF_SUCCESS;
 ERR:
-    EcmFreeFifo(&ecm->readFifo);
     return ret;
 }
 
@@ -397,9 +389,11 @@ static void EcmClostRelease(struct EcmDevice *ecm)
     }
 
     EcmFreeWriteReq(ecm);
-    EcmFreeReadReq(ecm);
-    EcmFreeFifo(&ecm->readFifo);
+    OsalMutexLock(&ecm->readLock);
+    (void)EcmFrameRingFlush(&ecm->readRing);
     ecm->openFlag = false;
+    OsalMutexUnlock(&ecm->readLock);
+    EcmFreeReadReq(ecm);
 }
 
 static int32_t EcmClose(struct EcmDevice *ecm, struct HdfSBuf *data)
@@ -426,53 +420,73 @@ static int32_t EcmClose(struct EcmDevice *ecm, struct HdfSBuf *data)
     return HDF_SUCCESS;
 }
 
+static int32_t EcmWriteFrame(struct EcmDevice *ecm, const uint8_t *frame, uint32_t len,
+    struct EcmWb **batch, int32_t *batchNum)
+{
+    int32_t wbn;
+    struct EcmWb *wb = NULL;
+
+    if (*batchNum >= ECM_NW || !EcmWbIsAvail(ecm)) {
+        HDF_LOGE("%s:%d no write buf", __func__, __LINE__);
+        return HDF_ERR_QUEUE_FULL;
+    }
+    wbn = EcmWbAlloc(ecm);
+    if (wbn >= ECM_NW || wbn < 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    wb = &ecm->wb[wbn];
+    if (wb->buf == NULL || memcpy_s(wb->buf, ecm->writeSize, frame, len) != EOK) {
+        OsalMutexLock(&ecm->writeLock);
+        wb->use = 0;
+        OsalMutexUnlock(&ecm->writeLock);
+        return HDF_ERR_IO;
+    }
+    wb->len = (int)len;
+    wb->ecm = ecm;
+    batch[(*batchNum)++] = wb;
+    return HDF_SUCCESS;
+}
+
+/*
+ * Each sbuf buffer is one Ethernet frame. ECM delimits frames by the end of a
+ * transfer, so frames are staged into write buffers first and then submitted
+ * back to back; oversized buffers are still split into writeSize chunks.
+ */
 static int32_t EcmWrite(struct EcmDevice *ecm, struct HdfSBuf *data)
 {
     uint32_t size;
-    uint32_t totalSize = 0;
-    int32_t ret;
-    uint8_t *tmp = NULL;
-    int32_t wbn;
     uint32_t len;
-    struct EcmWb *wb = NULL;
+    uint32_t totalSize = 0;
+    uint32_t queued = 0;
+    const uint8_t *tmp = NULL;
+    struct EcmWb *batch[ECM_NW];
+    int32_t batchNum = 0;
+    int32_t ret = HDF_SUCCESS;
 
     if (ecm == NULL || ecm->openFlag == false) {
         return HDF_ERR_BAD_FD;
     }
-    if (!HdfSbufReadBuffer(data, (const void **)&tmp, &totalSize)) {
+    if (!HdfSbufReadBuffer(data, (const void **)&tmp, &size)) {
         return HDF_ERR_IO;
     }
-    size = totalSize;
-    while (size != 0) {
-        if (EcmWbIsAvail(ecm)) {
-            wbn = EcmWbAlloc(ecm);
-        } else {
-            HDF_LOGE("%s:%d no write buf", __func__, __LINE__);
-            return size;
-        }
-        if (wbn < ECM_NW && wbn >= 0) {
-            wb = &ecm->wb[wbn];
-        }
-        if (wb == NULL) {
-            return HDF_ERR_INVALID_PARAM;
-        }
-        if (size > ecm->writeSize) {
-            len = ecm->writeSize;
-            size -= ecm->writeSize;
-        } else {
-            len = size;
-            size = 0;
-        }
-        if (wb->buf) {
-            ret = memcpy_s(wb->buf, ecm->writeSize, tmp, len);
-            if (ret) {
-                return size;
+    do {
+        totalSize += size;
+        while ((size != 0) && (ret == HDF_SUCCESS)) {
+            len = (size > ecm->writeSize) ? ecm->writeSize : size;
+            ret = EcmWriteFrame(ecm, tmp, len, batch, &batchNum);
+            if (ret == HDF_SUCCESS) {
+                tmp += len;
+                size -= len;
+                queued += len;
             }
-            tmp += len;
-            wb->len = (int)len;
-            wb->ecm = ecm;
-            ret = EcmStartWb(ecm, wb);
         }
+    } while ((ret == HDF_SUCCESS) && HdfSbufReadBuffer(data, (const void **)&tmp, &size));
+
+    for (int32_t i = 0; i < batchNum; i++) {
+        (void)EcmStartWb(ecm, batch[i]);
+    }
+    if (queued != totalSize) {
+        return totalSize - queued;
     }
     return totalSize;
 }
@@ -665,8 +679,8 @@ static int32_t EcmGetPipes(struct EcmDevice *ecm)
         goto ERROR;
     }
 
-    ecm->readSize  = ecm->dataInPipe->maxPacketSize;
-    ecm->writeSize = ecm->dataOutPipe->maxPacketSize;
+    ecm->readSize  = EcmFrameBufSize(ecm->dataInPipe);
+    ecm->writeSize = EcmFrameBufSize(ecm->dataOutPipe);
     ecm->ctrlSize  = ecm->ctrPipe->maxPacketSize;
     ecm->intSize   = ecm->intPipe->maxPacketSize;
 
@@ -801,41 +815,30 @@ EXIT:
 
 static void EcmReadBulk(struct UsbRequest *req)
 {
-    int32_t retval;
+    int32_t ret;
     int32_t status = req->compInfo.status;
     size_t size = req->compInfo.actualLength;
     struct EcmDevice *ecm = (struct EcmDevice *)req->compInfo.userData;
     ecm->readReqNum--;
     switch (status) {
         case USB_REQUEST_COMPLETED:
-            OsalMutexLock(&ecm->readLock);
-            if (size) {
-                uint8_t *data = req->compInfo.buffer;
-                uint32_t count;
-                if (DataFifoIsFull(&ecm->readFifo)) {
-                    HDF_LOGD("%s:%d fifo is full", __func__, __LINE__);
-                    DataFifoSkip(&ecm->readFifo, size);
-                }
-                count = DataFifoWrite(&ecm->readFifo, data, size);
-                if (count != size) {
-                    HDF_LOGW("%s: write %u less than expected %zu", __func__, count, size);
-                }
+            if (size == 0) {
+                break;
             }
+            /* the request is parked in the ring until the reader releases its frame */
+            OsalMutexLock(&ecm->readLock);
+            ret = EcmFrameRingPush(&ecm->readRing, req, req->compInfo.buffer, (uint32_t)size);
             OsalMutexUnlock(&ecm->readLock);
+            if (ret == HDF_SUCCESS) {
+                return;
+            }
             break;
         default:
             HDF_LOGE("%s:%d status=%d", __func__, __LINE__, status);
             return;
     }
 
-    if (ecm->openFlag) {
-        retval = UsbSubmitRequestAsync(req);
-        if (retval && retval != -EPERM) {
-            HDF_LOGE("%s - usb_submit_urb failed: %d\n", __func__, retval);
-        } else {
-            ecm->readReqNum++;
-        }
-    }
+    (void)EcmReadFrameRelease(req, ecm);
 }
 
 void EcmAllocWriteReq(struct EcmDevice *ecm)
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecm_frame_ring.h"
+#include "hdf_log.h"
+
+#define HDF_LOG_TAG   USB_HOST_ECM
+
+#define ECM_FRAME_RING_MASK     (ECM_FRAME_RING_SIZE - 1)
+
+void EcmFrameRingInit(struct EcmFrameRing *ring, EcmFrameReleaseFunc release, void *priv)
+{
+    if (ring == NULL) {
+        return;
+    }
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    ring->release = release;
+    ring->priv = priv;
+}
+
+uint32_t EcmFrameRingCount(const struct EcmFrameRing *ring)
+{
+    return ring->tail - ring->head;
+}
+
+int32_t EcmFrameRingPush(struct EcmFrameRing *ring, void *owner, uint8_t *data, uint32_t len)
+{
+    struct EcmFrame *frame = NULL;
+
+    if ((ring == NULL) || (data == NULL)) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (EcmFrameRingCount(ring) >= ECM_FRAME_RING_SIZE) {
+        ring->dropped++;
+        HDF_LOGW("%s: ring full, dropped %u", __func__, ring->dropped);
+        return HDF_ERR_QUEUE_FULL;
+    }
+
+    frame = &ring->frames[ring->tail & ECM_FRAME_RING_MASK];
+    frame->owner = owner;
+    frame->data = data;
+    frame->len = len;
+    ring->tail++;
+    return HDF_SUCCESS;
+}
+
+int32_t EcmFrameRingGet(struct EcmFrameRing *ring, struct EcmFrame *frame)
+{
+    if ((ring == NULL) || (frame == NULL)) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (EcmFrameRingCount(ring) == 0) {
+        return HDF_DEV_ERR_NODATA;
+    }
+
+    *frame = ring->frames[ring->head & ECM_FRAME_RING_MASK];
+    ring->head++;
+    return HDF_SUCCESS;
+}
+
+int32_t EcmFrameRingRelease(const struct EcmFrameRing *ring, const struct EcmFrame *frame)
+{
+    if ((ring == NULL) || (frame == NULL)) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (ring->release == NULL) {
+        return HDF_SUCCESS;
+    }
+    return ring->release(frame->owner, ring->priv);
+}
+
+uint32_t EcmFrameRingFlush(struct EcmFrameRing *ring)
+{
+    uint32_t count;
+
+    if (ring == NULL) {
+        return 0;
+    }
+    count = EcmFrameRingCount(ring);
+    ring->head = ring->tail;
+    return count;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef USB_HOST_LOOPBACK_BENCH_H
+#define USB_HOST_LOOPBACK_BENCH_H
+
+#include "hdf_base.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOOPBACK_BENCH_DEFAULT_INTERFACE    0
+#define LOOPBACK_BENCH_DEFAULT_SIZE         (16 * 1024)
+#define LOOPBACK_BENCH_DEFAULT_DEPTH        4
+#define LOOPBACK_BENCH_DEFAULT_DURATION_MS  5000
+#define LOOPBACK_BENCH_DEFAULT_INTERVAL_US  1000
+#define LOOPBACK_BENCH_DEFAULT_TIMEOUT_MS   1000
+#define LOOPBACK_BENCH_INTERRUPT_SIZE       64
+#define LOOPBACK_BENCH_DEPTH_MAX            16
+#define LOOPBACK_BENCH_SIZE_MAX             (256 * 1024)
+
+enum LoopbackBenchPath {
+    LOOPBACK_PATH_DDK,
+    LOOPBACK_PATH_RAW,
+    LOOPBACK_PATH_USBD,
+    LOOPBACK_PATH_MAX,
+};
+
+/*
+ * All patterns run over the bulk IN/OUT pair of the loopback function:
+ * bulk streams large transfers from depth writers and depth readers,
+ * interrupt is a single small ping-pong, isoc is a ping-pong paced to a
+ * fixed service interval that counts missed deadlines.
+ */
+enum LoopbackBenchPattern {
+    LOOPBACK_PATTERN_BULK,
+    LOOPBACK_PATTERN_INTERRUPT,
+    LOOPBACK_PATTERN_ISOC,
+    LOOPBACK_PATTERN_MAX,
+};
+
+struct LoopbackBenchConfig {
+    uint8_t busNum;
+    uint8_t devAddr;
+    uint8_t interfaceId;
+    enum LoopbackBenchPath path;
+    enum LoopbackBenchPattern pattern;
+    uint32_t size;
+    uint32_t depth;
+    uint32_t durationMs;
+    uint32_t intervalUs;
+    uint32_t timeoutMs;
+};
+
+/*
+ * One access path to the device. A lane is the per-thread transfer state,
+ * transfers on a lane are synchronous and never shared between threads.
+ */
+struct LoopbackBenchOps {
+    const char *name;
+    int32_t (*open)(const struct LoopbackBenchConfig *config, void **ctx);
+    int32_t (*laneInit)(void *ctx, uint8_t *buf, uint32_t size, void **lane);
+    int32_t (*transfer)(void *ctx, void *lane, bool in, uint8_t *buf, uint32_t len, uint32_t *actual);
+    void (*laneRelease)(void *ctx, void *lane);
+    void (*close)(void *ctx);
+};
+
+const struct LoopbackBenchOps *LoopbackBenchUsbdOps(void);
+
+/* find the first bulk IN/OUT pair of alt setting 0 in raw descriptor bytes */
+int32_t LoopbackBenchFindEndpoints(const uint8_t *desc, uint32_t len, uint8_t interfaceId,
+    uint8_t *inAddr, uint8_t *outAddr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* USB_HOST_LOOPBACK_BENCH_H */
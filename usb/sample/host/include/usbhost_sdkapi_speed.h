@@ -33,6 +33,7 @@
 #define TEST_BYTE_COUNT         1024
 #define TEST_FLOAT_COUNT        (1.0)
 #define TEST_SLEEP_TIME         10
+#define TEST_STATUS_LINE_LEN    128
 
 #define TEST_WRITE              true
 #define TEST_READ               false
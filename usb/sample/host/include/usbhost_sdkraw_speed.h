@@ -31,6 +31,9 @@
 #define TEST_BYTE_COUNT         1024
 #define TEST_FLOAT_COUNT        (1.0)
 #define TEST_SLEEP_TIME         10
+#define TEST_SYNC_LENGTH        (64 * 1024)
+#define TEST_SYNC_TIMEOUT       1000
+#define TEST_USEC_PER_SEC       1000000
 
 #define TEST_WRITE              true
 #define TEST_READ               false
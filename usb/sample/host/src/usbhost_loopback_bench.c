@@ -0,0 +1,813 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "usbhost_loopback_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include "hdf_log.h"
+#include "osal_mem.h"
+#include "securec.h"
+#include "usb_ddk_interface.h"
+#include "usb_raw_api.h"
+#include "usb_throughput_stats.h"
+
+#define HDF_LOG_TAG   USB_HOST_LOOPBACK_BENCH
+
+#define LOOPBACK_BENCH_ISOC_SIZE        1024
+#define LOOPBACK_BENCH_LANE_MAX         (LOOPBACK_BENCH_DEPTH_MAX * 2)
+#define LOOPBACK_BENCH_US_PER_MS        1000
+#define LOOPBACK_BENCH_DESC_LEN         0
+#define LOOPBACK_BENCH_DESC_TYPE        1
+#define LOOPBACK_BENCH_IF_NUMBER        2
+#define LOOPBACK_BENCH_IF_ALT           3
+#define LOOPBACK_BENCH_EP_ADDR          2
+#define LOOPBACK_BENCH_EP_ATTR          3
+#define LOOPBACK_BENCH_DESC_INTERFACE   0x04
+#define LOOPBACK_BENCH_DESC_ENDPOINT    0x05
+#define LOOPBACK_BENCH_XFER_MASK        0x03
+#define LOOPBACK_BENCH_XFER_BULK        0x02
+#define LOOPBACK_BENCH_DIR_IN           0x80
+#define LOOPBACK_BENCH_PIPE_DIR_OFFSET  7
+
+struct LoopbackLane {
+    struct LoopbackRun *run;
+    void *lane;
+    uint8_t *buf;
+    bool in;
+    pthread_t tid;
+    uint64_t submits;
+    uint64_t deadlineMisses;
+    struct UsbThroughputStats stats;
+};
+
+struct LoopbackRun {
+    const struct LoopbackBenchConfig *config;
+    const struct LoopbackBenchOps *ops;
+    void *ctx;
+    uint64_t startUs;
+    uint64_t endUs;
+    uint32_t laneNum;
+    struct LoopbackLane lanes[LOOPBACK_BENCH_LANE_MAX];
+};
+
+static const char *g_pathName[LOOPBACK_PATH_MAX] = {"ddk", "raw", "usbd"};
+static const char *g_patternName[LOOPBACK_PATTERN_MAX] = {"bulk", "interrupt", "isoc"};
+static const uint32_t g_patternSize[LOOPBACK_PATTERN_MAX] = {
+    LOOPBACK_BENCH_DEFAULT_SIZE, LOOPBACK_BENCH_INTERRUPT_SIZE, LOOPBACK_BENCH_ISOC_SIZE
+};
+
+int32_t LoopbackBenchFindEndpoints(const uint8_t *desc, uint32_t len, uint8_t interfaceId,
+    uint8_t *inAddr, uint8_t *outAddr)
+{
+    bool inInterface = false;
+    uint32_t pos = 0;
+
+    if (desc == NULL || inAddr == NULL || outAddr == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    *inAddr = 0;
+    *outAddr = 0;
+    while (pos + LOOPBACK_BENCH_IF_ALT < len) {
+        uint8_t descLen = desc[pos + LOOPBACK_BENCH_DESC_LEN];
+        uint8_t descType = desc[pos + LOOPBACK_BENCH_DESC_TYPE];
+        if (descLen == 0 || pos + descLen > len) {
+            break;
+        }
+        if (descType == LOOPBACK_BENCH_DESC_INTERFACE) {
+            inInterface = desc[pos + LOOPBACK_BENCH_IF_NUMBER] == interfaceId &&
+                desc[pos + LOOPBACK_BENCH_IF_ALT] == 0;
+        } else if (descType == LOOPBACK_BENCH_DESC_ENDPOINT && inInterface &&
+            (desc[pos + LOOPBACK_BENCH_EP_ATTR] & LOOPBACK_BENCH_XFER_MASK) == LOOPBACK_BENCH_XFER_BULK) {
+            uint8_t addr = desc[pos + LOOPBACK_BENCH_EP_ADDR];
+            if ((addr & LOOPBACK_BENCH_DIR_IN) != 0 && *inAddr == 0) {
+                *inAddr = addr;
+            } else if ((addr & LOOPBACK_BENCH_DIR_IN) == 0 && *outAddr == 0) {
+                *outAddr = addr;
+            }
+        }
+        pos += descLen;
+    }
+
+    return (*inAddr != 0 && *outAddr != 0) ? HDF_SUCCESS : HDF_DEV_ERR_NO_DEVICE;
+}
+
+/* DDK path: interface objects and pipe ids, requests are filled once per lane */
+struct DdkBenchCtx {
+    struct UsbSession *session;
+    struct UsbInterface *interfaceObj;
+    UsbInterfaceHandle *handle;
+    struct UsbPipeInfo inPipe;
+    struct UsbPipeInfo outPipe;
+    bool haveIn;
+    bool haveOut;
+    uint32_t timeoutMs;
+};
+
+struct DdkBenchLane {
+    struct UsbRequest *inReq;
+    struct UsbRequest *outReq;
+};
+
+static void DdkBenchClose(void *ctx)
+{
+    struct DdkBenchCtx *ddk = (struct DdkBenchCtx *)ctx;
+
+    if (ddk == NULL) {
+        return;
+    }
+    if (ddk->handle != NULL) {
+        (void)UsbCloseInterface(ddk->handle);
+    }
+    if (ddk->interfaceObj != NULL) {
+        (void)UsbReleaseInterface(ddk->interfaceObj);
+    }
+    if (ddk->session != NULL) {
+        (void)UsbExitHostSdk(ddk->session);
+    }
+    OsalMemFree(ddk);
+}
+
+static int32_t DdkBenchFindPipes(struct DdkBenchCtx *ddk)
+{
+    struct UsbPipeInfo pipe;
+    uint8_t i;
+
+    for (i = 0; i <= ddk->interfaceObj->info.pipeNum; i++) {
+        if (UsbGetPipeInfo(ddk->handle, ddk->interfaceObj->info.curAltSetting, i, &pipe) != HDF_SUCCESS ||
+            pipe.pipeType != USB_PIPE_TYPE_BULK) {
+            continue;
+        }
+        if (pipe.pipeDirection == USB_PIPE_DIRECTION_IN && !ddk->haveIn) {
+            ddk->inPipe = pipe;
+            ddk->haveIn = true;
+        } else if (pipe.pipeDirection == USB_PIPE_DIRECTION_OUT && !ddk->haveOut) {
+            ddk->outPipe = pipe;
+            ddk->haveOut = true;
+        }
+    }
+    return (ddk->haveIn && ddk->haveOut) ? HDF_SUCCESS : HDF_DEV_ERR_NO_DEVICE;
+}
+
+static int32_t DdkBenchOpen(const struct LoopbackBenchConfig *config, void **ctx)
+{
+    struct DdkBenchCtx *ddk = (struct DdkBenchCtx *)OsalMemCalloc(sizeof(*ddk));
+    int32_t ret;
+
+    if (ddk == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    ddk->timeoutMs = config->timeoutMs;
+    ret = UsbInitHostSdk(&ddk->session);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s:%d UsbInitHostSdk failed, ret=%d", __func__, __LINE__, ret);
+        DdkBenchClose(ddk);
+        return ret;
+    }
+    ddk->interfaceObj = UsbClaimInterface(ddk->session, config->busNum, config->devAddr, config->interfaceId);
+    if (ddk->interfaceObj == NULL) {
+        HDF_LOGE("%s:%d UsbClaimInterface failed", __func__, __LINE__);
+        DdkBenchClose(ddk);
+        return HDF_DEV_ERR_NO_DEVICE;
+    }
+    ddk->handle = UsbOpenInterface(ddk->interfaceObj);
+    if (ddk->handle == NULL) {
+        HDF_LOGE("%s:%d UsbOpenInterface failed", __func__, __LINE__);
+        DdkBenchClose(ddk);
+        return HDF_DEV_ERR_NO_DEVICE;
+    }
+    ret = DdkBenchFindPipes(ddk);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s:%d no bulk pipe pair on interface %u", __func__, __LINE__, config->interfaceId);
+        DdkBenchClose(ddk);
+        return ret;
+    }
+    *ctx = ddk;
+    return HDF_SUCCESS;
+}
+
+static struct UsbRequest *DdkBenchAllocRequest(const struct DdkBenchCtx *ddk, const struct UsbPipeInfo *pipe,
+    uint8_t *buf, uint32_t size)
+{
+    struct UsbRequestParams params;
+    struct UsbRequest *req = UsbAllocRequest(ddk->handle, 0, (int32_t)size);
+
+    if (req == NULL) {
+        return NULL;
+    }
+    (void)memset_s(&params, sizeof(params), 0, sizeof(params));
+    params.interfaceId = pipe->interfaceId;
+    params.pipeId = pipe->pipeId;
+    params.pipeAddress = pipe->pipeAddress;
+    params.timeout = ddk->timeoutMs;
+    params.requestType = USB_REQUEST_PARAMS_DATA_TYPE;
+    params.dataReq.numIsoPackets = 0;
+    params.dataReq.directon = (pipe->pipeDirection >> LOOPBACK_BENCH_PIPE_DIR_OFFSET) & 0x1;
+    params.dataReq.length = size;
+    params.dataReq.buffer = buf;
+    if (UsbFillRequest(req, ddk->handle, &params) != HDF_SUCCESS) {
+        (void)UsbFreeRequest(req);
+        return NULL;
+    }
+    return req;
+}
+
+static void DdkBenchLaneRelease(void *ctx, void *lane)
+{
+    struct DdkBenchLane *ddkLane = (struct DdkBenchLane *)lane;
+
+    (void)ctx;
+    if (ddkLane == NULL) {
+        return;
+    }
+    if (ddkLane->inReq != NULL) {
+        (void)UsbFreeRequest(ddkLane->inReq);
+    }
+    if (ddkLane->outReq != NULL) {
+        (void)UsbFreeRequest(ddkLane->outReq);
+    }
+    OsalMemFree(ddkLane);
+}
+
+static int32_t DdkBenchLaneInit(void *ctx, uint8_t *buf, uint32_t size, void **lane)
+{
+    struct DdkBenchCtx *ddk = (struct DdkBenchCtx *)ctx;
+    struct DdkBenchLane *ddkLane = (struct DdkBenchLane *)OsalMemCalloc(sizeof(*ddkLane));
+
+    if (ddkLane == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    ddkLane->inReq = DdkBenchAllocRequest(ddk, &ddk->inPipe, buf, size);
+    ddkLane->outReq = DdkBenchAllocRequest(ddk, &ddk->outPipe, buf, size);
+    if (ddkLane->inReq == NULL || ddkLane->outReq == NULL) {
+        DdkBenchLaneRelease(ctx, ddkLane);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    *lane = ddkLane;
+    return HDF_SUCCESS;
+}
+
+static int32_t DdkBenchTransfer(void *ctx, void *lane, bool in, uint8_t *buf, uint32_t len, uint32_t *actual)
+{
+    struct DdkBenchLane *ddkLane = (struct DdkBenchLane *)lane;
+    struct UsbRequest *req = in ? ddkLane->inReq : ddkLane->outReq;
+    int32_t ret;
+
+    (void)ctx;
+    (void)buf;
+    (void)len;
+    ret = UsbSubmitRequestSync(req);
+    *actual = req->compInfo.actualLength;
+    if (ret == HDF_SUCCESS && req->compInfo.status != USB_REQUEST_COMPLETED) {
+        ret = HDF_ERR_IO;
+    }
+    return ret;
+}
+
+static const struct LoopbackBenchOps g_ddkBenchOps = {
+    .name = "ddk",
+    .open = DdkBenchOpen,
+    .laneInit = DdkBenchLaneInit,
+    .transfer = DdkBenchTransfer,
+    .laneRelease = DdkBenchLaneRelease,
+    .close = DdkBenchClose,
+};
+
+/* raw path: endpoints from the parsed config descriptor, one raw request per lane */
+struct RawBenchCtx {
+    struct UsbSession *session;
+    UsbRawHandle *handle;
+    uint8_t interfaceId;
+    bool claimed;
+    uint8_t inAddr;
+    uint8_t outAddr;
+    uint32_t timeoutMs;
+};
+
+static void RawBenchClose(void *ctx)
+{
+    struct RawBenchCtx *raw = (struct RawBenchCtx *)ctx;
+
+    if (raw == NULL) {
+        return;
+    }
+    if (raw->claimed) {
+        (void)UsbRawReleaseInterface(raw->handle, raw->interfaceId);
+    }
+    if (raw->handle != NULL) {
+        (void)UsbRawCloseDevice(raw->handle);
+    }
+    if (raw->session != NULL) {
+        (void)UsbRawExit(raw->session);
+    }
+    OsalMemFree(raw);
+}
+
+static int32_t RawBenchFindEndpoints(struct RawBenchCtx *raw)
+{
+    struct UsbRawConfigDescriptor *config = NULL;
+    const struct UsbRawInterface *rawInterface = NULL;
+    uint8_t i;
+    int32_t ret;
+
+    /* the loopback gadget exposes a single configuration */
+    ret = UsbRawGetConfigDescriptor(UsbRawGetDevice(raw->handle), 0, &config);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    for (i = 0; i < config->configDescriptor.bNumInterfaces && i < USB_MAXINTERFACES; i++) {
+        rawInterface = config->interface[i];
+        if (rawInterface != NULL && rawInterface->numAltsetting > 0 &&
+            rawInterface->altsetting[0].interfaceDescriptor.bInterfaceNumber == raw->interfaceId) {
+            break;
+        }
+        rawInterface = NULL;
+    }
+    for (i = 0; rawInterface != NULL && i < rawInterface->altsetting[0].interfaceDescriptor.bNumEndpoints; i++) {
+        const struct UsbEndpointDescriptor *ep = &rawInterface->altsetting[0].endPoint[i].endpointDescriptor;
+        if ((ep->bmAttributes & LOOPBACK_BENCH_XFER_MASK) != LOOPBACK_BENCH_XFER_BULK) {
+            continue;
+        }
+        if ((ep->bEndpointAddress & LOOPBACK_BENCH_DIR_IN) != 0 && raw->inAddr == 0) {
+            raw->inAddr = ep->bEndpointAddress;
+        } else if ((ep->bEndpointAddress & LOOPBACK_BENCH_DIR_IN) == 0 && raw->outAddr == 0) {
+            raw->outAddr = ep->bEndpointAddress;
+        }
+    }
+    UsbRawFreeConfigDescriptor(config);
+    return (raw->inAddr != 0 && raw->outAddr != 0) ? HDF_SUCCESS : HDF_DEV_ERR_NO_DEVICE;
+}
+
+static int32_t RawBenchOpen(const struct LoopbackBenchConfig *config, void **ctx)
+{
+    struct RawBenchCtx *raw = (struct RawBenchCtx *)OsalMemCalloc(sizeof(*raw));
+    int32_t ret;
+
+    if (raw == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    raw->interfaceId = config->interfaceId;
+    raw->timeoutMs = config->timeoutMs;
+    ret = UsbRawInit(&raw->session);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s:%d UsbRawInit failed, ret=%d", __func__, __LINE__, ret);
+        RawBenchClose(raw);
+        return ret;
+    }
+    raw->handle = UsbRawOpenDevice(raw->session, config->busNum, config->devAddr);
+    if (raw->handle == NULL) {
+        HDF_LOGE("%s:%d UsbRawOpenDevice failed", __func__, __LINE__);
+        RawBenchClose(raw);
+        return HDF_DEV_ERR_NO_DEVICE;
+    }
+    ret = RawBenchFindEndpoints(raw);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s:%d no bulk endpoint pair on interface %u", __func__, __LINE__, config->interfaceId);
+        RawBenchClose(raw);
+        return ret;
+    }
+    ret = UsbRawClaimInterface(raw->handle, raw->interfaceId);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s:%d UsbRawClaimInterface failed, ret=%d", __func__, __LINE__, ret);
+        RawBenchClose(raw);
+        return ret;
+    }
+    raw->claimed = true;
+    *ctx = raw;
+    return HDF_SUCCESS;
+}
+
+static int32_t RawBenchLaneInit(void *ctx, uint8_t *buf, uint32_t size, void **lane)
+{
+    struct RawBenchCtx *raw = (struct RawBenchCtx *)ctx;
+    struct UsbRawRequest *req = UsbRawAllocRequest(raw->handle, 0, (int32_t)size);
+
+    (void)buf;
+    if (req == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    *lane = req;
+    return HDF_SUCCESS;
+}
+
+static int32_t RawBenchTransfer(void *ctx, void *lane, bool in, uint8_t *buf, uint32_t len, uint32_t *actual)
+{
+    struct RawBenchCtx *raw = (struct RawBenchCtx *)ctx;
+    int32_t requested = 0;
+    struct UsbRequestData reqData = {
+        .endPoint = in ? raw->inAddr : raw->outAddr,
+        .data = buf,
+        .length = len,
+        .requested = &requested,
+        .timeout = raw->timeoutMs,
+    };
+    int32_t ret;
+
+    ret = UsbRawSendBulkRequest((struct UsbRawRequest *)lane, raw->handle, &reqData);
+    *actual = (requested > 0) ? (uint32_t)requested : 0;
+    return ret;
+}
+
+static void RawBenchLaneRelease(void *ctx, void *lane)
+{
+    (void)ctx;
+    if (lane != NULL) {
+        (void)UsbRawFreeRequest((struct UsbRawRequest *)lane);
+    }
+}
+
+static const struct LoopbackBenchOps g_rawBenchOps = {
+    .name = "raw",
+    .open = RawBenchOpen,
+    .laneInit = RawBenchLaneInit,
+    .transfer = RawBenchTransfer,
+    .laneRelease = RawBenchLaneRelease,
+    .close = RawBenchClose,
+};
+
+static const struct LoopbackBenchOps *LoopbackBenchGetOps(enum LoopbackBenchPath path)
+{
+    switch (path) {
+        case LOOPBACK_PATH_DDK:
+            return &g_ddkBenchOps;
+        case LOOPBACK_PATH_RAW:
+            return &g_rawBenchOps;
+        case LOOPBACK_PATH_USBD:
+            return LoopbackBenchUsbdOps();
+        default:
+            return NULL;
+    }
+}
+
+static inline bool LoopbackBenchExpired(const struct LoopbackRun *run)
+{
+    return UsbThroughputNowUs() >= run->endUs;
+}
+
+/* bulk: each lane streams in one direction until the window closes */
+static void LoopbackBenchStream(struct LoopbackLane *lane)
+{
+    struct LoopbackRun *run = lane->run;
+    uint32_t size = run->config->size;
+    uint32_t actual = 0;
+    int32_t ret;
+
+    while (!LoopbackBenchExpired(run)) {
+        UsbThroughputSubmit(&lane->stats);
+        ret = run->ops->transfer(run->ctx, lane->lane, lane->in, lane->buf, size, &actual);
+        if (LoopbackBenchExpired(run)) {
+            /* drained after the window, typically a read timing out once the writers stopped */
+            UsbThroughputCancel(&lane->stats);
+            break;
+        }
+        lane->submits++;
+        UsbThroughputComplete(&lane->stats, actual, ret == HDF_SUCCESS);
+    }
+}
+
+/* interrupt and isoc: one OUT+IN round trip per iteration, isoc paced to intervalUs */
+static void LoopbackBenchPingPong(struct LoopbackLane *lane)
+{
+    struct LoopbackRun *run = lane->run;
+    bool paced = run->config->pattern == LOOPBACK_PATTERN_ISOC;
+    uint64_t interval = run->config->intervalUs;
+    uint64_t next = UsbThroughputNowUs();
+    uint32_t size = run->config->size;
+    uint32_t actual = 0;
+    uint64_t now;
+    int32_t ret;
+
+    while (!LoopbackBenchExpired(run)) {
+        now = UsbThroughputNowUs();
+        if (paced && now < next) {
+            (void)usleep((useconds_t)(next - now));
+        }
+        UsbThroughputSubmit(&lane->stats);
+        ret = run->ops->transfer(run->ctx, lane->lane, false, lane->buf, size, &actual);
+        if (ret == HDF_SUCCESS) {
+            ret = run->ops->transfer(run->ctx, lane->lane, true, lane->buf, size, &actual);
+        }
+        lane->submits += 2;
+        UsbThroughputComplete(&lane->stats, actual, ret == HDF_SUCCESS);
+        if (!paced) {
+            continue;
+        }
+        now = UsbThroughputNowUs();
+        if (ret != HDF_SUCCESS || now > next + interval) {
+            lane->deadlineMisses++;
+        }
+        next += interval;
+        if (next < now) {
+            /* do not burst to catch up, a late period is already counted */
+            next = now;
+        }
+    }
+}
+
+static void *LoopbackBenchLaneThread(void *arg)
+{
+    struct LoopbackLane *lane = (struct LoopbackLane *)arg;
+
+    if (lane->run->config->pattern == LOOPBACK_PATTERN_BULK) {
+        LoopbackBenchStream(lane);
+    } else {
+        LoopbackBenchPingPong(lane);
+    }
+    return NULL;
+}
+
+static void LoopbackBenchReleaseLanes(struct LoopbackRun *run)
+{
+    uint32_t i;
+
+    for (i = 0; i < run->laneNum; i++) {
+        if (run->lanes[i].lane != NULL) {
+            run->ops->laneRelease(run->ctx, run->lanes[i].lane);
+        }
+        OsalMemFree(run->lanes[i].buf);
+    }
+    run->laneNum = 0;
+}
+
+static int32_t LoopbackBenchInitLanes(struct LoopbackRun *run)
+{
+    const struct LoopbackBenchConfig *config = run->config;
+    uint32_t laneNum = (config->pattern == LOOPBACK_PATTERN_BULK) ? config->depth * 2 : 1;
+    struct LoopbackLane *lane = NULL;
+    int32_t ret;
+    uint32_t i;
+
+    for (i = 0; i < laneNum; i++) {
+        lane = &run->lanes[i];
+        (void)memset_s(lane, sizeof(*lane), 0, sizeof(*lane));
+        run->laneNum++;
+        lane->run = run;
+        lane->in = (i % 2) == 1;
+        lane->buf = (uint8_t *)OsalMemCalloc(config->size);
+        if (lane->buf == NULL) {
+            LoopbackBenchReleaseLanes(run);
+            return HDF_ERR_MALLOC_FAIL;
+        }
+        ret = run->ops->laneInit(run->ctx, lane->buf, config->size, &lane->lane);
+        if (ret != HDF_SUCCESS) {
+            LoopbackBenchReleaseLanes(run);
+            return ret;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+static void LoopbackBenchReport(const struct LoopbackRun *run, uint64_t elapsedUs)
+{
+    const struct LoopbackBenchConfig *config = run->config;
+    struct UsbThroughputStats merged;
+    uint64_t bytes = 0;
+    uint64_t submits = 0;
+    uint64_t misses = 0;
+    uint32_t i, j;
+    double seconds = (elapsedUs == 0) ? 1.0 : (double)elapsedUs / USB_THROUGHPUT_US_PER_SEC;
+
+    (void)memset_s(&merged, sizeof(merged), 0, sizeof(merged));
+    for (i = 0; i < run->laneNum; i++) {
+        const struct LoopbackLane *lane = &run->lanes[i];
+        /* the looped-back rate is what arrives on IN, ping-pong lanes only count IN bytes */
+        if (lane->in || config->pattern != LOOPBACK_PATTERN_BULK) {
+            bytes += lane->stats.bytes;
+        }
+        merged.requests += lane->stats.requests;
+        merged.errors += lane->stats.errors;
+        submits += lane->submits;
+        misses += lane->deadlineMisses;
+        for (j = 0; j < USB_THROUGHPUT_LATENCY_BUCKETS; j++) {
+            merged.latency[j] += lane->stats.latency[j];
+        }
+    }
+
+    printf("{\"path\":\"%s\",\"pattern\":\"%s\",\"busNum\":%u,\"devAddr\":%u,\"interface\":%u,"
+        "\"size\":%u,\"depth\":%u,\"durationMs\":%" PRIu64 ",\"bytes\":%" PRIu64 ",\"transfers\":%" PRIu64 ","
+        "\"errors\":%" PRIu64 ",\"mbps\":%.3f,\"submitsPerSec\":%.1f,\"latencyKind\":\"%s\","
+        "\"latencyUs\":{\"p50\":%u,\"p90\":%u,\"p99\":%u},\"intervalUs\":%u,\"deadlineMisses\":%" PRIu64 "}",
+        g_pathName[config->path], g_patternName[config->pattern], config->busNum, config->devAddr,
+        config->interfaceId, config->size, (config->pattern == LOOPBACK_PATTERN_BULK) ? config->depth : 1,
+        elapsedUs / LOOPBACK_BENCH_US_PER_MS, bytes, merged.requests, merged.errors,
+        (double)bytes / USB_THROUGHPUT_BYTES_PER_MB / seconds, (double)submits / seconds,
+        (config->pattern == LOOPBACK_PATTERN_BULK) ? "transfer" : "roundtrip",
+        UsbThroughputPercentile(&merged, USB_THROUGHPUT_P50), UsbThroughputPercentile(&merged, USB_THROUGHPUT_P90),
+        UsbThroughputPercentile(&merged, USB_THROUGHPUT_P99),
+        (config->pattern == LOOPBACK_PATTERN_ISOC) ? config->intervalUs : 0, misses);
+}
+
+static int32_t LoopbackBenchRun(const struct LoopbackBenchConfig *config)
+{
+    struct LoopbackRun *run = (struct LoopbackRun *)OsalMemCalloc(sizeof(*run));
+    uint32_t started = 0;
+    uint64_t elapsedUs;
+    int32_t ret;
+    uint32_t i;
+
+    if (run == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    run->config = config;
+    run->ops = LoopbackBenchGetOps(config->path);
+    ret = (run->ops == NULL) ? HDF_ERR_NOT_SUPPORT : run->ops->open(config, &run->ctx);
+    if (ret != HDF_SUCCESS) {
+        goto OUT;
+    }
+    ret = LoopbackBenchInitLanes(run);
+    if (ret != HDF_SUCCESS) {
+        run->ops->close(run->ctx);
+        goto OUT;
+    }
+
+    run->startUs = UsbThroughputNowUs();
+    run->endUs = run->startUs + (uint64_t)config->durationMs * LOOPBACK_BENCH_US_PER_MS;
+    for (i = 0; i < run->laneNum; i++) {
+        if (pthread_create(&run->lanes[i].tid, NULL, LoopbackBenchLaneThread, &run->lanes[i]) != 0) {
+            HDF_LOGE("%s:%d pthread_create failed", __func__, __LINE__);
+            /* stop the lanes already running */
+            run->endUs = 0;
+            ret = HDF_FAILURE;
+            break;
+        }
+        started++;
+    }
+    for (i = 0; i < started; i++) {
+        (void)pthread_join(run->lanes[i].tid, NULL);
+    }
+    elapsedUs = run->endUs - run->startUs;
+
+    if (ret == HDF_SUCCESS) {
+        LoopbackBenchReport(run, elapsedUs);
+    }
+    LoopbackBenchReleaseLanes(run);
+    run->ops->close(run->ctx);
+OUT:
+    if (ret != HDF_SUCCESS) {
+        printf("{\"path\":\"%s\",\"pattern\":\"%s\",\"busNum\":%u,\"devAddr\":%u,\"error\":%d}",
+            g_pathName[config->path], g_patternName[config->pattern], config->busNum, config->devAddr, ret);
+    }
+    OsalMemFree(run);
+    return ret;
+}
+
+static int32_t LoopbackBenchParseName(const char *arg, const char * const *names, int32_t num, int32_t *value)
+{
+    int32_t i;
+
+    if (strcmp(arg, "all") == 0) {
+        *value = num;
+        return HDF_SUCCESS;
+    }
+    for (i = 0; i < num; i++) {
+        if (strcmp(arg, names[i]) == 0) {
+            *value = i;
+            return HDF_SUCCESS;
+        }
+    }
+    return HDF_ERR_INVALID_PARAM;
+}
+
+static void ShowHelp(const char *name)
+{
+    printf(">> usage:\n");
+    printf(">>      %s -b busNum -d devAddr [options]\n", name);
+    printf(">>      -i interface      loopback interface number, default %d\n", LOOPBACK_BENCH_DEFAULT_INTERFACE);
+    printf(">>      -p ddk|raw|usbd|all   access path, default all\n");
+    printf(">>      -t bulk|interrupt|isoc|all   traffic pattern, default all\n");
+    printf(">>      -s size           transfer size in bytes, default per pattern\n");
+    printf(">>      -q depth          bulk writers and readers each, default %d\n", LOOPBACK_BENCH_DEFAULT_DEPTH);
+    printf(">>      -T durationMs     default %d\n", LOOPBACK_BENCH_DEFAULT_DURATION_MS);
+    printf(">>      -I intervalUs     isoc service interval, default %d\n", LOOPBACK_BENCH_DEFAULT_INTERVAL_US);
+    printf(">>      -o timeoutMs      per transfer timeout, default %d\n", LOOPBACK_BENCH_DEFAULT_TIMEOUT_MS);
+    printf("\n");
+}
+
+static int32_t ParseArgs(int32_t argc, char *argv[], struct LoopbackBenchConfig *config,
+    int32_t *path, int32_t *pattern)
+{
+    bool haveBus = false;
+    bool haveDev = false;
+    int32_t opt;
+
+    while ((opt = getopt(argc, argv, "b:d:i:p:t:s:q:T:I:o:h")) != -1) {
+        switch (opt) {
+            case 'b':
+                config->busNum = (uint8_t)atoi(optarg);
+                haveBus = true;
+                break;
+            case 'd':
+                config->devAddr = (uint8_t)atoi(optarg);
+                haveDev = true;
+                break;
+            case 'i':
+                config->interfaceId = (uint8_t)atoi(optarg);
+                break;
+            case 'p':
+                if (LoopbackBenchParseName(optarg, g_pathName, LOOPBACK_PATH_MAX, path) != HDF_SUCCESS) {
+                    return HDF_ERR_INVALID_PARAM;
+                }
+                break;
+            case 't':
+                if (LoopbackBenchParseName(optarg, g_patternName, LOOPBACK_PATTERN_MAX, pattern) != HDF_SUCCESS) {
+                    return HDF_ERR_INVALID_PARAM;
+                }
+                break;
+            case 's':
+                config->size = (uint32_t)atoi(optarg);
+                break;
+            case 'q':
+                config->depth = (uint32_t)atoi(optarg);
+                break;
+            case 'T':
+                config->durationMs = (uint32_t)atoi(optarg);
+                break;
+            case 'I':
+                config->intervalUs = (uint32_t)atoi(optarg);
+                break;
+            case 'o':
+                config->timeoutMs = (uint32_t)atoi(optarg);
+                break;
+            default:
+                return HDF_ERR_INVALID_PARAM;
+        }
+    }
+
+    if (!haveBus || !haveDev || config->size > LOOPBACK_BENCH_SIZE_MAX || config->depth == 0 ||
+        config->depth > LOOPBACK_BENCH_DEPTH_MAX || config->durationMs == 0 || config->intervalUs == 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t main(int32_t argc, char *argv[])
+{
+    struct LoopbackBenchConfig base = {
+        .interfaceId = LOOPBACK_BENCH_DEFAULT_INTERFACE,
+        .size = 0,
+        .depth = LOOPBACK_BENCH_DEFAULT_DEPTH,
+        .durationMs = LOOPBACK_BENCH_DEFAULT_DURATION_MS,
+        .intervalUs = LOOPBACK_BENCH_DEFAULT_INTERVAL_US,
+        .timeoutMs = LOOPBACK_BENCH_DEFAULT_TIMEOUT_MS,
+    };
+    struct LoopbackBenchConfig config;
+    int32_t path = LOOPBACK_PATH_MAX;
+    int32_t pattern = LOOPBACK_PATTERN_MAX;
+    int32_t failed = 0;
+    bool array;
+    bool first = true;
+    int32_t p, t;
+
+    if (ParseArgs(argc, argv, &base, &path, &pattern) != HDF_SUCCESS) {
+        ShowHelp(argv[0]);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    /* "all" expands to every path x pattern and prints one JSON array */
+    array = path == LOOPBACK_PATH_MAX || pattern == LOOPBACK_PATTERN_MAX;
+    if (array) {
+        printf("[");
+    }
+    for (p = 0; p < LOOPBACK_PATH_MAX; p++) {
+        if (path != LOOPBACK_PATH_MAX && p != path) {
+            continue;
+        }
+        for (t = 0; t < LOOPBACK_PATTERN_MAX; t++) {
+            if (pattern != LOOPBACK_PATTERN_MAX && t != pattern) {
+                continue;
+            }
+            config = base;
+            config.path = (enum LoopbackBenchPath)p;
+            config.pattern = (enum LoopbackBenchPattern)t;
+            config.size = (base.size == 0) ? g_patternSize[t] : base.size;
+            if (!first) {
+                printf(",");
+            }
+            first = false;
+            if (LoopbackBenchRun(&config) != HDF_SUCCESS) {
+                failed++;
+            }
+            (void)fflush(stdout);
+        }
+    }
+    printf(array ? "]\n" : "\n");
+
+    return (failed == 0) ? HDF_SUCCESS : HDF_FAILURE;
+}
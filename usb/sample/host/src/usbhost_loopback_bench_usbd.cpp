@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "usbhost_loopback_bench.h"
+#include <new>
+#include <vector>
+#include "hdf_log.h"
+#include "securec.h"
+#include "usbd_client.h"
+
+#define HDF_LOG_TAG   USB_HOST_LOOPBACK_BENCH
+
+using namespace OHOS::USB;
+
+namespace {
+/* usbd path: every transfer is an IPC round trip to the usb host service */
+struct UsbdBenchCtx {
+    UsbDev dev;
+    uint8_t interfaceId;
+    uint8_t inAddr;
+    uint8_t outAddr;
+    int32_t timeoutMs;
+    bool claimed;
+};
+
+void UsbdBenchClose(void *ctx)
+{
+    auto usbd = static_cast<UsbdBenchCtx *>(ctx);
+    if (usbd == nullptr) {
+        return;
+    }
+    if (usbd->claimed) {
+        (void)UsbdClient::GetInstance().ReleaseInterface(usbd->dev, usbd->interfaceId);
+    }
+    (void)UsbdClient::GetInstance().CloseDevice(usbd->dev);
+    delete usbd;
+}
+
+int32_t UsbdBenchOpen(const struct LoopbackBenchConfig *config, void **ctx)
+{
+    auto usbd = new (std::nothrow) UsbdBenchCtx {{config->busNum, config->devAddr}, config->interfaceId, 0, 0,
+        static_cast<int32_t>(config->timeoutMs), false};
+    if (usbd == nullptr) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    int32_t ret = UsbdClient::GetInstance().OpenDevice(usbd->dev);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s:%{public}d OpenDevice failed, ret=%{public}d", __func__, __LINE__, ret);
+        delete usbd;
+        return ret;
+    }
+
+    std::vector<uint8_t> desc;
+    ret = UsbdClient::GetInstance().GetRawDescriptor(usbd->dev, desc);
+    if (ret == HDF_SUCCESS) {
+        ret = LoopbackBenchFindEndpoints(desc.data(), static_cast<uint32_t>(desc.size()), usbd->interfaceId,
+            &usbd->inAddr, &usbd->outAddr);
+    }
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s:%{public}d no bulk endpoint pair on interface %{public}u", __func__, __LINE__,
+            usbd->interfaceId);
+        UsbdBenchClose(usbd);
+        return ret;
+    }
+
+    ret = UsbdClient::GetInstance().ClaimInterface(usbd->dev, usbd->interfaceId, 1);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%{public}s:%{public}d ClaimInterface failed, ret=%{public}d", __func__, __LINE__, ret);
+        UsbdBenchClose(usbd);
+        return ret;
+    }
+    usbd->claimed = true;
+    *ctx = usbd;
+    return HDF_SUCCESS;
+}
+
+int32_t UsbdBenchLaneInit(void *ctx, uint8_t *buf, uint32_t size, void **lane)
+{
+    (void)buf;
+    (void)size;
+    /* the service owns the requests, a lane needs no state of its own */
+    *lane = ctx;
+    return HDF_SUCCESS;
+}
+
+int32_t UsbdBenchTransfer(void *ctx, void *lane, bool in, uint8_t *buf, uint32_t len, uint32_t *actual)
+{
+    auto usbd = static_cast<UsbdBenchCtx *>(ctx);
+    int32_t ret;
+
+    (void)lane;
+    *actual = 0;
+    if (in) {
+        const UsbPipe pipe = {usbd->interfaceId, usbd->inAddr};
+        std::vector<uint8_t> data;
+        ret = UsbdClient::GetInstance().BulkTransferRead(usbd->dev, pipe, usbd->timeoutMs, data);
+        if (ret == HDF_SUCCESS && !data.empty() && memcpy_s(buf, len, data.data(), data.size()) != EOK) {
+            return HDF_ERR_IO;
+        }
+        *actual = (ret == HDF_SUCCESS) ? static_cast<uint32_t>(data.size()) : 0;
+    } else {
+        const UsbPipe pipe = {usbd->interfaceId, usbd->outAddr};
+        const std::vector<uint8_t> data(buf, buf + len);
+        ret = UsbdClient::GetInstance().BulkTransferWrite(usbd->dev, pipe, usbd->timeoutMs, data);
+        *actual = (ret == HDF_SUCCESS) ? len : 0;
+    }
+    return ret;
+}
+
+void UsbdBenchLaneRelease(void *ctx, void *lane)
+{
+    (void)ctx;
+    (void)lane;
+}
+
+const struct LoopbackBenchOps g_usbdBenchOps = {
+    "usbd", UsbdBenchOpen, UsbdBenchLaneInit, UsbdBenchTransfer, UsbdBenchLaneRelease, UsbdBenchClose,
+};
+} // namespace
+
+const struct LoopbackBenchOps *LoopbackBenchUsbdOps(void)
+{
+    return &g_usbdBenchOps;
+}
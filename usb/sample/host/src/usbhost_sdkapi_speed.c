@@ -35,6 +35,8 @@
 #include "securec.h"
 #include "usb_ddk_interface.h"
 #include "hdf_usb_pnp_manage.h"
+#include "linux_adapter.h"
+#include "usb_io_reactor.h"
 
 #define HDF_LOG_TAG   USB_HOST_ACM
 
@@ -413,6 +415,45 @@ int32_t FillRequest(struct AcmDevice *acm)
     return HDF_SUCCESS;
 }
 
+static int32_t GetThreadCount(void)
+{
+    char line[TEST_STATUS_LINE_LEN];
+    int32_t threads = -1;
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (fp == NULL) {
+        return threads;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf_s(line, "Threads: %d", &threads) == 1) {
+            break;
+        }
+    }
+    (void)fclose(fp);
+    return threads;
+}
+
+static void ShowIoStats(const struct AcmDevice *acm)
+{
+    struct UsbIoReactorStats reactorStats = {0};
+    struct UsbAdapterRequestPoolStats poolStats = {0};
+    const struct UsbInterfaceHandleEntity *ifaceHdl = NULL;
+
+    printf("threads:%d\n", GetThreadCount());
+    if (UsbIoReactorGetStats(&reactorStats) == HDF_SUCCESS) {
+        printf("reactor threads:%u devices:%u pools:%u releases:%" PRIu64 " wakeups:%" PRIu64
+            " completions:%" PRIu64 " per wakeup:%f\n", reactorStats.threads, reactorStats.devices,
+            reactorStats.pools, reactorStats.releases, reactorStats.wakeups, reactorStats.completions,
+            reactorStats.wakeups ? ((double)reactorStats.completions / reactorStats.wakeups) : 0);
+    }
+
+    ifaceHdl = (const struct UsbInterfaceHandleEntity *)InterfaceIdToHandle(acm, acm->dataPipe->interfaceId);
+    if ((ifaceHdl != NULL) && (UsbAdapterGetRequestPoolStats(ifaceHdl->devHandle, &poolStats) == HDF_SUCCESS)) {
+        printf("request pool hits:%u misses:%u recycled:%u released:%u\n",
+            poolStats.hits, poolStats.misses, poolStats.recycled, poolStats.released);
+    }
+}
+
 int32_t main(int32_t argc, char *argv[])
 {
     struct timeval time;
@@ -457,6 +498,7 @@ int32_t main(int32_t argc, char *argv[])
     while (!g_speedFlag) {
         OsalMSleep(TEST_SLEEP_TIME);
     }
+    ShowIoStats(acm);
 END:
     if (ret != HDF_SUCCESS) {
         printf("please check whether usb drv so is existing or not,like acm,ecm,if not, remove it and test again!\n");
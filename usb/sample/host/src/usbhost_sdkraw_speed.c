@@ -50,6 +50,7 @@ static uint64_t g_recv_count = 0;
 static uint64_t g_byteTotal = 0;
 static bool g_writeOrRead = TEST_WRITE;
 static bool g_printData = false;
+static bool g_syncMode = false;
 static struct OsalSem sem;
 
 static void AcmTestBulkCallback(const void *requestArg);
@@ -555,10 +556,72 @@ void SignalHandler(int32_t signo)
 static void ShowHelp(const char *name)
 {
     printf(">> usage:\n");
-    printf(">>      %s [<busNum> <devAddr>]  <ifaceNum> <w>/<r> [printdata]> \n", name);
+    printf(">>      %s [<busNum> <devAddr>]  <ifaceNum> <w>/<r>/<ws>/<rs> [printdata]> \n", name);
+    printf(">>      ws/rs: sync bulk transfer of %d bytes per request\n", TEST_SYNC_LENGTH);
     printf("\n");
 }
 
+static bool IsSyncMode(const char *mode)
+{
+    return (strlen(mode) == TEST_TWO_TYPE) && (mode[TEST_ONE_TYPE] == 's');
+}
+
+static int32_t UsbSyncSpeedTest(struct AcmDevice *acm)
+{
+    struct UsbRawRequest *request = NULL;
+    struct UsbRequestData reqData;
+    struct timeval startTime, endTime;
+    uint8_t *buf = NULL;
+    int32_t requested = 0;
+    int32_t ret = HDF_SUCCESS;
+
+    request = UsbRawAllocRequest(acm->devHandle, 0, TEST_SYNC_LENGTH);
+    buf = OsalMemCalloc(TEST_SYNC_LENGTH);
+    if ((request == NULL) || (buf == NULL)) {
+        HDF_LOGE("%s: alloc sync request failed", __func__);
+        ret = HDF_ERR_MALLOC_FAIL;
+        goto END;
+    }
+    memset_s(buf, TEST_SYNC_LENGTH, 'b', TEST_SYNC_LENGTH);
+
+    reqData.endPoint  = acm->dataEp->addr;
+    reqData.data      = buf;
+    reqData.length    = TEST_SYNC_LENGTH;
+    reqData.requested = &requested;
+    reqData.timeout   = TEST_SYNC_TIMEOUT;
+
+    gettimeofday(&startTime, NULL);
+    while (!g_speedFlag) {
+        requested = 0;
+        ret = UsbRawSendBulkRequest(request, acm->devHandle, &reqData);
+        if ((ret != HDF_SUCCESS) && (ret != HDF_ERR_TIMEOUT)) {
+            printf("UsbRawSendBulkRequest error, ret=%d\n", ret);
+            break;
+        }
+        g_send_count++;
+        g_byteTotal += (uint64_t)requested;
+    }
+    gettimeofday(&endTime, NULL);
+
+    uint64_t usec = (uint64_t)(endTime.tv_sec - startTime.tv_sec) * TEST_USEC_PER_SEC +
+        (endTime.tv_usec - startTime.tv_usec);
+    if (usec > 0) {
+        double speed = (g_byteTotal * TEST_FLOAT_COUNT * TEST_USEC_PER_SEC) /
+            (usec * TEST_BYTE_COUNT * TEST_BYTE_COUNT);
+        printf("\nSync %s: %" PRIu64 " bytes in %" PRIu64 " requests, %" PRIu64 " us, Speed:%f MB/s\n",
+            (g_writeOrRead == TEST_WRITE) ? "write" : "read", g_byteTotal, g_send_count, usec, speed);
+    }
+
+END:
+    if (request != NULL) {
+        UsbRawFreeRequest(request);
+    }
+    if (buf != NULL) {
+        OsalMemFree(buf);
+    }
+    return ret;
+}
+
 int32_t CheckParam(int32_t argc, const char *argv[])
 {
     int32_t busNum = 1;
@@ -571,6 +634,7 @@ int32_t CheckParam(int32_t argc, const char *argv[])
         devAddr = atoi(argv[TEST_TWO_TYPE]);
         ifaceNum = atoi(argv[TEST_THREE_TYPE]);
         g_writeOrRead = (strncmp(argv[TEST_FOUR_TYPE], "r", TEST_ONE_TYPE)) ? TEST_WRITE : TEST_READ;
+        g_syncMode = IsSyncMode(argv[TEST_FOUR_TYPE]);
         if (g_writeOrRead == TEST_READ) {
             g_printData = (strncmp(argv[TEST_FIVE_TYPE], "printdata", TEST_ONE_TYPE)) ? false : true;
         }
@@ -579,9 +643,11 @@ int32_t CheckParam(int32_t argc, const char *argv[])
         devAddr = atoi(argv[TEST_TWO_TYPE]);
         ifaceNum = atoi(argv[TEST_THREE_TYPE]);
         g_writeOrRead = (strncmp(argv[TEST_FOUR_TYPE], "r", TEST_ONE_TYPE)) ? TEST_WRITE : TEST_READ;
+        g_syncMode = IsSyncMode(argv[TEST_FOUR_TYPE]);
     } else if (argc == TEST_THREE_TYPE) {
         ifaceNum = atoi(argv[TEST_ONE_TYPE]);
         g_writeOrRead = (strncmp(argv[TEST_TWO_TYPE], "r", TEST_ONE_TYPE)) ? TEST_WRITE : TEST_READ;
+        g_syncMode = IsSyncMode(argv[TEST_TWO_TYPE]);
     } else {
         printf("Error: parameter error!\n\n");
         ShowHelp(argv[TEST_ZERO_TYPE]);
@@ -691,7 +757,12 @@ int32_t main(int32_t argc, char *argv[])
     }
     gettimeofday(&time, NULL);
 
-    printf("test SDK rawAPI [%s]\n", g_writeOrRead?"write":"read");
+    printf("test SDK rawAPI [%s]%s\n", g_writeOrRead?"write":"read", g_syncMode ? " sync" : "");
+
+    if (g_syncMode) {
+        ret = UsbSyncSpeedTest(g_acm);
+        goto STOP;
+    }
 
     for (i = 0; i < TEST_CYCLE; i++) {
         if (SerialBegin(g_acm) != HDF_SUCCESS) {
@@ -704,6 +775,7 @@ int32_t main(int32_t argc, char *argv[])
         OsalMSleep(TEST_SLEEP_TIME);
     }
 
+STOP:
     if (UsbStopIo(g_acm) != HDF_SUCCESS) {
         printf("UsbStopIo error!\n");
     }
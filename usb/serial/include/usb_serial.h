@@ -21,12 +21,14 @@
 #include "hdf_device_desc.h"
 #include "usb_ddk.h"
 #include "usb_ddk_interface.h"
+#include "usb_throughput_stats.h"
 
 #define USB_MAX_INTERFACES      32
 #define DATARATE                9600
 #define DATA_BITS_LENGTH        8
 #define ACM_NW                  16
 #define ACM_NR                  16
+#define ACM_REQUEST_SIZE_MAX    65536
 #define READ_BUF_SIZE           8192
 #define DIRECTION_MASK          0x1
 #define USB_CTRL_SET_TIMEOUT    5000
@@ -49,6 +51,7 @@ typedef enum {
     CMD_STD_CTRL_GET_DESCRIPTOR_ASYNC,
     CMD_ADD_INTERFACE,
     CMD_REMOVE_INTERFACE,
+    CMD_GET_STATS,
 } SerialOPCmd;
 
 typedef enum {
@@ -69,6 +72,7 @@ typedef enum {
     HOST_ACM_GET_BAUDRATE,
     HOST_ACM_ADD_INTERFACE,
     HOST_ACM_REMOVE_INTERFACE,
+    HOST_ACM_THROUGHPUT,
 } AcmModuleTestCmdType;
 
 struct AcmDevice;
@@ -135,6 +139,11 @@ struct AcmDevice {
     uint32_t readSize;
     struct UsbCdcLineCoding lineCoding;
     bool initFlag;
+    /* throughput profile, queue depth and request size come from HCS */
+    uint32_t readReqNum;
+    uint32_t readReqSize;
+    bool throughput;
+    struct UsbThroughputStats readStats;
 };
 
 struct UsbControlParams {
@@ -14,6 +14,7 @@
  */
 
 #include "usb_serial.h"
+#include "device_resource_if.h"
 #include "hdf_base.h"
 #include "hdf_log.h"
 #include "hdf_usb_pnp_manage.h"
@@ -571,7 +572,7 @@ static int32_t UsbSerialRead(struct SerialDevice *port, struct HdfSBuf *reply)
     int32_t ret = HDF_SUCCESS;
     struct AcmDevice *acm = port->acm;
 
-    for (int32_t i = 0; i < ACM_NR; i++) {
+    for (uint32_t i = 0; i < acm->readReqNum; i++) {
         if(acm->readReq[i]->compInfo.status != USB_REQUEST_COMPLETED) {
             HDF_LOGE("%s:%d i=%d status=%d!",
                 __func__, __LINE__, i, acm->readReq[i]->compInfo.status);
@@ -889,7 +890,7 @@ static int32_t SerialOpen(const struct SerialDevice *port, struct HdfSBuf *data)
         return  HDF_FAILURE;
     }
 
-    if (cmdType != HOST_ACM_ASYNC_READ) {
+    if ((cmdType != HOST_ACM_ASYNC_READ) && (cmdType != HOST_ACM_THROUGHPUT)) {
         HDF_LOGD("%s:%d asyncRead success", __func__, __LINE__);
         return HDF_SUCCESS;
     }
@@ -907,13 +908,21 @@ static int32_t SerialOpen(const struct SerialDevice *port, struct HdfSBuf *data)
         HDF_LOGE("%s: UsbSerialAllocFifo failed", __func__);
         return  HDF_ERR_INVALID_PARAM;
     }
-    for (int32_t i = 0; i < ACM_NR; i++) {
+    /* the throughput profile keeps all read requests queued and skips the fifo */
+    OsalMutexLock(&acm->readLock);
+    acm->throughput = (cmdType == HOST_ACM_THROUGHPUT);
+    UsbThroughputReset(&acm->readStats);
+    for (uint32_t i = 0; i < acm->readReqNum; i++) {
+        UsbThroughputSubmit(&acm->readStats);
         ret = UsbSubmitRequestAsync(acm->readReq[i]);
         if (HDF_SUCCESS != ret) {
             HDF_LOGE("UsbSubmitRequestAsync  failed, ret = %d ", ret);
+            UsbThroughputCancel(&acm->readStats);
+            OsalMutexUnlock(&acm->readLock);
             goto ERR;
         }
     }
+    OsalMutexUnlock(&acm->readLock);
     return HDF_SUCCESS;
 ERR:
     OsalMemFree(g_acmReadBuffer);
@@ -956,6 +965,7 @@ static int32_t SerialClose(const struct SerialDevice *port, struct HdfSBuf *data
 
     UsbSerialFreeFifo((struct DataFifo *)&port->readFifo);
     AcmRelease(acm);
+    acm->throughput = false;
     return HDF_SUCCESS;
 }
 
@@ -1027,6 +1037,30 @@ static int32_t SerialAddOrRemoveInterface(int32_t cmd, const struct SerialDevice
     return UsbAddOrRemoveInterface(acm->session, acm->busNum, acm->devAddr, index, status);
 }
 
+static int32_t UsbSerialGetStats(const struct SerialDevice *port, struct HdfSBuf *reply)
+{
+    int32_t ret;
+    struct AcmDevice *acm = port->acm;
+
+    if (acm == NULL) {
+        HDF_LOGE("%s: invalid param", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    OsalMutexLock(&acm->readLock);
+    if (!HdfSbufWriteUint32(reply, acm->readReqNum) || !HdfSbufWriteUint32(reply, acm->readSize)) {
+        OsalMutexUnlock(&acm->readLock);
+        HDF_LOGE("%s:%d sbuf write config failed", __func__, __LINE__);
+        return HDF_ERR_IO;
+    }
+    ret = UsbThroughputWriteReply(&acm->readStats, reply);
+    OsalMutexUnlock(&acm->readLock);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s:%d sbuf write stats failed", __func__, __LINE__);
+    }
+    return ret;
+}
+
 static int32_t UsbSerialCheckCmd(struct SerialDevice *port, int32_t cmd,
     struct HdfSBuf *data, const struct HdfSBuf *reply)
 {
@@ -1062,6 +1096,8 @@ static int32_t UsbSerialCheckCmd(struct SerialDevice *port, int32_t cmd,
         case CMD_ADD_INTERFACE:
         case CMD_REMOVE_INTERFACE:
             return SerialAddOrRemoveInterface(cmd, port, data);
+        case CMD_GET_STATS:
+            return UsbSerialGetStats(port, (struct HdfSBuf *)reply);
         default:
             return HDF_ERR_NOT_SUPPORT;
     }
@@ -1358,13 +1394,14 @@ static void AcmReadBulk(struct UsbRequest *req)
         return;
     }
 
+    OsalMutexLock(&acm->readLock);
+    UsbThroughputComplete(&acm->readStats, (uint32_t)size, status == 0);
     switch (status) {
         case 0:
             HDF_LOGD("Bulk status: %d+size:%zu\n", status, size);
-            if (size) {
+            if (size && !acm->throughput) {
                 uint8_t *data = req->compInfo.buffer;
                 uint32_t count;
-                OsalMutexLock(&acm->readLock);
                 if (DataFifoIsFull(&acm->port->readFifo)) {
                     HDF_LOGD("%s:%d", __func__, __LINE__);
                     DataFifoSkip(&acm->port->readFifo, size);
@@ -1374,15 +1411,20 @@ static void AcmReadBulk(struct UsbRequest *req)
                     HDF_LOGW("%s: write %u less than expected %zu",
                         __func__, count, size);
                 }
-                OsalMutexUnlock(&acm->readLock);
             }
             break;
         default:
+            OsalMutexUnlock(&acm->readLock);
             HDF_LOGE("%s:%d status=%d", __func__, __LINE__, status);
             return;
     }
 
+    UsbThroughputSubmit(&acm->readStats);
     retval = UsbSubmitRequestAsync(req);
+    if (retval) {
+        UsbThroughputCancel(&acm->readStats);
+    }
+    OsalMutexUnlock(&acm->readLock);
     if (retval && retval != -EPERM) {
         HDF_LOGE("%s - usb_submit_urb failed: %d", __func__, retval);
     }
@@ -1419,13 +1461,13 @@ static void AcmFreeReadRequests(struct AcmDevice *acm)
         HDF_LOGE("%s: acm is NULL", __func__);
         return;
     }
-    for (i = 0; i < ACM_NR; i++) {
+    for (i = 0; i < (int32_t)acm->readReqNum; i++) {
         ret = UsbCancelRequest(acm->readReq[i]);
         if (ret != HDF_SUCCESS) {
             HDF_LOGE("UsbCancelRequest rd failed, ret=%d ", ret);
         }
     }
-    for (i = 0; i < ACM_NR; i++) {
+    for (i = 0; i < (int32_t)acm->readReqNum; i++) {
         if (acm->readReq[i]) {
             UsbFreeRequest(acm->readReq[i]);
             acm->readReq[i] = NULL;
@@ -1457,7 +1499,7 @@ static int32_t AcmAllocReadRequests(struct AcmDevice *acm)
 {
     int32_t ret;
     struct UsbRequestParams readParmas = {};
-    for (int32_t i = 0; i < ACM_NR; i++) {
+    for (uint32_t i = 0; i < acm->readReqNum; i++) {
         acm->readReq[i] = UsbAllocRequest(InterfaceIdToHandle(acm, acm->dataInPipe->interfaceId), 0, acm->readSize);
         if (!acm->readReq[i]) {
             HDF_LOGE("readReq request failed\n");
@@ -1620,6 +1662,10 @@ static int32_t AcmGetPipes(struct AcmDevice *acm)
     }
 
     acm->readSize  = acm->dataInPipe->maxPacketSize;
+    /* larger read requests must stay a whole number of packets */
+    if ((acm->readSize != 0) && (acm->readReqSize > acm->readSize)) {
+        acm->readSize = acm->readReqSize - acm->readReqSize % acm->readSize;
+    }
     acm->writeSize = acm->dataOutPipe->maxPacketSize;
     acm->ctrlSize  = acm->ctrPipe->maxPacketSize;
     acm->intSize   = acm->intPipe->maxPacketSize;
@@ -1765,6 +1811,31 @@ static void AcmRelease(struct AcmDevice *acm)
     acm->initFlag = false;
 }
 
+static void UsbSerialParseConfig(struct AcmDevice *acm)
+{
+    struct DeviceResourceIface *iface = DeviceResourceGetIfaceInstance(HDF_CONFIG_SOURCE);
+
+    acm->readReqNum = ACM_NR;
+    acm->readReqSize = 0;
+    if ((iface == NULL) || (iface->GetUint32 == NULL) || (acm->device->property == NULL)) {
+        HDF_LOGD("%s:%d no config, use default", __func__, __LINE__);
+        return;
+    }
+    if (iface->GetUint32(acm->device->property, "queue_size", &acm->readReqNum, ACM_NR) != HDF_SUCCESS) {
+        HDF_LOGD("%s:%d read queue_size failed, use default", __func__, __LINE__);
+    }
+    if (iface->GetUint32(acm->device->property, "request_size", &acm->readReqSize, 0) != HDF_SUCCESS) {
+        HDF_LOGD("%s:%d read request_size failed, use default", __func__, __LINE__);
+    }
+    if ((acm->readReqNum == 0) || (acm->readReqNum > ACM_NR)) {
+        HDF_LOGW("%s:%d queue_size %u out of range", __func__, __LINE__, acm->readReqNum);
+        acm->readReqNum = ACM_NR;
+    }
+    if (acm->readReqSize > ACM_REQUEST_SIZE_MAX) {
+        acm->readReqSize = ACM_REQUEST_SIZE_MAX;
+    }
+}
+
 static int32_t UsbSerialDriverInit(struct HdfDeviceObject *device)
 {
     int32_t ret;
@@ -1781,6 +1852,7 @@ static int32_t UsbSerialDriverInit(struct HdfDeviceObject *device)
     OsalMutexInit(&acm->readLock);
     OsalMutexInit(&acm->writeLock);
     HDF_LOGD("%s:%d busNum = %d,devAddr = %d",  __func__, __LINE__, acm->busNum, acm->devAddr);
+    UsbSerialParseConfig(acm);
 
     ret = UsbSerialDeviceAlloc(acm);
     if (ret != HDF_SUCCESS) {
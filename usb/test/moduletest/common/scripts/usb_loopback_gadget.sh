@@ -0,0 +1,91 @@
+#!/bin/bash
+# Copyright (c) 2021 Huawei Device Co., Ltd.
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Bring up a bulk loopback gadget on dummy_hcd for usbhost_loopback_bench:
+#   usb_loopback_gadget.sh start [bulk_buflen] [qlen]
+#   usb_loopback_gadget.sh stop
+# start prints the busNum and devAddr to pass with -b and -d.
+
+set -e
+
+gadget_dir="/sys/kernel/config/usb_gadget/hdf_loopback"
+vendor_id="0x1a0a"
+product_id="0xbadd"
+buflen=${2:-16384}
+qlen=${3:-32}
+
+stop_gadget()
+{
+    if [ ! -d "${gadget_dir}" ];then
+        return
+    fi
+    echo "" > ${gadget_dir}/UDC 2>/dev/null || true
+    rm -f ${gadget_dir}/configs/c.1/Loopback.0
+    rmdir ${gadget_dir}/configs/c.1/strings/0x409 2>/dev/null || true
+    rmdir ${gadget_dir}/configs/c.1 2>/dev/null || true
+    rmdir ${gadget_dir}/functions/Loopback.0 2>/dev/null || true
+    rmdir ${gadget_dir}/strings/0x409 2>/dev/null || true
+    rmdir ${gadget_dir}
+}
+
+start_gadget()
+{
+    modprobe dummy_hcd
+    modprobe libcomposite
+    modprobe usb_f_ss_lb
+    mountpoint -q /sys/kernel/config || mount -t configfs none /sys/kernel/config
+
+    stop_gadget
+    mkdir -p ${gadget_dir}
+    echo ${vendor_id} > ${gadget_dir}/idVendor
+    echo ${product_id} > ${gadget_dir}/idProduct
+    mkdir -p ${gadget_dir}/strings/0x409
+    echo "hdf" > ${gadget_dir}/strings/0x409/manufacturer
+    echo "loopback bench" > ${gadget_dir}/strings/0x409/product
+
+    mkdir -p ${gadget_dir}/functions/Loopback.0
+    echo ${buflen} > ${gadget_dir}/functions/Loopback.0/bulk_buflen
+    echo ${qlen} > ${gadget_dir}/functions/Loopback.0/qlen
+
+    mkdir -p ${gadget_dir}/configs/c.1/strings/0x409
+    echo "loopback" > ${gadget_dir}/configs/c.1/strings/0x409/configuration
+    ln -s ${gadget_dir}/functions/Loopback.0 ${gadget_dir}/configs/c.1/
+    ls /sys/class/udc | grep dummy_udc | head -n 1 > ${gadget_dir}/UDC
+
+    for i in $(seq 1 50);do
+        for dev in /sys/bus/usb/devices/*;do
+            if [ -f ${dev}/idVendor ] && [ "0x$(cat ${dev}/idVendor)" == "${vendor_id}" ] &&
+                [ "0x$(cat ${dev}/idProduct)" == "${product_id}" ];then
+                echo "busNum=$(cat ${dev}/busnum) devAddr=$(cat ${dev}/devnum)"
+                return
+            fi
+        done
+        sleep 0.1
+    done
+    echo "loopback gadget did not enumerate"
+    exit 1
+}
+
+case "$1" in
+    start)
+        start_gadget
+        ;;
+    stop)
+        stop_gadget
+        ;;
+    *)
+        echo "usage: $0 start [bulk_buflen] [qlen] | stop"
+        exit 1
+        ;;
+esac
@@ -37,11 +37,58 @@ const uint8_t INTERFACEID_1 = 1;
 const uint8_t POINTID_1 = 1;
 const uint8_t POINTID_129 = 129;
 
+const uint32_t STREAM_REQ_SIZE = 16384;
+const uint32_t STREAM_QUEUE_DEPTH = 8;
+const uint32_t STREAM_RING_SIZE = 65536;
+const uint32_t STREAM_WRITE_LENGTH = 40000;
+const uint8_t STREAM_RING_FILL = 0xA5;
+const int32_t STREAM_WAIT_MS = 5000;
+const int32_t STREAM_POLL_MS = 10;
+const int32_t US_PER_MS = 1000;
+
 using namespace testing::ext;
 using namespace OHOS;
 using namespace OHOS::USB;
 using namespace std;
 
+static sptr<Ashmem> CreateStreamAshmem(uint32_t producer)
+{
+    UsbdBulkStreamHeader header = {USBD_BULK_STREAM_MAGIC, sizeof(UsbdBulkStreamHeader), STREAM_RING_SIZE, 0,
+        producer, 0, 0, 0};
+    std::vector<uint8_t> ring(STREAM_RING_SIZE, STREAM_RING_FILL);
+    for (uint32_t i = 0; i < producer; i++) {
+        ring[i] = static_cast<uint8_t>(i);
+    }
+    sptr<Ashmem> ashmem = Ashmem::CreateAshmem("usbd_stream_test", sizeof(header) + STREAM_RING_SIZE);
+    if ((ashmem == nullptr) || !ashmem->MapReadAndWriteAshmem() ||
+        !ashmem->WriteToAshmem(&header, sizeof(header), 0) ||
+        !ashmem->WriteToAshmem(ring.data(), STREAM_RING_SIZE, sizeof(header))) {
+        return nullptr;
+    }
+    return ashmem;
+}
+
+static const UsbdBulkStreamHeader *StreamHeader(const sptr<Ashmem> &ashmem)
+{
+    return static_cast<const UsbdBulkStreamHeader *>(ashmem->ReadFromAshmem(sizeof(UsbdBulkStreamHeader), 0));
+}
+
+static const uint8_t *StreamRing(const sptr<Ashmem> &ashmem)
+{
+    return static_cast<const uint8_t *>(ashmem->ReadFromAshmem(STREAM_RING_SIZE, sizeof(UsbdBulkStreamHeader)));
+}
+
+/* Waits for the index the service moves to reach target and returns where it stopped. */
+static uint32_t WaitStreamIndex(const uint32_t *index, uint32_t target)
+{
+    uint32_t value = __atomic_load_n(index, __ATOMIC_SEQ_CST);
+    for (int32_t waited = 0; (value < target) && (waited < STREAM_WAIT_MS); waited += STREAM_POLL_MS) {
+        usleep(STREAM_POLL_MS * US_PER_MS);
+        value = __atomic_load_n(index, __ATOMIC_SEQ_CST);
+    }
+    return value;
+}
+
 void UsbdTransferTest::SetUpTestCase(void)
 {
     auto ret = UsbdClient::GetInstance().SetPortRole(1, 1, 1);
@@ -1492,3 +1539,184 @@ HWTEST_F(UsbdTransferTest, UsbdIsoTransferWrite008, TestSize.Level1)
     HDF_LOGI("UsbdTransferTest::UsbdIsoTransferWrite008 %{public}d IsoTransferWrite=%{public}d", __LINE__, ret);
     ASSERT_TRUE(ret == 0);
 }
+
+/**
+ * @tc.name: UsbdBulkStreamConfig001
+ * @tc.desc: Test functions to BulkStreamConfig(const UsbDev &dev, const UsbPipe &pipe, uint32_t requestSize,
+ * uint32_t queueDepth);
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbdTransferTest, UsbdBulkStreamConfig001, TestSize.Level1)
+{
+    struct UsbDev dev = {BUS_NUM_1, DEV_ADDR_2};
+    uint8_t interfaceId = INTERFACEID_1;
+    uint8_t pointid = POINTID_129;
+    auto ret = UsbdClient::GetInstance().ClaimInterface(dev, interfaceId, true);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamConfig001 %{public}d ClaimInterface=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret == 0);
+    struct UsbPipe pipe = {interfaceId, pointid};
+    ret = UsbdClient::GetInstance().BulkStreamConfig(dev, pipe, STREAM_REQ_SIZE, STREAM_QUEUE_DEPTH);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamConfig001 %{public}d BulkStreamConfig=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret == 0);
+}
+
+/**
+ * @tc.name: UsbdBulkStreamConfig002
+ * @tc.desc: Test functions to BulkStreamConfig(const UsbDev &dev, const UsbPipe &pipe, uint32_t requestSize,
+ * uint32_t queueDepth);
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbdTransferTest, UsbdBulkStreamConfig002, TestSize.Level1)
+{
+    struct UsbDev dev = {BUS_NUM_1, DEV_ADDR_2};
+    uint8_t interfaceId = INTERFACEID_1;
+    uint8_t pointid = POINTID_129;
+    auto ret = UsbdClient::GetInstance().ClaimInterface(dev, interfaceId, true);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamConfig002 %{public}d ClaimInterface=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret == 0);
+    struct UsbPipe pipe = {interfaceId, pointid};
+    ret = UsbdClient::GetInstance().BulkStreamConfig(dev, pipe, USBD_BULK_STREAM_REQ_SIZE_MAX + 1,
+        STREAM_QUEUE_DEPTH);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamConfig002 %{public}d BulkStreamConfig=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret != 0);
+    ret = UsbdClient::GetInstance().BulkStreamConfig(dev, pipe, STREAM_REQ_SIZE, 0);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamConfig002 %{public}d BulkStreamConfig=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret != 0);
+}
+
+/**
+ * @tc.name: UsbdBulkStreamKick001
+ * @tc.desc: Test functions to BulkStreamKick(const UsbDev &dev, const UsbPipe &pipe);
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbdTransferTest, UsbdBulkStreamKick001, TestSize.Level1)
+{
+    struct UsbDev dev = {BUS_NUM_1, DEV_ADDR_2};
+    uint8_t interfaceId = INTERFACEID_1;
+    uint8_t pointid = POINTID_129;
+    auto ret = UsbdClient::GetInstance().ClaimInterface(dev, interfaceId, true);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamKick001 %{public}d ClaimInterface=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret == 0);
+    struct UsbPipe pipe = {interfaceId, pointid};
+    ret = UsbdClient::GetInstance().BulkStreamKick(dev, pipe);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamKick001 %{public}d BulkStreamKick=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret != 0);
+}
+
+/**
+ * @tc.name: UsbdGetBulkStats001
+ * @tc.desc: Test functions to GetBulkStats(const UsbDev &dev, const UsbPipe &pipe, UsbdBulkStats &stats);
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbdTransferTest, UsbdGetBulkStats001, TestSize.Level1)
+{
+    struct UsbDev dev = {BUS_NUM_1, DEV_ADDR_2};
+    uint8_t interfaceId = INTERFACEID_1;
+    uint8_t pointid = POINTID_129;
+    auto ret = UsbdClient::GetInstance().ClaimInterface(dev, interfaceId, true);
+    HDF_LOGI("UsbdTransferTest::UsbdGetBulkStats001 %{public}d ClaimInterface=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret == 0);
+    struct UsbPipe pipe = {interfaceId, pointid};
+    ret = UsbdClient::GetInstance().BulkStreamConfig(dev, pipe, STREAM_REQ_SIZE, STREAM_QUEUE_DEPTH);
+    ASSERT_TRUE(ret == 0);
+    struct UsbdBulkStats stats = {0};
+    ret = UsbdClient::GetInstance().GetBulkStats(dev, pipe, stats);
+    HDF_LOGI("UsbdTransferTest::UsbdGetBulkStats001 %{public}d GetBulkStats=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret == 0);
+    ASSERT_TRUE(stats.errors == 0);
+}
+
+/**
+ * @tc.name: UsbdBulkStreamWrite001
+ * @tc.desc: Test functions to BulkStreamWrite(const UsbDev &dev, const UsbPipe &pipe, sptr<Ashmem> &ashmem);
+ * every queued byte is sent once and the ring is left as the client wrote it
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbdTransferTest, UsbdBulkStreamWrite001, TestSize.Level1)
+{
+    struct UsbDev dev = {BUS_NUM_1, DEV_ADDR_2};
+    uint8_t interfaceId = INTERFACEID_1;
+    uint8_t pointid = POINTID_1;
+    auto ret = UsbdClient::GetInstance().ClaimInterface(dev, interfaceId, true);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamWrite001 %{public}d ClaimInterface=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret == 0);
+    struct UsbPipe pipe = {interfaceId, pointid};
+    ret = UsbdClient::GetInstance().BulkStreamConfig(dev, pipe, STREAM_REQ_SIZE, STREAM_QUEUE_DEPTH);
+    ASSERT_TRUE(ret == 0);
+    struct UsbdBulkStats before = {0};
+    ret = UsbdClient::GetInstance().GetBulkStats(dev, pipe, before);
+    ASSERT_TRUE(ret == 0);
+    sptr<Ashmem> ashmem = CreateStreamAshmem(STREAM_WRITE_LENGTH);
+    ASSERT_TRUE(ashmem != nullptr);
+    const UsbdBulkStreamHeader *header = StreamHeader(ashmem);
+    ASSERT_TRUE(header != nullptr);
+
+    ret = UsbdClient::GetInstance().BulkStreamWrite(dev, pipe, ashmem);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamWrite001 %{public}d BulkStreamWrite=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret == 0);
+    uint32_t consumer = WaitStreamIndex(&header->consumer, STREAM_WRITE_LENGTH);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamWrite001 %{public}d consumer=%{public}u", __LINE__, consumer);
+    EXPECT_EQ(consumer, STREAM_WRITE_LENGTH);
+    EXPECT_EQ(__atomic_load_n(&header->status, __ATOMIC_SEQ_CST), 0);
+
+    struct UsbdBulkStats after = {0};
+    ret = UsbdClient::GetInstance().GetBulkStats(dev, pipe, after);
+    ASSERT_TRUE(ret == 0);
+    EXPECT_EQ(after.bytes - before.bytes, STREAM_WRITE_LENGTH);
+    EXPECT_EQ(after.errors, before.errors);
+    const uint8_t *ring = StreamRing(ashmem);
+    ASSERT_TRUE(ring != nullptr);
+    for (uint32_t i = 0; i < STREAM_RING_SIZE; i++) {
+        ASSERT_EQ(ring[i], (i < STREAM_WRITE_LENGTH) ? static_cast<uint8_t>(i) : STREAM_RING_FILL) << "offset " << i;
+    }
+    ret = UsbdClient::GetInstance().BulkCancel(dev, pipe);
+    ASSERT_TRUE(ret == 0);
+}
+
+/**
+ * @tc.name: UsbdBulkStreamRead001
+ * @tc.desc: Test functions to BulkStreamRead(const UsbDev &dev, const UsbPipe &pipe, sptr<Ashmem> &ashmem);
+ * the producer index counts exactly the bytes received and nothing past it is written
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbdTransferTest, UsbdBulkStreamRead001, TestSize.Level1)
+{
+    struct UsbDev dev = {BUS_NUM_1, DEV_ADDR_2};
+    uint8_t interfaceId = INTERFACEID_1;
+    uint8_t pointid = POINTID_129;
+    auto ret = UsbdClient::GetInstance().ClaimInterface(dev, interfaceId, true);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamRead001 %{public}d ClaimInterface=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret == 0);
+    struct UsbPipe pipe = {interfaceId, pointid};
+    ret = UsbdClient::GetInstance().BulkStreamConfig(dev, pipe, STREAM_REQ_SIZE, STREAM_QUEUE_DEPTH);
+    ASSERT_TRUE(ret == 0);
+    struct UsbdBulkStats before = {0};
+    ret = UsbdClient::GetInstance().GetBulkStats(dev, pipe, before);
+    ASSERT_TRUE(ret == 0);
+    sptr<Ashmem> ashmem = CreateStreamAshmem(0);
+    ASSERT_TRUE(ashmem != nullptr);
+    const UsbdBulkStreamHeader *header = StreamHeader(ashmem);
+    ASSERT_TRUE(header != nullptr);
+
+    ret = UsbdClient::GetInstance().BulkStreamRead(dev, pipe, ashmem);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamRead001 %{public}d BulkStreamRead=%{public}d", __LINE__, ret);
+    ASSERT_TRUE(ret == 0);
+    uint32_t producer = WaitStreamIndex(&header->producer, 1);
+    ret = UsbdClient::GetInstance().BulkCancel(dev, pipe);
+    ASSERT_TRUE(ret == 0);
+    producer = __atomic_load_n(&header->producer, __ATOMIC_SEQ_CST);
+    HDF_LOGI("UsbdTransferTest::UsbdBulkStreamRead001 %{public}d producer=%{public}u", __LINE__, producer);
+    ASSERT_TRUE(producer > 0);
+    /* the client never consumed, so the service stops at a full ring */
+    ASSERT_TRUE(producer <= STREAM_RING_SIZE);
+
+    struct UsbdBulkStats after = {0};
+    ret = UsbdClient::GetInstance().GetBulkStats(dev, pipe, after);
+    ASSERT_TRUE(ret == 0);
+    EXPECT_EQ(after.bytes - before.bytes, producer);
+    const uint8_t *ring = StreamRing(ashmem);
+    ASSERT_TRUE(ring != nullptr);
+    for (uint32_t i = producer; i < STREAM_RING_SIZE; i++) {
+        ASSERT_EQ(ring[i], STREAM_RING_FILL) << "offset " << i;
+    }
+}
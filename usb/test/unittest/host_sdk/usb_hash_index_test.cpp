@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <gtest/gtest.h>
+extern "C" {
+#include "usb_hash_index.h"
+#include "securec.h"
+}
+
+using namespace std;
+using namespace testing::ext;
+namespace {
+const uint32_t FAKE_DEV_NUM = 64;
+const uint32_t FAKE_BUS_NUM = 4;
+const uint32_t FAKE_PIPE_NUM = 8;
+const uint32_t FAKE_IN_DIR = 0x80;
+const uint32_t BENCH_ROUNDS = 2000;
+const uint32_t HOTPLUG_ROUNDS = 20000;
+
+struct FakePipe {
+    struct UsbHashNode hashNode;
+    uint8_t interfaceId;
+    uint8_t pipeAddr;
+};
+
+/* Stands in for a usbd HostDevice: kept on a plain list and in the hashed index. */
+struct FakeDevice {
+    struct FakeDevice *next;
+    struct UsbHashNode hashNode;
+    uint8_t busNum;
+    uint8_t devAddr;
+    struct UsbHashIndex pipeIndex;
+    struct FakePipe pipes[FAKE_PIPE_NUM];
+};
+
+static uint8_t FakeBusNum(uint32_t i)
+{
+    return static_cast<uint8_t>(i % FAKE_BUS_NUM + 1);
+}
+
+static uint8_t FakeDevAddr(uint32_t i)
+{
+    return static_cast<uint8_t>(i / FAKE_BUS_NUM + 1);
+}
+
+static uint8_t FakePipeAddr(uint32_t p)
+{
+    return static_cast<uint8_t>((p / 2 + 1) | ((p % 2) ? FAKE_IN_DIR : 0));
+}
+
+class UsbHashIndexTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+    void Attach(uint32_t i);
+    void Detach(uint32_t i);
+    struct FakeDevice *LinearFind(uint8_t busNum, uint8_t devAddr);
+    struct FakeDevice *HashFind(uint8_t busNum, uint8_t devAddr);
+    struct FakeDevice devs_[FAKE_DEV_NUM];
+    struct FakeDevice *devList_;
+    pthread_mutex_t listLock_;
+    struct UsbHashIndex devIndex_;
+};
+
+void UsbHashIndexTest::SetUpTestCase()
+{
+}
+
+void UsbHashIndexTest::TearDownTestCase()
+{
+}
+
+void UsbHashIndexTest::SetUp()
+{
+    (void)memset_s(devs_, sizeof(devs_), 0, sizeof(devs_));
+    devList_ = nullptr;
+    (void)pthread_mutex_init(&listLock_, nullptr);
+    ASSERT_EQ(HDF_SUCCESS, UsbHashIndexInit(&devIndex_));
+    for (uint32_t i = 0; i < FAKE_DEV_NUM; i++) {
+        struct FakeDevice *dev = &devs_[i];
+        dev->busNum = FakeBusNum(i);
+        dev->devAddr = FakeDevAddr(i);
+        ASSERT_EQ(HDF_SUCCESS, UsbHashIndexInit(&dev->pipeIndex));
+        for (uint32_t p = 0; p < FAKE_PIPE_NUM; p++) {
+            struct FakePipe *pipe = &dev->pipes[p];
+            pipe->interfaceId = static_cast<uint8_t>(p / 2);
+            pipe->pipeAddr = FakePipeAddr(p);
+            UsbHashIndexInsert(&dev->pipeIndex, &pipe->hashNode,
+                USB_HASH_PIPE_KEY(pipe->interfaceId, pipe->pipeAddr));
+        }
+        Attach(i);
+    }
+}
+
+void UsbHashIndexTest::TearDown()
+{
+    for (uint32_t i = 0; i < FAKE_DEV_NUM; i++) {
+        UsbHashIndexDestroy(&devs_[i].pipeIndex);
+    }
+    UsbHashIndexDestroy(&devIndex_);
+    (void)pthread_mutex_destroy(&listLock_);
+}
+
+void UsbHashIndexTest::Attach(uint32_t i)
+{
+    struct FakeDevice *dev = &devs_[i];
+
+    (void)pthread_mutex_lock(&listLock_);
+    dev->next = devList_;
+    devList_ = dev;
+    (void)pthread_mutex_unlock(&listLock_);
+    UsbHashIndexInsert(&devIndex_, &dev->hashNode, USB_HASH_DEV_KEY(dev->busNum, dev->devAddr));
+}
+
+void UsbHashIndexTest::Detach(uint32_t i)
+{
+    struct FakeDevice *dev = &devs_[i];
+
+    (void)pthread_mutex_lock(&listLock_);
+    for (struct FakeDevice **link = &devList_; *link != nullptr; link = &(*link)->next) {
+        if (*link == dev) {
+            *link = dev->next;
+            break;
+        }
+    }
+    (void)pthread_mutex_unlock(&listLock_);
+    (void)UsbHashIndexRemove(&devIndex_, &dev->hashNode);
+}
+
+/* what FindDevFromService used to do on every request */
+struct FakeDevice *UsbHashIndexTest::LinearFind(uint8_t busNum, uint8_t devAddr)
+{
+    struct FakeDevice *dev = nullptr;
+
+    (void)pthread_mutex_lock(&listLock_);
+    for (dev = devList_; dev != nullptr; dev = dev->next) {
+        if (dev->busNum == busNum && dev->devAddr == devAddr) {
+            break;
+        }
+    }
+    (void)pthread_mutex_unlock(&listLock_);
+    return dev;
+}
+
+struct FakeDevice *UsbHashIndexTest::HashFind(uint8_t busNum, uint8_t devAddr)
+{
+    struct UsbHashNode *node = UsbHashIndexFind(&devIndex_, USB_HASH_DEV_KEY(busNum, devAddr), nullptr, nullptr);
+    if (node == nullptr) {
+        return nullptr;
+    }
+    return USB_HASH_INDEX_ENTRY(node, struct FakeDevice, hashNode);
+}
+
+static bool FakePipeIsIn(const struct UsbHashNode *node, const void *arg)
+{
+    (void)arg;
+    const struct FakePipe *pipe = USB_HASH_INDEX_ENTRY(node, const struct FakePipe, hashNode);
+    return (pipe->pipeAddr & FAKE_IN_DIR) != 0;
+}
+
+/**
+ * @tc.name: UsbHashIndexFind001
+ * @tc.desc: every attached device and each of its pipes is found by key
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbHashIndexTest, UsbHashIndexFind001, TestSize.Level1)
+{
+    EXPECT_EQ(FAKE_DEV_NUM, UsbHashIndexCount(&devIndex_));
+    for (uint32_t i = 0; i < FAKE_DEV_NUM; i++) {
+        EXPECT_EQ(&devs_[i], HashFind(FakeBusNum(i), FakeDevAddr(i)));
+        for (uint32_t p = 0; p < FAKE_PIPE_NUM; p++) {
+            struct FakePipe *pipe = &devs_[i].pipes[p];
+            struct UsbHashNode *node = UsbHashIndexFind(&devs_[i].pipeIndex,
+                USB_HASH_PIPE_KEY(pipe->interfaceId, pipe->pipeAddr), nullptr, nullptr);
+            EXPECT_EQ(&pipe->hashNode, node);
+        }
+    }
+    EXPECT_EQ(nullptr, HashFind(FAKE_BUS_NUM + 1, 1));
+    EXPECT_EQ(nullptr, HashFind(1, FAKE_DEV_NUM));
+}
+
+/**
+ * @tc.name: UsbHashIndexHotplug001
+ * @tc.desc: detached devices drop out of the index and come back on reattach
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbHashIndexTest, UsbHashIndexHotplug001, TestSize.Level1)
+{
+    for (uint32_t i = 0; i < FAKE_DEV_NUM; i += 2) {
+        Detach(i);
+    }
+    EXPECT_EQ(FAKE_DEV_NUM / 2, UsbHashIndexCount(&devIndex_));
+    EXPECT_FALSE(UsbHashIndexRemove(&devIndex_, &devs_[0].hashNode));
+    for (uint32_t i = 0; i < FAKE_DEV_NUM; i++) {
+        EXPECT_EQ((i % 2) ? &devs_[i] : nullptr, HashFind(FakeBusNum(i), FakeDevAddr(i)));
+        EXPECT_EQ(LinearFind(FakeBusNum(i), FakeDevAddr(i)), HashFind(FakeBusNum(i), FakeDevAddr(i)));
+    }
+    for (uint32_t i = 0; i < FAKE_DEV_NUM; i += 2) {
+        Attach(i);
+    }
+    EXPECT_EQ(FAKE_DEV_NUM, UsbHashIndexCount(&devIndex_));
+    for (uint32_t i = 0; i < FAKE_DEV_NUM; i++) {
+        EXPECT_EQ(&devs_[i], HashFind(FakeBusNum(i), FakeDevAddr(i)));
+    }
+}
+
+/**
+ * @tc.name: UsbHashIndexMatch001
+ * @tc.desc: the match callback picks one of several nodes sharing a bucket
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbHashIndexTest, UsbHashIndexMatch001, TestSize.Level1)
+{
+    struct UsbHashIndex index;
+    struct FakePipe out = {{nullptr, 0}, 0, 0x01};
+    struct FakePipe in = {{nullptr, 0}, 0, 0x81};
+
+    ASSERT_EQ(HDF_SUCCESS, UsbHashIndexInit(&index));
+    /* same key on purpose, only the callback tells them apart */
+    UsbHashIndexInsert(&index, &out.hashNode, USB_HASH_PIPE_KEY(0, 1));
+    UsbHashIndexInsert(&index, &in.hashNode, USB_HASH_PIPE_KEY(0, 1));
+    EXPECT_EQ(&in.hashNode, UsbHashIndexFind(&index, USB_HASH_PIPE_KEY(0, 1), FakePipeIsIn, nullptr));
+    EXPECT_TRUE(UsbHashIndexRemove(&index, &in.hashNode));
+    EXPECT_EQ(nullptr, UsbHashIndexFind(&index, USB_HASH_PIPE_KEY(0, 1), FakePipeIsIn, nullptr));
+    EXPECT_EQ(&out.hashNode, UsbHashIndexFind(&index, USB_HASH_PIPE_KEY(0, 1), nullptr, nullptr));
+    UsbHashIndexDestroy(&index);
+}
+
+/**
+ * @tc.name: UsbHashIndexConcurrent001
+ * @tc.desc: lookups of stable devices keep succeeding while another device is hotplugged
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbHashIndexTest, UsbHashIndexConcurrent001, TestSize.Level1)
+{
+    std::atomic<bool> stop(false);
+    std::atomic<uint32_t> misses(0);
+    const uint32_t hotplugDev = FAKE_DEV_NUM - 1;
+
+    std::thread reader([&]() {
+        while (!stop.load()) {
+            for (uint32_t i = 0; i < hotplugDev; i++) {
+                if (HashFind(FakeBusNum(i), FakeDevAddr(i)) != &devs_[i]) {
+                    misses++;
+                }
+            }
+        }
+    });
+    for (uint32_t n = 0; n < HOTPLUG_ROUNDS; n++) {
+        Detach(hotplugDev);
+        Attach(hotplugDev);
+    }
+    stop = true;
+    reader.join();
+    EXPECT_EQ(0U, misses.load());
+    EXPECT_EQ(FAKE_DEV_NUM, UsbHashIndexCount(&devIndex_));
+}
+
+/**
+ * @tc.name: UsbHashIndexBenchmark001
+ * @tc.desc: per-lookup cost of the list walk and the hashed index with 64 attached devices
+ * @tc.type: PERF
+ */
+HWTEST_F(UsbHashIndexTest, UsbHashIndexBenchmark001, TestSize.Level1)
+{
+    uint32_t found = 0;
+    const uint32_t lookups = BENCH_ROUNDS * FAKE_DEV_NUM * FAKE_PIPE_NUM;
+
+    auto start = chrono::steady_clock::now();
+    for (uint32_t n = 0; n < BENCH_ROUNDS; n++) {
+        for (uint32_t i = 0; i < FAKE_DEV_NUM; i++) {
+            for (uint32_t p = 0; p < FAKE_PIPE_NUM; p++) {
+                found += (LinearFind(FakeBusNum(i), FakeDevAddr(i)) != nullptr) ? 1 : 0;
+            }
+        }
+    }
+    auto linearNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(lookups, found);
+
+    found = 0;
+    start = chrono::steady_clock::now();
+    for (uint32_t n = 0; n < BENCH_ROUNDS; n++) {
+        for (uint32_t i = 0; i < FAKE_DEV_NUM; i++) {
+            for (uint32_t p = 0; p < FAKE_PIPE_NUM; p++) {
+                /* a transfer resolves its device and then its pipe */
+                struct FakeDevice *dev = HashFind(FakeBusNum(i), FakeDevAddr(i));
+                found += (dev != nullptr && UsbHashIndexFind(&dev->pipeIndex,
+                    USB_HASH_PIPE_KEY(dev->pipes[p].interfaceId, dev->pipes[p].pipeAddr), nullptr, nullptr) != nullptr)
+                    ? 1 : 0;
+            }
+        }
+    }
+    auto hashNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(lookups, found);
+
+    printf("%u devices, %u lookups: list walk %.1f ns/lookup, hashed index (device + pipe) %.1f ns/lookup\n",
+        FAKE_DEV_NUM, lookups, static_cast<double>(linearNs) / lookups, static_cast<double>(hashNs) / lookups);
+}
+}
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <deque>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <gtest/gtest.h>
+extern "C" {
+#include "linux_adapter.h"
+#include "securec.h"
+#include "usb_io_reactor.h"
+#include "usb_raw_api_library.h"
+}
+
+using namespace std;
+using namespace testing::ext;
+namespace {
+const uint32_t WAIT_MS = 2000;
+const uint32_t POLL_MS = 1;
+const size_t DRAIN_SIZE = 4096;
+
+/*
+ * Stands in for the usbfs fd of a device: the write end of a pipe is writable, like usbfs reports POLLOUT,
+ * only while the test left completions to reap. The pool of each completion plays the request callback
+ * OsUrbCompletion runs, which is how a reaped urb reaches the pool that submitted it.
+ */
+struct FakeDevice {
+    struct UsbDevice device;
+    struct UsbDeviceHandle devHandle;
+    int32_t readFd;
+    deque<struct UsbInterfacePool *> pending;
+    bool gone;
+};
+
+mutex g_fakeLock;
+map<const struct UsbDeviceHandle *, struct FakeDevice *> g_fakeDevices;
+map<const struct UsbInterfacePool *, uint32_t> g_completions;
+map<const struct UsbDeviceHandle *, uint32_t> g_batches;
+struct UsbOsAdapterOps g_fakeOps;
+
+void FillPipe(int32_t fd)
+{
+    char buf[DRAIN_SIZE] = {0};
+    while (write(fd, buf, sizeof(buf)) > 0) {
+    }
+}
+
+void DrainPipe(int32_t fd)
+{
+    char buf[DRAIN_SIZE];
+    while (read(fd, buf, sizeof(buf)) > 0) {
+    }
+}
+
+int32_t FakeUrbCompleteBatch(const struct UsbDeviceHandle *devHandle, uint32_t maxUrbs)
+{
+    (void)devHandle;
+    (void)maxUrbs;
+    return 0;
+}
+
+template<typename Pred>
+bool WaitFor(Pred pred)
+{
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(WAIT_MS);
+    while (chrono::steady_clock::now() < deadline) {
+        {
+            lock_guard<mutex> lock(g_fakeLock);
+            if (pred()) {
+                return true;
+            }
+        }
+        this_thread::sleep_for(chrono::milliseconds(POLL_MS));
+    }
+    return false;
+}
+}
+
+extern "C" {
+struct UsbOsAdapterOps *UsbAdapterGetOps(void)
+{
+    return &g_fakeOps;
+}
+
+int32_t RawHandleRequestBatch(const struct UsbDeviceHandle *devHandle, uint32_t maxUrbs)
+{
+    lock_guard<mutex> lock(g_fakeLock);
+    struct FakeDevice *dev = g_fakeDevices[devHandle];
+    int32_t count = 0;
+
+    g_batches[devHandle]++;
+    if (dev->gone) {
+        return HDF_DEV_ERR_NO_DEVICE;
+    }
+    while (!dev->pending.empty() && static_cast<uint32_t>(count) < maxUrbs) {
+        g_completions[dev->pending.front()]++;
+        dev->pending.pop_front();
+        count++;
+    }
+    if (dev->pending.empty()) {
+        FillPipe(dev->devHandle.fd);
+    }
+    return count;
+}
+
+UsbRawTidType RawGetTid(void)
+{
+    return static_cast<UsbRawTidType>(syscall(SYS_gettid));
+}
+
+void *RawUsbMemCalloc(size_t size)
+{
+    return calloc(1, size);
+}
+
+void RawUsbMemFree(void *mem)
+{
+    free(mem);
+}
+}
+
+namespace {
+class UsbIoReactorTest : public testing::Test {
+public:
+    void SetUp() override;
+    void TearDown() override;
+
+protected:
+    void InitPool(struct UsbInterfacePool &pool);
+    void Complete(struct UsbInterfacePool &pool, uint32_t num);
+    uint32_t Completions(const struct UsbInterfacePool &pool);
+    static UsbPoolProcessStatusType StopStatus(struct UsbInterfacePool &pool);
+
+    struct FakeDevice dev_;
+    struct UsbInterfacePool poolA_;
+    struct UsbInterfacePool poolB_;
+};
+
+void UsbIoReactorTest::SetUp()
+{
+    int32_t fds[2];
+
+    g_fakeOps.urbCompleteBatch = FakeUrbCompleteBatch;
+    ASSERT_EQ(pipe2(fds, O_NONBLOCK | O_CLOEXEC), 0);
+    dev_.readFd = fds[0];
+    dev_.devHandle.fd = fds[1];
+    dev_.devHandle.dev = &dev_.device;
+    dev_.device.devHandle = &dev_.devHandle;
+    dev_.gone = false;
+    FillPipe(dev_.devHandle.fd);
+
+    lock_guard<mutex> lock(g_fakeLock);
+    g_fakeDevices[&dev_.devHandle] = &dev_;
+    g_batches.clear();
+    g_completions.clear();
+    InitPool(poolA_);
+    InitPool(poolB_);
+}
+
+void UsbIoReactorTest::TearDown()
+{
+    {
+        lock_guard<mutex> lock(g_fakeLock);
+        g_fakeDevices.erase(&dev_.devHandle);
+    }
+    for (auto pool : {&poolA_, &poolB_}) {
+        OsalSemDestroy(&pool->submitRequestQueue.sem);
+        OsalMutexDestroy(&pool->ioStopLock);
+    }
+    close(dev_.readFd);
+    close(dev_.devHandle.fd);
+}
+
+void UsbIoReactorTest::InitPool(struct UsbInterfacePool &pool)
+{
+    (void)memset_s(&pool, sizeof(pool), 0, sizeof(pool));
+    pool.device = &dev_.device;
+    pool.ioProcessStopStatus = USB_POOL_PROCESS_RUNNING;
+    OsalMutexInit(&pool.ioStopLock);
+    OsalSemInit(&pool.submitRequestQueue.sem, 0);
+}
+
+void UsbIoReactorTest::Complete(struct UsbInterfacePool &pool, uint32_t num)
+{
+    lock_guard<mutex> lock(g_fakeLock);
+    for (uint32_t i = 0; i < num; i++) {
+        dev_.pending.push_back(&pool);
+    }
+    DrainPipe(dev_.readFd);
+}
+
+uint32_t UsbIoReactorTest::Completions(const struct UsbInterfacePool &pool)
+{
+    lock_guard<mutex> lock(g_fakeLock);
+    return g_completions[&pool];
+}
+
+UsbPoolProcessStatusType UsbIoReactorTest::StopStatus(struct UsbInterfacePool &pool)
+{
+    OsalMutexLock(&pool.ioStopLock);
+    UsbPoolProcessStatusType status = pool.ioProcessStopStatus;
+    OsalMutexUnlock(&pool.ioStopLock);
+    return status;
+}
+
+/**
+ * @tc.number: UsbIoReactorTwoPools001
+ * @tc.name: UsbIoReactorTwoPools001
+ * @tc.desc: two interface pools of one device share its fd and each gets its own completions
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbIoReactorTest, UsbIoReactorTwoPools001, TestSize.Level1)
+{
+    struct UsbIoReactorStats stats;
+
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorRegister(&poolA_));
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorRegister(&poolB_));
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorGetStats(&stats));
+    EXPECT_EQ(1U, stats.devices);
+    EXPECT_EQ(2U, stats.pools);
+    EXPECT_EQ(1U, stats.threads);
+
+    Complete(poolA_, 3);
+    Complete(poolB_, 5);
+    EXPECT_TRUE(WaitFor([this] { return dev_.pending.empty(); }));
+    EXPECT_EQ(3U, Completions(poolA_));
+    EXPECT_EQ(5U, Completions(poolB_));
+
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorUnregister(&poolA_));
+    EXPECT_EQ(HDF_ERR_NOT_SUPPORT, UsbIoReactorUnregister(&poolA_));
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorGetStats(&stats));
+    EXPECT_EQ(1U, stats.devices);
+    EXPECT_EQ(1U, stats.pools);
+
+    // the fd stays polled for the pool left
+    Complete(poolB_, 4);
+    EXPECT_TRUE(WaitFor([this] { return dev_.pending.empty(); }));
+    EXPECT_EQ(3U, Completions(poolA_));
+    EXPECT_EQ(9U, Completions(poolB_));
+
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorUnregister(&poolB_));
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorGetStats(&stats));
+    EXPECT_EQ(0U, stats.devices);
+    EXPECT_EQ(0U, stats.pools);
+
+    // removed from epoll with the last pool
+    uint32_t batches;
+    {
+        lock_guard<mutex> lock(g_fakeLock);
+        batches = g_batches[&dev_.devHandle];
+    }
+    Complete(poolB_, 1);
+    this_thread::sleep_for(chrono::milliseconds(WAIT_MS / 10));
+    lock_guard<mutex> lock(g_fakeLock);
+    EXPECT_EQ(batches, g_batches[&dev_.devHandle]);
+    EXPECT_EQ(1U, dev_.pending.size());
+}
+
+/**
+ * @tc.number: UsbIoReactorTwoPools002
+ * @tc.name: UsbIoReactorTwoPools002
+ * @tc.desc: the fd is added again once the last pool left and a pool comes back
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbIoReactorTest, UsbIoReactorTwoPools002, TestSize.Level1)
+{
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorRegister(&poolA_));
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorRegister(&poolB_));
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorUnregister(&poolB_));
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorUnregister(&poolA_));
+
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorRegister(&poolB_));
+    Complete(poolB_, 2);
+    EXPECT_TRUE(WaitFor([this] { return dev_.pending.empty(); }));
+    EXPECT_EQ(2U, Completions(poolB_));
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorUnregister(&poolB_));
+}
+
+/**
+ * @tc.number: UsbIoReactorTwoPools003
+ * @tc.name: UsbIoReactorTwoPools003
+ * @tc.desc: a gone device stops every pool reaping on its fd
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbIoReactorTest, UsbIoReactorTwoPools003, TestSize.Level1)
+{
+    struct UsbIoReactorStats stats;
+
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorRegister(&poolA_));
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorRegister(&poolB_));
+    {
+        lock_guard<mutex> lock(g_fakeLock);
+        dev_.gone = true;
+        DrainPipe(dev_.readFd);
+    }
+    EXPECT_TRUE(WaitFor([this] {
+        return StopStatus(poolA_) == USB_POOL_PROCESS_STOPED && StopStatus(poolB_) == USB_POOL_PROCESS_STOPED;
+    }));
+
+    // the entry stays until its last pool left, no pool reaps on it again
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorUnregister(&poolA_));
+    EXPECT_EQ(HDF_DEV_ERR_NO_DEVICE, UsbIoReactorRegister(&poolA_));
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorUnregister(&poolB_));
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorGetStats(&stats));
+    EXPECT_EQ(0U, stats.devices);
+    EXPECT_EQ(0U, stats.pools);
+}
+
+/**
+ * @tc.number: UsbIoReactorStop001
+ * @tc.name: UsbIoReactorStop001
+ * @tc.desc: the reactor thread is joined once the last device left and comes back on the next registration
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbIoReactorTest, UsbIoReactorStop001, TestSize.Level1)
+{
+    struct UsbIoReactorStats stats;
+
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorRegister(&poolA_));
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorGetStats(&stats));
+    uint64_t releases = stats.releases;
+    EXPECT_EQ(HDF_ERR_DEVICE_BUSY, UsbIoReactorStop());
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorUnregister(&poolA_));
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorStop());
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorStop());
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorGetStats(&stats));
+    EXPECT_EQ(0U, stats.threads);
+    EXPECT_EQ(releases + 1, stats.releases);
+
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorRegister(&poolA_));
+    ASSERT_EQ(HDF_SUCCESS, UsbIoReactorGetStats(&stats));
+    EXPECT_EQ(1U, stats.threads);
+    Complete(poolA_, 2);
+    EXPECT_TRUE(WaitFor([this] { return dev_.pending.empty(); }));
+    EXPECT_EQ(2U, Completions(poolA_));
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorUnregister(&poolA_));
+    EXPECT_EQ(HDF_SUCCESS, UsbIoReactorStop());
+}
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+extern "C" {
+#include "ecm_frame_ring.h"
+#include "securec.h"
+}
+
+using namespace std;
+using namespace testing::ext;
+namespace {
+const uint32_t FAKE_REQ_NUM = 16;
+const uint32_t FAKE_REQ_BUF_SIZE = 1536;
+const uint32_t FAKE_FRAME_NUM = 200;
+const uint32_t FAKE_FRAME_MIN = 60;
+const uint32_t FAKE_FRAME_MAX = 1514;
+
+/* Stands in for a bulk IN UsbRequest: completes into its own buffer, resubmitted on release. */
+struct FakeRequest {
+    uint8_t buffer[FAKE_REQ_BUF_SIZE];
+    uint32_t actualLength;
+    bool inflight;
+};
+
+struct FakeRequestLayer {
+    struct FakeRequest reqs[FAKE_REQ_NUM];
+    uint32_t resubmitted;
+};
+
+static int32_t FakeRequestResubmit(void *owner, void *priv)
+{
+    struct FakeRequest *req = static_cast<struct FakeRequest *>(owner);
+    struct FakeRequestLayer *layer = static_cast<struct FakeRequestLayer *>(priv);
+    req->inflight = true;
+    layer->resubmitted++;
+    return HDF_SUCCESS;
+}
+
+static uint32_t FakeFrameLen(uint32_t seq)
+{
+    return FAKE_FRAME_MIN + (seq * 97) % (FAKE_FRAME_MAX - FAKE_FRAME_MIN + 1);
+}
+
+/* Complete the first idle request with frame seq, as EcmReadBulk would. */
+static struct FakeRequest *FakeComplete(struct FakeRequestLayer *layer, struct EcmFrameRing *ring, uint32_t seq)
+{
+    for (uint32_t i = 0; i < FAKE_REQ_NUM; i++) {
+        struct FakeRequest *req = &layer->reqs[i];
+        if (!req->inflight) {
+            continue;
+        }
+        req->inflight = false;
+        req->actualLength = FakeFrameLen(seq);
+        (void)memset_s(req->buffer, sizeof(req->buffer), static_cast<int>(seq & 0xFF), req->actualLength);
+        if (EcmFrameRingPush(ring, req, req->buffer, req->actualLength) != HDF_SUCCESS) {
+            (void)FakeRequestResubmit(req, layer);
+        }
+        return req;
+    }
+    return nullptr;
+}
+
+class UsbNetEcmFrameRingTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+    struct FakeRequestLayer layer_;
+    struct EcmFrameRing ring_;
+};
+
+void UsbNetEcmFrameRingTest::SetUpTestCase()
+{
+}
+
+void UsbNetEcmFrameRingTest::TearDownTestCase()
+{
+}
+
+void UsbNetEcmFrameRingTest::SetUp()
+{
+    (void)memset_s(&layer_, sizeof(layer_), 0, sizeof(layer_));
+    for (uint32_t i = 0; i < FAKE_REQ_NUM; i++) {
+        layer_.reqs[i].inflight = true;
+    }
+    EcmFrameRingInit(&ring_, FakeRequestResubmit, &layer_);
+}
+
+void UsbNetEcmFrameRingTest::TearDown()
+{
+}
+
+/**
+ * @tc.name: EcmFrameRingReplay001
+ * @tc.desc: frames keep their boundaries and point at the completed request buffers
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbNetEcmFrameRingTest, EcmFrameRingReplay001, TestSize.Level1)
+{
+    uint32_t received = 0;
+    struct EcmFrame frame;
+
+    for (uint32_t seq = 0; seq < FAKE_FRAME_NUM; seq++) {
+        struct FakeRequest *req = FakeComplete(&layer_, &ring_, seq);
+        ASSERT_NE(nullptr, req);
+        if ((seq % 3) != 2) {
+            continue;
+        }
+        /* the reader drains in bursts, like repeated EcmRead calls */
+        while (EcmFrameRingGet(&ring_, &frame) == HDF_SUCCESS) {
+            struct FakeRequest *owner = static_cast<struct FakeRequest *>(frame.owner);
+            EXPECT_EQ(owner->buffer, frame.data);
+            EXPECT_EQ(FakeFrameLen(received), frame.len);
+            EXPECT_EQ(received & 0xFF, frame.data[frame.len - 1]);
+            EXPECT_EQ(HDF_SUCCESS, EcmFrameRingRelease(&ring_, &frame));
+            received++;
+        }
+    }
+    while (EcmFrameRingGet(&ring_, &frame) == HDF_SUCCESS) {
+        EXPECT_EQ(FakeFrameLen(received), frame.len);
+        EXPECT_EQ(HDF_SUCCESS, EcmFrameRingRelease(&ring_, &frame));
+        received++;
+    }
+    EXPECT_EQ(FAKE_FRAME_NUM, received);
+    EXPECT_EQ(FAKE_FRAME_NUM, layer_.resubmitted);
+    EXPECT_EQ(0U, ring_.dropped);
+}
+
+/**
+ * @tc.name: EcmFrameRingFull001
+ * @tc.desc: a full ring rejects the frame so the caller can resubmit its request
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbNetEcmFrameRingTest, EcmFrameRingFull001, TestSize.Level1)
+{
+    uint8_t data[FAKE_FRAME_MIN] = {0};
+
+    for (uint32_t i = 0; i < ECM_FRAME_RING_SIZE; i++) {
+        EXPECT_EQ(HDF_SUCCESS, EcmFrameRingPush(&ring_, nullptr, data, sizeof(data)));
+    }
+    EXPECT_EQ(ECM_FRAME_RING_SIZE, EcmFrameRingCount(&ring_));
+    EXPECT_EQ(HDF_ERR_QUEUE_FULL, EcmFrameRingPush(&ring_, nullptr, data, sizeof(data)));
+    EXPECT_EQ(1U, ring_.dropped);
+}
+
+/**
+ * @tc.name: EcmFrameRingFlush001
+ * @tc.desc: flushing on close drops held frames without resubmitting them
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbNetEcmFrameRingTest, EcmFrameRingFlush001, TestSize.Level1)
+{
+    struct EcmFrame frame;
+
+    for (uint32_t seq = 0; seq < FAKE_REQ_NUM; seq++) {
+        EXPECT_NE(nullptr, FakeComplete(&layer_, &ring_, seq));
+    }
+    EXPECT_EQ(nullptr, FakeComplete(&layer_, &ring_, FAKE_REQ_NUM));
+    EXPECT_EQ(FAKE_REQ_NUM, EcmFrameRingFlush(&ring_));
+    EXPECT_EQ(HDF_DEV_ERR_NODATA, EcmFrameRingGet(&ring_, &frame));
+    EXPECT_EQ(0U, layer_.resubmitted);
+}
+
+/**
+ * @tc.name: EcmFrameRingInvalid001
+ * @tc.desc: invalid parameters are rejected
+ * @tc.type: FUNC
+ */
+HWTEST_F(UsbNetEcmFrameRingTest, EcmFrameRingInvalid001, TestSize.Level1)
+{
+    struct EcmFrame frame;
+
+    EXPECT_EQ(HDF_ERR_INVALID_PARAM, EcmFrameRingPush(nullptr, nullptr, nullptr, 0));
+    EXPECT_EQ(HDF_ERR_INVALID_PARAM, EcmFrameRingPush(&ring_, nullptr, nullptr, 0));
+    EXPECT_EQ(HDF_ERR_INVALID_PARAM, EcmFrameRingGet(&ring_, nullptr));
+    EXPECT_EQ(HDF_ERR_INVALID_PARAM, EcmFrameRingRelease(nullptr, &frame));
+}
+}